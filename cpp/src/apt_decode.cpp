@@ -0,0 +1,132 @@
+/*
+ * apt_decode.cpp
+ * Satellite Ground Station - Streaming APT Decoder for WAV Files
+ *
+ * Native counterpart of decode_apt_wav.py: reads FM-demodulated audio
+ * (rtlsdr_capture -a, or any 16-bit / float WAV at >= 8960 Hz) half a
+ * second at a time through AptDecoder, so memory stays at a few lines
+ * plus the image itself however long the recording is. With -r the PNG
+ * is rewritten every few lines, e.g. while the WAV is still growing
+ * during a pass.
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <getopt.h>
+
+#include "apt_decoder.h"
+#include "fft.h"
+#include "wav_reader.h"
+
+void print_usage(const char* progname) {
+    std::cout << "Usage: " << progname << " [options] <audio.wav>\n"
+              << "\nOptions:\n"
+              << "  -o <file.png>  Output image (default: <audio>_decoded.png)\n"
+              << "  -r <lines>     Rewrite the PNG every this many lines (default: only at the end)\n"
+              << "  -h             Show this help\n"
+              << "\nExample:\n"
+              << "  " << progname << " -r 20 pass.wav\n";
+}
+
+int main(int argc, char* argv[]) {
+    std::string output_file;
+    int refresh_lines = 0;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "o:r:h")) != -1) {
+        switch (opt) {
+            case 'o':
+                output_file = optarg;
+                break;
+            case 'r':
+                refresh_lines = std::stoi(optarg);
+                break;
+            case 'h':
+            default:
+                print_usage(argv[0]);
+                return (opt == 'h') ? 0 : 1;
+        }
+    }
+    if (optind != argc - 1) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    std::string input_file = argv[optind];
+    if (output_file.empty()) {
+        size_t dot = input_file.find_last_of('.');
+        size_t slash = input_file.find_last_of('/');
+        std::string base = (dot != std::string::npos && (slash == std::string::npos || dot > slash))
+            ? input_file.substr(0, dot) : input_file;
+        output_file = base + "_decoded.png";
+    }
+
+    WavReader wav;
+    if (!wav.open(input_file)) {
+        return 1;
+    }
+    std::cout << "Loading: " << input_file << "\n";
+    std::cout << "  Sample rate: " << wav.sample_rate() << " Hz\n";
+    std::cout << "  Channels:    " << wav.channels() << (wav.channels() > 1 ? " (using the first)" : "") << "\n";
+
+    AptDecoder decoder;
+    if (!decoder.configure(wav.sample_rate())) {
+        std::cerr << "Error: Sample rate too low for APT (need at least "
+                  << APT_MIN_AUDIO_RATE << " Hz)\n";
+        return 1;
+    }
+
+    // Half a second of audio per block, i.e. about one line
+    const size_t block_frames = wav.sample_rate() / 2;
+    std::vector<float> audio(block_frames);
+    std::vector<AptLine> lines;
+    AptImage image;
+    uint64_t frames = 0;
+    int since_refresh = 0;
+    bool ok = true;
+
+    auto t0 = std::chrono::steady_clock::now();
+    size_t n;
+    while ((n = wav.read(audio.data(), block_frames)) > 0) {
+        frames += n;
+
+        lines.clear();
+        decoder.process(audio.data(), n, lines);
+        for (const AptLine& line : lines) {
+            image.add(line);
+        }
+        since_refresh += static_cast<int>(lines.size());
+        if (refresh_lines > 0 && since_refresh >= refresh_lines) {
+            ok = image.save_png(output_file) && ok;
+            since_refresh = 0;
+        }
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    if (image.height() == 0) {
+        std::cerr << "Error: Recording too short for a single APT line\n";
+        return 1;
+    }
+    if (!image.save_png(output_file) || !ok) {
+        std::cerr << "Error: Cannot write image: " << output_file << std::endl;
+        return 1;
+    }
+
+    double duration = static_cast<double>(frames) / wav.sample_rate();
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "  Duration:    " << duration << " seconds\n";
+    std::cout << "  Lines:       " << decoder.lines_emitted() << " (" << decoder.lines_synced() << " synced)\n";
+    std::cout << "  Sync:        " << (decoder.fft_correlation() ? "overlap-save FFT (" : "direct (")
+              << (decoder.fft_correlation() ? fft_backend_name() : dsp_kernels().name) << "), clock "
+              << std::showpos << decoder.clock_error_ppm() << std::noshowpos << " ppm\n";
+    std::cout << "  Decode time: " << std::setprecision(3) << elapsed << " s ("
+              << std::setprecision(0) << duration / (elapsed > 0 ? elapsed : 1e-9) << "x real time)\n";
+    std::cout << "\nSaved: " << output_file << "\n";
+    std::cout << "Size: " << image.width() << " x " << image.height() << " pixels\n";
+    return 0;
+}
@@ -0,0 +1,304 @@
+/*
+ * apt_decoder.cpp
+ * Satellite Ground Station - Streaming NOAA APT Image Decoder
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#include "apt_decoder.h"
+#include "png_writer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <numeric>
+
+static const double kPi = 3.14159265358979323846;
+
+// From the NOAA KLM user's guide: sync A is seven cycles of 1040 Hz,
+// sync B seven cycles of 832 Hz, both after four black pixels
+const char kAptSyncA[APT_SYNC_PIXELS + 1] = "000011001100110011001100110011000000000";
+const char kAptSyncB[APT_SYNC_PIXELS + 1] = "000011100111001110011100111001110011100";
+
+#define APT_VIDEO_CUTOFF_HZ     2080.0  // Pixel-rate Nyquist
+#define APT_VIDEO_TRANSITION_HZ 1040.0
+#define APT_LEVEL_SMOOTHING     0.1f    // Weight of each new line's sync levels
+
+// Stream (oversampled) units
+#define APT_LINE_SAMPLES   (APT_LINE_PIXELS * APT_OVERSAMPLE)
+#define APT_SYNC_SAMPLES   (APT_SYNC_PIXELS * APT_OVERSAMPLE)
+#define APT_B_OFFSET       (APT_CHANNEL_B_OFFSET * APT_OVERSAMPLE)
+#define APT_SEARCH_SAMPLES (APT_SYNC_SEARCH * APT_OVERSAMPLE)
+
+// Zero-mean, unit-norm template with each pixel repeated APT_OVERSAMPLE times
+static std::vector<float> make_template(const char* pattern) {
+    std::vector<float> out(APT_SYNC_SAMPLES);
+    float mean = 0.0f;
+    for (int k = 0; k < APT_SYNC_PIXELS; k++) mean += pattern[k] == '1' ? 1.0f : 0.0f;
+    mean /= APT_SYNC_PIXELS;
+    float norm = 0.0f;
+    for (int k = 0; k < APT_SYNC_SAMPLES; k++) {
+        out[k] = (pattern[k / APT_OVERSAMPLE] == '1' ? 1.0f : 0.0f) - mean;
+        norm += out[k] * out[k];
+    }
+    norm = std::sqrt(norm);
+    for (auto& t : out) t /= norm;
+    return out;
+}
+
+bool AptDecoder::configure(uint32_t audio_rate) {
+    // The subcarrier's upper video sideband has to fit below Nyquist
+    if (audio_rate < APT_MIN_AUDIO_RATE) {
+        return false;
+    }
+    audio_rate_ = audio_rate;
+
+    double phi = 2.0 * kPi * APT_CARRIER_HZ / audio_rate;
+    cos_phi_ = static_cast<float>(std::cos(phi));
+    inv_sin_phi_ = static_cast<float>(1.0 / std::sin(phi));
+
+    // Envelope -> oversampled pixel rate by L/M, filtered at the
+    // interpolated rate
+    const uint32_t stream_rate = APT_PIXEL_RATE * APT_OVERSAMPLE;
+    uint32_t g = std::gcd(audio_rate, stream_rate);
+    int interp = static_cast<int>(stream_rate / g);
+    int decim = static_cast<int>(audio_rate / g);
+    double up_rate = static_cast<double>(audio_rate) * interp;
+    resampler_.configure(design_lowpass(up_rate, APT_VIDEO_CUTOFF_HZ,
+                                        lowpass_num_taps(up_rate, APT_VIDEO_TRANSITION_HZ)),
+                         interp, decim);
+
+    correlator_.configure(make_template(kAptSyncA), make_template(kAptSyncB));
+    reset();
+    return true;
+}
+
+void AptDecoder::reset() {
+    resampler_.reset();
+    correlator_.reset();
+    last_sample_ = 0.0f;
+    samples_.clear();
+    sum_.assign(1, 0.0);
+    sum_sq_.assign(1, 0.0);
+    corr_.clear();
+    base_ = 0;
+    next_start_ = 0.0;
+    period_ = APT_LINE_SAMPLES;
+    locked_ = false;
+    missed_ = 0;
+    lines_emitted_ = 0;
+    lines_synced_ = 0;
+}
+
+double AptDecoder::clock_error_ppm() const {
+    return (period_ / APT_LINE_SAMPLES - 1.0) * 1e6;
+}
+
+size_t AptDecoder::process(const float* audio, size_t n, std::vector<AptLine>& lines) {
+    // Amplitude of a sinusoid at the known subcarrier frequency from two
+    // consecutive samples: x[n]^2 + x[n-1]^2 - 2 x[n] x[n-1] cos(phi)
+    // = A^2 sin^2(phi)
+    envelope_.resize(n);
+    float prev = last_sample_;
+    for (size_t i = 0; i < n; i++) {
+        float x = audio[i];
+        float v = x * x + prev * prev - 2.0f * x * prev * cos_phi_;
+        envelope_[i] = std::sqrt(std::max(v, 0.0f)) * inv_sin_phi_;
+        prev = x;
+    }
+    if (n > 0) last_sample_ = prev;
+
+    resampled_.clear();
+    resampler_.process(envelope_.data(), n, resampled_);
+    push_samples(resampled_.data(), resampled_.size());
+
+    size_t before = lines.size();
+    while (emit_ready(lines)) {}
+    return lines.size() - before;
+}
+
+void AptDecoder::push_samples(const float* x, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        samples_.push_back(x[i]);
+        sum_.push_back(sum_.back() + x[i]);
+        sum_sq_.push_back(sum_sq_.back() + static_cast<double>(x[i]) * x[i]);
+    }
+    corr_new_.clear();
+    correlator_.process(x, n, corr_new_);
+    corr_.insert(corr_.end(), corr_new_.begin(), corr_new_.end());
+}
+
+// Mean of the normalized sync A correlation at index and sync B half a
+// line later. Both must lie inside corr_.
+float AptDecoder::sync_score(size_t index) const {
+    float score = 0.0f;
+    for (int which = 0; which < 2; which++) {
+        size_t w = index + (which ? APT_B_OFFSET : 0);
+        double s1 = sum_[w + APT_SYNC_SAMPLES] - sum_[w];
+        double s2 = sum_sq_[w + APT_SYNC_SAMPLES] - sum_sq_[w];
+        double var = s2 - s1 * s1 / APT_SYNC_SAMPLES;
+        float c = which ? corr_[w].imag() : corr_[w].real();
+        score += var > 1e-12 ? static_cast<float>(c / std::sqrt(var)) : 0.0f;
+    }
+    return 0.5f * score;
+}
+
+// Frame and emit the next line once every candidate start for it, and
+// the line body after each, has arrived
+bool AptDecoder::emit_ready(std::vector<AptLine>& lines) {
+    uint64_t lo, hi;
+    uint64_t predicted = static_cast<uint64_t>(std::llround(next_start_));
+    if (locked_) {
+        lo = predicted >= base_ + APT_SEARCH_SAMPLES + 1 ? predicted - APT_SEARCH_SAMPLES : base_ + 1;
+        hi = predicted + APT_SEARCH_SAMPLES;
+    } else {
+        lo = std::max<uint64_t>(predicted, base_ + 1);
+        hi = lo + APT_LINE_SAMPLES - 1;
+    }
+    // Neighbours of every candidate are scored too, for sub-sample peaks
+    uint64_t line_end = hi + static_cast<uint64_t>(std::ceil(period_)) + 2;
+    if (hi + 1 + APT_B_OFFSET >= base_ + corr_.size() || line_end > base_ + samples_.size()) {
+        return false;
+    }
+
+    // Sync A at the start and sync B half a line later must agree
+    size_t best = static_cast<size_t>(lo - base_);
+    float best_q = -1.0f;
+    for (uint64_t s = lo; s <= hi; s++) {
+        size_t i = static_cast<size_t>(s - base_);
+        float q = sync_score(i);
+        if (q > best_q) {
+            best_q = q;
+            best = i;
+        }
+    }
+    bool synced = best_q >= APT_SYNC_THRESHOLD;
+
+    double start = next_start_;
+    if (synced) {
+        // Parabola through the peak and its neighbours
+        float qm = sync_score(best - 1), qp = sync_score(best + 1);
+        float den = qm - 2.0f * best_q + qp;
+        double offset = den < 0.0f ? 0.5 * (qm - qp) / den : 0.0;
+        double peak = base_ + best + std::max(-0.5, std::min(0.5, offset));
+
+        if (locked_) {
+            // Second-order loop: nudge the phase, and the period by a
+            // smaller share, toward the measured sync
+            double err = peak - next_start_;
+            start = next_start_ + APT_PLL_PHASE_GAIN * err;
+            period_ += APT_PLL_PERIOD_GAIN * err;
+            period_ = std::max(APT_LINE_SAMPLES * (1.0 - APT_MAX_CLOCK_ERROR),
+                               std::min(APT_LINE_SAMPLES * (1.0 + APT_MAX_CLOCK_ERROR), period_));
+        } else {
+            start = peak;
+        }
+        lines_synced_++;
+        locked_ = true;
+        missed_ = 0;
+    } else if (locked_ && ++missed_ > APT_MAX_MISSED_SYNCS) {
+        locked_ = false;
+        missed_ = 0;
+    } else if (!locked_) {
+        start = static_cast<double>(lo);
+    }
+
+    // Pixels at the tracked period: each is the mean of APT_OVERSAMPLE
+    // linearly interpolated samples
+    lines.emplace_back();
+    AptLine& line = lines.back();
+    const double step = period_ / APT_LINE_SAMPLES;
+    const double origin = start - static_cast<double>(base_);
+    for (int x = 0; x < APT_LINE_PIXELS; x++) {
+        float acc = 0.0f;
+        for (int j = 0; j < APT_OVERSAMPLE; j++) {
+            double t = origin + (x * APT_OVERSAMPLE + j) * step;
+            size_t i = static_cast<size_t>(t);
+            float f = static_cast<float>(t - i);
+            acc += samples_[i] + f * (samples_[i + 1] - samples_[i]);
+        }
+        line.pixels[x] = acc / APT_OVERSAMPLE;
+    }
+    line.number = lines_emitted_++;
+    line.start_pixel = start / APT_OVERSAMPLE;
+    line.synced = synced;
+    line.sync_quality = std::max(best_q, 0.0f);
+    if (synced) {
+        float white = 0.0f, black = 0.0f;
+        int num_white = 0;
+        for (int k = 0; k < APT_SYNC_PIXELS; k++) {
+            if (kAptSyncA[k] == '1') {
+                white += line.pixels[k];
+                num_white++;
+            } else {
+                black += line.pixels[k];
+            }
+        }
+        line.white_level = white / num_white;
+        line.black_level = black / (APT_SYNC_PIXELS - num_white);
+    }
+    next_start_ = start + period_;
+
+    // Drop everything before the next search window (and the sample
+    // ahead of it that the sub-sample fit reads)
+    double keep_from = next_start_ - (locked_ ? APT_SEARCH_SAMPLES : 0) - 2.0;
+    uint64_t keep = keep_from > 0.0 ? static_cast<uint64_t>(keep_from) : 0;
+    size_t drop = static_cast<size_t>(std::min<uint64_t>(keep - std::min(keep, base_), corr_.size()));
+    samples_.erase(samples_.begin(), samples_.begin() + drop);
+    sum_.erase(sum_.begin(), sum_.begin() + drop);
+    sum_sq_.erase(sum_sq_.begin(), sum_sq_.begin() + drop);
+    corr_.erase(corr_.begin(), corr_.begin() + drop);
+    base_ += drop;
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// AptImage
+// ----------------------------------------------------------------------------
+
+void AptImage::add(const AptLine& line) {
+    if (line.synced && line.white_level > line.black_level) {
+        if (!levels_set_) {
+            black_ = line.black_level;
+            white_ = line.white_level;
+            levels_set_ = true;
+        } else {
+            black_ += APT_LEVEL_SMOOTHING * (line.black_level - black_);
+            white_ += APT_LEVEL_SMOOTHING * (line.white_level - white_);
+        }
+    }
+
+    float black = black_, white = white_;
+    if (!levels_set_) {
+        // Nothing synced yet: stretch this line on its own
+        auto range = std::minmax_element(line.pixels.begin(), line.pixels.end());
+        black = *range.first;
+        white = *range.second;
+    }
+    float scale = white > black ? 255.0f / (white - black) : 0.0f;
+
+    size_t at = rows_.size();
+    rows_.resize(at + APT_LINE_PIXELS);
+    for (int x = 0; x < APT_LINE_PIXELS; x++) {
+        float v = (line.pixels[x] - black) * scale;
+        rows_[at + x] = static_cast<uint8_t>(std::lrint(std::min(255.0f, std::max(0.0f, v))));
+    }
+}
+
+void AptImage::clear() {
+    rows_.clear();
+    levels_set_ = false;
+    black_ = 0.0f;
+    white_ = 1.0f;
+}
+
+bool AptImage::save_png(const std::string& path) const {
+    if (height() == 0) return false;
+    std::string tmp = path + ".tmp";
+    if (!write_png_gray8(tmp, rows_.data(), width(), height())) {
+        std::remove(tmp.c_str());
+        return false;
+    }
+    return std::rename(tmp.c_str(), path.c_str()) == 0;
+}
@@ -0,0 +1,145 @@
+/*
+ * apt_decoder.h
+ * Satellite Ground Station - Streaming NOAA APT Image Decoder
+ *
+ * Native replacement for the am_demodulate / find_sync_pulses /
+ * extract_lines steps of decode_apt.py. Audio is fed block by block
+ * (straight from DemodPipeline during a capture, or from a WAV) and
+ * each 2080-pixel line is emitted as soon as its last pixel arrives:
+ *
+ *   FM audio (any rate, 20800 Hz from the capture)
+ *     -> 2400 Hz subcarrier envelope (two-sample quadrature detector)
+ *     -> polyphase resampler to APT_OVERSAMPLE x 4160 samples/s
+ *     -> sync A / sync B correlation (PairCorrelator: overlap-save FFT
+ *        for the oversampled templates), normalized per window
+ *     -> line framing: full-line search until locked, then +/-
+ *        APT_SYNC_SEARCH pixels around the predicted start
+ *     -> second-order PLL on the sub-sample sync position, which
+ *        smooths the line start and tracks the line period, i.e. the
+ *        sample-clock error of the recording, through missed syncs
+ *     -> 2080 pixels per line, resampled at the tracked period
+ *
+ * Memory is bounded by a few lines of samples regardless of pass length.
+ * AptImage collects emitted lines into an 8-bit image, scaled by the
+ * black/white levels of the sync A pulses rather than the whole-image
+ * percentiles decode_apt.py uses, so it can be written mid-pass.
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#ifndef SATGS_APT_DECODER_H
+#define SATGS_APT_DECODER_H
+
+#include "correlator.h"
+#include "dsp_pipeline.h"
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#define APT_PIXEL_RATE       4160      // 2 lines/s x 2080 pixels
+#define APT_OVERSAMPLE       4         // Timing resolution, samples per pixel
+#define APT_LINE_PIXELS      2080
+#define APT_CARRIER_HZ       2400.0
+#define APT_MIN_AUDIO_RATE   8960      // 2 x (subcarrier + 2080 Hz video bandwidth)
+#define APT_SYNC_PIXELS      39        // Sync A / sync B pattern length
+#define APT_CHANNEL_B_OFFSET 1040      // Sync B position within the line
+#define APT_SYNC_THRESHOLD   0.45f     // Mean A/B correlation that counts as a sync
+#define APT_SYNC_SEARCH      8         // Pixels either side of the predicted start when locked
+#define APT_MAX_MISSED_SYNCS 16        // Flywheel lines before reacquiring
+#define APT_PLL_PHASE_GAIN   0.25      // Share of each line's timing error taken at once
+#define APT_PLL_PERIOD_GAIN  0.02      // ... and folded into the line period
+#define APT_MAX_CLOCK_ERROR  0.005     // Line period kept within +/-0.5% of nominal
+
+// Sync patterns in pixels ('1' = white)
+extern const char kAptSyncA[APT_SYNC_PIXELS + 1];
+extern const char kAptSyncB[APT_SYNC_PIXELS + 1];
+
+struct AptLine {
+    uint64_t number = 0;            // Emitted line count, from 0
+    double start_pixel = 0.0;       // Stream position of the first pixel (fractional)
+    bool synced = false;            // Start came from a detected sync (else flywheel)
+    float sync_quality = 0.0f;      // Mean sync A / sync B correlation at the start
+    float black_level = 0.0f;       // Sync A low and high levels (valid when synced)
+    float white_level = 0.0f;
+    std::array<float, APT_LINE_PIXELS> pixels;
+};
+
+class AptDecoder {
+public:
+    bool configure(uint32_t audio_rate);
+    void reset();
+
+    // Feed audio; completed lines are appended to lines. Returns the
+    // number appended.
+    size_t process(const float* audio, size_t n, std::vector<AptLine>& lines);
+
+    uint32_t audio_rate() const { return audio_rate_; }
+    bool locked() const { return locked_; }
+    bool fft_correlation() const { return correlator_.uses_fft(); }
+
+    // Recording clock error from the tracked line period
+    double clock_error_ppm() const;
+
+    uint64_t lines_emitted() const { return lines_emitted_; }
+    uint64_t lines_synced() const { return lines_synced_; }
+
+private:
+    void push_samples(const float* x, size_t n);
+    float sync_score(size_t index) const;
+    bool emit_ready(std::vector<AptLine>& lines);
+
+    uint32_t audio_rate_ = 0;
+    float cos_phi_ = 0.0f;
+    float inv_sin_phi_ = 1.0f;
+    float last_sample_ = 0.0f;
+
+    RationalResampler resampler_;
+    PairCorrelator correlator_;     // Sync A (real) and sync B (imaginary)
+    std::vector<float> envelope_;   // Scratch reused between blocks
+    std::vector<float> resampled_;
+    std::vector<cf32> corr_new_;
+
+    // Oversampled envelope, window sums for normalization (prefix sums,
+    // one longer) and the raw correlation of the window starting at each
+    // sample; index 0 is stream sample base_
+    std::vector<float> samples_;
+    std::vector<double> sum_;
+    std::vector<double> sum_sq_;
+    std::vector<cf32> corr_;
+    uint64_t base_ = 0;
+
+    // PLL: predicted start of the next line and the line period, in
+    // oversampled samples
+    double next_start_ = 0.0;
+    double period_ = 0.0;
+    bool locked_ = false;
+    int missed_ = 0;
+    uint64_t lines_emitted_ = 0;
+    uint64_t lines_synced_ = 0;
+};
+
+// Growing 8-bit image of decoded lines
+class AptImage {
+public:
+    void add(const AptLine& line);
+    void clear();
+
+    // Grayscale PNG of every line so far, replaced atomically so a
+    // reader polling the file never sees it half-written
+    bool save_png(const std::string& path) const;
+
+    uint32_t width() const { return APT_LINE_PIXELS; }
+    uint32_t height() const { return static_cast<uint32_t>(rows_.size() / APT_LINE_PIXELS); }
+    const std::vector<uint8_t>& data() const { return rows_; }
+
+private:
+    std::vector<uint8_t> rows_;
+    bool levels_set_ = false;
+    float black_ = 0.0f;            // Smoothed over synced lines
+    float white_ = 1.0f;
+};
+
+#endif // SATGS_APT_DECODER_H
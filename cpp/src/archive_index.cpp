@@ -0,0 +1,406 @@
+/*
+ * archive_index.cpp
+ * Satellite Ground Station - Time-indexed Capture Archive
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#include "archive_index.h"
+#include "sgc_format.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define ARCHIVE_CAPTURE_MAX_SEC 3600.0  // Longest capture covering() looks back for
+
+template <typename T>
+static void put(uint8_t* buf, size_t offset, T value) {
+    std::memcpy(buf + offset, &value, sizeof(T));
+}
+
+template <typename T>
+static T get(const uint8_t* buf, size_t offset) {
+    T value;
+    std::memcpy(&value, buf + offset, sizeof(T));
+    return value;
+}
+
+static size_t pad8(size_t n) {
+    return (n + 7) & ~static_cast<size_t>(7);
+}
+
+static std::string upper(std::string s) {
+    for (auto& c : s) c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    return s;
+}
+
+static bool write_at(int fd, const uint8_t* data, size_t n, off_t offset) {
+    while (n > 0) {
+        ssize_t w = ::pwrite(fd, data, n, offset);
+        if (w < 0 && errno == EINTR) continue;
+        if (w <= 0) return false;
+        data += w;
+        n -= static_cast<size_t>(w);
+        offset += w;
+    }
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// Writing
+// ----------------------------------------------------------------------------
+
+bool archive_describe_capture(const std::string& capture_file, uint32_t raw_rate, double raw_start_utc,
+                              ArchiveEntry& entry) {
+    entry.capture_file = capture_file;
+    entry.seek.clear();
+    const bool sgc = capture_file.size() > 4 && capture_file.compare(capture_file.size() - 4, 4, ".sgc") == 0;
+    if (!sgc) {
+        struct stat st;
+        if (stat(capture_file.c_str(), &st) != 0) {
+            std::cerr << "Error: Cannot stat capture: " << capture_file << std::endl;
+            return false;
+        }
+        entry.flags &= ~ARCHIVE_SGC;
+        entry.sample_rate = raw_rate;
+        entry.capture_start_utc = raw_start_utc;
+        entry.capture_samples = static_cast<uint64_t>(st.st_size) / 2;
+        return true;
+    }
+
+    SgcReader reader;
+    if (!reader.open(capture_file)) return false;
+    const SgcHeader& h = reader.header();
+    const std::vector<SgcEntry>& frames = reader.entries();
+    const uint64_t base = frames.empty() ? 0 : frames.front().first_sample;
+    entry.flags |= ARCHIVE_SGC;
+    entry.sample_rate = h.sample_rate;
+    entry.capture_start_utc = frames.empty() ? h.created_utc : frames.front().utc;
+    entry.capture_samples = reader.stream_samples();
+    if (entry.freq_hz == 0.0) entry.freq_hz = static_cast<double>(h.carrier_freq_hz ? h.carrier_freq_hz : h.center_freq_hz);
+
+    // First frame of every second of samples, and after every gap or
+    // clock jump (gaps carry no data to decode)
+    const uint64_t step = static_cast<uint64_t>(ARCHIVE_SEEK_STEP_SEC * h.sample_rate);
+    uint64_t next_sample = 0;
+    double next_utc = -1e300;
+    bool after_gap = true;
+    for (const SgcEntry& e : frames) {
+        if (e.gap) {
+            after_gap = true;
+            continue;
+        }
+        const uint64_t sample = e.first_sample - base;
+        if (after_gap || sample >= next_sample || e.utc >= next_utc) {
+            entry.seek.push_back({e.utc, sample, e.offset});
+            next_sample = sample + step;
+            next_utc = e.utc + ARCHIVE_SEEK_STEP_SEC;
+        }
+        after_gap = false;
+    }
+    return true;
+}
+
+static void pack_record(const ArchiveEntry& e, double key_aos, double key_late, uint64_t blob_offset,
+                        uint8_t* buf) {
+    std::memset(buf, 0, ARCHIVE_RECORD_SIZE);
+    put<double>(buf, 0, e.aos_unix);
+    put<double>(buf, 8, e.los_unix);
+    put<double>(buf, 16, key_aos);
+    put<double>(buf, 24, key_late);
+    put<double>(buf, 32, e.tca_unix);
+    put<double>(buf, 40, e.capture_start_utc);
+    put<double>(buf, 48, e.indexed_unix);
+    put<double>(buf, 56, e.freq_hz);
+    put<uint32_t>(buf, 64, e.sample_rate);
+    put<uint32_t>(buf, 68, static_cast<uint32_t>(e.norad_id));
+    put<float>(buf, 72, static_cast<float>(e.max_elevation_deg));
+    put<float>(buf, 76, static_cast<float>(e.snr_db));
+    put<float>(buf, 80, static_cast<float>(e.sync_rate));
+    put<uint32_t>(buf, 84, e.image_lines);
+    put<uint32_t>(buf, 88, e.flags);
+    put<uint32_t>(buf, 92, static_cast<uint32_t>(e.seek.size()));
+    put<uint64_t>(buf, 96, e.capture_samples);
+    put<uint64_t>(buf, 104, blob_offset);
+    put<uint32_t>(buf, 112, static_cast<uint32_t>(e.capture_file.size()));
+    put<uint32_t>(buf, 116, static_cast<uint32_t>(e.image_file.size()));
+    put<uint32_t>(buf, 120, static_cast<uint32_t>(e.doppler_file.size()));
+    put<uint32_t>(buf, 124, static_cast<uint32_t>(e.source.size()));
+    std::memcpy(buf + 128, e.satellite.data(), std::min<size_t>(e.satellite.size(), ARCHIVE_SATELLITE_LEN));
+}
+
+// out[0] sits at file offset base; the seek table is 8-aligned in the file
+static void pack_blob(const ArchiveEntry& e, uint64_t base, std::vector<uint8_t>& out) {
+    for (const std::string* s : {&e.capture_file, &e.image_file, &e.doppler_file, &e.source}) {
+        out.insert(out.end(), s->begin(), s->end());
+    }
+    out.resize(pad8(base + out.size()) - base, 0);
+    for (const ArchiveSeekPoint& p : e.seek) {
+        uint8_t point[ARCHIVE_SEEK_POINT_SIZE];
+        put<double>(point, 0, p.utc);
+        put<uint64_t>(point, 8, p.sample);
+        put<uint64_t>(point, 16, p.offset);
+        out.insert(out.end(), point, point + ARCHIVE_SEEK_POINT_SIZE);
+    }
+}
+
+bool archive_append(const std::string& index_path, const std::vector<ArchiveEntry>& entries) {
+    int fd = ::open(index_path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        std::cerr << "Error: Cannot open archive index " << index_path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    const std::string blob_path = index_path + ARCHIVE_BLOB_SUFFIX;
+    int blob_fd = ::open(blob_path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (blob_fd < 0 || flock(fd, LOCK_EX) != 0) {
+        std::cerr << "Error: Cannot open archive index " << blob_path << ": " << std::strerror(errno) << std::endl;
+        if (blob_fd >= 0) ::close(blob_fd);
+        ::close(fd);
+        return false;
+    }
+
+    bool ok = true;
+    struct stat st;
+    fstat(fd, &st);
+    off_t size = st.st_size;
+    uint8_t header[ARCHIVE_HEADER_SIZE];
+    if (size < ARCHIVE_HEADER_SIZE) {
+        std::memset(header, 0, sizeof(header));
+        std::memcpy(header, ARCHIVE_MAGIC, 4);
+        put<uint32_t>(header, 4, ARCHIVE_VERSION);
+        put<uint32_t>(header, 8, ARCHIVE_HEADER_SIZE);
+        put<uint32_t>(header, 12, ARCHIVE_RECORD_SIZE);
+        put<double>(header, 16, std::chrono::duration<double>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+        ok = ftruncate(fd, 0) == 0 && ftruncate(blob_fd, 0) == 0 && write_at(fd, header, sizeof(header), 0);
+        size = ARCHIVE_HEADER_SIZE;
+    } else if (::pread(fd, header, sizeof(header), 0) != ARCHIVE_HEADER_SIZE ||
+               std::memcmp(header, ARCHIVE_MAGIC, 4) != 0 ||
+               get<uint32_t>(header, 12) != ARCHIVE_RECORD_SIZE) {
+        std::cerr << "Error: Not an archive index: " << index_path << std::endl;
+        ok = false;
+    }
+
+    // Cut a record torn by a crash, then continue the running keys
+    const off_t torn = (size - ARCHIVE_HEADER_SIZE) % ARCHIVE_RECORD_SIZE;
+    if (ok && torn != 0) {
+        size -= torn;
+        ok = ftruncate(fd, size) == 0;
+    }
+    double key_aos = -1e300, key_late = 0.0;
+    if (ok && size > ARCHIVE_HEADER_SIZE) {
+        uint8_t last[32];
+        ok = ::pread(fd, last, sizeof(last), size - ARCHIVE_RECORD_SIZE) == sizeof(last);
+        key_aos = get<double>(last, 16);
+        key_late = get<double>(last, 24);
+    }
+
+    fstat(blob_fd, &st);
+    const uint64_t blob_start = pad8(static_cast<size_t>(st.st_size));
+    std::vector<uint8_t> blob(blob_start - static_cast<uint64_t>(st.st_size), 0);
+    std::vector<uint8_t> records(entries.size() * ARCHIVE_RECORD_SIZE);
+    const double now = std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+    for (size_t i = 0; ok && i < entries.size(); i++) {
+        ArchiveEntry e = entries[i];
+        e.indexed_unix = now;
+        key_aos = std::max(key_aos, e.aos_unix);
+        key_late = std::max(key_late, key_aos - e.aos_unix);
+        pack_record(e, key_aos, key_late, st.st_size + blob.size(), records.data() + i * ARCHIVE_RECORD_SIZE);
+        pack_blob(e, st.st_size, blob);
+    }
+
+    // Blob first: a record never points past what is on disk
+    ok = ok && write_at(blob_fd, blob.data(), blob.size(), st.st_size) &&
+         write_at(fd, records.data(), records.size(), size);
+    if (!ok) std::cerr << "Error: Failed writing archive index " << index_path << std::endl;
+    ::close(blob_fd);
+    ::close(fd);
+    return ok;
+}
+
+// ----------------------------------------------------------------------------
+// ArchiveIndex
+// ----------------------------------------------------------------------------
+
+bool ArchiveIndex::open(const std::string& index_path) {
+    path_ = index_path;
+    if (!index_.open(index_path)) return false;
+    const uint8_t* h = reinterpret_cast<const uint8_t*>(index_.data());
+    if (index_.size() < ARCHIVE_HEADER_SIZE || std::memcmp(h, ARCHIVE_MAGIC, 4) != 0 ||
+        get<uint32_t>(h, 12) != ARCHIVE_RECORD_SIZE) {
+        std::cerr << "Error: Not an archive index: " << index_path << std::endl;
+        return false;
+    }
+    count_ = (index_.size() - ARCHIVE_HEADER_SIZE) / ARCHIVE_RECORD_SIZE;
+
+    // Names and seek tables; an index of records without any is valid
+    struct stat st;
+    const std::string blob_path = index_path + ARCHIVE_BLOB_SUFFIX;
+    if (stat(blob_path.c_str(), &st) == 0 && !blob_.open(blob_path)) return false;
+    return true;
+}
+
+const uint8_t* ArchiveIndex::record(size_t i) const {
+    return reinterpret_cast<const uint8_t*>(index_.data()) + ARCHIVE_HEADER_SIZE + i * ARCHIVE_RECORD_SIZE;
+}
+
+double ArchiveIndex::key_aos(size_t i) const {
+    return get<double>(record(i), 16);
+}
+
+double ArchiveIndex::aos_unix(size_t i) const {
+    return get<double>(record(i), 0);
+}
+
+// First record with key_aos >= key
+size_t ArchiveIndex::lower_bound(double key) const {
+    size_t lo = 0, hi = count_;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (key_aos(mid) < key) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+void ArchiveIndex::find(double from_unix, double to_unix, std::vector<size_t>& out) const {
+    if (count_ == 0) return;
+    // No record sits further behind the running maximum than this
+    const double late = get<double>(record(count_ - 1), 24);
+    for (size_t i = lower_bound(from_unix); i < count_ && key_aos(i) < to_unix + late; i++) {
+        double aos = aos_unix(i);
+        if (aos >= from_unix && aos < to_unix) out.push_back(i);
+    }
+}
+
+std::vector<size_t> ArchiveIndex::query(const ArchiveQuery& q) const {
+    std::vector<size_t> found, out;
+    find(q.from_unix, q.to_unix, found);
+    const std::string wanted = upper(q.satellite);
+    for (size_t i : found) {
+        const uint8_t* r = record(i);
+        if (get<float>(r, 72) < q.min_elevation_deg) continue;
+        if (q.decoded_only && !(get<uint32_t>(r, 88) & ARCHIVE_DECODED)) continue;
+        if (!wanted.empty()) {
+            const char* name = reinterpret_cast<const char*>(r + 128);
+            std::string satellite(name, strnlen(name, ARCHIVE_SATELLITE_LEN));
+            if (upper(satellite).find(wanted) == std::string::npos) continue;
+        }
+        out.push_back(i);
+    }
+    std::stable_sort(out.begin(), out.end(), [&](size_t a, size_t b) { return aos_unix(a) < aos_unix(b); });
+    if (q.limit > 0 && out.size() > q.limit) out.erase(out.begin(), out.end() - q.limit);
+    if (q.limit > 0) std::reverse(out.begin(), out.end());
+    return out;
+}
+
+void ArchiveIndex::covering(double utc, std::vector<size_t>& out) const {
+    std::vector<size_t> found;
+    find(utc - ARCHIVE_CAPTURE_MAX_SEC, utc + ARCHIVE_CAPTURE_MAX_SEC, found);
+    for (size_t i : found) {
+        const uint8_t* r = record(i);
+        double start = get<double>(r, 40);
+        uint32_t rate = get<uint32_t>(r, 64);
+        if (start <= 0.0 || rate == 0) continue;
+        if (utc >= start && utc < start + static_cast<double>(get<uint64_t>(r, 96)) / rate) out.push_back(i);
+    }
+}
+
+bool ArchiveIndex::entry(size_t i, ArchiveEntry& out, bool with_seek) const {
+    if (i >= count_) return false;
+    const uint8_t* r = record(i);
+    out = ArchiveEntry();
+    out.aos_unix = get<double>(r, 0);
+    out.los_unix = get<double>(r, 8);
+    out.tca_unix = get<double>(r, 32);
+    out.capture_start_utc = get<double>(r, 40);
+    out.indexed_unix = get<double>(r, 48);
+    out.freq_hz = get<double>(r, 56);
+    out.sample_rate = get<uint32_t>(r, 64);
+    out.norad_id = static_cast<int>(get<uint32_t>(r, 68));
+    out.max_elevation_deg = get<float>(r, 72);
+    out.snr_db = get<float>(r, 76);
+    out.sync_rate = get<float>(r, 80);
+    out.image_lines = get<uint32_t>(r, 84);
+    out.flags = get<uint32_t>(r, 88);
+    out.capture_samples = get<uint64_t>(r, 96);
+    const char* name = reinterpret_cast<const char*>(r + 128);
+    out.satellite.assign(name, strnlen(name, ARCHIVE_SATELLITE_LEN));
+
+    const uint32_t seek_count = get<uint32_t>(r, 92);
+    const uint64_t blob_offset = get<uint64_t>(r, 104);
+    size_t lengths[4], names = 0;
+    for (int k = 0; k < 4; k++) names += lengths[k] = get<uint32_t>(r, 112 + 4 * k);
+    const size_t table = pad8(blob_offset + names);
+    const size_t end = with_seek ? table + static_cast<size_t>(seek_count) * ARCHIVE_SEEK_POINT_SIZE
+                                 : blob_offset + names;
+    if (names == 0 && (!with_seek || seek_count == 0)) return true;
+    if (end > blob_.size()) {
+        std::cerr << "Error: Archive record " << i << " points past " << path_ << ARCHIVE_BLOB_SUFFIX << std::endl;
+        return false;
+    }
+
+    const char* p = blob_.data() + blob_offset;
+    std::string* fields[4] = {&out.capture_file, &out.image_file, &out.doppler_file, &out.source};
+    for (int k = 0; k < 4; k++) {
+        fields[k]->assign(p, lengths[k]);
+        p += lengths[k];
+    }
+    if (with_seek) {
+        const uint8_t* t = reinterpret_cast<const uint8_t*>(blob_.data() + table);
+        out.seek.resize(seek_count);
+        for (uint32_t k = 0; k < seek_count; k++, t += ARCHIVE_SEEK_POINT_SIZE) {
+            out.seek[k] = {get<double>(t, 0), get<uint64_t>(t, 8), get<uint64_t>(t, 16)};
+        }
+    }
+    return true;
+}
+
+bool ArchiveIndex::seek(size_t i, double utc, ArchiveSeek& out) const {
+    if (i >= count_) return false;
+    const uint8_t* r = record(i);
+    const double start = get<double>(r, 40);
+    const uint32_t rate = get<uint32_t>(r, 64);
+    const uint64_t samples = get<uint64_t>(r, 96);
+    if (start <= 0.0 || rate == 0 || utc < start || utc >= start + static_cast<double>(samples) / rate) {
+        return false;
+    }
+
+    if (!(get<uint32_t>(r, 88) & ARCHIVE_SGC)) {
+        out.sample = static_cast<uint64_t>((utc - start) * rate);
+        out.offset = out.sample * 2;
+        out.skip = 0;
+        return true;
+    }
+
+    // Last seek point at or before utc, straight from the mapped table
+    const uint32_t count = get<uint32_t>(r, 92);
+    const uint64_t blob_offset = get<uint64_t>(r, 104);
+    size_t names = 0;
+    for (int k = 0; k < 4; k++) names += get<uint32_t>(r, 112 + 4 * k);
+    const size_t table = pad8(blob_offset + names);
+    if (count == 0 || table + static_cast<size_t>(count) * ARCHIVE_SEEK_POINT_SIZE > blob_.size()) return false;
+    const uint8_t* points = reinterpret_cast<const uint8_t*>(blob_.data() + table);
+
+    size_t lo = 0, hi = count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (get<double>(points, mid * ARCHIVE_SEEK_POINT_SIZE) <= utc) lo = mid + 1;
+        else hi = mid;
+    }
+    const uint8_t* p = points + (lo > 0 ? lo - 1 : 0) * ARCHIVE_SEEK_POINT_SIZE;
+    const double point_utc = get<double>(p, 0);
+    out.skip = utc > point_utc ? static_cast<uint64_t>((utc - point_utc) * rate) : 0;
+    out.sample = get<uint64_t>(p, 8) + out.skip;
+    out.offset = get<uint64_t>(p, 16);
+    return true;
+}
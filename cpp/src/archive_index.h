@@ -0,0 +1,156 @@
+/*
+ * archive_index.h
+ * Satellite Ground Station - Time-indexed Capture Archive
+ *
+ * One fixed-size record per pass, appended by the capture pipeline as a
+ * pass finishes. History questions ("NOAA 18 above 40 deg since
+ * January") and seeks into a capture then read the index rather than
+ * mission_log.json and every *_metadata.json. Little-endian:
+ *
+ *   <index>        header  "SGIX" uint32 version, header_size (64),
+ *                          record_size (192), float64 created_utc
+ *                  records one per pass, in the order they were indexed
+ *   <index>.blob   per record: capture, image, Doppler profile and
+ *                  source names back to back, zero-padded to an 8-byte
+ *                  file offset, then the capture's seek table
+ *
+ * Record (192 bytes):
+ *   float64 aos_unix, los_unix, key_aos, key_late, tca_unix,
+ *           capture_start_utc, indexed_unix, freq_hz
+ *   uint32  sample_rate, norad_id
+ *   float32 max_elevation_deg, snr_db, sync_rate (NaN: not measured)
+ *   uint32  image_lines, flags, seek_count
+ *   uint64  capture_samples, blob_offset
+ *   uint32  capture, image, doppler, source name lengths
+ *   char    satellite[32], zero-padded
+ *   reserved to 192
+ *
+ * Seek point (24 bytes): float64 utc, uint64 sample, uint64 file offset
+ * of the .sgc frame holding it, one per second of capture and one after
+ * each gap. Raw I/Q needs none: a sample is at twice its index.
+ *
+ * Both files only grow, under flock, so readers map them while a pass is
+ * being indexed; a torn trailing record is ignored and cut off by the
+ * next writer. Records come in completion order, which is AOS order
+ * except where passes overlap or history is backfilled. key_aos is the
+ * running maximum of aos_unix and key_late the running maximum of
+ * key_aos - aos_unix. Both only grow, so a UTC range is a binary search
+ * on key_aos, widened by the last record's key_late.
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#ifndef SATGS_ARCHIVE_INDEX_H
+#define SATGS_ARCHIVE_INDEX_H
+
+#include "mapped_file.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#define ARCHIVE_MAGIC           "SGIX"
+#define ARCHIVE_VERSION         1
+#define ARCHIVE_HEADER_SIZE     64
+#define ARCHIVE_RECORD_SIZE     192
+#define ARCHIVE_SEEK_POINT_SIZE 24
+#define ARCHIVE_SEEK_STEP_SEC   1.0
+#define ARCHIVE_SATELLITE_LEN   32
+#define ARCHIVE_BLOB_SUFFIX     ".blob"
+
+#define ARCHIVE_CAPTURED        0x1     // Flags
+#define ARCHIVE_DECODED         0x2
+#define ARCHIVE_SGC             0x4     // Capture is .sgc (seek table present)
+
+struct ArchiveSeekPoint {
+    double utc = 0.0;
+    uint64_t sample = 0;
+    uint64_t offset = 0;
+};
+
+struct ArchiveEntry {
+    std::string satellite;
+    int norad_id = 0;
+    double aos_unix = 0.0;
+    double los_unix = 0.0;
+    double tca_unix = 0.0;
+    double max_elevation_deg = 0.0;
+    double freq_hz = 0.0;
+    double snr_db = NAN;                // Not measured
+    double sync_rate = NAN;
+    uint32_t image_lines = 0;
+    uint32_t flags = 0;
+
+    std::string capture_file;           // Empty: no I/Q kept
+    std::string image_file;
+    std::string doppler_file;
+    std::string source;                 // Tool that indexed the pass
+
+    // Where the capture's samples sit in time (0: unknown)
+    double capture_start_utc = 0.0;
+    uint32_t sample_rate = 0;
+    uint64_t capture_samples = 0;
+    std::vector<ArchiveSeekPoint> seek;
+
+    double indexed_unix = 0.0;          // Set by archive_append
+};
+
+// Capture start, rate, length and (for .sgc) seek table from the file;
+// a raw capture keeps the start_utc and rate it was given
+bool archive_describe_capture(const std::string& capture_file, uint32_t raw_rate, double raw_start_utc,
+                              ArchiveEntry& entry);
+
+// Append under an exclusive lock, creating the index when missing
+bool archive_append(const std::string& index_path, const std::vector<ArchiveEntry>& entries);
+
+struct ArchiveQuery {
+    std::string satellite;              // Substring, case-insensitive (empty: all)
+    double from_unix = -1e300;          // AOS in [from, to)
+    double to_unix = 1e300;
+    double min_elevation_deg = -90.0;
+    bool decoded_only = false;
+    size_t limit = 0;                   // Newest first when set (0: all)
+};
+
+// Where a UTC instant falls in a capture
+struct ArchiveSeek {
+    uint64_t sample = 0;                // From the start of the capture
+    uint64_t offset = 0;                // Byte to start reading (raw) or decoding (.sgc frame)
+    uint64_t skip = 0;                  // Samples from there to the instant
+};
+
+class ArchiveIndex {
+public:
+    bool open(const std::string& index_path);
+
+    size_t size() const { return count_; }
+
+    // Records with AOS in [from, to), in index order
+    void find(double from_unix, double to_unix, std::vector<size_t>& out) const;
+
+    // find() plus the filters, AOS order (newest first with a limit)
+    std::vector<size_t> query(const ArchiveQuery& q) const;
+
+    // Records whose capture covers utc
+    void covering(double utc, std::vector<size_t>& out) const;
+
+    bool entry(size_t i, ArchiveEntry& out, bool with_seek = false) const;
+    double aos_unix(size_t i) const;
+
+    bool seek(size_t i, double utc, ArchiveSeek& out) const;
+
+private:
+    const uint8_t* record(size_t i) const;
+    double key_aos(size_t i) const;
+    size_t lower_bound(double key) const;
+
+    MappedFile index_;
+    MappedFile blob_;
+    std::string path_;
+    size_t count_ = 0;
+};
+
+#endif // SATGS_ARCHIVE_INDEX_H
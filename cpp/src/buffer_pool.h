@@ -0,0 +1,186 @@
+/*
+ * buffer_pool.h
+ * Satellite Ground Station - Preallocated I/Q Buffer Pool
+ *
+ * Fixed set of page-aligned slabs allocated once at startup, shared
+ * between the libusb callback (producer) and the writer (consumer)
+ * through two single-producer/single-consumer lock-free rings of slab
+ * indices:
+ *
+ *   free ring:   writer   -> callback   (slabs ready to be filled)
+ *   BufferQueue: callback -> writer     (slabs holding I/Q data)
+ *
+ * The callback never allocates, locks or blocks. If no free slab is
+ * available every slab is still waiting on the writer, which is the
+ * overflow condition; the transfer is dropped and counted.
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#ifndef SATGS_BUFFER_POOL_H
+#define SATGS_BUFFER_POOL_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+#define SLAB_ALIGNMENT  4096    // Page aligned so slabs can feed O_DIRECT
+#define CACHE_LINE_SIZE 64
+
+// Lock-free single-producer/single-consumer ring.
+// Capacity is rounded up to a power of two; storage is allocated once.
+template <typename T>
+class SpscRing {
+public:
+    explicit SpscRing(size_t min_capacity) {
+        size_t capacity = 1;
+        while (capacity < min_capacity) capacity <<= 1;
+        slots_.resize(capacity);
+        mask_ = capacity - 1;
+    }
+
+    // Producer only
+    bool try_push(const T& value) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_.load(std::memory_order_acquire) > mask_) {
+            return false;  // Full
+        }
+        slots_[tail & mask_] = value;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only
+    bool try_pop(T& value) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_.load(std::memory_order_acquire)) {
+            return false;  // Empty
+        }
+        value = slots_[head & mask_];
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Approximate when called off the producer/consumer threads
+    size_t size() const {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+
+    size_t capacity() const { return mask_ + 1; }
+
+private:
+    std::vector<T> slots_;
+    size_t mask_;
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> head_{0};
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail_{0};
+};
+
+// Handle to a filled slab
+struct SlabRef {
+    uint32_t index;
+    uint32_t length;
+    uint64_t first_sample;  // Stream position of the slab's first I/Q pair
+    int64_t steady_ns;      // Arrival of the transfer (steady_clock)
+    double utc;             // ... and as Unix time
+};
+
+// Fixed pool of slabs plus the free-index ring
+class BufferPool {
+public:
+    BufferPool(size_t num_slabs, size_t slab_size)
+        : num_slabs_(num_slabs), slab_size_(slab_size), free_(num_slabs) {
+        void* mem = nullptr;
+        if (posix_memalign(&mem, SLAB_ALIGNMENT, num_slabs * slab_size) != 0) {
+            return;
+        }
+        memory_ = static_cast<uint8_t*>(mem);
+        // Touch every page now so the callback never takes a page fault
+        std::memset(memory_, 0, num_slabs * slab_size);
+        for (size_t i = 0; i < num_slabs; i++) {
+            free_.try_push(static_cast<uint32_t>(i));
+        }
+    }
+
+    ~BufferPool() { std::free(memory_); }
+
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    bool valid() const { return memory_ != nullptr; }
+
+    uint8_t* data(uint32_t index) { return memory_ + static_cast<size_t>(index) * slab_size_; }
+
+    size_t slab_size() const { return slab_size_; }
+    size_t num_slabs() const { return num_slabs_; }
+    size_t bytes() const { return num_slabs_ * slab_size_; }
+
+    // Slabs currently owned by the producer/consumer (not free)
+    size_t in_use() const { return num_slabs_ - free_.size(); }
+
+    // Producer side: take a free slab, false if the pool is exhausted
+    bool acquire(uint32_t& index) { return free_.try_pop(index); }
+
+    // Consumer side: return a slab once its contents are consumed
+    void release(uint32_t index) { free_.try_push(index); }
+
+private:
+    size_t num_slabs_;
+    size_t slab_size_;
+    uint8_t* memory_ = nullptr;
+    SpscRing<uint32_t> free_;
+};
+
+// Filled-slab queue from the callback to the writer.
+// push() is wait-free; pop() sleeps on a condition variable only when
+// the ring is empty, and the producer signals only if the consumer is
+// actually parked, so the hot path is one atomic store and one load.
+class BufferQueue {
+public:
+    explicit BufferQueue(size_t capacity) : ring_(capacity) {}
+
+    bool push(const SlabRef& ref) {
+        if (!ring_.try_push(ref)) return false;
+        if (waiting_.load(std::memory_order_seq_cst)) {
+            cv_.notify_one();
+        }
+        return true;
+    }
+
+    bool pop(SlabRef& ref, int timeout_ms = 1000) {
+        if (ring_.try_pop(ref)) return true;
+
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+        std::unique_lock<std::mutex> lock(mutex_);
+        waiting_.store(true, std::memory_order_seq_cst);
+        bool got = false;
+        while (!(got = ring_.try_pop(ref))) {
+            // Short slices bound the cost of a notify that raced the park
+            auto slice = std::chrono::steady_clock::now() + std::chrono::milliseconds(5);
+            if (slice > deadline) slice = deadline;
+            if (cv_.wait_until(lock, slice) == std::cv_status::timeout &&
+                std::chrono::steady_clock::now() >= deadline) {
+                got = ring_.try_pop(ref);
+                break;
+            }
+        }
+        waiting_.store(false, std::memory_order_relaxed);
+        return got;
+    }
+
+    size_t size() const { return ring_.size(); }
+    size_t capacity() const { return ring_.capacity(); }
+
+private:
+    SpscRing<SlabRef> ring_;
+    std::atomic<bool> waiting_{false};
+    std::mutex mutex_;
+    std::condition_variable cv_;
+};
+
+#endif // SATGS_BUFFER_POOL_H
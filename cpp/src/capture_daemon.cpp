@@ -0,0 +1,555 @@
+/*
+ * capture_daemon.cpp
+ * Satellite Ground Station - Multi-device Capture Daemon
+ *
+ * Streams several RTL-SDR dongles at once from one process, e.g. for
+ * overlapping NOAA 15/18/19 passes. Each device gets its own capture
+ * session (async reader, slab pool, DSP worker); all raw I/Q goes
+ * through one shared I/O thread so the dongles don't contend for the
+ * disk. With "pin_threads" the I/O thread takes core 0 and session i
+ * takes cores 1 + 2i (reader) and 2 + 2i (worker), wrapping around.
+ * "realtime" puts a session's USB reader (and then the shared I/O
+ * thread) on SCHED_FIFO and locks its slab pool in RAM where permitted.
+ * "source" (see sample_source.h) replaces a dongle with a replayed
+ * capture or the APT generator, e.g. to dry-run a job file.
+ * "metrics_port" (or -m) serves every session's counters and latency
+ * histograms for Prometheus (metrics.h). "channels" demodulates further
+ * carriers from a session's stream (the tuner stays at frequency_hz +
+ * offset_hz), so one dongle can cover the whole 137 MHz band.
+ * "waterfall" publishes a session's live spectrum for the HMI, with the
+ * --waterfall spec of rtlsdr_capture ("noaa19" or "noaa19,fft=4096").
+ * "track_carrier" closes the carrier loop of rtlsdr_capture --track-carrier
+ * ("fll_bandwidth_hz" sets its bandwidth) and "ppm" corrects a known tuner
+ * error; the top-level "ppm_store" is shared by all sessions, looked up
+ * per dongle at open and written back once every session has finished.
+ * "shed_load" is rtlsdr_capture --shed-load: true, or the raw I/Q
+ * decimation to fall back on before dropping it (e.g. 8).
+ *
+ * Job file (JSON); per-session keys override the top-level defaults:
+ *
+ *   {
+ *     "sample_rate": 2400000, "gain_db": 40, "duration_sec": 900,
+ *     "io": "direct", "inflight": 4, "prealloc": true, "pin_threads": true,
+ *     "realtime": true, "metrics_port": 9464, "calibrate_sec": 3,
+ *     "track_carrier": true, "ppm_store": "ppm.json", "shed_load": 8,
+ *     "sessions": [
+ *       {"name": "NOAA 15", "device": 0, "frequency_hz": 137620000,
+ *        "audio": "noaa15.wav", "image": "noaa15.png",
+ *        "profile": "noaa15.dpb", "offset_hz": 100000},
+ *       {"name": "NOAA 19", "device": 1, "frequency_hz": 137100000,
+ *        "output": "noaa19.bin", "duration_sec": 780, "waterfall": "noaa19"},
+ *       {"name": "Meteor", "device": 2, "frequency_hz": 137900000,
+ *        "output": "meteor.sgc", "format": "sgc", "compress_bits": 8,
+ *        "io": "stream", "prealloc": false},
+ *       {"name": "Replay", "source": "file:noaa18.sgc,speed=max",
+ *        "frequency_hz": 137912500, "audio": "noaa18.wav"},
+ *       {"name": "Band", "device": 3, "frequency_hz": 137100000,
+ *        "offset_hz": 400000, "audio": "noaa19.wav", "image": "noaa19.png",
+ *        "channels": [
+ *          {"name": "NOAA 18", "frequency_hz": 137912500, "audio": "noaa18.wav",
+ *           "image": "noaa18.png", "profile": "noaa18.dpb"},
+ *          {"name": "NOAA 15", "frequency_hz": 137620000, "audio": "noaa15.wav"}]}
+ *     ]
+ *   }
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <memory>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdlib>
+#include <getopt.h>
+
+#include "capture_session.h"
+#include "doppler_profile.h"
+#include "dsp_pipeline.h"
+#include "io_scheduler.h"
+#include "json_reader.h"
+#include "mapped_file.h"
+#include "ppm_store.h"
+#include "metrics.h"
+#include "thread_util.h"
+#include "waterfall_ring.h"
+
+#define MAX_SESSIONS 8
+
+// Global state
+static std::atomic<bool> g_running(true);
+
+void signal_handler(int signum) {
+    std::cerr << "\nSignal " << signum << " received, stopping all captures..." << std::endl;
+    g_running = false;
+}
+
+struct JobFile {
+    int io_core = -1;
+    int metrics_port = -1;                  // -1 = no endpoint
+    std::string ppm_store;                  // Empty = none
+    std::vector<CaptureConfig> sessions;
+    std::vector<std::string> profiles;      // Per session, empty = none
+    std::vector<std::vector<std::string>> channel_profiles;   // Per session and channel
+};
+
+// One entry of a session's "channels"
+static void read_channel(JsonReader& json, ChannelConfig& channel, std::string& profile) {
+    std::string_view key, text;
+    double value;
+    json.begin_object();
+    while (json.next_key(key)) {
+        if (key == "name" && json.peek() == '"' && json.read_string(text)) {
+            channel.label.assign(text);
+        } else if (key == "frequency_hz" && json.read_number(value)) {
+            channel.frequency = static_cast<uint32_t>(value);
+        } else if (key == "audio" && json.peek() == '"' && json.read_string(text)) {
+            channel.audio_filename.assign(text);
+        } else if (key == "image" && json.peek() == '"' && json.read_string(text)) {
+            channel.image_filename.assign(text);
+        } else if (key == "profile" && json.peek() == '"' && json.read_string(text)) {
+            profile.assign(text);
+        } else {
+            json.skip_value();
+        }
+    }
+}
+
+// Keys shared by the top level and each session
+static bool read_common_key(JsonReader& json, std::string_view key, CaptureConfig& config, bool& pin) {
+    double value;
+    std::string_view text;
+    if (key == "sample_rate" && json.read_number(value)) {
+        config.sample_rate = static_cast<uint32_t>(value);
+    } else if (key == "gain_db" && json.read_number(value)) {
+        config.gain = static_cast<int>(std::lround(value * 10));
+    } else if (key == "duration_sec" && json.read_number(value)) {
+        config.duration_sec = static_cast<int>(value);
+    } else if (key == "calibrate_sec" && json.read_number(value)) {
+        config.calibrate_sec = value;
+    } else if (key == "inflight" && json.read_number(value)) {
+        config.max_inflight = static_cast<int>(value);
+    } else if (key == "io" && json.peek() == '"' && json.read_string(text)) {
+        if (!parse_io_backend(std::string(text), config.backend)) {
+            std::cerr << "Error: Unknown I/O backend: " << text << "\n";
+            return false;
+        }
+    } else if (key == "source" && json.peek() == '"' && json.read_string(text)) {
+        config.source.assign(text);
+    } else if (key == "format" && json.peek() == '"' && json.read_string(text)) {
+        if (!parse_capture_format(std::string(text), config.format)) {
+            std::cerr << "Error: Unknown output format: " << text << "\n";
+            return false;
+        }
+    } else if (key == "fll_bandwidth_hz" && json.read_number(value)) {
+        config.fll_bandwidth_hz = value;
+    } else if (key == "ppm" && json.read_number(value)) {
+        config.ppm = value;
+        config.ppm_set = true;
+    } else if (key == "compress_bits" && json.read_number(value)) {
+        config.compress_bits = static_cast<int>(value);
+    } else if (key == "audio_format" && json.peek() == '"' && json.read_string(text)) {
+        if (!parse_audio_format(std::string(text), config.audio_format)) {
+            std::cerr << "Error: Unknown audio format: " << text << "\n";
+            return false;
+        }
+    } else if (key == "shed_load" && json.peek() == 'n' && json.read_number(value)) {
+        config.load.enabled = true;
+        config.load.raw_decimation = static_cast<int>(value);
+        if (config.load.raw_decimation < 2 || config.load.raw_decimation > LOAD_MAX_DECIMATION) {
+            std::cerr << "Error: shed_load decimation must be 2 to " << LOAD_MAX_DECIMATION << "\n";
+            return false;
+        }
+    } else if (key == "prealloc" || key == "iq_correct" || key == "pin_threads" || key == "realtime" ||
+               key == "track_carrier" || key == "shed_load") {
+        bool flag = json.peek() == 't';
+        json.skip_value();
+        if (key == "prealloc") config.preallocate = flag;
+        else if (key == "iq_correct") config.iq_correction = flag;
+        else if (key == "track_carrier") config.carrier_tracking = flag;
+        else if (key == "shed_load") config.load.enabled = flag;
+        else if (key == "pin_threads") pin = flag;
+        else {
+            config.reader_rt_priority = flag ? READER_RT_PRIORITY : 0;
+            config.lock_memory = flag;
+        }
+    } else {
+        json.skip_value();
+    }
+    return true;
+}
+
+// RTL-SDR device a session streams from; false for file and synth sources
+static bool rtlsdr_device(const CaptureConfig& config, int& device) {
+    const std::string& spec = config.source;
+    if (!spec.empty() && spec != "rtlsdr" && spec.compare(0, 7, "rtlsdr:") != 0) return false;
+    device = spec.size() > 7 ? std::atoi(spec.c_str() + 7) : config.device_index;
+    return true;
+}
+
+static bool load_job_file(const std::string& filename, JobFile& job) {
+    MappedFile file;
+    if (!file.open(filename)) {
+        std::cerr << "Error: Cannot load job file: " << filename << std::endl;
+        return false;
+    }
+
+    // Two passes so sessions inherit the top-level defaults wherever
+    // they appear in the file
+    CaptureConfig defaults;
+    bool pin = false;
+    for (int pass = 0; pass < 2; pass++) {
+        JsonReader json(file.data(), file.size());
+        std::string_view key, text;
+        double value;
+
+        json.begin_object();
+        while (json.next_key(key)) {
+            if (key != "sessions" || json.peek() != '[') {
+                if (pass == 0 && key == "metrics_port" && json.read_number(value)) {
+                    job.metrics_port = static_cast<int>(value);
+                } else if (pass == 0 && key == "ppm_store" && json.peek() == '"' && json.read_string(text)) {
+                    job.ppm_store.assign(text);
+                } else if (pass == 0) {
+                    if (!read_common_key(json, key, defaults, pin)) return false;
+                } else {
+                    json.skip_value();
+                }
+                continue;
+            }
+            if (pass == 0) {
+                json.skip_value();
+                continue;
+            }
+
+            json.begin_array();
+            while (json.next_element()) {
+                CaptureConfig c = defaults;
+                std::string profile;
+                std::vector<std::string> channel_profiles;
+                bool unused_pin = false;
+                json.begin_object();
+                while (json.next_key(key)) {
+                    if (key == "name" && json.peek() == '"' && json.read_string(text)) {
+                        c.label.assign(text);
+                    } else if (key == "device" && json.read_number(value)) {
+                        c.device_index = static_cast<int>(value);
+                    } else if (key == "frequency_hz" && json.read_number(value)) {
+                        c.frequency = static_cast<uint32_t>(value);
+                    } else if (key == "offset_hz" && json.read_number(value)) {
+                        c.tune_offset_hz = value;
+                    } else if (key == "output" && json.peek() == '"' && json.read_string(text)) {
+                        c.filename.assign(text);
+                    } else if (key == "audio" && json.peek() == '"' && json.read_string(text)) {
+                        c.audio_filename.assign(text);
+                    } else if (key == "image" && json.peek() == '"' && json.read_string(text)) {
+                        c.image_filename.assign(text);
+                    } else if (key == "profile" && json.peek() == '"' && json.read_string(text)) {
+                        profile.assign(text);
+                    } else if (key == "waterfall" && json.peek() == '"' && json.read_string(text)) {
+                        if (!parse_waterfall_spec(std::string(text), c.waterfall_name, c.spectrum)) {
+                            std::cerr << "Error: Bad waterfall spec: " << text << "\n";
+                            return false;
+                        }
+                    } else if (key == "channels" && json.peek() == '[') {
+                        json.begin_array();
+                        while (json.next_element()) {
+                            c.channels.emplace_back();
+                            channel_profiles.emplace_back();
+                            read_channel(json, c.channels.back(), channel_profiles.back());
+                        }
+                    } else if (!read_common_key(json, key, c, unused_pin)) {
+                        return false;
+                    }
+                }
+
+                size_t i = job.sessions.size();
+                if (c.label.empty()) c.label = "dev" + std::to_string(c.device_index);
+                if (pin) {
+                    c.reader_core = static_cast<int>(1 + 2 * i) % cpu_count();
+                    c.worker_core = static_cast<int>(2 + 2 * i) % cpu_count();
+                }
+                job.sessions.push_back(c);
+                job.profiles.push_back(profile);
+                job.channel_profiles.push_back(channel_profiles);
+            }
+        }
+
+        if (!json.ok()) {
+            std::cerr << "Error: Malformed job file at byte " << json.error_offset()
+                      << ": " << filename << std::endl;
+            return false;
+        }
+    }
+    if (pin) job.io_core = 0;
+    return true;
+}
+
+void print_usage(const char* progname) {
+    std::cout << "Usage: " << progname << " -c <jobs.json>\n"
+              << "\nOptions:\n"
+              << "  -c <file>      Job file listing one session per device (see source header)\n"
+              << "  -m <port>      Serve Prometheus metrics on http://" << METRICS_BIND_ADDRESS
+              << ":<port>/metrics (overrides \"metrics_port\")\n"
+              << "  -h             Show this help\n"
+              << "\nEach session streams its own RTL-SDR (or the \"source\" it names: a\n"
+              << "replayed capture or the APT generator); raw I/Q from all of them is\n"
+              << "written by one shared I/O thread.\n";
+}
+
+int main(int argc, char* argv[]) {
+    std::string job_file;
+    int metrics_port = -1;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "c:m:h")) != -1) {
+        switch (opt) {
+            case 'c':
+                job_file = optarg;
+                break;
+            case 'm':
+                metrics_port = std::stoi(optarg);
+                break;
+            case 'h':
+            default:
+                print_usage(argv[0]);
+                return (opt == 'h') ? 0 : 1;
+        }
+    }
+
+    if (job_file.empty()) {
+        std::cerr << "Error: Job file required (-c)\n";
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    JobFile job;
+    if (!load_job_file(job_file, job)) {
+        return 1;
+    }
+    if (metrics_port >= 0) {
+        job.metrics_port = metrics_port;
+    }
+    if (job.sessions.empty() || job.sessions.size() > MAX_SESSIONS) {
+        std::cerr << "Error: Job file must list 1 to " << MAX_SESSIONS << " sessions\n";
+        return 1;
+    }
+
+    // Validate everything before touching a device
+    std::vector<std::unique_ptr<DopplerProfile>> profiles(job.sessions.size());
+    std::vector<std::unique_ptr<DopplerProfile>> channel_profiles;
+    for (size_t i = 0; i < job.sessions.size(); i++) {
+        CaptureConfig& c = job.sessions[i];
+        if (c.filename.empty() && c.audio_filename.empty() && c.channels.empty()) {
+            std::cerr << "Error: " << c.label << ": needs \"output\", \"audio\" and/or \"channels\"\n";
+            return 1;
+        }
+        for (const ChannelConfig& channel : c.channels) {
+            if (channel.frequency == 0 || (channel.audio_filename.empty() && channel.image_filename.empty())) {
+                std::cerr << "Error: " << c.label << ": each channel needs \"frequency_hz\" and "
+                          << "\"audio\" and/or \"image\"\n";
+                return 1;
+            }
+        }
+        if ((!job.profiles[i].empty() || (c.tune_offset_hz != 0.0 && c.channels.empty())) &&
+            c.audio_filename.empty()) {
+            std::cerr << "Error: " << c.label << ": \"profile\" / \"offset_hz\" correct the "
+                      << "demodulated channel; set \"audio\"\n";
+            return 1;
+        }
+        if ((c.carrier_tracking || c.ppm_set) && c.audio_filename.empty() && c.channels.empty()) {
+            std::cerr << "Error: " << c.label << ": \"track_carrier\" / \"ppm\" act on the "
+                      << "demodulated channel; set \"audio\" or \"channels\"\n";
+            return 1;
+        }
+        if (c.carrier_tracking && (c.fll_bandwidth_hz <= 0.0 || c.fll_bandwidth_hz > 10.0)) {
+            std::cerr << "Error: " << c.label << ": \"fll_bandwidth_hz\" must be in (0, 10]\n";
+            return 1;
+        }
+        if (std::abs(c.ppm) > PPM_STORE_MAX) {
+            std::cerr << "Error: " << c.label << ": \"ppm\" must be within +/-" << PPM_STORE_MAX << "\n";
+            return 1;
+        }
+        if (!c.image_filename.empty() && c.audio_filename.empty()) {
+            std::cerr << "Error: " << c.label << ": \"image\" is decoded from the audio; set \"audio\"\n";
+            return 1;
+        }
+        if (c.compress_bits != 0 && (c.format != CaptureFormat::Sgc || c.compress_bits < 1 || c.compress_bits > 8)) {
+            std::cerr << "Error: " << c.label << ": \"compress_bits\" takes 1-8 and needs \"format\": \"sgc\"\n";
+            return 1;
+        }
+        if (c.format == CaptureFormat::Sgc && (c.backend != IoBackend::Stream || c.preallocate)) {
+            std::cerr << "Error: " << c.label << ": \"sgc\" output has its own writer; "
+                      << "\"io\" / \"prealloc\" apply to raw and sigmf\n";
+            return 1;
+        }
+        if (std::abs(c.tune_offset_hz) > c.sample_rate / 2.0 - DEMOD_CHANNEL_BW_HZ) {
+            std::cerr << "Error: " << c.label << ": offset must keep the channel inside +/-"
+                      << (c.sample_rate / 2.0 - DEMOD_CHANNEL_BW_HZ) / 1e3 << " kHz\n";
+            return 1;
+        }
+        if (!io_backend_available(c.backend)) {
+            std::cerr << "Error: I/O backend '" << io_backend_name(c.backend)
+                      << "' not available in this build\n";
+            return 1;
+        }
+        if (c.max_inflight < 1 || c.max_inflight > NUM_BUFFERS - 1) {
+            std::cerr << "Error: inflight must be between 1 and " << NUM_BUFFERS - 1 << "\n";
+            return 1;
+        }
+        int device, other;
+        for (size_t j = 0; j < i && rtlsdr_device(c, device); j++) {
+            if (rtlsdr_device(job.sessions[j], other) && other == device) {
+                std::cerr << "Error: Device " << device << " listed twice\n";
+                return 1;
+            }
+        }
+        for (size_t j = 0; j < i && !c.waterfall_name.empty(); j++) {
+            if (job.sessions[j].waterfall_name == c.waterfall_name) {
+                std::cerr << "Error: Waterfall \"" << c.waterfall_name << "\" used twice\n";
+                return 1;
+            }
+        }
+        if (!job.profiles[i].empty()) {
+            profiles[i].reset(new DopplerProfile());
+            if (!profiles[i]->load(job.profiles[i])) {
+                return 1;
+            }
+            c.doppler = profiles[i].get();
+        }
+        for (size_t k = 0; k < c.channels.size(); k++) {
+            if (job.channel_profiles[i][k].empty()) continue;
+            channel_profiles.emplace_back(new DopplerProfile());
+            if (!channel_profiles.back()->load(job.channel_profiles[i][k])) {
+                return 1;
+            }
+            c.channels[k].doppler = channel_profiles.back().get();
+        }
+    }
+
+    PpmStore ppm_store;
+    if (!job.ppm_store.empty()) {
+        if (!ppm_store.load(job.ppm_store)) {
+            return 1;
+        }
+        for (CaptureConfig& c : job.sessions) c.ppm_store = &ppm_store;
+    }
+
+    signal(SIGINT, signal_handler);
+    signal(SIGTERM, signal_handler);
+
+    IoScheduler io(job.io_core);
+    bool realtime = false;
+    for (const CaptureConfig& c : job.sessions) realtime = realtime || c.reader_rt_priority > 0;
+    if (realtime) {
+        io.set_realtime(IO_RT_PRIORITY);
+    }
+    std::vector<std::unique_ptr<CaptureSession>> sessions;
+    for (const CaptureConfig& c : job.sessions) {
+        sessions.emplace_back(new CaptureSession(c));
+        if (!sessions.back()->open(io)) {
+            return 1;
+        }
+    }
+
+    std::cout << "\nStarting " << sessions.size() << " capture session(s)...\n";
+    io.start();
+    for (auto& s : sessions) s->start();
+    if (realtime || job.io_core >= 0) {
+        std::cout << "Real-time:\n";
+        for (auto& s : sessions) s->print_placement(std::cout);
+        std::cout << "  I/O writer: " << describe_placement(io.placement()) << "\n";
+    }
+
+    MetricsServer metrics;
+    if (job.metrics_port >= 0) {
+        for (auto& s : sessions) {
+            const CaptureSession* session = s.get();
+            metrics.add_collector([session](MetricsWriter& out) { session->collect_metrics(out); });
+        }
+        if (!metrics.start(job.metrics_port)) {
+            g_running = false;
+        } else {
+            std::cout << "Metrics on http://" << METRICS_BIND_ADDRESS << ":" << metrics.port() << "/metrics\n";
+        }
+    }
+
+    // Aggregate progress until every session has reached its duration
+    auto start_time = std::chrono::steady_clock::now();
+    size_t active = sessions.size();
+    while (active > 0) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::steady_clock::now() - start_time).count();
+
+        CaptureStats total;
+        active = 0;
+        for (auto& s : sessions) {
+            // Sessions end themselves after duration_sec of samples; the
+            // wall clock backs that up for live sources
+            if (!g_running || (s->speed() == 1.0 && elapsed >= s->config().duration_sec + WALL_STOP_GRACE_SEC)) s->stop();
+            CaptureStats st = s->stats();
+            total.samples += st.samples;
+            total.bytes_written += st.bytes_written;
+            total.overflows += st.overflows;
+            total.gaps += st.gaps;
+            total.queued += st.queued;
+            active += s->running() ? 1 : 0;
+        }
+
+        double mb_written = total.bytes_written / 1e6;
+        std::cout << "\r[" << elapsed << "s] " << active << "/" << sessions.size() << " active, "
+                  << total.samples / 1000000 << "M samples, "
+                  << std::fixed << std::setprecision(1)
+                  << mb_written << " MB written ("
+                  << mb_written / (elapsed > 0 ? elapsed : 1) << " MB/s), "
+                  << "Queued: " << total.queued << ", "
+                  << "Overflows: " << total.overflows << ", "
+                  << "Gaps: " << total.gaps
+                  << "     " << std::flush;
+    }
+    std::cout << std::endl;
+
+    bool ok = true;
+    for (auto& s : sessions) {
+        ok = s->join() && ok;
+    }
+    metrics.stop();
+
+    // Every session has folded its estimate in by now
+    double learned;
+    bool any_learned = false;
+    for (auto& s : sessions) any_learned = s->learned_ppm(learned) || any_learned;
+    if (!job.ppm_store.empty() && any_learned && !ppm_store.save()) {
+        ok = false;
+    }
+
+    // Summary
+    std::cout << std::setprecision(2);
+    std::cout << "\n========================================\n";
+    std::cout << "Capture complete (" << sessions.size() << " devices)\n";
+    CaptureStats total;
+    for (auto& s : sessions) {
+        s->print_summary(std::cout);
+        CaptureStats st = s->stats();
+        total.samples += st.samples;
+        total.bytes_written += st.bytes_written;
+        total.overflows += st.overflows;
+        total.gaps += st.gaps;
+        total.gap_samples += st.gap_samples;
+    }
+    std::cout << "Total:\n";
+    std::cout << "  Samples:   " << total.samples << "\n";
+    std::cout << "  Written:   " << total.bytes_written / 1e6 << " MB\n";
+    std::cout << "  Overflows: " << total.overflows << " buffers dropped\n";
+    std::cout << "  Gaps:      " << total.gaps << " upstream (" << total.gap_samples << " samples lost)\n";
+    std::cout << "========================================\n";
+
+    return ok ? 0 : 1;
+}
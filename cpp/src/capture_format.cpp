@@ -0,0 +1,438 @@
+/*
+ * capture_format.cpp
+ * Satellite Ground Station - Capture File Formats
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#include "capture_format.h"
+#include "doppler_profile.h"
+#include "sgc_format.h"
+#include "thread_pool.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+bool parse_capture_format(const std::string& name, CaptureFormat& format) {
+    if (name == "raw") format = CaptureFormat::Raw;
+    else if (name == "sigmf") format = CaptureFormat::Sigmf;
+    else if (name == "sgc") format = CaptureFormat::Sgc;
+    else return false;
+    return true;
+}
+
+const char* capture_format_name(CaptureFormat format) {
+    switch (format) {
+        case CaptureFormat::Raw:   return "raw";
+        case CaptureFormat::Sigmf: return "sigmf";
+        case CaptureFormat::Sgc:   return "sgc";
+    }
+    return "unknown";
+}
+
+std::string sigmf_meta_path(const std::string& data_path) {
+    const std::string ext = ".sigmf-data";
+    if (data_path.size() > ext.size() &&
+        data_path.compare(data_path.size() - ext.size(), ext.size(), ext) == 0) {
+        return data_path.substr(0, data_path.size() - ext.size()) + ".sigmf-meta";
+    }
+    return data_path + ".sigmf-meta";
+}
+
+static double now_utc() {
+    return std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// ----------------------------------------------------------------------------
+// sigmf: any raw backend plus the sidecar
+// ----------------------------------------------------------------------------
+
+class SigmfWriter : public IQWriter {
+public:
+    SigmfWriter(std::unique_ptr<IQWriter> inner, const CaptureMetadata& metadata)
+        : inner_(std::move(inner)), meta_(metadata) {}
+
+    bool open(const std::string& path, uint64_t preallocate_bytes) override {
+        meta_path_ = sigmf_meta_path(path);
+        // Written up front too, so a capture that dies still says what it is
+        return inner_->open(path, preallocate_bytes) && write_meta();
+    }
+
+    bool submit(const uint8_t* data, uint32_t length, uint32_t tag, const IqFrameInfo& frame) override {
+        uint64_t samples = length / 2;
+        if (segments_.empty() || frame.first_sample != next_sample_) {
+            if (!segments_.empty()) {
+                gaps_.push_back({file_samples_, frame.first_sample - next_sample_});
+                dropped_ += frame.first_sample - next_sample_;
+            }
+            // Arrival time is the end of the transfer
+            segments_.push_back({file_samples_, frame.first_sample,
+                                 frame.utc - static_cast<double>(samples) / meta_.sample_rate});
+        }
+        next_sample_ = frame.first_sample + samples;
+        file_samples_ += samples;
+        return inner_->submit(data, length, tag, frame);
+    }
+
+    size_t reap(std::vector<uint32_t>& done, bool wait) override { return inner_->reap(done, wait); }
+
+    bool close(std::vector<uint32_t>& done) override {
+        bool ok = inner_->close(done);
+        return write_meta() && ok;
+    }
+
+    size_t inflight() const override { return inner_->inflight(); }
+    uint64_t bytes_written() const override { return inner_->bytes_written(); }
+    uint64_t buffered_writes() const override { return inner_->buffered_writes(); }
+
+private:
+    struct Segment {
+        uint64_t sample_start;      // In the file
+        uint64_t global_index;      // In the device stream
+        double utc;
+    };
+    struct Gap {
+        uint64_t sample_start;
+        uint64_t dropped;
+    };
+
+    bool write_meta() const;
+
+    std::unique_ptr<IQWriter> inner_;
+    CaptureMetadata meta_;
+    std::string meta_path_;
+    std::vector<Segment> segments_;
+    std::vector<Gap> gaps_;
+    uint64_t next_sample_ = 0;
+    uint64_t file_samples_ = 0;
+    uint64_t dropped_ = 0;
+};
+
+bool SigmfWriter::write_meta() const {
+    std::string tmp = meta_path_ + ".tmp";
+    FILE* f = std::fopen(tmp.c_str(), "w");
+    if (!f) {
+        std::cerr << "Error: Cannot write SigMF metadata: " << meta_path_ << std::endl;
+        return false;
+    }
+
+    std::fprintf(f, "{\n  \"global\": {\n");
+    std::fprintf(f, "    \"core:datatype\": \"cu8\",\n");
+    std::fprintf(f, "    \"core:sample_rate\": %u,\n", meta_.sample_rate);
+    std::fprintf(f, "    \"core:version\": \"1.0.0\",\n");
+    std::fprintf(f, "    \"core:hw\": \"%s (device %d)\",\n",
+                 meta_.hardware.empty() ? "RTL-SDR" : meta_.hardware.c_str(), meta_.device_index);
+    std::fprintf(f, "    \"core:recorder\": \"satgs rtlsdr_capture\",\n");
+    std::fprintf(f, "    \"core:extensions\": [{\"name\": \"satgs\", \"version\": \"1.0.0\", \"optional\": true}],\n");
+    std::fprintf(f, "    \"satgs:gain_db\": %.1f,\n", meta_.gain_tenth_db / 10.0);
+    std::fprintf(f, "    \"satgs:carrier_frequency\": %llu,\n",
+                 static_cast<unsigned long long>(meta_.carrier_freq_hz));
+    std::fprintf(f, "    \"satgs:dropped_samples\": %llu\n  },\n",
+                 static_cast<unsigned long long>(dropped_));
+
+    std::fprintf(f, "  \"captures\": [");
+    for (size_t i = 0; i < segments_.size(); i++) {
+        const Segment& s = segments_[i];
+        std::fprintf(f, "%s\n    {\"core:sample_start\": %llu, \"core:global_index\": %llu, "
+                     "\"core:frequency\": %llu, \"core:datetime\": \"%s\"}",
+                     i ? "," : "", static_cast<unsigned long long>(s.sample_start),
+                     static_cast<unsigned long long>(s.global_index),
+                     static_cast<unsigned long long>(meta_.center_freq_hz),
+                     format_utc_timestamp(s.utc).c_str());
+    }
+    std::fprintf(f, segments_.empty() ? "],\n" : "\n  ],\n");
+
+    std::fprintf(f, "  \"annotations\": [");
+    for (size_t i = 0; i < gaps_.size(); i++) {
+        const Gap& g = gaps_[i];
+        std::fprintf(f, "%s\n    {\"core:sample_start\": %llu, \"core:comment\": \"ring overflow\", "
+                     "\"satgs:dropped_samples\": %llu}",
+                     i ? "," : "", static_cast<unsigned long long>(g.sample_start),
+                     static_cast<unsigned long long>(g.dropped));
+    }
+    std::fprintf(f, gaps_.empty() ? "]\n}\n" : "\n  ]\n}\n");
+
+    bool ok = !std::ferror(f);
+    ok = (std::fclose(f) == 0) && ok;
+    if (!ok || std::rename(tmp.c_str(), meta_path_.c_str()) != 0) {
+        std::cerr << "Error: Failed writing SigMF metadata: " << meta_path_ << std::endl;
+        std::remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// sgc: container records, frames encoded on a worker pool
+// ----------------------------------------------------------------------------
+
+// Submitted frames are encoded concurrently but written, and their slabs
+// handed back, strictly in submission order from reap() on the I/O thread
+class SgcWriter : public IQWriter {
+public:
+    SgcWriter(const CaptureMetadata& metadata, int compress_bits, LatencyHistogram* latency)
+        : meta_(metadata), bits_(compress_bits), latency_(latency) {}
+
+    ~SgcWriter() override {
+        if (pool_) group_.wait();
+    }
+
+    bool open(const std::string& path, uint64_t preallocate_bytes) override;
+    bool submit(const uint8_t* data, uint32_t length, uint32_t tag, const IqFrameInfo& frame) override;
+    size_t reap(std::vector<uint32_t>& done, bool wait) override;
+    bool close(std::vector<uint32_t>& done) override;
+
+    size_t inflight() const override { return frames_inflight_; }
+    uint64_t bytes_written() const override { return bytes_; }
+
+private:
+    struct Job {
+        bool gap = false;
+        uint32_t tag = 0;
+        IqFrameInfo frame;
+        uint32_t num_samples = 0;
+        const uint8_t* data = nullptr;
+        std::vector<uint8_t> payload;   // Encoded frame (unused when stored raw)
+        uint8_t codec = SGC_CODEC_RAW;
+        uint8_t rice_k = 0;
+        bool ready = false;             // Guarded by mutex_
+        Clock::time_point submitted;
+    };
+
+    std::unique_ptr<Job> new_job();
+    void write_record(Job& job);
+    void drain(bool wait_front);
+
+    CaptureMetadata meta_;
+    int bits_;
+    LatencyHistogram* latency_;
+    std::ofstream out_;
+    bool failed_ = false;
+    uint64_t bytes_ = 0;
+
+    TaskGroup group_;
+    std::unique_ptr<ThreadPool> pool_;          // Declared after group_: joins first
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::unique_ptr<Job>> jobs_;
+    std::vector<std::unique_ptr<Job>> spare_;   // Keeps payload capacity between frames
+    size_t frames_inflight_ = 0;
+    std::vector<uint32_t> done_;
+
+    bool started_ = false;
+    uint64_t next_sample_ = 0;
+    std::vector<SgcEntry> index_;
+};
+
+bool SgcWriter::open(const std::string& path, uint64_t) {
+    // Compressed size isn't known up front, so no preallocation
+    out_.open(path, std::ios::binary | std::ios::out | std::ios::trunc);
+    if (!out_) return false;
+
+    SgcHeader header;
+    header.sample_rate = meta_.sample_rate;
+    header.center_freq_hz = meta_.center_freq_hz;
+    header.carrier_freq_hz = meta_.carrier_freq_hz;
+    header.gain_tenth_db = meta_.gain_tenth_db;
+    header.frame_samples = meta_.frame_samples;
+    header.created_utc = now_utc();
+    header.codec = bits_ > 0 ? SGC_CODEC_RICE : SGC_CODEC_RAW;
+    header.bits = bits_ > 0 ? static_cast<uint32_t>(bits_) : 8;
+    header.device_index = static_cast<uint32_t>(meta_.device_index);
+    uint8_t buf[SGC_HEADER_SIZE];
+    sgc_pack_header(header, buf);
+    out_.write(reinterpret_cast<const char*>(buf), sizeof(buf));
+    bytes_ = SGC_HEADER_SIZE;
+
+    if (bits_ > 0) pool_.reset(new ThreadPool(SGC_COMPRESS_THREADS));
+    return static_cast<bool>(out_);
+}
+
+std::unique_ptr<SgcWriter::Job> SgcWriter::new_job() {
+    if (spare_.empty()) return std::unique_ptr<Job>(new Job());
+    std::unique_ptr<Job> job = std::move(spare_.back());
+    spare_.pop_back();
+    std::vector<uint8_t> payload;
+    payload.swap(job->payload);
+    *job = Job();
+    job->payload.swap(payload);
+    return job;
+}
+
+bool SgcWriter::submit(const uint8_t* data, uint32_t length, uint32_t tag, const IqFrameInfo& frame) {
+    const uint32_t samples = length / 2;
+    const double frame_sec = static_cast<double>(samples) / meta_.sample_rate;
+
+    if (started_ && frame.first_sample > next_sample_) {
+        // Transfers dropped at the ring: say so instead of closing up
+        std::unique_ptr<Job> gap = new_job();
+        gap->gap = true;
+        gap->frame.first_sample = next_sample_;
+        gap->frame.utc = frame.utc - frame_sec;
+        gap->frame.steady_ns = frame.steady_ns;
+        gap->num_samples = static_cast<uint32_t>(frame.first_sample - next_sample_);
+        gap->ready = true;
+        jobs_.push_back(std::move(gap));
+    }
+    started_ = true;
+    next_sample_ = frame.first_sample + samples;
+
+    std::unique_ptr<Job> job = new_job();
+    job->tag = tag;
+    job->frame = frame;
+    job->num_samples = samples;
+    job->data = data;
+    job->submitted = Clock::now();
+    Job* raw = job.get();
+    if (!pool_) {
+        job->ready = true;
+    }
+    jobs_.push_back(std::move(job));
+    frames_inflight_++;
+
+    if (pool_) {
+        const int bits = bits_;
+        pool_->submit(group_, [this, raw, bits, length]() {
+            sgc_encode(raw->data, length, bits, raw->payload, raw->codec, raw->rice_k);
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                raw->ready = true;
+            }
+            cv_.notify_all();
+        });
+    }
+
+    drain(false);
+    return !failed_;
+}
+
+void SgcWriter::write_record(Job& job) {
+    SgcEntry entry;
+    entry.offset = bytes_;
+    entry.first_sample = job.frame.first_sample;
+    entry.num_samples = job.num_samples;
+    entry.gap = job.gap;
+    entry.utc = job.frame.utc;
+    index_.push_back(entry);
+
+    const uint8_t* payload = nullptr;
+    uint32_t payload_bytes = 0;
+    uint8_t bits = static_cast<uint8_t>(bits_ > 0 ? bits_ : 8);
+    if (!job.gap) {
+        if (pool_) {
+            payload = job.payload.data();
+            payload_bytes = static_cast<uint32_t>(job.payload.size());
+        } else {
+            payload = job.data;
+            payload_bytes = job.num_samples * 2;
+        }
+    }
+
+    uint8_t header[SGC_RECORD_SIZE];
+    sgc_pack_record(job.gap ? SGC_RECORD_GAP : SGC_RECORD_FRAME, payload_bytes,
+                    job.frame.first_sample, job.num_samples, job.codec, bits, job.rice_k,
+                    job.frame.utc, job.frame.steady_ns, header);
+    out_.write(reinterpret_cast<const char*>(header), sizeof(header));
+    if (payload_bytes) out_.write(reinterpret_cast<const char*>(payload), payload_bytes);
+    if (!out_) failed_ = true;
+    bytes_ += SGC_RECORD_SIZE + payload_bytes;
+}
+
+// Write every finished job at the head of the queue, optionally waiting
+// for the first one
+void SgcWriter::drain(bool wait_front) {
+    while (!jobs_.empty()) {
+        Job& job = *jobs_.front();
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (wait_front) {
+                cv_.wait(lock, [&job]() { return job.ready; });
+            } else if (!job.ready) {
+                return;
+            }
+        }
+        write_record(job);
+        if (!job.gap) {
+            if (latency_) {
+                latency_->record(static_cast<uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - job.submitted).count()));
+            }
+            done_.push_back(job.tag);
+            frames_inflight_--;
+            wait_front = false;
+        }
+        spare_.push_back(std::move(jobs_.front()));
+        jobs_.pop_front();
+    }
+}
+
+size_t SgcWriter::reap(std::vector<uint32_t>& done, bool wait) {
+    drain(wait && frames_inflight_ > 0);
+    size_t n = done_.size();
+    done.insert(done.end(), done_.begin(), done_.end());
+    done_.clear();
+    return n;
+}
+
+bool SgcWriter::close(std::vector<uint32_t>& done) {
+    while (frames_inflight_ > 0 || !jobs_.empty()) drain(true);
+    reap(done, false);
+
+    // Index of every record, then the trailer pointing at it
+    uint64_t index_offset = bytes_;
+    uint32_t payload = static_cast<uint32_t>(index_.size() * SGC_INDEX_ENTRY);
+    uint8_t header[SGC_RECORD_SIZE];
+    sgc_pack_record(SGC_RECORD_INDEX, payload, 0, static_cast<uint32_t>(index_.size()),
+                    0, 0, 0, now_utc(), 0, header);
+    out_.write(reinterpret_cast<const char*>(header), sizeof(header));
+    std::vector<uint8_t> entries(payload);
+    for (size_t i = 0; i < index_.size(); i++) {
+        uint8_t* e = &entries[i * SGC_INDEX_ENTRY];
+        uint32_t gap = index_[i].gap ? 1 : 0;
+        std::memcpy(e, &index_[i].offset, 8);
+        std::memcpy(e + 8, &index_[i].first_sample, 8);
+        std::memcpy(e + 16, &index_[i].utc, 8);
+        std::memcpy(e + 24, &index_[i].num_samples, 4);
+        std::memcpy(e + 28, &gap, 4);
+    }
+    out_.write(reinterpret_cast<const char*>(entries.data()), payload);
+
+    uint8_t trailer[SGC_TRAILER_SIZE];
+    uint32_t count = static_cast<uint32_t>(index_.size());
+    std::memcpy(trailer, SGC_TRAILER_MAGIC, 4);
+    std::memcpy(trailer + 4, &count, 4);
+    std::memcpy(trailer + 8, &index_offset, 8);
+    out_.write(reinterpret_cast<const char*>(trailer), sizeof(trailer));
+    bytes_ += SGC_RECORD_SIZE + payload + SGC_TRAILER_SIZE;
+
+    out_.close();
+    return !failed_ && !out_.fail();
+}
+
+std::unique_ptr<IQWriter> create_capture_writer(CaptureFormat format, IoBackend backend,
+                                                int max_inflight, LatencyHistogram* latency,
+                                                const CaptureMetadata& metadata,
+                                                int compress_bits) {
+    switch (format) {
+        case CaptureFormat::Raw:
+            return create_iq_writer(backend, max_inflight, latency);
+        case CaptureFormat::Sigmf: {
+            std::unique_ptr<IQWriter> inner = create_iq_writer(backend, max_inflight, latency);
+            if (!inner) return nullptr;
+            return std::unique_ptr<IQWriter>(new SigmfWriter(std::move(inner), metadata));
+        }
+        case CaptureFormat::Sgc:
+            return std::unique_ptr<IQWriter>(new SgcWriter(metadata, compress_bits, latency));
+    }
+    return nullptr;
+}
@@ -0,0 +1,62 @@
+/*
+ * capture_format.h
+ * Satellite Ground Station - Capture File Formats
+ *
+ * What rtlsdr_capture -o writes, on top of the disk backends of
+ * iq_writer.h:
+ *
+ *   raw    - bare u8 I/Q, as before
+ *   sigmf  - the same bytes plus a SigMF <name>.sigmf-meta sidecar:
+ *            rate, tuning and hardware, one capture segment per run of
+ *            contiguous samples (with its UTC start) and an annotation
+ *            for every ring overflow
+ *   sgc    - the chunked container of sgc_format.h, optionally Rice-
+ *            coded / bit-depth reduced on a small worker pool so the
+ *            I/O thread only ever writes
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#ifndef SATGS_CAPTURE_FORMAT_H
+#define SATGS_CAPTURE_FORMAT_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "iq_writer.h"
+
+#define SGC_COMPRESS_THREADS 2      // Encoder threads per .sgc capture
+
+enum class CaptureFormat {
+    Raw,
+    Sigmf,
+    Sgc
+};
+
+bool parse_capture_format(const std::string& name, CaptureFormat& format);
+const char* capture_format_name(CaptureFormat format);
+
+// Recording parameters the self-describing formats store
+struct CaptureMetadata {
+    uint32_t sample_rate = 0;
+    uint64_t center_freq_hz = 0;    // Tuner center as reported by the device
+    uint64_t carrier_freq_hz = 0;   // Signal of interest
+    int gain_tenth_db = 0;
+    int device_index = 0;
+    std::string hardware;           // Device name
+    uint32_t frame_samples = 0;     // Nominal samples per transfer
+};
+
+// compress_bits (sgc only): 0 stores frames raw, 8 Rice-codes them
+// losslessly, 1-7 keeps that many bits per component first
+std::unique_ptr<IQWriter> create_capture_writer(CaptureFormat format, IoBackend backend,
+                                                int max_inflight, LatencyHistogram* latency,
+                                                const CaptureMetadata& metadata,
+                                                int compress_bits = 0);
+
+// <name>.sigmf-meta for <name>.sigmf-data (or <path>.sigmf-meta otherwise)
+std::string sigmf_meta_path(const std::string& data_path);
+
+#endif // SATGS_CAPTURE_FORMAT_H
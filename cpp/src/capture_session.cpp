@@ -0,0 +1,1414 @@
+/*
+ * capture_session.cpp
+ * Satellite Ground Station - Per-device Capture Session
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#include "capture_session.h"
+#include "apt_decoder.h"
+#include "channelizer.h"
+#include "device_pool.h"
+#include "dsp_pipeline.h"
+#include "io_scheduler.h"
+#include "metrics.h"
+#include "ppm_store.h"
+#include "thread_pool.h"
+#include "thread_util.h"
+#include "waterfall_ring.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#define CONTINUITY_WINDOW       16      // Transfers per lag minimum
+#define CONTINUITY_MIN_GAP_SEC  0.005   // Smallest step reported as a gap
+#define CALIBRATE_DSP_TRANSFERS 8       // Trial transfers timed through the demodulator
+#define DSP_LOAD_WARNING        0.8     // Share of real time that leaves no headroom
+#define WATERFALL_HISTORY_SEC   60      // Rows kept in the ring, in seconds
+#define SPECTRUM_POLL_US        2000    // Spectrum thread's wait for a pending row
+#define SPECTRUM_NICE           10      // ... and how far it yields to the capture threads
+#define LOWRATE_PASSBAND        0.35    // Decimated raw: flat to this share of its rate ...
+#define LOWRATE_STOPBAND        0.65    // ... and aliasing only from beyond this into the edges
+#define LOWRATE_CARRIER_MARGIN_HZ 25000.0 // APT signal either side of the carrier
+
+// One demodulated carrier, from its slice of the stream to WAV and
+// image. Its demodulator runs on the worker or a pool thread, one slab
+// at a time; the decode thread drains its audio ring.
+struct alignas(CACHE_LINE_SIZE) DemodChannel {
+    ChannelConfig config;
+    bool primary = false;                 // The session's own carrier (config_.frequency)
+    double offset_hz = 0.0;               // Carrier minus the centre of the chain's input
+    double profile_start = 0.0;           // Profile time of the first sample
+    bool profile_aligned = false;
+    uint64_t next_sample = 0;             // Stream position after the last slab
+
+    DemodPipeline demod;
+    WavWriter wav;
+    std::unique_ptr<AptDecoder> apt;
+    std::unique_ptr<AptImage> image;
+    std::vector<float> audio;
+
+    // Audio blocks to the decoder, same pool + queue scheme as the slabs
+    // (float samples, SlabRef::length = count)
+    std::unique_ptr<BufferPool> audio_pool;
+    std::unique_ptr<BufferQueue> audio_queue;
+    size_t audio_block_samples = 0;
+    std::thread decoder;
+    std::chrono::steady_clock::time_point image_done;
+
+    std::atomic<uint64_t> audio_samples{0};
+    std::atomic<uint64_t> image_lines{0};
+    std::atomic<uint64_t> decode_stalls{0};
+    std::atomic<double> doppler_hz{0.0};
+
+    // Carrier loop, published per slab; the pass totals are worker only
+    std::atomic<double> carrier_error_hz{0.0};
+    std::atomic<double> carrier_correction_hz{0.0};
+    std::atomic<bool> carrier_locked{false};
+    double measured_sec = 0.0;
+    double locked_sec = 0.0;
+    double error_sq_sum = 0.0;            // Over locked slabs, weighted by length
+    double open_loop_sum = 0.0;           // Offset before the loop (error - correction), ditto
+};
+
+CaptureSession::CaptureSession(const CaptureConfig& config) : config_(config) {}
+
+std::string lowrate_capture_path(const std::string& filename) {
+    size_t slash = filename.find_last_of('/');
+    size_t dot = filename.find_last_of('.');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) dot = filename.size();
+    return filename.substr(0, dot) + ".lowrate" + filename.substr(dot);
+}
+
+CaptureSession::~CaptureSession() {
+    if (reader_.joinable() || worker_.joinable()) {
+        stop();
+        join();
+    }
+    if (source_) source_->close();
+}
+
+// heading for multi-session output; empty label keeps the single-device text
+static std::string heading(const std::string& label, const char* title) {
+    return label.empty() ? std::string(title) + ":" : std::string(title) + " (" + label + "):";
+}
+
+// "137.9125 MHz": channel plans are on 2.5 kHz steps
+static std::string frequency_mhz(uint32_t hz) {
+    std::ostringstream text;
+    text << std::fixed << std::setprecision(4) << hz / 1e6 << " MHz";
+    return text.str();
+}
+
+bool CaptureSession::open(IoScheduler& io) {
+    source_ = config_.device_pool
+        ? config_.device_pool->acquire(config_.source, config_.device_index, config_.frequency)
+        : create_sample_source(config_.source, config_.device_index, config_.frequency);
+    if (!source_ || !source_->open()) {
+        source_.reset();
+        return false;
+    }
+    std::cout << "Using " << source_->name() << "\n";
+
+    source_->set_sample_rate(config_.sample_rate);
+    // Fixed for the whole capture; Doppler is corrected in software
+    source_->set_center_freq(static_cast<uint32_t>(std::lround(config_.frequency + config_.tune_offset_hz)));
+    source_->set_gain(config_.gain);
+
+    // A replayed capture keeps the rate it was recorded at
+    if (source_->sample_rate() != 0 && source_->sample_rate() != config_.sample_rate) {
+        std::cout << "Note: Source runs at " << source_->sample_rate() / 1e6 << " MS/s\n";
+        config_.sample_rate = source_->sample_rate();
+    }
+    if (config_.load.enabled && (source_->lossless() || source_->speed() <= 0.0)) {
+        std::cout << "Note: Lossless source, load shedding is off\n";
+        config_.load.enabled = false;
+    }
+    if (config_.calibrate_sec > 0.0 && !calibrate()) {
+        return false;
+    }
+    pool_.reset(new BufferPool(config_.num_buffers, config_.buffer_size));
+    queue_.reset(new BufferQueue(config_.num_buffers));
+    if (!pool_->valid()) {
+        std::cerr << "Error: Failed to allocate " << config_.num_buffers << " x "
+                  << config_.buffer_size << " byte buffer pool\n";
+        return false;
+    }
+    // The pages are already touched; locking keeps them from being paged
+    // out under memory pressure mid-pass
+    if (config_.lock_memory) {
+        memory_lock_ = lock_memory(pool_->data(0), pool_->bytes(), memory_lock_error_);
+        if (memory_lock_ == MemoryLock::None) {
+            std::cerr << "Warning: Could not lock the buffer pool in memory: "
+                      << std::strerror(memory_lock_error_) << " (raise the memlock limit)" << std::endl;
+        }
+    }
+
+    // Known tuner error, taken out by every channel's NCO
+    device_id_ = source_->device_id();
+    if (config_.ppm_set) {
+        ppm_applied_ = config_.ppm;
+    } else if (config_.ppm_store && config_.ppm_store->lookup(device_id_, ppm_applied_)) {
+        ppm_from_store_ = true;
+    }
+    uint32_t tuned = source_->center_freq();
+    tuner_hz_ = tuned ? tuned : config_.frequency + config_.tune_offset_hz;
+    ppm_shift_hz_ = ppm_applied_ * 1e-6 * tuner_hz_;
+
+    print_config(std::cout);
+
+    // Verify settings
+    std::cout << "\n" << heading(config_.label, "Actual settings") << "\n";
+    std::cout << "  Frequency:   " << source_->center_freq() / 1e6 << " MHz\n";
+    std::cout << "  Sample rate: " << source_->sample_rate() / 1e6 << " MS/s\n";
+    std::cout << "  Gain:        " << source_->gain() / 10.0 << " dB\n";
+    if (source_->speed() != 1.0) {
+        std::cout << "  Speed:       ";
+        if (source_->lossless()) std::cout << "max (lossless)\n";
+        else std::cout << source_->speed() << "x real time\n";
+    }
+
+    if (config_.doppler || config_.tune_offset_hz != 0.0) {
+        // Use the center the tuner actually reports so PLL rounding is corrected too
+        uint32_t tuned = source_->center_freq();
+        carrier_offset_hz_ = static_cast<double>(config_.frequency) -
+            (tuned ? tuned : config_.frequency + config_.tune_offset_hz);
+    }
+
+    if (!config_.filename.empty()) {
+        CaptureMetadata metadata;
+        metadata.sample_rate = source_->sample_rate();
+        metadata.center_freq_hz = source_->center_freq();
+        metadata.carrier_freq_hz = config_.frequency;
+        metadata.gain_tenth_db = source_->gain();
+        metadata.device_index = config_.device_index;
+        metadata.hardware = source_->name();
+        metadata.frame_samples = config_.buffer_size / 2;
+        std::unique_ptr<IQWriter> writer = create_capture_writer(
+            config_.format, config_.backend, config_.max_inflight, &write_latency_, metadata,
+            config_.compress_bits);
+        uint64_t prealloc = config_.preallocate
+            ? static_cast<uint64_t>(config_.sample_rate) * config_.duration_sec * 2 : 0;
+        if (!writer || !writer->open(config_.filename, prealloc)) {
+            std::cerr << "Error: Cannot open output file: " << config_.filename << std::endl;
+            return false;
+        }
+        io_channel_ = io.add_channel(std::move(writer), pool_.get(), config_.max_inflight, config_.filename);
+        if (io_channel_ < 0) {
+            std::cerr << "Error: I/O scheduler already running" << std::endl;
+            return false;
+        }
+        io_ = &io;
+        if (config_.load.enabled && config_.load.raw_decimation > 1 && !open_lowrate(io, metadata)) {
+            config_.load.raw_decimation = 0;
+        }
+    }
+
+    if (!config_.waterfall_name.empty()) {
+        uint32_t tuned = source_->center_freq();
+        uint64_t center = tuned ? tuned : static_cast<uint64_t>(std::llround(config_.frequency + config_.tune_offset_hz));
+        uint32_t rows = static_cast<uint32_t>(std::max(16.0, std::ceil(config_.spectrum.row_rate * WATERFALL_HISTORY_SEC)));
+        spectrum_.reset(new SpectrumAnalyzer());
+        waterfall_.reset(new WaterfallPublisher());
+        if (!spectrum_->configure(config_.spectrum) ||
+            !waterfall_->open(config_.waterfall_name, config_.spectrum, center, config_.frequency,
+                              config_.sample_rate, rows)) {
+            return false;
+        }
+        spectrum_input_.resize(spectrum_->samples_per_row() * 2);
+    }
+
+    if (!open_channels()) return false;
+    load_.configure(config_.load, waterfall_ != nullptr, io_channel_ >= 0, channels_.size() > 1);
+    return true;
+}
+
+// Sidecar for the Decimated load step, in the capture's own format: the
+// middle 1/D of the band around the tuner center
+bool CaptureSession::open_lowrate(IoScheduler& io, CaptureMetadata metadata) {
+    int d = config_.load.raw_decimation;
+    if (d > LOAD_MAX_DECIMATION || config_.sample_rate % d != 0) {
+        std::cerr << "Warning: Raw decimation " << d << " does not divide " << config_.sample_rate
+                  << " S/s; load shedding goes straight to no raw I/Q" << std::endl;
+        return false;
+    }
+    double rate = config_.sample_rate / d;
+    if (std::abs(carrier_offset_hz_) + LOWRATE_CARRIER_MARGIN_HZ > LOWRATE_PASSBAND * rate) {
+        std::cerr << "Warning: The carrier is " << std::abs(carrier_offset_hz_) / 1e3
+                  << " kHz off the tuner center, outside the decimated raw band" << std::endl;
+    }
+    metadata.sample_rate = config_.sample_rate / d;
+    metadata.frame_samples = config_.buffer_size / 2 / d;
+    lowrate_filename_ = lowrate_capture_path(config_.filename);
+    // Small frames and a light stream: no O_DIRECT alignment to meet
+    std::unique_ptr<IQWriter> writer = create_capture_writer(config_.format, IoBackend::Stream, 1, nullptr,
+                                                             metadata, config_.compress_bits);
+    if (!writer || !writer->open(lowrate_filename_, 0)) {
+        std::cerr << "Error: Cannot open output file: " << lowrate_filename_ << std::endl;
+        return false;
+    }
+    lowrate_pool_.reset(new BufferPool(config_.num_buffers, (config_.buffer_size / 2 / d + 1) * 2));
+    if (!lowrate_pool_->valid()) {
+        std::cerr << "Error: Failed to allocate the decimated raw buffer pool" << std::endl;
+        return false;
+    }
+    lowrate_channel_ = io.add_channel(std::move(writer), lowrate_pool_.get(), 1, lowrate_filename_);
+    if (lowrate_channel_ < 0) return false;
+
+    double stop = LOWRATE_STOPBAND * rate;
+    lowrate_fir_.configure(design_lowpass(config_.sample_rate, (LOWRATE_PASSBAND * rate + stop) / 2.0,
+                                          lowpass_num_taps(config_.sample_rate, stop - LOWRATE_PASSBAND * rate)),
+                           d);
+    lowrate_decimation_ = d;
+    return true;
+}
+
+std::string CaptureSession::channel_name(const DemodChannel& channel) const {
+    return channel.config.label.empty() ? frequency_mhz(channel.config.frequency) : channel.config.label;
+}
+
+// The primary carrier (if anything is decoded from it) and the further
+// ones, each with its chain, outputs and decoder ring. The image is
+// decoded from the audio, which need not be kept.
+bool CaptureSession::open_channels() {
+    if (!config_.audio_filename.empty() || !config_.image_filename.empty()) {
+        std::unique_ptr<DemodChannel> primary(new DemodChannel());
+        primary->config.frequency = config_.frequency;
+        primary->config.audio_filename = config_.audio_filename;
+        primary->config.image_filename = config_.image_filename;
+        primary->config.doppler = config_.doppler;
+        primary->primary = true;
+        primary->offset_hz = carrier_offset_hz_;
+        primary->profile_start = config_.profile_start_sec;
+        channels_.push_back(std::move(primary));
+    }
+    for (const ChannelConfig& channel : config_.channels) {
+        channels_.emplace_back(new DemodChannel());
+        channels_.back()->config = channel;
+    }
+    if (channels_.empty()) return true;
+
+    uint32_t demod_rate = config_.sample_rate;
+    if (!config_.channels.empty()) {
+        // Offsets from the center the tuner actually reports; what the
+        // bin grid leaves over goes to each channel's NCO
+        uint32_t tuned = source_->center_freq();
+        double center = tuned ? tuned : std::round(config_.frequency + config_.tune_offset_hz);
+        std::vector<double> offsets;
+        for (const auto& channel : channels_) offsets.push_back(channel->config.frequency - center);
+        channelizer_.reset(new Channelizer());
+        if (!channelizer_->configure(config_.sample_rate, offsets, DEMOD_CHANNEL_BW_HZ, config_.iq_correction)) {
+            return false;
+        }
+        for (size_t c = 0; c < channels_.size(); c++) {
+            channels_[c]->offset_hz = offsets[c] - channelizer_->channel_center_hz(c);
+        }
+        demod_rate = channelizer_->output_rate();
+        std::cout << "  Channelizer: " << channels_.size() << " x " << demod_rate / 1e3 << " kHz ("
+                  << channelizer_->fft_size() << "-point FFT, " << channelizer_->num_taps() << " taps)\n";
+    }
+
+    for (const auto& channel : channels_) {
+        DemodChannel& ch = *channel;
+        DemodConfig demod_config;
+        demod_config.input_rate = demod_rate;
+        demod_config.iq_correction = config_.iq_correction && !channelizer_;
+        demod_config.carrier_tracking = config_.carrier_tracking;
+        demod_config.fll_bandwidth_hz = config_.fll_bandwidth_hz;
+        if (!ch.demod.configure(demod_config) ||
+            (!ch.config.audio_filename.empty() &&
+             !ch.wav.open(ch.config.audio_filename, ch.demod.audio_rate(), config_.audio_format))) {
+            std::cerr << "Error: Cannot open audio output: " << ch.config.audio_filename << std::endl;
+            return false;
+        }
+        if (ch.config.image_filename.empty()) continue;
+        ch.apt.reset(new AptDecoder());
+        ch.image.reset(new AptImage());
+        if (!ch.apt->configure(ch.demod.audio_rate())) {
+            std::cerr << "Error: Audio rate too low for APT decoding" << std::endl;
+            return false;
+        }
+        // One transfer's audio per block, with headroom for resampler phase
+        ch.audio_block_samples = static_cast<size_t>(
+            static_cast<uint64_t>(config_.buffer_size / 2) * ch.demod.audio_rate() / config_.sample_rate) + 64;
+        ch.audio_pool.reset(new BufferPool(APT_AUDIO_BLOCKS, ch.audio_block_samples * sizeof(float)));
+        ch.audio_queue.reset(new BufferQueue(APT_AUDIO_BLOCKS));
+        if (!ch.audio_pool->valid()) {
+            std::cerr << "Error: Failed to allocate the decoder's audio blocks" << std::endl;
+            return false;
+        }
+        ch.audio.reserve(ch.audio_block_samples);
+    }
+    return true;
+}
+
+bool CaptureSession::start() {
+    if (!source_ || reader_.joinable()) return false;
+    sample_limit_ = static_cast<uint64_t>(config_.sample_rate) * config_.duration_sec;
+    running_ = true;
+    wall_start_ = wall_end_ = scrape_time_ = std::chrono::steady_clock::now();
+    stream_done_ = false;
+    stream_start_utc_ = 0.0;
+    gate_open_ = start_at_utc_ <= 0.0;
+    first_transfer_utc_ = 0.0;
+    start_lag_sec_ = -1.0;
+    reader_placement_.core = config_.reader_core;
+    reader_placement_.rt_priority = config_.reader_rt_priority;
+    worker_placement_.core = config_.worker_core;
+    threads_placed_ = 0;
+    worker_done_ = false;
+    spectrum_pending_ = false;
+    spectrum_due_ = wall_start_;
+    if (spectrum_) spectrum_thread_ = std::thread(&CaptureSession::spectrum_loop, this);
+    for (const auto& channel : channels_) {
+        if (channel->apt) channel->decoder = std::thread(&CaptureSession::decoder_loop, this, channel.get());
+    }
+    // The worker demodulates the first channel itself
+    if (channelizer_ && channels_.size() > 1) {
+        int cpus = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        channel_pool_.reset(new ThreadPool(std::min(static_cast<int>(channels_.size()) - 1, cpus)));
+    }
+    worker_ = std::thread(&CaptureSession::worker_loop, this);
+    reader_ = std::thread(&CaptureSession::reader_loop, this);
+    // Placement is the first thing both threads do; wait so it can be reported
+    while (threads_placed_.load(std::memory_order_acquire) < 2) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+// The reader and the transfers are up by start_utc, so the first sample
+// kept is the one on air then rather than one a stream setup later
+bool CaptureSession::start_at(double start_utc) {
+    if (!source_ || reader_.joinable()) return false;
+    start_at_utc_ = source_->lossless() ? 0.0 : start_utc;
+    return start();
+}
+
+void CaptureSession::stop() {
+    running_ = false;
+}
+
+bool CaptureSession::join() {
+    if (reader_.joinable()) reader_.join();
+    if (worker_.joinable()) worker_.join();
+    for (const auto& channel : channels_) {
+        if (channel->decoder.joinable()) channel->decoder.join();
+    }
+    channel_pool_.reset();
+    if (spectrum_thread_.joinable()) spectrum_thread_.join();
+    bool ok = !failed_;
+    if (io_channel_ >= 0) {
+        ok = io_->wait_closed(io_channel_) && ok;
+    }
+    if (lowrate_channel_ >= 0) {
+        ok = io_->wait_closed(lowrate_channel_) && ok;
+        // Never needed this pass
+        if (lowrate_samples_ == 0) {
+            std::remove(lowrate_filename_.c_str());
+            if (config_.format == CaptureFormat::Sigmf) std::remove(sigmf_meta_path(lowrate_filename_).c_str());
+        }
+    }
+    if (source_) source_->close();
+
+    double ppm;
+    if (config_.ppm_store && learned_ppm(ppm)) {
+        ppm_stored_ = config_.ppm_store->update(
+            device_id_, ppm, std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count());
+        ppm_updated_ = true;
+    }
+    return ok;
+}
+
+// Open-loop offset averaged over the locked time of the channels that
+// have a profile: with Doppler taken out, what stays is the tuner (and
+// the TLE's error, which roughly cancels across a pass)
+bool CaptureSession::learned_ppm(double& ppm) const {
+    double locked = 0.0;
+    double offset = 0.0;
+    for (const auto& channel : channels_) {
+        if (!channel->config.doppler) continue;
+        locked += channel->locked_sec;
+        offset += channel->open_loop_sum;
+    }
+    if (locked < PPM_LEARN_MIN_SEC || tuner_hz_ <= 0.0) return false;
+    // Carriers land ppm * f below nominal
+    ppm = ppm_applied_ - offset / locked / tuner_hz_ * 1e6;
+    return std::abs(ppm) <= PPM_STORE_MAX;
+}
+
+CaptureStats CaptureSession::stats() const {
+    CaptureStats s;
+    s.samples = samples_captured_;
+    s.bytes_written = io_channel_ >= 0 ? io_->bytes_written(io_channel_) : 0;
+    s.buffered_writes = io_channel_ >= 0 ? io_->buffered_writes(io_channel_) : 0;
+    s.lowrate_bytes = lowrate_channel_ >= 0 ? io_->bytes_written(lowrate_channel_) : 0;
+    s.overflows = overflows_;
+    s.gaps = gaps_;
+    s.gap_samples = gap_samples_;
+    s.queued = queue_ ? queue_->size() : 0;
+    for (const auto& channel : channels_) {
+        s.audio_samples += channel->audio_samples;
+        s.image_lines += channel->image_lines;
+        s.decode_stalls += channel->decode_stalls;
+    }
+    if (!channels_.empty()) {
+        const DemodChannel& first = *channels_.front();
+        s.doppler_hz = first.doppler_hz;
+        s.carrier_error_hz = first.carrier_error_hz.load(std::memory_order_relaxed);
+        s.carrier_correction_hz = first.carrier_correction_hz.load(std::memory_order_relaxed);
+        s.carrier_locked = first.carrier_locked.load(std::memory_order_relaxed);
+    }
+    s.spectrum_rows = spectrum_rows_;
+    return s;
+}
+
+// ----------------------------------------------------------------------------
+// Streaming
+// ----------------------------------------------------------------------------
+
+// Sample source callback (one thread: the reader)
+void CaptureSession::callback(unsigned char* buf, uint32_t len, void* ctx) {
+    CaptureSession* self = static_cast<CaptureSession*>(ctx);
+    int64_t arrival_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    len &= ~1u;
+    if (!self->gate_open_) {
+        if (!self->running_) {
+            self->source_->cancel();
+            return;
+        }
+        // A transfer's first sample was on air one transfer length
+        // before it arrived
+        double utc = std::chrono::duration<double>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        double rate = self->config_.sample_rate * self->source_->speed();
+        double begin = utc - (len / 2) / rate;
+        if (self->first_transfer_utc_ == 0.0) self->first_transfer_utc_ = begin;
+        if (utc <= self->start_at_utc_) return;
+        uint32_t skip = 0;
+        if (begin < self->start_at_utc_) {
+            // Keep a whole number of O_DIRECT blocks, so the writer's
+            // offset stays aligned for the rest of the pass; the first
+            // sample kept is then up to a block's worth early
+            skip = std::min(len, static_cast<uint32_t>((self->start_at_utc_ - begin) * rate) * 2);
+            uint32_t keep = (len - skip + DIRECT_IO_ALIGNMENT - 1) / DIRECT_IO_ALIGNMENT * DIRECT_IO_ALIGNMENT;
+            skip = len - std::min(len, keep);
+            begin += (skip / 2) / rate;
+        }
+        self->wall_start_ = std::chrono::steady_clock::now();
+        self->stream_start_utc_ = begin;
+        self->start_lag_sec_ = std::max(0.0, begin - self->start_at_utc_);
+        self->gate_open_ = true;
+        buf += skip;
+        len -= skip;
+        if (len == 0) return;
+    }
+    uint64_t first_sample = self->samples_captured_;
+    // Samples lost upstream move the stream position on; the writers see
+    // the jump as a gap
+    first_sample += self->check_continuity(arrival_ns, first_sample, len);
+    if (!self->running_ || first_sample >= self->sample_limit_) {
+        self->running_ = false;
+        self->source_->cancel();
+        return;
+    }
+
+    // The last transfer is cut at exactly duration_sec worth of samples
+    bool last = first_sample + len / 2 >= self->sample_limit_;
+    if (last) {
+        len = static_cast<uint32_t>(self->sample_limit_ - first_sample) * 2;
+    }
+    self->samples_captured_ = first_sample + len / 2;   // 2 bytes per sample (I + Q)
+    double utc = std::chrono::duration<double>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    if (first_sample == 0 && self->stream_start_utc_ == 0.0) {
+        self->stream_start_utc_ = utc;
+    }
+
+    // Every slab still queued for the worker means it has fallen behind:
+    // drop this transfer rather than allocate or block. A lossless source
+    // waits for the worker instead, which paces it.
+    uint32_t slab;
+    BufferPool& pool = *self->pool_;
+    bool acquired = len <= pool.slab_size() && pool.acquire(slab);
+    while (!acquired && len <= pool.slab_size() && self->source_->lossless() && self->running_) {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+        acquired = pool.acquire(slab);
+    }
+    if (!acquired) {
+        self->overflows_++;
+        if (last) self->running_ = false;
+        return;
+    }
+
+    std::memcpy(pool.data(slab), buf, len);
+    int64_t steady_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    self->queue_->push({slab, len, first_sample, steady_ns, utc});
+    if (last) self->running_ = false;
+}
+
+// Upstream drop detection for paced sources. Every sample of a transfer
+// was on the air by the time it arrives, so the sample count has to keep
+// up with the arrival clock. A late callback only builds a backlog that
+// the next few catch up in a burst; samples that never come leave a
+// lasting step. So the lag is taken at its minimum per window of
+// transfers, a step is reported once two windows in a row show it (a
+// long stall looks like a step for one), and the gap is placed at the
+// transfer that confirms it. Below the threshold the reference follows
+// the lag, which absorbs tuner clock error. Returns the samples lost.
+uint64_t CaptureSession::check_continuity(int64_t arrival_ns, uint64_t first_sample, uint32_t len) {
+    double speed = source_->speed();
+    if (speed <= 0.0 || len == 0) return 0;     // Lossless sources wait instead of dropping
+    double rate = config_.sample_rate * speed;
+    uint64_t samples = len / 2;
+
+    int64_t previous_ns = last_callback_ns_;
+    last_callback_ns_ = arrival_ns;
+    if (previous_ns == 0) {
+        origin_ns_ = arrival_ns;
+        origin_sample_ = first_sample + samples;
+        return 0;
+    }
+    double nominal_ns = samples * 1e9 / rate;
+    callback_jitter_.record(static_cast<uint64_t>(
+        std::abs(static_cast<double>(arrival_ns - previous_ns) - nominal_ns)));
+
+    double lag = (arrival_ns - origin_ns_) * rate / 1e9 -
+                 static_cast<double>(first_sample + samples - origin_sample_);
+    lag_min_ = window_count_ == 0 ? lag : std::min(lag_min_, lag);
+    if (++window_count_ < CONTINUITY_WINDOW) return 0;
+    window_count_ = 0;
+
+    if (!lag_ref_set_) {
+        lag_ref_ = lag_min_;
+        lag_ref_set_ = true;
+        return 0;
+    }
+    double step = lag_min_ - lag_ref_;
+    if (step < std::max(0.5 * samples, rate * CONTINUITY_MIN_GAP_SEC)) {
+        lag_ref_ = lag_min_;
+        lag_pending_ = -1.0;
+        return 0;
+    }
+    if (lag_pending_ < 0.0) {
+        lag_pending_ = step;
+        return 0;
+    }
+    // Later lag values drop by the same amount, so the reference stays
+    uint64_t missing = static_cast<uint64_t>(std::llround(std::min(step, lag_pending_)));
+    lag_pending_ = -1.0;
+    gaps_++;
+    gap_samples_ += missing;
+    return missing;
+}
+
+// ----------------------------------------------------------------------------
+// Calibration
+// ----------------------------------------------------------------------------
+
+struct CalibrationRun {
+    SampleSource* source = nullptr;
+    double rate = 0.0;                  // Samples per second delivered
+    uint64_t limit = 0;
+    uint64_t samples = 0;
+    int64_t last_ns = 0;
+    uint64_t max_interval_ns = 0;
+    LatencyHistogram jitter;
+    std::vector<std::vector<uint8_t>> transfers;    // Kept for DSP timing
+};
+
+static void calibration_callback(unsigned char* buf, uint32_t len, void* ctx) {
+    CalibrationRun* run = static_cast<CalibrationRun*>(ctx);
+    int64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    if (run->last_ns != 0) {
+        uint64_t interval = static_cast<uint64_t>(now_ns - run->last_ns);
+        double nominal_ns = len / 2 * 1e9 / run->rate;
+        run->jitter.record(static_cast<uint64_t>(std::abs(interval - nominal_ns)));
+        run->max_interval_ns = std::max(run->max_interval_ns, interval);
+    }
+    run->last_ns = now_ns;
+    if (run->transfers.size() < CALIBRATE_DSP_TRANSFERS) {
+        run->transfers.emplace_back(buf, buf + len);
+    }
+    run->samples += len / 2;
+    if (run->samples >= run->limit) run->source->cancel();
+}
+
+// Stream for calibrate_sec with the default geometry, then size the
+// transfers so callback jitter stays within half a transfer, and the
+// pool so it rides out twice the worst stall seen plus the DSP time of
+// a slab and the writes in flight
+bool CaptureSession::calibrate() {
+    if (source_->lossless()) {
+        std::cout << "Calibration skipped: " << source_->name() << " is not paced\n";
+        return true;
+    }
+    CalibrationRun run;
+    run.source = source_.get();
+    run.rate = config_.sample_rate * source_->speed();
+    run.limit = static_cast<uint64_t>(config_.calibrate_sec * config_.sample_rate);
+    std::cout << "Calibrating for " << config_.calibrate_sec << " s...\n";
+    if (!source_->stream(calibration_callback, &run, config_.num_buffers, config_.buffer_size) ||
+        run.jitter.count() < 2) {
+        std::cerr << "Error: Calibration stream from " << source_->name() << " failed\n";
+        return false;
+    }
+
+    // Demodulator cost per byte on this host, NCO included when it will
+    // run. Further channels are timed through the channelizer as if they
+    // ran one after another, which the pool only improves on.
+    double dsp_sec_per_byte = 0.0;
+    size_t carriers = config_.channels.size() +
+        (!config_.audio_filename.empty() || !config_.image_filename.empty() ? 1 : 0);
+    if (carriers > 0) {
+        bool split = !config_.channels.empty();
+        Channelizer channelizer;
+        DemodConfig demod_config;
+        demod_config.input_rate = config_.sample_rate;
+        demod_config.iq_correction = config_.iq_correction;
+        bool ready = true;
+        if (split) {
+            std::vector<double> offsets(carriers, -config_.tune_offset_hz);
+            ready = channelizer.configure(config_.sample_rate, offsets, DEMOD_CHANNEL_BW_HZ,
+                                          config_.iq_correction);
+            demod_config.input_rate = channelizer.output_rate();
+            demod_config.iq_correction = false;
+        }
+        DemodPipeline demod;
+        if (ready && demod.configure(demod_config)) {
+            bool nco = split || config_.doppler || config_.tune_offset_hz != 0.0;
+            std::vector<float> audio;
+            std::vector<std::vector<cf32>> baseband;
+            size_t bytes = 0;
+            auto t0 = std::chrono::steady_clock::now();
+            for (const std::vector<uint8_t>& transfer : run.transfers) {
+                if (split) {
+                    for (std::vector<cf32>& samples : baseband) samples.clear();
+                    channelizer.process(transfer.data(), transfer.size(), baseband);
+                }
+                for (size_t c = 0; c < carriers; c++) {
+                    if (nco) demod.set_frequency_shift(-config_.tune_offset_hz, -config_.tune_offset_hz);
+                    audio.clear();
+                    if (split) demod.process_baseband(baseband[c].data(), baseband[c].size(), audio);
+                    else demod.process(transfer.data(), transfer.size(), audio);
+                }
+                bytes += transfer.size();
+            }
+            double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+            dsp_sec_per_byte = bytes > 0 ? sec / bytes : 0.0;
+        }
+    }
+
+    double jitter_p99 = run.jitter.percentile_ns(99) / 1e9;
+    uint32_t size = config_.buffer_size;
+    while (size < MAX_BUFFER_SIZE && jitter_p99 > 0.5 * (size / 2) / run.rate) size *= 2;
+    double transfer_sec = (size / 2) / run.rate;
+    double stall = std::max(0.0, run.max_interval_ns / 1e9 - (config_.buffer_size / 2) / run.rate);
+    double dsp_sec = dsp_sec_per_byte * size;
+    int needed = static_cast<int>(std::ceil((2.0 * stall + dsp_sec) / transfer_sec)) + config_.max_inflight + 2;
+    int slabs = std::min(MAX_NUM_BUFFERS, std::max(config_.num_buffers, needed));
+
+    std::ios::fmtflags flags = std::cout.flags();
+    std::streamsize precision = std::cout.precision();
+    std::cout << std::fixed << std::setprecision(1)
+              << "Calibration: transfers every " << (config_.buffer_size / 2) / run.rate * 1e3
+              << " ms, jitter p99 " << jitter_p99 * 1e3 << " ms, worst stall " << stall * 1e3 << " ms";
+    if (dsp_sec > 0.0) std::cout << ", DSP " << 100.0 * dsp_sec / transfer_sec << "% of real time";
+    std::cout << "\n  -> " << slabs << " x " << size / 1024 << " KB slabs\n";
+    std::cout.flags(flags);
+    std::cout.precision(precision);
+    if (dsp_sec > DSP_LOAD_WARNING * transfer_sec) {
+        std::cerr << "Warning: The demodulator needs " << static_cast<int>(100.0 * dsp_sec / transfer_sec)
+                  << "% of real time on this host; expect overflows\n";
+    }
+    if (needed > MAX_NUM_BUFFERS) {
+        std::cerr << "Warning: A " << static_cast<int>(stall * 1e3) << " ms stall needs more than "
+                  << MAX_NUM_BUFFERS << " slabs; this host may drop samples\n";
+    }
+    config_.buffer_size = size;
+    config_.num_buffers = slabs;
+    return true;
+}
+
+void CaptureSession::reader_loop() {
+    std::string name = "satgs-rx" + std::to_string(config_.device_index);
+    set_current_thread_name(name.c_str());
+    apply_thread_placement(reader_placement_, name.c_str());
+    threads_placed_.fetch_add(1, std::memory_order_release);
+
+    // Blocks until cancelled from the callback or the source runs out
+    if (!source_->stream(callback, this, config_.num_buffers, config_.buffer_size)) {
+        std::cerr << "\nError: Sample stream from " << source_->name() << " failed" << std::endl;
+        failed_ = true;
+    }
+    wall_end_ = std::chrono::steady_clock::now();
+    running_ = false;
+    stream_done_ = true;
+}
+
+// Shift that brings a channel's carrier to 0 Hz at stream sample
+// `sample`, open loop. Time comes from the sample count, so dropped
+// transfers don't skew it.
+double CaptureSession::channel_shift_hz(const DemodChannel& channel, uint64_t sample) const {
+    double doppler = 0.0;
+    if (channel.config.doppler) {
+        doppler = channel.config.doppler->getDoppler(
+            channel.profile_start + static_cast<double>(sample) / config_.sample_rate);
+    }
+    return ppm_shift_hz_ - (channel.offset_hz + doppler);
+}
+
+// After each slab: publish the loop state and add it to the pass totals
+void CaptureSession::track_carrier(DemodChannel& channel, double block_sec) {
+    const FrequencyLockedLoop& loop = channel.demod.carrier_loop();
+    channel.carrier_error_hz.store(loop.error_hz(), std::memory_order_relaxed);
+    channel.carrier_correction_hz.store(loop.correction_hz(), std::memory_order_relaxed);
+    channel.carrier_locked.store(loop.locked(), std::memory_order_relaxed);
+    channel.measured_sec += block_sec;
+    if (!loop.locked()) return;
+    channel.locked_sec += block_sec;
+    channel.error_sq_sum += loop.error_hz() * loop.error_hz() * block_sec;
+    // The loop moved the carrier up by the correction it had going into
+    // the slab; without it the carrier would sit that much lower
+    channel.open_loop_sum += (loop.error_hz() - loop.correction_applied_hz()) * block_sec;
+}
+
+// Worker: each slab is demodulated (if enabled), then handed to the I/O
+// scheduler, which returns it to the pool once it is on disk. With
+// further channels the slab is channelized first and the channels'
+// demodulators run side by side on the pool.
+void CaptureSession::worker_loop() {
+    std::string name = "satgs-dsp" + std::to_string(config_.device_index);
+    set_current_thread_name(name.c_str());
+    apply_thread_placement(worker_placement_, name.c_str());
+    threads_placed_.fetch_add(1, std::memory_order_release);
+
+    SlabRef ref;
+    bool write_failed = false;
+    std::vector<std::vector<cf32>> baseband;
+    TaskGroup group;
+    load_time_ = std::chrono::steady_clock::now();
+    load_overflows_ = 0;
+
+    while (!stream_done_ || queue_->size() > 0) {
+        if (!queue_->pop(ref, 100)) continue;
+        auto begin = std::chrono::steady_clock::now();
+        const uint8_t* data = pool_->data(ref.index);
+        LoadLevel level = load_.level();
+
+        if (channelizer_) {
+            for (std::vector<cf32>& samples : baseband) samples.clear();
+            channelizer_->process(data, ref.length, baseband);
+            size_t active = level == LoadLevel::PrimaryOnly ? 1 : channels_.size();
+            for (size_t c = active; c < channels_.size(); c++) {
+                silence_channel(*channels_[c], ref);
+            }
+            for (size_t c = 1; c < active; c++) {
+                DemodChannel* channel = channels_[c].get();
+                const std::vector<cf32>* samples = &baseband[c];
+                channel_pool_->submit(group, [this, channel, ref, samples]() {
+                    run_channel(*channel, ref, nullptr, samples->data(), samples->size());
+                });
+            }
+            run_channel(*channels_[0], ref, nullptr, baseband[0].data(), baseband[0].size());
+            group.wait();
+        } else if (!channels_.empty()) {
+            run_channel(*channels_[0], ref, data, nullptr, 0);
+        }
+        if (spectrum_ && level < LoadLevel::NoWaterfall) {
+            tap_spectrum(ref, data);
+        }
+
+        if (io_channel_ < 0) {
+            pool_->release(ref.index);
+        } else if (level >= LoadLevel::Decimated) {
+            if (level == LoadLevel::Decimated) write_lowrate(ref, data);
+            io_->discard(io_channel_, ref);
+        } else {
+            io_->submit(io_channel_, ref);
+        }
+        if (!write_failed && io_channel_ >= 0 &&
+            (io_->failed(io_channel_) || (lowrate_channel_ >= 0 && io_->failed(lowrate_channel_)))) {
+            // The scheduler keeps draining the channel; end this stream
+            write_failed = true;
+            failed_ = true;
+            running_ = false;
+        }
+        if (load_.enabled()) update_load(ref, begin);
+    }
+
+    worker_done_ = true;
+    if (io_channel_ >= 0) {
+        io_->finish(io_channel_);
+    }
+    if (lowrate_channel_ >= 0) {
+        io_->finish(lowrate_channel_);
+    }
+    for (const auto& channel : channels_) {
+        if (channel->wav.is_open() && !channel->wav.close()) {
+            std::cerr << "\nError: Failed to finalize " << channel->config.audio_filename << std::endl;
+            failed_ = true;
+        }
+    }
+}
+
+// One slab through one channel: the u8 slab itself (single channel) or
+// the channel's slice of it from the channelizer
+void CaptureSession::run_channel(DemodChannel& channel, const SlabRef& ref, const uint8_t* iq,
+                                 const cf32* baseband, size_t baseband_count) {
+    if (channel.config.doppler || channel.offset_hz != 0.0 || ppm_shift_hz_ != 0.0) {
+        if (!channel.profile_aligned) {
+            // Align the profile to the stream once the first transfer has
+            // been timestamped
+            bool start_set = channel.primary && config_.profile_start_set;
+            if (!start_set && channel.config.doppler && channel.config.doppler->aos_epoch_sec > 0) {
+                channel.profile_start = stream_start_utc_ - channel.config.doppler->aos_epoch_sec;
+            }
+            channel.profile_aligned = true;
+        }
+        uint64_t end_sample = ref.first_sample + ref.length / 2;
+        double shift_start = channel_shift_hz(channel, ref.first_sample);
+        double shift_end = channel_shift_hz(channel, end_sample);
+        channel.demod.set_frequency_shift(shift_start, shift_end);
+        channel.doppler_hz = ppm_shift_hz_ - shift_end - channel.offset_hz;
+    }
+
+    std::vector<float>& audio = channel.audio;
+    audio.clear();
+    // Silence for samples that never arrived (upstream gaps and
+    // overflows), so the audio stays on the stream's time base
+    if (ref.first_sample > channel.next_sample && channel.next_sample > 0) {
+        uint64_t missing = ref.first_sample - channel.next_sample;
+        audio.assign(static_cast<size_t>(missing * channel.demod.audio_rate() / config_.sample_rate), 0.0f);
+    }
+    channel.next_sample = ref.first_sample + ref.length / 2;
+    if (iq) {
+        channel.demod.process(iq, ref.length, audio);
+    } else {
+        channel.demod.process_baseband(baseband, baseband_count, audio);
+    }
+    track_carrier(channel, ref.length / 2.0 / config_.sample_rate);
+    if (channel.wav.is_open()) channel.wav.write(audio.data(), audio.size());
+    channel.audio_samples += audio.size();
+
+    if (channel.apt) {
+        push_audio(channel, audio.data(), audio.size());
+    }
+}
+
+// A shed channel's audio for the slab: silence, counted from absolute
+// positions so the WAV keeps the stream's length however long it lasts
+void CaptureSession::silence_channel(DemodChannel& channel, const SlabRef& ref) {
+    uint64_t end = ref.first_sample + ref.length / 2;
+    if (end <= channel.next_sample) return;
+    uint64_t rate = channel.demod.audio_rate();
+    size_t count = static_cast<size_t>(end * rate / config_.sample_rate -
+                                       channel.next_sample * rate / config_.sample_rate);
+    channel.next_sample = end;
+    channel.audio.assign(count, 0.0f);
+    if (channel.wav.is_open()) channel.wav.write(channel.audio.data(), count);
+    channel.audio_samples += count;
+    if (channel.apt) push_audio(channel, channel.audio.data(), count);
+}
+
+// Hand audio to the decoder in block-sized pieces (gap silence can span
+// several). A full ring makes the worker wait: the decoder is never
+// allowed to lose audio, the capture pool absorbs the delay.
+void CaptureSession::push_audio(DemodChannel& channel, const float* audio, size_t count) {
+    BufferPool& pool = *channel.audio_pool;
+    while (count > 0) {
+        uint32_t index;
+        if (!pool.acquire(index)) {
+            channel.decode_stalls.fetch_add(1, std::memory_order_relaxed);
+            do {
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            } while (!pool.acquire(index));
+        }
+        size_t n = std::min(count, channel.audio_block_samples);
+        std::memcpy(pool.data(index), audio, n * sizeof(float));
+        SlabRef ref = {};
+        ref.index = index;
+        ref.length = static_cast<uint32_t>(n);
+        channel.audio_queue->push(ref);    // Can't fail: the ring holds every block
+        audio += n;
+        count -= n;
+    }
+}
+
+// Decoder: APT lines come out as the pass goes; the PNG is swapped in
+// place so the HMI can show it while the capture runs, and written a
+// last time as soon as the worker is done
+void CaptureSession::decoder_loop(DemodChannel* channel) {
+    std::string name = "satgs-apt" + std::to_string(config_.device_index);
+    if (channels_.size() > 1) {
+        size_t index = 0;
+        while (channels_[index].get() != channel) index++;
+        name += "." + std::to_string(index);
+    }
+    set_current_thread_name(name.c_str());
+
+    const std::string& filename = channel->config.image_filename;
+    BufferPool& pool = *channel->audio_pool;
+    std::vector<AptLine> lines;
+    int lines_since_save = 0;
+    bool image_failed = false;
+    SlabRef ref;
+    while (!worker_done_ || channel->audio_queue->size() > 0) {
+        if (!channel->audio_queue->pop(ref, 100)) continue;
+        lines.clear();
+        channel->apt->process(reinterpret_cast<const float*>(pool.data(ref.index)), ref.length, lines);
+        pool.release(ref.index);
+        for (const AptLine& line : lines) channel->image->add(line);
+        channel->image_lines += lines.size();
+        lines_since_save += static_cast<int>(lines.size());
+        if (lines_since_save >= APT_IMAGE_REFRESH_LINES) {
+            lines_since_save = 0;
+            if (!channel->image->save_png(filename) && !image_failed) {
+                std::cerr << "\nWarning: Cannot update " << filename << std::endl;
+                image_failed = true;
+            }
+        }
+    }
+
+    if (channel->image->height() > 0 && !channel->image->save_png(filename)) {
+        std::cerr << "\nError: Failed to write " << filename << std::endl;
+        failed_ = true;
+    }
+    channel->image_done = std::chrono::steady_clock::now();
+}
+
+// Decimated load step: the slab filtered down to 1/D of the rate and
+// back to u8 for the sidecar. Sample positions stay on the full-rate
+// stream's time base (divided by D), so a span the step skipped or the
+// pool could not take is a gap in the sidecar.
+void CaptureSession::write_lowrate(const SlabRef& ref, const uint8_t* data) {
+    size_t n = ref.length / 2;
+    if (ref.first_sample != lowrate_next_) {
+        lowrate_fir_.reset();
+        lowrate_position_ = ref.first_sample / lowrate_decimation_;
+    }
+    lowrate_next_ = ref.first_sample + n;
+    lowrate_in_.resize(n);
+    dsp_kernels().u8_to_cf32(data, lowrate_in_.data(), n);
+    lowrate_out_.clear();
+    lowrate_fir_.process(lowrate_in_.data(), n, lowrate_out_);
+    uint64_t first = lowrate_position_;
+    lowrate_position_ += lowrate_out_.size();
+
+    uint32_t slab;
+    if (lowrate_out_.empty() || !lowrate_pool_->acquire(slab)) return;
+    uint8_t* out = lowrate_pool_->data(slab);
+    auto to_u8 = [](float x) {
+        return static_cast<uint8_t>(std::min(255.0f, std::max(0.0f, std::round(x * 127.5f + 127.5f))));
+    };
+    for (size_t i = 0; i < lowrate_out_.size(); i++) {
+        out[2 * i] = to_u8(lowrate_out_[i].real());
+        out[2 * i + 1] = to_u8(lowrate_out_[i].imag());
+    }
+    uint32_t len = static_cast<uint32_t>(lowrate_out_.size() * 2);
+    io_->submit(lowrate_channel_, {slab, len, first, ref.steady_ns, ref.utc});
+    lowrate_samples_.fetch_add(lowrate_out_.size(), std::memory_order_relaxed);
+}
+
+static const char* load_level_effect(LoadLevel level) {
+    switch (level) {
+        case LoadLevel::Full:        return "every stage running";
+        case LoadLevel::NoWaterfall: return "waterfall off";
+        case LoadLevel::Decimated:   return "raw I/Q decimated";
+        case LoadLevel::NoRaw:       return "raw I/Q off";
+        case LoadLevel::PrimaryOnly: return "primary channel only";
+    }
+    return "";
+}
+
+// One slab's measurements into the load policy, and the console line
+// when it moves. Neither queued nor on the worker, a slab is with the
+// disk writer (the one just handed over included).
+void CaptureSession::update_load(const SlabRef& ref, std::chrono::steady_clock::time_point begin) {
+    auto now = std::chrono::steady_clock::now();
+    double num = static_cast<double>(pool_->num_slabs());
+    size_t queued = queue_->size();
+    size_t in_use = pool_->in_use();
+    uint64_t overflows = overflows_.load(std::memory_order_relaxed);
+    double slab_sec = ref.length / 2.0 / (config_.sample_rate * speed());
+
+    LoadSample sample;
+    sample.queue_fill = queued / num;
+    sample.writer_fill = in_use > queued ? (in_use - queued) / num : 0.0;
+    sample.dsp_load = slab_sec > 0.0 ? std::chrono::duration<double>(now - begin).count() / slab_sec : 0.0;
+    sample.dropped = overflows > load_overflows_;
+    sample.elapsed_sec = std::chrono::duration<double>(now - load_time_).count();
+    load_overflows_ = overflows;
+    load_time_ = now;
+
+    LoadLevel before = load_.level();
+    if (!load_.update(sample)) return;
+    LoadLevel level = load_.level();
+    std::ostringstream line;
+    line << std::fixed << std::setprecision(2);
+    if (!config_.label.empty()) line << config_.label << ": ";
+    line << "Load " << load_.pressure() << " (pool " << std::setprecision(0)
+         << 100.0 * (sample.queue_fill + sample.writer_fill) << "% full, DSP "
+         << 100.0 * sample.dsp_load << "% of real time)";
+    if (level > before) {
+        line << ", " << load_.cause() << " bound: shed to " << load_level_name(level);
+    } else {
+        line << ": restored to " << load_level_name(level);
+    }
+    line << ", " << load_level_effect(level);
+    if (level == LoadLevel::Decimated) line << " to " << lowrate_filename_;
+    if (level > before) std::cerr << "\nWarning: " << line.str() << std::endl;
+    else std::cout << "\n" << line.str() << std::endl;
+}
+
+// Side tap for the waterfall: at most one row in flight and one per
+// 1/row_rate seconds. The copy is a few tens of KB; a busy spectrum
+// thread or a short slab just skips this one.
+void CaptureSession::tap_spectrum(const SlabRef& ref, const uint8_t* data) {
+    if (spectrum_pending_.load(std::memory_order_acquire) || ref.length < spectrum_input_.size()) return;
+    auto now = std::chrono::steady_clock::now();
+    if (now < spectrum_due_) return;
+    spectrum_due_ = now + std::chrono::microseconds(static_cast<int64_t>(1e6 / config_.spectrum.row_rate));
+    std::memcpy(spectrum_input_.data(), data, spectrum_input_.size());
+    spectrum_utc_ = ref.utc;
+    spectrum_pending_.store(true, std::memory_order_release);
+}
+
+void CaptureSession::spectrum_loop() {
+    std::string name = "satgs-fft" + std::to_string(config_.device_index);
+    set_current_thread_name(name.c_str());
+    lower_current_thread_priority(SPECTRUM_NICE);
+    if (config_.reader_core >= 0 || config_.worker_core >= 0) {
+        pin_current_thread_excluding({config_.reader_core, config_.worker_core});
+    }
+
+    std::vector<uint8_t> row(spectrum_->bins());
+    while (!worker_done_) {
+        if (!spectrum_pending_.load(std::memory_order_acquire)) {
+            std::this_thread::sleep_for(std::chrono::microseconds(SPECTRUM_POLL_US));
+            continue;
+        }
+        spectrum_->compute(spectrum_input_.data(), row.data());
+        waterfall_->publish(row.data(), spectrum_utc_);
+        spectrum_rows_.fetch_add(1, std::memory_order_relaxed);
+        spectrum_pending_.store(false, std::memory_order_release);
+    }
+    waterfall_->close();
+}
+
+double CaptureSession::image_latency_sec() const {
+    double latency = -1.0;
+    for (const auto& channel : channels_) {
+        if (!channel->apt || channel->image->height() == 0) continue;
+        latency = std::max(latency, std::chrono::duration<double>(channel->image_done - wall_end_).count());
+    }
+    return latency;
+}
+
+uint64_t CaptureSession::lines_synced(size_t channel) const {
+    if (channel >= channels_.size() || !channels_[channel]->apt) return 0;
+    return channels_[channel]->apt->lines_synced();
+}
+
+// ----------------------------------------------------------------------------
+// Reporting
+// ----------------------------------------------------------------------------
+
+void CaptureSession::print_config(std::ostream& out) const {
+    out << "\n" << heading(config_.label, "Configuration") << "\n";
+    out << "  Frequency:   " << config_.frequency / 1e6 << " MHz\n";
+    out << "  Sample rate: " << config_.sample_rate / 1e6 << " MS/s\n";
+    out << "  Gain:        " << config_.gain / 10.0 << " dB\n";
+    out << "  Duration:    " << config_.duration_sec << " seconds\n";
+    out << "  Buffers:     " << config_.num_buffers << " x " << config_.buffer_size / 1024 << " KB\n";
+    if (!config_.filename.empty()) {
+        out << "  Output:      " << config_.filename << " (" << capture_format_name(config_.format);
+        if (config_.compress_bits == 8) out << ", Rice lossless";
+        else if (config_.compress_bits > 0) out << ", Rice at " << config_.compress_bits << " bits";
+        out << ")\n";
+        out << "  Writer:      " << io_backend_name(config_.backend);
+        if (config_.backend != IoBackend::Stream) out << " (" << config_.max_inflight << " in flight)";
+        out << (config_.preallocate ? ", preallocated" : "") << "\n";
+    }
+    if (!config_.audio_filename.empty()) {
+        out << "  Audio:       " << config_.audio_filename << " (" << DEMOD_AUDIO_RATE << " Hz "
+            << audio_format_name(config_.audio_format) << ")\n";
+    }
+    for (const ChannelConfig& channel : config_.channels) {
+        out << "  Channel:     " << frequency_mhz(channel.frequency);
+        if (!channel.label.empty()) out << " (" << channel.label << ")";
+        if (!channel.audio_filename.empty()) out << ", " << channel.audio_filename;
+        if (!channel.image_filename.empty()) out << ", " << channel.image_filename;
+        if (channel.doppler) out << ", Doppler NCO";
+        out << "\n";
+    }
+    if (!config_.audio_filename.empty() || !config_.image_filename.empty() || !config_.channels.empty()) {
+        out << "  DSP kernels: " << dsp_kernels().name
+            << (config_.iq_correction ? ", I/Q correction" : "") << "\n";
+    }
+    if (!config_.image_filename.empty()) {
+        out << "  Image:       " << config_.image_filename << " (live APT, every "
+            << APT_IMAGE_REFRESH_LINES / 2 << " s)\n";
+    }
+    if (config_.doppler) {
+        out << "  Doppler:     NCO, " << config_.doppler->doppler_hz.front() << " to "
+            << config_.doppler->doppler_hz.back() << " Hz\n";
+    }
+    if (config_.tune_offset_hz != 0.0) {
+        out << "  Tune offset: " << config_.tune_offset_hz / 1e3 << " kHz\n";
+    }
+    if (config_.carrier_tracking) {
+        out << "  Carrier:     FLL, " << config_.fll_bandwidth_hz << " Hz loop, +/-" << FLL_PULL_HZ / 1e3
+            << " kHz pull-in\n";
+    }
+    if (ppm_applied_ != 0.0 || config_.ppm_store) {
+        out << "  Tuner error: " << std::showpos << ppm_applied_ << std::noshowpos << " ppm";
+        if (config_.ppm_set) out << " (set)";
+        else if (ppm_from_store_) out << " (" << device_id_ << " in " << config_.ppm_store->path() << ")";
+        else out << " (" << device_id_ << " not in " << config_.ppm_store->path() << " yet)";
+        out << "\n";
+    }
+    if (!config_.waterfall_name.empty()) {
+        const SpectrumConfig& sp = config_.spectrum;
+        out << "  Waterfall:   /dev/shm" << WATERFALL_SHM_PREFIX << config_.waterfall_name << " ("
+            << sp.fft_size << " bins, " << sp.averages << " averages, " << sp.row_rate << " rows/s)\n";
+    }
+    if (config_.load.enabled) {
+        out << "  Shedding:    waterfall, raw I/Q";
+        if (config_.load.raw_decimation > 1) out << " (1/" << config_.load.raw_decimation << " rate first)";
+        out << ", further channels above " << config_.load.shed_pressure << " load\n";
+    }
+    if (config_.reader_core >= 0 || config_.worker_core >= 0) {
+        out << "  Cores:       reader " << config_.reader_core << ", worker " << config_.worker_core << "\n";
+    }
+}
+
+void CaptureSession::print_placement(std::ostream& out) const {
+    std::string who = config_.label.empty() ? "  " : "  " + config_.label + " ";
+    out << who << "USB reader: " << describe_placement(reader_placement_) << "\n";
+    out << who << "DSP worker: " << describe_placement(worker_placement_) << "\n";
+    if (config_.lock_memory) {
+        out << who << "Buffers:    ";
+        if (memory_lock_ == MemoryLock::All) {
+            out << "locked (whole process, mlockall)\n";
+        } else if (memory_lock_ == MemoryLock::Region) {
+            out << "locked (" << pool_->bytes() / (1024 * 1024.0) << " MB pool only)\n";
+        } else {
+            out << "not locked (" << std::strerror(memory_lock_error_) << ")\n";
+        }
+    }
+}
+
+void CaptureSession::print_summary(std::ostream& out) const {
+    CaptureStats s = stats();
+    if (!config_.label.empty()) {
+        out << config_.label << ":\n";
+    }
+    out << "  Samples:   " << s.samples << "\n";
+    out << "  Written:   " << s.bytes_written / 1e6 << " MB";
+    if (config_.compress_bits > 0 && s.samples > 0) {
+        out << " (" << 100.0 * s.bytes_written / (s.samples * 2.0) << "% of raw)";
+    }
+    out << "\n";
+    out << "  Overflows: " << s.overflows << " buffers dropped\n";
+    if (config_.backend != IoBackend::Stream && s.buffered_writes > 0) {
+        out << "  Buffered:  " << s.buffered_writes << " writes off the O_DIRECT alignment (page cache)\n";
+    }
+    if (load_.enabled()) {
+        std::ostringstream line;
+        if (load_.transitions() == 0) {
+            line << "nothing shed";
+        } else {
+            line << std::fixed << std::setprecision(1) << load_.transitions() << " transitions, down to "
+                 << load_level_name(load_.peak()) << ", " << load_.shed_time_sec() << " s with stages shed";
+        }
+        out << "  Load:      " << line.str() << "\n";
+    }
+    if (waterfall_) {
+        out << "  Waterfall: " << s.spectrum_rows << " rows\n";
+    }
+    double lag = start_lag_sec_;
+    if (start_at_utc_ > 0.0 && lag >= 0.0) {
+        std::ostringstream line;
+        line << std::fixed << std::setprecision(1) << "first sample " << lag * 1e3 << " ms after "
+             << format_utc_timestamp(start_at_utc_) << " (stream up "
+             << std::setprecision(2) << start_at_utc_ - first_transfer_utc_ << " s ahead)";
+        out << "  Start:     " << line.str() << "\n";
+    }
+    if (speed() > 0.0) {
+        out << "  Gaps:      " << s.gaps << " upstream";
+        if (s.gaps > 0) out << " (" << s.gap_samples << " samples lost)";
+        out << "\n";
+    }
+    double wall = std::chrono::duration<double>(wall_end_ - wall_start_).count();
+    if (speed() != 1.0 && wall > 0.0 && config_.sample_rate > 0) {
+        out << "  Speed:     " << s.samples / static_cast<double>(config_.sample_rate) / wall
+            << "x real time\n";
+    }
+    if (!config_.filename.empty()) {
+        out << "  Output:    " << config_.filename << "\n";
+    }
+    if (lowrate_samples_ > 0) {
+        out << "  Low rate:  " << lowrate_filename_ << " ("
+            << lowrate_samples_ * lowrate_decimation_ / static_cast<double>(config_.sample_rate) << " s at "
+            << config_.sample_rate / lowrate_decimation_ / 1e3 << " kS/s)\n";
+    }
+    // Channels beyond the primary carrier get a line of their own
+    for (const auto& channel : channels_) {
+        const DemodChannel& ch = *channel;
+        std::string indent = "  ";
+        if (channelizer_) {
+            out << "  " << channel_name(ch) << ":\n";
+            indent = "    ";
+        }
+        if (!ch.config.audio_filename.empty()) {
+            out << indent << "Audio:     " << ch.config.audio_filename << " ("
+                << ch.audio_samples / static_cast<double>(DEMOD_AUDIO_RATE) << " s)\n";
+        }
+        if (ch.apt) {
+            out << indent << "Image:     " << ch.config.image_filename << " (" << ch.image_lines << " lines, "
+                << ch.apt->lines_synced() << " synced)\n";
+        }
+        if (ch.measured_sec > 0.0) {
+            std::ostringstream line;
+            line << std::fixed << std::setprecision(0);
+            if (ch.locked_sec > 0.0) {
+                line << std::sqrt(ch.error_sq_sum / ch.locked_sec) << " Hz RMS residual"
+                     << (config_.carrier_tracking ? " (FLL), " : " (open loop), ")
+                     << 100.0 * ch.locked_sec / ch.measured_sec << "% of the pass on carrier";
+            } else {
+                line << "not found";
+            }
+            out << indent << "Carrier:   " << line.str() << "\n";
+        }
+    }
+    double ppm;
+    if (learned_ppm(ppm)) {
+        std::ostringstream line;
+        line << std::showpos << std::fixed << std::setprecision(2) << ppm << " ppm this pass";
+        if (ppm_updated_) line << ", " << ppm_stored_ << " stored for " << device_id_;
+        out << "  Tuner:     " << line.str() << "\n";
+    }
+}
+
+void CaptureSession::collect_metrics(MetricsWriter& out) const {
+    std::string name = !config_.label.empty() ? config_.label : source_ ? source_->name() : "capture";
+    std::string labels = metrics_label("session", name);
+    CaptureStats s = stats();
+
+    auto now = std::chrono::steady_clock::now();
+    double dt = std::chrono::duration<double>(now - scrape_time_).count();
+    double rate = dt > 0.0 ? (s.samples - scrape_samples_) / dt : 0.0;
+    scrape_samples_ = s.samples;
+    scrape_time_ = now;
+
+    out.gauge("satgs_capture_running", "1 while the session is streaming", labels, running() ? 1 : 0);
+    double lag = start_lag_sec_;
+    if (start_at_utc_ > 0.0 && lag >= 0.0) {
+        out.gauge("satgs_capture_start_lag_seconds", "First sample kept past the start_at() instant",
+                  labels, lag);
+    }
+    out.counter("satgs_samples_total", "I/Q samples delivered by the source", labels,
+                static_cast<double>(s.samples));
+    out.gauge("satgs_samples_per_second", "Sample rate since the previous scrape", labels, rate);
+    out.gauge("satgs_sample_rate_hz", "Configured source sample rate", labels, config_.sample_rate);
+    out.counter("satgs_overflows_total", "Transfers dropped with the slab pool exhausted", labels,
+                static_cast<double>(s.overflows));
+    out.counter("satgs_upstream_gaps_total", "Discontinuities before the callback (dongle / USB)",
+                labels, static_cast<double>(s.gaps));
+    out.counter("satgs_upstream_gap_samples_total", "Samples lost in upstream gaps", labels,
+                static_cast<double>(s.gap_samples));
+    out.gauge("satgs_pool_slabs", "Slab pool depth", labels, config_.num_buffers);
+    out.gauge("satgs_queue_depth", "Filled slabs waiting on the DSP worker", labels,
+              static_cast<double>(s.queued));
+    out.counter("satgs_bytes_written_total", "Raw I/Q bytes on disk", labels,
+                static_cast<double>(s.bytes_written));
+    if (config_.backend != IoBackend::Stream) {
+        out.counter("satgs_buffered_writes_total", "O_DIRECT raw writes that fell back to the page cache",
+                    labels, static_cast<double>(s.buffered_writes));
+    }
+    // Per carrier when the stream is channelized
+    auto channel_metrics = [&out](const std::string& channel_labels, uint64_t audio_samples,
+                                  uint64_t image_lines, uint64_t decode_stalls, double doppler_hz,
+                                  double error_hz, double correction_hz, bool locked) {
+        out.counter("satgs_audio_samples_total", "Demodulated audio samples written", channel_labels,
+                    static_cast<double>(audio_samples));
+        out.counter("satgs_apt_lines_total", "APT image lines decoded", channel_labels,
+                    static_cast<double>(image_lines));
+        out.counter("satgs_decode_stalls_total", "Times the DSP worker waited on a full APT decoder ring",
+                    channel_labels, static_cast<double>(decode_stalls));
+        out.gauge("satgs_doppler_correction_hz", "Doppler currently removed by the NCO", channel_labels,
+                  doppler_hz);
+        out.gauge("satgs_carrier_error_hz", "Carrier offset left after the NCO, last block", channel_labels,
+                  error_hz);
+        out.gauge("satgs_carrier_loop_correction_hz", "Shift added by the carrier FLL", channel_labels,
+                  correction_hz);
+        out.gauge("satgs_carrier_locked", "1 while the demodulator sees a carrier", channel_labels,
+                  locked ? 1 : 0);
+    };
+    if (!channelizer_) {
+        channel_metrics(labels, s.audio_samples, s.image_lines, s.decode_stalls, s.doppler_hz,
+                        s.carrier_error_hz, s.carrier_correction_hz, s.carrier_locked);
+    } else {
+        for (const auto& channel : channels_) {
+            channel_metrics(labels + "," + metrics_label("channel", channel_name(*channel)),
+                            channel->audio_samples, channel->image_lines, channel->decode_stalls,
+                            channel->doppler_hz, channel->carrier_error_hz, channel->carrier_correction_hz,
+                            channel->carrier_locked);
+        }
+    }
+    out.gauge("satgs_tuner_ppm", "Tuner crystal error corrected by the NCO", labels, ppm_applied_);
+    if (waterfall_) {
+        out.counter("satgs_waterfall_rows_total", "Spectrum rows published to the waterfall ring", labels,
+                    static_cast<double>(s.spectrum_rows));
+    }
+    if (load_.enabled()) {
+        out.gauge("satgs_load_level", "Stages shed (0 = full, 4 = primary channel only)", labels,
+                  static_cast<double>(load_.level()));
+        out.gauge("satgs_load_pressure", "Smoothed pressure driving the shedding (1 = saturated)", labels,
+                  load_.pressure());
+        out.gauge("satgs_load_queue_fill", "Share of the slab pool waiting on the DSP worker", labels,
+                  load_.queue_fill());
+        out.gauge("satgs_load_writer_fill", "Share of the slab pool held by the disk writer", labels,
+                  load_.writer_fill());
+        out.gauge("satgs_load_dsp", "DSP worker time per slab over the slab's duration", labels,
+                  load_.dsp_load());
+        for (int i = 0; i < LOAD_LEVELS; i++) {
+            LoadLevel level = static_cast<LoadLevel>(i);
+            out.counter("satgs_load_transitions_total", "Times the session moved to a load level",
+                        labels + "," + metrics_label("level", load_level_name(level)),
+                        static_cast<double>(load_.transitions(level)));
+        }
+    }
+    if (lowrate_channel_ >= 0) {
+        out.counter("satgs_lowrate_bytes_written_total", "Decimated raw I/Q bytes on disk (load shedding)",
+                    labels, static_cast<double>(s.lowrate_bytes));
+    }
+    out.histogram("satgs_write_latency_seconds", "Raw write submit-to-completion time", labels,
+                  write_latency_);
+    out.histogram("satgs_callback_jitter_seconds", "Transfer arrival offset from the nominal interval",
+                  labels, callback_jitter_);
+
+    std::vector<const std::string*> paths = {&config_.filename, &config_.audio_filename};
+    for (const ChannelConfig& channel : config_.channels) paths.push_back(&channel.audio_filename);
+    for (const std::string* path : paths) {
+        if (path->empty()) continue;
+        double free_bytes = disk_free_bytes(*path);
+        if (free_bytes >= 0) {
+            out.gauge("satgs_disk_free_bytes", "Free space on the filesystem of an output file",
+                      labels + "," + metrics_label("path", *path), free_bytes);
+        }
+    }
+}
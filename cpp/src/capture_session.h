@@ -0,0 +1,391 @@
+/*
+ * capture_session.h
+ * Satellite Ground Station - Per-device Capture Session
+ *
+ * Everything one sample source (sample_source.h) needs to stream a pass:
+ * its slab pool and filled-slab queue, counters, and the threads below.
+ * Several sessions can run in one process (capture_daemon); their raw
+ * I/Q writes all go through one shared IoScheduler.
+ *
+ *   reader thread:   SampleSource::stream -> callback -> pool slab -> queue
+ *   worker thread:   queue -> demod/NCO -> WAV (-> audio queue), then slab -> IoScheduler
+ *   decode thread:   audio queue -> APT decoder -> live PNG (only with an image)
+ *   spectrum thread: side tap -> averaged FFT -> waterfall ring (only with a waterfall)
+ *   I/O thread:      (shared) slab -> IQWriter -> back to pool
+ *
+ * Each hop is a bounded SPSC ring. Only the source end drops (overflows,
+ * like the USB stream); further in a full ring makes the producer wait,
+ * so a slow image save backs the worker up instead of losing lines.
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#ifndef SATGS_CAPTURE_SESSION_H
+#define SATGS_CAPTURE_SESSION_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "buffer_pool.h"
+#include "capture_format.h"
+#include "doppler_profile.h"
+#include "dsp_kernels.h"
+#include "dsp_pipeline.h"
+#include "iq_writer.h"
+#include "latency_histogram.h"
+#include "load_manager.h"
+#include "sample_source.h"
+#include "spectrum.h"
+#include "thread_util.h"
+#include "wav_writer.h"
+
+class Channelizer;
+class IoScheduler;
+class MetricsWriter;
+class SpectrumAnalyzer;
+class ThreadPool;
+class WaterfallPublisher;
+struct DemodChannel;
+class DevicePool;
+class PpmStore;
+
+// Default configuration
+#define DEFAULT_FREQ        137100000   // 137.1 MHz (NOAA-19)
+#define DEFAULT_SAMPLE_RATE 2400000     // 2.4 MS/s
+#define DEFAULT_GAIN        400         // 40.0 dB (gain is in tenths)
+#define DEFAULT_DURATION    900         // 15 minutes
+#define BUFFER_SIZE         (16 * 16384) // 256KB per buffer
+#define NUM_BUFFERS         16          // Ring buffer depth (pool slabs)
+#define MAX_BUFFER_SIZE     (64 * 16384) // Calibration limits
+#define MAX_NUM_BUFFERS     64
+#define DEFAULT_CALIBRATE_SEC 3.0
+#define APT_IMAGE_REFRESH_LINES 20      // Rewrite the live image every 10 s
+#define APT_AUDIO_BLOCKS    32          // Worker -> decoder ring, in transfers (~1.7 s)
+#define WALL_STOP_GRACE_SEC 2           // Wall-clock backstop past the duration (live sources)
+#define READER_RT_PRIORITY  50          // SCHED_FIFO for the USB reader with --realtime ...
+#define IO_RT_PRIORITY      40          // ... and just below it for the disk writer
+#define PPM_LEARN_MIN_SEC   60.0        // Locked time before a pass's ppm estimate counts
+#define STREAM_PREROLL_SEC  1.0         // How far ahead of its instant to call start_at()
+
+// A further carrier demodulated from the same stream
+struct ChannelConfig {
+    std::string label;                    // Name in reports (empty = the frequency)
+    uint32_t frequency = 0;               // Carrier
+    std::string audio_filename;           // Demodulated WAV (empty = none)
+    std::string image_filename;           // Live APT PNG (empty = none)
+    DopplerProfile* doppler = nullptr;    // Aligned by its aos_epoch_sec (else from the first sample)
+};
+
+struct CaptureConfig {
+    std::string label;                    // Heading in multi-device output (empty = none)
+    std::string source;                   // Sample source spec (empty = RTL-SDR device_index)
+    int device_index = 0;
+    uint32_t frequency = DEFAULT_FREQ;    // Carrier of interest
+    uint32_t sample_rate = DEFAULT_SAMPLE_RATE;
+    int gain = DEFAULT_GAIN;              // Tenths of a dB
+    int duration_sec = DEFAULT_DURATION;
+
+    // Transfer size and pool depth; calibrate_sec > 0 replaces them with
+    // values measured on this host just before the capture
+    uint32_t buffer_size = BUFFER_SIZE;
+    int num_buffers = NUM_BUFFERS;
+    double calibrate_sec = 0.0;
+
+    std::string filename;                 // Raw I/Q (empty = audio only)
+    CaptureFormat format = CaptureFormat::Raw;
+    int compress_bits = 0;                // .sgc Rice coding (0 = off, 8 = lossless)
+    IoBackend backend = IoBackend::Stream;
+    int max_inflight = DEFAULT_IO_INFLIGHT;
+    bool preallocate = false;             // sample_rate * duration * 2 bytes
+
+    std::string audio_filename;           // Demodulated WAV (empty = raw only)
+    AudioFormat audio_format = AudioFormat::Int16;
+    bool iq_correction = false;
+    std::string image_filename;           // Live APT PNG decoded from the audio (empty = none)
+
+    // Software frequency correction of the demodulated channel
+    DopplerProfile* doppler = nullptr;    // Profile driving the NCO (nullptr = none)
+    double tune_offset_hz = 0.0;          // Tuner center minus carrier
+    bool profile_start_set = false;
+    double profile_start_sec = 0.0;       // Profile time of the first sample
+
+    // Closed-loop correction of what the open-loop shift (profile, tune
+    // offset, known tuner error) leaves: a frequency-locked loop around
+    // each channel's NCO (dsp_pipeline.h)
+    bool carrier_tracking = false;
+    double fll_bandwidth_hz = FLL_BANDWIDTH_HZ;
+
+    // Tuner crystal error, rtl_sdr -p convention. An explicit ppm wins
+    // over the store's entry for the device; the store (shared between
+    // sessions, outliving them) is updated in join() from channels with
+    // a Doppler profile, and seeds the next session on the device.
+    bool ppm_set = false;
+    double ppm = 0.0;
+    PpmStore* ppm_store = nullptr;
+
+    // Further carriers split out of the stream alongside `frequency` by
+    // the channelizer (channelizer.h) and demodulated in parallel, each
+    // with its own NCO, Doppler profile, WAV and decode thread.
+    // frequency + tune_offset_hz has to leave all of them in the band.
+    std::vector<ChannelConfig> channels;
+
+    // Live spectrum rows in /dev/shm/satgs-wf-<name> (empty = off). The
+    // tap is rate limited and lossy: a row is only copied from the slab
+    // when one is due and the niced spectrum thread has taken the last.
+    std::string waterfall_name;
+    SpectrumConfig spectrum;
+
+    // Cores for the reader and worker threads (-1 = leave to the OS)
+    int reader_core = -1;
+    int worker_core = -1;
+
+    // Real-time setup: SCHED_FIFO for the reader (0 = normal priority;
+    // the DSP worker always stays normal) and the pool locked in RAM,
+    // where the host allows it (thread_util.h; see print_placement())
+    int reader_rt_priority = 0;
+    bool lock_memory = false;
+
+    // Borrow the device from a pool, which keeps it open after the
+    // session is destroyed (nullptr = open and close it here); an open,
+    // tuned device is only sent the settings that differ
+    DevicePool* device_pool = nullptr;
+
+    // Stage shedding under CPU or disk pressure, before the callback has
+    // to drop transfers (load_manager.h): the waterfall, the raw I/Q (or
+    // first its decimated sidecar), then the further channels, never the
+    // primary. A raw capture that resumes has the span as a gap (.sgc and
+    // SigMF), a shed channel gets silence. Lossless sources shed nothing.
+    LoadConfig load;
+};
+
+// Where the Decimated load step writes: "pass.sgc" -> "pass.lowrate.sgc"
+std::string lowrate_capture_path(const std::string& filename);
+
+// Snapshot of a session's counters
+struct CaptureStats {
+    uint64_t samples = 0;
+    uint64_t bytes_written = 0;
+    uint64_t buffered_writes = 0; // O_DIRECT writes that fell back to the page cache
+    uint64_t overflows = 0;       // Transfers dropped (pool exhausted)
+
+    // Paced sources' sample counts are checked against the arrival clock:
+    // samples lost upstream are a jump in the stream position, written as
+    // a gap (.sgc, SigMF) and as silence in the audio, so line timing holds
+    uint64_t gaps = 0;            // Upstream discontinuities (dongle / USB)
+    uint64_t gap_samples = 0;     // ... and the samples they lost
+    uint64_t audio_samples = 0;   // Summed over the channels
+    uint64_t decode_stalls = 0;   // Worker waits on a full decoder ring
+    uint64_t image_lines = 0;
+    uint64_t spectrum_rows = 0;   // Waterfall rows published
+    uint64_t lowrate_bytes = 0;   // Written to the decimated sidecar
+    size_t queued = 0;            // Slabs waiting on the worker
+    double doppler_hz = 0.0;      // Most recent NCO correction (first channel)
+    double carrier_error_hz = 0.0;        // Offset measured on the last block (first channel)
+    double carrier_correction_hz = 0.0;   // Carrier loop's share of the shift
+    bool carrier_locked = false;
+};
+
+class CaptureSession {
+public:
+    explicit CaptureSession(const CaptureConfig& config);
+    ~CaptureSession();
+
+    CaptureSession(const CaptureSession&) = delete;
+    CaptureSession& operator=(const CaptureSession&) = delete;
+
+    // Open and configure the device and the output files, and register
+    // the raw writer with io (which must not be running yet)
+    bool open(IoScheduler& io);
+
+    // Start the reader and worker threads
+    bool start();
+
+    // Start now, keeping samples from Unix time start_utc on; the
+    // duration counts from there. Called STREAM_PREROLL_SEC ahead, the
+    // thread start and USB setup are out of the way by then; the callback
+    // drops what arrives earlier, cutting the transfer that spans it. A
+    // lossless source starts at once.
+    bool start_at(double start_utc);
+
+    // Stream length counted from start(), for a session opened ahead of
+    // time (satgs_pass warms up before AOS); before start()
+    void set_duration(int duration_sec) { config_.duration_sec = duration_sec; }
+
+    // Ask the stream to end; returns immediately
+    void stop();
+
+    // Wait for the reader, worker and the session's disk writes
+    bool join();
+
+    bool running() const { return running_; }
+    CaptureStats stats() const;
+    const LatencyHistogram& write_latency() const { return write_latency_; }
+    const LatencyHistogram& callback_jitter() const { return callback_jitter_; }
+    const LoadManager& load() const { return load_; }
+    const CaptureConfig& config() const { return config_; }
+
+    // Seconds from the end of the stream to the final image being on
+    // disk (the last of them); after join(), -1 without an image
+    double image_latency_sec() const;
+
+    // Carriers being demodulated; after open()
+    size_t num_channels() const { return channels_.size(); }
+
+    // APT lines with a sync pulse on channel i: `frequency` first if it
+    // has audio or an image, then config().channels; 0 without an image
+    uint64_t lines_synced(size_t channel) const;
+
+    // Receiver key and the tuner error corrected from the first sample;
+    // after open()
+    const std::string& device_id() const { return device_id_; }
+    double ppm_applied() const { return ppm_applied_; }
+
+    // The pass's estimate of the tuner error; after join(), false without
+    // PPM_LEARN_MIN_SEC of lock on a channel with a Doppler profile
+    bool learned_ppm(double& ppm) const;
+
+    // Real-time multiple of the source (0 = as fast as the pipeline runs)
+    double speed() const { return source_ ? source_->speed() : 1.0; }
+
+    void print_config(std::ostream& out) const;
+    void print_summary(std::ostream& out) const;
+
+    // Cores, priorities and memory locking the session was granted;
+    // after start()
+    void print_placement(std::ostream& out) const;
+    const ThreadPlacement& reader_placement() const { return reader_placement_; }
+    const ThreadPlacement& worker_placement() const { return worker_placement_; }
+
+    // This session's samples for the metrics endpoint; call from one
+    // thread only (the metrics server)
+    void collect_metrics(MetricsWriter& out) const;
+
+private:
+    static void callback(unsigned char* buf, uint32_t len, void* ctx);
+    uint64_t check_continuity(int64_t arrival_ns, uint64_t first_sample, uint32_t len);
+    bool calibrate();
+    void reader_loop();
+    void worker_loop();
+    void decoder_loop(DemodChannel* channel);
+    void run_channel(DemodChannel& channel, const SlabRef& ref, const uint8_t* iq, const cf32* baseband,
+                     size_t baseband_count);
+    void push_audio(DemodChannel& channel, const float* audio, size_t count);
+    void silence_channel(DemodChannel& channel, const SlabRef& ref);
+    void tap_spectrum(const SlabRef& ref, const uint8_t* data);
+    bool open_lowrate(IoScheduler& io, CaptureMetadata metadata);
+    void write_lowrate(const SlabRef& ref, const uint8_t* data);
+    void update_load(const SlabRef& ref, std::chrono::steady_clock::time_point begin);
+    void spectrum_loop();
+    double channel_shift_hz(const DemodChannel& channel, uint64_t sample) const;
+    void track_carrier(DemodChannel& channel, double block_sec);
+    bool open_channels();
+    std::string channel_name(const DemodChannel& channel) const;
+
+    CaptureConfig config_;
+    std::unique_ptr<SampleSource> source_;
+    uint64_t sample_limit_ = 0;           // Stream ends here (duration_sec worth)
+    double carrier_offset_hz_ = 0.0;      // Nominal carrier minus actual tuner center
+    std::string device_id_;
+    double tuner_hz_ = 0.0;               // Center the source reports (else the requested one)
+    double ppm_applied_ = 0.0;
+    double ppm_shift_hz_ = 0.0;           // ppm_applied_ at the tuner frequency
+    bool ppm_from_store_ = false;
+    double ppm_stored_ = 0.0;             // Store value after this pass (join)
+    bool ppm_updated_ = false;
+
+    // Slabs are allocated once in open(); the callback only moves indices around
+    std::unique_ptr<BufferPool> pool_;
+    std::unique_ptr<BufferQueue> queue_;
+    IoScheduler* io_ = nullptr;
+    int io_channel_ = -1;                 // -1 = no raw output
+    LatencyHistogram write_latency_;      // Submit-to-completion per write
+    LatencyHistogram callback_jitter_;    // |transfer interval - nominal| (paced sources)
+
+    // Stage shedding (worker only but for the published values). The
+    // sidecar channel drains its own pool of decimated slabs.
+    LoadManager load_;
+    std::chrono::steady_clock::time_point load_time_;
+    uint64_t load_overflows_ = 0;
+    std::string lowrate_filename_;
+    std::unique_ptr<BufferPool> lowrate_pool_;
+    int lowrate_channel_ = -1;            // -1 = no Decimated step
+    int lowrate_decimation_ = 1;
+    DecimatingFIR lowrate_fir_;
+    std::vector<cf32> lowrate_in_;
+    std::vector<cf32> lowrate_out_;
+    uint64_t lowrate_next_ = 0;           // Full-rate sample the filter expects next
+    uint64_t lowrate_position_ = 0;       // Its low-rate position
+    std::atomic<uint64_t> lowrate_samples_{0};
+
+    // Demodulated carriers: the primary one (if it has audio or an image)
+    // first, then config_.channels. The channelizer and the pool only
+    // exist when there are further channels.
+    std::vector<std::unique_ptr<DemodChannel>> channels_;
+    std::unique_ptr<Channelizer> channelizer_;
+    std::unique_ptr<ThreadPool> channel_pool_;
+    std::atomic<bool> worker_done_{false};        // Worker has handled its last slab
+
+    // Spectrum side tap: one row's input, handed over by the pending flag
+    std::unique_ptr<SpectrumAnalyzer> spectrum_;
+    std::unique_ptr<WaterfallPublisher> waterfall_;
+    std::thread spectrum_thread_;
+    std::vector<uint8_t> spectrum_input_;
+    double spectrum_utc_ = 0.0;
+    std::atomic<bool> spectrum_pending_{false};
+    std::chrono::steady_clock::time_point spectrum_due_;  // Worker only
+    std::atomic<uint64_t> spectrum_rows_{0};
+
+    std::thread reader_;
+    std::thread worker_;
+    ThreadPlacement reader_placement_;
+    ThreadPlacement worker_placement_;
+    std::atomic<int> threads_placed_{0};
+    MemoryLock memory_lock_ = MemoryLock::None;
+    int memory_lock_error_ = 0;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> stream_done_{false};  // Set once stream() has returned
+    std::atomic<bool> failed_{false};     // Set by the reader or the worker
+
+    std::chrono::steady_clock::time_point wall_start_;  // Start, or the first sample kept (start_at)
+    std::chrono::steady_clock::time_point wall_end_;
+
+    // start_at() gate (reader thread only while streaming)
+    double start_at_utc_ = 0.0;           // 0 = keep everything
+    bool gate_open_ = true;
+    double first_transfer_utc_ = 0.0;     // On air, 0 = none yet
+    std::atomic<double> start_lag_sec_{-1.0};   // First sample kept past it (< 0 = none yet)
+
+    // Reader and worker counters on separate cache lines, so neither
+    // thread's stores keep invalidating the line the other writes
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> samples_captured_{0};
+    std::atomic<uint64_t> overflows_{0};
+    std::atomic<double> stream_start_utc_{0.0};   // Unix time of the first transfer (sample, start_at)
+    std::atomic<uint64_t> gaps_{0};
+    std::atomic<uint64_t> gap_samples_{0};
+
+    // Continuity tracking (reader thread only). lag = samples the arrival
+    // clock says should have come minus those that did, relative to the
+    // first transfer; its minimum over a window of transfers is the
+    // backlog-free value.
+    int64_t last_callback_ns_ = 0;
+    int64_t origin_ns_ = 0;
+    uint64_t origin_sample_ = 0;
+    double lag_ref_ = 0.0;                        // Window minimum with no gap pending
+    double lag_min_ = 0.0;                        // Current window's minimum
+    double lag_pending_ = -1.0;                   // Step seen in the last window (< 0 = none)
+    int window_count_ = 0;
+    bool lag_ref_set_ = false;
+
+    // Rate between scrapes (metrics thread only)
+    alignas(CACHE_LINE_SIZE) mutable uint64_t scrape_samples_ = 0;
+    mutable std::chrono::steady_clock::time_point scrape_time_;
+};
+
+#endif // SATGS_CAPTURE_SESSION_H
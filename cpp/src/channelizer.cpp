@@ -0,0 +1,146 @@
+/*
+ * channelizer.cpp
+ * Satellite Ground Station - Wideband FFT Channelizer
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#include "channelizer.h"
+#include "dsp_pipeline.h"
+#include "fft.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+static const double kPi = 3.14159265358979323846;
+
+// Index in [0, m) for any signed bin
+static size_t wrap(long bin, size_t m) {
+    long r = bin % static_cast<long>(m);
+    return static_cast<size_t>(r < 0 ? r + static_cast<long>(m) : r);
+}
+
+bool Channelizer::configure(uint32_t input_rate, const std::vector<double>& offsets_hz,
+                            double channel_bw_hz, bool iq_correction) {
+    input_rate_ = input_rate;
+    iq_correction_ = iq_correction;
+
+    // Largest power-of-two decimation that keeps the output rate up
+    decimation_ = 1;
+    while (input_rate % (decimation_ * 2) == 0 && input_rate / (decimation_ * 2) >= CHANNELIZER_MIN_RATE) {
+        decimation_ *= 2;
+    }
+    output_rate_ = input_rate / decimation_;
+
+    // Everything the channel can move to stays clear of what aliases in
+    double passband = channel_bw_hz / 2.0 + CHANNELIZER_MARGIN_HZ;
+    double stopband = output_rate_ - passband;
+    if (stopband <= passband) {
+        std::cerr << "Error: Sample rate " << input_rate << " Hz too low to channelize "
+                  << channel_bw_hz / 1e3 << " kHz channels\n";
+        return false;
+    }
+    std::vector<float> taps = design_lowpass(input_rate, (passband + stopband) / 2.0,
+                                             lowpass_num_taps(input_rate, stopband - passband));
+    num_taps_ = taps.size();
+
+    // Overlap covers the filter history and keeps the decimation phase
+    overlap_ = (num_taps_ - 1 + decimation_ - 1) / decimation_ * decimation_;
+    fft_size_ = fft_size_at_least(std::max<size_t>(CHANNELIZER_BLOCK_FACTOR * overlap_, 2 * decimation_));
+    out_size_ = fft_size_ / decimation_;
+    forward_ = &fft_plan(fft_size_);
+    inverse_ = &fft_plan(out_size_);
+
+    // Prototype response over the bins folded into each output: +/- one
+    // output rate, beyond which the stopband is negligible
+    std::vector<cf32> h(fft_size_, cf32(0.0f, 0.0f));
+    for (size_t i = 0; i < num_taps_; i++) h[i] = cf32(taps[i], 0.0f);
+    forward_->forward(h.data());
+    size_t width = std::min(2 * out_size_, fft_size_);
+    response_.resize(width);
+    for (size_t j = 0; j < width; j++) {
+        long bin = static_cast<long>(j) - static_cast<long>(width / 2);
+        response_[j] = h[wrap(bin, fft_size_)] / static_cast<float>(fft_size_);
+    }
+
+    bins_.clear();
+    double bin_hz = static_cast<double>(input_rate) / fft_size_;
+    for (double offset : offsets_hz) {
+        if (std::abs(offset) + passband > input_rate / 2.0) {
+            std::cerr << "Error: Channel at " << offset / 1e3 << " kHz from the tuner is outside the "
+                      << input_rate / 1e6 << " MHz captured band\n";
+            return false;
+        }
+        bins_.push_back(std::lround(offset / bin_hz));
+    }
+    phase_step_ = -2.0 * kPi * static_cast<double>(fft_size_ - overlap_) / fft_size_;
+
+    folded_.resize(out_size_);
+    spectrum_.resize(fft_size_);
+    reset();
+    return true;
+}
+
+void Channelizer::reset() {
+    iq_corrector_.reset();
+    input_.assign(overlap_, cf32(0.0f, 0.0f));
+    // The first block starts overlap_ samples before the stream
+    phase_.resize(bins_.size());
+    for (size_t c = 0; c < bins_.size(); c++) {
+        phase_[c] = std::remainder(2.0 * kPi * bins_[c] * static_cast<double>(overlap_) / fft_size_, 2.0 * kPi);
+    }
+}
+
+double Channelizer::channel_center_hz(size_t c) const {
+    return static_cast<double>(bins_[c]) * input_rate_ / fft_size_;
+}
+
+void Channelizer::process(const uint8_t* iq, size_t num_bytes, std::vector<std::vector<cf32>>& out) {
+    size_t n = num_bytes / 2;
+    converted_.resize(n);
+    dsp_kernels().u8_to_cf32(iq, converted_.data(), n);
+    if (iq_correction_) {
+        iq_corrector_.process(converted_.data(), n);
+    }
+    input_.insert(input_.end(), converted_.begin(), converted_.end());
+    out.resize(bins_.size());
+
+    const size_t step = fft_size_ - overlap_;
+    size_t pos = 0;
+    while (pos + fft_size_ <= input_.size()) {
+        std::copy(input_.begin() + pos, input_.begin() + pos + fft_size_, spectrum_.begin());
+        run_block(out);
+        pos += step;
+    }
+    // Keep the overlap and the partial block for next time
+    input_.erase(input_.begin(), input_.begin() + pos);
+}
+
+// spectrum_ holds the time-domain block on entry
+void Channelizer::run_block(std::vector<std::vector<cf32>>& out) {
+    forward_->forward(spectrum_.data());
+
+    const size_t width = response_.size();
+    const long half = static_cast<long>(width / 2);
+    const size_t first = overlap_ / decimation_;
+    for (size_t c = 0; c < bins_.size(); c++) {
+        // Shift the channel to bin 0, filter, and alias the band down to
+        // M bins: the spectrum of every D-th output sample
+        std::fill(folded_.begin(), folded_.end(), cf32(0.0f, 0.0f));
+        for (size_t j = 0; j < width; j++) {
+            long bin = static_cast<long>(j) - half;
+            folded_[wrap(bin, out_size_)] += spectrum_[wrap(bin + bins_[c], fft_size_)] * response_[j];
+        }
+        inverse_->inverse(folded_.data());
+
+        // The shift was relative to the block start; rotate onto the
+        // stream's time base
+        std::complex<double> z = std::polar(1.0, phase_[c]);
+        cf32 rotate(static_cast<float>(z.real()), static_cast<float>(z.imag()));
+        std::vector<cf32>& dest = out[c];
+        for (size_t m = first; m < out_size_; m++) dest.push_back(folded_[m] * rotate);
+        phase_[c] = std::remainder(phase_[c] + phase_step_ * bins_[c], 2.0 * kPi);
+    }
+}
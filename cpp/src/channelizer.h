@@ -0,0 +1,88 @@
+/*
+ * channelizer.h
+ * Satellite Ground Station - Wideband FFT Channelizer
+ *
+ * Splits one wideband capture into several narrow channels, so a single
+ * 2.4 MS/s stream centred in the 137 MHz band yields NOAA 15/18/19 and
+ * Meteor at once. Overlap-save FFT filter bank:
+ *
+ *   u8 I/Q -> complex float (optional DC / I/Q correction, done once)
+ *     -> N-point forward FFT per block, blocks overlapping by V samples
+ *     -> per channel: bins around the channel centre x prototype lowpass,
+ *        folded to M = N/D bins (decimation by D in the frequency domain)
+ *     -> M-point inverse FFT, first V/D outputs discarded
+ *
+ * One forward FFT serves every channel; each extra channel costs 2M
+ * multiplies and an M-point inverse per block. Channel centres snap to
+ * the bin grid (fs/N); the remainder is left to the channel's own NCO,
+ * which runs at the low output rate along with the Doppler correction.
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#ifndef SATGS_CHANNELIZER_H
+#define SATGS_CHANNELIZER_H
+
+#include "dsp_kernels.h"
+
+#include <cstdint>
+#include <vector>
+
+#define CHANNELIZER_MIN_RATE     60000     // Lowest output rate (holds a 40 kHz channel + Doppler)
+#define CHANNELIZER_MARGIN_HZ    5000.0    // Passband beyond the channel: Doppler + bin rounding
+#define CHANNELIZER_BLOCK_FACTOR 4         // FFT size >= this x the overlap
+
+class FftPlan;
+
+class Channelizer {
+public:
+    // offsets_hz: channel carriers relative to the tuner centre;
+    // channel_bw_hz: width each output must hold clean of aliases
+    bool configure(uint32_t input_rate, const std::vector<double>& offsets_hz,
+                   double channel_bw_hz, bool iq_correction);
+    void reset();
+
+    // iq is interleaved offset-binary u8 as for DemodPipeline::process.
+    // out[c] receives channel c's baseband at output_rate() (appended).
+    void process(const uint8_t* iq, size_t num_bytes, std::vector<std::vector<cf32>>& out);
+
+    size_t num_channels() const { return bins_.size(); }
+    uint32_t output_rate() const { return output_rate_; }
+
+    // Frequency channel c is actually centred on (bin grid), relative
+    // to the tuner
+    double channel_center_hz(size_t c) const;
+
+    size_t fft_size() const { return fft_size_; }
+    int decimation() const { return decimation_; }
+    size_t num_taps() const { return num_taps_; }
+
+private:
+    void run_block(std::vector<std::vector<cf32>>& out);
+
+    uint32_t input_rate_ = 0;
+    uint32_t output_rate_ = 0;
+    size_t fft_size_ = 0;           // N
+    size_t out_size_ = 0;           // M = N / D
+    int decimation_ = 1;            // D
+    size_t overlap_ = 0;            // V, a multiple of D
+    size_t num_taps_ = 0;
+    bool iq_correction_ = false;
+    const FftPlan* forward_ = nullptr;
+    const FftPlan* inverse_ = nullptr;
+
+    // Prototype response at bins -M..M-1 (index j = bin + M), scaled by 1/N
+    std::vector<cf32> response_;
+    std::vector<long> bins_;        // Centre bin per channel
+    std::vector<double> phase_;     // Per-channel block phase (radians)
+    double phase_step_ = 0.0;       // Per bin of centre, per block
+
+    DcIqCorrector iq_corrector_;
+    std::vector<cf32> input_;       // Overlap followed by samples not yet blocked
+    std::vector<cf32> spectrum_;
+    std::vector<cf32> folded_;
+    std::vector<cf32> converted_;
+};
+
+#endif // SATGS_CHANNELIZER_H
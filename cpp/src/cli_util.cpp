@@ -0,0 +1,24 @@
+/*
+ * cli_util.cpp
+ * Satellite Ground Station - Command-line Tool Helpers
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#include "cli_util.h"
+
+#include <chrono>
+
+double utc_now() {
+    return std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+std::string json_string(const std::string& text) {
+    std::string out = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') out += '\\';
+        if (static_cast<unsigned char>(c) >= 0x20) out += c;
+    }
+    return out + "\"";
+}
@@ -0,0 +1,24 @@
+/*
+ * cli_util.h
+ * Satellite Ground Station - Command-line Tool Helpers
+ *
+ * Wall-clock time and JSON string quoting shared by the tools that write
+ * mission log, schedule and archive JSON.
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#ifndef SATGS_CLI_UTIL_H
+#define SATGS_CLI_UTIL_H
+
+#include <string>
+
+// Current UTC as Unix seconds
+double utc_now();
+
+// text as a quoted JSON string: quotes and backslashes escaped, control
+// characters dropped
+std::string json_string(const std::string& text);
+
+#endif // SATGS_CLI_UTIL_H
@@ -0,0 +1,80 @@
+/*
+ * correlator.cpp
+ * Satellite Ground Station - Streaming Template Correlator
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#include "correlator.h"
+#include "fft.h"
+
+#include <algorithm>
+
+bool PairCorrelator::configure(const std::vector<float>& a, const std::vector<float>& b,
+                               CorrelatorMode mode) {
+    if (a.empty() || a.size() != b.size()) return false;
+    a_ = a;
+    b_ = b;
+    const size_t m = a_.size();
+
+    bool fft = mode == CorrelatorMode::Fft ||
+               (mode == CorrelatorMode::Auto && m >= CORR_FFT_MIN_TAPS);
+    plan_ = nullptr;
+    fft_n_ = 0;
+    block_outputs_ = 0;
+    response_.clear();
+    if (fft) {
+        fft_n_ = fft_size_at_least(CORR_FFT_OVERSIZE * m);
+        plan_ = &fft_plan(fft_n_);
+        block_outputs_ = fft_n_ - m + 1;
+
+        // Correlating with h = a + jb is convolving with h[-k]; its
+        // spectrum is conj(FFT(conj(h))). The 1/N of the inverse
+        // transform is folded in.
+        response_.assign(fft_n_, cf32(0.0f, 0.0f));
+        for (size_t k = 0; k < m; k++) response_[k] = cf32(a_[k], -b_[k]);
+        plan_->forward(response_.data());
+        const float scale = 1.0f / static_cast<float>(fft_n_);
+        for (auto& r : response_) r = std::conj(r) * scale;
+        work_.resize(fft_n_);
+    }
+    reset();
+    return true;
+}
+
+void PairCorrelator::reset() {
+    history_.clear();
+    next_ = 0;
+}
+
+void PairCorrelator::process(const float* x, size_t n, std::vector<cf32>& out) {
+    history_.insert(history_.end(), x, x + n);
+    const size_t m = a_.size();
+    const DspKernels& k = dsp_kernels();
+
+    if (plan_) {
+        // Overlap-save: outputs [0, N - M] of each block are free of
+        // circular wrap-around
+        while (next_ + fft_n_ <= history_.size()) {
+            const float* src = &history_[next_];
+            for (size_t i = 0; i < fft_n_; i++) work_[i] = cf32(src[i], 0.0f);
+            plan_->forward(work_.data());
+            k.complex_multiply(work_.data(), response_.data(), work_.data(), fft_n_);
+            plan_->inverse(work_.data());
+            out.insert(out.end(), work_.begin(), work_.begin() + block_outputs_);
+            next_ += block_outputs_;
+        }
+    } else {
+        while (next_ + m <= history_.size()) {
+            const float* w = &history_[next_];
+            out.push_back(cf32(k.dot_f32(w, a_.data(), m), k.dot_f32(w, b_.data(), m)));
+            next_++;
+        }
+    }
+
+    // Keep only what the next window still needs
+    size_t consumed = std::min(next_, history_.size());
+    history_.erase(history_.begin(), history_.begin() + consumed);
+    next_ -= consumed;
+}
@@ -0,0 +1,67 @@
+/*
+ * correlator.h
+ * Satellite Ground Station - Streaming Template Correlator
+ *
+ * Slides a pair of equal-length real templates a, b along a real
+ * stream and reports both correlations as one complex value:
+ *
+ *   out[w] = sum_k x[w + k] a[k]  +  j sum_k x[w + k] b[k]
+ *
+ * Long templates go through overlap-save: each FFT block of N input
+ * samples is multiplied by the cached spectrum of (a + jb), so one
+ * forward / inverse transform pair yields N - M + 1 outputs for both
+ * templates. Short templates, where that overhead doesn't pay off
+ * (below CORR_FFT_MIN_TAPS), use the vectorized dot_f32 kernel
+ * directly. Either way output w is produced in stream order once the
+ * input reaches x[w + M - 1] (FFT mode: once its whole block has).
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#ifndef SATGS_CORRELATOR_H
+#define SATGS_CORRELATOR_H
+
+#include "dsp_kernels.h"
+
+#include <vector>
+
+#define CORR_FFT_MIN_TAPS   128     // Direct below this (crossover of radix-2 vs AVX2 dot_f32)
+#define CORR_FFT_OVERSIZE   8       // FFT block ~ this many template lengths
+
+class FftPlan;
+
+enum class CorrelatorMode {
+    Auto,       // FFT for templates of CORR_FFT_MIN_TAPS or more
+    Direct,
+    Fft
+};
+
+class PairCorrelator {
+public:
+    bool configure(const std::vector<float>& a, const std::vector<float>& b,
+                   CorrelatorMode mode = CorrelatorMode::Auto);
+    void reset();
+
+    // Append one output per window completed by x[0..n)
+    void process(const float* x, size_t n, std::vector<cf32>& out);
+
+    size_t length() const { return a_.size(); }
+    bool uses_fft() const { return plan_ != nullptr; }
+    size_t fft_size() const { return fft_n_; }
+
+private:
+    std::vector<float> a_;
+    std::vector<float> b_;
+
+    const FftPlan* plan_ = nullptr;
+    size_t fft_n_ = 0;
+    size_t block_outputs_ = 0;          // N - M + 1
+    std::vector<cf32> response_;        // Spectrum of the time-reversed template, / N
+    std::vector<cf32> work_;
+
+    std::vector<float> history_;
+    size_t next_ = 0;                   // Start of the next output window in history_
+};
+
+#endif // SATGS_CORRELATOR_H
@@ -0,0 +1,199 @@
+/*
+ * device_pool.cpp
+ * Satellite Ground Station - Persistent Device Handles
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#include "device_pool.h"
+#include "metrics.h"
+
+#include <iostream>
+#include <sstream>
+
+// ----------------------------------------------------------------------------
+// PooledSource
+// ----------------------------------------------------------------------------
+
+// A session's view of a pooled device. The pool's mutex guards the
+// device's lease fields; while on lease the rest belongs to this object.
+class PooledSource : public SampleSource {
+public:
+    PooledSource(DevicePool* pool, DevicePool::Device* device) : pool_(pool), device_(device) {}
+    ~PooledSource() override { pool_->release(device_); }
+
+    bool open() override {
+        DevicePool::Device& d = *device_;
+        if (d.is_open) {
+            std::lock_guard<std::mutex> lock(pool_->mutex_);
+            pool_->reuses_++;
+            return true;
+        }
+        if (!d.source->open()) return false;
+        std::lock_guard<std::mutex> lock(pool_->mutex_);
+        d.is_open = true;
+        d.have_rate = d.have_freq = d.have_gain = false;
+        pool_->opens_++;
+        return true;
+    }
+
+    // The device stays open for the next lease
+    void close() override {}
+
+    bool set_sample_rate(uint32_t rate) override {
+        DevicePool::Device& d = *device_;
+        if (d.have_rate && d.rate == rate) return skipped();
+        d.have_rate = d.source->set_sample_rate(rate);
+        d.rate = rate;
+        return sent(d.have_rate);
+    }
+
+    bool set_center_freq(uint32_t hz) override {
+        DevicePool::Device& d = *device_;
+        if (d.have_freq && d.freq == hz) return skipped();
+        d.have_freq = d.source->set_center_freq(hz);
+        d.freq = hz;
+        return sent(d.have_freq);
+    }
+
+    bool set_gain(int tenth_db) override {
+        DevicePool::Device& d = *device_;
+        if (d.have_gain && d.gain == tenth_db) return skipped();
+        d.have_gain = d.source->set_gain(tenth_db);
+        d.gain = tenth_db;
+        return sent(d.have_gain);
+    }
+
+    uint32_t sample_rate() const override { return device_->source->sample_rate(); }
+    uint32_t center_freq() const override { return device_->source->center_freq(); }
+    int gain() const override { return device_->source->gain(); }
+    std::string name() const override { return device_->source->name(); }
+    std::string device_id() const override { return device_->source->device_id(); }
+    double speed() const override { return device_->source->speed(); }
+
+    bool stream(SampleCallback callback, void* ctx, uint32_t num_buffers, uint32_t buffer_size) override {
+        bool ok = device_->source->stream(callback, ctx, num_buffers, buffer_size);
+        if (!ok) device_->failed = true;
+        return ok;
+    }
+
+    void cancel() override { device_->source->cancel(); }
+
+private:
+    bool skipped() {
+        std::lock_guard<std::mutex> lock(pool_->mutex_);
+        pool_->settings_skipped_++;
+        return true;
+    }
+
+    bool sent(bool ok) {
+        std::lock_guard<std::mutex> lock(pool_->mutex_);
+        pool_->settings_sent_++;
+        return ok;
+    }
+
+    DevicePool* pool_;
+    DevicePool::Device* device_;
+};
+
+// ----------------------------------------------------------------------------
+// DevicePool
+// ----------------------------------------------------------------------------
+
+DevicePool::~DevicePool() {
+    close_idle();
+}
+
+std::unique_ptr<SampleSource> DevicePool::acquire(const std::string& spec, int device_index,
+                                                  uint32_t carrier_hz) {
+    size_t colon = spec.find(':');
+    std::string kind = spec.substr(0, colon);
+    std::string rest = colon == std::string::npos ? std::string() : spec.substr(colon + 1);
+    bool pooled = kind.empty() || kind == "rtlsdr";
+    if (pooled && !rest.empty()) {
+        pooled = rest.find_first_not_of("0123456789") == std::string::npos;
+        if (pooled) device_index = std::stoi(rest);
+    }
+    // Not a device (or a bad index, which create_sample_source reports)
+    if (!pooled) return create_sample_source(spec, device_index, carrier_hz);
+
+    std::string key = "rtlsdr:" + std::to_string(device_index);
+    std::lock_guard<std::mutex> lock(mutex_);
+    Device* device = nullptr;
+    for (const auto& d : devices_) {
+        if (d->key == key) device = d.get();
+    }
+    if (!device) {
+        std::unique_ptr<SampleSource> source = create_sample_source(key, device_index, carrier_hz);
+        if (!source) return nullptr;
+        devices_.emplace_back(new Device());
+        device = devices_.back().get();
+        device->key = key;
+        device->source = std::move(source);
+    }
+    if (device->in_use) {
+        std::cerr << "Error: " << key << " is already in use by another session\n";
+        return nullptr;
+    }
+    device->in_use = true;
+    device->failed = false;
+    device->leases++;
+    return std::unique_ptr<SampleSource>(new PooledSource(this, device));
+}
+
+bool DevicePool::preopen(const std::string& spec, int device_index, uint32_t sample_rate, int gain) {
+    std::unique_ptr<SampleSource> source = acquire(spec, device_index, 0);
+    if (!source || !source->open()) return false;
+    // Left open and set by the lease unless it isn't a pooled one
+    return source->set_sample_rate(sample_rate) && source->set_gain(gain);
+}
+
+void DevicePool::release(Device* device) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    device->in_use = false;
+    if (device->failed && device->is_open) {
+        // Whatever state the dongle is in, the next lease starts afresh
+        std::cerr << "Warning: Closing " << device->key << " after a stream error\n";
+        device->source->close();
+        device->is_open = false;
+    }
+}
+
+void DevicePool::close_idle() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& d : devices_) {
+        if (d->in_use || !d->is_open) continue;
+        d->source->close();
+        d->is_open = false;
+    }
+}
+
+void DevicePool::print_status(std::ostream& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::ostringstream text;
+    for (const auto& d : devices_) {
+        text << "  " << d->key << ": " << (d->is_open ? "open" : "closed")
+             << (d->in_use ? ", in use" : "") << ", " << d->leases << " leases\n";
+    }
+    text << "  " << opens_ << " opens, " << reuses_ << " reused; " << settings_sent_ << " settings sent, "
+         << settings_skipped_ << " already in effect\n";
+    out << text.str();
+}
+
+void DevicePool::collect_metrics(MetricsWriter& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t open = 0;
+    for (const auto& d : devices_) {
+        if (d->is_open) open++;
+    }
+    out.gauge("satgs_devices_open", "Pooled devices held open", "", static_cast<double>(open));
+    out.counter("satgs_device_opens_total", "Device opens (first use or after a stream error)", "",
+                static_cast<double>(opens_));
+    out.counter("satgs_device_reuses_total", "Sessions that found their device already open", "",
+                static_cast<double>(reuses_));
+    out.counter("satgs_tuner_settings_total", "Tuner settings requested", metrics_label("result", "sent"),
+                static_cast<double>(settings_sent_));
+    out.counter("satgs_tuner_settings_total", "Tuner settings requested", metrics_label("result", "skipped"),
+                static_cast<double>(settings_skipped_));
+}
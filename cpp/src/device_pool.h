@@ -0,0 +1,94 @@
+/*
+ * device_pool.h
+ * Satellite Ground Station - Persistent Device Handles
+ *
+ * Opening a dongle costs a USB enumeration, the tuner's init sequence
+ * and a PLL settle, and every setting sent after that is a few control
+ * transfers more. A resident process (satgs_scheduler) has no reason to
+ * pay that at each warm-up: the pool keeps RTL-SDR devices open between
+ * sessions and lends them out as leases.
+ *
+ * A lease is a SampleSource over the pooled device. Its close() leaves
+ * the device open, and its setters compare against what the device was
+ * last given and skip the librtlsdr call when nothing changed, so a
+ * session that follows one on the same dongle typically sends only the
+ * new center frequency. Destroying the lease returns the device; one
+ * whose stream failed is closed then, and the next lease opens it again.
+ *
+ * Only rtlsdr specs are pooled; file and synth sources are created fresh
+ * for every session, as create_sample_source does. One lease per device
+ * at a time; the pool has to outlive its leases.
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#ifndef SATGS_DEVICE_POOL_H
+#define SATGS_DEVICE_POOL_H
+
+#include "sample_source.h"
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+class MetricsWriter;
+class PooledSource;
+
+class DevicePool {
+public:
+    DevicePool() = default;
+    ~DevicePool();
+
+    DevicePool(const DevicePool&) = delete;
+    DevicePool& operator=(const DevicePool&) = delete;
+
+    // A source for spec (arguments as create_sample_source). Pooled
+    // devices come back already open when an earlier lease opened them;
+    // nullptr when the device is on lease to another session.
+    std::unique_ptr<SampleSource> acquire(const std::string& spec, int device_index, uint32_t carrier_hz);
+
+    // Open a pooled device ahead of its first session, at the rate and
+    // gain sessions will ask for; true for specs that aren't pooled
+    bool preopen(const std::string& spec, int device_index, uint32_t sample_rate, int gain);
+
+    // Close every device not on lease
+    void close_idle();
+
+    void print_status(std::ostream& out) const;
+    void collect_metrics(MetricsWriter& out) const;
+
+private:
+    friend class PooledSource;
+
+    struct Device {
+        std::string key;                  // rtlsdr:<index>
+        std::unique_ptr<SampleSource> source;
+        bool is_open = false;
+        bool in_use = false;
+        bool failed = false;              // Stream error on the current lease
+        uint64_t leases = 0;
+
+        // What the device was last set to (cleared on open)
+        bool have_rate = false;
+        bool have_freq = false;
+        bool have_gain = false;
+        uint32_t rate = 0;
+        uint32_t freq = 0;
+        int gain = 0;
+    };
+
+    void release(Device* device);
+
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<Device>> devices_;
+    uint64_t opens_ = 0;                  // Device opens (first and after a failure)
+    uint64_t reuses_ = 0;                 // Leases that found the device open
+    uint64_t settings_sent_ = 0;
+    uint64_t settings_skipped_ = 0;       // Already in effect
+};
+
+#endif // SATGS_DEVICE_POOL_H
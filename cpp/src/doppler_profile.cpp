@@ -0,0 +1,419 @@
+/*
+ * doppler_profile.cpp
+ * Satellite Ground Station - Doppler Profile Loading
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#include "doppler_profile.h"
+#include "json_reader.h"
+#include "mapped_file.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+
+// ----------------------------------------------------------------------------
+// Timestamps
+// ----------------------------------------------------------------------------
+
+bool parse_utc_timestamp(const std::string& text, double& epoch_sec) {
+    int year, month, day, hour, minute;
+    double second = 0.0;
+    int used = 0;
+    if (std::sscanf(text.c_str(), "%d-%d-%dT%d:%d%n", &year, &month, &day, &hour, &minute, &used) < 5) {
+        return false;
+    }
+    const char* rest = text.c_str() + used;
+    if (*rest == ':') {
+        int more = 0;
+        if (std::sscanf(rest, ":%lf%n", &second, &more) < 1) return false;
+        rest += more;
+    }
+    
+    // Optional zone designator: Z, +hh:mm or -hh:mm
+    double zone_sec = 0.0;
+    if (*rest == '+' || *rest == '-') {
+        int zh = 0, zm = 0;
+        if (std::sscanf(rest + 1, "%d:%d", &zh, &zm) < 1) return false;
+        zone_sec = (zh * 3600.0 + zm * 60.0) * (*rest == '-' ? -1 : 1);
+    }
+    
+    std::tm tm = {};
+    tm.tm_year = year - 1900;
+    tm.tm_mon = month - 1;
+    tm.tm_mday = day;
+    tm.tm_hour = hour;
+    tm.tm_min = minute;
+    tm.tm_sec = 0;
+    
+    time_t t = timegm(&tm);
+    if (t == static_cast<time_t>(-1)) return false;
+    
+    // Naive timestamps are UTC, as written by doppler_calc.py
+    epoch_sec = static_cast<double>(t) + second - zone_sec;
+    return true;
+}
+
+std::string format_utc_timestamp(double epoch_sec) {
+    double whole = std::floor(epoch_sec);
+    int millis = static_cast<int>(std::lround((epoch_sec - whole) * 1000.0));
+    if (millis == 1000) {
+        whole += 1.0;
+        millis = 0;
+    }
+    time_t t = static_cast<time_t>(whole);
+    std::tm tm = {};
+    gmtime_r(&t, &tm);
+    char buf[96];   // Seven ints of up to 11 characters each, not only a valid date
+    std::snprintf(buf, sizeof(buf), "%04d-%02d-%02dT%02d:%02d:%02d.%03dZ",
+                  tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
+                  tm.tm_hour, tm.tm_min, tm.tm_sec, millis);
+    return buf;
+}
+
+// ----------------------------------------------------------------------------
+// DopplerProfile
+// ----------------------------------------------------------------------------
+
+bool parse_doppler_interp(const std::string& name, DopplerInterp& interp) {
+    if (name == "linear") {
+        interp = DopplerInterp::Linear;
+    } else if (name == "hermite" || name == "cubic") {
+        interp = DopplerInterp::Hermite;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool DopplerProfile::load(const std::string& filename) {
+    MappedFile file;
+    if (!file.open(filename)) {
+        std::cerr << "Error: Cannot load Doppler profile: " << filename << std::endl;
+        return false;
+    }
+    
+    center_freq_hz = 0.0;
+    time_step_sec = 0.0;
+    aos_epoch_sec = 0.0;
+    times_sec.clear();
+    doppler_hz.clear();
+    
+    bool loaded = (file.size() >= 4 && std::memcmp(file.data(), DOPPLER_BINARY_MAGIC, 4) == 0)
+        ? loadBinary(file.data(), file.size(), filename)
+        : loadJson(file.data(), file.size(), filename);
+    return loaded && prepare();
+}
+
+bool DopplerProfile::save(const std::string& filename) const {
+    if (times_sec.size() != doppler_hz.size()) {
+        std::cerr << "Error: Doppler profile times and values differ in length" << std::endl;
+        return false;
+    }
+    
+    bool binary = filename.size() >= 4 && filename.compare(filename.size() - 4, 4, ".dpb") == 0;
+    FILE* f = std::fopen(filename.c_str(), binary ? "wb" : "w");
+    if (!f) {
+        std::cerr << "Error: Cannot write Doppler profile: " << filename << std::endl;
+        return false;
+    }
+    
+    const size_t count = times_sec.size();
+    if (binary) {
+        char header[DOPPLER_BINARY_HEADER_SIZE] = {};
+        uint32_t fields[3] = {DOPPLER_BINARY_VERSION, static_cast<uint32_t>(count), 0};
+        std::memcpy(header, DOPPLER_BINARY_MAGIC, 4);
+        std::memcpy(header + 4, fields, sizeof(fields));
+        std::memcpy(header + 16, &center_freq_hz, sizeof(double));
+        std::memcpy(header + 24, &time_step_sec, sizeof(double));
+        std::memcpy(header + 32, &aos_epoch_sec, sizeof(double));
+        std::fwrite(header, 1, sizeof(header), f);
+        std::fwrite(times_sec.data(), sizeof(double), count, f);
+        std::fwrite(doppler_hz.data(), sizeof(double), count, f);
+    } else {
+        std::fprintf(f, "{\n  \"center_freq_hz\": %.17g,\n  \"time_step_sec\": %.17g,\n",
+                     center_freq_hz, time_step_sec);
+        if (aos_epoch_sec > 0) {
+            std::fprintf(f, "  \"aos_utc\": \"%s\",\n", format_utc_timestamp(aos_epoch_sec).c_str());
+        }
+        const std::vector<double>* series[2] = {&times_sec, &doppler_hz};
+        const char* names[2] = {"times_sec", "doppler_hz"};
+        for (int s = 0; s < 2; s++) {
+            std::fprintf(f, "  \"%s\": [", names[s]);
+            for (size_t i = 0; i < count; i++) {
+                std::fprintf(f, i ? ", %.17g" : "%.17g", (*series[s])[i]);
+            }
+            std::fprintf(f, s == 0 ? "],\n" : "]\n");
+        }
+        std::fprintf(f, "}\n");
+    }
+    
+    bool ok = !std::ferror(f);
+    ok = (std::fclose(f) == 0) && ok;
+    if (!ok) {
+        std::cerr << "Error: Failed writing Doppler profile: " << filename << std::endl;
+    }
+    return ok;
+}
+
+bool DopplerProfile::loadBinary(const char* data, size_t size, const std::string& filename) {
+    uint32_t version = 0, count = 0;
+    if (size >= DOPPLER_BINARY_HEADER_SIZE) {
+        std::memcpy(&version, data + 4, sizeof(version));
+        std::memcpy(&count, data + 8, sizeof(count));
+    }
+    if (version != DOPPLER_BINARY_VERSION ||
+        size != DOPPLER_BINARY_HEADER_SIZE + 2 * sizeof(double) * static_cast<size_t>(count)) {
+        std::cerr << "Error: Bad binary Doppler profile (version " << version << ", "
+                  << size << " bytes): " << filename << std::endl;
+        return false;
+    }
+    
+    std::memcpy(&center_freq_hz, data + 16, sizeof(double));
+    std::memcpy(&time_step_sec, data + 24, sizeof(double));
+    std::memcpy(&aos_epoch_sec, data + 32, sizeof(double));
+    
+    const char* body = data + DOPPLER_BINARY_HEADER_SIZE;
+    times_sec.resize(count);
+    doppler_hz.resize(count);
+    std::memcpy(times_sec.data(), body, count * sizeof(double));
+    std::memcpy(doppler_hz.data(), body + count * sizeof(double), count * sizeof(double));
+    return true;
+}
+
+bool DopplerProfile::loadJson(const char* data, size_t size, const std::string& filename) {
+    JsonReader json(data, size);
+    std::string_view key, text;
+    std::string aos_utc;
+    
+    // "points" entries may carry their time as a UTC string; resolved
+    // against aos_utc once the whole file has been read
+    std::vector<double> point_utc;
+    bool have_points = false;
+    
+    json.begin_object();
+    while (json.next_key(key)) {
+        if (key == "center_freq_hz") {
+            json.read_number(center_freq_hz);
+        } else if (key == "time_step_sec") {
+            json.read_number(time_step_sec);
+        } else if (key == "aos_utc" && json.peek() == '"') {
+            json.read_string(text);
+            aos_utc.assign(text);
+        } else if (key == "times_sec") {
+            json.read_number_array(times_sec);
+        } else if (key == "doppler_hz") {
+            json.read_number_array(doppler_hz);
+        } else if (key == "points" && json.peek() == '[') {
+            have_points = true;
+            times_sec.clear();
+            doppler_hz.clear();
+            json.begin_array();
+            while (json.next_element()) {
+                double t = NAN, d = NAN, utc = NAN;
+                json.begin_object();
+                while (json.next_key(key)) {
+                    if (key == "time_sec" || key == "t" || key == "offset_sec") {
+                        json.read_number(t);
+                    } else if (key == "doppler_hz" || key == "doppler") {
+                        json.read_number(d);
+                    } else if ((key == "utc" || key == "time_utc") && json.peek() == '"') {
+                        json.read_string(text);
+                        if (!parse_utc_timestamp(std::string(text), utc)) utc = NAN;
+                    } else {
+                        json.skip_value();
+                    }
+                }
+                times_sec.push_back(t);
+                doppler_hz.push_back(d);
+                point_utc.push_back(utc);
+            }
+        } else {
+            json.skip_value();
+        }
+    }
+    
+    if (!json.ok()) {
+        std::cerr << "Error: Malformed Doppler profile JSON at byte " << json.error_offset()
+                  << ": " << filename << std::endl;
+        return false;
+    }
+    
+    if (!aos_utc.empty() && !parse_utc_timestamp(aos_utc, aos_epoch_sec)) {
+        std::cerr << "Warning: Cannot parse aos_utc '" << aos_utc << "' in Doppler profile" << std::endl;
+        aos_epoch_sec = 0.0;
+    }
+    
+    if (have_points) {
+        for (size_t i = 0; i < times_sec.size(); i++) {
+            if (std::isnan(times_sec[i])) {
+                if (!std::isnan(point_utc[i]) && aos_epoch_sec > 0) {
+                    times_sec[i] = point_utc[i] - aos_epoch_sec;
+                } else if (time_step_sec > 0) {
+                    times_sec[i] = i * time_step_sec;
+                }
+            }
+            if (std::isnan(times_sec[i]) || std::isnan(doppler_hz[i])) {
+                std::cerr << "Error: Doppler profile point " << i << " has no time or doppler_hz: "
+                          << filename << std::endl;
+                return false;
+            }
+        }
+    }
+    
+    return true;
+}
+
+bool DopplerProfile::prepare() {
+    if (times_sec.empty() || doppler_hz.empty()) {
+        std::cerr << "Error: Empty Doppler profile" << std::endl;
+        return false;
+    }
+    
+    if (times_sec.size() != doppler_hz.size()) {
+        std::cerr << "Error: Mismatched array sizes in Doppler profile" << std::endl;
+        return false;
+    }
+    
+    const size_t n = times_sec.size();
+    for (size_t i = 1; i < n; i++) {
+        if (!(times_sec[i] > times_sec[i-1])) {
+            std::cerr << "Error: Doppler profile times not increasing at point " << i << std::endl;
+            return false;
+        }
+    }
+    
+    slopes_.resize(n - 1);
+    for (size_t i = 0; i + 1 < n; i++) {
+        slopes_[i] = (doppler_hz[i+1] - doppler_hz[i]) / (times_sec[i+1] - times_sec[i]);
+    }
+    
+    // Three-point derivative, weighted for uneven spacing; one-sided at the ends
+    tangents_.assign(n, 0.0);
+    if (n > 1) {
+        tangents_.front() = slopes_.front();
+        tangents_.back() = slopes_.back();
+        for (size_t i = 1; i + 1 < n; i++) {
+            double h0 = times_sec[i] - times_sec[i-1];
+            double h1 = times_sec[i+1] - times_sec[i];
+            tangents_[i] = (h1 * slopes_[i-1] + h0 * slopes_[i]) / (h0 + h1);
+        }
+    }
+    
+    // doppler_calc.py writes i * time_step_sec, so this is the usual case
+    uniform_ = false;
+    if (n > 1) {
+        double step = (times_sec.back() - times_sec.front()) / (n - 1);
+        uniform_ = true;
+        for (size_t i = 1; i < n && uniform_; i++) {
+            double expected = times_sec.front() + i * step;
+            uniform_ = std::fabs(times_sec[i] - expected) <= 1e-6 * step;
+        }
+        inv_step_ = 1.0 / step;
+    }
+    
+    cursor_ = 0;
+    return true;
+}
+
+// Segment i covers [times_sec[i], times_sec[i+1]); time_sec must lie
+// strictly inside the profile
+size_t DopplerProfile::segment(double time_sec) {
+    const size_t last = times_sec.size() - 2;
+    
+    if (uniform_) {
+        size_t i = static_cast<size_t>((time_sec - times_sec.front()) * inv_step_);
+        return std::min(i, last);
+    }
+    
+    // Same or next segment as the previous call (the streaming case)
+    size_t c = cursor_;
+    if (time_sec >= times_sec[c]) {
+        if (time_sec < times_sec[c+1]) return c;
+        if (c < last && time_sec < times_sec[c+2]) return cursor_ = c + 1;
+    }
+    
+    auto it = std::upper_bound(times_sec.begin(), times_sec.end(), time_sec);
+    size_t i = static_cast<size_t>(it - times_sec.begin());
+    cursor_ = std::min(i > 0 ? i - 1 : 0, last);
+    return cursor_;
+}
+
+double DopplerProfile::evaluate(size_t seg, double time_sec) const {
+    double dt = time_sec - times_sec[seg];
+    if (interp == DopplerInterp::Linear) {
+        return doppler_hz[seg] + slopes_[seg] * dt;
+    }
+    
+    double h = times_sec[seg+1] - times_sec[seg];
+    double u = dt / h;
+    double u2 = u * u;
+    double u3 = u2 * u;
+    return (2 * u3 - 3 * u2 + 1) * doppler_hz[seg]
+         + (u3 - 2 * u2 + u) * h * tangents_[seg]
+         + (-2 * u3 + 3 * u2) * doppler_hz[seg+1]
+         + (u3 - u2) * h * tangents_[seg+1];
+}
+
+double DopplerProfile::getDoppler(double time_sec) {
+    if (times_sec.empty()) return 0.0;
+    
+    // Before first point
+    if (time_sec <= times_sec.front()) return doppler_hz.front();
+    
+    // After last point
+    if (time_sec >= times_sec.back()) return doppler_hz.back();
+    
+    return evaluate(segment(time_sec), time_sec);
+}
+
+void DopplerProfile::getDopplerBlock(double start_sec, double step_sec, float* out, size_t n) {
+    size_t k = 0;
+    while (k < n) {
+        double t = start_sec + k * step_sec;
+        if (times_sec.size() < 2 || step_sec <= 0.0 ||
+            t <= times_sec.front() || t >= times_sec.back()) {
+            out[k++] = static_cast<float>(getDoppler(t));
+            continue;
+        }
+        
+        // Every sample up to the end of this segment shares one polynomial
+        size_t seg = segment(t);
+        double remaining = (times_sec[seg+1] - t) / step_sec;
+        size_t count = std::min<size_t>(n - k, static_cast<size_t>(std::ceil(remaining)));
+        if (count == 0) count = 1;
+        
+        double dt0 = t - times_sec[seg];
+        if (interp == DopplerInterp::Linear) {
+            double base = doppler_hz[seg] + slopes_[seg] * dt0;
+            double inc = slopes_[seg] * step_sec;
+            for (size_t j = 0; j < count; j++) {
+                out[k + j] = static_cast<float>(base + inc * j);
+            }
+        } else {
+            double h = times_sec[seg+1] - times_sec[seg];
+            double d0 = doppler_hz[seg], d1 = doppler_hz[seg+1];
+            double m0 = h * tangents_[seg], m1 = h * tangents_[seg+1];
+            double inv_h = 1.0 / h;
+            for (size_t j = 0; j < count; j++) {
+                double u = (dt0 + step_sec * j) * inv_h;
+                double u2 = u * u;
+                double u3 = u2 * u;
+                out[k + j] = static_cast<float>((2 * u3 - 3 * u2 + 1) * d0 + (u3 - 2 * u2 + u) * m0
+                                              + (-2 * u3 + 3 * u2) * d1 + (u3 - u2) * m1);
+            }
+        }
+        k += count;
+    }
+}
+
+double DopplerProfile::getDuration() {
+    if (times_sec.empty()) return 0.0;
+    return times_sec.back();
+}
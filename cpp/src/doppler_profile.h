@@ -0,0 +1,104 @@
+/*
+ * doppler_profile.h
+ * Satellite Ground Station - Doppler Profile Loading
+ *
+ * Reads the Doppler profile written by doppler_calc.py, or by
+ * doppler_tracker -b from the native SGP4 propagator. Shared by
+ * doppler_tracker (hardware retuning) and rtlsdr_capture (software NCO
+ * correction at a fixed center frequency).
+ *
+ * Two encodings, told apart by the first bytes of the file:
+ *
+ *   JSON    Parsed in one pass from a memory map. Accepts both the array
+ *           schema ("times_sec": [...], "doppler_hz": [...]) and the
+ *           object schema ("points": [{"time_sec": t, "doppler_hz": d}, ...];
+ *           t / offset_sec, doppler and utc / time_utc also accepted).
+ *
+ *   Binary  (.dpb) Little-endian, loaded with two memcpys:
+ *             char[4]  magic "SGDP"
+ *             uint32   version (1)
+ *             uint32   count
+ *             uint32   reserved (0)
+ *             float64  center_freq_hz, time_step_sec, aos_epoch_sec
+ *             float64  times_sec[count]
+ *             float64  doppler_hz[count]
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#ifndef SATGS_DOPPLER_PROFILE_H
+#define SATGS_DOPPLER_PROFILE_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#define DOPPLER_BINARY_MAGIC       "SGDP"
+#define DOPPLER_BINARY_VERSION     1
+#define DOPPLER_BINARY_HEADER_SIZE 40
+
+// Parse an ISO 8601 timestamp as written by datetime.isoformat()
+// ("2026-02-03T14:30:00", optional fraction and "Z" / "+hh:mm" zone;
+// no zone means UTC) into seconds since the Unix epoch. Returns false
+// if malformed.
+bool parse_utc_timestamp(const std::string& text, double& epoch_sec);
+
+// Inverse of parse_utc_timestamp: "2026-02-03T14:30:00.250Z"
+std::string format_utc_timestamp(double epoch_sec);
+
+enum class DopplerInterp {
+    Linear,     // Piecewise linear between profile points
+    Hermite     // Cubic Hermite with finite-difference tangents (C1 continuous)
+};
+
+bool parse_doppler_interp(const std::string& name, DopplerInterp& interp);
+
+// Doppler profile data
+//
+// Lookups are O(1): a direct index when the points are uniformly spaced
+// (the normal doppler_calc.py output), otherwise a cursor that follows
+// monotonic queries and falls back to binary search on a jump.
+// Per-segment slopes and tangents are computed once by prepare().
+struct DopplerProfile {
+    double center_freq_hz = 0.0;
+    double time_step_sec = 0.0;
+    double aos_epoch_sec = 0.0;     // AOS (times_sec == 0) as Unix time, 0 if absent
+    std::vector<double> times_sec;
+    std::vector<double> doppler_hz;
+    DopplerInterp interp = DopplerInterp::Linear;
+
+    // JSON or binary, detected from the content
+    bool load(const std::string& filename);
+
+    // Binary if the name ends in .dpb, otherwise JSON (array schema)
+    bool save(const std::string& filename) const;
+
+    // Validate the arrays and build the lookup tables. Called by load();
+    // call again after filling times_sec / doppler_hz by hand.
+    bool prepare();
+
+    // Interpolate Doppler shift at given time
+    double getDoppler(double time_sec);
+
+    // out[k] = getDoppler(start_sec + k * step_sec) for k < n. Walks
+    // segment by segment so the inner loop is a plain polynomial that
+    // the compiler can vectorize.
+    void getDopplerBlock(double start_sec, double step_sec, float* out, size_t n);
+
+    double getDuration();
+
+private:
+    bool loadJson(const char* data, size_t size, const std::string& filename);
+    bool loadBinary(const char* data, size_t size, const std::string& filename);
+    size_t segment(double time_sec);
+    double evaluate(size_t seg, double time_sec) const;
+
+    std::vector<double> slopes_;    // (d[i+1] - d[i]) / (t[i+1] - t[i])
+    std::vector<double> tangents_;  // Hermite derivative at each point
+    bool uniform_ = false;
+    double inv_step_ = 0.0;
+    size_t cursor_ = 0;             // Segment of the previous lookup
+};
+
+#endif // SATGS_DOPPLER_PROFILE_H
@@ -5,191 +5,202 @@
  * Reads Doppler profile from JSON, adjusts RTL-SDR frequency in real-time
  * during satellite pass to compensate for Doppler shift.
  *
+ * With -T/-S the shift is computed directly from the TLE with the
+ * embedded SGP4 propagator, so no profile (or Python) is needed; -b
+ * writes the next pass as a profile for rtlsdr_capture -p and exits.
+ *
+ * Tracking is anchored to the pass's wall-clock AOS, and instead of
+ * polling the loop sleeps until the shift is predicted to move by the
+ * retune threshold, so a slow part of the pass costs a wakeup per
+ * second or less.
+ *
+ * Each retune is a slow I2C transaction that glitches the stream and
+ * needs the device to itself; rtlsdr_capture -p applies the same profile
+ * as a software NCO at a fixed center frequency instead.
+ *
+ * The tuner is driven through SampleSource (sample_source.h), so
+ * --source can point the retunes at something other than a dongle.
+ * --metrics serves retune count and latency and the residual Doppler
+ * error for Prometheus.
+ *
  * Author: Luke Waszyn
  * Date: February 2026
  */
 
-#include <rtl-sdr.h>
 #include <iostream>
-#include <fstream>
-#include <sstream>
+#include <iomanip>
 #include <vector>
 #include <string>
 #include <thread>
 #include <atomic>
 #include <chrono>
+#include <algorithm>
 #include <cmath>
 #include <csignal>
+#include <memory>
 #include <getopt.h>
 
-// Simple JSON value extraction (no external dependency)
-// Only handles the specific format from doppler_calc.py
-class SimpleJSON {
-public:
-    bool load(const std::string& filename) {
-        std::ifstream file(filename);
-        if (!file) return false;
-        
-        std::stringstream buffer;
-        buffer << file.rdbuf();
-        content_ = buffer.str();
-        return true;
-    }
-    
-    double getDouble(const std::string& key) {
-        std::string search = "\"" + key + "\":";
-        size_t pos = content_.find(search);
-        if (pos == std::string::npos) return 0.0;
-        
-        pos += search.length();
-        while (pos < content_.size() && (content_[pos] == ' ' || content_[pos] == '\t'))
-            pos++;
-        
-        size_t end = pos;
-        while (end < content_.size() && (isdigit(content_[end]) || content_[end] == '.' || 
-               content_[end] == '-' || content_[end] == 'e' || content_[end] == 'E' || content_[end] == '+'))
-            end++;
-        
-        return std::stod(content_.substr(pos, end - pos));
-    }
-    
-    std::vector<double> getArray(const std::string& key) {
-        std::vector<double> result;
-        std::string search = "\"" + key + "\":";
-        size_t pos = content_.find(search);
-        if (pos == std::string::npos) return result;
-        
-        pos = content_.find('[', pos);
-        if (pos == std::string::npos) return result;
-        
-        size_t end = content_.find(']', pos);
-        if (end == std::string::npos) return result;
-        
-        std::string array_str = content_.substr(pos + 1, end - pos - 1);
-        std::stringstream ss(array_str);
-        std::string item;
-        
-        while (std::getline(ss, item, ',')) {
-            try {
-                // Trim whitespace
-                size_t start = item.find_first_not_of(" \t\n\r");
-                size_t stop = item.find_last_not_of(" \t\n\r");
-                if (start != std::string::npos && stop != std::string::npos) {
-                    result.push_back(std::stod(item.substr(start, stop - start + 1)));
-                }
-            } catch (...) {
-                // Skip invalid entries
-            }
-        }
-        return result;
-    }
-    
-private:
-    std::string content_;
-};
-
-// Doppler profile data
-struct DopplerProfile {
-    double center_freq_hz;
-    double time_step_sec;
-    std::vector<double> times_sec;
-    std::vector<double> doppler_hz;
-    
-    bool load(const std::string& filename) {
-        SimpleJSON json;
-        if (!json.load(filename)) {
-            std::cerr << "Error: Cannot load Doppler profile: " << filename << std::endl;
-            return false;
-        }
-        
-        center_freq_hz = json.getDouble("center_freq_hz");
-        time_step_sec = json.getDouble("time_step_sec");
-        times_sec = json.getArray("times_sec");
-        doppler_hz = json.getArray("doppler_hz");
-        
-        if (times_sec.empty() || doppler_hz.empty()) {
-            std::cerr << "Error: Empty Doppler profile" << std::endl;
-            return false;
-        }
-        
-        if (times_sec.size() != doppler_hz.size()) {
-            std::cerr << "Error: Mismatched array sizes in Doppler profile" << std::endl;
-            return false;
-        }
-        
-        return true;
-    }
-    
-    // Interpolate Doppler shift at given time
-    double getDoppler(double time_sec) {
-        if (times_sec.empty()) return 0.0;
-        
-        // Before first point
-        if (time_sec <= times_sec.front()) return doppler_hz.front();
-        
-        // After last point
-        if (time_sec >= times_sec.back()) return doppler_hz.back();
-        
-        // Linear interpolation
-        for (size_t i = 1; i < times_sec.size(); i++) {
-            if (time_sec <= times_sec[i]) {
-                double t0 = times_sec[i-1];
-                double t1 = times_sec[i];
-                double d0 = doppler_hz[i-1];
-                double d1 = doppler_hz[i];
-                
-                double alpha = (time_sec - t0) / (t1 - t0);
-                return d0 + alpha * (d1 - d0);
-            }
-        }
-        
-        return doppler_hz.back();
-    }
-    
-    double getDuration() {
-        if (times_sec.empty()) return 0.0;
-        return times_sec.back();
-    }
-};
+#include "cli_util.h"
+#include "doppler_profile.h"
+#include "latency_histogram.h"
+#include "metrics.h"
+#include "orbit.h"
+#include "sample_source.h"
 
 // Global state
 static std::atomic<bool> g_running(true);
-static rtlsdr_dev_t* g_dev = nullptr;
 
 void signal_handler(int signum) {
     std::cerr << "\nSignal " << signum << " received, stopping..." << std::endl;
     g_running = false;
 }
 
+#define RETUNE_THRESHOLD_HZ     10.0    // Retune once Doppler has moved this far
+#define MIN_RETUNE_INTERVAL_SEC 0.02    // Floor between wakeups (tuner I2C time)
+#define CROSSING_RESOLUTION_SEC 0.005   // Bisection stop for the predicted crossing
+#define DEFAULT_MAX_WAIT_MS     1000    // Longest sleep between checks
+
+using SteadyClock = std::chrono::steady_clock;
+
+// Earliest time after now at which |doppler(t) - applied| reaches the
+// retune threshold, looking at most max_wait ahead. The local slope gives
+// the first guess; bisection pins the crossing down, since the shift is
+// monotonic over a pass.
+template <typename DopplerFn>
+static double next_retune_time(DopplerFn& doppler, double now, double applied, double max_wait) {
+    double d0 = doppler(now);
+    double remaining = RETUNE_THRESHOLD_HZ - std::abs(d0 - applied);
+    if (remaining <= 0) return now;
+    
+    double rate = (doppler(now + 0.5) - d0) / 0.5;
+    double horizon = max_wait;
+    if (std::abs(rate) > 1e-9) {
+        horizon = std::min(max_wait, 2.0 * remaining / std::abs(rate));
+    }
+    double lo = now, hi = now + horizon;
+    if (!(std::abs(doppler(hi) - applied) >= RETUNE_THRESHOLD_HZ)) {
+        return hi;  // No crossing inside the bracket; look again from there
+    }
+    while (hi - lo > CROSSING_RESOLUTION_SEC) {
+        double mid = 0.5 * (lo + hi);
+        if (std::abs(doppler(mid) - applied) >= RETUNE_THRESHOLD_HZ) hi = mid;
+        else lo = mid;
+    }
+    return hi;
+}
+
+static void print_pass(const std::string& name, const SatellitePass& pass) {
+    std::cout << "Next pass of " << name << ":\n";
+    std::cout << "  AOS: " << format_utc_timestamp(pass.aos_unix) << "\n";
+    std::cout << "  TCA: " << format_utc_timestamp(pass.tca_unix) << " (max elevation "
+              << std::fixed << std::setprecision(1) << pass.max_elevation_deg << " deg)\n";
+    std::cout << "  LOS: " << format_utc_timestamp(pass.los_unix) << "\n";
+    std::cout.unsetf(std::ios::fixed);
+}
+
 void print_usage(const char* progname) {
     std::cout << "Usage: " << progname << " [options] -p <doppler_profile.json>\n"
+              << "       " << progname << " [options] -T <tle file> -S <satellite>\n"
               << "\nOptions:\n"
-              << "  -p <file>      Doppler profile JSON (required)\n"
+              << "  -p <file>      Doppler profile (JSON or .dpb)\n"
+              << "  -T <file>      TLE file; compute Doppler with SGP4 instead of -p\n"
+              << "  -S <name>      Satellite name or NORAD number in the TLE file\n"
+              << "  -c <file>      Station config (default: config.json)\n"
+              << "  -f <freq>      Downlink frequency in Hz (default: by satellite name,\n"
+              << "                 else capture.primary_freq_hz)\n"
+              << "  -b <file>      Write the next pass as a profile (.dpb or JSON) and exit\n"
+              << "  -s <sec>       Profile step for -b (default: 1.0)\n"
               << "  -D <device>    Device index (default: 0)\n"
-              << "  -u <interval>  Update interval in ms (default: 100)\n"
+              << "  --source=<spec>  Tuner to drive (default: rtlsdr, see rtlsdr_capture -h)\n"
+              << "  --metrics=<port>  Serve Prometheus metrics on http://" << METRICS_BIND_ADDRESS
+              << ":<port>/metrics\n"
+              << "  -a <utc>       AOS of the profile, ISO 8601 or \"now\" (default: its aos_utc, else now)\n"
+              << "  -u <interval>  Longest sleep between checks in ms (default: " << DEFAULT_MAX_WAIT_MS << ");\n"
+              << "                 retunes are scheduled for when Doppler moves "
+              << RETUNE_THRESHOLD_HZ << " Hz\n"
+              << "  -i <mode>      Interpolation: linear, hermite (default: linear)\n"
               << "  -n             Dry run - don't actually tune\n"
               << "  -h             Show this help\n"
-              << "\nThe Doppler profile is generated by doppler_calc.py\n";
+              << "\nThe Doppler profile is generated by doppler_calc.py or -b\n"
+              << "For glitch-free correction without retuning, use rtlsdr_capture -p\n";
 }
 
 int main(int argc, char* argv[]) {
     std::string profile_file;
+    std::string tle_file;
+    std::string sat_name;
+    std::string config_file = "config.json";
+    std::string build_file;
+    double frequency = 0.0;
+    double build_step = 1.0;
     int device_index = 0;
-    int update_interval_ms = 100;
+    int max_wait_ms = DEFAULT_MAX_WAIT_MS;
+    bool aos_set = false;
+    double aos_unix = 0.0;
     bool dry_run = false;
+    DopplerInterp interp = DopplerInterp::Linear;
+    std::string source_spec;
+    int metrics_port = -1;
+    
+    enum { OPT_SOURCE = 256, OPT_METRICS };
+    static const struct option long_options[] = {
+        {"source", required_argument, nullptr, OPT_SOURCE},
+        {"metrics", required_argument, nullptr, OPT_METRICS},
+        {"help",   no_argument,       nullptr, 'h'},
+        {nullptr, 0, nullptr, 0}
+    };
     
     // Parse arguments
     int opt;
-    while ((opt = getopt(argc, argv, "p:D:u:nh")) != -1) {
+    while ((opt = getopt_long(argc, argv, "p:T:S:c:f:b:s:D:u:a:i:nh", long_options, nullptr)) != -1) {
         switch (opt) {
+            case OPT_SOURCE:
+                source_spec = optarg;
+                break;
+            case OPT_METRICS:
+                metrics_port = std::stoi(optarg);
+                break;
             case 'p':
                 profile_file = optarg;
                 break;
+            case 'T':
+                tle_file = optarg;
+                break;
+            case 'S':
+                sat_name = optarg;
+                break;
+            case 'c':
+                config_file = optarg;
+                break;
+            case 'f':
+                frequency = std::stod(optarg);
+                break;
+            case 'b':
+                build_file = optarg;
+                break;
+            case 's':
+                build_step = std::stod(optarg);
+                break;
             case 'D':
                 device_index = std::stoi(optarg);
                 break;
             case 'u':
-                update_interval_ms = std::stoi(optarg);
+                max_wait_ms = std::stoi(optarg);
+                break;
+            case 'a':
+                if (std::string(optarg) == "now") {
+                    aos_unix = utc_now();
+                } else if (!parse_utc_timestamp(optarg, aos_unix)) {
+                    std::cerr << "Error: Bad AOS timestamp: " << optarg << "\n";
+                    return 1;
+                }
+                aos_set = true;
+                break;
+            case 'i':
+                if (!parse_doppler_interp(optarg, interp)) {
+                    std::cerr << "Error: Unknown interpolation: " << optarg << "\n";
+                    return 1;
+                }
                 break;
             case 'n':
                 dry_run = true;
@@ -201,85 +212,212 @@ int main(int argc, char* argv[]) {
         }
     }
     
-    if (profile_file.empty()) {
-        std::cerr << "Error: Doppler profile required (-p)\n";
+    bool use_tle = !tle_file.empty();
+    if (profile_file.empty() == !use_tle) {
+        std::cerr << "Error: Need either a Doppler profile (-p) or a TLE file (-T)\n";
         print_usage(argv[0]);
         return 1;
     }
-    
-    // Load Doppler profile
-    DopplerProfile profile;
-    if (!profile.load(profile_file)) {
+    if (use_tle && sat_name.empty()) {
+        std::cerr << "Error: -T requires a satellite name (-S)\n";
+        return 1;
+    }
+    if (!build_file.empty() && !use_tle) {
+        std::cerr << "Error: -b requires -T / -S\n";
         return 1;
     }
     
-    std::cout << "Doppler Profile Loaded:\n";
-    std::cout << "  Center frequency: " << profile.center_freq_hz / 1e6 << " MHz\n";
-    std::cout << "  Duration: " << profile.getDuration() << " seconds\n";
-    std::cout << "  Points: " << profile.times_sec.size() << "\n";
-    std::cout << "  Doppler range: " << profile.doppler_hz.front() << " to " 
-              << profile.doppler_hz.back() << " Hz\n";
+    DopplerProfile profile;
+    PassPredictor predictor;
+    SatellitePass pass = {};
+    
+    if (use_tle) {
+        GroundStation station;
+        if (!station.load(config_file)) {
+            return 1;
+        }
+        std::vector<Tle> tles;
+        if (!load_tle_file(tle_file, tles)) {
+            return 1;
+        }
+        const Tle* tle = find_tle(tles, sat_name);
+        if (!tle) {
+            std::cerr << "Error: Satellite not found in " << tle_file << ": " << sat_name << "\n";
+            return 1;
+        }
+        if (!predictor.init(*tle, station)) {
+            return 1;
+        }
+        if (frequency <= 0) {
+            frequency = downlink_freq_hz(tle->name, station.primary_freq_hz);
+        }
+        
+        if (!predictor.find_next_pass(utc_now(), 2 * 86400.0, pass)) {
+            std::cerr << "Error: No pass of " << tle->name << " above "
+                      << station.min_elevation_deg << " deg in the next 48 hours\n";
+            return 1;
+        }
+        print_pass(tle->name, pass);
+        
+        if (!build_file.empty()) {
+            auto t0 = std::chrono::steady_clock::now();
+            if (!predictor.build_profile(pass, frequency, build_step, profile) ||
+                !profile.save(build_file)) {
+                return 1;
+            }
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+            std::cout << "Wrote " << profile.times_sec.size() << " points to " << build_file
+                      << " in " << std::fixed << std::setprecision(2) << ms << " ms\n";
+            return 0;
+        }
+        std::cout << "  Downlink: " << frequency / 1e6 << " MHz\n";
+    } else {
+        // Load Doppler profile
+        if (!profile.load(profile_file)) {
+            return 1;
+        }
+        profile.interp = interp;
+        
+        std::cout << "Doppler Profile Loaded:\n";
+        std::cout << "  Center frequency: " << profile.center_freq_hz / 1e6 << " MHz\n";
+        std::cout << "  Duration: " << profile.getDuration() << " seconds\n";
+        std::cout << "  Points: " << profile.times_sec.size() << "\n";
+        std::cout << "  Doppler range: " << profile.doppler_hz.front() << " to " 
+                  << profile.doppler_hz.back() << " Hz\n";
+        frequency = profile.center_freq_hz;
+    }
     
     if (dry_run) {
         std::cout << "\n[DRY RUN MODE]\n";
     }
     
+    // Tracking window in wall-clock time. A profile runs from its aos_utc
+    // (or -a), not from process start; without either it starts now.
+    const double base_unix = utc_now();
+    const SteadyClock::time_point base_steady = SteadyClock::now();
+    double track_start, track_end, profile_epoch = 0.0;
+    if (use_tle) {
+        track_start = pass.aos_unix - predictor.station().pre_aos_margin_sec;
+        track_end = pass.los_unix + predictor.station().post_los_margin_sec;
+    } else {
+        profile_epoch = aos_set ? aos_unix : (profile.aos_epoch_sec > 0 ? profile.aos_epoch_sec : base_unix);
+        track_start = profile_epoch;
+        track_end = profile_epoch + profile.getDuration();
+    }
+    if (track_end <= base_unix) {
+        std::cerr << "Error: Pass already over (ended " << format_utc_timestamp(track_end) << ")"
+                  << (use_tle ? "" : "; use -a now to replay the profile") << "\n";
+        return 1;
+    }
+    
+    // All deadlines are steady_clock, so NTP steps can't move them
+    auto to_steady = [&](double unix_sec) {
+        return base_steady + std::chrono::duration_cast<SteadyClock::duration>(
+            std::chrono::duration<double>(unix_sec - base_unix));
+    };
+    auto now_unix = [&]() {
+        return base_unix + std::chrono::duration<double>(SteadyClock::now() - base_steady).count();
+    };
+    auto doppler_at = [&](double unix_sec) {
+        if (!use_tle) return profile.getDoppler(unix_sec - profile_epoch);
+        LookAngles look;
+        return predictor.look(unix_sec, look) ? PassPredictor::doppler_hz(look, frequency) : NAN;
+    };
+    
     // Open device (unless dry run)
+    std::unique_ptr<SampleSource> tuner;
     if (!dry_run) {
-        int device_count = rtlsdr_get_device_count();
-        if (device_count == 0) {
-            std::cerr << "Error: No RTL-SDR devices found\n";
-            return 1;
-        }
-        
-        if (rtlsdr_open(&g_dev, device_index) < 0) {
-            std::cerr << "Error: Failed to open RTL-SDR device\n";
+        tuner = create_sample_source(source_spec, device_index, static_cast<uint32_t>(frequency));
+        if (!tuner || !tuner->open()) {
             return 1;
         }
         
         // Initial frequency
-        uint32_t initial_freq = static_cast<uint32_t>(profile.center_freq_hz + profile.doppler_hz.front());
-        rtlsdr_set_center_freq(g_dev, initial_freq);
+        uint32_t initial_freq = static_cast<uint32_t>(frequency + doppler_at(std::max(base_unix, track_start)));
+        tuner->set_center_freq(initial_freq);
         
-        std::cout << "Device opened, initial frequency: " << initial_freq / 1e6 << " MHz\n";
+        std::cout << "Opened " << tuner->name() << ", initial frequency: " << initial_freq / 1e6 << " MHz\n";
     }
     
     // Install signal handlers
     signal(SIGINT, signal_handler);
     signal(SIGTERM, signal_handler);
     
+    // Sleep to the start of the window in slices, so Ctrl+C stays responsive
+    if (track_start > base_unix) {
+        std::cout << "\nWaiting for " << format_utc_timestamp(track_start) << " ("
+                  << std::fixed << std::setprecision(0) << track_start - base_unix << " s)...\n";
+        SteadyClock::time_point start_deadline = to_steady(track_start);
+        while (g_running && SteadyClock::now() < start_deadline) {
+            std::this_thread::sleep_until(std::min(start_deadline, SteadyClock::now() + std::chrono::seconds(1)));
+        }
+    }
+    
     // Tracking loop
     std::cout << "\nStarting Doppler tracking...\n";
     std::cout << "Press Ctrl+C to stop\n\n";
     
-    auto start_time = std::chrono::steady_clock::now();
-    double duration = profile.getDuration();
+    const double max_wait = max_wait_ms / 1000.0;
     double last_doppler = 0;
     uint32_t last_freq = 0;
     
+    // Written by the loop, read by the metrics thread
+    std::atomic<uint64_t> wakeups{0}, retunes{0};
+    std::atomic<double> current_doppler{0.0}, doppler_error{0.0};
+    LatencyHistogram retune_latency;
+    
+    MetricsServer metrics;
+    if (metrics_port >= 0) {
+        metrics.add_collector([&](MetricsWriter& out) {
+            out.counter("satgs_tracker_wakeups_total", "Tracking loop iterations", "",
+                        static_cast<double>(wakeups.load()));
+            out.counter("satgs_tracker_retunes_total", "Center frequency updates", "",
+                        static_cast<double>(retunes.load()));
+            out.histogram("satgs_tracker_retune_latency_seconds", "Time to apply one retune", "",
+                          retune_latency);
+            out.gauge("satgs_tracker_doppler_hz", "Predicted Doppler shift", "", current_doppler);
+            out.gauge("satgs_tracker_doppler_error_hz", "Predicted minus applied Doppler at the last wakeup",
+                      "", doppler_error);
+        });
+        if (!metrics.start(metrics_port)) {
+            return 1;
+        }
+        std::cout << "Metrics on http://" << METRICS_BIND_ADDRESS << ":" << metrics.port() << "/metrics\n";
+    }
+    
     while (g_running) {
-        auto now = std::chrono::steady_clock::now();
-        double elapsed = std::chrono::duration<double>(now - start_time).count();
+        double now = now_unix();
+        wakeups++;
         
         // Check if pass is complete
-        if (elapsed > duration) {
+        if (now > track_end) {
             std::cout << "\nPass complete.\n";
             break;
         }
         
-        // Get current Doppler shift
-        double doppler = profile.getDoppler(elapsed);
+        // Get current Doppler shift, straight from SGP4 in TLE mode
+        double doppler = doppler_at(now);
+        if (std::isnan(doppler)) {
+            std::cerr << "\nError: SGP4 propagation failed\n";
+            break;
+        }
         
         // Calculate corrected frequency
-        uint32_t corrected_freq = static_cast<uint32_t>(profile.center_freq_hz + doppler);
+        uint32_t corrected_freq = static_cast<uint32_t>(frequency + doppler);
+        current_doppler = doppler;
+        doppler_error = last_freq ? doppler - last_doppler : doppler;
         
-        // Only update if frequency changed significantly (>10 Hz)
-        if (std::abs(doppler - last_doppler) > 10 || last_freq == 0) {
-            if (!dry_run && g_dev) {
-                rtlsdr_set_center_freq(g_dev, corrected_freq);
+        // Only update if frequency changed significantly
+        if (std::abs(doppler - last_doppler) >= RETUNE_THRESHOLD_HZ || last_freq == 0) {
+            if (tuner) {
+                auto t0 = SteadyClock::now();
+                tuner->set_center_freq(corrected_freq);
+                retune_latency.record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    SteadyClock::now() - t0).count());
             }
+            retunes++;
             
-            std::cout << "\r[" << std::fixed << std::setprecision(1) << elapsed << "s] "
+            std::cout << "\r[" << std::fixed << std::setprecision(1) << now - track_start << "s] "
                       << "Doppler: " << std::setw(7) << std::setprecision(1) << doppler << " Hz, "
                       << "Freq: " << std::setprecision(6) << corrected_freq / 1e6 << " MHz"
                       << "     " << std::flush;
@@ -288,16 +426,26 @@ int main(int argc, char* argv[]) {
             last_freq = corrected_freq;
         }
         
-        std::this_thread::sleep_for(std::chrono::milliseconds(update_interval_ms));
+        // Sleep until Doppler is predicted to leave the threshold band
+        double next = next_retune_time(doppler_at, now, last_doppler, max_wait);
+        next = std::min(std::max(next, now + MIN_RETUNE_INTERVAL_SEC), track_end + MIN_RETUNE_INTERVAL_SEC);
+        std::this_thread::sleep_until(to_steady(next));
     }
     
     std::cout << std::endl;
     
     // Cleanup
-    if (g_dev) {
-        rtlsdr_close(g_dev);
+    metrics.stop();
+    if (tuner) {
+        tuner->close();
     }
     
-    std::cout << "Doppler tracking complete.\n";
+    std::cout << "Doppler tracking complete (" << retunes << " retunes, "
+              << wakeups << " wakeups";
+    if (retune_latency.count() > 0) {
+        std::cout << ", retune p50/p99 " << std::setprecision(2) << retune_latency.percentile_ms(50)
+                  << "/" << retune_latency.percentile_ms(99) << " ms";
+    }
+    std::cout << ").\n";
     return 0;
 }
@@ -0,0 +1,317 @@
+/*
+ * dsp_kernels.cpp
+ * Satellite Ground Station - Scalar reference kernels and runtime dispatch
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#include "dsp_kernels_impl.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <ostream>
+#include <random>
+#include <vector>
+
+// ----------------------------------------------------------------------------
+// Scalar reference
+// ----------------------------------------------------------------------------
+
+void scalar_u8_to_cf32(const uint8_t* in, cf32* out, size_t n) {
+    float* y = reinterpret_cast<float*>(out);
+    for (size_t i = 0; i < 2 * n; i++) {
+        y[i] = (static_cast<float>(in[i]) - 127.5f) * U8_SCALE;
+    }
+}
+
+void scalar_iq_stats(const cf32* in, size_t n, IqStats* stats) {
+    double si = 0, sq = 0, sii = 0, sqq = 0, siq = 0;
+    for (size_t i = 0; i < n; i++) {
+        double I = in[i].real();
+        double Q = in[i].imag();
+        si += I;
+        sq += Q;
+        sii += I * I;
+        sqq += Q * Q;
+        siq += I * Q;
+    }
+    stats->sum_i += si;
+    stats->sum_q += sq;
+    stats->sum_ii += sii;
+    stats->sum_qq += sqq;
+    stats->sum_iq += siq;
+    stats->count += n;
+}
+
+void scalar_iq_apply(cf32* data, size_t n, const IqCorrection* corr) {
+    for (size_t i = 0; i < n; i++) {
+        float I = data[i].real() - corr->dc_i;
+        float Q = data[i].imag() - corr->dc_q;
+        data[i] = cf32(I, (Q - corr->cross * I) * corr->q_gain);
+    }
+}
+
+void scalar_complex_multiply(const cf32* a, const cf32* b, cf32* out, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        float ar = a[i].real(), ai = a[i].imag();
+        float br = b[i].real(), bi = b[i].imag();
+        out[i] = cf32(ar * br - ai * bi, ar * bi + ai * br);
+    }
+}
+
+void scalar_fm_discriminate(const cf32* in, float* out, size_t n, cf32* last, float gain) {
+    cf32 prev = *last;
+    for (size_t i = 0; i < n; i++) {
+        cf32 z = in[i];
+        float re = z.real() * prev.real() + z.imag() * prev.imag();
+        float im = z.imag() * prev.real() - z.real() * prev.imag();
+        out[i] = fast_atan2(im, re) * gain;
+        prev = z;
+    }
+    if (n > 0) *last = prev;
+}
+
+cf32 scalar_dot_cf32_real(const cf32* x, const float* taps2, size_t n) {
+    const float* xf = reinterpret_cast<const float*>(x);
+    float re = 0.0f, im = 0.0f;
+    for (size_t k = 0; k < n; k++) {
+        re += xf[2 * k] * taps2[2 * k];
+        im += xf[2 * k + 1] * taps2[2 * k + 1];
+    }
+    return cf32(re, im);
+}
+
+float scalar_dot_f32(const float* x, const float* h, size_t n) {
+    float acc = 0.0f;
+    for (size_t k = 0; k < n; k++) acc += x[k] * h[k];
+    return acc;
+}
+
+static const DspKernels g_dsp_kernels_scalar = {
+    "scalar",
+    scalar_u8_to_cf32,
+    scalar_iq_stats,
+    scalar_iq_apply,
+    scalar_complex_multiply,
+    scalar_fm_discriminate,
+    scalar_dot_cf32_real,
+    scalar_dot_f32,
+};
+
+// ----------------------------------------------------------------------------
+// Dispatch
+// ----------------------------------------------------------------------------
+
+static bool cpu_supports(const DspKernels* k) {
+    if (k == &g_dsp_kernels_scalar) return true;
+#if defined(SATGS_DSP_HAVE_AVX2)
+    if (k == &g_dsp_kernels_avx2) {
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    }
+#endif
+#if defined(SATGS_DSP_HAVE_SSE2)
+    if (k == &g_dsp_kernels_sse2) return true;  // Baseline on x86-64
+#endif
+#if defined(SATGS_DSP_HAVE_NEON)
+    if (k == &g_dsp_kernels_neon) return true;  // Compiled only where NEON is baseline
+#endif
+    return false;
+}
+
+const DspKernels* const* dsp_kernels_available() {
+    static const DspKernels* available[5] = {nullptr};
+    static bool init = [] {
+        const DspKernels* candidates[] = {
+#if defined(SATGS_DSP_HAVE_AVX2)
+            &g_dsp_kernels_avx2,
+#endif
+#if defined(SATGS_DSP_HAVE_SSE2)
+            &g_dsp_kernels_sse2,
+#endif
+#if defined(SATGS_DSP_HAVE_NEON)
+            &g_dsp_kernels_neon,
+#endif
+            &g_dsp_kernels_scalar,
+        };
+        int count = 0;
+        for (const DspKernels* k : candidates) {
+            if (cpu_supports(k)) available[count++] = k;
+        }
+        return true;
+    }();
+    (void)init;
+    return available;
+}
+
+const DspKernels* dsp_kernels_by_name(const char* name) {
+    for (const DspKernels* const* k = dsp_kernels_available(); *k; k++) {
+        if (std::strcmp((*k)->name, name) == 0) return *k;
+    }
+    return nullptr;
+}
+
+const DspKernels& dsp_kernels_scalar() {
+    return g_dsp_kernels_scalar;
+}
+
+const DspKernels& dsp_kernels() {
+    static const DspKernels* selected = [] {
+        const char* forced = std::getenv("SATGS_DSP_KERNELS");
+        if (forced) {
+            const DspKernels* k = dsp_kernels_by_name(forced);
+            if (k) return k;
+        }
+        return dsp_kernels_available()[0];
+    }();
+    return *selected;
+}
+
+// ----------------------------------------------------------------------------
+// Verification against the scalar reference
+// ----------------------------------------------------------------------------
+
+static void report(std::ostream& out, const char* kernel, double err, double tol, bool& all_ok) {
+    bool ok = err <= tol;
+    all_ok = all_ok && ok;
+    out << "  " << std::left << std::setw(18) << kernel
+        << (ok ? "OK  " : "FAIL") << " max error " << std::scientific << std::setprecision(2)
+        << err << " (tolerance " << tol << ")" << std::defaultfloat << "\n";
+}
+
+bool dsp_kernels_verify(const DspKernels& k, std::ostream& out) {
+    const DspKernels& ref = g_dsp_kernels_scalar;
+    const size_t n = 4099;  // Odd length exercises the scalar tails
+    std::mt19937 rng(12345);
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::uniform_real_distribution<float> uni(-1.0f, 1.0f);
+
+    std::vector<uint8_t> raw(2 * n);
+    for (auto& b : raw) b = static_cast<uint8_t>(byte(rng));
+    std::vector<cf32> a(n), b(n), y_ref(n), y(n);
+    for (size_t i = 0; i < n; i++) {
+        a[i] = cf32(uni(rng), uni(rng));
+        b[i] = cf32(uni(rng), uni(rng));
+    }
+    bool all_ok = true;
+    out << "Kernels '" << k.name << "' vs scalar reference:\n";
+
+    // u8 -> cf32 (exact)
+    ref.u8_to_cf32(raw.data(), y_ref.data(), n);
+    k.u8_to_cf32(raw.data(), y.data(), n);
+    double err = 0;
+    for (size_t i = 0; i < n; i++) err = std::max<double>(err, std::abs(y[i] - y_ref[i]));
+    report(out, "u8_to_cf32", err, 0.0, all_ok);
+
+    // iq_stats (relative)
+    IqStats s_ref = {0, 0, 0, 0, 0, 0}, s = {0, 0, 0, 0, 0, 0};
+    ref.iq_stats(a.data(), n, &s_ref);
+    k.iq_stats(a.data(), n, &s);
+    err = 0;
+    const double* pr = &s_ref.sum_i;
+    const double* pk = &s.sum_i;
+    for (int i = 0; i < 5; i++) err = std::max(err, std::fabs(pk[i] - pr[i]) / n);
+    if (s.count != s_ref.count) err = 1.0;
+    report(out, "iq_stats", err, 1e-5, all_ok);
+
+    // iq_apply
+    IqCorrection corr = {0.013f, -0.021f, 0.04f, 1.07f};
+    y_ref = a;
+    y = a;
+    ref.iq_apply(y_ref.data(), n, &corr);
+    k.iq_apply(y.data(), n, &corr);
+    err = 0;
+    for (size_t i = 0; i < n; i++) err = std::max<double>(err, std::abs(y[i] - y_ref[i]));
+    report(out, "iq_apply", err, 1e-6, all_ok);
+
+    // complex_multiply
+    ref.complex_multiply(a.data(), b.data(), y_ref.data(), n);
+    k.complex_multiply(a.data(), b.data(), y.data(), n);
+    err = 0;
+    for (size_t i = 0; i < n; i++) err = std::max<double>(err, std::abs(y[i] - y_ref[i]));
+    report(out, "complex_multiply", err, 1e-6, all_ok);
+
+    // fm_discriminate, against the scalar kernel and against std::atan2 of
+    // the same float product (the polynomial's error alone)
+    std::vector<float> f_ref(n), f(n);
+    cf32 last_ref(1.0f, 0.0f), last(1.0f, 0.0f);
+    ref.fm_discriminate(a.data(), f_ref.data(), n, &last_ref, 1.0f);
+    k.fm_discriminate(a.data(), f.data(), n, &last, 1.0f);
+    err = 0;
+    double exact_err = 0;
+    cf32 prev(1.0f, 0.0f);
+    for (size_t i = 0; i < n; i++) {
+        err = std::max<double>(err, std::fabs(f[i] - f_ref[i]));
+        float re = a[i].real() * prev.real() + a[i].imag() * prev.imag();
+        float im = a[i].imag() * prev.real() - a[i].real() * prev.imag();
+        exact_err = std::max(exact_err, std::fabs(f[i] - std::atan2(static_cast<double>(im), static_cast<double>(re))));
+        prev = a[i];
+    }
+    if (last != last_ref) err = 1.0;
+    report(out, "fm_discriminate", err, 1e-5, all_ok);
+    report(out, "  vs atan2", exact_err, FAST_ATAN2_MAX_ERROR, all_ok);
+
+    // Dot products (relative to the sum of magnitudes)
+    std::vector<float> taps(n), taps2(2 * n);
+    for (size_t i = 0; i < n; i++) {
+        taps[i] = uni(rng);
+        taps2[2 * i] = taps2[2 * i + 1] = taps[i];
+    }
+    cf32 d_ref = ref.dot_cf32_real(a.data(), taps2.data(), n);
+    cf32 d = k.dot_cf32_real(a.data(), taps2.data(), n);
+    report(out, "dot_cf32_real", std::abs(d - d_ref) / n, 1e-6, all_ok);
+
+    std::vector<float> x(n);
+    for (auto& v : x) v = uni(rng);
+    float r_ref = ref.dot_f32(x.data(), taps.data(), n);
+    float r = k.dot_f32(x.data(), taps.data(), n);
+    report(out, "dot_f32", std::fabs(r - r_ref) / n, 1e-6, all_ok);
+
+    return all_ok;
+}
+
+// ----------------------------------------------------------------------------
+// DcIqCorrector
+// ----------------------------------------------------------------------------
+
+void DcIqCorrector::reset() {
+    primed_ = false;
+    mean_i_ = mean_q_ = var_i_ = var_q_ = cov_iq_ = 0;
+    corr_ = {0.0f, 0.0f, 0.0f, 1.0f};
+}
+
+void DcIqCorrector::process(cf32* data, size_t n) {
+    if (n == 0) return;
+    const DspKernels& k = dsp_kernels();
+
+    IqStats st = {0, 0, 0, 0, 0, 0};
+    k.iq_stats(data, n, &st);
+    double mi = st.sum_i / n;
+    double mq = st.sum_q / n;
+    double vi = st.sum_ii / n - mi * mi;
+    double vq = st.sum_qq / n - mq * mq;
+    double c = st.sum_iq / n - mi * mq;
+
+    if (!primed_) {
+        mean_i_ = mi; mean_q_ = mq; var_i_ = vi; var_q_ = vq; cov_iq_ = c;
+        primed_ = true;
+    } else {
+        mean_i_ += alpha_ * (mi - mean_i_);
+        mean_q_ += alpha_ * (mq - mean_q_);
+        var_i_ += alpha_ * (vi - var_i_);
+        var_q_ += alpha_ * (vq - var_q_);
+        cov_iq_ += alpha_ * (c - cov_iq_);
+    }
+
+    corr_.dc_i = static_cast<float>(mean_i_);
+    corr_.dc_q = static_cast<float>(mean_q_);
+    if (var_i_ > 1e-12) {
+        double cross = cov_iq_ / var_i_;
+        double q_perp = var_q_ - cross * cov_iq_;  // Variance of Q after removing I leakage
+        corr_.cross = static_cast<float>(cross);
+        corr_.q_gain = q_perp > 1e-12 ? static_cast<float>(std::sqrt(var_i_ / q_perp)) : 1.0f;
+    }
+
+    k.iq_apply(data, n, &corr_);
+}
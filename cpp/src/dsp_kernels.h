@@ -0,0 +1,107 @@
+/*
+ * dsp_kernels.h
+ * Satellite Ground Station - Vectorized DSP Kernels
+ *
+ * Hot per-sample loops of the streaming pipeline, each with a scalar
+ * reference and SSE2 / AVX2+FMA (x86) or NEON (ARM) implementations.
+ * The best table for the running CPU is chosen once at first use;
+ * set SATGS_DSP_KERNELS=scalar|sse2|avx2|neon to force one.
+ *
+ * Complex samples are interleaved float pairs (std::complex<float>).
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#ifndef SATGS_DSP_KERNELS_H
+#define SATGS_DSP_KERNELS_H
+
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+
+#define FAST_ATAN2_MAX_ERROR  2e-6    // rad, fm_discriminate's polynomial atan2
+
+typedef std::complex<float> cf32;
+
+// Block sums used to estimate DC offset and I/Q imbalance
+struct IqStats {
+    double sum_i;
+    double sum_q;
+    double sum_ii;
+    double sum_qq;
+    double sum_iq;
+    size_t count;
+};
+
+// out.I = (I - dc_i)
+// out.Q = ((Q - dc_q) - cross * (I - dc_i)) * q_gain
+struct IqCorrection {
+    float dc_i;
+    float dc_q;
+    float cross;
+    float q_gain;
+};
+
+struct DspKernels {
+    const char* name;
+
+    // n complex samples from 2n offset-binary bytes, scaled to [-1, 1]
+    void (*u8_to_cf32)(const uint8_t* in, cf32* out, size_t n);
+
+    // Accumulate (not reset) block statistics into stats
+    void (*iq_stats)(const cf32* in, size_t n, IqStats* stats);
+
+    // Apply DC removal and I/Q imbalance correction in place
+    void (*iq_apply)(cf32* data, size_t n, const IqCorrection* corr);
+
+    // out[i] = a[i] * b[i]; out may alias a
+    void (*complex_multiply)(const cf32* a, const cf32* b, cf32* out, size_t n);
+
+    // out[i] = angle(in[i] * conj(in[i-1])) * gain, with in[-1] = *last.
+    // Uses a polynomial atan2 (< 2e-6 rad off std::atan2) so it vectorizes.
+    // *last is updated to in[n-1].
+    void (*fm_discriminate)(const cf32* in, float* out, size_t n, cf32* last, float gain);
+
+    // sum x[k] * h[k] for complex x and real taps. taps2 holds each tap
+    // twice (h0 h0 h1 h1 ...) so it lines up with interleaved I/Q.
+    cf32 (*dot_cf32_real)(const cf32* x, const float* taps2, size_t n);
+
+    // sum x[k] * h[k]
+    float (*dot_f32)(const float* x, const float* h, size_t n);
+};
+
+// Best kernels for this CPU (or SATGS_DSP_KERNELS override)
+const DspKernels& dsp_kernels();
+
+// Scalar reference implementation
+const DspKernels& dsp_kernels_scalar();
+
+// Named table if compiled in and supported by this CPU, else nullptr
+const DspKernels* dsp_kernels_by_name(const char* name);
+
+// Compare every kernel in k against the scalar reference on random
+// data. Prints one line per kernel to out; returns true if all match.
+bool dsp_kernels_verify(const DspKernels& k, std::ostream& out);
+
+// Available tables in preference order, terminated by nullptr
+const DspKernels* const* dsp_kernels_available();
+
+// Running DC offset / I/Q imbalance corrector built on the block kernels.
+// Estimates are smoothed across blocks with time constant ~1/alpha blocks.
+class DcIqCorrector {
+public:
+    explicit DcIqCorrector(float alpha = 0.05f) : alpha_(alpha) {}
+    void process(cf32* data, size_t n);
+    void reset();
+    const IqCorrection& correction() const { return corr_; }
+
+private:
+    float alpha_;
+    bool primed_ = false;
+    double mean_i_ = 0, mean_q_ = 0, var_i_ = 0, var_q_ = 0, cov_iq_ = 0;
+    IqCorrection corr_ = {0.0f, 0.0f, 0.0f, 1.0f};
+};
+
+#endif // SATGS_DSP_KERNELS_H
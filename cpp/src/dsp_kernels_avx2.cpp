@@ -0,0 +1,205 @@
+/*
+ * dsp_kernels_avx2.cpp
+ * Satellite Ground Station - AVX2 + FMA DSP kernels
+ *
+ * Functions carry a target attribute instead of building the file with
+ * -mavx2, so no AVX-encoded copy of a shared inline template can leak
+ * into the rest of the library. Only selected at runtime when the CPU
+ * reports both AVX2 and FMA.
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#include "dsp_kernels_impl.h"
+
+#include <immintrin.h>
+
+#define AVX2_TARGET __attribute__((target("avx2,fma")))
+
+AVX2_TARGET static inline float hsum256_ps(__m256 v) {
+    __m128 lo = _mm256_castps256_ps128(v);
+    __m128 hi = _mm256_extractf128_ps(v, 1);
+    lo = _mm_add_ps(lo, hi);
+    __m128 shuf = _mm_movehdup_ps(lo);
+    __m128 sums = _mm_add_ps(lo, shuf);
+    shuf = _mm_movehl_ps(shuf, sums);
+    sums = _mm_add_ss(sums, shuf);
+    return _mm_cvtss_f32(sums);
+}
+
+AVX2_TARGET static inline __m256 atan2_ps(__m256 y, __m256 x) {
+    const __m256 abs_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    __m256 ax = _mm256_and_ps(x, abs_mask);
+    __m256 ay = _mm256_and_ps(y, abs_mask);
+    __m256 mx = _mm256_max_ps(_mm256_max_ps(ax, ay), _mm256_set1_ps(KERNEL_TINY));
+    __m256 mn = _mm256_min_ps(ax, ay);
+    __m256 z = _mm256_div_ps(mn, mx);
+    __m256 s = _mm256_mul_ps(z, z);
+    __m256 p = _mm256_set1_ps(ATAN_C11);
+    p = _mm256_fmadd_ps(p, s, _mm256_set1_ps(ATAN_C9));
+    p = _mm256_fmadd_ps(p, s, _mm256_set1_ps(ATAN_C7));
+    p = _mm256_fmadd_ps(p, s, _mm256_set1_ps(ATAN_C5));
+    p = _mm256_fmadd_ps(p, s, _mm256_set1_ps(ATAN_C3));
+    p = _mm256_fmadd_ps(p, s, _mm256_set1_ps(ATAN_C1));
+    p = _mm256_mul_ps(p, z);
+    __m256 zero = _mm256_setzero_ps();
+    p = _mm256_blendv_ps(p, _mm256_sub_ps(_mm256_set1_ps(KERNEL_HALF_PI), p),
+                         _mm256_cmp_ps(ay, ax, _CMP_GT_OQ));
+    p = _mm256_blendv_ps(p, _mm256_sub_ps(_mm256_set1_ps(KERNEL_PI), p),
+                         _mm256_cmp_ps(x, zero, _CMP_LT_OQ));
+    p = _mm256_blendv_ps(p, _mm256_sub_ps(zero, p), _mm256_cmp_ps(y, zero, _CMP_LT_OQ));
+    return p;
+}
+
+AVX2_TARGET static void avx2_u8_to_cf32(const uint8_t* in, cf32* out, size_t n) {
+    float* y = reinterpret_cast<float*>(out);
+    const size_t bytes = 2 * n;
+    const __m256 offset = _mm256_set1_ps(127.5f);
+    const __m256 scale = _mm256_set1_ps(U8_SCALE);
+    size_t i = 0;
+    for (; i + 16 <= bytes; i += 16) {
+        __m128i v0 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(in + i));
+        __m128i v1 = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(in + i + 8));
+        __m256 f0 = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(v0));
+        __m256 f1 = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(v1));
+        _mm256_storeu_ps(y + i, _mm256_mul_ps(_mm256_sub_ps(f0, offset), scale));
+        _mm256_storeu_ps(y + i + 8, _mm256_mul_ps(_mm256_sub_ps(f1, offset), scale));
+    }
+    scalar_u8_to_cf32(in + i, out + i / 2, n - i / 2);
+}
+
+AVX2_TARGET static void avx2_iq_stats(const cf32* in, size_t n, IqStats* stats) {
+    const float* x = reinterpret_cast<const float*>(in);
+    size_t i = 0;
+    double si = 0, sq = 0, sii = 0, sqq = 0, siq = 0;
+    const size_t n4 = n & ~static_cast<size_t>(3);
+    while (i < n4) {
+        size_t chunk_end = (i + 8192 < n4) ? i + 8192 : n4;
+        __m256 s = _mm256_setzero_ps();
+        __m256 s2 = _mm256_setzero_ps();
+        __m256 sx = _mm256_setzero_ps();
+        for (; i < chunk_end; i += 4) {
+            __m256 v = _mm256_loadu_ps(x + 2 * i);
+            s = _mm256_add_ps(s, v);
+            s2 = _mm256_fmadd_ps(v, v, s2);
+            sx = _mm256_fmadd_ps(v, _mm256_permute_ps(v, 0xB1), sx);
+        }
+        alignas(32) float a[8], b[8], c[8];
+        _mm256_store_ps(a, s);
+        _mm256_store_ps(b, s2);
+        _mm256_store_ps(c, sx);
+        for (int k = 0; k < 8; k += 2) {
+            si += a[k];
+            sq += a[k + 1];
+            sii += b[k];
+            sqq += b[k + 1];
+            siq += c[k];
+        }
+    }
+    stats->sum_i += si;
+    stats->sum_q += sq;
+    stats->sum_ii += sii;
+    stats->sum_qq += sqq;
+    stats->sum_iq += siq;
+    stats->count += i;
+    scalar_iq_stats(in + i, n - i, stats);
+}
+
+AVX2_TARGET static void avx2_iq_apply(cf32* data, size_t n, const IqCorrection* corr) {
+    float* x = reinterpret_cast<float*>(data);
+    const __m256 dc = _mm256_setr_ps(corr->dc_i, corr->dc_q, corr->dc_i, corr->dc_q,
+                                     corr->dc_i, corr->dc_q, corr->dc_i, corr->dc_q);
+    const __m256 cross = _mm256_setr_ps(0.0f, corr->cross, 0.0f, corr->cross,
+                                        0.0f, corr->cross, 0.0f, corr->cross);
+    const __m256 gain = _mm256_setr_ps(1.0f, corr->q_gain, 1.0f, corr->q_gain,
+                                       1.0f, corr->q_gain, 1.0f, corr->q_gain);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256 v = _mm256_sub_ps(_mm256_loadu_ps(x + 2 * i), dc);
+        __m256 ii = _mm256_moveldup_ps(v);
+        v = _mm256_mul_ps(_mm256_fnmadd_ps(cross, ii, v), gain);
+        _mm256_storeu_ps(x + 2 * i, v);
+    }
+    scalar_iq_apply(data + i, n - i, corr);
+}
+
+AVX2_TARGET static void avx2_complex_multiply(const cf32* a, const cf32* b, cf32* out, size_t n) {
+    const float* pa = reinterpret_cast<const float*>(a);
+    const float* pb = reinterpret_cast<const float*>(b);
+    float* po = reinterpret_cast<float*>(out);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256 va = _mm256_loadu_ps(pa + 2 * i);
+        __m256 vb = _mm256_loadu_ps(pb + 2 * i);
+        __m256 br = _mm256_moveldup_ps(vb);
+        __m256 bi = _mm256_movehdup_ps(vb);
+        __m256 sw = _mm256_permute_ps(va, 0xB1);  // (ai, ar, ...)
+        _mm256_storeu_ps(po + 2 * i, _mm256_fmaddsub_ps(va, br, _mm256_mul_ps(sw, bi)));
+    }
+    scalar_complex_multiply(a + i, b + i, out + i, n - i);
+}
+
+AVX2_TARGET static void avx2_fm_discriminate(const cf32* in, float* out, size_t n, cf32* last, float gain) {
+    if (n == 0) return;
+    scalar_fm_discriminate(in, out, 1, last, gain);
+    const float* x = reinterpret_cast<const float*>(in);
+    const __m256 g = _mm256_set1_ps(gain);
+    size_t i = 1;
+    for (; i + 8 <= n; i += 8) {
+        __m256 c0 = _mm256_loadu_ps(x + 2 * i);
+        __m256 c1 = _mm256_loadu_ps(x + 2 * i + 8);
+        __m256 p0 = _mm256_loadu_ps(x + 2 * i - 2);
+        __m256 p1 = _mm256_loadu_ps(x + 2 * i + 6);
+        // In-lane deinterleave; element order is (0 1 4 5 2 3 6 7) for all four
+        __m256 zr = _mm256_shuffle_ps(c0, c1, _MM_SHUFFLE(2, 0, 2, 0));
+        __m256 zi = _mm256_shuffle_ps(c0, c1, _MM_SHUFFLE(3, 1, 3, 1));
+        __m256 pr = _mm256_shuffle_ps(p0, p1, _MM_SHUFFLE(2, 0, 2, 0));
+        __m256 pi = _mm256_shuffle_ps(p0, p1, _MM_SHUFFLE(3, 1, 3, 1));
+        __m256 re = _mm256_fmadd_ps(zr, pr, _mm256_mul_ps(zi, pi));
+        __m256 im = _mm256_fmsub_ps(zi, pr, _mm256_mul_ps(zr, pi));
+        __m256 r = _mm256_mul_ps(atan2_ps(im, re), g);
+        r = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(r), _MM_SHUFFLE(3, 1, 2, 0)));
+        _mm256_storeu_ps(out + i, r);
+    }
+    *last = in[i - 1];
+    scalar_fm_discriminate(in + i, out + i, n - i, last, gain);
+}
+
+AVX2_TARGET static cf32 avx2_dot_cf32_real(const cf32* x, const float* taps2, size_t n) {
+    const float* xf = reinterpret_cast<const float*>(x);
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    size_t k = 0;
+    for (; k + 8 <= n; k += 8) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(xf + 2 * k), _mm256_loadu_ps(taps2 + 2 * k), acc0);
+        acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(xf + 2 * k + 8), _mm256_loadu_ps(taps2 + 2 * k + 8), acc1);
+    }
+    alignas(32) float a[8];
+    _mm256_store_ps(a, _mm256_add_ps(acc0, acc1));
+    cf32 tail = scalar_dot_cf32_real(x + k, taps2 + 2 * k, n - k);
+    return cf32(a[0] + a[2] + a[4] + a[6] + tail.real(),
+                a[1] + a[3] + a[5] + a[7] + tail.imag());
+}
+
+AVX2_TARGET static float avx2_dot_f32(const float* x, const float* h, size_t n) {
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    size_t k = 0;
+    for (; k + 16 <= n; k += 16) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(x + k), _mm256_loadu_ps(h + k), acc0);
+        acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(x + k + 8), _mm256_loadu_ps(h + k + 8), acc1);
+    }
+    return hsum256_ps(_mm256_add_ps(acc0, acc1)) + scalar_dot_f32(x + k, h + k, n - k);
+}
+
+const DspKernels g_dsp_kernels_avx2 = {
+    "avx2",
+    avx2_u8_to_cf32,
+    avx2_iq_stats,
+    avx2_iq_apply,
+    avx2_complex_multiply,
+    avx2_fm_discriminate,
+    avx2_dot_cf32_real,
+    avx2_dot_f32,
+};
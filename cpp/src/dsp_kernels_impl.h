@@ -0,0 +1,67 @@
+/*
+ * dsp_kernels_impl.h
+ * Satellite Ground Station - Shared pieces of the per-ISA kernel files
+ *
+ * Not part of the public API; included only by dsp_kernels*.cpp.
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#ifndef SATGS_DSP_KERNELS_IMPL_H
+#define SATGS_DSP_KERNELS_IMPL_H
+
+#include "dsp_kernels.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Minimax coefficients for atan(z), z in [0, 1]
+#define ATAN_C1   0.99997726f
+#define ATAN_C3  -0.33262347f
+#define ATAN_C5   0.19354346f
+#define ATAN_C7  -0.11643287f
+#define ATAN_C9   0.05265332f
+#define ATAN_C11 -0.01172120f
+
+#define KERNEL_PI      3.14159265f
+#define KERNEL_HALF_PI 1.57079633f
+#define KERNEL_TINY    1e-30f
+#define U8_SCALE       (1.0f / 127.5f)
+
+// Scalar polynomial atan2; the SIMD versions evaluate the same steps
+static inline float fast_atan2(float y, float x) {
+    float ax = std::fabs(x);
+    float ay = std::fabs(y);
+    float mx = std::max(std::max(ax, ay), KERNEL_TINY);
+    float mn = std::min(ax, ay);
+    float z = mn / mx;
+    float s = z * z;
+    float p = ((((ATAN_C11 * s + ATAN_C9) * s + ATAN_C7) * s + ATAN_C5) * s + ATAN_C3) * s + ATAN_C1;
+    p *= z;
+    if (ay > ax) p = KERNEL_HALF_PI - p;
+    if (x < 0.0f) p = KERNEL_PI - p;
+    if (y < 0.0f) p = -p;
+    return p;
+}
+
+// Scalar tails shared by the vector kernels
+void scalar_u8_to_cf32(const uint8_t* in, cf32* out, size_t n);
+void scalar_iq_stats(const cf32* in, size_t n, IqStats* stats);
+void scalar_iq_apply(cf32* data, size_t n, const IqCorrection* corr);
+void scalar_complex_multiply(const cf32* a, const cf32* b, cf32* out, size_t n);
+void scalar_fm_discriminate(const cf32* in, float* out, size_t n, cf32* last, float gain);
+cf32 scalar_dot_cf32_real(const cf32* x, const float* taps2, size_t n);
+float scalar_dot_f32(const float* x, const float* h, size_t n);
+
+#ifdef SATGS_DSP_HAVE_SSE2
+extern const DspKernels g_dsp_kernels_sse2;
+#endif
+#ifdef SATGS_DSP_HAVE_AVX2
+extern const DspKernels g_dsp_kernels_avx2;
+#endif
+#ifdef SATGS_DSP_HAVE_NEON
+extern const DspKernels g_dsp_kernels_neon;
+#endif
+
+#endif // SATGS_DSP_KERNELS_IMPL_H
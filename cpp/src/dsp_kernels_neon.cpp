@@ -0,0 +1,176 @@
+/*
+ * dsp_kernels_neon.cpp
+ * Satellite Ground Station - NEON DSP kernels (AArch64 / Apple Silicon)
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#include "dsp_kernels_impl.h"
+
+#include <arm_neon.h>
+
+static inline float32x4_t atan2_f32x4(float32x4_t y, float32x4_t x) {
+    float32x4_t ax = vabsq_f32(x);
+    float32x4_t ay = vabsq_f32(y);
+    float32x4_t mx = vmaxq_f32(vmaxq_f32(ax, ay), vdupq_n_f32(KERNEL_TINY));
+    float32x4_t mn = vminq_f32(ax, ay);
+    float32x4_t z = vdivq_f32(mn, mx);
+    float32x4_t s = vmulq_f32(z, z);
+    float32x4_t p = vdupq_n_f32(ATAN_C11);
+    p = vfmaq_f32(vdupq_n_f32(ATAN_C9), p, s);
+    p = vfmaq_f32(vdupq_n_f32(ATAN_C7), p, s);
+    p = vfmaq_f32(vdupq_n_f32(ATAN_C5), p, s);
+    p = vfmaq_f32(vdupq_n_f32(ATAN_C3), p, s);
+    p = vfmaq_f32(vdupq_n_f32(ATAN_C1), p, s);
+    p = vmulq_f32(p, z);
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    p = vbslq_f32(vcgtq_f32(ay, ax), vsubq_f32(vdupq_n_f32(KERNEL_HALF_PI), p), p);
+    p = vbslq_f32(vcltq_f32(x, zero), vsubq_f32(vdupq_n_f32(KERNEL_PI), p), p);
+    p = vbslq_f32(vcltq_f32(y, zero), vnegq_f32(p), p);
+    return p;
+}
+
+static void neon_u8_to_cf32(const uint8_t* in, cf32* out, size_t n) {
+    float* y = reinterpret_cast<float*>(out);
+    const size_t bytes = 2 * n;
+    const float32x4_t offset = vdupq_n_f32(127.5f);
+    const float32x4_t scale = vdupq_n_f32(U8_SCALE);
+    size_t i = 0;
+    for (; i + 16 <= bytes; i += 16) {
+        uint8x16_t v = vld1q_u8(in + i);
+        uint16x8_t lo16 = vmovl_u8(vget_low_u8(v));
+        uint16x8_t hi16 = vmovl_u8(vget_high_u8(v));
+        float32x4_t f0 = vcvtq_f32_u32(vmovl_u16(vget_low_u16(lo16)));
+        float32x4_t f1 = vcvtq_f32_u32(vmovl_u16(vget_high_u16(lo16)));
+        float32x4_t f2 = vcvtq_f32_u32(vmovl_u16(vget_low_u16(hi16)));
+        float32x4_t f3 = vcvtq_f32_u32(vmovl_u16(vget_high_u16(hi16)));
+        vst1q_f32(y + i,      vmulq_f32(vsubq_f32(f0, offset), scale));
+        vst1q_f32(y + i + 4,  vmulq_f32(vsubq_f32(f1, offset), scale));
+        vst1q_f32(y + i + 8,  vmulq_f32(vsubq_f32(f2, offset), scale));
+        vst1q_f32(y + i + 12, vmulq_f32(vsubq_f32(f3, offset), scale));
+    }
+    scalar_u8_to_cf32(in + i, out + i / 2, n - i / 2);
+}
+
+static void neon_iq_stats(const cf32* in, size_t n, IqStats* stats) {
+    const float* x = reinterpret_cast<const float*>(in);
+    size_t i = 0;
+    double si = 0, sq = 0, sii = 0, sqq = 0, siq = 0;
+    const size_t n4 = n & ~static_cast<size_t>(3);
+    while (i < n4) {
+        size_t chunk_end = (i + 8192 < n4) ? i + 8192 : n4;
+        float32x4_t s_i = vdupq_n_f32(0.0f), s_q = vdupq_n_f32(0.0f);
+        float32x4_t s_ii = vdupq_n_f32(0.0f), s_qq = vdupq_n_f32(0.0f);
+        float32x4_t s_iq = vdupq_n_f32(0.0f);
+        for (; i < chunk_end; i += 4) {
+            float32x4x2_t v = vld2q_f32(x + 2 * i);  // val[0] = I, val[1] = Q
+            s_i = vaddq_f32(s_i, v.val[0]);
+            s_q = vaddq_f32(s_q, v.val[1]);
+            s_ii = vfmaq_f32(s_ii, v.val[0], v.val[0]);
+            s_qq = vfmaq_f32(s_qq, v.val[1], v.val[1]);
+            s_iq = vfmaq_f32(s_iq, v.val[0], v.val[1]);
+        }
+        si += vaddvq_f32(s_i);
+        sq += vaddvq_f32(s_q);
+        sii += vaddvq_f32(s_ii);
+        sqq += vaddvq_f32(s_qq);
+        siq += vaddvq_f32(s_iq);
+    }
+    stats->sum_i += si;
+    stats->sum_q += sq;
+    stats->sum_ii += sii;
+    stats->sum_qq += sqq;
+    stats->sum_iq += siq;
+    stats->count += i;
+    scalar_iq_stats(in + i, n - i, stats);
+}
+
+static void neon_iq_apply(cf32* data, size_t n, const IqCorrection* corr) {
+    float* x = reinterpret_cast<float*>(data);
+    const float32x4_t dc_i = vdupq_n_f32(corr->dc_i);
+    const float32x4_t dc_q = vdupq_n_f32(corr->dc_q);
+    const float32x4_t cross = vdupq_n_f32(corr->cross);
+    const float32x4_t gain = vdupq_n_f32(corr->q_gain);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        float32x4x2_t v = vld2q_f32(x + 2 * i);
+        float32x4_t I = vsubq_f32(v.val[0], dc_i);
+        float32x4_t Q = vsubq_f32(v.val[1], dc_q);
+        v.val[0] = I;
+        v.val[1] = vmulq_f32(vfmsq_f32(Q, cross, I), gain);
+        vst2q_f32(x + 2 * i, v);
+    }
+    scalar_iq_apply(data + i, n - i, corr);
+}
+
+static void neon_complex_multiply(const cf32* a, const cf32* b, cf32* out, size_t n) {
+    const float* pa = reinterpret_cast<const float*>(a);
+    const float* pb = reinterpret_cast<const float*>(b);
+    float* po = reinterpret_cast<float*>(out);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        float32x4x2_t va = vld2q_f32(pa + 2 * i);
+        float32x4x2_t vb = vld2q_f32(pb + 2 * i);
+        float32x4x2_t r;
+        r.val[0] = vfmsq_f32(vmulq_f32(va.val[0], vb.val[0]), va.val[1], vb.val[1]);
+        r.val[1] = vfmaq_f32(vmulq_f32(va.val[0], vb.val[1]), va.val[1], vb.val[0]);
+        vst2q_f32(po + 2 * i, r);
+    }
+    scalar_complex_multiply(a + i, b + i, out + i, n - i);
+}
+
+static void neon_fm_discriminate(const cf32* in, float* out, size_t n, cf32* last, float gain) {
+    if (n == 0) return;
+    scalar_fm_discriminate(in, out, 1, last, gain);
+    const float* x = reinterpret_cast<const float*>(in);
+    const float32x4_t g = vdupq_n_f32(gain);
+    size_t i = 1;
+    for (; i + 4 <= n; i += 4) {
+        float32x4x2_t z = vld2q_f32(x + 2 * i);
+        float32x4x2_t p = vld2q_f32(x + 2 * i - 2);
+        float32x4_t re = vfmaq_f32(vmulq_f32(z.val[0], p.val[0]), z.val[1], p.val[1]);
+        float32x4_t im = vfmsq_f32(vmulq_f32(z.val[1], p.val[0]), z.val[0], p.val[1]);
+        vst1q_f32(out + i, vmulq_f32(atan2_f32x4(im, re), g));
+    }
+    *last = in[i - 1];
+    scalar_fm_discriminate(in + i, out + i, n - i, last, gain);
+}
+
+static cf32 neon_dot_cf32_real(const cf32* x, const float* taps2, size_t n) {
+    const float* xf = reinterpret_cast<const float*>(x);
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    size_t k = 0;
+    for (; k + 4 <= n; k += 4) {
+        acc0 = vfmaq_f32(acc0, vld1q_f32(xf + 2 * k), vld1q_f32(taps2 + 2 * k));
+        acc1 = vfmaq_f32(acc1, vld1q_f32(xf + 2 * k + 4), vld1q_f32(taps2 + 2 * k + 4));
+    }
+    // Lanes are (re, im, re, im); fold the two pairs together
+    float32x4_t acc = vaddq_f32(acc0, acc1);
+    float32x2_t pair = vadd_f32(vget_low_f32(acc), vget_high_f32(acc));
+    cf32 tail = scalar_dot_cf32_real(x + k, taps2 + 2 * k, n - k);
+    return cf32(vget_lane_f32(pair, 0) + tail.real(), vget_lane_f32(pair, 1) + tail.imag());
+}
+
+static float neon_dot_f32(const float* x, const float* h, size_t n) {
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    size_t k = 0;
+    for (; k + 8 <= n; k += 8) {
+        acc0 = vfmaq_f32(acc0, vld1q_f32(x + k), vld1q_f32(h + k));
+        acc1 = vfmaq_f32(acc1, vld1q_f32(x + k + 4), vld1q_f32(h + k + 4));
+    }
+    return vaddvq_f32(vaddq_f32(acc0, acc1)) + scalar_dot_f32(x + k, h + k, n - k);
+}
+
+const DspKernels g_dsp_kernels_neon = {
+    "neon",
+    neon_u8_to_cf32,
+    neon_iq_stats,
+    neon_iq_apply,
+    neon_complex_multiply,
+    neon_fm_discriminate,
+    neon_dot_cf32_real,
+    neon_dot_f32,
+};
@@ -0,0 +1,202 @@
+/*
+ * dsp_kernels_sse2.cpp
+ * Satellite Ground Station - SSE2 DSP kernels (x86-64 baseline)
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#include "dsp_kernels_impl.h"
+
+#include <emmintrin.h>
+
+static inline float hsum_ps(__m128 v) {
+    __m128 shuf = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+    __m128 sums = _mm_add_ps(v, shuf);
+    shuf = _mm_movehl_ps(shuf, sums);
+    sums = _mm_add_ss(sums, shuf);
+    return _mm_cvtss_f32(sums);
+}
+
+static inline __m128 abs_ps(__m128 v) {
+    return _mm_and_ps(v, _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff)));
+}
+
+static inline __m128 select_ps(__m128 mask, __m128 a, __m128 b) {
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+static inline __m128 atan2_ps(__m128 y, __m128 x) {
+    __m128 ax = abs_ps(x);
+    __m128 ay = abs_ps(y);
+    __m128 mx = _mm_max_ps(_mm_max_ps(ax, ay), _mm_set1_ps(KERNEL_TINY));
+    __m128 mn = _mm_min_ps(ax, ay);
+    __m128 z = _mm_div_ps(mn, mx);
+    __m128 s = _mm_mul_ps(z, z);
+    __m128 p = _mm_set1_ps(ATAN_C11);
+    p = _mm_add_ps(_mm_mul_ps(p, s), _mm_set1_ps(ATAN_C9));
+    p = _mm_add_ps(_mm_mul_ps(p, s), _mm_set1_ps(ATAN_C7));
+    p = _mm_add_ps(_mm_mul_ps(p, s), _mm_set1_ps(ATAN_C5));
+    p = _mm_add_ps(_mm_mul_ps(p, s), _mm_set1_ps(ATAN_C3));
+    p = _mm_add_ps(_mm_mul_ps(p, s), _mm_set1_ps(ATAN_C1));
+    p = _mm_mul_ps(p, z);
+    p = select_ps(_mm_cmpgt_ps(ay, ax), _mm_sub_ps(_mm_set1_ps(KERNEL_HALF_PI), p), p);
+    __m128 zero = _mm_setzero_ps();
+    p = select_ps(_mm_cmplt_ps(x, zero), _mm_sub_ps(_mm_set1_ps(KERNEL_PI), p), p);
+    p = select_ps(_mm_cmplt_ps(y, zero), _mm_sub_ps(zero, p), p);
+    return p;
+}
+
+static void sse2_u8_to_cf32(const uint8_t* in, cf32* out, size_t n) {
+    float* y = reinterpret_cast<float*>(out);
+    const size_t bytes = 2 * n;
+    const __m128 offset = _mm_set1_ps(127.5f);
+    const __m128 scale = _mm_set1_ps(U8_SCALE);
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 16 <= bytes; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        __m128i lo16 = _mm_unpacklo_epi8(v, zero);
+        __m128i hi16 = _mm_unpackhi_epi8(v, zero);
+        __m128 f0 = _mm_cvtepi32_ps(_mm_unpacklo_epi16(lo16, zero));
+        __m128 f1 = _mm_cvtepi32_ps(_mm_unpackhi_epi16(lo16, zero));
+        __m128 f2 = _mm_cvtepi32_ps(_mm_unpacklo_epi16(hi16, zero));
+        __m128 f3 = _mm_cvtepi32_ps(_mm_unpackhi_epi16(hi16, zero));
+        _mm_storeu_ps(y + i,      _mm_mul_ps(_mm_sub_ps(f0, offset), scale));
+        _mm_storeu_ps(y + i + 4,  _mm_mul_ps(_mm_sub_ps(f1, offset), scale));
+        _mm_storeu_ps(y + i + 8,  _mm_mul_ps(_mm_sub_ps(f2, offset), scale));
+        _mm_storeu_ps(y + i + 12, _mm_mul_ps(_mm_sub_ps(f3, offset), scale));
+    }
+    scalar_u8_to_cf32(in + i, out + i / 2, n - i / 2);
+}
+
+static void sse2_iq_stats(const cf32* in, size_t n, IqStats* stats) {
+    const float* x = reinterpret_cast<const float*>(in);
+    // Lanes hold (I, Q, I, Q); float partials flushed into doubles per chunk
+    size_t i = 0;
+    double si = 0, sq = 0, sii = 0, sqq = 0, siq = 0;
+    while (i + 2 <= n) {
+        size_t chunk_end = std::min(n & ~static_cast<size_t>(1), i + 8192);
+        __m128 s = _mm_setzero_ps();
+        __m128 s2 = _mm_setzero_ps();
+        __m128 sx = _mm_setzero_ps();
+        for (; i + 2 <= chunk_end; i += 2) {
+            __m128 v = _mm_loadu_ps(x + 2 * i);
+            s = _mm_add_ps(s, v);
+            s2 = _mm_add_ps(s2, _mm_mul_ps(v, v));
+            // I*Q: multiply with the pair-swapped vector
+            sx = _mm_add_ps(sx, _mm_mul_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1))));
+        }
+        alignas(16) float a[4], b[4], c[4];
+        _mm_store_ps(a, s);
+        _mm_store_ps(b, s2);
+        _mm_store_ps(c, sx);
+        si += static_cast<double>(a[0]) + a[2];
+        sq += static_cast<double>(a[1]) + a[3];
+        sii += static_cast<double>(b[0]) + b[2];
+        sqq += static_cast<double>(b[1]) + b[3];
+        siq += static_cast<double>(c[0]) + c[2];
+    }
+    stats->sum_i += si;
+    stats->sum_q += sq;
+    stats->sum_ii += sii;
+    stats->sum_qq += sqq;
+    stats->sum_iq += siq;
+    stats->count += i;
+    scalar_iq_stats(in + i, n - i, stats);
+}
+
+static void sse2_iq_apply(cf32* data, size_t n, const IqCorrection* corr) {
+    float* x = reinterpret_cast<float*>(data);
+    const __m128 dc = _mm_setr_ps(corr->dc_i, corr->dc_q, corr->dc_i, corr->dc_q);
+    const __m128 cross = _mm_setr_ps(0.0f, corr->cross, 0.0f, corr->cross);
+    const __m128 gain = _mm_setr_ps(1.0f, corr->q_gain, 1.0f, corr->q_gain);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128 v = _mm_sub_ps(_mm_loadu_ps(x + 2 * i), dc);
+        __m128 ii = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 0, 0));  // (I0, I0, I1, I1)
+        v = _mm_mul_ps(_mm_sub_ps(v, _mm_mul_ps(cross, ii)), gain);
+        _mm_storeu_ps(x + 2 * i, v);
+    }
+    scalar_iq_apply(data + i, n - i, corr);
+}
+
+static void sse2_complex_multiply(const cf32* a, const cf32* b, cf32* out, size_t n) {
+    const float* pa = reinterpret_cast<const float*>(a);
+    const float* pb = reinterpret_cast<const float*>(b);
+    float* po = reinterpret_cast<float*>(out);
+    const __m128 sign = _mm_setr_ps(-1.0f, 1.0f, -1.0f, 1.0f);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128 va = _mm_loadu_ps(pa + 2 * i);
+        __m128 vb = _mm_loadu_ps(pb + 2 * i);
+        __m128 br = _mm_shuffle_ps(vb, vb, _MM_SHUFFLE(2, 2, 0, 0));
+        __m128 bi = _mm_shuffle_ps(vb, vb, _MM_SHUFFLE(3, 3, 1, 1));
+        __m128 sw = _mm_shuffle_ps(va, va, _MM_SHUFFLE(2, 3, 0, 1));  // (ai, ar, ...)
+        __m128 r = _mm_add_ps(_mm_mul_ps(va, br), _mm_mul_ps(_mm_mul_ps(sw, bi), sign));
+        _mm_storeu_ps(po + 2 * i, r);
+    }
+    scalar_complex_multiply(a + i, b + i, out + i, n - i);
+}
+
+static void sse2_fm_discriminate(const cf32* in, float* out, size_t n, cf32* last, float gain) {
+    if (n == 0) return;
+    // First sample pairs with the previous block
+    scalar_fm_discriminate(in, out, 1, last, gain);
+    const float* x = reinterpret_cast<const float*>(in);
+    const __m128 g = _mm_set1_ps(gain);
+    size_t i = 1;
+    for (; i + 4 <= n; i += 4) {
+        __m128 c0 = _mm_loadu_ps(x + 2 * i);
+        __m128 c1 = _mm_loadu_ps(x + 2 * i + 4);
+        __m128 p0 = _mm_loadu_ps(x + 2 * i - 2);
+        __m128 p1 = _mm_loadu_ps(x + 2 * i + 2);
+        __m128 zr = _mm_shuffle_ps(c0, c1, _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 zi = _mm_shuffle_ps(c0, c1, _MM_SHUFFLE(3, 1, 3, 1));
+        __m128 pr = _mm_shuffle_ps(p0, p1, _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 pi = _mm_shuffle_ps(p0, p1, _MM_SHUFFLE(3, 1, 3, 1));
+        __m128 re = _mm_add_ps(_mm_mul_ps(zr, pr), _mm_mul_ps(zi, pi));
+        __m128 im = _mm_sub_ps(_mm_mul_ps(zi, pr), _mm_mul_ps(zr, pi));
+        _mm_storeu_ps(out + i, _mm_mul_ps(atan2_ps(im, re), g));
+    }
+    *last = in[i - 1];
+    scalar_fm_discriminate(in + i, out + i, n - i, last, gain);
+}
+
+static cf32 sse2_dot_cf32_real(const cf32* x, const float* taps2, size_t n) {
+    const float* xf = reinterpret_cast<const float*>(x);
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    size_t k = 0;
+    for (; k + 4 <= n; k += 4) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(xf + 2 * k), _mm_loadu_ps(taps2 + 2 * k)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(xf + 2 * k + 4), _mm_loadu_ps(taps2 + 2 * k + 4)));
+    }
+    __m128 acc = _mm_add_ps(acc0, acc1);
+    alignas(16) float a[4];
+    _mm_store_ps(a, acc);
+    cf32 tail = scalar_dot_cf32_real(x + k, taps2 + 2 * k, n - k);
+    return cf32(a[0] + a[2] + tail.real(), a[1] + a[3] + tail.imag());
+}
+
+static float sse2_dot_f32(const float* x, const float* h, size_t n) {
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    size_t k = 0;
+    for (; k + 8 <= n; k += 8) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(x + k), _mm_loadu_ps(h + k)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(x + k + 4), _mm_loadu_ps(h + k + 4)));
+    }
+    return hsum_ps(_mm_add_ps(acc0, acc1)) + scalar_dot_f32(x + k, h + k, n - k);
+}
+
+const DspKernels g_dsp_kernels_sse2 = {
+    "sse2",
+    sse2_u8_to_cf32,
+    sse2_iq_stats,
+    sse2_iq_apply,
+    sse2_complex_multiply,
+    sse2_fm_discriminate,
+    sse2_dot_cf32_real,
+    sse2_dot_f32,
+};
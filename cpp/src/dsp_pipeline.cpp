@@ -0,0 +1,330 @@
+/*
+ * dsp_pipeline.cpp
+ * Satellite Ground Station - Streaming FM Demodulation Pipeline
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#include "dsp_pipeline.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <numeric>
+
+static const double kPi = 3.14159265358979323846;
+
+std::vector<float> design_lowpass(double sample_rate, double cutoff_hz, int num_taps) {
+    if (num_taps < 3) num_taps = 3;
+    if (num_taps % 2 == 0) num_taps++;
+
+    std::vector<float> taps(num_taps);
+    double fc = cutoff_hz / sample_rate;  // Normalized to sample rate
+    double mid = (num_taps - 1) / 2.0;
+    double sum = 0.0;
+
+    for (int n = 0; n < num_taps; n++) {
+        double x = n - mid;
+        double sinc = (x == 0.0) ? 2.0 * fc : std::sin(2.0 * kPi * fc * x) / (kPi * x);
+        double w = 0.42 - 0.5 * std::cos(2.0 * kPi * n / (num_taps - 1))
+                        + 0.08 * std::cos(4.0 * kPi * n / (num_taps - 1));
+        taps[n] = static_cast<float>(sinc * w);
+        sum += taps[n];
+    }
+
+    for (auto& t : taps) t = static_cast<float>(t / sum);
+    return taps;
+}
+
+int lowpass_num_taps(double sample_rate, double transition_hz) {
+    int n = static_cast<int>(std::ceil(5.5 * sample_rate / transition_hz));
+    return (n % 2 == 0) ? n + 1 : n;
+}
+
+// ----------------------------------------------------------------------------
+// DecimatingFIR
+// ----------------------------------------------------------------------------
+
+void DecimatingFIR::configure(const std::vector<float>& taps, int decimation) {
+    taps_.assign(taps.rbegin(), taps.rend());
+    taps2_.resize(2 * taps_.size());
+    for (size_t k = 0; k < taps_.size(); k++) {
+        taps2_[2 * k] = taps2_[2 * k + 1] = taps_[k];
+    }
+    decimation_ = decimation > 0 ? decimation : 1;
+    reset();
+}
+
+void DecimatingFIR::reset() {
+    history_.assign(taps_.size() > 0 ? taps_.size() - 1 : 0, cf32(0.0f, 0.0f));
+    next_ = 0;
+}
+
+void DecimatingFIR::process(const cf32* in, size_t n, std::vector<cf32>& out) {
+    history_.insert(history_.end(), in, in + n);
+
+    const size_t num_taps = taps_.size();
+    const float* h2 = taps2_.data();
+    const DspKernels& k = dsp_kernels();
+
+    while (next_ + num_taps <= history_.size()) {
+        out.push_back(k.dot_cf32_real(&history_[next_], h2, num_taps));
+        next_ += decimation_;
+    }
+
+    // Keep only what the next output window still needs
+    size_t consumed = std::min(next_, history_.size());
+    history_.erase(history_.begin(), history_.begin() + consumed);
+    next_ -= consumed;
+}
+
+// ----------------------------------------------------------------------------
+// RationalResampler
+// ----------------------------------------------------------------------------
+
+void RationalResampler::configure(const std::vector<float>& taps, int interpolation, int decimation) {
+    interp_ = interpolation > 0 ? interpolation : 1;
+    decim_ = decimation > 0 ? decimation : 1;
+    taps_per_branch_ = (taps.size() + interp_ - 1) / interp_;
+
+    branches_.assign(interp_, std::vector<float>(taps_per_branch_, 0.0f));
+    for (int p = 0; p < interp_; p++) {
+        for (size_t k = 0; k < taps_per_branch_; k++) {
+            size_t idx = p + k * interp_;
+            float h = idx < taps.size() ? taps[idx] * interp_ : 0.0f;
+            // Reversed: branch[j] multiplies x[n - (K-1) + j]
+            branches_[p][taps_per_branch_ - 1 - k] = h;
+        }
+    }
+    reset();
+}
+
+void RationalResampler::reset() {
+    history_.assign(taps_per_branch_ > 0 ? taps_per_branch_ - 1 : 0, 0.0f);
+    next_ = history_.size();
+    phase_ = 0;
+}
+
+void RationalResampler::process(const float* in, size_t n, std::vector<float>& out) {
+    history_.insert(history_.end(), in, in + n);
+
+    const size_t k_taps = taps_per_branch_;
+    const DspKernels& k = dsp_kernels();
+
+    while (next_ < history_.size()) {
+        const float* x = &history_[next_ + 1 - k_taps];
+        while (phase_ < interp_) {
+            out.push_back(k.dot_f32(x, branches_[phase_].data(), k_taps));
+            phase_ += decim_;
+        }
+        // Skip inputs that produce no output
+        int advance = phase_ / interp_;
+        phase_ -= advance * interp_;
+        next_ += advance;
+    }
+
+    size_t keep = k_taps - 1;
+    size_t consumed = history_.size() - keep;
+    history_.erase(history_.begin(), history_.begin() + consumed);
+    next_ -= consumed;
+}
+
+// ----------------------------------------------------------------------------
+// FmDiscriminator
+// ----------------------------------------------------------------------------
+
+void FmDiscriminator::configure(double sample_rate, double max_deviation_hz) {
+    gain_ = static_cast<float>(sample_rate / (2.0 * kPi * max_deviation_hz));
+    reset();
+}
+
+void FmDiscriminator::process(const cf32* in, size_t n, std::vector<float>& out) {
+    size_t base = out.size();
+    out.resize(base + n);
+    dsp_kernels().fm_discriminate(in, out.data() + base, n, &last_, gain_);
+}
+
+// ----------------------------------------------------------------------------
+// Nco
+// ----------------------------------------------------------------------------
+
+void Nco::mix(cf32* data, size_t n, double start_hz, double end_hz) {
+    if (n == 0) return;
+    lo_.resize(n);
+
+    const double w0 = 2.0 * kPi * start_hz / sample_rate_;
+    const double dw = 2.0 * kPi * (end_hz - start_hz) / sample_rate_ / n;
+
+    for (size_t base = 0; base < n; base += NCO_CHUNK) {
+        size_t len = std::min<size_t>(NCO_CHUNK, n - base);
+        // Constant step per chunk, taken at the chunk midpoint
+        double step = w0 + dw * (base + len / 2.0);
+        std::complex<double> z = std::polar(1.0, phase_);
+        std::complex<double> w = std::polar(1.0, step);
+        for (size_t i = 0; i < len; i++) {
+            lo_[base + i] = cf32(static_cast<float>(z.real()), static_cast<float>(z.imag()));
+            z *= w;
+        }
+        phase_ = std::remainder(phase_ + step * len, 2.0 * kPi);
+    }
+
+    dsp_kernels().complex_multiply(data, lo_.data(), data, n);
+}
+
+// ----------------------------------------------------------------------------
+// FrequencyLockedLoop
+// ----------------------------------------------------------------------------
+
+void FrequencyLockedLoop::configure(double bandwidth_hz, double pull_hz, double max_deviation_hz) {
+    bandwidth_hz_ = bandwidth_hz;
+    pull_hz_ = pull_hz;
+    max_deviation_hz_ = max_deviation_hz;
+    reset();
+}
+
+void FrequencyLockedLoop::reset() {
+    correction_hz_ = 0.0;
+    applied_hz_ = 0.0;
+    error_hz_ = 0.0;
+    locked_ = false;
+}
+
+void FrequencyLockedLoop::update(const float* fm, size_t n, double block_sec) {
+    if (n == 0) return;
+    applied_hz_ = correction_hz_;
+    double sum = 0.0;
+    double power = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        sum += fm[i];
+        power += static_cast<double>(fm[i]) * fm[i];
+    }
+    error_hz_ = sum / n * max_deviation_hz_;
+    locked_ = power / n < FLL_LOCK_POWER;
+    if (!locked_) return;   // Hold through fades
+
+    // One pole at the loop bandwidth, whatever the block length
+    double alpha = 1.0 - std::exp(-2.0 * kPi * bandwidth_hz_ * block_sec);
+    correction_hz_ = std::clamp(correction_hz_ - alpha * error_hz_, -pull_hz_, pull_hz_);
+}
+
+// ----------------------------------------------------------------------------
+// DemodPipeline
+// ----------------------------------------------------------------------------
+
+bool DemodPipeline::configure(const DemodConfig& config) {
+    config_ = config;
+
+    // Largest integer decimation that keeps the IF at or above the minimum
+    uint32_t decim = config.input_rate / DEMOD_MIN_IF_RATE;
+    while (decim > 1 && config.input_rate % decim != 0) decim--;
+    if (decim == 0) {
+        std::cerr << "Error: Sample rate " << config.input_rate
+                  << " Hz too low for FM demodulation\n";
+        return false;
+    }
+    if_rate_ = config.input_rate / decim;
+
+    double passband = config.channel_bw_hz / 2.0;
+    if (if_rate_ <= config.channel_bw_hz) {
+        std::cerr << "Error: IF rate " << if_rate_ << " Hz cannot hold a "
+                  << config.channel_bw_hz / 1e3 << " kHz channel\n";
+        return false;
+    }
+
+    // Split into a cheap wide first stage and a sharp second stage
+    uint32_t d2 = 1;
+    for (uint32_t d = 1; d * d <= decim; d++) {
+        if (decim % d == 0) d2 = d;
+    }
+    uint32_t d1 = decim / d2;
+    two_stage_ = d2 > 1;
+
+    double rate1 = static_cast<double>(config.input_rate) / d1;
+    double stop1 = (two_stage_ ? rate1 : if_rate_) - passband;
+    if (decim == 1) {
+        // Nothing aliases; the stage is just the channel filter
+        stop1 = std::min(if_rate_ / 2.0, 1.5 * passband);
+    }
+    stage1_.configure(design_lowpass(config.input_rate, (passband + stop1) / 2.0,
+                                     lowpass_num_taps(config.input_rate, stop1 - passband)),
+                      static_cast<int>(d1));
+
+    if (two_stage_) {
+        double stop2 = if_rate_ - passband;
+        stage2_.configure(design_lowpass(rate1, (passband + stop2) / 2.0,
+                                         lowpass_num_taps(rate1, stop2 - passband)),
+                          static_cast<int>(d2));
+    }
+
+    discriminator_.configure(if_rate_, config.max_deviation_hz);
+    nco_.configure(config.input_rate);
+    // Without tracking the loop only measures
+    fll_.configure(config.carrier_tracking ? config.fll_bandwidth_hz : 0.0, config.fll_pull_hz,
+                   config.max_deviation_hz);
+
+    // IF -> audio by L/M, filtered at the interpolated rate
+    uint32_t g = std::gcd(if_rate_, config.audio_rate);
+    int interp = static_cast<int>(config.audio_rate / g);
+    int decim_audio = static_cast<int>(if_rate_ / g);
+    double up_rate = static_cast<double>(if_rate_) * interp;
+    double stop_audio = std::min<double>(config.audio_rate, if_rate_) - config.audio_bw_hz;
+    double cutoff_audio = (config.audio_bw_hz + stop_audio) / 2.0;
+    resampler_.configure(design_lowpass(up_rate, cutoff_audio,
+                                        lowpass_num_taps(up_rate, stop_audio - config.audio_bw_hz)),
+                         interp, decim_audio);
+
+    reset();
+    return true;
+}
+
+void DemodPipeline::reset() {
+    iq_corrector_.reset();
+    nco_.reset();
+    fll_.reset();
+    stage1_.reset();
+    stage2_.reset();
+    discriminator_.reset();
+    resampler_.reset();
+}
+
+void DemodPipeline::process(const uint8_t* iq, size_t num_bytes, std::vector<float>& audio) {
+    size_t n = num_bytes / 2;
+
+    baseband_.resize(n);
+    dsp_kernels().u8_to_cf32(iq, baseband_.data(), n);
+    if (config_.iq_correction) {
+        iq_corrector_.process(baseband_.data(), n);
+    }
+    demodulate(n, audio);
+}
+
+void DemodPipeline::process_baseband(const cf32* in, size_t n, std::vector<float>& audio) {
+    baseband_.assign(in, in + n);
+    demodulate(n, audio);
+}
+
+void DemodPipeline::demodulate(size_t n, std::vector<float>& audio) {
+    if (config_.carrier_tracking) {
+        double correction = fll_.correction_hz();
+        nco_.mix(baseband_.data(), n, shift_start_hz_ + correction, shift_end_hz_ + correction);
+    } else if (shift_enabled_) {
+        nco_.mix(baseband_.data(), n, shift_start_hz_, shift_end_hz_);
+    }
+
+    stage1_out_.clear();
+    stage1_.process(baseband_.data(), n, stage1_out_);
+
+    const std::vector<cf32>* if_samples = &stage1_out_;
+    if (two_stage_) {
+        stage2_out_.clear();
+        stage2_.process(stage1_out_.data(), stage1_out_.size(), stage2_out_);
+        if_samples = &stage2_out_;
+    }
+
+    fm_out_.clear();
+    discriminator_.process(if_samples->data(), if_samples->size(), fm_out_);
+    fll_.update(fm_out_.data(), fm_out_.size(), static_cast<double>(n) / config_.input_rate);
+
+    resampler_.process(fm_out_.data(), fm_out_.size(), audio);
+}
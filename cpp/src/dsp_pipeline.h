@@ -0,0 +1,229 @@
+/*
+ * dsp_pipeline.h
+ * Satellite Ground Station - Streaming FM Demodulation Pipeline
+ *
+ * In-process replacement for the fm_demodulate / lowpass_filter /
+ * resample_signal steps of decode_apt.py, run block by block on the
+ * capture stream:
+ *
+ *   u8 I/Q (2.4 MS/s)
+ *     -> complex float (optional DC / I/Q imbalance correction)
+ *     -> NCO frequency shift (Doppler / offset-tuning correction,
+ *        plus the carrier loop's residual when tracking)
+ *     -> decimating FIR stage 1 (/10 -> 240 kHz)
+ *     -> decimating FIR stage 2 (/5  -> 48 kHz, +/-20 kHz channel)
+ *     -> quadrature FM discriminator
+ *     -> polyphase rational resampler (13/30 -> 20800 Hz audio)
+ *
+ * The rate plan is derived from the input rate; any rate with an
+ * integer decimation to 44-60 kHz works (2.4 MS/s, 2.048 MS/s, ...).
+ * process_baseband() enters after the u8 conversion, for a channel
+ * already cut out of a wider stream (channelizer.h) at input_rate.
+ * The discriminator output of each block also gives the carrier offset
+ * left after the shift (carrier_loop()). With carrier_tracking that
+ * closes a frequency-locked loop around the NCO: the next block is
+ * shifted by a filtered share of it more.
+ * All buffers are sized on the first block and reused afterwards.
+ * Inner loops run through the runtime-selected kernels in dsp_kernels.h.
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#ifndef SATGS_DSP_PIPELINE_H
+#define SATGS_DSP_PIPELINE_H
+
+#include "dsp_kernels.h"
+
+#include <cstdint>
+#include <vector>
+
+#define DEMOD_AUDIO_RATE        20800     // APT_SAMPLE_RATE in decode_apt.py
+#define DEMOD_CHANNEL_BW_HZ     40000.0   // NOAA APT FM channel (+/-17 kHz deviation)
+#define DEMOD_MAX_DEVIATION_HZ  17000.0
+#define DEMOD_AUDIO_BW_HZ       5000.0    // 2400 Hz subcarrier +/- 2080 Hz video
+#define DEMOD_MIN_IF_RATE       44000     // Lowest rate the FM discriminator runs at
+#define NCO_CHUNK               256       // Samples per exact phase/frequency update
+#define FLL_BANDWIDTH_HZ        0.2       // Carrier loop bandwidth (time constant ~0.8 s)
+#define FLL_PULL_HZ             5000.0    // Largest correction the loop applies
+#define FLL_LOCK_POWER          0.5       // Discriminator mean square below this: a carrier
+
+struct DemodConfig {
+    uint32_t input_rate = 2400000;
+    uint32_t audio_rate = DEMOD_AUDIO_RATE;
+    double channel_bw_hz = DEMOD_CHANNEL_BW_HZ;
+    double max_deviation_hz = DEMOD_MAX_DEVIATION_HZ;
+    double audio_bw_hz = DEMOD_AUDIO_BW_HZ;
+    bool iq_correction = false;     // Remove DC spike and I/Q imbalance first
+    bool carrier_tracking = false;  // FLL on the residual carrier offset
+    double fll_bandwidth_hz = FLL_BANDWIDTH_HZ;
+    double fll_pull_hz = FLL_PULL_HZ;
+};
+
+// Blackman-windowed sinc lowpass, unity DC gain.
+// cutoff_hz is the -6 dB point; num_taps is forced odd.
+std::vector<float> design_lowpass(double sample_rate, double cutoff_hz, int num_taps);
+
+// Taps needed for a Blackman design with the given transition width
+int lowpass_num_taps(double sample_rate, double transition_hz);
+
+// Complex FIR that only evaluates every D-th output (the polyphase
+// form of filter-then-downsample)
+class DecimatingFIR {
+public:
+    void configure(const std::vector<float>& taps, int decimation);
+    void process(const cf32* in, size_t n, std::vector<cf32>& out);
+    void reset();
+    int decimation() const { return decimation_; }
+    size_t num_taps() const { return taps_.size(); }
+
+private:
+    std::vector<float> taps_;   // Reversed so the dot product walks history forward
+    std::vector<float> taps2_;  // taps_ with each tap duplicated for interleaved I/Q
+    int decimation_ = 1;
+    std::vector<cf32> history_;
+    size_t next_ = 0;           // Start index of the next output window in history_
+};
+
+// Real polyphase resampler by L/M
+class RationalResampler {
+public:
+    void configure(const std::vector<float>& taps, int interpolation, int decimation);
+    void process(const float* in, size_t n, std::vector<float>& out);
+    void reset();
+    int interpolation() const { return interp_; }
+    int decimation() const { return decim_; }
+
+private:
+    std::vector<std::vector<float>> branches_;  // branches_[p][k] = h[p + k*L] * L, reversed
+    size_t taps_per_branch_ = 0;
+    int interp_ = 1;
+    int decim_ = 1;
+    std::vector<float> history_;
+    size_t next_ = 0;           // Newest input index of the next output, relative to history_
+    int phase_ = 0;
+};
+
+// Quadrature FM discriminator: angle(z[n] * conj(z[n-1])), scaled so
+// that max_deviation_hz maps to +/-1.0
+class FmDiscriminator {
+public:
+    void configure(double sample_rate, double max_deviation_hz);
+    void process(const cf32* in, size_t n, std::vector<float>& out);
+    void reset() { last_ = cf32(1.0f, 0.0f); }
+
+private:
+    float gain_ = 1.0f;
+    cf32 last_ = cf32(1.0f, 0.0f);
+};
+
+// Phase-continuous numerically controlled oscillator. mix() shifts a
+// block by a frequency that ramps linearly from start_hz to end_hz across
+// it, so a Doppler curve sampled at block edges is followed without
+// steps. Phase is carried in double precision between blocks; within a
+// block the oscillator is a complex recurrence rebased every NCO_CHUNK
+// samples.
+class Nco {
+public:
+    void configure(double sample_rate) { sample_rate_ = sample_rate; reset(); }
+    void mix(cf32* data, size_t n, double start_hz, double end_hz);
+    void reset() { phase_ = 0.0; }
+    double phase() const { return phase_; }
+
+private:
+    double sample_rate_ = 1.0;
+    double phase_ = 0.0;        // Radians, kept in [-pi, pi]
+    std::vector<cf32> lo_;      // Oscillator samples for the current block
+};
+
+// First-order frequency-locked loop on the FM discriminator output. The
+// APT subcarrier averages out over a block, so the block mean is the
+// carrier's offset from 0 Hz. Only blocks that look like a carrier move
+// the loop: noise drives the normalized discriminator to a mean square
+// near pi^2/3 * gain^2, a captured FM carrier stays well inside +/-1.
+class FrequencyLockedLoop {
+public:
+    void configure(double bandwidth_hz, double pull_hz, double max_deviation_hz);
+    void reset();
+
+    // fm: one block of discriminator output (max deviation = 1.0),
+    // lasting block_sec
+    void update(const float* fm, size_t n, double block_sec);
+
+    // Shift to add to the open-loop one for the next block ...
+    double correction_hz() const { return correction_hz_; }
+    // ... and the one the last block had, whose offset error_hz() is
+    double correction_applied_hz() const { return applied_hz_; }
+    double error_hz() const { return error_hz_; }
+    bool locked() const { return locked_; }
+
+private:
+    double bandwidth_hz_ = FLL_BANDWIDTH_HZ;
+    double pull_hz_ = FLL_PULL_HZ;
+    double max_deviation_hz_ = DEMOD_MAX_DEVIATION_HZ;
+    double correction_hz_ = 0.0;
+    double applied_hz_ = 0.0;
+    double error_hz_ = 0.0;
+    bool locked_ = false;
+};
+
+// Complete u8 I/Q -> audio chain
+class DemodPipeline {
+public:
+    bool configure(const DemodConfig& config);
+    void reset();
+
+    // iq is interleaved offset-binary u8 (I, Q, I, Q, ...) as delivered by
+    // rtlsdr_read_async. Audio samples are appended to audio.
+    void process(const uint8_t* iq, size_t num_bytes, std::vector<float>& audio);
+
+    // Complex baseband at input_rate; no I/Q correction (the wideband
+    // stream has had it)
+    void process_baseband(const cf32* in, size_t n, std::vector<float>& audio);
+
+    // Shift the next block by a frequency ramping from start_hz to end_hz
+    // before channel filtering. Positive values move the spectrum up.
+    void set_frequency_shift(double start_hz, double end_hz) {
+        shift_start_hz_ = start_hz;
+        shift_end_hz_ = end_hz;
+        shift_enabled_ = true;
+    }
+
+    // Carrier offset measurement; the correction stays 0 without
+    // carrier_tracking
+    const FrequencyLockedLoop& carrier_loop() const { return fll_; }
+
+    uint32_t input_rate() const { return config_.input_rate; }
+    uint32_t if_rate() const { return if_rate_; }
+    uint32_t audio_rate() const { return config_.audio_rate; }
+    const DecimatingFIR& stage1() const { return stage1_; }
+    const DecimatingFIR& stage2() const { return stage2_; }
+    const RationalResampler& resampler() const { return resampler_; }
+
+private:
+    // Shift, filter and demodulate baseband_[0, n)
+    void demodulate(size_t n, std::vector<float>& audio);
+
+    DemodConfig config_;
+    uint32_t if_rate_ = 0;
+    bool two_stage_ = false;
+
+    DcIqCorrector iq_corrector_;
+    Nco nco_;
+    FrequencyLockedLoop fll_;
+    bool shift_enabled_ = false;
+    double shift_start_hz_ = 0.0;
+    double shift_end_hz_ = 0.0;
+    DecimatingFIR stage1_;
+    DecimatingFIR stage2_;
+    FmDiscriminator discriminator_;
+    RationalResampler resampler_;
+
+    // Scratch reused between blocks
+    std::vector<cf32> baseband_;
+    std::vector<cf32> stage1_out_;
+    std::vector<cf32> stage2_out_;
+    std::vector<float> fm_out_;
+};
+
+#endif // SATGS_DSP_PIPELINE_H
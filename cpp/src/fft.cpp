@@ -0,0 +1,156 @@
+/*
+ * fft.cpp
+ * Satellite Ground Station - Cached Complex FFT Plans
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#include "fft.h"
+
+#include <cmath>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#ifdef SATGS_HAVE_FFTW
+#include <fftw3.h>
+#endif
+
+#define FFT_MIN_SIZE 2
+#define FFT_MAX_SIZE (1u << 24)
+
+static const double kPi = 3.14159265358979323846;
+
+bool fft_size_valid(size_t n) {
+    return n >= FFT_MIN_SIZE && n <= FFT_MAX_SIZE && (n & (n - 1)) == 0;
+}
+
+size_t fft_size_at_least(size_t n) {
+    size_t size = FFT_MIN_SIZE;
+    while (size < n && size < FFT_MAX_SIZE) size <<= 1;
+    return size;
+}
+
+const char* fft_backend_name() {
+#ifdef SATGS_HAVE_FFTW
+    return "fftw";
+#else
+    return "radix2";
+#endif
+}
+
+FftPlan::FftPlan(size_t n) : n_(n) {
+#ifdef SATGS_HAVE_FFTW
+    // FFTW_UNALIGNED: plans run on whatever buffers callers pass in
+    fftwf_complex* buf = fftwf_alloc_complex(n);
+    unsigned flags = FFTW_ESTIMATE | FFTW_UNALIGNED;
+    forward_plan_ = fftwf_plan_dft_1d(static_cast<int>(n), buf, buf, FFTW_FORWARD, flags);
+    inverse_plan_ = fftwf_plan_dft_1d(static_cast<int>(n), buf, buf, FFTW_BACKWARD, flags);
+    fftwf_free(buf);
+    if (forward_plan_ && inverse_plan_) return;
+#endif
+    // Twiddles stage by stage, e^(-2 pi i k / len) for k < len/2, so each
+    // butterfly group walks its table contiguously
+    twiddles_.reserve(n);
+    for (size_t len = 2; len <= n; len <<= 1) {
+        for (size_t k = 0; k < len / 2; k++) {
+            double a = -2.0 * kPi * static_cast<double>(k) / len;
+            twiddles_.push_back(cf32(static_cast<float>(std::cos(a)), static_cast<float>(std::sin(a))));
+        }
+    }
+    int bits = 0;
+    while ((static_cast<size_t>(1) << bits) < n) bits++;
+    bitrev_.resize(n);
+    for (size_t i = 0; i < n; i++) {
+        uint32_t r = 0;
+        for (int b = 0; b < bits; b++) {
+            if (i & (static_cast<size_t>(1) << b)) r |= 1u << (bits - 1 - b);
+        }
+        bitrev_[i] = r;
+    }
+}
+
+FftPlan::~FftPlan() {
+#ifdef SATGS_HAVE_FFTW
+    if (forward_plan_) fftwf_destroy_plan(static_cast<fftwf_plan>(forward_plan_));
+    if (inverse_plan_) fftwf_destroy_plan(static_cast<fftwf_plan>(inverse_plan_));
+#endif
+}
+
+void FftPlan::forward(cf32* data) const {
+#ifdef SATGS_HAVE_FFTW
+    if (forward_plan_) {
+        fftwf_complex* d = reinterpret_cast<fftwf_complex*>(data);
+        fftwf_execute_dft(static_cast<fftwf_plan>(forward_plan_), d, d);
+        return;
+    }
+#endif
+    radix2(data, false);
+}
+
+void FftPlan::inverse(cf32* data) const {
+#ifdef SATGS_HAVE_FFTW
+    if (inverse_plan_) {
+        fftwf_complex* d = reinterpret_cast<fftwf_complex*>(data);
+        fftwf_execute_dft(static_cast<fftwf_plan>(inverse_plan_), d, d);
+        return;
+    }
+#endif
+    radix2(data, true);
+}
+
+// Iterative decimation-in-time. Products are written out in real
+// arithmetic: std::complex operator* carries NaN/Inf recovery that
+// keeps the butterflies from vectorizing.
+void FftPlan::radix2(cf32* data, bool inverse) const {
+    for (size_t i = 0; i < n_; i++) {
+        size_t j = bitrev_[i];
+        if (i < j) std::swap(data[i], data[j]);
+    }
+
+    float* d = reinterpret_cast<float*>(data);
+    const float sign = inverse ? -1.0f : 1.0f;
+
+    // len = 2: all twiddles are 1
+    for (size_t i = 0; i < 2 * n_; i += 4) {
+        float ur = d[i], ui = d[i + 1];
+        d[i] = ur + d[i + 2];
+        d[i + 1] = ui + d[i + 3];
+        d[i + 2] = ur - d[i + 2];
+        d[i + 3] = ui - d[i + 3];
+    }
+
+    const float* tw = reinterpret_cast<const float*>(twiddles_.data()) + 2;
+    for (size_t len = 4; len <= n_; len <<= 1) {
+        size_t half = len / 2;
+        for (size_t i = 0; i < n_; i += len) {
+            float* u = d + 2 * i;
+            float* v = u + 2 * half;
+            for (size_t k = 0; k < half; k++) {
+                float wr = tw[2 * k];
+                float wi = sign * tw[2 * k + 1];
+                float vr = v[2 * k] * wr - v[2 * k + 1] * wi;
+                float vi = v[2 * k] * wi + v[2 * k + 1] * wr;
+                v[2 * k] = u[2 * k] - vr;
+                v[2 * k + 1] = u[2 * k + 1] - vi;
+                u[2 * k] += vr;
+                u[2 * k + 1] += vi;
+            }
+        }
+        tw += 2 * half;
+    }
+}
+
+const FftPlan& fft_plan(size_t n) {
+    // Plans live for the process; creation is serialized (the FFTW
+    // planner is not thread-safe), execution is not
+    static std::mutex mutex;
+    static std::map<size_t, std::unique_ptr<FftPlan>> cache;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::unique_ptr<FftPlan>& plan = cache[n];
+    if (!plan) plan.reset(new FftPlan(n));
+    return *plan;
+}
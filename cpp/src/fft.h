@@ -0,0 +1,64 @@
+/*
+ * fft.h
+ * Satellite Ground Station - Cached Complex FFT Plans
+ *
+ * In-place complex FFTs of power-of-two sizes. Plans (twiddles and the
+ * bit-reversal permutation, or an FFTW plan when built with FFTW) are
+ * made once per size and shared: fft_plan() hands out the cached plan,
+ * and executing a plan is safe from several threads at once.
+ *
+ * The built-in backend is an iterative radix-2 transform, quick enough
+ * for the correlator block sizes used here (1-8k points). With
+ * SATGS_HAVE_FFTW the same interface runs on fftw3f.
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#ifndef SATGS_FFT_H
+#define SATGS_FFT_H
+
+#include "dsp_kernels.h"
+
+#include <cstddef>
+#include <vector>
+
+class FftPlan {
+public:
+    explicit FftPlan(size_t n);
+    ~FftPlan();
+
+    FftPlan(const FftPlan&) = delete;
+    FftPlan& operator=(const FftPlan&) = delete;
+
+    size_t size() const { return n_; }
+
+    // X[k] = sum x[j] e^(-2 pi i jk / n), in place
+    void forward(cf32* data) const;
+
+    // x[j] = sum X[k] e^(+2 pi i jk / n), in place and unscaled
+    // (inverse(forward(x)) = n * x)
+    void inverse(cf32* data) const;
+
+private:
+    void radix2(cf32* data, bool inverse) const;
+
+    size_t n_;
+    std::vector<cf32> twiddles_;    // Per stage: e^(-2 pi i k / len), k < len/2
+    std::vector<uint32_t> bitrev_;
+    void* forward_plan_ = nullptr;  // fftwf_plan when built with FFTW
+    void* inverse_plan_ = nullptr;
+};
+
+bool fft_size_valid(size_t n);
+
+// Smallest valid FFT size >= n
+size_t fft_size_at_least(size_t n);
+
+// Shared plan for size n (which must be valid)
+const FftPlan& fft_plan(size_t n);
+
+// "fftw" or "radix2"
+const char* fft_backend_name();
+
+#endif // SATGS_FFT_H
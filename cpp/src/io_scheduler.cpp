@@ -0,0 +1,157 @@
+/*
+ * io_scheduler.cpp
+ * Satellite Ground Station - Shared Disk Writer for Capture Sessions
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#include "io_scheduler.h"
+#include "thread_util.h"
+
+#include <chrono>
+#include <iostream>
+
+#define IO_POLL_INFLIGHT_MS 1     // Reap interval while writes are outstanding
+#define IO_POLL_IDLE_MS     20    // Park interval with nothing in flight
+
+IoScheduler::~IoScheduler() {
+    if (!started_) return;
+    for (size_t i = 0; i < channels_.size(); i++) {
+        finish(static_cast<int>(i));
+    }
+    if (thread_.joinable()) thread_.join();
+}
+
+int IoScheduler::add_channel(std::unique_ptr<IQWriter> writer, BufferPool* pool, int max_inflight,
+                             const std::string& label) {
+    if (started_ || !writer || !pool) return -1;
+    std::unique_ptr<Channel> ch(new Channel(pool->num_slabs()));
+    ch->writer = std::move(writer);
+    ch->pool = pool;
+    ch->max_inflight = max_inflight > 0 ? max_inflight : 1;
+    ch->label = label;
+    ch->done.reserve(pool->num_slabs());
+    channels_.push_back(std::move(ch));
+    return static_cast<int>(channels_.size() - 1);
+}
+
+bool IoScheduler::start() {
+    if (started_) return false;
+    started_ = true;
+    thread_ = std::thread(&IoScheduler::run, this);
+    while (!placed_.load(std::memory_order_acquire)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+void IoScheduler::submit(int channel, const SlabRef& ref) {
+    Channel& ch = *channels_[channel];
+    if (!ch.pending.try_push(ref)) {
+        // Can't happen while the ring holds the whole pool; never lose a slab
+        ch.pool->release(ref.index);
+        return;
+    }
+    notify();
+}
+
+void IoScheduler::finish(int channel) {
+    channels_[channel]->finishing.store(true, std::memory_order_release);
+    notify();
+}
+
+bool IoScheduler::wait_closed(int channel) {
+    Channel& ch = *channels_[channel];
+    std::unique_lock<std::mutex> lock(mutex_);
+    closed_cv_.wait(lock, [&ch]() { return ch.closed.load(); });
+    return !ch.failed;
+}
+
+void IoScheduler::notify() {
+    if (waiting_.load(std::memory_order_seq_cst)) {
+        cv_.notify_one();
+    }
+}
+
+// One round for one channel: reap completions, submit at most one slab,
+// close once finished and drained. Returns whether anything happened.
+bool IoScheduler::service(Channel& ch) {
+    bool busy = false;
+    ch.writer->reap(ch.done, false);
+    if (!ch.done.empty()) {
+        for (uint32_t index : ch.done) ch.pool->release(index);
+        ch.done.clear();
+        busy = true;
+    }
+
+    SlabRef ref;
+    if (ch.failed) {
+        // Keep draining so the session's callback is not starved of slabs
+        while (ch.pending.try_pop(ref)) {
+            ch.pool->release(ref.index);
+            busy = true;
+        }
+    } else if (ch.writer->inflight() < static_cast<size_t>(ch.max_inflight) && ch.pending.try_pop(ref)) {
+        if (ref.length == 0) {
+            ch.pool->release(ref.index);
+            return true;
+        }
+        IqFrameInfo frame;
+        frame.first_sample = ref.first_sample;
+        frame.steady_ns = ref.steady_ns;
+        frame.utc = ref.utc;
+        if (!ch.writer->submit(ch.pool->data(ref.index), ref.length, ref.index, frame)) {
+            std::cerr << "\nError: Write to " << ch.label << " failed" << std::endl;
+            ch.failed = true;
+            ch.pool->release(ref.index);
+        }
+        busy = true;
+    }
+    ch.bytes = ch.writer->bytes_written();
+
+    // finishing is set after the producer's last push, so an empty ring
+    // here really is the end of the stream
+    if (ch.finishing.load(std::memory_order_acquire) && ch.pending.size() == 0) {
+        if (!ch.writer->close(ch.done)) {
+            std::cerr << "\nError: Failed to finalize " << ch.label << std::endl;
+            ch.failed = true;
+        }
+        for (uint32_t index : ch.done) ch.pool->release(index);
+        ch.done.clear();
+        ch.bytes = ch.writer->bytes_written();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ch.closed = true;
+        }
+        closed_cv_.notify_all();
+        busy = true;
+    }
+    return busy;
+}
+
+void IoScheduler::run() {
+    set_current_thread_name("satgs-io");
+    apply_thread_placement(placement_, "I/O thread");
+    placed_.store(true, std::memory_order_release);
+
+    while (true) {
+        bool busy = false;
+        bool all_closed = true;
+        bool inflight = false;
+        for (auto& ch : channels_) {
+            if (ch->closed) continue;
+            all_closed = false;
+            busy = service(*ch) || busy;
+            inflight = inflight || ch->writer->inflight() > 0;
+        }
+        if (all_closed) break;
+
+        if (!busy) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            waiting_.store(true, std::memory_order_seq_cst);
+            cv_.wait_for(lock, std::chrono::milliseconds(inflight ? IO_POLL_INFLIGHT_MS : IO_POLL_IDLE_MS));
+            waiting_.store(false, std::memory_order_relaxed);
+        }
+    }
+}
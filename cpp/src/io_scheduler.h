@@ -0,0 +1,112 @@
+/*
+ * io_scheduler.h
+ * Satellite Ground Station - Shared Disk Writer for Capture Sessions
+ *
+ * One I/O thread services the raw I/Q writers of every capture session
+ * in the process, so N dongles don't have N threads fighting over the
+ * same disk. Each session gets a channel: its DSP worker hands filled
+ * slabs over a lock-free SPSC ring, the I/O thread submits them to the
+ * channel's IQWriter in round-robin order (one slab per channel per
+ * pass, so a busy device can't starve a quiet one) and returns each
+ * slab to the session's pool once the backend reports it written.
+ *
+ * Channels are added before start(). A channel is the sole releaser of
+ * its pool's slabs, keeping the pool's free ring single-producer.
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#ifndef SATGS_IO_SCHEDULER_H
+#define SATGS_IO_SCHEDULER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "buffer_pool.h"
+#include "iq_writer.h"
+#include "thread_util.h"
+
+class IoScheduler {
+public:
+    explicit IoScheduler(int core = -1) { placement_.core = core; }
+    ~IoScheduler();
+
+    IoScheduler(const IoScheduler&) = delete;
+    IoScheduler& operator=(const IoScheduler&) = delete;
+
+    // Register an opened writer draining `pool`; returns the channel id,
+    // or -1 once the scheduler is running
+    int add_channel(std::unique_ptr<IQWriter> writer, BufferPool* pool, int max_inflight,
+                    const std::string& label);
+
+    // SCHED_FIFO priority for the I/O thread (0 = normal); before start()
+    void set_realtime(int priority) { placement_.rt_priority = priority; }
+
+    // Returns once the I/O thread has applied its placement
+    bool start();
+
+    // What the I/O thread was granted; valid after start()
+    const ThreadPlacement& placement() const { return placement_; }
+
+    // Session worker side (one producer per channel). Never blocks; the
+    // ring holds every slab of the pool, so it cannot fill.
+    void submit(int channel, const SlabRef& ref);
+
+    // Return a slab to the pool unwritten, in order with the writes (a
+    // session shedding its raw output still may not release slabs itself)
+    void discard(int channel, SlabRef ref) {
+        ref.length = 0;
+        submit(channel, ref);
+    }
+
+    // No more slabs on this channel; it is closed once drained
+    void finish(int channel);
+
+    // Block until the channel is closed; false if any write or the
+    // close failed
+    bool wait_closed(int channel);
+
+    bool failed(int channel) const { return channels_[channel]->failed.load(); }
+    uint64_t bytes_written(int channel) const { return channels_[channel]->bytes.load(); }
+    uint64_t buffered_writes(int channel) const { return channels_[channel]->writer->buffered_writes(); }
+    size_t channels() const { return channels_.size(); }
+
+private:
+    struct Channel {
+        Channel(size_t depth) : pending(depth) {}
+        std::unique_ptr<IQWriter> writer;
+        BufferPool* pool = nullptr;
+        SpscRing<SlabRef> pending;
+        int max_inflight = 1;
+        std::string label;
+        std::vector<uint32_t> done;
+        std::atomic<bool> finishing{false};
+        std::atomic<bool> closed{false};
+        std::atomic<bool> failed{false};
+        std::atomic<uint64_t> bytes{0};
+    };
+
+    void run();
+    bool service(Channel& ch);
+    void notify();
+
+    std::vector<std::unique_ptr<Channel>> channels_;
+    std::thread thread_;
+    ThreadPlacement placement_;
+    std::atomic<bool> placed_{false};
+    bool started_ = false;
+
+    // Same park/notify scheme as BufferQueue
+    std::atomic<bool> waiting_{false};
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::condition_variable closed_cv_;
+};
+
+#endif // SATGS_IO_SCHEDULER_H
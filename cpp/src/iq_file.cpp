@@ -0,0 +1,53 @@
+/*
+ * iq_file.cpp
+ * Satellite Ground Station - Random-access Reader for Recorded I/Q
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#include "iq_file.h"
+
+#include <algorithm>
+#include <iostream>
+
+bool IqFile::open(const std::string& filename, uint32_t sample_rate) {
+    filename_ = filename;
+    sample_rate_ = sample_rate;
+    if (!file_.open(filename)) {
+        std::cerr << "Error: Cannot map I/Q file: " << filename << std::endl;
+        return false;
+    }
+    if (file_.size() % 2 != 0) {
+        std::cerr << "Warning: " << filename << " ends mid-sample; ignoring the last byte" << std::endl;
+    }
+    return true;
+}
+
+std::vector<IqChunk> IqFile::chunks(uint64_t chunk_samples, uint64_t margin, uint64_t align) const {
+    std::vector<IqChunk> out;
+    if (align == 0) align = 1;
+    chunk_samples = std::max(align, (chunk_samples + align - 1) / align * align);
+    margin = (margin + align - 1) / align * align;
+
+    const uint64_t total = num_samples();
+    for (uint64_t start = 0; start < total; start += chunk_samples) {
+        IqChunk c;
+        c.index = out.size();
+        c.first_sample = start;
+        c.num_samples = std::min(chunk_samples, total - start);
+        c.margin = std::min(margin, start);
+        c.data = data() + (start - c.margin) * 2;
+        out.push_back(c);
+    }
+    return out;
+}
+
+void IqFile::prefetch(const IqChunk& chunk) const {
+    file_.prefetch((chunk.first_sample - chunk.margin) * 2, chunk.data_bytes());
+}
+
+void IqFile::release(const IqChunk& chunk) const {
+    // Only what no later chunk's margin still needs
+    file_.release(chunk.first_sample * 2, chunk.num_samples * 2);
+}
@@ -0,0 +1,64 @@
+/*
+ * iq_file.h
+ * Satellite Ground Station - Random-access Reader for Recorded I/Q
+ *
+ * Maps a raw capture from rtlsdr_capture -o (interleaved offset-binary
+ * u8 I/Q, 2 bytes per sample) instead of reading it into RAM, and cuts
+ * it into chunks for parallel offline processing. Each chunk owns a
+ * contiguous sample range and carries a warm-up margin of earlier
+ * samples, so a filter chain run fresh over the chunk has settled by
+ * the time it reaches the samples it owns; outputs from the margin are
+ * discarded and the owned outputs concatenate into the whole-file
+ * result.
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#ifndef SATGS_IQ_FILE_H
+#define SATGS_IQ_FILE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "mapped_file.h"
+
+struct IqChunk {
+    size_t index = 0;
+    uint64_t first_sample = 0;      // First sample the chunk owns
+    uint64_t num_samples = 0;       // Samples it owns
+    uint64_t margin = 0;            // Warm-up samples before first_sample
+    const uint8_t* data = nullptr;  // (margin + num_samples) samples, from first_sample - margin
+
+    size_t data_bytes() const { return static_cast<size_t>((margin + num_samples) * 2); }
+};
+
+class IqFile {
+public:
+    bool open(const std::string& filename, uint32_t sample_rate);
+    void close() { file_.close(); }
+
+    // Chunks owning chunk_samples each (the last one the remainder), with
+    // up to `margin` warm-up samples where the file has them. Chunk
+    // starts fall on multiples of `align` samples, so a decimating chain
+    // keeps the same output phase in every chunk.
+    std::vector<IqChunk> chunks(uint64_t chunk_samples, uint64_t margin, uint64_t align = 1) const;
+
+    // Readahead for a chunk about to be processed / drop its pages after
+    void prefetch(const IqChunk& chunk) const;
+    void release(const IqChunk& chunk) const;
+
+    const uint8_t* data() const { return reinterpret_cast<const uint8_t*>(file_.data()); }
+    uint64_t num_samples() const { return file_.size() / 2; }
+    uint32_t sample_rate() const { return sample_rate_; }
+    double duration_sec() const { return static_cast<double>(num_samples()) / sample_rate_; }
+    const std::string& filename() const { return filename_; }
+
+private:
+    MappedFile file_;
+    uint32_t sample_rate_ = 0;
+    std::string filename_;
+};
+
+#endif // SATGS_IQ_FILE_H
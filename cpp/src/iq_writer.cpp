@@ -0,0 +1,512 @@
+/*
+ * iq_writer.cpp
+ * Satellite Ground Station - Raw I/Q Writer Backends
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#include "iq_writer.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+#ifdef SATGS_HAVE_LIBURING
+#include <liburing.h>
+#endif
+
+using Clock = std::chrono::steady_clock;
+
+static uint64_t elapsed_ns(Clock::time_point start) {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+}
+
+bool parse_io_backend(const std::string& name, IoBackend& backend) {
+    if (name == "stream") backend = IoBackend::Stream;
+    else if (name == "direct") backend = IoBackend::Direct;
+    else if (name == "uring") backend = IoBackend::Uring;
+    else return false;
+    return true;
+}
+
+const char* io_backend_name(IoBackend backend) {
+    switch (backend) {
+        case IoBackend::Stream: return "stream";
+        case IoBackend::Direct: return "direct";
+        case IoBackend::Uring:  return "uring";
+    }
+    return "unknown";
+}
+
+bool io_backend_available(IoBackend backend) {
+#ifdef SATGS_HAVE_LIBURING
+    (void)backend;
+    return true;
+#else
+    return backend != IoBackend::Uring;
+#endif
+}
+
+// Reserve disk blocks so a long pass never stalls on allocation.
+// The file size is trimmed back to the bytes actually written on close.
+static bool preallocate_fd(int fd, uint64_t bytes) {
+    if (bytes == 0) return true;
+#if defined(__linux__)
+    if (fallocate(fd, 0, 0, static_cast<off_t>(bytes)) == 0) return true;
+    return posix_fallocate(fd, 0, static_cast<off_t>(bytes)) == 0;
+#elif defined(__APPLE__)
+    fstore_t store = {F_ALLOCATECONTIG | F_ALLOCATEALL, F_PEOFPOSMODE, 0,
+                      static_cast<off_t>(bytes), 0};
+    if (fcntl(fd, F_PREALLOCATE, &store) == 0) return true;
+    store.fst_flags = F_ALLOCATEALL;  // Retry without requiring contiguous space
+    return fcntl(fd, F_PREALLOCATE, &store) == 0;
+#else
+    (void)fd;
+    return false;
+#endif
+}
+
+// Open for writing without the page cache where the platform allows it
+static int open_uncached(const std::string& path) {
+#if defined(O_DIRECT)
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0644);
+    if (fd >= 0 || errno != EINVAL) return fd;
+    // Filesystem without O_DIRECT support (tmpfs, some FUSE mounts)
+    std::cerr << "Warning: O_DIRECT not supported on this filesystem, using buffered I/O\n";
+    return ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+#else
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+#if defined(F_NOCACHE)
+    if (fd >= 0) fcntl(fd, F_NOCACHE, 1);
+#endif
+    return fd;
+#endif
+}
+
+static bool is_direct_aligned(const uint8_t* data, uint32_t length, uint64_t offset) {
+    return (reinterpret_cast<uintptr_t>(data) % DIRECT_IO_ALIGNMENT) == 0 &&
+           (length % DIRECT_IO_ALIGNMENT) == 0 &&
+           (offset % DIRECT_IO_ALIGNMENT) == 0;
+}
+
+static bool pwrite_all(int fd, const uint8_t* data, size_t length, uint64_t offset) {
+    while (length > 0) {
+        ssize_t n = ::pwrite(fd, data, length, static_cast<off_t>(offset));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += n;
+        length -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+    }
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// stream: std::ofstream, completes synchronously
+// ----------------------------------------------------------------------------
+
+class StreamWriter : public IQWriter {
+public:
+    explicit StreamWriter(LatencyHistogram* latency) : latency_(latency) {}
+
+    bool open(const std::string& path, uint64_t preallocate_bytes) override {
+        path_ = path;
+        std::ios::openmode mode = std::ios::binary | std::ios::out | std::ios::trunc;
+        if (preallocate_bytes > 0) {
+            int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if (fd >= 0) {
+                preallocated_ = preallocate_fd(fd, preallocate_bytes);
+                ::close(fd);
+            }
+            if (preallocated_) mode = std::ios::binary | std::ios::in | std::ios::out;
+        }
+        out_.open(path, mode);
+        return static_cast<bool>(out_);
+    }
+
+    bool submit(const uint8_t* data, uint32_t length, uint32_t tag, const IqFrameInfo&) override {
+        auto start = Clock::now();
+        out_.write(reinterpret_cast<const char*>(data), length);
+        if (latency_) latency_->record(elapsed_ns(start));
+        done_.push_back(tag);
+        if (!out_) return false;
+        bytes_ += length;
+        return true;
+    }
+
+    size_t reap(std::vector<uint32_t>& done, bool) override {
+        size_t n = done_.size();
+        done.insert(done.end(), done_.begin(), done_.end());
+        done_.clear();
+        return n;
+    }
+
+    bool close(std::vector<uint32_t>& done) override {
+        reap(done, false);
+        out_.close();
+        if (preallocated_ && ::truncate(path_.c_str(), static_cast<off_t>(bytes_)) != 0) {
+            return false;
+        }
+        return !out_.fail();
+    }
+
+    size_t inflight() const override { return 0; }
+    uint64_t bytes_written() const override { return bytes_; }
+
+private:
+    LatencyHistogram* latency_;
+    std::string path_;
+    std::ofstream out_;
+    bool preallocated_ = false;
+    uint64_t bytes_ = 0;
+    std::vector<uint32_t> done_;
+};
+
+// ----------------------------------------------------------------------------
+// direct: O_DIRECT pwrite from max_inflight I/O threads
+// ----------------------------------------------------------------------------
+
+class DirectWriter : public IQWriter {
+public:
+    DirectWriter(int max_inflight, LatencyHistogram* latency)
+        : max_inflight_(max_inflight > 0 ? max_inflight : 1), latency_(latency) {}
+
+    ~DirectWriter() override {
+        std::vector<uint32_t> ignored;
+        if (fd_ >= 0) close(ignored);
+    }
+
+    bool open(const std::string& path, uint64_t preallocate_bytes) override {
+        fd_ = open_uncached(path);
+        if (fd_ < 0) return false;
+        // Unaligned tail writes go through a buffered descriptor
+        buffered_fd_ = ::open(path.c_str(), O_WRONLY);
+        if (buffered_fd_ < 0) {
+            ::close(fd_);
+            fd_ = -1;
+            return false;
+        }
+        if (preallocate_bytes > 0 && !preallocate_fd(fd_, preallocate_bytes)) {
+            std::cerr << "Warning: Preallocation of " << preallocate_bytes / 1e6
+                      << " MB failed: " << std::strerror(errno) << "\n";
+        }
+        running_ = true;
+        for (int i = 0; i < max_inflight_; i++) {
+            workers_.emplace_back(&DirectWriter::worker, this);
+        }
+        return true;
+    }
+
+    bool submit(const uint8_t* data, uint32_t length, uint32_t tag, const IqFrameInfo&) override {
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_cv_.wait(lock, [this] { return inflight_ < static_cast<size_t>(max_inflight_); });
+        if (failed_) return false;
+        jobs_.push_back({data, length, tag, offset_, Clock::now()});
+        offset_ += length;
+        inflight_++;
+        job_cv_.notify_one();
+        return true;
+    }
+
+    size_t reap(std::vector<uint32_t>& done, bool wait) override {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (wait) {
+            done_cv_.wait(lock, [this] { return !done_.empty() || inflight_ == 0; });
+        }
+        size_t n = done_.size();
+        done.insert(done.end(), done_.begin(), done_.end());
+        done_.clear();
+        return n;
+    }
+
+    bool close(std::vector<uint32_t>& done) override {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            done_cv_.wait(lock, [this] { return inflight_ == 0; });
+            running_ = false;
+        }
+        job_cv_.notify_all();
+        for (auto& t : workers_) t.join();
+        workers_.clear();
+        reap(done, false);
+
+        bool ok = !failed_;
+        if (fd_ >= 0) {
+            if (::ftruncate(fd_, static_cast<off_t>(bytes_.load())) != 0) ok = false;
+            ::close(fd_);
+            fd_ = -1;
+        }
+        if (buffered_fd_ >= 0) {
+            ::close(buffered_fd_);
+            buffered_fd_ = -1;
+        }
+        return ok;
+    }
+
+    size_t inflight() const override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return inflight_;
+    }
+
+    uint64_t bytes_written() const override { return bytes_.load(); }
+    uint64_t buffered_writes() const override { return buffered_.load(std::memory_order_relaxed); }
+
+private:
+    struct Job {
+        const uint8_t* data;
+        uint32_t length;
+        uint32_t tag;
+        uint64_t offset;
+        Clock::time_point start;
+    };
+
+    void worker() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            job_cv_.wait(lock, [this] { return !jobs_.empty() || !running_; });
+            if (jobs_.empty()) return;
+            Job job = jobs_.front();
+            jobs_.pop_front();
+            lock.unlock();
+
+            int fd = fd_;
+            if (!is_direct_aligned(job.data, job.length, job.offset)) {
+                fd = buffered_fd_;
+                buffered_.fetch_add(1, std::memory_order_relaxed);
+            }
+            bool ok = pwrite_all(fd, job.data, job.length, job.offset);
+            if (latency_) latency_->record(elapsed_ns(job.start));
+
+            lock.lock();
+            if (ok) {
+                bytes_ += job.length;
+            } else {
+                if (!failed_) {
+                    std::cerr << "\nError: Write failed: " << std::strerror(errno) << std::endl;
+                }
+                failed_ = true;
+            }
+            done_.push_back(job.tag);
+            inflight_--;
+            done_cv_.notify_all();
+        }
+    }
+
+    int max_inflight_;
+    LatencyHistogram* latency_;
+    int fd_ = -1;
+    int buffered_fd_ = -1;
+    uint64_t offset_ = 0;
+    std::atomic<uint64_t> bytes_{0};
+    std::atomic<uint64_t> buffered_{0};
+
+    mutable std::mutex mutex_;
+    std::condition_variable job_cv_;
+    std::condition_variable done_cv_;
+    std::deque<Job> jobs_;
+    std::vector<uint32_t> done_;
+    std::vector<std::thread> workers_;
+    size_t inflight_ = 0;
+    bool running_ = false;
+    bool failed_ = false;
+};
+
+// ----------------------------------------------------------------------------
+// uring: O_DIRECT with batched io_uring submissions
+// ----------------------------------------------------------------------------
+
+#ifdef SATGS_HAVE_LIBURING
+
+class UringWriter : public IQWriter {
+public:
+    UringWriter(int max_inflight, LatencyHistogram* latency)
+        : max_inflight_(max_inflight > 0 ? max_inflight : 1), latency_(latency),
+          slots_(max_inflight_) {
+        for (int i = max_inflight_ - 1; i >= 0; i--) free_slots_.push_back(i);
+    }
+
+    ~UringWriter() override {
+        std::vector<uint32_t> ignored;
+        if (fd_ >= 0 || ring_ready_) close(ignored);
+    }
+
+    bool open(const std::string& path, uint64_t preallocate_bytes) override {
+        int ret = io_uring_queue_init(static_cast<unsigned>(max_inflight_), &ring_, 0);
+        if (ret < 0) {
+            std::cerr << "Error: io_uring_queue_init failed: " << std::strerror(-ret) << "\n";
+            return false;
+        }
+        ring_ready_ = true;
+        fd_ = open_uncached(path);
+        if (fd_ < 0) return false;
+        buffered_fd_ = ::open(path.c_str(), O_WRONLY);
+        if (buffered_fd_ < 0) return false;
+        if (preallocate_bytes > 0 && !preallocate_fd(fd_, preallocate_bytes)) {
+            std::cerr << "Warning: Preallocation of " << preallocate_bytes / 1e6
+                      << " MB failed: " << std::strerror(errno) << "\n";
+        }
+        return true;
+    }
+
+    bool submit(const uint8_t* data, uint32_t length, uint32_t tag, const IqFrameInfo&) override {
+        if (failed_) return false;
+        while (free_slots_.empty()) {
+            if (!complete_one(true)) return false;
+        }
+        int slot = free_slots_.back();
+        free_slots_.pop_back();
+        slots_[slot] = {tag, length, Clock::now()};
+
+        struct io_uring_sqe* sqe = io_uring_get_sqe(&ring_);
+        if (!sqe) {
+            flush();
+            sqe = io_uring_get_sqe(&ring_);
+            if (!sqe) return false;
+        }
+        int fd = fd_;
+        if (!is_direct_aligned(data, length, offset_)) {
+            fd = buffered_fd_;
+            buffered_.fetch_add(1, std::memory_order_relaxed);
+        }
+        io_uring_prep_write(sqe, fd, data, length, offset_);
+        io_uring_sqe_set_data(sqe, &slots_[slot]);
+        offset_ += length;
+        pending_submit_++;
+        inflight_++;
+        return true;
+    }
+
+    size_t reap(std::vector<uint32_t>& done, bool wait) override {
+        // Submissions are batched until the writer asks for completions
+        flush();
+        if (wait && inflight_ > 0 && done_.empty()) complete_one(true);
+        while (complete_one(false)) {
+        }
+        size_t n = done_.size();
+        done.insert(done.end(), done_.begin(), done_.end());
+        done_.clear();
+        return n;
+    }
+
+    bool close(std::vector<uint32_t>& done) override {
+        flush();
+        while (inflight_ > 0 && complete_one(true)) {
+        }
+        reap(done, false);
+        bool ok = !failed_;
+        if (fd_ >= 0) {
+            if (::ftruncate(fd_, static_cast<off_t>(bytes_)) != 0) ok = false;
+            ::close(fd_);
+            fd_ = -1;
+        }
+        if (buffered_fd_ >= 0) {
+            ::close(buffered_fd_);
+            buffered_fd_ = -1;
+        }
+        if (ring_ready_) {
+            io_uring_queue_exit(&ring_);
+            ring_ready_ = false;
+        }
+        return ok;
+    }
+
+    size_t inflight() const override { return inflight_; }
+    uint64_t bytes_written() const override { return bytes_; }
+    uint64_t buffered_writes() const override { return buffered_.load(std::memory_order_relaxed); }
+
+private:
+    struct Slot {
+        uint32_t tag;
+        uint32_t length;
+        Clock::time_point start;
+    };
+
+    void flush() {
+        if (pending_submit_ == 0) return;
+        int ret = io_uring_submit(&ring_);
+        if (ret < 0) {
+            std::cerr << "\nError: io_uring_submit failed: " << std::strerror(-ret) << std::endl;
+            failed_ = true;
+            return;
+        }
+        pending_submit_ = 0;
+    }
+
+    bool complete_one(bool wait) {
+        if (inflight_ == 0) return false;
+        flush();
+        struct io_uring_cqe* cqe = nullptr;
+        int ret = wait ? io_uring_wait_cqe(&ring_, &cqe) : io_uring_peek_cqe(&ring_, &cqe);
+        if (ret < 0 || !cqe) {
+            if (wait && ret != -EINTR) failed_ = true;
+            return false;
+        }
+        Slot* slot = static_cast<Slot*>(io_uring_cqe_get_data(cqe));
+        if (cqe->res != static_cast<int>(slot->length)) {
+            if (!failed_) {
+                std::cerr << "\nError: Write failed: "
+                          << (cqe->res < 0 ? std::strerror(-cqe->res) : "short write") << std::endl;
+            }
+            failed_ = true;
+        } else {
+            bytes_ += slot->length;
+        }
+        if (latency_) latency_->record(elapsed_ns(slot->start));
+        io_uring_cqe_seen(&ring_, cqe);
+
+        done_.push_back(slot->tag);
+        free_slots_.push_back(static_cast<int>(slot - slots_.data()));
+        inflight_--;
+        return true;
+    }
+
+    int max_inflight_;
+    LatencyHistogram* latency_;
+    struct io_uring ring_;
+    bool ring_ready_ = false;
+    int fd_ = -1;
+    int buffered_fd_ = -1;
+    uint64_t offset_ = 0;
+    uint64_t bytes_ = 0;
+    std::atomic<uint64_t> buffered_{0};     // Read by the metrics thread
+    std::vector<Slot> slots_;
+    std::vector<int> free_slots_;
+    std::vector<uint32_t> done_;
+    size_t inflight_ = 0;
+    int pending_submit_ = 0;
+    bool failed_ = false;
+};
+
+#endif // SATGS_HAVE_LIBURING
+
+std::unique_ptr<IQWriter> create_iq_writer(IoBackend backend, int max_inflight,
+                                           LatencyHistogram* latency) {
+    switch (backend) {
+        case IoBackend::Stream:
+            return std::unique_ptr<IQWriter>(new StreamWriter(latency));
+        case IoBackend::Direct:
+            return std::unique_ptr<IQWriter>(new DirectWriter(max_inflight, latency));
+        case IoBackend::Uring:
+#ifdef SATGS_HAVE_LIBURING
+            return std::unique_ptr<IQWriter>(new UringWriter(max_inflight, latency));
+#else
+            std::cerr << "Error: io_uring backend not available (built without liburing)\n";
+            return nullptr;
+#endif
+    }
+    return nullptr;
+}
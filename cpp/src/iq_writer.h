@@ -0,0 +1,87 @@
+/*
+ * iq_writer.h
+ * Satellite Ground Station - Raw I/Q Writer Backends
+ *
+ * Selectable disk backends for the capture writer thread:
+ *
+ *   stream  - std::ofstream (libstdc++ buffer + page cache), the original path
+ *   direct  - O_DIRECT (F_NOCACHE on macOS) pwrite of page-aligned pool
+ *             slabs from a small set of I/O threads
+ *   uring   - O_DIRECT with batched io_uring submissions (Linux, liburing)
+ *
+ * Writers never copy: they write straight from the slab and hand the
+ * slab's tag back through reap() once the write has completed, at which
+ * point the caller may return the slab to the pool.
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#ifndef SATGS_IQ_WRITER_H
+#define SATGS_IQ_WRITER_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "latency_histogram.h"
+
+#define DEFAULT_IO_INFLIGHT 4   // Writes kept in flight (direct/uring)
+#define DIRECT_IO_ALIGNMENT 4096  // Conservative logical block size for O_DIRECT
+
+enum class IoBackend {
+    Stream,
+    Direct,
+    Uring
+};
+
+bool parse_io_backend(const std::string& name, IoBackend& backend);
+const char* io_backend_name(IoBackend backend);
+bool io_backend_available(IoBackend backend);
+
+// Where a submitted buffer sits in the stream. Raw backends only write
+// the bytes; container formats record position and arrival time, and a
+// jump in first_sample is a dropped transfer.
+struct IqFrameInfo {
+    uint64_t first_sample = 0;
+    int64_t steady_ns = 0;
+    double utc = 0.0;
+};
+
+class IQWriter {
+public:
+    virtual ~IQWriter() = default;
+
+    // Create/truncate the file; reserve preallocate_bytes up front if nonzero
+    virtual bool open(const std::string& path, uint64_t preallocate_bytes) = 0;
+
+    // Queue a write of data[0..length). The buffer must stay valid until
+    // its tag is returned by reap(). Blocks while max_inflight writes are
+    // outstanding. Returns false after an I/O error.
+    virtual bool submit(const uint8_t* data, uint32_t length, uint32_t tag,
+                        const IqFrameInfo& frame) = 0;
+
+    // Append tags of completed writes to done. With wait=true, blocks until
+    // at least one write completes (returns immediately if none in flight).
+    virtual size_t reap(std::vector<uint32_t>& done, bool wait) = 0;
+
+    // Wait for all outstanding writes, trim preallocation, close the file.
+    // Tags of writes completed during close are appended to done.
+    virtual bool close(std::vector<uint32_t>& done) = 0;
+
+    virtual size_t inflight() const = 0;
+    virtual uint64_t bytes_written() const = 0;
+
+    // Writes an O_DIRECT backend had to send through the page cache: a
+    // length or file offset off DIRECT_IO_ALIGNMENT (a stream's last,
+    // short write always is). Once the offset is off, every later write
+    // follows it.
+    virtual uint64_t buffered_writes() const { return 0; }
+};
+
+// latency (optional) receives submit-to-completion time of every write
+std::unique_ptr<IQWriter> create_iq_writer(IoBackend backend, int max_inflight,
+                                           LatencyHistogram* latency);
+
+#endif // SATGS_IQ_WRITER_H
@@ -0,0 +1,195 @@
+/*
+ * json_reader.cpp
+ * Satellite Ground Station - Minimal pull-style JSON reader
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#include "json_reader.h"
+
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+
+#define JSON_MAX_DEPTH 64
+
+void JsonReader::skip_ws() {
+    while (pos_ < end_ && (*pos_ == ' ' || *pos_ == '\n' || *pos_ == '\r' || *pos_ == '\t')) {
+        pos_++;
+    }
+}
+
+bool JsonReader::fail() {
+    if (ok_) error_at_ = pos_;
+    ok_ = false;
+    pos_ = end_;
+    return false;
+}
+
+bool JsonReader::expect(char c) {
+    skip_ws();
+    if (pos_ >= end_ || *pos_ != c) return fail();
+    pos_++;
+    return true;
+}
+
+bool JsonReader::skip_literal(const char* word) {
+    size_t len = std::strlen(word);
+    if (static_cast<size_t>(end_ - pos_) < len || std::memcmp(pos_, word, len) != 0) return fail();
+    pos_ += len;
+    return true;
+}
+
+char JsonReader::peek() {
+    if (!ok_) return 0;
+    skip_ws();
+    if (pos_ >= end_) return 0;
+    switch (*pos_) {
+        case '{': case '[': case '"': return *pos_;
+        case 't': case 'f': return *pos_;
+        case 'n': return 'z';
+        default:  return 'n';
+    }
+}
+
+bool JsonReader::begin_object() {
+    if (!ok_ || !expect('{')) return false;
+    first_ = true;
+    return true;
+}
+
+bool JsonReader::begin_array() {
+    if (!ok_ || !expect('[')) return false;
+    first_ = true;
+    return true;
+}
+
+bool JsonReader::next_key(std::string_view& key) {
+    if (!ok_) return false;
+    skip_ws();
+    if (pos_ < end_ && *pos_ == '}') {
+        pos_++;
+        first_ = false;
+        return false;
+    }
+    if (!first_ && !expect(',')) return false;
+    first_ = false;
+    return read_string(key) && expect(':');
+}
+
+bool JsonReader::next_element() {
+    if (!ok_) return false;
+    skip_ws();
+    if (pos_ < end_ && *pos_ == ']') {
+        pos_++;
+        first_ = false;
+        return false;
+    }
+    if (!first_ && !expect(',')) return false;
+    first_ = false;
+    return true;
+}
+
+bool JsonReader::read_string(std::string_view& value) {
+    if (!ok_ || !expect('"')) return false;
+    const char* start = pos_;
+    while (pos_ < end_ && *pos_ != '"') {
+        pos_ += (*pos_ == '\\') ? 2 : 1;
+    }
+    if (pos_ >= end_) return fail();
+    value = std::string_view(start, static_cast<size_t>(pos_ - start));
+    pos_++;
+    return true;
+}
+
+bool JsonReader::read_number(double& value) {
+    if (!ok_) return false;
+    skip_ws();
+    const char* start = pos_;
+    // Also accepts the NaN / Infinity tokens Python's json module writes
+    while (pos_ < end_ && (std::strchr("+-.0123456789eE", *pos_) ||
+                           (*pos_ >= 'a' && *pos_ <= 'z') || (*pos_ >= 'A' && *pos_ <= 'Z'))) {
+        pos_++;
+    }
+    if (pos_ == start) return fail();
+    
+#if defined(__cpp_lib_to_chars)
+    auto result = std::from_chars(start, pos_, value);
+    if (result.ec != std::errc() || result.ptr != pos_) {
+        pos_ = start;
+        return fail();
+    }
+#else
+    // Toolchains without floating-point from_chars: strtod on a bounded copy
+    char buf[64];
+    size_t len = static_cast<size_t>(pos_ - start);
+    if (len >= sizeof(buf)) {
+        pos_ = start;
+        return fail();
+    }
+    std::memcpy(buf, start, len);
+    buf[len] = '\0';
+    char* stop = nullptr;
+    value = std::strtod(buf, &stop);
+    if (stop != buf + len) {
+        pos_ = start;
+        return fail();
+    }
+#endif
+    return true;
+}
+
+bool JsonReader::read_number_array(std::vector<double>& values) {
+    if (!begin_array()) return false;
+    double v;
+    while (next_element()) {
+        if (!read_number(v)) return false;
+        values.push_back(v);
+    }
+    return ok_;
+}
+
+bool JsonReader::skip_value() {
+    if (!ok_) return false;
+    // Iterative so deeply nested input can't blow the stack
+    int depth = 0;
+    std::string_view sv;
+    double d;
+    do {
+        bool opened = false;
+        switch (peek()) {
+            case '{': case '[':
+                if (++depth > JSON_MAX_DEPTH) return fail();
+                pos_++;
+                opened = true;
+                break;
+            case '"':
+                if (!read_string(sv)) return false;
+                break;
+            case 't': if (!skip_literal("true")) return false; break;
+            case 'f': if (!skip_literal("false")) return false; break;
+            case 'z': if (!skip_literal("null")) return false; break;
+            case 'n': if (!read_number(d)) return false; break;
+            default:  return fail();
+        }
+        // Inside a container the separators and closers are consumed here
+        while (depth > 0) {
+            skip_ws();
+            if (pos_ >= end_) return fail();
+            if (*pos_ == '}' || *pos_ == ']') {
+                pos_++;
+                depth--;
+                opened = false;
+            } else if (opened) {
+                break;  // First value of the container just opened
+            } else if (*pos_ == ',' || *pos_ == ':') {
+                pos_++;
+                break;
+            } else {
+                return fail();
+            }
+        }
+    } while (depth > 0 && ok_);
+    return ok_;
+}
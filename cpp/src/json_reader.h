@@ -0,0 +1,72 @@
+/*
+ * json_reader.h
+ * Satellite Ground Station - Minimal pull-style JSON reader
+ *
+ * Walks a JSON document once, front to back, straight out of a buffer
+ * (typically a MappedFile). Nothing is materialized: the caller pulls
+ * keys, numbers and strings as it goes and skips whatever it doesn't
+ * need. Numbers are parsed with std::from_chars; strings come back as
+ * views into the buffer with escapes left in place, which is all the
+ * profile and config files need.
+ *
+ *   JsonReader r(data, size);
+ *   std::string_view key;
+ *   r.begin_object();
+ *   while (r.next_key(key)) {
+ *       if (key == "center_freq_hz") r.read_number(freq);
+ *       else r.skip_value();
+ *   }
+ *   if (!r.ok()) ... r.error_offset() ...
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#ifndef SATGS_JSON_READER_H
+#define SATGS_JSON_READER_H
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+class JsonReader {
+public:
+    JsonReader(const char* data, size_t size) : begin_(data), pos_(data), end_(data + size) {}
+
+    // Each returns false and latches the error state on malformed input
+    bool begin_object();
+    bool begin_array();
+
+    // Next key of the current object; false at the closing brace
+    bool next_key(std::string_view& key);
+
+    // Whether the current array has another element; false at the closing bracket
+    bool next_element();
+
+    bool read_number(double& value);
+    bool read_string(std::string_view& value);
+    bool read_number_array(std::vector<double>& values);    // Appends
+    bool skip_value();
+
+    // Type of the next value without consuming it: '{', '[', '"', 'n'umber,
+    // 't'/'f' (bool), 'z' (null), 0 at end of input or on error
+    char peek();
+
+    bool ok() const { return ok_; }
+    size_t error_offset() const { return static_cast<size_t>(error_at_ - begin_); }
+
+private:
+    void skip_ws();
+    bool fail();
+    bool expect(char c);
+    bool skip_literal(const char* word);
+
+    const char* begin_;
+    const char* pos_;
+    const char* end_;
+    const char* error_at_ = nullptr;
+    bool ok_ = true;
+    bool first_ = false;    // Next key/element is the first of its container
+};
+
+#endif // SATGS_JSON_READER_H
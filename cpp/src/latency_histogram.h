@@ -0,0 +1,99 @@
+/*
+ * latency_histogram.h
+ * Satellite Ground Station - Lock-free Latency Histogram
+ *
+ * Log-linear histogram (4 sub-buckets per power of two, nanosecond
+ * resolution up to ~18 minutes). Recording is a single relaxed atomic
+ * increment so it is safe to call from I/O completion paths; the
+ * percentile estimate is the upper edge of the bucket that crosses
+ * the requested rank, i.e. within 25% of the true value, clamped to
+ * the smallest and largest values recorded.
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#ifndef SATGS_LATENCY_HISTOGRAM_H
+#define SATGS_LATENCY_HISTOGRAM_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+
+#define LATENCY_SUB_BITS    2
+#define LATENCY_SUB_BUCKETS (1 << LATENCY_SUB_BITS)
+#define LATENCY_OCTAVES     41
+#define LATENCY_BUCKETS     (LATENCY_OCTAVES * LATENCY_SUB_BUCKETS)
+
+class LatencyHistogram {
+public:
+    void record(uint64_t ns) {
+        // Extremes first, so a reader that sees the count sees them
+        uint64_t prev = max_ns_.load(std::memory_order_relaxed);
+        while (ns > prev && !max_ns_.compare_exchange_weak(prev, ns, std::memory_order_relaxed)) {
+        }
+        prev = min_ns_.load(std::memory_order_relaxed);
+        while (ns < prev && !min_ns_.compare_exchange_weak(prev, ns, std::memory_order_relaxed)) {
+        }
+        buckets_[bucket_index(ns)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_ns_.fetch_add(ns, std::memory_order_relaxed);
+    }
+
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    uint64_t max_ns() const { return max_ns_.load(std::memory_order_relaxed); }
+    uint64_t min_ns() const { return count() ? min_ns_.load(std::memory_order_relaxed) : 0; }
+    uint64_t sum_ns() const { return sum_ns_.load(std::memory_order_relaxed); }
+
+    // p in [0, 100]; returns 0 when empty
+    uint64_t percentile_ns(double p) const {
+        uint64_t total = count();
+        if (total == 0) return 0;
+        uint64_t rank = static_cast<uint64_t>(p / 100.0 * total + 0.5);
+        if (rank < 1) rank = 1;
+        uint64_t seen = 0;
+        for (int i = 0; i < LATENCY_BUCKETS; i++) {
+            seen += buckets_[i].load(std::memory_order_relaxed);
+            if (seen >= rank) return std::min(std::max(bucket_upper(i), min_ns()), max_ns());
+        }
+        return max_ns();
+    }
+
+    double percentile_ms(double p) const { return percentile_ns(p) / 1e6; }
+
+    // Per-bucket access for exporters
+    static int num_buckets() { return LATENCY_BUCKETS; }
+    uint64_t bucket_count(int i) const { return buckets_[i].load(std::memory_order_relaxed); }
+    static uint64_t bucket_upper(int i) {
+        int octave = i / LATENCY_SUB_BUCKETS;
+        int sub = i % LATENCY_SUB_BUCKETS;
+        if (octave < LATENCY_SUB_BITS) return static_cast<uint64_t>(i);
+        uint64_t base = 1ULL << octave;
+        return base + (base >> LATENCY_SUB_BITS) * (sub + 1) - 1;
+    }
+
+    void reset() {
+        for (auto& b : buckets_) b.store(0, std::memory_order_relaxed);
+        count_.store(0, std::memory_order_relaxed);
+        sum_ns_.store(0, std::memory_order_relaxed);
+        max_ns_.store(0, std::memory_order_relaxed);
+        min_ns_.store(UINT64_MAX, std::memory_order_relaxed);
+    }
+
+private:
+    static int bucket_index(uint64_t ns) {
+        if (ns < (1ULL << LATENCY_SUB_BITS)) return static_cast<int>(ns);
+        int octave = 63 - __builtin_clzll(ns);
+        if (octave >= LATENCY_OCTAVES) return LATENCY_BUCKETS - 1;
+        int sub = static_cast<int>((ns >> (octave - LATENCY_SUB_BITS)) & (LATENCY_SUB_BUCKETS - 1));
+        return octave * LATENCY_SUB_BUCKETS + sub;
+    }
+
+    std::atomic<uint64_t> buckets_[LATENCY_BUCKETS] = {};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_ns_{0};
+    std::atomic<uint64_t> max_ns_{0};
+    std::atomic<uint64_t> min_ns_{UINT64_MAX};
+};
+
+#endif // SATGS_LATENCY_HISTOGRAM_H
@@ -0,0 +1,95 @@
+/*
+ * load_manager.cpp
+ * Satellite Ground Station - Stage Shedding Under CPU or Disk Pressure
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#include "load_manager.h"
+
+#include <algorithm>
+#include <cmath>
+
+const char* load_level_name(LoadLevel level) {
+    switch (level) {
+        case LoadLevel::Full:        return "full";
+        case LoadLevel::NoWaterfall: return "no_waterfall";
+        case LoadLevel::Decimated:   return "decimated";
+        case LoadLevel::NoRaw:       return "no_raw";
+        case LoadLevel::PrimaryOnly: return "primary_only";
+    }
+    return "unknown";
+}
+
+void LoadManager::configure(const LoadConfig& config, bool waterfall, bool raw, bool channels) {
+    config_ = config;
+    available_[static_cast<int>(LoadLevel::NoWaterfall)] = waterfall;
+    available_[static_cast<int>(LoadLevel::Decimated)] = raw && config.raw_decimation > 1;
+    available_[static_cast<int>(LoadLevel::NoRaw)] = raw;
+    available_[static_cast<int>(LoadLevel::PrimaryOnly)] = channels;
+    restore_hold_ = config.restore_sec;
+}
+
+// Next level with a stage to shed (direction 1) or restore (-1); `from`
+// when there is none
+int LoadManager::step(int from, int direction) const {
+    for (int i = from + direction; i >= 0 && i < LOAD_LEVELS; i += direction) {
+        if (available_[i]) return i;
+    }
+    return from;
+}
+
+bool LoadManager::update(const LoadSample& sample) {
+    if (!config_.enabled) return false;
+    last_ = sample;
+    double dt = std::max(0.0, sample.elapsed_sec);
+    double fill = std::min(1.0, sample.queue_fill + sample.writer_fill);
+    double raw = sample.dropped ? 1.0 : std::min(1.0, std::max(fill, sample.dsp_load));
+    double alpha = 1.0 - std::exp(-dt / LOAD_SMOOTH_SEC);
+    smoothed_ = sample.dropped ? 1.0 : smoothed_ + alpha * (raw - smoothed_);
+
+    pressure_.store(smoothed_, std::memory_order_relaxed);
+    queue_fill_.store(sample.queue_fill, std::memory_order_relaxed);
+    writer_fill_.store(sample.writer_fill, std::memory_order_relaxed);
+    dsp_load_.store(sample.dsp_load, std::memory_order_relaxed);
+
+    int current = static_cast<int>(level_.load(std::memory_order_relaxed));
+    if (current > 0) shed_time_sec_ += dt;
+    since_restore_sec_ += dt;
+    since_step_sec_ += dt;
+    above_sec_ = smoothed_ > config_.shed_pressure ? above_sec_ + dt : 0.0;
+    below_sec_ = smoothed_ < config_.restore_pressure ? below_sec_ + dt : 0.0;
+
+    int next = current;
+    // A drop sheds at once, but a step at most every shed_sec: the
+    // backlog that caused it takes a moment to clear
+    if (above_sec_ >= config_.shed_sec || (sample.dropped && since_step_sec_ >= config_.shed_sec)) {
+        next = step(current, 1);
+        if (next != current) {
+            // Shed again before the restore had proved itself
+            if (since_restore_sec_ < 2.0 * restore_hold_) {
+                restore_hold_ = std::min(2.0 * restore_hold_, LOAD_RESTORE_MAX_SEC);
+            }
+            cause_ = sample.writer_fill > std::max(sample.queue_fill, sample.dsp_load) ? "disk" : "CPU";
+        }
+    } else if (below_sec_ >= restore_hold_) {
+        next = step(current, -1);
+        if (next != current) since_restore_sec_ = 0.0;
+    }
+    if (next == current) return false;
+
+    // Each step gets its own hold
+    above_sec_ = below_sec_ = since_step_sec_ = 0.0;
+    LoadLevel level = static_cast<LoadLevel>(next);
+    level_.store(level, std::memory_order_relaxed);
+    transitions_[next].fetch_add(1, std::memory_order_relaxed);
+    peak_ = std::max(peak_, level);
+    return true;
+}
+
+uint64_t LoadManager::transitions() const {
+    uint64_t total = 0;
+    for (int i = 0; i < LOAD_LEVELS; i++) total += transitions_[i].load();
+    return total;
+}
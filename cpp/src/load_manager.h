@@ -0,0 +1,128 @@
+/*
+ * load_manager.h
+ * Satellite Ground Station - Stage Shedding Under CPU or Disk Pressure
+ *
+ * Every hop of a capture session is a bounded ring, so a host that can't
+ * keep up with a pass doesn't grow memory but loses whole transfers at
+ * the callback, and with them lines of the primary APT image. With
+ * shedding on, the DSP worker feeds this policy one sample per slab and
+ * the session drops its optional stages before that point, one step at
+ * a time, cheapest loss first:
+ *
+ *   Full          everything configured
+ *   NoWaterfall   the spectrum tap is skipped
+ *   Decimated     raw I/Q goes to a sidecar at sample_rate / D instead
+ *   NoRaw         raw I/Q is not written at all
+ *   PrimaryOnly   further channels get silence, only the primary decodes
+ *
+ * Pressure is the larger of the pool fill (slabs waiting on the worker
+ * plus those held by the disk writer, as a share of the pool) and the
+ * worker's DSP load (time per slab over the slab's duration), smoothed
+ * over LOAD_SMOOTH_SEC. A dropped transfer counts as full pressure and
+ * sheds a step right away; otherwise a step is shed once pressure has
+ * stayed above shed_pressure for shed_sec. One is restored after
+ * restore_sec below restore_pressure. A step shed again soon after its
+ * restore doubles the restore hold, up to LOAD_RESTORE_MAX_SEC, so a
+ * host that only keeps up without the stage settles there instead of
+ * flapping. Steps whose stage the session doesn't have are passed over.
+ *
+ * update() runs on the worker only; the published values are atomics
+ * for the metrics thread.
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#ifndef SATGS_LOAD_MANAGER_H
+#define SATGS_LOAD_MANAGER_H
+
+#include <atomic>
+#include <cstdint>
+
+#define LOAD_SHED_PRESSURE    0.75    // Shed a step above this ...
+#define LOAD_SHED_SEC         0.5     // ... held this long
+#define LOAD_RESTORE_PRESSURE 0.4     // Restore a step below this ...
+#define LOAD_RESTORE_SEC      10.0    // ... held this long
+#define LOAD_RESTORE_MAX_SEC  120.0   // Longest restore hold after repeated sheds
+#define LOAD_SMOOTH_SEC       0.25    // Pressure averaging time constant
+#define LOAD_MAX_DECIMATION   64
+
+enum class LoadLevel { Full, NoWaterfall, Decimated, NoRaw, PrimaryOnly };
+
+#define LOAD_LEVELS 5
+
+const char* load_level_name(LoadLevel level);
+
+struct LoadConfig {
+    bool enabled = false;
+    int raw_decimation = 0;               // Decimated step's D (0 = go straight to NoRaw)
+    double shed_pressure = LOAD_SHED_PRESSURE;
+    double shed_sec = LOAD_SHED_SEC;
+    double restore_pressure = LOAD_RESTORE_PRESSURE;
+    double restore_sec = LOAD_RESTORE_SEC;
+};
+
+// One slab's worth of measurements
+struct LoadSample {
+    double queue_fill = 0.0;              // Slabs waiting on the worker / pool depth
+    double writer_fill = 0.0;             // Slabs held by the disk writer / pool depth
+    double dsp_load = 0.0;                // Worker time over the slab's duration
+    bool dropped = false;                 // Transfers lost since the last sample
+    double elapsed_sec = 0.0;             // Wall time since the last sample
+};
+
+class LoadManager {
+public:
+    // Which steps the session can take (Full is always there)
+    void configure(const LoadConfig& config, bool waterfall, bool raw, bool channels);
+
+    bool enabled() const { return config_.enabled; }
+
+    // Fold one sample in; true when the level changed
+    bool update(const LoadSample& sample);
+
+    LoadLevel level() const { return level_.load(std::memory_order_relaxed); }
+    double pressure() const { return pressure_.load(std::memory_order_relaxed); }
+    const LoadSample& last() const { return last_; }    // Worker only
+
+    // Why the last step was shed: "disk" or "CPU"
+    const char* cause() const { return cause_; }
+
+    // Published for the metrics thread
+    double queue_fill() const { return queue_fill_.load(std::memory_order_relaxed); }
+    double writer_fill() const { return writer_fill_.load(std::memory_order_relaxed); }
+    double dsp_load() const { return dsp_load_.load(std::memory_order_relaxed); }
+    uint64_t transitions(LoadLevel to) const { return transitions_[static_cast<int>(to)].load(); }
+
+    // Totals over the pass; after the worker has finished
+    uint64_t transitions() const;
+    LoadLevel peak() const { return peak_; }
+    double shed_time_sec() const { return shed_time_sec_; }   // Below Full
+
+private:
+    int step(int from, int direction) const;
+
+    LoadConfig config_;
+    bool available_[LOAD_LEVELS] = {true, false, false, false, false};
+
+    // Worker only
+    LoadSample last_;
+    double smoothed_ = 0.0;
+    double above_sec_ = 0.0;
+    double below_sec_ = 0.0;
+    double restore_hold_ = LOAD_RESTORE_SEC;
+    double since_restore_sec_ = 1e300;
+    double since_step_sec_ = 1e300;
+    LoadLevel peak_ = LoadLevel::Full;
+    double shed_time_sec_ = 0.0;
+    const char* cause_ = "CPU";
+
+    std::atomic<LoadLevel> level_{LoadLevel::Full};
+    std::atomic<double> pressure_{0.0};
+    std::atomic<double> queue_fill_{0.0};
+    std::atomic<double> writer_fill_{0.0};
+    std::atomic<double> dsp_load_{0.0};
+    std::atomic<uint64_t> transitions_[LOAD_LEVELS] = {};
+};
+
+#endif // SATGS_LOAD_MANAGER_H
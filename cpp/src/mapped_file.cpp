@@ -0,0 +1,70 @@
+/*
+ * mapped_file.cpp
+ * Satellite Ground Station - Read-only memory-mapped file
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#include "mapped_file.h"
+
+#include <algorithm>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+bool MappedFile::open(const std::string& filename) {
+    close();
+    
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        ::close(fd);
+        return false;
+    }
+    
+    size_ = static_cast<size_t>(st.st_size);
+    if (size_ > 0) {
+        void* p = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) {
+            ::close(fd);
+            size_ = 0;
+            return false;
+        }
+        data_ = p;
+        // Read front to back once
+        madvise(data_, size_, MADV_SEQUENTIAL);
+    }
+    
+    // The mapping stays valid after the descriptor is closed
+    ::close(fd);
+    open_ = true;
+    return true;
+}
+
+void MappedFile::close() {
+    if (data_) munmap(data_, size_);
+    data_ = nullptr;
+    size_ = 0;
+    open_ = false;
+}
+
+static void advise_range(void* data, size_t size, size_t offset, size_t length, int advice) {
+    if (!data || offset >= size) return;
+    static const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t begin = offset / page * page;
+    size_t end = std::min(size, offset + length);
+    madvise(static_cast<char*>(data) + begin, end - begin, advice);
+}
+
+void MappedFile::prefetch(size_t offset, size_t length) const {
+    advise_range(data_, size_, offset, length, MADV_WILLNEED);
+}
+
+void MappedFile::release(size_t offset, size_t length) const {
+    advise_range(data_, size_, offset, length, MADV_DONTNEED);
+}
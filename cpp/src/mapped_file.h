@@ -0,0 +1,43 @@
+/*
+ * mapped_file.h
+ * Satellite Ground Station - Read-only memory-mapped file
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#ifndef SATGS_MAPPED_FILE_H
+#define SATGS_MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile() { close(); }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Map the whole file read-only. An empty file maps successfully with
+    // size() == 0 and data() == nullptr.
+    bool open(const std::string& filename);
+    void close();
+
+    // Paging hints for [offset, offset + length), widened to whole pages:
+    // prefetch starts readahead, release drops the pages once consumed so
+    // streaming through a multi-GB file doesn't evict everything else
+    void prefetch(size_t offset, size_t length) const;
+    void release(size_t offset, size_t length) const;
+
+    const char* data() const { return static_cast<const char*>(data_); }
+    size_t size() const { return size_; }
+    bool is_open() const { return open_; }
+
+private:
+    void* data_ = nullptr;
+    size_t size_ = 0;
+    bool open_ = false;
+};
+
+#endif // SATGS_MAPPED_FILE_H
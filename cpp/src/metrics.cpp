@@ -0,0 +1,239 @@
+/*
+ * metrics.cpp
+ * Satellite Ground Station - Prometheus Metrics Endpoint
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#include "metrics.h"
+#include "thread_util.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/statvfs.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#define METRICS_POLL_MS      200     // Stop-flag check interval
+#define METRICS_REQUEST_MAX  4096    // Request bytes read before answering
+#define METRICS_IO_TIMEOUT_MS 1000   // Per-client read budget
+
+// ----------------------------------------------------------------------------
+// Exposition
+// ----------------------------------------------------------------------------
+
+std::string metrics_label(const char* label, const std::string& value) {
+    std::string out = label;
+    out += "=\"";
+    for (char c : value) {
+        if (c == '\\' || c == '"') {
+            out += '\\';
+            out += c;
+        } else if (c == '\n') {
+            out += "\\n";
+        } else {
+            out += c;
+        }
+    }
+    out += '"';
+    return out;
+}
+
+void MetricsWriter::clear() {
+    text_.clear();
+    families_.clear();
+}
+
+void MetricsWriter::family(const char* name, const char* help, const char* type) {
+    if (std::find(families_.begin(), families_.end(), name) != families_.end()) return;
+    families_.push_back(name);
+    text_ += "# HELP ";
+    text_ += name;
+    text_ += ' ';
+    text_ += help;
+    text_ += "\n# TYPE ";
+    text_ += name;
+    text_ += ' ';
+    text_ += type;
+    text_ += '\n';
+}
+
+void MetricsWriter::sample(const char* name, const char* suffix, const std::string& labels,
+                           const char* extra_label, double value) {
+    text_ += name;
+    text_ += suffix;
+    if (!labels.empty() || extra_label) {
+        text_ += '{';
+        text_ += labels;
+        if (extra_label) {
+            if (!labels.empty()) text_ += ',';
+            text_ += extra_label;
+        }
+        text_ += '}';
+    }
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), " %.15g\n", value);
+    text_ += buf;
+}
+
+void MetricsWriter::counter(const char* name, const char* help, const std::string& labels, double value) {
+    family(name, help, "counter");
+    sample(name, "", labels, nullptr, value);
+}
+
+void MetricsWriter::gauge(const char* name, const char* help, const std::string& labels, double value) {
+    family(name, help, "gauge");
+    sample(name, "", labels, nullptr, value);
+}
+
+// Cumulative counts at power-of-two edges; the log-linear sub-buckets
+// collapse into their octave. Buckets below the first edge fold into it.
+void MetricsWriter::histogram(const char* name, const char* help, const std::string& labels,
+                              const LatencyHistogram& hist) {
+    family(name, help, "histogram");
+    uint64_t cumulative = 0;
+    int bucket = 0;
+    for (int octave = METRICS_HIST_MIN_OCTAVE; octave <= METRICS_HIST_MAX_OCTAVE; octave++) {
+        uint64_t edge = (1ULL << (octave + 1)) - 1;
+        while (bucket < LatencyHistogram::num_buckets() && LatencyHistogram::bucket_upper(bucket) <= edge) {
+            cumulative += hist.bucket_count(bucket++);
+        }
+        char le[48];
+        std::snprintf(le, sizeof(le), "le=\"%.9g\"", (edge + 1) / 1e9);
+        sample(name, "_bucket", labels, le, static_cast<double>(cumulative));
+    }
+    // Read the total last so +Inf never trails the finite buckets
+    uint64_t count = std::max(hist.count(), cumulative);
+    sample(name, "_bucket", labels, "le=\"+Inf\"", static_cast<double>(count));
+    sample(name, "_sum", labels, nullptr, hist.sum_ns() / 1e9);
+    sample(name, "_count", labels, nullptr, static_cast<double>(count));
+}
+
+double disk_free_bytes(const std::string& path) {
+    std::string dir = path;
+    size_t slash = dir.find_last_of('/');
+    dir = slash == std::string::npos ? "." : (slash == 0 ? "/" : dir.substr(0, slash));
+    struct statvfs st;
+    if (statvfs(dir.c_str(), &st) != 0) return -1.0;
+    return static_cast<double>(st.f_bavail) * st.f_frsize;
+}
+
+// ----------------------------------------------------------------------------
+// Server
+// ----------------------------------------------------------------------------
+
+void MetricsServer::add_collector(MetricsCollector collector) {
+    collectors_.push_back(std::move(collector));
+}
+
+bool MetricsServer::start(int port, const std::string& bind_address) {
+    if (running_) return false;
+    listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd_ < 0) {
+        std::cerr << "Error: Metrics socket: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    int one = 1;
+    setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    if (inet_pton(AF_INET, bind_address.c_str(), &addr.sin_addr) != 1) {
+        std::cerr << "Error: Bad metrics bind address: " << bind_address << std::endl;
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+    if (bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        listen(listen_fd_, 8) != 0) {
+        std::cerr << "Error: Cannot serve metrics on " << bind_address << ":" << port << ": "
+                  << std::strerror(errno) << std::endl;
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+    socklen_t len = sizeof(addr);
+    getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&addr), &len);
+    port_ = ntohs(addr.sin_port);
+
+    running_ = true;
+    thread_ = std::thread(&MetricsServer::serve_loop, this);
+    return true;
+}
+
+void MetricsServer::stop() {
+    running_ = false;
+    if (thread_.joinable()) thread_.join();
+    if (listen_fd_ >= 0) {
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+    }
+}
+
+void MetricsServer::serve_loop() {
+    set_current_thread_name("satgs-metrics");
+    while (running_) {
+        pollfd pfd = {listen_fd_, POLLIN, 0};
+        if (poll(&pfd, 1, METRICS_POLL_MS) <= 0) continue;
+        int client = accept(listen_fd_, nullptr, nullptr);
+        if (client < 0) continue;
+        handle(client);
+        ::close(client);
+    }
+}
+
+static void send_all(int fd, const char* data, size_t len) {
+    while (len > 0) {
+        ssize_t n = send(fd, data, len, MSG_NOSIGNAL);
+        if (n <= 0) return;
+        data += n;
+        len -= static_cast<size_t>(n);
+    }
+}
+
+// One request per connection; scrapers send a short GET and wait
+void MetricsServer::handle(int client) {
+    timeval timeout = {METRICS_IO_TIMEOUT_MS / 1000, 0};
+    setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    char request[METRICS_REQUEST_MAX];
+    size_t got = 0;
+    while (got < sizeof(request) - 1) {
+        pollfd pfd = {client, POLLIN, 0};
+        if (poll(&pfd, 1, METRICS_IO_TIMEOUT_MS) <= 0) return;
+        ssize_t n = recv(client, request + got, sizeof(request) - 1 - got, 0);
+        if (n <= 0) return;
+        got += static_cast<size_t>(n);
+        request[got] = '\0';
+        if (std::strstr(request, "\r\n\r\n") || std::strstr(request, "\n\n")) break;
+    }
+    request[got] = '\0';
+
+    bool metrics = std::strncmp(request, "GET /metrics", 12) == 0 &&
+                   (request[12] == ' ' || request[12] == '?');
+    std::string header;
+    const std::string* body;
+    static const std::string not_found = "Not found; try /metrics\n";
+    if (metrics) {
+        writer_.clear();
+        for (const MetricsCollector& collect : collectors_) collect(writer_);
+        scrapes_++;
+        body = &writer_.text();
+        header = "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\n";
+    } else {
+        body = &not_found;
+        header = "HTTP/1.0 404 Not Found\r\nContent-Type: text/plain\r\n";
+    }
+    header += "Content-Length: " + std::to_string(body->size()) + "\r\nConnection: close\r\n\r\n";
+    send_all(client, header.data(), header.size());
+    send_all(client, body->data(), body->size());
+}
@@ -0,0 +1,94 @@
+/*
+ * metrics.h
+ * Satellite Ground Station - Prometheus Metrics Endpoint
+ *
+ * Live counters for unattended operation, served as Prometheus text
+ * exposition on http://<bind>:<port>/metrics. Nothing here touches the
+ * hot paths: readers and workers keep bumping their own relaxed atomics
+ * (CaptureSession, LatencyHistogram) and collectors read them on the
+ * server thread when a scrape comes in.
+ *
+ *   satgs_samples_total{session="NOAA 19"} 2160000000
+ *   satgs_write_latency_seconds_bucket{session="NOAA 19",le="0.000262144"} 8192
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#ifndef SATGS_METRICS_H
+#define SATGS_METRICS_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "latency_histogram.h"
+
+#define METRICS_BIND_ADDRESS "127.0.0.1"   // Default: local scrapers only
+#define METRICS_HIST_MIN_OCTAVE 10         // Exported buckets: le 2 us ...
+#define METRICS_HIST_MAX_OCTAVE 35         // ... to 68 s, one per power of two
+
+// Builds one exposition page. Each family's HELP/TYPE is written once,
+// however many label sets (sessions) report it.
+class MetricsWriter {
+public:
+    // labels: pre-formatted pairs, e.g. session="NOAA 19" (empty = none)
+    void counter(const char* name, const char* help, const std::string& labels, double value);
+    void gauge(const char* name, const char* help, const std::string& labels, double value);
+
+    // Nanosecond histogram exported in seconds
+    void histogram(const char* name, const char* help, const std::string& labels,
+                   const LatencyHistogram& hist);
+
+    const std::string& text() const { return text_; }
+    void clear();
+
+private:
+    void family(const char* name, const char* help, const char* type);
+    void sample(const char* name, const char* suffix, const std::string& labels,
+                const char* extra_label, double value);
+
+    std::string text_;
+    std::vector<std::string> families_;
+};
+
+// label="value" with quotes / backslashes / newlines escaped
+std::string metrics_label(const char* label, const std::string& value);
+
+typedef std::function<void(MetricsWriter&)> MetricsCollector;
+
+// Minimal HTTP/1.0 server on its own thread: GET /metrics runs every
+// collector and returns the page, anything else is a 404
+class MetricsServer {
+public:
+    ~MetricsServer() { stop(); }
+
+    // Collectors must be added before start()
+    void add_collector(MetricsCollector collector);
+
+    bool start(int port, const std::string& bind_address = METRICS_BIND_ADDRESS);
+    void stop();
+
+    int port() const { return port_; }
+    uint64_t scrapes() const { return scrapes_; }
+
+private:
+    void serve_loop();
+    void handle(int client);
+
+    std::vector<MetricsCollector> collectors_;
+    MetricsWriter writer_;
+    int listen_fd_ = -1;
+    int port_ = 0;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<uint64_t> scrapes_{0};
+};
+
+// Free space (bytes) on the filesystem holding path; -1 if unknown
+double disk_free_bytes(const std::string& path);
+
+#endif // SATGS_METRICS_H
@@ -0,0 +1,334 @@
+/*
+ * orbit.cpp
+ * Satellite Ground Station - Pass Prediction and Doppler from SGP4
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#include "orbit.h"
+#include "doppler_profile.h"
+#include "json_reader.h"
+#include "mapped_file.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <iostream>
+
+// WGS-84 ellipsoid for the station position
+#define WGS84_RADIUS_KM     6378.137
+#define WGS84_FLATTENING    (1.0 / 298.257223563)
+
+// Steps per look_batch block; sized to keep the scratch on the stack
+#define LOOK_BATCH_BLOCK    256
+
+static const double kPi = 3.14159265358979323846;
+static const double kDeg2Rad = kPi / 180.0;
+static const double kRad2Deg = 180.0 / kPi;
+
+// ----------------------------------------------------------------------------
+// Configuration
+// ----------------------------------------------------------------------------
+
+bool GroundStation::load(const std::string& filename) {
+    MappedFile file;
+    if (!file.open(filename)) {
+        std::cerr << "Error: Cannot load station config: " << filename << std::endl;
+        return false;
+    }
+
+    JsonReader json(file.data(), file.size());
+    std::string_view section, key, text;
+    json.begin_object();
+    while (json.next_key(section)) {
+        if ((section != "station" && section != "capture") || json.peek() != '{') {
+            json.skip_value();
+            continue;
+        }
+        json.begin_object();
+        while (json.next_key(key)) {
+            if (section == "station" && key == "name" && json.peek() == '"') {
+                json.read_string(text);
+                name.assign(text);
+            } else if (section == "station" && key == "lat") {
+                json.read_number(lat_deg);
+            } else if (section == "station" && key == "lon") {
+                json.read_number(lon_deg);
+            } else if (section == "station" && key == "elevation_m") {
+                json.read_number(elevation_m);
+            } else if (section == "station" && key == "min_elevation_deg") {
+                json.read_number(min_elevation_deg);
+            } else if (section == "capture" && key == "pre_aos_margin_sec") {
+                json.read_number(pre_aos_margin_sec);
+            } else if (section == "capture" && key == "post_los_margin_sec") {
+                json.read_number(post_los_margin_sec);
+            } else if (section == "capture" && key == "primary_freq_hz") {
+                json.read_number(primary_freq_hz);
+            } else {
+                json.skip_value();
+            }
+        }
+    }
+
+    if (!json.ok()) {
+        std::cerr << "Error: Malformed station config at byte " << json.error_offset()
+                  << ": " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+double downlink_freq_hz(const std::string& sat_name, double fallback_hz) {
+    static const struct {
+        const char* name;
+        double freq_hz;
+    } kDownlinks[] = {
+        {"NOAA 15", 137.620e6},
+        {"NOAA 18", 137.9125e6},
+        {"NOAA 19", 137.100e6},
+        {"NOAA 20", 137.100e6},
+    };
+
+    std::string upper = sat_name;
+    for (auto& c : upper) c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    for (const auto& entry : kDownlinks) {
+        if (upper.find(entry.name) != std::string::npos) return entry.freq_hz;
+    }
+    return fallback_hz;
+}
+
+// ----------------------------------------------------------------------------
+// PassPredictor
+// ----------------------------------------------------------------------------
+
+bool PassPredictor::init(const Tle& tle, const GroundStation& station) {
+    if (!sgp4_.init(tle)) {
+        std::cerr << "Error: " << (tle.name.empty() ? "Satellite" : tle.name)
+                  << ": " << sgp4_.error() << std::endl;
+        return false;
+    }
+    station_ = station;
+
+    double lat = station.lat_deg * kDeg2Rad;
+    double lon = station.lon_deg * kDeg2Rad;
+    sin_lat_ = std::sin(lat);
+    cos_lat_ = std::cos(lat);
+    sin_lon_ = std::sin(lon);
+    cos_lon_ = std::cos(lon);
+
+    const double e2 = WGS84_FLATTENING * (2.0 - WGS84_FLATTENING);
+    double n = WGS84_RADIUS_KM / std::sqrt(1.0 - e2 * sin_lat_ * sin_lat_);
+    double h = station.elevation_m / 1000.0;
+    site_[0] = (n + h) * cos_lat_ * cos_lon_;
+    site_[1] = (n + h) * cos_lat_ * sin_lon_;
+    site_[2] = (n * (1.0 - e2) + h) * sin_lat_;
+    return true;
+}
+
+void PassPredictor::topocentric(const StateVector& sv, double jd, LookAngles& out) const {
+    // TEME -> earth-fixed; the station is at rest in this frame, so the
+    // relative velocity is the satellite's minus earth rotation
+    double theta = gmst_rad(jd);
+    double st = std::sin(theta), ct = std::cos(theta);
+    double x = ct * sv.r[0] + st * sv.r[1];
+    double y = -st * sv.r[0] + ct * sv.r[1];
+    double z = sv.r[2];
+    double vx = ct * sv.v[0] + st * sv.v[1] + EARTH_ROTATION_RAD_S * y;
+    double vy = -st * sv.v[0] + ct * sv.v[1] - EARTH_ROTATION_RAD_S * x;
+    double vz = sv.v[2];
+
+    double dx = x - site_[0];
+    double dy = y - site_[1];
+    double dz = z - site_[2];
+    double range = std::sqrt(dx * dx + dy * dy + dz * dz);
+
+    // South-east-zenith
+    double south = sin_lat_ * cos_lon_ * dx + sin_lat_ * sin_lon_ * dy - cos_lat_ * dz;
+    double east = -sin_lon_ * dx + cos_lon_ * dy;
+    double zenith = cos_lat_ * cos_lon_ * dx + cos_lat_ * sin_lon_ * dy + sin_lat_ * dz;
+
+    double az = std::atan2(east, -south) * kRad2Deg;
+    out.azimuth_deg = az < 0.0 ? az + 360.0 : az;
+    out.elevation_deg = std::asin(zenith / range) * kRad2Deg;
+    out.range_km = range;
+    out.range_rate_km_s = (dx * vx + dy * vy + dz * vz) / range;
+}
+
+bool PassPredictor::look(double unix_sec, LookAngles& out) const {
+    double jd = unix_to_jd(unix_sec);
+    StateVector sv;
+    if (sgp4_.propagate((jd - sgp4_.epoch_jd()) * 1440.0, sv) != 0) {
+        out = LookAngles{0, 0, 0, 0};
+        return false;
+    }
+    topocentric(sv, jd, out);
+    return true;
+}
+
+size_t PassPredictor::look_batch(double start_unix, double step_sec, size_t n, LookAngles* out) const {
+    double tsince[LOOK_BATCH_BLOCK];
+    StateVector states[LOOK_BATCH_BLOCK];
+    int errors[LOOK_BATCH_BLOCK];
+    const double start_jd = unix_to_jd(start_unix);
+    const double step_days = step_sec / 86400.0;
+    const double epoch_offset_min = (start_jd - sgp4_.epoch_jd()) * 1440.0;
+    size_t failed = 0;
+
+    for (size_t base = 0; base < n; base += LOOK_BATCH_BLOCK) {
+        size_t count = std::min<size_t>(LOOK_BATCH_BLOCK, n - base);
+        for (size_t k = 0; k < count; k++) {
+            tsince[k] = epoch_offset_min + (base + k) * step_sec / 60.0;
+        }
+        failed += sgp4_.propagate_batch(tsince, count, states, errors);
+        for (size_t k = 0; k < count; k++) {
+            if (errors[k] != 0) {
+                out[base + k] = LookAngles{0, 0, 0, 0};
+                continue;
+            }
+            topocentric(states[k], start_jd + (base + k) * step_days, out[base + k]);
+        }
+    }
+    return failed;
+}
+
+size_t PassPredictor::position_batch(double start_unix, double step_sec, size_t n, double* xyz_km) const {
+    double tsince[LOOK_BATCH_BLOCK];
+    StateVector states[LOOK_BATCH_BLOCK];
+    int errors[LOOK_BATCH_BLOCK];
+    const double start_jd = unix_to_jd(start_unix);
+    const double step_days = step_sec / 86400.0;
+    const double epoch_offset_min = (start_jd - sgp4_.epoch_jd()) * 1440.0;
+    size_t failed = 0;
+
+    for (size_t base = 0; base < n; base += LOOK_BATCH_BLOCK) {
+        size_t count = std::min<size_t>(LOOK_BATCH_BLOCK, n - base);
+        for (size_t k = 0; k < count; k++) {
+            tsince[k] = epoch_offset_min + (base + k) * step_sec / 60.0;
+        }
+        failed += sgp4_.propagate_batch(tsince, count, states, errors);
+        for (size_t k = 0; k < count; k++) {
+            double* out = xyz_km + 3 * (base + k);
+            if (errors[k] != 0) {
+                out[0] = out[1] = out[2] = 0.0;
+                continue;
+            }
+            double theta = gmst_rad(start_jd + (base + k) * step_days);
+            double st = std::sin(theta), ct = std::cos(theta);
+            out[0] = ct * states[k].r[0] + st * states[k].r[1];
+            out[1] = -st * states[k].r[0] + ct * states[k].r[1];
+            out[2] = states[k].r[2];
+        }
+    }
+    return failed;
+}
+
+double PassPredictor::elevation(double unix_sec) const {
+    LookAngles la;
+    return look(unix_sec, la) ? la.elevation_deg : -90.0;
+}
+
+// Bisect the mask crossing between a time below it and one above
+double PassPredictor::refine_crossing(double t_below, double t_above) const {
+    while (std::fabs(t_above - t_below) > PASS_REFINE_SEC) {
+        double mid = 0.5 * (t_below + t_above);
+        if (elevation(mid) >= station_.min_elevation_deg) t_above = mid;
+        else t_below = mid;
+    }
+    return t_above;
+}
+
+bool PassPredictor::find_next_pass(double start_unix, double search_sec, SatellitePass& pass) const {
+    const double mask = station_.min_elevation_deg;
+    const double step = PASS_SEARCH_STEP_SEC;
+    const size_t total = static_cast<size_t>(std::ceil(search_sec / step)) + 1;
+    LookAngles looks[LOOK_BATCH_BLOCK];
+
+    bool in_pass = false;
+    double prev_t = start_unix;
+    double best_t = start_unix, best_el = -90.0;
+
+    // Coarse sweep in batches, refining each edge as it is found
+    for (size_t base = 0; base < total; base += LOOK_BATCH_BLOCK) {
+        size_t count = std::min<size_t>(LOOK_BATCH_BLOCK, total - base);
+        double block_start = start_unix + base * step;
+        look_batch(block_start, step, count, looks);
+
+        for (size_t k = 0; k < count; k++) {
+            double t = block_start + k * step;
+            double el = looks[k].range_km > 0.0 ? looks[k].elevation_deg : -90.0;
+            if (!in_pass && el >= mask) {
+                in_pass = true;
+                pass.aos_unix = (base + k == 0) ? start_unix : refine_crossing(prev_t, t);
+                best_t = t;
+                best_el = el;
+            } else if (in_pass && el > best_el) {
+                best_t = t;
+                best_el = el;
+            } else if (in_pass && el < mask) {
+                pass.los_unix = refine_crossing(t, prev_t);
+
+                // Golden-section search for the peak around the best sample
+                const double g = 0.6180339887498949;
+                double a = std::max(pass.aos_unix, best_t - step);
+                double b = std::min(pass.los_unix, best_t + step);
+                double c = b - g * (b - a), d = a + g * (b - a);
+                double fc = elevation(c), fd = elevation(d);
+                while (b - a > PASS_REFINE_SEC) {
+                    if (fc > fd) {
+                        b = d; d = c; fd = fc;
+                        c = b - g * (b - a); fc = elevation(c);
+                    } else {
+                        a = c; c = d; fc = fd;
+                        d = a + g * (b - a); fd = elevation(d);
+                    }
+                }
+                pass.tca_unix = 0.5 * (a + b);
+                pass.max_elevation_deg = std::max(best_el, elevation(pass.tca_unix));
+                return true;
+            }
+            prev_t = t;
+        }
+    }
+    return false;
+}
+
+size_t PassPredictor::find_passes(double start_unix, double span_sec, std::vector<SatellitePass>& passes) const {
+    size_t found = 0;
+    double t = start_unix;
+    const double end = start_unix + span_sec;
+    SatellitePass pass;
+    while (t < end && find_next_pass(t, end - t, pass)) {
+        passes.push_back(pass);
+        found++;
+        t = pass.los_unix + PASS_SEARCH_STEP_SEC;
+    }
+    return found;
+}
+
+bool PassPredictor::build_profile(const SatellitePass& pass, double freq_hz, double step_sec, DopplerProfile& out) const {
+    if (step_sec <= 0.0) {
+        std::cerr << "Error: Profile step must be positive" << std::endl;
+        return false;
+    }
+    double start = pass.aos_unix - station_.pre_aos_margin_sec;
+    double duration = (pass.los_unix + station_.post_los_margin_sec) - start;
+    size_t n = static_cast<size_t>(duration / step_sec) + 1;
+
+    std::vector<LookAngles> looks(n);
+    if (look_batch(start, step_sec, n, looks.data()) != 0) {
+        std::cerr << "Error: SGP4 failed while building Doppler profile" << std::endl;
+        return false;
+    }
+
+    out.center_freq_hz = freq_hz;
+    out.time_step_sec = step_sec;
+    out.aos_epoch_sec = start;
+    out.times_sec.resize(n);
+    out.doppler_hz.resize(n);
+    for (size_t i = 0; i < n; i++) {
+        out.times_sec[i] = i * step_sec;
+        out.doppler_hz[i] = doppler_hz(looks[i], freq_hz);
+    }
+    return out.prepare();
+}
@@ -0,0 +1,117 @@
+/*
+ * orbit.h
+ * Satellite Ground Station - Pass Prediction and Doppler from SGP4
+ *
+ * Topocentric look angles and range-rate Doppler for one satellite as
+ * seen from the station in config.json, plus AOS/LOS search and profile
+ * generation. Replaces the skyfield path in doppler_calc.py for the C++
+ * tools, using the same model, constants and Doppler sign convention.
+ *
+ * TEME -> earth-fixed uses GMST only: polar motion and UT1 - UTC
+ * (under 0.9 s of earth rotation, a few hundred metres at the ground)
+ * are ignored.
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#ifndef SATGS_ORBIT_H
+#define SATGS_ORBIT_H
+
+#include "sgp4.h"
+
+#include <string>
+#include <vector>
+
+#define SPEED_OF_LIGHT_MPS      299792458.0
+#define EARTH_ROTATION_RAD_S    7.292115146706979e-5
+
+// Coarse step of the AOS/LOS search; passes shorter than this that
+// barely clear the mask can be missed, which doppler_calc never schedules
+#define PASS_SEARCH_STEP_SEC    20.0
+#define PASS_REFINE_SEC         0.1
+
+// Station and capture settings from config.json
+struct GroundStation {
+    std::string name;
+    double lat_deg = 40.7934;
+    double lon_deg = -77.8600;
+    double elevation_m = 376.0;
+    double min_elevation_deg = 10.0;
+    double pre_aos_margin_sec = 30.0;
+    double post_los_margin_sec = 30.0;
+    double primary_freq_hz = 137.1e6;
+
+    // Fields missing from the file keep their defaults
+    bool load(const std::string& filename);
+};
+
+// Downlink frequency for a satellite name (the doppler_calc.py
+// NOAA_FREQUENCIES table), or fallback_hz if it isn't listed
+double downlink_freq_hz(const std::string& sat_name, double fallback_hz);
+
+struct LookAngles {
+    double azimuth_deg;
+    double elevation_deg;
+    double range_km;
+    double range_rate_km_s;     // Positive = receding
+};
+
+struct SatellitePass {
+    double aos_unix;
+    double los_unix;
+    double tca_unix;            // Time of maximum elevation
+    double max_elevation_deg;
+};
+
+struct DopplerProfile;
+
+class PassPredictor {
+public:
+    bool init(const Tle& tle, const GroundStation& station);
+
+    // Look angles at a Unix time; false if SGP4 fails (decayed elements)
+    bool look(double unix_sec, LookAngles& out) const;
+
+    // out[k] = look(start + k * step) for k < n, propagated in blocks so
+    // the SGP4 and topocentric loops run over contiguous arrays. Returns
+    // the number of steps that failed (left zeroed).
+    size_t look_batch(double start_unix, double step_sec, size_t n, LookAngles* out) const;
+
+    // Earth-fixed position (km, the same GMST-only rotation) at start +
+    // k * step for k < n, into xyz_km[3k .. 3k + 2]. Returns the number
+    // of steps that failed (left zeroed).
+    size_t position_batch(double start_unix, double step_sec, size_t n, double* xyz_km) const;
+
+    // Doppler shift of a carrier at freq_hz (observed - transmitted)
+    static double doppler_hz(const LookAngles& look, double freq_hz) {
+        return -freq_hz * look.range_rate_km_s * 1000.0 / SPEED_OF_LIGHT_MPS;
+    }
+
+    // Next pass above the station's elevation mask starting at or after
+    // start_unix, searching search_sec ahead. A pass already in
+    // progress reports AOS = start_unix.
+    bool find_next_pass(double start_unix, double search_sec, SatellitePass& pass) const;
+
+    // All passes in [start_unix, start_unix + span_sec)
+    size_t find_passes(double start_unix, double span_sec, std::vector<SatellitePass>& passes) const;
+
+    // Profile over the pass plus the station's capture margins, with
+    // times relative to aos_epoch_sec = AOS - pre margin
+    bool build_profile(const SatellitePass& pass, double freq_hz, double step_sec, DopplerProfile& out) const;
+
+    const Sgp4& sgp4() const { return sgp4_; }
+    const GroundStation& station() const { return station_; }
+
+private:
+    void topocentric(const StateVector& sv, double jd, LookAngles& out) const;
+    double elevation(double unix_sec) const;
+    double refine_crossing(double t_below, double t_above) const;
+
+    Sgp4 sgp4_;
+    GroundStation station_;
+    double site_[3] = {0, 0, 0};    // Station ECEF, km
+    double sin_lat_ = 0, cos_lat_ = 1, sin_lon_ = 0, cos_lon_ = 1;
+};
+
+#endif // SATGS_ORBIT_H
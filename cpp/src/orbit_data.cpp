@@ -0,0 +1,301 @@
+/*
+ * orbit_data.cpp
+ * Satellite Ground Station - Compact Orbital Data for the HMI
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#include "orbit_data.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#define ORBIT_DELTA_LIMIT   32000.0     // Largest int16 difference, with rounding to spare
+#define ORBIT_DOPPLER_QUANTUM 0.1       // Hz, before any widening
+
+template <typename T>
+static void put(uint8_t* buf, size_t offset, T value) {
+    std::memcpy(buf + offset, &value, sizeof(T));
+}
+
+template <typename T>
+static T get(const uint8_t* buf, size_t offset) {
+    T value;
+    std::memcpy(&value, buf + offset, sizeof(T));
+    return value;
+}
+
+static size_t pad8(size_t bytes) {
+    return (bytes + 7) & ~static_cast<size_t>(7);
+}
+
+static size_t track_bytes(size_t samples) {
+    return ORBIT_TRACK_SIZE + pad8(6 * (samples - 2));
+}
+
+static size_t series_bytes(size_t count) {
+    return pad8(4 * count);
+}
+
+static int16_t clamp16(double value) {
+    return static_cast<int16_t>(std::max(-32767.0, std::min(32767.0, std::round(value))));
+}
+
+// ----------------------------------------------------------------------------
+// Writing
+// ----------------------------------------------------------------------------
+
+// Positions as integers of a power-of-two metre quantum small enough for
+// the second differences to fit int16
+static void encode_track(const std::vector<double>& xyz_km, size_t samples, uint8_t* buf) {
+    double max_d2 = 0.0;
+    for (size_t k = 2; k < samples; k++) {
+        for (int c = 0; c < 3; c++) {
+            double d2 = xyz_km[3 * k + c] - 2.0 * xyz_km[3 * (k - 1) + c] + xyz_km[3 * (k - 2) + c];
+            max_d2 = std::max(max_d2, std::abs(d2) * 1000.0);
+        }
+    }
+    double quantum = 1.0;
+    while (max_d2 / quantum > ORBIT_DELTA_LIMIT) quantum *= 2.0;
+
+    std::vector<int64_t> q(3 * samples);
+    for (size_t i = 0; i < q.size(); i++) q[i] = std::llround(xyz_km[i] * 1000.0 / quantum);
+
+    std::memset(buf, 0, track_bytes(samples));
+    for (int c = 0; c < 3; c++) {
+        put<int32_t>(buf, 4 * c, static_cast<int32_t>(q[c]));
+        put<int32_t>(buf, 12 + 4 * c, static_cast<int32_t>(q[3 + c] - q[c]));
+    }
+    put<float>(buf, 24, static_cast<float>(quantum));
+    for (size_t k = 2; k < samples; k++) {
+        for (int c = 0; c < 3; c++) {
+            int64_t d2 = q[3 * k + c] - 2 * q[3 * (k - 1) + c] + q[3 * (k - 2) + c];
+            put<int16_t>(buf, ORBIT_TRACK_SIZE + 2 * (3 * (k - 2) + c), clamp16(static_cast<double>(d2)));
+        }
+    }
+}
+
+static void encode_pass(const OrbitPass& p, uint8_t* record, uint8_t* series) {
+    size_t n = p.doppler_hz.size();
+    double quantum = ORBIT_DOPPLER_QUANTUM;
+    std::vector<int64_t> q(n);
+    for (;;) {
+        double max_delta = 0.0;
+        for (size_t i = 0; i < n; i++) {
+            q[i] = std::llround(p.doppler_hz[i] / quantum);
+            if (i > 0) max_delta = std::max(max_delta, std::abs(static_cast<double>(q[i] - q[i - 1])));
+        }
+        if (max_delta <= ORBIT_DELTA_LIMIT) break;
+        quantum *= 2.0;
+    }
+
+    std::memset(record, 0, ORBIT_PASS_SIZE);
+    put<uint32_t>(record, 0, p.satellite);
+    put<uint32_t>(record, 4, static_cast<uint32_t>(n));
+    put<double>(record, 8, p.pass.aos_unix);
+    put<double>(record, 16, p.pass.tca_unix);
+    put<double>(record, 24, p.pass.los_unix);
+    put<float>(record, 32, static_cast<float>(p.pass.max_elevation_deg));
+    put<float>(record, 36, static_cast<float>(p.aos_az_deg));
+    put<float>(record, 40, static_cast<float>(p.tca_az_deg));
+    put<float>(record, 44, static_cast<float>(p.los_az_deg));
+    put<float>(record, 48, static_cast<float>(p.tca_range_km));
+    put<float>(record, 52, static_cast<float>(quantum));
+    put<int32_t>(record, 56, n ? static_cast<int32_t>(q[0]) : 0);
+
+    if (n == 0) return;
+    std::memset(series, 0, series_bytes(n));
+    for (size_t i = 0; i < n; i++) {
+        double el = i < p.elevation_deg.size() ? p.elevation_deg[i] : 0.0;
+        put<int16_t>(series, 2 * i, clamp16(el * 100.0));
+        put<int16_t>(series, 2 * (n + i), i ? clamp16(static_cast<double>(q[i] - q[i - 1])) : int16_t(0));
+    }
+}
+
+void orbit_encode_segment(double start_unix, size_t samples, const std::vector<std::vector<double>>& tracks,
+                          const std::vector<OrbitPass>& passes, std::vector<uint8_t>& out) {
+    size_t bytes = ORBIT_SEGMENT_SIZE + tracks.size() * track_bytes(samples) + passes.size() * ORBIT_PASS_SIZE;
+    for (const OrbitPass& p : passes) bytes += series_bytes(p.doppler_hz.size());
+
+    size_t begin = out.size();
+    out.resize(begin + bytes, 0);
+    uint8_t* buf = out.data() + begin;
+    std::memcpy(buf, ORBIT_SEGMENT_MAGIC, 4);
+    put<uint32_t>(buf, 4, static_cast<uint32_t>(bytes));
+    put<double>(buf, 8, start_unix);
+    put<uint32_t>(buf, 16, static_cast<uint32_t>(samples));
+    put<uint32_t>(buf, 20, static_cast<uint32_t>(passes.size()));
+
+    size_t offset = ORBIT_SEGMENT_SIZE;
+    for (const auto& track : tracks) {
+        encode_track(track, samples, buf + offset);
+        offset += track_bytes(samples);
+    }
+    // Records first, so a reader can index them before the curves
+    size_t series = offset + passes.size() * ORBIT_PASS_SIZE;
+    for (const OrbitPass& p : passes) {
+        encode_pass(p, buf + offset, buf + series);
+        offset += ORBIT_PASS_SIZE;
+        series += series_bytes(p.doppler_hz.size());
+    }
+}
+
+bool orbit_write_file(const std::string& filename, const OrbitDataHeader& header, const std::string& meta,
+                      const std::vector<std::vector<uint8_t>>& segments) {
+    std::string padded = meta;
+    padded.resize(pad8(meta.size()), ' ');
+
+    uint8_t head[ORBIT_DATA_HEADER_SIZE] = {0};
+    std::memcpy(head, ORBIT_DATA_MAGIC, 4);
+    put<uint32_t>(head, 4, header.version);
+    put<uint32_t>(head, 8, ORBIT_DATA_HEADER_SIZE);
+    put<uint32_t>(head, 12, static_cast<uint32_t>(padded.size()));
+    put<double>(head, 16, header.generated_unix);
+    put<double>(head, 24, header.start_unix);
+    put<double>(head, 32, header.step_sec);
+    put<double>(head, 40, header.doppler_step_sec);
+    put<double>(head, 48, header.segment_sec);
+    put<uint32_t>(head, 56, header.num_satellites);
+    put<uint32_t>(head, 60, static_cast<uint32_t>(segments.size()));
+
+    std::string tmp = filename + ".tmp";
+    FILE* f = std::fopen(tmp.c_str(), "wb");
+    if (!f) {
+        std::cerr << "Error: Cannot write orbital data: " << filename << std::endl;
+        return false;
+    }
+    bool ok = std::fwrite(head, 1, sizeof(head), f) == sizeof(head) &&
+              std::fwrite(padded.data(), 1, padded.size(), f) == padded.size();
+    for (const auto& segment : segments) {
+        ok = ok && std::fwrite(segment.data(), 1, segment.size(), f) == segment.size();
+    }
+    ok = (std::fclose(f) == 0) && ok;
+    if (!ok || std::rename(tmp.c_str(), filename.c_str()) != 0) {
+        std::cerr << "Error: Failed writing orbital data: " << filename << std::endl;
+        std::remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// OrbitDataReader
+// ----------------------------------------------------------------------------
+
+bool OrbitDataReader::open(const std::string& filename) {
+    filename_ = filename;
+    segments_.clear();
+    meta_ = std::string_view();
+    if (!file_.open(filename)) {
+        std::cerr << "Error: Cannot open orbital data: " << filename << std::endl;
+        return false;
+    }
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(file_.data());
+    size_t size = file_.size();
+    if (size < ORBIT_DATA_HEADER_SIZE || std::memcmp(data, ORBIT_DATA_MAGIC, 4) != 0) {
+        std::cerr << "Error: Not an orbital data file: " << filename << std::endl;
+        return false;
+    }
+    header_.version = get<uint32_t>(data, 4);
+    uint32_t header_size = get<uint32_t>(data, 8);
+    header_.meta_bytes = get<uint32_t>(data, 12);
+    header_.generated_unix = get<double>(data, 16);
+    header_.start_unix = get<double>(data, 24);
+    header_.step_sec = get<double>(data, 32);
+    header_.doppler_step_sec = get<double>(data, 40);
+    header_.segment_sec = get<double>(data, 48);
+    header_.num_satellites = get<uint32_t>(data, 56);
+    header_.num_segments = get<uint32_t>(data, 60);
+    if (header_.version != ORBIT_DATA_VERSION || header_size < ORBIT_DATA_HEADER_SIZE ||
+        header_size + static_cast<size_t>(header_.meta_bytes) > size) {
+        std::cerr << "Error: Unsupported orbital data version " << header_.version << ": " << filename
+                  << std::endl;
+        return false;
+    }
+    meta_ = std::string_view(file_.data() + header_size, header_.meta_bytes);
+
+    size_t offset = header_size + header_.meta_bytes;
+    for (uint32_t i = 0; i < header_.num_segments; i++) {
+        Segment s;
+        s.offset = offset;
+        if (offset + ORBIT_SEGMENT_SIZE > size || std::memcmp(data + offset, ORBIT_SEGMENT_MAGIC, 4) != 0) {
+            std::cerr << "Error: Orbital data cut short at segment " << i << ": " << filename << std::endl;
+            return false;
+        }
+        s.bytes = get<uint32_t>(data, offset + 4);
+        s.start_unix = get<double>(data, offset + 8);
+        s.samples = get<uint32_t>(data, offset + 16);
+        s.passes = get<uint32_t>(data, offset + 20);
+        size_t needed = ORBIT_SEGMENT_SIZE + header_.num_satellites * track_bytes(s.samples) +
+                        s.passes * static_cast<size_t>(ORBIT_PASS_SIZE);
+        if (s.samples < 2 || s.bytes < needed || offset + s.bytes > size) {
+            std::cerr << "Error: Malformed orbital data segment " << i << ": " << filename << std::endl;
+            return false;
+        }
+        segments_.push_back(s);
+        offset += s.bytes;
+    }
+    return true;
+}
+
+const uint8_t* OrbitDataReader::segment_data(size_t i) const {
+    return reinterpret_cast<const uint8_t*>(file_.data()) + segments_[i].offset;
+}
+
+bool OrbitDataReader::decode_track(size_t segment, uint32_t satellite, std::vector<double>& xyz_km) const {
+    if (segment >= segments_.size() || satellite >= header_.num_satellites) return false;
+    const Segment& s = segments_[segment];
+    const uint8_t* buf = segment_data(segment) + ORBIT_SEGMENT_SIZE + satellite * track_bytes(s.samples);
+    double quantum = get<float>(buf, 24);
+    std::vector<int64_t> q(3 * s.samples);
+    for (int c = 0; c < 3; c++) {
+        q[c] = get<int32_t>(buf, 4 * c);
+        q[3 + c] = q[c] + get<int32_t>(buf, 12 + 4 * c);
+    }
+    for (size_t k = 2; k < s.samples; k++) {
+        for (int c = 0; c < 3; c++) {
+            q[3 * k + c] = 2 * q[3 * (k - 1) + c] - q[3 * (k - 2) + c] +
+                           get<int16_t>(buf, ORBIT_TRACK_SIZE + 2 * (3 * (k - 2) + c));
+        }
+    }
+    xyz_km.resize(q.size());
+    for (size_t i = 0; i < q.size(); i++) xyz_km[i] = q[i] * quantum / 1000.0;
+    return true;
+}
+
+bool OrbitDataReader::decode_passes(size_t segment, std::vector<OrbitPass>& passes) const {
+    if (segment >= segments_.size()) return false;
+    const Segment& s = segments_[segment];
+    const uint8_t* base = segment_data(segment);
+    size_t offset = ORBIT_SEGMENT_SIZE + header_.num_satellites * track_bytes(s.samples);
+    size_t series = offset + s.passes * static_cast<size_t>(ORBIT_PASS_SIZE);
+    for (uint32_t i = 0; i < s.passes; i++, offset += ORBIT_PASS_SIZE) {
+        const uint8_t* r = base + offset;
+        OrbitPass p;
+        p.satellite = get<uint32_t>(r, 0);
+        uint32_t n = get<uint32_t>(r, 4);
+        p.pass.aos_unix = get<double>(r, 8);
+        p.pass.tca_unix = get<double>(r, 16);
+        p.pass.los_unix = get<double>(r, 24);
+        p.pass.max_elevation_deg = get<float>(r, 32);
+        p.aos_az_deg = get<float>(r, 36);
+        p.tca_az_deg = get<float>(r, 40);
+        p.los_az_deg = get<float>(r, 44);
+        p.tca_range_km = get<float>(r, 48);
+        double quantum = get<float>(r, 52);
+        int64_t q = get<int32_t>(r, 56);
+        if (series + series_bytes(n) > s.bytes) return false;
+        for (uint32_t k = 0; k < n; k++) {
+            if (k > 0) q += get<int16_t>(base, series + 2 * (n + k));
+            p.elevation_deg.push_back(get<int16_t>(base, series + 2 * k) / 100.0);
+            p.doppler_hz.push_back(q * quantum);
+        }
+        series += series_bytes(n);
+        passes.push_back(p);
+    }
+    return true;
+}
@@ -0,0 +1,128 @@
+/*
+ * orbit_data.h
+ * Satellite Ground Station - Compact Orbital Data for the HMI
+ *
+ * What generate_orbital_data.py writes as JSON (positions every step
+ * for a day ahead, passes with Doppler and elevation curves), in a form
+ * the browser can map onto typed arrays without parsing. Time is cut
+ * into segments on a fixed Unix-time grid, so a refresh keeps every
+ * segment it already has and only propagates new ones. Little-endian,
+ * every block a multiple of 8 bytes:
+ *
+ *   header  "SGOB" uint32 version, header_size (64), meta_bytes
+ *           float64 generated_unix, start_unix (first position sample),
+ *                   step_sec, doppler_step_sec, segment_sec
+ *           uint32 num_satellites, num_segments
+ *
+ *   meta    JSON, space-padded: ground station and, per satellite, the
+ *           catalog entry and its element set (name, norad_id, freq_hz,
+ *           color, role, epoch, inclination, period)
+ *
+ *   segment "SEGM" uint32 bytes (whole segment)
+ *           float64 start_unix, uint32 samples, passes, uint64 reserved
+ *     per satellite, samples positions at start + k * step:
+ *           int32 x0, y0, z0, dx, dy, dz, float32 quantum_m, reserved
+ *           int16 second differences, xyz interleaved (samples - 2)
+ *     per pass (AOS inside the segment), 64 bytes:
+ *           uint32 satellite, doppler_count
+ *           float64 aos_unix, tca_unix, los_unix
+ *           float32 max_el, aos_az, tca_az, los_az, tca_range_km,
+ *                   doppler_quantum_hz, int32 doppler_first, reserved
+ *     per pass with a downlink, doppler_count samples from AOS on:
+ *           int16 elevation (0.01 deg), int16 Doppler first differences
+ *
+ * Positions are earth-fixed, in whole multiples of quantum_m metres
+ * (one metre unless the step is long enough for the second differences
+ * to need more), so they decode exactly: x1 = x0 + dx, then
+ * x[k] = 2 x[k-1] - x[k-2] + d2. The Doppler curve decodes the same
+ * way at first order, from doppler_first.
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#ifndef SATGS_ORBIT_DATA_H
+#define SATGS_ORBIT_DATA_H
+
+#include "mapped_file.h"
+#include "orbit.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#define ORBIT_DATA_MAGIC        "SGOB"
+#define ORBIT_DATA_VERSION      1
+#define ORBIT_DATA_HEADER_SIZE  64
+#define ORBIT_SEGMENT_MAGIC     "SEGM"
+#define ORBIT_SEGMENT_SIZE      32
+#define ORBIT_TRACK_SIZE        32
+#define ORBIT_PASS_SIZE         64
+
+struct OrbitDataHeader {
+    uint32_t version = ORBIT_DATA_VERSION;
+    uint32_t meta_bytes = 0;
+    double generated_unix = 0.0;
+    double start_unix = 0.0;
+    double step_sec = 0.0;
+    double doppler_step_sec = 0.0;
+    double segment_sec = 0.0;
+    uint32_t num_satellites = 0;
+    uint32_t num_segments = 0;
+};
+
+struct OrbitPass {
+    uint32_t satellite = 0;             // Index into the meta satellites
+    SatellitePass pass{};
+    double aos_az_deg = 0.0;
+    double tca_az_deg = 0.0;
+    double los_az_deg = 0.0;
+    double tca_range_km = 0.0;
+    std::vector<double> elevation_deg;  // doppler_step apart from AOS (empty without a downlink)
+    std::vector<double> doppler_hz;
+};
+
+// Append one segment to out. tracks[s] holds 3 * samples earth-fixed
+// km for satellite s (samples >= 2); passes are those with AOS in it.
+void orbit_encode_segment(double start_unix, size_t samples, const std::vector<std::vector<double>>& tracks,
+                          const std::vector<OrbitPass>& passes, std::vector<uint8_t>& out);
+
+// Header, meta (padded here) and the encoded segments, through a
+// temporary file
+bool orbit_write_file(const std::string& filename, const OrbitDataHeader& header, const std::string& meta,
+                      const std::vector<std::vector<uint8_t>>& segments);
+
+class OrbitDataReader {
+public:
+    struct Segment {
+        size_t offset = 0;
+        uint32_t bytes = 0;
+        double start_unix = 0.0;
+        uint32_t samples = 0;
+        uint32_t passes = 0;
+    };
+
+    bool open(const std::string& filename);
+
+    const OrbitDataHeader& header() const { return header_; }
+    std::string_view meta() const { return meta_; }            // Padding included
+    const std::vector<Segment>& segments() const { return segments_; }
+
+    // Segment i as stored, for copying into a new file
+    const uint8_t* segment_data(size_t i) const;
+
+    // Satellite s's positions in segment i (3 * samples km)
+    bool decode_track(size_t segment, uint32_t satellite, std::vector<double>& xyz_km) const;
+    bool decode_passes(size_t segment, std::vector<OrbitPass>& passes) const;
+
+private:
+    MappedFile file_;
+    std::string filename_;
+    OrbitDataHeader header_;
+    std::string_view meta_;
+    std::vector<Segment> segments_;
+};
+
+#endif // SATGS_ORBIT_DATA_H
@@ -0,0 +1,222 @@
+/*
+ * pass_features.cpp
+ * Satellite Ground Station - Batch Pass Features for Scoring
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#include "pass_features.h"
+#include "pass_scheduler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+static const double kPi = 3.14159265358979323846;
+static const double kDeg2Rad = kPi / 180.0;
+static const double kRad2Deg = 180.0 / kPi;
+
+const PassFeatureColumn kPassFeatureColumns[] = {
+    {"aos_unix", &PassFeatureTable::aos_unix},
+    {"tca_unix", &PassFeatureTable::tca_unix},
+    {"los_unix", &PassFeatureTable::los_unix},
+    {"max_elevation_deg", &PassFeatureTable::max_elevation_deg},
+    {"duration_min", &PassFeatureTable::duration_min},
+    {"aos_hour_utc", &PassFeatureTable::aos_hour_utc},
+    {"aos_day_of_week", &PassFeatureTable::aos_day_of_week},
+    {"azimuth_range_deg", &PassFeatureTable::azimuth_range_deg},
+    {"is_morning_pass", &PassFeatureTable::is_morning_pass},
+    {"is_evening_pass", &PassFeatureTable::is_evening_pass},
+    {"aos_az_deg", &PassFeatureTable::aos_az_deg},
+    {"los_az_deg", &PassFeatureTable::los_az_deg},
+    {"tca_range_km", &PassFeatureTable::tca_range_km},
+    {"doppler_span_hz", &PassFeatureTable::doppler_span_hz},
+    {"doppler_rate_hz_s", &PassFeatureTable::doppler_rate_hz_s},
+    {"sun_elevation_deg", &PassFeatureTable::sun_elevation_deg},
+    {"subsat_sun_elevation_deg", &PassFeatureTable::subsat_sun_elevation_deg},
+};
+const size_t kPassFeatureColumnCount = sizeof(kPassFeatureColumns) / sizeof(kPassFeatureColumns[0]);
+
+void PassFeatureTable::clear() {
+    satellite.clear();
+    for (size_t i = 0; i < kPassFeatureColumnCount; i++) (this->*kPassFeatureColumns[i].column).clear();
+}
+
+void PassFeatureTable::append(const PassFeatureTable& other, size_t row) {
+    satellite.push_back(other.satellite[row]);
+    for (size_t i = 0; i < kPassFeatureColumnCount; i++) {
+        auto column = kPassFeatureColumns[i].column;
+        (this->*column).push_back((other.*column)[row]);
+    }
+}
+
+void sun_direction_ecef(double unix_sec, double out[3]) {
+    // Astronomical Almanac low-precision Sun: ecliptic longitude and
+    // obliquity from days since J2000
+    const double jd = unix_to_jd(unix_sec);
+    const double n = jd - 2451545.0;
+    const double mean_lon = (280.460 + 0.9856474 * n) * kDeg2Rad;
+    const double anomaly = (357.528 + 0.9856003 * n) * kDeg2Rad;
+    const double lambda = mean_lon + (1.915 * std::sin(anomaly) + 0.020 * std::sin(2.0 * anomaly)) * kDeg2Rad;
+    const double eps = (23.439 - 0.0000004 * n) * kDeg2Rad;
+
+    const double x = std::cos(lambda);
+    const double y = std::cos(eps) * std::sin(lambda);
+    const double theta = gmst_rad(jd);
+    out[0] = std::cos(theta) * x + std::sin(theta) * y;
+    out[1] = -std::sin(theta) * x + std::cos(theta) * y;
+    out[2] = std::sin(eps) * std::sin(lambda);
+}
+
+static bool same_elements(const Tle& a, const Tle& b) {
+    return a.satnum == b.satnum && a.epoch_jd == b.epoch_jd && a.bstar == b.bstar && a.inclo == b.inclo &&
+           a.nodeo == b.nodeo && a.ecco == b.ecco && a.argpo == b.argpo && a.mo == b.mo &&
+           a.no_kozai == b.no_kozai && a.ndot == b.ndot && a.nddot == b.nddot;
+}
+
+// ----------------------------------------------------------------------------
+// PassFeatureCache
+// ----------------------------------------------------------------------------
+
+bool PassFeatureCache::set_tle(const Tle& tle) {
+    auto it = entries_.find(tle.name);
+    if (it != entries_.end() && same_elements(it->second.tle, tle)) return false;
+
+    Entry& entry = entries_[tle.name];
+    entry.tle = tle;
+    entry.valid = entry.predictor.init(tle, station_);
+    entry.searched_from = entry.searched_to = entry.last_los = 0.0;
+    entry.rows.clear();
+    return entry.valid;
+}
+
+bool PassFeatureCache::remove(const std::string& name) {
+    return entries_.erase(name) > 0;
+}
+
+size_t PassFeatureCache::update(double start_unix, double span_sec) {
+    const double end = start_unix + span_sec;
+    size_t propagated = 0;
+
+    names_.clear();
+    std::vector<std::pair<double, std::pair<int, size_t>>> order;    // AOS, (satellite, row)
+    for (auto& item : entries_) {
+        Entry& entry = item.second;
+        const int index = static_cast<int>(names_.size());
+        names_.push_back(item.first);
+        if (!entry.valid) continue;
+
+        if (start_unix < entry.searched_from || start_unix > entry.searched_to) {
+            // Nothing cached covers the new start
+            entry.rows.clear();
+            entry.searched_from = entry.searched_to = start_unix;
+            entry.last_los = 0.0;
+        } else if (start_unix > entry.searched_from) {
+            PassFeatureTable kept;
+            for (size_t r = 0; r < entry.rows.size(); r++) {
+                if (entry.rows.aos_unix[r] > start_unix) kept.append(entry.rows, r);
+            }
+            entry.rows = std::move(kept);
+            entry.searched_from = start_unix;
+        }
+        if (end > entry.searched_to) {
+            extend(entry, end);
+            propagated++;
+        }
+
+        for (size_t r = 0; r < entry.rows.size(); r++) {
+            entry.rows.satellite[r] = index;
+            if (entry.rows.aos_unix[r] < end) order.push_back({entry.rows.aos_unix[r], {index, r}});
+        }
+    }
+
+    std::sort(order.begin(), order.end());
+    table_.clear();
+    for (const auto& o : order) {
+        table_.append(entries_[names_[o.second.first]].rows, o.second.second);
+    }
+    return propagated;
+}
+
+// Search from where the cached passes stop to `to`, and far enough past
+// it that a pass rising just before `to` is found whole
+void PassFeatureCache::extend(Entry& entry, double to) const {
+    double resume = entry.searched_to;
+    if (entry.last_los > 0.0) resume = std::max(resume, entry.last_los + PASS_SEARCH_STEP_SEC);
+
+    std::vector<SatellitePass> found;
+    if (resume < to) entry.predictor.find_passes(resume, to + FEATURE_PASS_MAX_SEC - resume, found);
+    for (const SatellitePass& pass : found) {
+        // A pass in progress at the search start reports AOS = start
+        if (pass.aos_unix <= resume || pass.aos_unix >= to) continue;
+        add_row(entry, pass, entry.rows);
+        entry.last_los = pass.los_unix;
+    }
+    entry.searched_to = to;
+}
+
+void PassFeatureCache::add_row(const Entry& entry, const SatellitePass& pass, PassFeatureTable& rows) const {
+    const PassPredictor& predictor = entry.predictor;
+    const double freq_hz = downlink_freq_hz(entry.tle.name, station_.primary_freq_hz);
+
+    const double times[5] = {pass.aos_unix, pass.tca_unix, pass.los_unix,
+                             pass.tca_unix - FEATURE_RATE_DT_SEC, pass.tca_unix + FEATURE_RATE_DT_SEC};
+    LookAngles looks[5] = {};
+    for (int i = 0; i < 5; i++) predictor.look(times[i], looks[i]);
+    double sat[3] = {0.0, 0.0, 0.0};
+    predictor.position_batch(pass.tca_unix, 1.0, 1, sat);
+
+    // As extract_orbital_features: hours and whole minutes of AOS
+    double day_sec = std::fmod(pass.aos_unix, 86400.0);
+    if (day_sec < 0.0) day_sec += 86400.0;
+    const double aos_hour = std::floor(day_sec / 60.0) / 60.0;
+    const double day = std::floor(pass.aos_unix / 86400.0);  // 1970-01-01 was a Thursday
+    double az_range = std::abs(looks[2].azimuth_deg - looks[0].azimuth_deg);
+    if (az_range > 180.0) az_range = 360.0 - az_range;
+
+    double sun[3];
+    sun_direction_ecef(pass.tca_unix, sun);
+    const double lat = station_.lat_deg * kDeg2Rad, lon = station_.lon_deg * kDeg2Rad;
+    const double up[3] = {std::cos(lat) * std::cos(lon), std::cos(lat) * std::sin(lon), std::sin(lat)};
+    const double sat_r = std::sqrt(sat[0] * sat[0] + sat[1] * sat[1] + sat[2] * sat[2]);
+    auto elevation = [&](const double* dir, double norm) {
+        double d = (dir[0] * sun[0] + dir[1] * sun[1] + dir[2] * sun[2]) / norm;
+        return std::asin(std::max(-1.0, std::min(1.0, d))) * kRad2Deg;
+    };
+
+    rows.satellite.push_back(-1);
+    rows.aos_unix.push_back(pass.aos_unix);
+    rows.tca_unix.push_back(pass.tca_unix);
+    rows.los_unix.push_back(pass.los_unix);
+    rows.max_elevation_deg.push_back(pass.max_elevation_deg);
+    rows.duration_min.push_back((pass.los_unix - pass.aos_unix) / 60.0);
+    rows.aos_hour_utc.push_back(aos_hour);
+    rows.aos_day_of_week.push_back(std::fmod(day + 3.0, 7.0));
+    rows.azimuth_range_deg.push_back(az_range);
+    rows.is_morning_pass.push_back(aos_hour >= 4.0 && aos_hour < 12.0 ? 1.0 : 0.0);
+    rows.is_evening_pass.push_back(aos_hour >= 17.0 && aos_hour < 22.0 ? 1.0 : 0.0);
+    rows.aos_az_deg.push_back(looks[0].azimuth_deg);
+    rows.los_az_deg.push_back(looks[2].azimuth_deg);
+    rows.tca_range_km.push_back(looks[1].range_km);
+    rows.doppler_span_hz.push_back(PassPredictor::doppler_hz(looks[0], freq_hz) -
+                                   PassPredictor::doppler_hz(looks[2], freq_hz));
+    rows.doppler_rate_hz_s.push_back((PassPredictor::doppler_hz(looks[4], freq_hz) -
+                                      PassPredictor::doppler_hz(looks[3], freq_hz)) / (2.0 * FEATURE_RATE_DT_SEC));
+    rows.sun_elevation_deg.push_back(elevation(up, 1.0));
+    rows.subsat_sun_elevation_deg.push_back(sat_r > 0.0 ? elevation(sat, sat_r) : 0.0);
+}
+
+void PassFeatureCache::score(double cloud_cover_pct, double precipitation_prob,
+                             const std::vector<double>& recent_aos_unix, std::vector<double>& out) const {
+    const double weather = score_weather(cloud_cover_pct, precipitation_prob);
+    out.resize(table_.size());
+    for (size_t r = 0; r < table_.size(); r++) {
+        SatellitePass pass;
+        pass.aos_unix = table_.aos_unix[r];
+        pass.los_unix = table_.los_unix[r];
+        pass.tca_unix = table_.tca_unix[r];
+        pass.max_elevation_deg = table_.max_elevation_deg[r];
+        out[r] = score_pass(pass, recent_aos_unix, weather);
+    }
+}
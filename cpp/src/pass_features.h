@@ -0,0 +1,125 @@
+/*
+ * pass_features.h
+ * Satellite Ground Station - Batch Pass Features for Scoring
+ *
+ * The orbital features feature_engineering.py derives for each pass
+ * (elevation, duration, AOS time of day, azimuth sweep), plus the
+ * geometric and RF ones that need the propagator (range at TCA, Doppler
+ * span and peak rate, sun elevation at the station and under the
+ * satellite), computed straight from SGP4 for every satellite over a
+ * horizon and returned as one column per feature.
+ *
+ * Passes are cached per satellite against its element set. An update
+ * propagates only satellites whose elements changed and the part of the
+ * horizon not searched yet; rescoring with a new forecast or capture
+ * history runs over the cached columns without propagating anything.
+ *
+ * satgs_features (satgs_features_py.cpp) exposes this to Python.
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#ifndef SATGS_PASS_FEATURES_H
+#define SATGS_PASS_FEATURES_H
+
+#include "orbit.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+#define FEATURE_PASS_MAX_SEC    1800.0  // Longer than any LEO pass over the mask
+#define FEATURE_RATE_DT_SEC     1.0     // Half-width of the Doppler rate difference at TCA
+
+// One column per feature, one row per pass, in AOS order
+struct PassFeatureTable {
+    std::vector<int> satellite;                 // Index into PassFeatureCache::satellites()
+    std::vector<double> aos_unix;
+    std::vector<double> tca_unix;
+    std::vector<double> los_unix;
+
+    // feature_engineering.extract_orbital_features
+    std::vector<double> max_elevation_deg;
+    std::vector<double> duration_min;
+    std::vector<double> aos_hour_utc;
+    std::vector<double> aos_day_of_week;        // Monday = 0
+    std::vector<double> azimuth_range_deg;
+    std::vector<double> is_morning_pass;
+    std::vector<double> is_evening_pass;
+
+    // From the propagator
+    std::vector<double> aos_az_deg;
+    std::vector<double> los_az_deg;
+    std::vector<double> tca_range_km;
+    std::vector<double> doppler_span_hz;        // AOS shift minus LOS shift
+    std::vector<double> doppler_rate_hz_s;      // Peak rate, at TCA (negative)
+    std::vector<double> sun_elevation_deg;      // At the station, at TCA
+    std::vector<double> subsat_sun_elevation_deg;   // Under the satellite at TCA (> 0: lit image)
+
+    size_t size() const { return aos_unix.size(); }
+    void clear();
+    void append(const PassFeatureTable& other, size_t row);
+};
+
+// Name and column of every double feature, for bindings that hand the
+// table out generically
+struct PassFeatureColumn {
+    const char* name;
+    std::vector<double> PassFeatureTable::* column;
+};
+extern const PassFeatureColumn kPassFeatureColumns[];
+extern const size_t kPassFeatureColumnCount;
+
+// Sun direction as an earth-fixed unit vector (low-precision solar
+// ephemeris, ~0.01 deg, same GMST-only rotation as the propagator)
+void sun_direction_ecef(double unix_sec, double out[3]);
+
+class PassFeatureCache {
+public:
+    explicit PassFeatureCache(const GroundStation& station) : station_(station) {}
+
+    // Add or replace a satellite's elements. Returns true when they differ
+    // from the cached ones (its passes are recomputed on the next update),
+    // false when unchanged or unusable.
+    bool set_tle(const Tle& tle);
+    bool remove(const std::string& name);
+
+    // Passes over [start_unix, start_unix + span_sec) for every satellite,
+    // propagating only what the cache lacks. A pass already in progress
+    // at start_unix is left out. Returns the satellites that needed
+    // propagation; satellites whose elements SGP4 rejects have no passes.
+    size_t update(double start_unix, double span_sec);
+
+    // Rows of the last update, AOS order
+    const PassFeatureTable& table() const { return table_; }
+    const std::vector<std::string>& satellites() const { return names_; }
+
+    // pass_scorer.score_pass for every row: forecast (NaN = unknown) and
+    // recent capture AOS times (newest last)
+    void score(double cloud_cover_pct, double precipitation_prob, const std::vector<double>& recent_aos_unix,
+               std::vector<double>& out) const;
+
+    const GroundStation& station() const { return station_; }
+
+private:
+    struct Entry {
+        Tle tle;
+        PassPredictor predictor;
+        bool valid = false;
+        double searched_from = 0.0;     // Rows hold every pass with AOS in [from, to)
+        double searched_to = 0.0;
+        double last_los = 0.0;          // Of the latest pass found
+        PassFeatureTable rows;
+    };
+
+    void extend(Entry& entry, double to) const;
+    void add_row(const Entry& entry, const SatellitePass& pass, PassFeatureTable& rows) const;
+
+    GroundStation station_;
+    std::map<std::string, Entry> entries_;
+    std::vector<std::string> names_;    // Satellite index -> name, table_ order
+    PassFeatureTable table_;
+};
+
+#endif // SATGS_PASS_FEATURES_H
@@ -0,0 +1,175 @@
+/*
+ * pass_scheduler.cpp
+ * Satellite Ground Station - Pass Scoring and Device Assignment
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#include "pass_scheduler.h"
+
+#include <algorithm>
+#include <cmath>
+
+// ----------------------------------------------------------------------------
+// Scoring
+// ----------------------------------------------------------------------------
+
+static double utc_hour(double unix_sec) {
+    double day = std::fmod(unix_sec, 86400.0);
+    if (day < 0.0) day += 86400.0;
+    return day / 3600.0;
+}
+
+double score_weather(double cloud_cover_pct, double precipitation_prob) {
+    if (std::isnan(cloud_cover_pct) && std::isnan(precipitation_prob)) return SCORE_WEATHER_UNKNOWN;
+
+    double score = 1.0;
+    if (cloud_cover_pct > SCORE_CLOUD_THRESHOLD) score -= 0.2;
+    else if (cloud_cover_pct > 50.0) score -= 0.1;
+
+    if (precipitation_prob > 0.7) score -= 0.4;
+    else if (precipitation_prob > 0.4) score -= 0.2;
+    else if (precipitation_prob > 0.2) score -= 0.1;
+    return std::max(0.0, score);
+}
+
+double score_pass(const SatellitePass& pass, const std::vector<double>& recent_aos_unix, double weather) {
+    double elevation = 0.0;
+    if (pass.max_elevation_deg >= 90.0) {
+        elevation = 1.0;
+    } else if (pass.max_elevation_deg >= SCORE_MIN_ELEVATION_DEG) {
+        elevation = (pass.max_elevation_deg - SCORE_MIN_ELEVATION_DEG) / (90.0 - SCORE_MIN_ELEVATION_DEG);
+    }
+
+    double duration_min = (pass.los_unix - pass.aos_unix) / 60.0;
+    double duration = 0.2;
+    if (duration_min >= SCORE_MAX_DURATION_MIN) {
+        duration = 1.0;
+    } else if (duration_min >= SCORE_MIN_DURATION_MIN) {
+        duration = (duration_min - SCORE_MIN_DURATION_MIN) / (SCORE_MAX_DURATION_MIN - SCORE_MIN_DURATION_MIN);
+    }
+
+    // Oldest of the last few first, as score_time_diversity walks them;
+    // the recent side is compared by whole hour
+    double diversity = recent_aos_unix.empty() ? 0.8 : 1.0;
+    size_t first = recent_aos_unix.size() > SCORE_DIVERSITY_HISTORY
+                 ? recent_aos_unix.size() - SCORE_DIVERSITY_HISTORY : 0;
+    double hour = utc_hour(pass.aos_unix);
+    for (size_t i = first; i < recent_aos_unix.size(); i++) {
+        double diff = std::abs(hour - std::floor(utc_hour(recent_aos_unix[i])));
+        if (diff > 12.0) diff = 24.0 - diff;
+        if (diff < 2.0) {
+            diversity = 0.4;
+            break;
+        }
+        if (diff < 4.0) {
+            diversity = 0.7;
+            break;
+        }
+    }
+
+    return SCORE_WEIGHT_ELEVATION * elevation + SCORE_WEIGHT_DURATION * duration +
+           SCORE_WEIGHT_WEATHER * weather + SCORE_WEIGHT_DIVERSITY * diversity;
+}
+
+// ----------------------------------------------------------------------------
+// PassPlanner
+// ----------------------------------------------------------------------------
+
+PassPlanner::PassPlanner(const std::vector<SchedulerDevice>& devices, const GroundStation& station,
+                         double warmup_sec, double half_band_hz)
+    : devices_(devices), station_(station), warmup_sec_(warmup_sec), half_band_hz_(half_band_hz),
+      reserved_(devices.size()) {}
+
+void PassPlanner::reserve(const Booking& booking) {
+    if (booking.device < 0 || booking.device >= static_cast<int>(devices_.size())) return;
+    reserved_[booking.device].push_back({booking.warm_unix, booking.stop_unix + SCHED_TURNAROUND_SEC});
+}
+
+void PassPlanner::window(const PassCandidate& c, double& warm, double& start, double& stop) const {
+    start = c.pass.aos_unix - station_.pre_aos_margin_sec;
+    stop = c.pass.los_unix + station_.post_los_margin_sec;
+    warm = start - warmup_sec_;
+}
+
+bool PassPlanner::device_free(int device, double begin, double end, const Booking* ignore) const {
+    for (const Interval& busy : reserved_[device]) {
+        if (begin < busy.end && busy.begin < end) return false;
+    }
+    for (const Booking& b : bookings_) {
+        if (&b == ignore || b.device != device) continue;
+        if (begin < b.stop_unix + SCHED_TURNAROUND_SEC && b.warm_unix < end) return false;
+    }
+    return true;
+}
+
+bool PassPlanner::fits_band(const Booking& booking, const PassCandidate& c, double& center) const {
+    double lo = c.freq_hz, hi = c.freq_hz;
+    for (const PassCandidate& p : booking.passes) {
+        if (p.freq_hz == c.freq_hz) return false;   // One channel per carrier
+        lo = std::min(lo, p.freq_hz);
+        hi = std::max(hi, p.freq_hz);
+    }
+    center = std::round(0.5 * (lo + hi));
+    return hi - center <= half_band_hz_ && center - lo <= half_band_hz_;
+}
+
+std::vector<Booking> PassPlanner::plan(std::vector<PassCandidate> candidates,
+                                       std::vector<PassCandidate>* skipped) {
+    bookings_.clear();
+    std::stable_sort(candidates.begin(), candidates.end(), [](const PassCandidate& a, const PassCandidate& b) {
+        if (a.score != b.score) return a.score > b.score;
+        return a.pass.aos_unix < b.pass.aos_unix;
+    });
+
+    for (const PassCandidate& c : candidates) {
+        double warm, start, stop;
+        window(c, warm, start, stop);
+
+        bool placed = false;
+        for (int d = 0; d < static_cast<int>(devices_.size()) && !placed; d++) {
+            if (!device_free(d, warm, stop + SCHED_TURNAROUND_SEC, nullptr)) continue;
+            Booking b;
+            b.device = d;
+            b.warm_unix = warm;
+            b.start_unix = start;
+            b.stop_unix = stop;
+            b.center_hz = c.freq_hz;
+            b.passes.push_back(c);
+            bookings_.push_back(b);
+            placed = true;
+        }
+
+        // No idle device: share one that is already streaming then
+        for (size_t i = 0; i < bookings_.size() && !placed; i++) {
+            Booking& b = bookings_[i];
+            double center;
+            if (start >= b.stop_unix || b.start_unix >= stop) continue;
+            if (static_cast<int>(b.passes.size()) >= devices_[b.device].channel_slots) continue;
+            if (!fits_band(b, c, center)) continue;
+            double merged_warm = std::min(b.warm_unix, warm);
+            double merged_stop = std::max(b.stop_unix, stop);
+            if (!device_free(b.device, merged_warm, merged_stop + SCHED_TURNAROUND_SEC, &b)) continue;
+            b.warm_unix = merged_warm;
+            b.start_unix = std::min(b.start_unix, start);
+            b.stop_unix = merged_stop;
+            b.center_hz = center;
+            b.passes.push_back(c);
+            placed = true;
+        }
+
+        if (!placed && skipped) skipped->push_back(c);
+    }
+
+    std::vector<Booking> result = bookings_;
+    std::sort(result.begin(), result.end(), [](const Booking& a, const Booking& b) {
+        return a.warm_unix < b.warm_unix;
+    });
+    if (skipped) {
+        std::sort(skipped->begin(), skipped->end(), [](const PassCandidate& a, const PassCandidate& b) {
+            return a.pass.aos_unix < b.pass.aos_unix;
+        });
+    }
+    return result;
+}
@@ -0,0 +1,109 @@
+/*
+ * pass_scheduler.h
+ * Satellite Ground Station - Pass Scoring and Device Assignment
+ *
+ * Turns a list of predicted passes into bookings: one capture session
+ * per device and time window. A device is a sample source with a
+ * number of channelizer slots, so passes that overlap in time can share
+ * a dongle when all their carriers fit in its band (e.g. NOAA 15 and 18,
+ * 290 kHz apart), or go to another dongle when one is free.
+ *
+ * Passes are placed in score order (the pass_scorer.py rules), so when
+ * devices or slots run out it is the low, short passes that are left
+ * over. Each placement prefers an idle device and falls back to a free
+ * slot in an overlapping booking, whose window then grows to cover both.
+ *
+ * No SDR dependency: satgs_scheduler executes the bookings.
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#ifndef SATGS_PASS_SCHEDULER_H
+#define SATGS_PASS_SCHEDULER_H
+
+#include "orbit.h"
+
+#include <string>
+#include <vector>
+
+// pass_scorer.py weights and thresholds
+#define SCORE_WEIGHT_ELEVATION  0.50
+#define SCORE_WEIGHT_DURATION   0.20
+#define SCORE_WEIGHT_WEATHER    0.20
+#define SCORE_WEIGHT_DIVERSITY  0.10
+#define SCORE_MIN_ELEVATION_DEG 15.0
+#define SCORE_MIN_DURATION_MIN  5.0
+#define SCORE_MAX_DURATION_MIN  15.0
+#define SCORE_WEATHER_UNKNOWN   0.6     // No forecast here
+#define SCORE_CLOUD_THRESHOLD   80.0    // Cloud cover (%) with the larger penalty
+#define SCORE_DIVERSITY_HISTORY 5       // Recent captures compared by AOS hour
+
+#define SCHED_DEFAULT_SLOTS     3       // Carriers one session may demodulate
+#define SCHED_TURNAROUND_SEC    10.0    // Between a session's end and the next warm-up
+
+struct PassCandidate {
+    std::string satellite;
+    double freq_hz = 0.0;
+    SatellitePass pass{};
+    double score = 0.0;
+    int source = -1;                    // Caller's index (predictor, pass file entry)
+};
+
+// pass_scorer.score_weather; NaN for a quantity with no forecast
+double score_weather(double cloud_cover_pct, double precipitation_prob);
+
+// pass_scorer.score_pass: elevation, duration, the weather score and
+// the AOS hour against recent captures (Unix AOS times, newest last)
+double score_pass(const SatellitePass& pass, const std::vector<double>& recent_aos_unix,
+                  double weather = SCORE_WEATHER_UNKNOWN);
+
+struct SchedulerDevice {
+    std::string source;                 // Sample source spec (sample_source.h)
+    int channel_slots = SCHED_DEFAULT_SLOTS;
+};
+
+// One capture session on one device
+struct Booking {
+    int device = -1;
+    double warm_unix = 0.0;             // Open and calibrate
+    double start_unix = 0.0;            // Start streaming (first AOS - pre margin)
+    double stop_unix = 0.0;             // Last LOS + post margin
+    double center_hz = 0.0;             // Tuner frequency
+    std::vector<PassCandidate> passes;  // passes[0] is the primary channel
+};
+
+class PassPlanner {
+public:
+    // half_band_hz: how far from the tuner a carrier's channel may sit
+    // (sample_rate / 2 - channel bandwidth, as rtlsdr_capture --offset)
+    PassPlanner(const std::vector<SchedulerDevice>& devices, const GroundStation& station,
+                double warmup_sec, double half_band_hz);
+
+    // Keep a device busy for a booking already open or streaming; it
+    // takes no further passes
+    void reserve(const Booking& booking);
+
+    // Place candidates best score first. Bookings come back ordered by
+    // warm-up time; passes that found no room go to skipped.
+    std::vector<Booking> plan(std::vector<PassCandidate> candidates, std::vector<PassCandidate>* skipped);
+
+private:
+    struct Interval {
+        double begin;
+        double end;
+    };
+
+    void window(const PassCandidate& c, double& warm, double& start, double& stop) const;
+    bool device_free(int device, double begin, double end, const Booking* ignore) const;
+    bool fits_band(const Booking& booking, const PassCandidate& c, double& center) const;
+
+    std::vector<SchedulerDevice> devices_;
+    GroundStation station_;
+    double warmup_sec_;
+    double half_band_hz_;
+    std::vector<std::vector<Interval>> reserved_;   // Per device
+    std::vector<Booking> bookings_;
+};
+
+#endif // SATGS_PASS_SCHEDULER_H
@@ -0,0 +1,104 @@
+/*
+ * png_writer.cpp
+ * Satellite Ground Station - Minimal PNG Writer
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#include "png_writer.h"
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <vector>
+
+#define DEFLATE_STORED_MAX 65535    // Largest stored block payload
+
+static uint32_t crc32_update(uint32_t crc, const uint8_t* data, size_t n) {
+    // Built once, thread-safely, on first use
+    static const std::array<uint32_t, 256> table = []() {
+        std::array<uint32_t, 256> t;
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[i] = c;
+        }
+        return t;
+    }();
+    crc = ~crc;
+    for (size_t i = 0; i < n; i++) crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    return ~crc;
+}
+
+static void put_be32(std::vector<uint8_t>& out, uint32_t v) {
+    out.push_back(static_cast<uint8_t>(v >> 24));
+    out.push_back(static_cast<uint8_t>(v >> 16));
+    out.push_back(static_cast<uint8_t>(v >> 8));
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+static void put_chunk(std::vector<uint8_t>& out, const char* type, const std::vector<uint8_t>& body) {
+    put_be32(out, static_cast<uint32_t>(body.size()));
+    size_t type_at = out.size();
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), body.begin(), body.end());
+    put_be32(out, crc32_update(0, &out[type_at], 4 + body.size()));
+}
+
+bool write_png_gray8(const std::string& path, const uint8_t* pixels, uint32_t width, uint32_t height) {
+    if (width == 0 || height == 0) return false;
+
+    std::vector<uint8_t> ihdr;
+    put_be32(ihdr, width);
+    put_be32(ihdr, height);
+    ihdr.push_back(8);      // Bit depth
+    ihdr.push_back(0);      // Grayscale
+    ihdr.push_back(0);      // Deflate
+    ihdr.push_back(0);      // Adaptive filtering (every row uses filter 0)
+    ihdr.push_back(0);      // No interlace
+
+    // Filtered scanlines: a 0 filter byte before each row
+    size_t row_bytes = static_cast<size_t>(width) + 1;
+    std::vector<uint8_t> raw(row_bytes * height);
+    for (uint32_t y = 0; y < height; y++) {
+        raw[y * row_bytes] = 0;
+        std::copy(pixels + static_cast<size_t>(y) * width, pixels + static_cast<size_t>(y + 1) * width,
+                  raw.begin() + y * row_bytes + 1);
+    }
+
+    // zlib stream of stored blocks
+    std::vector<uint8_t> idat;
+    idat.reserve(raw.size() + raw.size() / DEFLATE_STORED_MAX * 5 + 16);
+    idat.push_back(0x78);
+    idat.push_back(0x01);
+    uint32_t adler_a = 1, adler_b = 0;
+    for (size_t pos = 0; pos < raw.size(); ) {
+        size_t len = std::min<size_t>(DEFLATE_STORED_MAX, raw.size() - pos);
+        bool last = pos + len == raw.size();
+        idat.push_back(last ? 1 : 0);
+        idat.push_back(static_cast<uint8_t>(len));
+        idat.push_back(static_cast<uint8_t>(len >> 8));
+        idat.push_back(static_cast<uint8_t>(~len));
+        idat.push_back(static_cast<uint8_t>(~len >> 8));
+        for (size_t i = pos; i < pos + len; i++) {
+            adler_a = (adler_a + raw[i]) % 65521;
+            adler_b = (adler_b + adler_a) % 65521;
+        }
+        idat.insert(idat.end(), raw.begin() + pos, raw.begin() + pos + len);
+        pos += len;
+    }
+    put_be32(idat, (adler_b << 16) | adler_a);
+
+    static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+    std::vector<uint8_t> png(signature, signature + 8);
+    put_chunk(png, "IHDR", ihdr);
+    put_chunk(png, "IDAT", idat);
+    put_chunk(png, "IEND", std::vector<uint8_t>());
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) return false;
+    file.write(reinterpret_cast<const char*>(png.data()), static_cast<std::streamsize>(png.size()));
+    file.close();
+    return !file.fail();
+}
@@ -0,0 +1,23 @@
+/*
+ * png_writer.h
+ * Satellite Ground Station - Minimal PNG Writer
+ *
+ * 8-bit grayscale PNG with no zlib dependency: image rows go out as
+ * stored (uncompressed) deflate blocks, which every PNG reader accepts.
+ * Files are about the size of the raw pixels, which is fine for APT
+ * images (2080 x ~1800 per pass).
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#ifndef SATGS_PNG_WRITER_H
+#define SATGS_PNG_WRITER_H
+
+#include <cstdint>
+#include <string>
+
+// pixels is height rows of width bytes, top row first
+bool write_png_gray8(const std::string& path, const uint8_t* pixels, uint32_t width, uint32_t height);
+
+#endif // SATGS_PNG_WRITER_H
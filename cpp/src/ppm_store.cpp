@@ -0,0 +1,110 @@
+/*
+ * ppm_store.cpp
+ * Satellite Ground Station - Per-device Tuner Frequency Error
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#include "ppm_store.h"
+#include "json_reader.h"
+#include "mapped_file.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <sys/stat.h>
+
+bool PpmStore::load(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    path_ = path;
+    entries_.clear();
+
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) return true;   // First run
+    MappedFile file;
+    if (!file.open(path)) {
+        std::cerr << "Error: Cannot read ppm store: " << path << std::endl;
+        return false;
+    }
+    if (file.size() == 0) return true;
+
+    JsonReader json(file.data(), file.size());
+    std::string_view device;
+    json.begin_object();
+    while (json.next_key(device)) {
+        Entry entry;
+        std::string_view key;
+        json.begin_object();
+        while (json.next_key(key)) {
+            double value = 0.0;
+            if (key == "ppm") {
+                json.read_number(entry.ppm);
+            } else if (key == "passes") {
+                json.read_number(value);
+                entry.passes = static_cast<int>(value);
+            } else if (key == "updated_utc") {
+                json.read_number(entry.updated_utc);
+            } else {
+                json.skip_value();
+            }
+        }
+        if (entry.passes > 0 && std::abs(entry.ppm) <= PPM_STORE_MAX) {
+            entries_[std::string(device)] = entry;
+        }
+    }
+    if (!json.ok()) {
+        std::cerr << "Error: Malformed ppm store JSON at byte " << json.error_offset() << ": " << path
+                  << std::endl;
+        entries_.clear();
+        return false;
+    }
+    return true;
+}
+
+bool PpmStore::save() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (path_.empty()) return false;
+    std::string tmp = path_ + ".tmp";
+    FILE* f = std::fopen(tmp.c_str(), "w");
+    if (!f) {
+        std::cerr << "Error: Cannot write ppm store: " << path_ << std::endl;
+        return false;
+    }
+    std::fprintf(f, "{");
+    bool first = true;
+    for (const auto& item : entries_) {
+        std::fprintf(f, "%s\n  \"%s\": {\"ppm\": %.3f, \"passes\": %d, \"updated_utc\": %.0f}",
+                     first ? "" : ",", item.first.c_str(), item.second.ppm, item.second.passes,
+                     item.second.updated_utc);
+        first = false;
+    }
+    std::fprintf(f, entries_.empty() ? "}\n" : "\n}\n");
+
+    bool ok = !std::ferror(f);
+    ok = (std::fclose(f) == 0) && ok;
+    if (!ok || std::rename(tmp.c_str(), path_.c_str()) != 0) {
+        std::cerr << "Error: Failed writing ppm store: " << path_ << std::endl;
+        std::remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool PpmStore::lookup(const std::string& device, double& ppm) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(device);
+    if (it == entries_.end()) return false;
+    ppm = it->second.ppm;
+    return true;
+}
+
+double PpmStore::update(const std::string& device, double ppm, double utc) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Entry& entry = entries_[device];
+    entry.passes = std::min(entry.passes + 1, PPM_STORE_HISTORY);
+    entry.ppm += (ppm - entry.ppm) / entry.passes;
+    entry.updated_utc = utc;
+    return entry.ppm;
+}
@@ -0,0 +1,61 @@
+/*
+ * ppm_store.h
+ * Satellite Ground Station - Per-device Tuner Frequency Error
+ *
+ * What the carrier loop learns about each dongle's crystal, kept across
+ * passes so the next capture starts corrected. A small JSON file keyed
+ * by SampleSource::device_id():
+ *
+ *   {
+ *     "rtlsdr:00000001": {"ppm": 1.84, "passes": 6, "updated_utc": 1771000000},
+ *     ...
+ *   }
+ *
+ * ppm follows rtl_sdr -p: positive when the tuner runs fast, so carriers
+ * land ppm * 1e-6 * tuner frequency below where they should. Each pass
+ * moves the stored value toward its own estimate by 1/passes, up to
+ * PPM_STORE_HISTORY passes, which averages out TLE-driven bias.
+ * Sessions in one process may share a store.
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#ifndef SATGS_PPM_STORE_H
+#define SATGS_PPM_STORE_H
+
+#include <map>
+#include <mutex>
+#include <string>
+
+#define PPM_STORE_HISTORY   8       // Passes in the running average
+#define PPM_STORE_MAX       200.0   // Anything larger is not a crystal error
+
+class PpmStore {
+public:
+    // A missing file is an empty store; false on unreadable or malformed
+    bool load(const std::string& path);
+
+    // Write back to the loaded path (atomically via a temporary file)
+    bool save() const;
+
+    bool lookup(const std::string& device, double& ppm) const;
+
+    // Fold one pass's estimate in; returns the new stored value
+    double update(const std::string& device, double ppm, double utc);
+
+    const std::string& path() const { return path_; }
+
+private:
+    struct Entry {
+        double ppm = 0.0;
+        int passes = 0;
+        double updated_utc = 0.0;
+    };
+
+    std::string path_;
+    mutable std::mutex mutex_;
+    std::map<std::string, Entry> entries_;
+};
+
+#endif // SATGS_PPM_STORE_H
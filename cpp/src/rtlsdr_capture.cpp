@@ -4,74 +4,65 @@
  *
  * High-performance capture with:
  * - Asynchronous I/Q streaming
- * - Ring buffer to prevent drops
- * - Binary output for maximum throughput
+ * - Preallocated slab pool with lock-free SPSC ring (no allocation
+ *   or locking on the libusb callback thread)
+ * - Binary output for maximum throughput, with selectable writer
+ *   backends (ofstream, O_DIRECT, io_uring) and file preallocation
+ * - Prometheus metrics endpoint (--metrics) for unattended runs
+ * - Real-time setup (--realtime, --pin): SCHED_FIFO for the USB reader
+ *   and the disk writer, the slab pool locked in RAM, the capture
+ *   threads on chosen cores with the progress reporter kept off them
+ * - Optional in-process FM demodulation to a 20800 Hz WAV stream,
+ *   written next to or instead of the raw I/Q, and live APT decoding
+ *   of that audio to a PNG that fills in during the pass
+ * - Wideband multi-channel mode (--channel): further carriers in the
+ *   captured band channelized out of the same stream, each with its own
+ *   NCO, Doppler profile, WAV and live image
+ * - Live waterfall (--waterfall): averaged spectrum rows from a
+ *   rate-limited side tap, in shared memory for satcom_server.py
+ * - Closed-loop carrier tracking (--track-carrier): an FLL on top of
+ *   the Doppler profile, and the tuner's ppm error learned per dongle
+ *   (--ppm-store) so the next pass starts corrected
+ * - Graceful degradation (--shed-load): a host that falls behind drops
+ *   the waterfall, then the raw I/Q (optionally decimated first), then
+ *   the further channels, before the primary image loses a line
+ *
+ * The device, pool and threads live in a CaptureSession; capture_daemon
+ * runs several of them in one process. --source swaps the dongle for a
+ * replayed capture or a generated APT signal (sample_source.h), so the
+ * whole chain can run without hardware, in real time or faster.
  *
  * Author: Luke Waszyn
  * Date: February 2026
  */
 
-#include <rtl-sdr.h>
 #include <iostream>
-#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <string>
 #include <vector>
-#include <queue>
-#include <mutex>
 #include <thread>
-#include <condition_variable>
 #include <atomic>
 #include <chrono>
-#include <cstring>
+#include <cmath>
 #include <csignal>
+#include <cstdlib>
 #include <getopt.h>
 
-// Default configuration
-#define DEFAULT_FREQ        137100000   // 137.1 MHz (NOAA-19)
-#define DEFAULT_SAMPLE_RATE 2400000     // 2.4 MS/s
-#define DEFAULT_GAIN        400         // 40.0 dB (gain is in tenths)
-#define DEFAULT_DURATION    900         // 15 minutes
-#define BUFFER_SIZE         (16 * 16384) // 256KB per buffer
-#define NUM_BUFFERS         16          // Ring buffer depth
+#include "capture_session.h"
+#include "doppler_profile.h"
+#include "dsp_pipeline.h"
+#include "io_scheduler.h"
+#include "iq_writer.h"
+#include "latency_histogram.h"
+#include "metrics.h"
+#include "ppm_store.h"
+#include "thread_util.h"
+#include "waterfall_ring.h"
+#include "wav_writer.h"
 
 // Global state
 static std::atomic<bool> g_running(true);
-static rtlsdr_dev_t *g_dev = nullptr;
-
-// Thread-safe queue for I/Q buffers
-class BufferQueue {
-public:
-    void push(std::vector<uint8_t>&& buf) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        queue_.push(std::move(buf));
-        cv_.notify_one();
-    }
-    
-    bool pop(std::vector<uint8_t>& buf, int timeout_ms = 1000) {
-        std::unique_lock<std::mutex> lock(mutex_);
-        if (cv_.wait_for(lock, std::chrono::milliseconds(timeout_ms),
-                         [this] { return !queue_.empty(); })) {
-            buf = std::move(queue_.front());
-            queue_.pop();
-            return true;
-        }
-        return false;
-    }
-    
-    size_t size() {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return queue_.size();
-    }
-    
-private:
-    std::queue<std::vector<uint8_t>> queue_;
-    std::mutex mutex_;
-    std::condition_variable cv_;
-};
-
-static BufferQueue g_buffer_queue;
-static std::atomic<uint64_t> g_samples_captured(0);
-static std::atomic<uint64_t> g_bytes_written(0);
-static std::atomic<int> g_overflows(0);
 
 // Signal handler
 void signal_handler(int signum) {
@@ -79,85 +70,165 @@ void signal_handler(int signum) {
     g_running = false;
 }
 
-// RTL-SDR async callback
-void rtlsdr_callback(unsigned char *buf, uint32_t len, void *ctx) {
-    if (!g_running) {
-        rtlsdr_cancel_async(g_dev);
-        return;
-    }
-    
-    // Copy to vector and push to queue
-    std::vector<uint8_t> buffer(buf, buf + len);
-    g_buffer_queue.push(std::move(buffer));
-    
-    g_samples_captured += len / 2;  // 2 bytes per sample (I + Q)
-    
-    // Check for queue overflow
-    if (g_buffer_queue.size() > NUM_BUFFERS) {
-        g_overflows++;
-    }
-}
-
-// Writer thread
-void writer_thread(const std::string& filename) {
-    std::ofstream outfile(filename, std::ios::binary);
-    if (!outfile) {
-        std::cerr << "Error: Cannot open output file: " << filename << std::endl;
-        g_running = false;
-        return;
-    }
-    
-    std::vector<uint8_t> buffer;
-    
-    while (g_running || g_buffer_queue.size() > 0) {
-        if (g_buffer_queue.pop(buffer, 100)) {
-            outfile.write(reinterpret_cast<char*>(buffer.data()), buffer.size());
-            g_bytes_written += buffer.size();
-        }
-    }
-    
-    outfile.close();
-}
-
-// Progress display thread
-void progress_thread(uint32_t sample_rate, int duration_sec) {
+// Progress display. The session ends itself after duration_sec of
+// samples; for a live source the wall clock stops it too, in case the
+// stream stalls.
+void progress_loop(const CaptureSession& session, int duration_sec, bool show_doppler) {
     auto start_time = std::chrono::steady_clock::now();
-    uint64_t expected_samples = static_cast<uint64_t>(sample_rate) * duration_sec;
+    bool real_time = session.speed() == 1.0;
     
-    while (g_running) {
+    while (g_running && session.running()) {
         std::this_thread::sleep_for(std::chrono::seconds(1));
         
         auto now = std::chrono::steady_clock::now();
         auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - start_time).count();
+        if (real_time && elapsed >= duration_sec + WALL_STOP_GRACE_SEC) {
+            g_running = false;
+        }
         
-        double progress = static_cast<double>(g_samples_captured) / expected_samples * 100.0;
-        double mb_written = g_bytes_written / 1e6;
+        CaptureStats stats = session.stats();
+        const LatencyHistogram& latency = session.write_latency();
+        double mb_written = stats.bytes_written / 1e6;
         double rate = mb_written / (elapsed > 0 ? elapsed : 1);
+        uint64_t stream_sec = stats.samples / session.config().sample_rate;
         
-        std::cout << "\r[" << elapsed << "s] "
-                  << g_samples_captured / 1000000 << "M samples, "
+        std::cout << "\r[" << stream_sec << "s] "
+                  << stats.samples / 1000000 << "M samples, "
                   << std::fixed << std::setprecision(1)
                   << mb_written << " MB written ("
                   << rate << " MB/s), "
-                  << "Queue: " << g_buffer_queue.size() << ", "
-                  << "Overflows: " << g_overflows
+                  << "Queue: " << stats.queued << "/" << session.config().num_buffers << ", "
+                  << "Overflows: " << stats.overflows << ", "
+                  << "Gaps: " << stats.gaps << ", "
+                  << "Write p50/p99/max: " << std::setprecision(2)
+                  << latency.percentile_ms(50) << "/"
+                  << latency.percentile_ms(99) << "/"
+                  << latency.max_ns() / 1e6 << " ms";
+        if (show_doppler) {
+            std::cout << ", Doppler: " << std::showpos << std::setprecision(1)
+                      << stats.doppler_hz << std::noshowpos << " Hz";
+        }
+        if (session.config().carrier_tracking) {
+            std::cout << ", Carrier: " << std::showpos << std::setprecision(0)
+                      << stats.carrier_error_hz << std::noshowpos << " Hz"
+                      << (stats.carrier_locked ? "" : " (no lock)");
+        }
+        if (session.load().enabled() && session.load().level() != LoadLevel::Full) {
+            std::cout << ", Load: " << load_level_name(session.load().level());
+        }
+        std::cout
                   << "     " << std::flush;
     }
     std::cout << std::endl;
 }
 
+// --channel=<freq>:<audio>[:<image>[:<profile>]]; either output may be
+// left empty
+struct ChannelSpec {
+    ChannelConfig config;
+    std::string profile_file;
+};
+
+static bool parse_channel(const std::string& spec, ChannelSpec& out) {
+    std::vector<std::string> fields;
+    size_t start = 0;
+    while (true) {
+        size_t colon = spec.find(':', start);
+        fields.push_back(spec.substr(start, colon == std::string::npos ? std::string::npos : colon - start));
+        if (colon == std::string::npos) break;
+        start = colon + 1;
+    }
+    if (fields.size() < 2 || fields.size() > 4) return false;
+    char* end = nullptr;
+    double hz = std::strtod(fields[0].c_str(), &end);
+    if (fields[0].empty() || *end != '\0' || hz <= 0.0 || hz > 4e9) return false;
+    out.config.frequency = static_cast<uint32_t>(std::lround(hz));
+    out.config.audio_filename = fields[1];
+    if (fields.size() > 2) out.config.image_filename = fields[2];
+    if (fields.size() > 3) out.profile_file = fields[3];
+    return !out.config.audio_filename.empty() || !out.config.image_filename.empty();
+}
+
+// Run every DSP kernel table this CPU supports against the scalar
+// reference; no device needed
+bool check_dsp_kernels() {
+    bool ok = true;
+    for (const DspKernels* const* k = dsp_kernels_available(); *k; k++) {
+        ok = dsp_kernels_verify(**k, std::cout) && ok;
+    }
+    std::cout << "Selected kernels: " << dsp_kernels().name << "\n";
+    return ok;
+}
+
 void print_usage(const char* progname) {
-    std::cout << "Usage: " << progname << " [options] -o <output_file>\n"
+    std::cout << "Usage: " << progname << " [options] -o <output_file> | -a <audio.wav>\n"
               << "\nOptions:\n"
               << "  -f <freq>      Center frequency in Hz (default: " << DEFAULT_FREQ << ")\n"
               << "  -s <rate>      Sample rate in Hz (default: " << DEFAULT_SAMPLE_RATE << ")\n"
               << "  -g <gain>      Gain in dB (default: " << DEFAULT_GAIN/10.0 << ")\n"
               << "  -d <duration>  Capture duration in seconds (default: " << DEFAULT_DURATION << ")\n"
-              << "  -o <file>      Output file (required)\n"
+              << "  -o <file>      Raw I/Q output file\n"
+              << "  -a <file.wav>  Demodulated audio output (" << DEMOD_AUDIO_RATE << " Hz WAV)\n"
               << "  -D <device>    Device index (default: 0)\n"
+              << "  --source=<spec>  Sample source: rtlsdr[:<index>], file:<capture>[,speed=<x|max>]\n"
+              << "                 [,rate=<hz>][,start=<sec>][,loop], synth[:speed=<x|max>]\n"
+              << "                 [,doppler=<profile>][,snr=<db>][,carrier=<hz>] (default: rtlsdr)\n"
+              << "  --format=<fmt> Output format: raw, sigmf (raw + .sigmf-meta), sgc (default: raw)\n"
+              << "  --compress=<bits>  Rice-code sgc frames at <bits> per component\n"
+              << "                 (8 = lossless, 1-7 drop low bits first)\n"
+              << "  --io=<mode>    Writer backend: stream, direct, uring (default: stream)\n"
+              << "  --inflight=<n> Writes kept in flight for direct/uring (default: " << DEFAULT_IO_INFLIGHT << ")\n"
+              << "  --prealloc     Preallocate sample_rate * duration * 2 bytes on disk\n"
+              << "  --audio-format=<fmt>  Audio sample format: s16, f32 (default: s16)\n"
+              << "  --iq-correct   Remove DC offset and I/Q imbalance before demodulating\n"
+              << "  --image=<png>  Decode the audio to an APT image during the pass (needs -a)\n"
+              << "  --dsp-check    Verify the SIMD DSP kernels against scalar and exit\n"
+              << "  --pin[=<io>,<reader>,<dsp>]  Pin the I/O, USB reader and DSP threads to\n"
+              << "                 these cores (default: 0,1,2); progress and metrics run on the rest\n"
+              << "  --realtime     SCHED_FIFO for the USB reader and I/O threads, buffer pool\n"
+              << "                 locked in RAM (falls back to normal where not permitted)\n"
+              << "  --calibrate[=<sec>]  Size transfers and the slab pool from a trial stream\n"
+              << "                 first (default: " << DEFAULT_CALIBRATE_SEC << " s)\n"
+              << "  --metrics=<port>  Serve Prometheus metrics on http://" << METRICS_BIND_ADDRESS
+              << ":<port>/metrics\n"
+              << "  --waterfall=<name>[,fft=<n>,avg=<n>,overlap=<f>,rate=<hz>,range=<dB>:<dB>]\n"
+              << "                 Publish live spectrum rows to /dev/shm/satgs-wf-<name> for the\n"
+              << "                 HMI (default " << SPECTRUM_DEFAULT_SIZE << " bins, " << SPECTRUM_DEFAULT_AVERAGES
+              << " averages, " << SPECTRUM_DEFAULT_ROW_RATE << " rows/s)\n"
+              << "  -p <file>      Doppler profile JSON: stay on a fixed center frequency and\n"
+              << "                 correct the audio channel with a software NCO (needs -a)\n"
+              << "  --offset=<hz>  Tune this far from the carrier (keeps it off the DC spike);\n"
+              << "                 the NCO shifts it back\n"
+              << "  --profile-start=<sec>  Profile time at the first sample (default:\n"
+              << "                 from the profile's aos_utc and the system clock)\n"
+              << "  --doppler-interp=<mode>  Profile interpolation: linear, hermite (default: linear)\n"
+              << "  --track-carrier[=<hz>]  Close a frequency-locked loop around the NCO on what\n"
+              << "                 the profile leaves over (loop bandwidth, default " << FLL_BANDWIDTH_HZ << " Hz)\n"
+              << "  --ppm=<ppm>    Tuner crystal error to correct (rtl_sdr -p convention)\n"
+              << "  --ppm-store=<file>  Per-dongle ppm learned on earlier passes: correct by the\n"
+              << "                 stored value, update it from this pass (needs a profile)\n"
+              << "  --channel=<freq>:<wav>[:<png>[:<profile>]]  Also demodulate the carrier at\n"
+              << "                 <freq> Hz from the same stream (repeatable; either output may\n"
+              << "                 be empty). The tuner stays at -f plus --offset.\n"
+              << "  --shed-load[=<D>]  Under CPU or disk pressure drop the waterfall, then the\n"
+              << "                 raw I/Q, then the further channels, restoring each once the load\n"
+              << "                 falls; with D, raw I/Q goes to <name>.lowrate<ext> at 1/D rate\n"
+              << "                 before it stops (paced sources only)\n"
               << "  -h             Show this help\n"
               << "\nExample:\n"
-              << "  " << progname << " -f 137100000 -s 2400000 -g 40 -d 900 -o capture.bin\n";
+              << "  " << progname << " -f 137100000 -s 2400000 -g 40 -d 900 -o capture.bin\n"
+              << "  " << progname << " --io=direct --prealloc -d 900 -o capture.bin\n"
+              << "  " << progname << " --format=sgc --compress=4 -d 900 -o capture.sgc\n"
+              << "  " << progname << " -d 900 -a pass.wav    # demodulate only, ~50x less disk\n"
+              << "  " << progname << " -d 900 -a pass.wav --image=pass.png\n"
+              << "  " << progname << " -d 900 -a pass.wav --waterfall=noaa19    # live spectrum for the HMI\n"
+              << "  " << progname << " -p doppler.json --offset=100000 -d 900 -a pass.wav\n"
+              << "  " << progname << " -p doppler.json --track-carrier --ppm-store=ppm.json -d 900 -a pass.wav\n"
+              << "  " << progname << " --source=synth:speed=max -d 900 -a pass.wav --image=pass.png\n"
+              << "  " << progname << " --shed-load=8 --waterfall=noaa19 -d 900 -o capture.sgc -a pass.wav\n"
+              << "  " << progname << " --source=file:capture.sgc,speed=10 -d 900 -a pass.wav\n"
+              << "  " << progname << " -f 137100000 --offset=300000 -a n19.wav --image=n19.png \\\n"
+              << "      --channel=137912500:n18.wav:n18.png --channel=137620000:n15.wav:n15.png\n";
 }
 
 int main(int argc, char *argv[]) {
@@ -168,13 +239,76 @@ int main(int argc, char *argv[]) {
     int duration = DEFAULT_DURATION;
     int device_index = 0;
     std::string output_file;
+    CaptureFormat output_format = CaptureFormat::Raw;
+    int compress_bits = 0;
+    IoBackend io_backend = IoBackend::Stream;
+    int io_inflight = DEFAULT_IO_INFLIGHT;
+    bool preallocate = false;
+    std::string audio_file;
+    AudioFormat audio_format = AudioFormat::Int16;
+    bool iq_correct = false;
+    std::string image_file;
+    bool frequency_set = false;
+    std::string profile_file;
+    double tune_offset_hz = 0.0;
+    bool profile_start_set = false;
+    double profile_start_sec = 0.0;
+    DopplerInterp doppler_interp = DopplerInterp::Linear;
+    bool pin_threads = false;
+    std::vector<int> pin_cores = {0, 1, 2};
+    bool realtime = false;
+    std::string source;
+    int metrics_port = -1;
+    double calibrate_sec = 0.0;
+    std::vector<ChannelSpec> channels;
+    std::string waterfall_name;
+    SpectrumConfig spectrum;
+    bool track_carrier = false;
+    double fll_bandwidth_hz = FLL_BANDWIDTH_HZ;
+    bool ppm_set = false;
+    double ppm = 0.0;
+    std::string ppm_store_file;
+    LoadConfig load;
+    
+    enum { OPT_IO = 256, OPT_INFLIGHT, OPT_PREALLOC, OPT_AUDIO_FORMAT, OPT_IQ_CORRECT, OPT_DSP_CHECK,
+           OPT_OFFSET, OPT_PROFILE_START, OPT_DOPPLER_INTERP, OPT_PIN, OPT_IMAGE, OPT_FORMAT,
+           OPT_COMPRESS, OPT_SOURCE, OPT_METRICS, OPT_CALIBRATE, OPT_REALTIME, OPT_CHANNEL,
+           OPT_WATERFALL, OPT_TRACK_CARRIER, OPT_PPM, OPT_PPM_STORE, OPT_SHED_LOAD };
+    static const struct option long_options[] = {
+        {"io",       required_argument, nullptr, OPT_IO},
+        {"inflight", required_argument, nullptr, OPT_INFLIGHT},
+        {"prealloc", no_argument,       nullptr, OPT_PREALLOC},
+        {"audio-format", required_argument, nullptr, OPT_AUDIO_FORMAT},
+        {"iq-correct", no_argument,     nullptr, OPT_IQ_CORRECT},
+        {"dsp-check", no_argument,      nullptr, OPT_DSP_CHECK},
+        {"offset",   required_argument, nullptr, OPT_OFFSET},
+        {"profile-start", required_argument, nullptr, OPT_PROFILE_START},
+        {"doppler-interp", required_argument, nullptr, OPT_DOPPLER_INTERP},
+        {"pin",      optional_argument, nullptr, OPT_PIN},
+        {"realtime", no_argument,       nullptr, OPT_REALTIME},
+        {"image",    required_argument, nullptr, OPT_IMAGE},
+        {"format",   required_argument, nullptr, OPT_FORMAT},
+        {"compress", required_argument, nullptr, OPT_COMPRESS},
+        {"source",   required_argument, nullptr, OPT_SOURCE},
+        {"metrics",  required_argument, nullptr, OPT_METRICS},
+        {"calibrate", optional_argument, nullptr, OPT_CALIBRATE},
+        {"channel",  required_argument, nullptr, OPT_CHANNEL},
+        {"waterfall", required_argument, nullptr, OPT_WATERFALL},
+        {"track-carrier", optional_argument, nullptr, OPT_TRACK_CARRIER},
+        {"ppm",      required_argument, nullptr, OPT_PPM},
+        {"ppm-store", required_argument, nullptr, OPT_PPM_STORE},
+        {"shed-load", optional_argument, nullptr, OPT_SHED_LOAD},
+        {"help",     no_argument,       nullptr, 'h'},
+        {nullptr, 0, nullptr, 0}
+    };
     
     // Parse arguments
     int opt;
-    while ((opt = getopt(argc, argv, "f:s:g:d:o:D:h")) != -1) {
+    while ((opt = getopt_long(argc, argv, "f:s:g:d:o:a:D:p:h", long_options, nullptr)) != -1) {
         switch (opt) {
             case 'f':
                 frequency = std::stoul(optarg);
+                frequency_set = true;
                 break;
             case 's':
                 sample_rate = std::stoul(optarg);
@@ -188,9 +322,118 @@ int main(int argc, char *argv[]) {
             case 'o':
                 output_file = optarg;
                 break;
+            case 'a':
+                audio_file = optarg;
+                break;
             case 'D':
                 device_index = std::stoi(optarg);
                 break;
+            case 'p':
+                profile_file = optarg;
+                break;
+            case OPT_OFFSET:
+                tune_offset_hz = std::stod(optarg);
+                break;
+            case OPT_PROFILE_START:
+                profile_start_sec = std::stod(optarg);
+                profile_start_set = true;
+                break;
+            case OPT_DOPPLER_INTERP:
+                if (!parse_doppler_interp(optarg, doppler_interp)) {
+                    std::cerr << "Error: Unknown Doppler interpolation: " << optarg << "\n";
+                    return 1;
+                }
+                break;
+            case OPT_IO:
+                if (!parse_io_backend(optarg, io_backend)) {
+                    std::cerr << "Error: Unknown I/O backend: " << optarg << "\n";
+                    return 1;
+                }
+                break;
+            case OPT_INFLIGHT:
+                io_inflight = std::stoi(optarg);
+                break;
+            case OPT_PREALLOC:
+                preallocate = true;
+                break;
+            case OPT_AUDIO_FORMAT:
+                if (!parse_audio_format(optarg, audio_format)) {
+                    std::cerr << "Error: Unknown audio format: " << optarg << "\n";
+                    return 1;
+                }
+                break;
+            case OPT_IQ_CORRECT:
+                iq_correct = true;
+                break;
+            case OPT_PIN:
+                pin_threads = true;
+                if (optarg && (!parse_core_list(optarg, pin_cores) || pin_cores.size() != 3)) {
+                    std::cerr << "Error: --pin takes three cores: <io>,<reader>,<dsp>\n";
+                    return 1;
+                }
+                break;
+            case OPT_REALTIME:
+                realtime = true;
+                break;
+            case OPT_IMAGE:
+                image_file = optarg;
+                break;
+            case OPT_FORMAT:
+                if (!parse_capture_format(optarg, output_format)) {
+                    std::cerr << "Error: Unknown output format: " << optarg << "\n";
+                    return 1;
+                }
+                break;
+            case OPT_COMPRESS:
+                compress_bits = std::stoi(optarg);
+                break;
+            case OPT_SOURCE:
+                source = optarg;
+                break;
+            case OPT_METRICS:
+                metrics_port = std::stoi(optarg);
+                break;
+            case OPT_CALIBRATE:
+                calibrate_sec = optarg ? std::stod(optarg) : DEFAULT_CALIBRATE_SEC;
+                break;
+            case OPT_CHANNEL: {
+                ChannelSpec channel;
+                if (!parse_channel(optarg, channel)) {
+                    std::cerr << "Error: --channel takes <freq>:<audio>[:<image>[:<profile>]]\n";
+                    return 1;
+                }
+                channels.push_back(channel);
+                break;
+            }
+            case OPT_WATERFALL:
+                if (!parse_waterfall_spec(optarg, waterfall_name, spectrum)) {
+                    std::cerr << "Error: Bad --waterfall spec: " << optarg << "\n";
+                    return 1;
+                }
+                break;
+            case OPT_TRACK_CARRIER:
+                track_carrier = true;
+                if (optarg) fll_bandwidth_hz = std::stod(optarg);
+                break;
+            case OPT_PPM:
+                ppm = std::stod(optarg);
+                ppm_set = true;
+                break;
+            case OPT_PPM_STORE:
+                ppm_store_file = optarg;
+                break;
+            case OPT_SHED_LOAD:
+                load.enabled = true;
+                if (optarg) {
+                    load.raw_decimation = std::stoi(optarg);
+                    if (load.raw_decimation < 2 || load.raw_decimation > LOAD_MAX_DECIMATION) {
+                        std::cerr << "Error: --shed-load decimation must be 2 to " << LOAD_MAX_DECIMATION << "\n";
+                        return 1;
+                    }
+                }
+                break;
+            case OPT_DSP_CHECK:
+                return check_dsp_kernels() ? 0 : 1;
             case 'h':
             default:
                 print_usage(argv[0]);
@@ -198,83 +441,206 @@ int main(int argc, char *argv[]) {
         }
     }
     
-    if (output_file.empty()) {
-        std::cerr << "Error: Output file required (-o)\n";
+    if (output_file.empty() && audio_file.empty() && channels.empty()) {
+        std::cerr << "Error: Output file required (-o, -a and/or --channel)\n";
         print_usage(argv[0]);
         return 1;
     }
     
-    // Install signal handlers
-    signal(SIGINT, signal_handler);
-    signal(SIGTERM, signal_handler);
+    if ((!profile_file.empty() || (tune_offset_hz != 0.0 && channels.empty())) && audio_file.empty()) {
+        std::cerr << "Error: Software frequency correction (-p, --offset) applies to "
+                  << "the demodulated channel; use -a\n";
+        return 1;
+    }
+    
+    if ((track_carrier || ppm_set || !ppm_store_file.empty()) && audio_file.empty() && channels.empty()) {
+        std::cerr << "Error: Carrier tracking and ppm correction act on the demodulated channel; use -a\n";
+        return 1;
+    }
+    
+    if (track_carrier && (fll_bandwidth_hz <= 0.0 || fll_bandwidth_hz > 10.0)) {
+        std::cerr << "Error: --track-carrier bandwidth must be in (0, 10] Hz\n";
+        return 1;
+    }
+    
+    if (std::abs(ppm) > PPM_STORE_MAX) {
+        std::cerr << "Error: --ppm must be within +/-" << PPM_STORE_MAX << "\n";
+        return 1;
+    }
+    
+    PpmStore ppm_store;
+    if (!ppm_store_file.empty() && !ppm_store.load(ppm_store_file)) {
+        return 1;
+    }
+    
+    if (!image_file.empty() && audio_file.empty()) {
+        std::cerr << "Error: --image decodes the demodulated audio; use -a\n";
+        return 1;
+    }
+    
+    if (std::abs(tune_offset_hz) > sample_rate / 2.0 - DEMOD_CHANNEL_BW_HZ) {
+        std::cerr << "Error: --offset must keep the channel inside +/-"
+                  << (sample_rate / 2.0 - DEMOD_CHANNEL_BW_HZ) / 1e3 << " kHz\n";
+        return 1;
+    }
+    
+    DopplerProfile profile;
+    if (!profile_file.empty()) {
+        if (!profile.load(profile_file)) {
+            return 1;
+        }
+        profile.interp = doppler_interp;
+        if (!frequency_set && profile.center_freq_hz > 0) {
+            frequency = static_cast<uint32_t>(profile.center_freq_hz);
+        }
+    }
+    
+    // Kept alive for the session; each channel has its own pass
+    std::vector<std::unique_ptr<DopplerProfile>> channel_profiles;
+    for (ChannelSpec& channel : channels) {
+        if (channel.profile_file.empty()) continue;
+        channel_profiles.emplace_back(new DopplerProfile());
+        if (!channel_profiles.back()->load(channel.profile_file)) {
+            return 1;
+        }
+        channel_profiles.back()->interp = doppler_interp;
+        channel.config.doppler = channel_profiles.back().get();
+    }
     
-    // Open device
-    int device_count = rtlsdr_get_device_count();
-    if (device_count == 0) {
-        std::cerr << "Error: No RTL-SDR devices found\n";
+    if (!io_backend_available(io_backend)) {
+        std::cerr << "Error: I/O backend '" << io_backend_name(io_backend)
+                  << "' not available in this build\n";
         return 1;
     }
     
-    std::cout << "Found " << device_count << " RTL-SDR device(s)\n";
-    std::cout << "Using device " << device_index << ": " 
-              << rtlsdr_get_device_name(device_index) << "\n";
+    if (compress_bits != 0 && (output_format != CaptureFormat::Sgc || compress_bits < 1 || compress_bits > 8)) {
+        std::cerr << "Error: --compress takes 1-8 bits and needs --format=sgc\n";
+        return 1;
+    }
     
-    if (rtlsdr_open(&g_dev, device_index) < 0) {
-        std::cerr << "Error: Failed to open RTL-SDR device\n";
+    if (output_format == CaptureFormat::Sgc && (io_backend != IoBackend::Stream || preallocate)) {
+        std::cerr << "Error: --format=sgc writes through its own buffered writer; "
+                  << "--io and --prealloc apply to raw and sigmf\n";
         return 1;
     }
     
-    // Configure device
-    std::cout << "\nConfiguration:\n";
-    std::cout << "  Frequency:   " << frequency / 1e6 << " MHz\n";
-    std::cout << "  Sample rate: " << sample_rate / 1e6 << " MS/s\n";
-    std::cout << "  Gain:        " << gain / 10.0 << " dB\n";
-    std::cout << "  Duration:    " << duration << " seconds\n";
-    std::cout << "  Output:      " << output_file << "\n";
+    if (io_inflight < 1 || io_inflight > NUM_BUFFERS - 1) {
+        std::cerr << "Error: --inflight must be between 1 and " << NUM_BUFFERS - 1 << "\n";
+        return 1;
+    }
     
-    rtlsdr_set_sample_rate(g_dev, sample_rate);
-    rtlsdr_set_center_freq(g_dev, frequency);
-    rtlsdr_set_tuner_gain_mode(g_dev, 1);  // Manual gain
-    rtlsdr_set_tuner_gain(g_dev, gain);
-    rtlsdr_reset_buffer(g_dev);
+    CaptureConfig config;
+    config.source = source;
+    config.device_index = device_index;
+    config.frequency = frequency;
+    config.sample_rate = sample_rate;
+    config.gain = gain;
+    config.duration_sec = duration;
+    config.calibrate_sec = calibrate_sec;
+    config.filename = output_file;
+    config.format = output_format;
+    config.compress_bits = compress_bits;
+    config.backend = io_backend;
+    config.max_inflight = io_inflight;
+    config.preallocate = preallocate;
+    config.audio_filename = audio_file;
+    config.audio_format = audio_format;
+    config.iq_correction = iq_correct;
+    config.image_filename = image_file;
+    if (!profile_file.empty()) {
+        config.doppler = &profile;
+    }
+    config.tune_offset_hz = tune_offset_hz;
+    config.profile_start_set = profile_start_set;
+    config.profile_start_sec = profile_start_sec;
+    for (const ChannelSpec& channel : channels) {
+        config.channels.push_back(channel.config);
+    }
+    config.waterfall_name = waterfall_name;
+    config.spectrum = spectrum;
+    config.carrier_tracking = track_carrier;
+    config.fll_bandwidth_hz = fll_bandwidth_hz;
+    config.ppm_set = ppm_set;
+    config.ppm = ppm;
+    if (!ppm_store_file.empty()) {
+        config.ppm_store = &ppm_store;
+    }
+    config.load = load;
     
-    // Verify settings
-    std::cout << "\nActual settings:\n";
-    std::cout << "  Frequency:   " << rtlsdr_get_center_freq(g_dev) / 1e6 << " MHz\n";
-    std::cout << "  Sample rate: " << rtlsdr_get_sample_rate(g_dev) / 1e6 << " MS/s\n";
-    std::cout << "  Gain:        " << rtlsdr_get_tuner_gain(g_dev) / 10.0 << " dB\n";
+    // I/O thread, USB reader and DSP worker on their own cores
+    int io_core = -1;
+    if (pin_threads) {
+        io_core = pin_cores[0] % cpu_count();
+        config.reader_core = pin_cores[1] % cpu_count();
+        config.worker_core = pin_cores[2] % cpu_count();
+    }
+    if (realtime) {
+        config.reader_rt_priority = READER_RT_PRIORITY;
+        config.lock_memory = true;
+    }
+    
+    // Install signal handlers
+    signal(SIGINT, signal_handler);
+    signal(SIGTERM, signal_handler);
+    
+    IoScheduler io(io_core);
+    if (realtime) {
+        io.set_realtime(IO_RT_PRIORITY);
+    }
+    CaptureSession session(config);
+    if (!session.open(io)) {
+        return 1;
+    }
     
     // Start threads
     std::cout << "\nStarting capture...\n";
-    std::thread writer(writer_thread, output_file);
-    std::thread progress(progress_thread, sample_rate, duration);
+    io.start();
+    session.start();
     
-    // Set up duration timer
-    std::thread timer([duration]() {
-        std::this_thread::sleep_for(std::chrono::seconds(duration));
-        g_running = false;
-    });
-    timer.detach();
+    // Progress, metrics and the main thread stay off the capture cores
+    if (pin_threads || realtime) {
+        std::cout << "Real-time:\n";
+        session.print_placement(std::cout);
+        std::cout << "  I/O writer: " << describe_placement(io.placement()) << "\n";
+        if (pin_threads) {
+            std::cout << "  Progress:   ";
+            if (pin_current_thread_excluding({io_core, config.reader_core, config.worker_core})) {
+                std::cout << "other cores\n";
+            } else {
+                std::cout << "shares the capture cores (" << cpu_count() << " online)\n";
+            }
+        }
+    }
     
-    // Start async read (blocks until cancelled)
-    rtlsdr_read_async(g_dev, rtlsdr_callback, nullptr, NUM_BUFFERS, BUFFER_SIZE);
+    MetricsServer metrics;
+    if (metrics_port >= 0) {
+        metrics.add_collector([&session](MetricsWriter& out) { session.collect_metrics(out); });
+        if (!metrics.start(metrics_port)) {
+            session.stop();
+            session.join();
+            return 1;
+        }
+        std::cout << "Metrics on http://" << METRICS_BIND_ADDRESS << ":" << metrics.port() << "/metrics\n";
+    }
     
-    // Wait for writer to finish
-    g_running = false;
-    writer.join();
-    progress.join();
+    // Ends at the duration, on a signal, or if the stream stops by itself
+    progress_loop(session, duration, !profile_file.empty());
     
-    // Cleanup
-    rtlsdr_close(g_dev);
+    // Wait for the worker and the I/O thread to drain the queue
+    session.stop();
+    bool ok = session.join();
+    metrics.stop();
     
     // Summary
     std::cout << "\n========================================\n";
     std::cout << "Capture complete!\n";
-    std::cout << "  Samples:   " << g_samples_captured << "\n";
-    std::cout << "  Written:   " << g_bytes_written / 1e6 << " MB\n";
-    std::cout << "  Overflows: " << g_overflows << "\n";
-    std::cout << "  Output:    " << output_file << "\n";
+    session.print_summary(std::cout);
     std::cout << "========================================\n";
     
-    return 0;
+    double learned;
+    if (!ppm_store_file.empty() && session.learned_ppm(learned) && !ppm_store.save()) {
+        ok = false;
+    }
+    
+    return ok ? 0 : 1;
 }
@@ -0,0 +1,94 @@
+/*
+ * rtlsdr_source.cpp
+ * Satellite Ground Station - RTL-SDR Sample Source
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#include "sample_source.h"
+
+#include <rtl-sdr.h>
+
+#include <iostream>
+
+class RtlSdrSource : public SampleSource {
+public:
+    explicit RtlSdrSource(int device_index) : device_index_(device_index) {}
+    ~RtlSdrSource() override { close(); }
+
+    bool open() override {
+        int device_count = rtlsdr_get_device_count();
+        if (device_count == 0) {
+            std::cerr << "Error: No RTL-SDR devices found\n";
+            return false;
+        }
+        if (device_index_ < 0 || device_index_ >= device_count) {
+            std::cerr << "Error: RTL-SDR device " << device_index_ << " not present ("
+                      << device_count << " found)\n";
+            return false;
+        }
+        if (rtlsdr_open(&dev_, static_cast<uint32_t>(device_index_)) < 0) {
+            std::cerr << "Error: Failed to open RTL-SDR device " << device_index_ << "\n";
+            dev_ = nullptr;
+            return false;
+        }
+        return true;
+    }
+
+    void close() override {
+        if (dev_) {
+            rtlsdr_close(dev_);
+            dev_ = nullptr;
+        }
+    }
+
+    bool set_sample_rate(uint32_t rate) override { return dev_ && rtlsdr_set_sample_rate(dev_, rate) == 0; }
+    bool set_center_freq(uint32_t hz) override { return dev_ && rtlsdr_set_center_freq(dev_, hz) == 0; }
+    bool set_gain(int tenth_db) override {
+        return dev_ && rtlsdr_set_tuner_gain_mode(dev_, 1) == 0 && rtlsdr_set_tuner_gain(dev_, tenth_db) == 0;
+    }
+
+    uint32_t sample_rate() const override { return dev_ ? rtlsdr_get_sample_rate(dev_) : 0; }
+    uint32_t center_freq() const override { return dev_ ? rtlsdr_get_center_freq(dev_) : 0; }
+    int gain() const override { return dev_ ? rtlsdr_get_tuner_gain(dev_) : 0; }
+
+    std::string name() const override {
+        const char* name = rtlsdr_get_device_name(static_cast<uint32_t>(device_index_));
+        return "device " + std::to_string(device_index_) + ": " + (name ? name : "");
+    }
+
+    // Serials survive replugging where indices don't; dongles that all
+    // ship as 00000001 need rtl_eeprom -s to be told apart
+    std::string device_id() const override {
+        char manufacturer[256] = {0}, product[256] = {0}, serial[256] = {0};
+        std::string id = "rtlsdr:";
+        if (rtlsdr_get_device_usb_strings(static_cast<uint32_t>(device_index_), manufacturer, product,
+                                          serial) != 0 || serial[0] == '\0') {
+            return id + "index" + std::to_string(device_index_);
+        }
+        for (const char* c = serial; *c; c++) {
+            id += (*c > ' ' && *c < 127 && *c != '"' && *c != '\\') ? *c : '_';
+        }
+        return id;
+    }
+
+    bool stream(SampleCallback callback, void* ctx, uint32_t num_buffers, uint32_t buffer_size) override {
+        if (!dev_) return false;
+        rtlsdr_reset_buffer(dev_);
+        // Blocks until cancelled
+        return rtlsdr_read_async(dev_, callback, ctx, num_buffers, buffer_size) == 0;
+    }
+
+    void cancel() override {
+        if (dev_) rtlsdr_cancel_async(dev_);
+    }
+
+private:
+    int device_index_;
+    rtlsdr_dev_t* dev_ = nullptr;
+};
+
+std::unique_ptr<SampleSource> create_rtlsdr_source(int device_index) {
+    return std::unique_ptr<SampleSource>(new RtlSdrSource(device_index));
+}
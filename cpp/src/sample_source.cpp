@@ -0,0 +1,601 @@
+/*
+ * sample_source.cpp
+ * Satellite Ground Station - I/Q Sample Sources
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#include "sample_source.h"
+#include "apt_decoder.h"
+#include "capture_format.h"
+#include "doppler_profile.h"
+#include "dsp_pipeline.h"
+#include "json_reader.h"
+#include "mapped_file.h"
+#include "sgc_format.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#define REPLAY_RELEASE_BYTES  (64 * 1024 * 1024)  // Drop replayed pages in steps of this
+#define SYNTH_AMPLITUDE       60.0                // Carrier amplitude in u8 LSBs
+#define SYNTH_DEVIATION       0.8                 // Peak deviation / DEMOD_MAX_DEVIATION_HZ
+#define SYNTH_TABLE_BITS      12                  // Sine table of 4096 entries
+#define SYNTH_CHUNK           256                 // Samples per Doppler update
+#define SYNTH_PASS_SEC        900.0               // Built-in pass length
+#define SYNTH_PASS_DOPPLER_HZ 3200.0              // ... and its peak Doppler
+#define DEFAULT_SYNTH_SNR_DB  20.0
+
+static const double kPi = 3.14159265358979323846;
+
+static bool ends_with(const std::string& s, const char* suffix) {
+    size_t n = std::strlen(suffix);
+    return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+static bool parse_speed(const std::string& value, double& speed) {
+    if (value == "max") {
+        speed = 0.0;
+        return true;
+    }
+    char* end = nullptr;
+    speed = std::strtod(value.c_str(), &end);
+    if (end == value.c_str() || *end != '\0' || !(speed > 0.0)) {
+        std::cerr << "Error: speed must be a positive multiple of real time or \"max\": " << value << "\n";
+        return false;
+    }
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// Paced software sources
+// ----------------------------------------------------------------------------
+
+// Runs the read loop for sources that produce samples themselves: each
+// transfer is handed over when its last sample would have arrived live
+// at speed() x real time (absolute deadlines, so pacing doesn't drift),
+// or immediately at speed 0
+class GeneratedSource : public SampleSource {
+public:
+    bool set_sample_rate(uint32_t rate) override {
+        if (!fixed_rate_) rate_ = rate;
+        return true;
+    }
+    bool set_center_freq(uint32_t hz) override {
+        if (!fixed_tuning_) center_ = hz;
+        return true;
+    }
+    bool set_gain(int tenth_db) override {
+        if (!fixed_tuning_) gain_ = tenth_db;
+        return true;
+    }
+
+    uint32_t sample_rate() const override { return rate_; }
+    uint32_t center_freq() const override { return center_; }
+    int gain() const override { return gain_; }
+    double speed() const override { return speed_; }
+
+    bool stream(SampleCallback callback, void* ctx, uint32_t num_buffers, uint32_t buffer_size) override {
+        if (rate_ == 0 || num_buffers == 0 || buffer_size < 2) return false;
+        cancelled_ = false;
+        buffer_size &= ~1u;
+        buffers_.assign(static_cast<size_t>(num_buffers) * buffer_size, 0);
+        if (!begin()) return false;
+
+        const auto start = std::chrono::steady_clock::now();
+        uint64_t delivered = 0;
+        uint64_t transfers = 0;
+        uint32_t next = 0;
+        while (!cancelled_) {
+            uint8_t* buf = &buffers_[static_cast<size_t>(next) * buffer_size];
+            next = (next + 1) % num_buffers;
+            uint32_t len = produce(buf, buffer_size);
+            if (len == 0) break;
+            delivered += len / 2;
+            if (speed_ > 0.0) {
+                std::this_thread::sleep_until(start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                    std::chrono::duration<double>(delivered / (rate_ * speed_))));
+            }
+            if (cancelled_) break;
+            if (drop_every_ > 0 && ++transfers % drop_every_ == 0) continue;
+            callback(buf, len, ctx);
+        }
+        return !failed_;
+    }
+
+    void cancel() override { cancelled_ = true; }
+
+    // Fault injection: lose every n-th transfer (0 = none)
+    void set_drop_every(uint32_t n) { drop_every_ = n; }
+
+protected:
+    // Called at the start of stream(), once the rate is known
+    virtual bool begin() { return true; }
+
+    // Fill up to len bytes (even); 0 at the end of the data
+    virtual uint32_t produce(uint8_t* buf, uint32_t len) = 0;
+
+    uint32_t rate_ = 0;
+    uint32_t center_ = 0;
+    int gain_ = 0;
+    bool fixed_rate_ = false;       // Recorded rate; requests don't change it
+    bool fixed_tuning_ = false;     // Recorded tuning and gain
+    double speed_ = 1.0;
+    uint32_t drop_every_ = 0;
+    bool failed_ = false;
+
+private:
+    std::atomic<bool> cancelled_{false};
+    std::vector<uint8_t> buffers_;
+};
+
+// ----------------------------------------------------------------------------
+// File replay
+// ----------------------------------------------------------------------------
+
+// SigMF global sample rate / datatype and the first capture's frequency
+static bool read_sigmf_meta(const std::string& path, uint32_t& rate, uint32_t& freq) {
+    MappedFile file;
+    if (!file.open(path)) {
+        std::cerr << "Error: Cannot open SigMF metadata: " << path << std::endl;
+        return false;
+    }
+    JsonReader json(file.data(), file.size());
+    std::string_view key, text;
+    std::string datatype;
+    double value;
+    json.begin_object();
+    while (json.next_key(key)) {
+        if (key == "global" && json.peek() == '{') {
+            json.begin_object();
+            while (json.next_key(key)) {
+                if (key == "core:sample_rate" && json.read_number(value)) {
+                    rate = static_cast<uint32_t>(value);
+                } else if (key == "core:datatype" && json.peek() == '"' && json.read_string(text)) {
+                    datatype.assign(text);
+                } else {
+                    json.skip_value();
+                }
+            }
+        } else if (key == "captures" && json.peek() == '[') {
+            json.begin_array();
+            bool first = true;
+            while (json.next_element()) {
+                if (!first || json.peek() != '{') {
+                    json.skip_value();
+                    continue;
+                }
+                first = false;
+                json.begin_object();
+                while (json.next_key(key)) {
+                    if (key == "core:frequency" && json.read_number(value)) {
+                        freq = static_cast<uint32_t>(value);
+                    } else {
+                        json.skip_value();
+                    }
+                }
+            }
+        } else {
+            json.skip_value();
+        }
+    }
+    if (!json.ok()) {
+        std::cerr << "Error: Malformed SigMF metadata at byte " << json.error_offset() << ": " << path << std::endl;
+        return false;
+    }
+    if (datatype != "cu8") {
+        std::cerr << "Error: Only cu8 SigMF recordings can be replayed (" << path << " is "
+                  << (datatype.empty() ? "untyped" : datatype) << ")\n";
+        return false;
+    }
+    return true;
+}
+
+class FileSource : public GeneratedSource {
+public:
+    FileSource(const std::string& path, double speed, uint32_t rate, double start_sec, bool loop)
+        : path_(path), start_sec_(start_sec), loop_(loop) {
+        speed_ = speed;
+        if (rate > 0) {
+            rate_ = rate;
+            fixed_rate_ = true;
+        }
+    }
+
+    bool open() override {
+        if (ends_with(path_, ".sgc")) {
+            if (!sgc_.open(path_)) return false;
+            const SgcHeader& h = sgc_.header();
+            rate_ = h.sample_rate;
+            center_ = static_cast<uint32_t>(h.center_freq_hz);
+            gain_ = h.gain_tenth_db;
+            fixed_rate_ = fixed_tuning_ = true;
+            is_sgc_ = true;
+            return true;
+        }
+        std::string meta = sigmf_meta_path(path_);
+        if (ends_with(path_, ".sigmf-data") || access(meta.c_str(), F_OK) == 0) {
+            uint32_t rate = 0, freq = 0;
+            if (!read_sigmf_meta(meta, rate, freq)) return false;
+            if (rate > 0) {
+                rate_ = rate;
+                fixed_rate_ = true;
+            }
+            if (freq > 0) {
+                center_ = freq;
+                fixed_tuning_ = true;
+            }
+        }
+        if (!file_.open(path_)) {
+            std::cerr << "Error: Cannot open capture: " << path_ << std::endl;
+            return false;
+        }
+        if (file_.size() < 2) {
+            std::cerr << "Error: Empty capture: " << path_ << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    void close() override {
+        file_.close();
+        sgc_.close();
+    }
+
+    std::string name() const override { return path_; }
+    // Whatever recorded it is unknown here
+    std::string device_id() const override { return "file"; }
+
+protected:
+    bool begin() override {
+        uint64_t start = static_cast<uint64_t>(start_sec_ * rate_);
+        if (is_sgc_) {
+            const std::vector<SgcEntry>& entries = sgc_.entries();
+            if (entries.empty()) {
+                std::cerr << "Error: Capture has no frames: " << path_ << std::endl;
+                return false;
+            }
+            start += entries.front().first_sample;
+            entry_ = sgc_.find_sample(start);
+            frame_.clear();
+            frame_pos_ = 0;
+            if (entry_ < entries.size() && start > entries[entry_].first_sample) {
+                if (!load_frame()) return false;
+                frame_pos_ = static_cast<size_t>(start - entries[entry_ - 1].first_sample) * 2;
+            }
+        } else {
+            pos_ = std::min<uint64_t>(start * 2, file_.size() & ~1ULL);
+            released_ = pos_ - pos_ % REPLAY_RELEASE_BYTES;
+            file_.prefetch(pos_, REPLAY_RELEASE_BYTES);
+        }
+        return true;
+    }
+
+    uint32_t produce(uint8_t* buf, uint32_t len) override {
+        uint32_t done = 0;
+        while (done < len) {
+            size_t got = is_sgc_ ? take_sgc(buf + done, len - done) : take_raw(buf + done, len - done);
+            if (got > 0) {
+                done += static_cast<uint32_t>(got);
+                continue;
+            }
+            if (failed_ || !loop_ || !rewind()) break;
+        }
+        return done;
+    }
+
+private:
+    size_t take_raw(uint8_t* out, size_t len) {
+        uint64_t end = file_.size() & ~1ULL;
+        size_t n = static_cast<size_t>(std::min<uint64_t>(len, end - pos_));
+        std::memcpy(out, file_.data() + pos_, n);
+        pos_ += n;
+        // Keep the page cache footprint of a long replay bounded
+        if (pos_ - released_ >= 2 * REPLAY_RELEASE_BYTES) {
+            file_.release(released_, REPLAY_RELEASE_BYTES);
+            released_ += REPLAY_RELEASE_BYTES;
+            file_.prefetch(pos_, REPLAY_RELEASE_BYTES);
+        }
+        return n;
+    }
+
+    bool load_frame() {
+        if (!sgc_.read(entry_, frame_)) {
+            failed_ = true;
+            return false;
+        }
+        entry_++;
+        frame_pos_ = 0;
+        return true;
+    }
+
+    size_t take_sgc(uint8_t* out, size_t len) {
+        if (frame_pos_ >= frame_.size()) {
+            if (entry_ >= sgc_.entries().size() || !load_frame()) return 0;
+        }
+        size_t n = std::min(len, frame_.size() - frame_pos_);
+        std::memcpy(out, frame_.data() + frame_pos_, n);
+        frame_pos_ += n;
+        return n;
+    }
+
+    bool rewind() {
+        if (is_sgc_) {
+            entry_ = 0;
+            frame_.clear();
+            frame_pos_ = 0;
+        } else {
+            file_.release(released_, pos_ - released_);
+            pos_ = released_ = 0;
+        }
+        return true;
+    }
+
+    std::string path_;
+    double start_sec_;
+    bool loop_;
+    bool is_sgc_ = false;
+
+    MappedFile file_;
+    uint64_t pos_ = 0;
+    uint64_t released_ = 0;         // Pages before this were dropped
+
+    SgcReader sgc_;
+    size_t entry_ = 0;              // Next entry to decode
+    std::vector<uint8_t> frame_;
+    size_t frame_pos_ = 0;
+};
+
+// ----------------------------------------------------------------------------
+// Synthetic APT signal
+// ----------------------------------------------------------------------------
+
+// NOAA APT line layout in pixels: sync, space, image, telemetry per channel
+#define APT_SPACE_PIXELS      47
+#define APT_IMAGE_PIXELS      909
+#define APT_TELEMETRY_PIXELS  45
+#define APT_WEDGE_LINES       8     // Lines per telemetry wedge
+
+class SynthSource : public GeneratedSource {
+public:
+    SynthSource(double speed, const std::string& profile_path, double snr_db, uint32_t carrier_hz)
+        : profile_path_(profile_path), snr_db_(snr_db), carrier_hz_(carrier_hz) {
+        speed_ = speed;
+        rate_ = 2400000;
+        center_ = carrier_hz;
+    }
+
+    bool open() override {
+        if (!profile_path_.empty()) {
+            if (!profile_.load(profile_path_)) return false;
+            use_profile_ = true;
+        }
+        sine_.resize(1u << SYNTH_TABLE_BITS);
+        for (size_t i = 0; i < sine_.size(); i++) {
+            sine_[i] = static_cast<float>(std::sin(2.0 * kPi * i / sine_.size()));
+        }
+        return true;
+    }
+
+    void close() override {}
+
+    std::string name() const override {
+        return "synthetic APT" + (use_profile_ ? " (" + profile_path_ + ")" : std::string());
+    }
+    std::string device_id() const override { return "synth"; }
+
+protected:
+    bool begin() override {
+        sample_ = 0;
+        carrier_phase_ = 0;
+        subcarrier_phase_ = 0;
+        line_number_ = ~0ULL;
+        subcarrier_step_ = static_cast<uint32_t>(APT_CARRIER_HZ / rate_ * 4294967296.0);
+        deviation_scale_ = SYNTH_DEVIATION * DEMOD_MAX_DEVIATION_HZ / rate_ * 4294967296.0;
+        // Sum of two uniforms in [0, 1) has a standard deviation of 1/sqrt(6)
+        double sigma = SYNTH_AMPLITUDE / std::sqrt(2.0) / std::pow(10.0, snr_db_ / 20.0);
+        noise_scale_ = static_cast<float>(sigma * std::sqrt(6.0) / 16777216.0);
+        return true;
+    }
+
+    uint32_t produce(uint8_t* buf, uint32_t len) override {
+        const uint32_t n = len / 2;
+        const int shift = 32 - SYNTH_TABLE_BITS;
+        const uint32_t quarter = 1u << (SYNTH_TABLE_BITS - 2);
+        const uint32_t mask = (1u << SYNTH_TABLE_BITS) - 1;
+        for (uint32_t i = 0; i < n; i += SYNTH_CHUNK) {
+            uint32_t end = std::min(n, i + SYNTH_CHUNK);
+            // Carrier offset in the tuned band, Doppler included
+            double t = static_cast<double>(sample_) / rate_;
+            double offset = static_cast<double>(carrier_hz_) + doppler_at(t) - center_;
+            int32_t carrier_step = static_cast<int32_t>(std::lround(offset / rate_ * 4294967296.0));
+            for (uint32_t k = i; k < end; k++, sample_++) {
+                uint64_t pixel = sample_ * APT_PIXEL_RATE / rate_;
+                uint64_t line = pixel / APT_LINE_PIXELS;
+                if (line != line_number_) build_line(line);
+                float envelope = line_[pixel % APT_LINE_PIXELS];
+                float audio = envelope * sine_[subcarrier_phase_ >> shift];
+                subcarrier_phase_ += subcarrier_step_;
+
+                carrier_phase_ += static_cast<uint32_t>(carrier_step +
+                    static_cast<int32_t>(audio * deviation_scale_));
+                uint32_t index = carrier_phase_ >> shift;
+                float re = SYNTH_AMPLITUDE * sine_[(index + quarter) & mask];
+                float im = SYNTH_AMPLITUDE * sine_[index];
+                buf[2 * k] = quantize(127.5f + re + noise());
+                buf[2 * k + 1] = quantize(127.5f + im + noise());
+            }
+        }
+        return n * 2;
+    }
+
+private:
+    double doppler_at(double t) {
+        if (use_profile_) return profile_.getDoppler(t);
+        return -SYNTH_PASS_DOPPLER_HZ * std::tanh((t - SYNTH_PASS_SEC / 2) / 120.0);
+    }
+
+    float noise() {
+        lcg_ = lcg_ * 1664525u + 1013904223u;
+        uint32_t a = lcg_ >> 8;
+        lcg_ = lcg_ * 1664525u + 1013904223u;
+        uint32_t b = lcg_ >> 8;
+        return (static_cast<float>(a) + static_cast<float>(b) - 16777216.0f) * noise_scale_;
+    }
+
+    static uint8_t quantize(float v) {
+        return static_cast<uint8_t>(std::min(255.0f, std::max(0.0f, v + 0.5f)));
+    }
+
+    // Subcarrier amplitude per pixel of one line: sync A, space A (black),
+    // a sine-grid test pattern, telemetry wedges, then sync B, space B
+    // (white) and a grey ramp
+    void build_line(uint64_t line) {
+        static const float kBlack = 0.05f, kWhite = 0.95f;
+        line_number_ = line;
+        line_.resize(APT_LINE_PIXELS);
+        int wedge = static_cast<int>((line / APT_WEDGE_LINES) % 16);
+        float wedge_level = wedge < 8 ? kBlack + (kWhite - kBlack) * (wedge + 1) / 8.0f : kBlack;
+        for (int half = 0; half < 2; half++) {
+            float* p = &line_[half * APT_CHANNEL_B_OFFSET];
+            const char* sync = half ? kAptSyncB : kAptSyncA;
+            int x = 0;
+            for (int k = 0; k < APT_SYNC_PIXELS; k++) p[x++] = sync[k] == '1' ? kWhite : kBlack;
+            for (int k = 0; k < APT_SPACE_PIXELS; k++) p[x++] = half ? kWhite : kBlack;
+            for (int k = 0; k < APT_IMAGE_PIXELS; k++) {
+                double u = static_cast<double>(k) / APT_IMAGE_PIXELS;
+                double v = half ? u : 0.5 + 0.4 * std::sin(2.0 * kPi * 3.0 * u) *
+                                              std::cos(2.0 * kPi * static_cast<double>(line) / 200.0);
+                p[x++] = kBlack + (kWhite - kBlack) * static_cast<float>(v);
+            }
+            for (int k = 0; k < APT_TELEMETRY_PIXELS; k++) p[x++] = wedge_level;
+        }
+    }
+
+    std::string profile_path_;
+    double snr_db_;
+    uint32_t carrier_hz_;
+    DopplerProfile profile_;
+    bool use_profile_ = false;
+
+    std::vector<float> sine_;
+    std::vector<float> line_;
+    uint64_t line_number_ = ~0ULL;
+    uint64_t sample_ = 0;
+    uint32_t carrier_phase_ = 0;
+    uint32_t subcarrier_phase_ = 0;
+    uint32_t subcarrier_step_ = 0;
+    double deviation_scale_ = 0.0;  // Phase step per unit of audio
+    float noise_scale_ = 0.0f;
+    uint32_t lcg_ = 12345;
+};
+
+// ----------------------------------------------------------------------------
+// Factory
+// ----------------------------------------------------------------------------
+
+bool rtlsdr_source_available() {
+#if defined(SATGS_HAVE_RTLSDR)
+    return true;
+#else
+    return false;
+#endif
+}
+
+std::unique_ptr<SampleSource> create_sample_source(const std::string& spec, int device_index,
+                                                   uint32_t carrier_hz) {
+    size_t colon = spec.find(':');
+    std::string kind = spec.substr(0, colon);
+    std::string rest = colon == std::string::npos ? std::string() : spec.substr(colon + 1);
+
+    if (kind.empty() || kind == "rtlsdr") {
+        if (!rest.empty()) {
+            if (rest.find_first_not_of("0123456789") != std::string::npos) {
+                std::cerr << "Error: Bad RTL-SDR device index: " << rest << "\n";
+                return nullptr;
+            }
+            device_index = std::stoi(rest);
+        }
+#if defined(SATGS_HAVE_RTLSDR)
+        return create_rtlsdr_source(device_index);
+#else
+        (void)device_index;
+        std::cerr << "Error: Built without librtlsdr; use --source=file:... or synth\n";
+        return nullptr;
+#endif
+    }
+
+    // Comma-separated options; for file the first field is the path
+    std::vector<std::string> fields;
+    size_t begin = 0;
+    while (colon != std::string::npos && begin <= rest.size()) {
+        size_t comma = rest.find(',', begin);
+        fields.push_back(rest.substr(begin, comma == std::string::npos ? std::string::npos : comma - begin));
+        if (comma == std::string::npos) break;
+        begin = comma + 1;
+    }
+
+    std::string path;
+    if (kind == "file") {
+        if (fields.empty() || fields.front().empty()) {
+            std::cerr << "Error: --source=file needs a path (file:<capture>)\n";
+            return nullptr;
+        }
+        path = fields.front();
+        fields.erase(fields.begin());
+    } else if (kind != "synth") {
+        std::cerr << "Error: Unknown sample source: " << kind << " (rtlsdr, file, synth)\n";
+        return nullptr;
+    }
+
+    double speed = 1.0, start_sec = 0.0, snr_db = DEFAULT_SYNTH_SNR_DB;
+    uint32_t rate = 0, drop_every = 0;
+    bool loop = false;
+    std::string profile;
+    for (const std::string& field : fields) {
+        if (field.empty()) continue;
+        size_t eq = field.find('=');
+        std::string key = field.substr(0, eq);
+        std::string value = eq == std::string::npos ? std::string() : field.substr(eq + 1);
+        bool is_file = kind == "file";
+        bool has_value = eq != std::string::npos;
+        if (key == "speed" && has_value) {
+            if (!parse_speed(value, speed)) return nullptr;
+        } else if (key == "drop" && has_value) {
+            drop_every = static_cast<uint32_t>(std::stoul(value));
+        } else if (is_file && key == "rate" && has_value) {
+            rate = static_cast<uint32_t>(std::stoul(value));
+        } else if (is_file && key == "start" && has_value) {
+            start_sec = std::stod(value);
+        } else if (is_file && key == "loop" && !has_value) {
+            loop = true;
+        } else if (!is_file && key == "doppler" && has_value) {
+            profile = value;
+        } else if (!is_file && key == "snr" && has_value) {
+            snr_db = std::stod(value);
+        } else if (!is_file && key == "carrier" && has_value) {
+            carrier_hz = static_cast<uint32_t>(std::stoul(value));
+        } else {
+            std::cerr << "Error: Unknown " << kind << " source option: " << field << "\n";
+            return nullptr;
+        }
+    }
+
+    GeneratedSource* source;
+    if (kind == "file") {
+        source = new FileSource(path, speed, rate, start_sec, loop);
+    } else {
+        source = new SynthSource(speed, profile, snr_db, carrier_hz);
+    }
+    source->set_drop_every(drop_every);
+    return std::unique_ptr<SampleSource>(source);
+}
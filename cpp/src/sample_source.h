@@ -0,0 +1,99 @@
+/*
+ * sample_source.h
+ * Satellite Ground Station - I/Q Sample Sources
+ *
+ * What a capture session streams from, behind the same async-callback
+ * shape as rtlsdr_read_async:
+ *
+ *   rtlsdr[:<index>]        RTL-SDR dongle (default; index falls back to -D)
+ *   file:<path>[,opt...]    Replay of a capture: raw u8 .bin, .sigmf-data
+ *                           (rate and tuning from the .sigmf-meta) or .sgc
+ *                           (gaps replayed as mid-scale samples)
+ *       speed=<x|max>       Real-time multiple (default 1), or as fast as
+ *                           the consumer takes it
+ *       rate=<hz>           Sample rate of a raw file (default: requested)
+ *       start=<sec>         Skip into the file
+ *       loop                Start over at the end instead of stopping
+ *       drop=<n>            Lose every n-th transfer before delivery, as
+ *                           a dongle overrun would (tests gap detection)
+ *   synth[:opt...]          Generated NOAA APT signal: 2400 Hz AM subcarrier
+ *                           carrying sync A/B, telemetry wedges and a test
+ *                           pattern, FM-modulated onto the carrier
+ *       speed=<x|max>       As for file
+ *       doppler=<profile>   Doppler curve to apply (default: a built-in
+ *                           15-minute pass, +/-3.2 kHz)
+ *       snr=<db>            Carrier to noise per sample (default 20)
+ *       carrier=<hz>        Carrier frequency (default: the capture frequency)
+ *       drop=<n>            As for file
+ *
+ * Paced sources (rtlsdr, speed=x) deliver at a fixed rate and drop what
+ * the consumer can't take, like the USB stream. With speed=max the
+ * source is lossless(): the callback may block until there is room, so
+ * the pipeline runs at its own maximum throughput.
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#ifndef SATGS_SAMPLE_SOURCE_H
+#define SATGS_SAMPLE_SOURCE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// Same signature as rtlsdr_read_async_cb_t
+typedef void (*SampleCallback)(unsigned char* buf, uint32_t len, void* ctx);
+
+class SampleSource {
+public:
+    virtual ~SampleSource() = default;
+
+    // Acquire the device or open the file
+    virtual bool open() = 0;
+    virtual void close() = 0;
+
+    // Requested settings; the actual values are read back below (a file
+    // keeps the rate and tuning it was recorded with)
+    virtual bool set_sample_rate(uint32_t rate) = 0;
+    virtual bool set_center_freq(uint32_t hz) = 0;
+    virtual bool set_gain(int tenth_db) = 0;    // Manual gain
+
+    virtual uint32_t sample_rate() const = 0;
+    virtual uint32_t center_freq() const = 0;
+    virtual int gain() const = 0;
+
+    // Hardware name or file, for logs and capture metadata
+    virtual std::string name() const = 0;
+
+    // Stable key for what is learned about this receiver (ppm_store.h):
+    // the dongle's USB serial, or the source kind. Plain ASCII, no quotes.
+    virtual std::string device_id() const = 0;
+
+    // Deliver transfers of buffer_size bytes to callback until cancel()
+    // or the end of the data. Blocks; false on a device error.
+    virtual bool stream(SampleCallback callback, void* ctx, uint32_t num_buffers,
+                        uint32_t buffer_size) = 0;
+
+    // End stream(); safe from the callback and from other threads
+    virtual void cancel() = 0;
+
+    // Real-time multiple the source runs at; 0 = as fast as consumed
+    virtual double speed() const { return 1.0; }
+
+    // The callback may wait for room instead of dropping
+    bool lossless() const { return speed() == 0.0; }
+};
+
+// Build a source from a spec as listed above. device_index serves a
+// bare "rtlsdr"; carrier_hz is the default synth carrier.
+std::unique_ptr<SampleSource> create_sample_source(const std::string& spec, int device_index,
+                                                   uint32_t carrier_hz);
+
+// Whether this build has the RTL-SDR backend
+bool rtlsdr_source_available();
+
+// RTL-SDR backend (rtlsdr_source.cpp, only in builds with librtlsdr)
+std::unique_ptr<SampleSource> create_rtlsdr_source(int device_index);
+
+#endif // SATGS_SAMPLE_SOURCE_H
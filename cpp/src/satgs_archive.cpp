@@ -0,0 +1,811 @@
+/*
+ * satgs_archive.cpp
+ * Satellite Ground Station - Capture Archive Queries and Seeks
+ *
+ *   satgs_archive query [-S <satellite>] [--from <utc>] [--to <utc>]
+ *                       [--last <N>d|h] [--min-el <deg>] [--decoded]
+ *                       [-n <limit>] [--json]
+ *       Passes from the index (archive_index.h), e.g. every NOAA 18 pass
+ *       above 40 deg in the last 30 days: -S "NOAA 18" --min-el 40 --last 30d
+ *
+ *   satgs_archive seek [--json] <capture> <time>
+ *       Sample and file offset of an instant in a capture: a UTC time,
+ *       HH:MM:SS on the capture's day or +<sec> from its start. With no
+ *       full UTC the capture is located by its modification time.
+ *
+ *   satgs_archive add --satellite <name> --aos <utc> --los <utc> [...]
+ *       Index one pass; the capture pipeline calls this after a pass.
+ *
+ *   satgs_archive rebuild [--mission-log <json>] [--decoded-dir <dir>]
+ *                         [--doppler-dir <dir>]
+ *       Rewrite the index from mission_log.json and the decoders'
+ *       *_metadata.json, for history from before the index existed.
+ *       Passes the log doesn't time are placed by their Doppler profile
+ *       or the AOS stamp in their file names; decoder metadata no log
+ *       entry claims is indexed on its own.
+ *
+ *   satgs_archive info
+ *
+ * Every command takes -I <index> (default data/archive.sgi). Nothing but
+ * the index is read by query and seek.
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <set>
+#include <getopt.h>
+#include <sys/stat.h>
+
+#include "archive_index.h"
+#include "cli_util.h"
+#include "doppler_profile.h"
+#include "json_reader.h"
+#include "mapped_file.h"
+
+#define DEFAULT_INDEX         "data/archive.sgi"
+#define DEFAULT_MISSION_LOG   "data/mission_log.json"
+#define DEFAULT_DECODED_DIR   "data/decoded"
+#define DEFAULT_DOPPLER_DIR   "data/doppler"
+#define DEFAULT_SAMPLE_RATE   2400000
+
+static bool file_exists(const std::string& path) {
+    struct stat st;
+    return !path.empty() && stat(path.c_str(), &st) == 0;
+}
+
+static std::string base_name(const std::string& path) {
+    size_t slash = path.find_last_of('/');
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+static std::string stem(const std::string& path) {
+    std::string name = base_name(path);
+    size_t dot = name.find_last_of('.');
+    return dot == std::string::npos ? name : name.substr(0, dot);
+}
+
+static bool ends_with(const std::string& text, const std::string& suffix) {
+    return text.size() > suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// ISO 8601 UTC or Unix seconds
+static bool parse_time(const std::string& text, double& unix_sec) {
+    if (text.find('T') != std::string::npos || text.find('-') != std::string::npos) {
+        return parse_utc_timestamp(text, unix_sec);
+    }
+    char* end = nullptr;
+    unix_sec = std::strtod(text.c_str(), &end);
+    return !text.empty() && *end == '\0';
+}
+
+// ----------------------------------------------------------------------------
+// Metadata and mission log
+// ----------------------------------------------------------------------------
+
+// Satellite and AOS from a capture or product named
+// <SATELLITE>_<YYYYMMDD>_<HHMMSS>[_suffix] (schedule_captures.py names
+// them after the AOS, UTC)
+static bool name_stamp(const std::string& name, std::string& satellite, double& aos_unix) {
+    const std::string s = stem(name);
+    for (size_t i = 0; i + 16 <= s.size(); i++) {
+        if (s[i] != '_' || s[i + 9] != '_' || (i + 16 < s.size() && s[i + 16] != '_')) continue;
+        bool digits = true;
+        for (size_t k = i + 1; k < i + 16; k++) {
+            digits = digits && (k == i + 9 || std::isdigit(static_cast<unsigned char>(s[k])));
+        }
+        if (!digits || i == 0) continue;
+        const std::string iso = s.substr(i + 1, 4) + "-" + s.substr(i + 5, 2) + "-" + s.substr(i + 7, 2) + "T" +
+                                s.substr(i + 10, 2) + ":" + s.substr(i + 12, 2) + ":" + s.substr(i + 14, 2) + "Z";
+        if (!parse_utc_timestamp(iso, aos_unix)) return false;
+        satellite = s.substr(0, i);
+        std::replace(satellite.begin(), satellite.end(), '_', ' ');
+        return true;
+    }
+    return false;
+}
+
+// decode_apt.py / satgs_reprocess *_metadata.json: quality and products
+static bool read_metadata(const std::string& path, ArchiveEntry& entry, uint32_t& sample_rate,
+                          double& duration_sec) {
+    MappedFile file;
+    if (!file.open(path)) return false;
+    JsonReader json(file.data(), file.size());
+    std::string_view key, text;
+    double value;
+    if (!json.begin_object()) return false;
+    while (json.next_key(key)) {
+        const char c = json.peek();
+        if (c == '"' && (key == "output_file" || key == "doppler_profile" || key == "input_file")) {
+            // What the entry already names wins: the metadata's paths may be another host's
+            std::string& field = key == "output_file" ? entry.image_file
+                               : key == "doppler_profile" ? entry.doppler_file : entry.capture_file;
+            json.read_string(text);
+            if (field.empty()) field.assign(text);
+        } else if (c == '"' && key == "decoder" && entry.source.empty()) {
+            json.read_string(text);
+            entry.source.assign(text);
+        } else if (c == 'n' && json.read_number(value)) {
+            if (key == "snr_db") entry.snr_db = value;
+            else if (key == "sync_rate") entry.sync_rate = value;
+            else if (key == "sync_pulses_found") entry.image_lines = static_cast<uint32_t>(value);
+            else if (key == "sample_rate_hz") sample_rate = static_cast<uint32_t>(value);
+            else if (key == "duration_sec") duration_sec = value;
+        } else {
+            json.skip_value();
+        }
+    }
+    if (!json.ok()) {
+        std::cerr << "Warning: Malformed metadata at offset " << json.error_offset() << ": " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Capture timing and seek table; a raw capture without a known start is
+// taken to have ended when it was last written
+static void describe_capture(ArchiveEntry& entry, uint32_t sample_rate, double capture_start) {
+    struct stat st;
+    if (entry.capture_file.empty() || stat(entry.capture_file.c_str(), &st) != 0) return;
+    const double raw_length = static_cast<double>(st.st_size) / 2.0 / sample_rate;
+    if (capture_start <= 0.0) capture_start = static_cast<double>(st.st_mtime) - raw_length;
+    if (!archive_describe_capture(entry.capture_file, sample_rate, capture_start, entry)) {
+        entry.capture_start_utc = 0.0;
+        entry.capture_samples = 0;
+    }
+}
+
+// The decoder's metadata for a pass: next to its image, or named after
+// the capture in decoded_dir
+static std::string metadata_path(const ArchiveEntry& entry, const std::string& decoded_dir) {
+    const std::string suffix = "_decoded.png";
+    const std::string& image = entry.image_file;
+    if (image.size() > suffix.size() && image.compare(image.size() - suffix.size(), suffix.size(), suffix) == 0) {
+        std::string path = image.substr(0, image.size() - suffix.size()) + "_metadata.json";
+        if (file_exists(path)) return path;
+    }
+    if (!entry.capture_file.empty()) {
+        std::string path = decoded_dir + "/" + stem(entry.capture_file) + "_metadata.json";
+        if (file_exists(path)) return path;
+    }
+    return "";
+}
+
+// AOS, LOS and carrier from a doppler_calc.py / satgs_scheduler profile,
+// where the entry doesn't have them yet
+static bool read_doppler_times(const std::string& path, ArchiveEntry& entry) {
+    MappedFile file;
+    if (!file.open(path)) return false;
+    JsonReader json(file.data(), file.size());
+    std::string_view key, text;
+    double value, t;
+    if (!json.begin_object()) return false;
+    while (json.next_key(key)) {
+        const char c = json.peek();
+        if (c == '"' && (key == "aos_utc" || key == "los_utc")) {
+            json.read_string(text);
+            double& field = key == "aos_utc" ? entry.aos_unix : entry.los_unix;
+            if (field == 0.0 && parse_utc_timestamp(std::string(text), t)) field = t;
+        } else if (c == 'n' && key == "center_freq_hz" && json.read_number(value)) {
+            if (entry.freq_hz == 0.0) entry.freq_hz = value;
+        } else {
+            json.skip_value();
+        }
+    }
+    return json.ok();
+}
+
+// A product path written on another host: the file of that name in dir
+static void relocate(std::string& path, const std::string& dir) {
+    if (path.empty() || file_exists(path)) return;
+    std::string local = dir + "/" + base_name(path);
+    if (file_exists(local)) path = local;
+}
+
+// Fill in what a pass record leaves out from the files around it: the
+// decoder's metadata (found from the entry unless given), then AOS/LOS
+// from the Doppler profile, else AOS from the capture's name stamp, else
+// fallback_aos, and LOS from the decoded length. Returns the metadata
+// read ("" when none).
+static std::string complete_entry(ArchiveEntry& entry, double fallback_aos, std::string meta,
+                                  const std::string& decoded_dir, const std::string& doppler_dir,
+                                  uint32_t sample_rate) {
+    double duration = 0.0;
+    if (meta.empty()) meta = metadata_path(entry, decoded_dir);
+    if (!meta.empty() && !read_metadata(meta, entry, sample_rate, duration)) meta.clear();
+    relocate(entry.image_file, decoded_dir);
+    relocate(entry.doppler_file, doppler_dir);
+
+    // Products share the capture's name stem, or the metadata's
+    std::string name = !entry.capture_file.empty() ? stem(entry.capture_file) : stem(meta);
+    const std::string meta_suffix = "_metadata";
+    if (entry.capture_file.empty() && ends_with(name, meta_suffix)) name.resize(name.size() - meta_suffix.size());
+    if (entry.doppler_file.empty() && !name.empty()) {
+        std::string path = doppler_dir + "/" + name + "_doppler.json";
+        if (file_exists(path)) entry.doppler_file = path;
+    }
+    if (file_exists(entry.doppler_file)) read_doppler_times(entry.doppler_file, entry);
+
+    std::string satellite;
+    double stamp;
+    if (name_stamp(name, satellite, stamp)) {
+        if (entry.aos_unix == 0.0) entry.aos_unix = stamp;
+        if (entry.satellite.empty()) entry.satellite = satellite;
+    }
+    if (entry.aos_unix == 0.0) entry.aos_unix = fallback_aos;
+    if (entry.los_unix == 0.0 && duration > 0.0 && entry.aos_unix != 0.0) entry.los_unix = entry.aos_unix + duration;
+
+    describe_capture(entry, sample_rate, 0.0);
+    return meta;
+}
+
+// mission_log.json entries as written by schedule_captures.py,
+// satcom_server.py and satgs_scheduler. schedule_captures.py logs no
+// AOS: its entries are completed from their products, else placed at
+// the time the job ran. The metadata taken is added to used.
+static bool read_mission_log(const std::string& path, const std::string& decoded_dir, const std::string& doppler_dir,
+                             uint32_t default_rate, std::vector<ArchiveEntry>& out, std::set<std::string>& used) {
+    MappedFile file;
+    if (!file.open(path)) {
+        std::cerr << "Error: Cannot read mission log: " << path << std::endl;
+        return false;
+    }
+    JsonReader json(file.data(), file.size());
+    std::string_view key, text;
+    size_t skipped = 0;
+    if (!json.begin_array()) {
+        std::cerr << "Error: Mission log is not a JSON array: " << path << std::endl;
+        return false;
+    }
+    while (json.next_element()) {
+        ArchiveEntry e;
+        bool captured = false, decoded = false;
+        double started = 0.0, completed = 0.0;
+        std::string decoded_image;
+        if (!json.begin_object()) break;
+        while (json.next_key(key)) {
+            const char c = json.peek();
+            if (c == '"') {
+                json.read_string(text);
+                double t;
+                if (key == "satellite") e.satellite.assign(text);
+                else if (key == "aos_utc" && parse_utc_timestamp(std::string(text), t)) e.aos_unix = t;
+                else if (key == "los_utc" && parse_utc_timestamp(std::string(text), t)) e.los_unix = t;
+                else if (key == "timestamp" && parse_utc_timestamp(std::string(text), t)) started = t;
+                else if (key == "completed" && parse_utc_timestamp(std::string(text), t)) completed = t;
+                else if (key == "capture_file") e.capture_file.assign(text);
+                else if (key == "image_file") e.image_file.assign(text);
+                else if (key == "decoded_image") decoded_image.assign(text);
+                else if (key == "scheduler") e.source.assign(text);
+            } else if (c == 't' || c == 'f') {
+                if (key == "capture_success") captured = c == 't';
+                else if (key == "decode_success") decoded = c == 't';
+                json.skip_value();
+            } else if (c == 'n') {
+                double value;
+                json.read_number(value);
+                if (key == "max_elevation_deg") e.max_elevation_deg = value;
+                else if (key == "snr_db") e.snr_db = value;
+                else if (key == "sync_pulses_found") e.image_lines = static_cast<uint32_t>(value);
+            } else {
+                json.skip_value();
+            }
+        }
+        if (e.satellite.empty()) {
+            skipped++;
+            continue;
+        }
+        if (e.image_file.empty() && !decoded_image.empty()) e.image_file = decoded_dir + "/" + decoded_image;
+        if (e.source.empty()) e.source = "mission_log";
+
+        std::string meta = complete_entry(e, started, "", decoded_dir, doppler_dir, default_rate);
+        if (e.aos_unix == 0.0) {
+            skipped++;
+            continue;
+        }
+        if (!meta.empty()) used.insert(base_name(meta));
+        if (e.los_unix < e.aos_unix) e.los_unix = std::max(completed, e.aos_unix);
+        e.flags = (captured ? ARCHIVE_CAPTURED : 0) | (decoded ? ARCHIVE_DECODED : 0);
+        out.push_back(e);
+    }
+    if (!json.ok()) {
+        std::cerr << "Error: Malformed mission log at offset " << json.error_offset() << ": " << path << std::endl;
+        return false;
+    }
+    if (skipped) std::cerr << "Warning: " << skipped << " mission log entries without satellite or AOS" << std::endl;
+    return true;
+}
+
+// Decoder metadata in decoded_dir that no mission log entry took: passes
+// decoded by hand, or from before the log
+static void read_decoded_dir(const std::string& decoded_dir, const std::string& doppler_dir, uint32_t default_rate,
+                             const std::set<std::string>& used, std::vector<ArchiveEntry>& out) {
+    std::vector<std::string> paths;
+    std::error_code ec;
+    for (const auto& file : std::filesystem::directory_iterator(decoded_dir, ec)) {
+        const std::string name = file.path().filename().string();
+        if (ends_with(name, "_metadata.json") && !used.count(name)) paths.push_back(decoded_dir + "/" + name);
+    }
+    std::sort(paths.begin(), paths.end());
+    size_t skipped = 0;
+    for (const std::string& path : paths) {
+        ArchiveEntry e;
+        if (complete_entry(e, 0.0, path, decoded_dir, doppler_dir, default_rate).empty() || e.aos_unix == 0.0 ||
+            e.satellite.empty()) {
+            skipped++;
+            continue;
+        }
+        if (e.los_unix < e.aos_unix) e.los_unix = e.aos_unix;
+        if (e.source.empty()) e.source = "metadata";
+        e.flags = ARCHIVE_CAPTURED | ARCHIVE_DECODED;
+        out.push_back(e);
+    }
+    if (skipped) std::cerr << "Warning: " << skipped << " decoder metadata files without satellite or AOS" << std::endl;
+}
+
+// ----------------------------------------------------------------------------
+// Output
+// ----------------------------------------------------------------------------
+
+static std::string json_number(double value, int precision) {
+    if (!std::isfinite(value)) return "null";
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(precision) << value;
+    return out.str();
+}
+
+static std::string json_time(double unix_sec) {
+    return unix_sec > 0.0 ? json_string(format_utc_timestamp(unix_sec)) : "null";
+}
+
+static std::string json_path(const std::string& path) {
+    return path.empty() ? "null" : json_string(path);
+}
+
+// Field names follow mission_log.json so the HMI reads either
+static std::string entry_json(const ArchiveEntry& e) {
+    std::ostringstream out;
+    out << "{\"satellite\": " << json_string(e.satellite)
+        << ", \"aos_utc\": " << json_time(e.aos_unix)
+        << ", \"los_utc\": " << json_time(e.los_unix)
+        << ", \"tca_utc\": " << json_time(e.tca_unix)
+        << ", \"max_elevation_deg\": " << json_number(e.max_elevation_deg, 1)
+        << ", \"duration_sec\": " << json_number(e.los_unix - e.aos_unix, 1)
+        << ", \"frequency_hz\": " << json_number(e.freq_hz, 0)
+        << ", \"capture_success\": " << (e.flags & ARCHIVE_CAPTURED ? "true" : "false")
+        << ", \"decode_success\": " << (e.flags & ARCHIVE_DECODED ? "true" : "false")
+        << ", \"capture_file\": " << json_path(e.capture_file)
+        << ", \"image_file\": " << json_path(e.image_file)
+        << ", \"decoded_image\": " << json_path(e.image_file.empty() ? "" : base_name(e.image_file))
+        << ", \"doppler_profile\": " << json_path(e.doppler_file)
+        << ", \"snr_db\": " << json_number(e.snr_db, 1)
+        << ", \"sync_rate\": " << json_number(e.sync_rate, 3)
+        << ", \"sync_pulses_found\": " << e.image_lines
+        << ", \"capture_start_utc\": " << json_time(e.capture_start_utc)
+        << ", \"capture_sec\": "
+        << json_number(e.sample_rate ? static_cast<double>(e.capture_samples) / e.sample_rate : NAN, 1)
+        << ", \"source\": " << json_path(e.source)
+        << ", \"timestamp\": " << json_time(e.indexed_unix) << "}";
+    return out.str();
+}
+
+static std::string short_time(double unix_sec) {
+    std::string text = format_utc_timestamp(unix_sec);
+    return text.substr(0, 10) + " " + text.substr(11, 8);
+}
+
+static void print_table(const ArchiveIndex& index, const std::vector<size_t>& rows) {
+    std::cout << std::left << std::setw(20) << "AOS (UTC)" << std::setw(14) << "Satellite" << std::right
+              << std::setw(7) << "Max el" << std::setw(7) << "Dur" << std::setw(8) << "SNR" << std::setw(7)
+              << "Lines" << "  Image / capture\n";
+    ArchiveEntry e;
+    for (size_t i : rows) {
+        if (!index.entry(i, e)) continue;
+        std::cout << std::left << std::setw(20) << short_time(e.aos_unix) << std::setw(14) << e.satellite
+                  << std::right << std::fixed << std::setprecision(1) << std::setw(7) << e.max_elevation_deg
+                  << std::setw(7) << (e.los_unix - e.aos_unix) / 60.0 << std::setw(8);
+        if (std::isfinite(e.snr_db)) std::cout << e.snr_db;
+        else std::cout << "-";
+        std::cout << std::setw(7) << e.image_lines << "  ";
+        if (e.flags & ARCHIVE_DECODED && !e.image_file.empty()) std::cout << e.image_file << "\n";
+        else if (!e.capture_file.empty()) std::cout << e.capture_file << "\n";
+        else std::cout << (e.flags & ARCHIVE_CAPTURED ? "(captured, no I/Q kept)\n" : "(failed)\n");
+    }
+    std::cout << rows.size() << " passes\n";
+}
+
+// ----------------------------------------------------------------------------
+// Commands
+// ----------------------------------------------------------------------------
+
+static int run_info(const std::string& index_path) {
+    ArchiveIndex index;
+    if (!index.open(index_path)) return 1;
+    size_t captured = 0, decoded = 0, seekable = 0;
+    std::vector<std::string> satellites;
+    ArchiveEntry e;
+    double first = 1e300, last = -1e300;
+    for (size_t i = 0; i < index.size(); i++) {
+        if (!index.entry(i, e)) continue;
+        if (e.flags & ARCHIVE_CAPTURED) captured++;
+        if (e.flags & ARCHIVE_DECODED) decoded++;
+        if (e.capture_start_utc > 0.0 && e.sample_rate) seekable++;
+        if (std::find(satellites.begin(), satellites.end(), e.satellite) == satellites.end()) {
+            satellites.push_back(e.satellite);
+        }
+        first = std::min(first, e.aos_unix);
+        last = std::max(last, e.aos_unix);
+    }
+    std::cout << "Archive: " << index_path << "\n";
+    std::cout << "  Passes:     " << index.size() << " (" << captured << " captured, " << decoded << " decoded, "
+              << seekable << " seekable captures)\n";
+    if (index.size()) {
+        std::cout << "  Span:       " << format_utc_timestamp(first) << " to " << format_utc_timestamp(last) << "\n";
+        std::cout << "  Satellites:";
+        for (const std::string& s : satellites) std::cout << " " << s << (&s == &satellites.back() ? "" : ",");
+        std::cout << "\n";
+    }
+    return 0;
+}
+
+static int run_query(const std::string& index_path, const ArchiveQuery& q, bool json) {
+    ArchiveIndex index;
+    if (!index.open(index_path)) return 1;
+    std::vector<size_t> rows = index.query(q);
+    if (!json) {
+        print_table(index, rows);
+        return 0;
+    }
+    std::ostringstream out;
+    out << "[";
+    ArchiveEntry e;
+    bool first = true;
+    for (size_t i : rows) {
+        if (!index.entry(i, e)) continue;
+        out << (first ? "\n  " : ",\n  ") << entry_json(e);
+        first = false;
+    }
+    out << (first ? "]\n" : "\n]\n");
+    std::cout << out.str();
+    return 0;
+}
+
+static bool same_capture(const std::string& a, const std::string& b) {
+    return a == b || base_name(a) == base_name(b);
+}
+
+static int run_seek(const std::string& index_path, const std::string& capture, const std::string& when, bool json) {
+    ArchiveIndex index;
+    if (!index.open(index_path)) return 1;
+
+    // With a full UTC time the records covering it are a range search;
+    // otherwise the capture ended when it was last written
+    double utc = 0.0, hint = 0.0;
+    const bool absolute = when.find('T') != std::string::npos;
+    if (absolute && !parse_utc_timestamp(when, utc)) {
+        std::cerr << "Error: Bad time: " << when << std::endl;
+        return 1;
+    }
+    struct stat st;
+    if (absolute) hint = utc;
+    else if (stat(capture.c_str(), &st) == 0) hint = static_cast<double>(st.st_mtime) - 1.0;
+
+    std::vector<size_t> candidates;
+    if (hint > 0.0) index.covering(hint, candidates);
+    ArchiveEntry e;
+    size_t found = index.size();
+    for (size_t i : candidates) {
+        if (index.entry(i, e) && same_capture(e.capture_file, capture)) {
+            found = i;
+            break;
+        }
+    }
+    for (size_t i = 0; found == index.size() && i < index.size(); i++) {
+        if (index.entry(i, e) && same_capture(e.capture_file, capture)) found = i;
+    }
+    if (found == index.size() || !index.entry(found, e) || e.capture_start_utc <= 0.0 || e.sample_rate == 0) {
+        std::cerr << "Error: No indexed timing for capture: " << capture << std::endl;
+        return 1;
+    }
+
+    if (!absolute && !when.empty() && when[0] == '+') {
+        utc = e.capture_start_utc + std::atof(when.c_str() + 1);
+    } else if (!absolute) {
+        int h = 0, m = 0;
+        double s = 0.0;
+        if (std::sscanf(when.c_str(), "%d:%d:%lf", &h, &m, &s) < 2) {
+            std::cerr << "Error: Bad time: " << when << std::endl;
+            return 1;
+        }
+        utc = std::floor(e.capture_start_utc / 86400.0) * 86400.0 + h * 3600.0 + m * 60.0 + s;
+        if (utc < e.capture_start_utc) utc += 86400.0;      // Capture ran past midnight
+    }
+
+    ArchiveSeek where;
+    const double length = static_cast<double>(e.capture_samples) / e.sample_rate;
+    if (!index.seek(found, utc, where)) {
+        std::cerr << "Error: " << format_utc_timestamp(utc) << " is outside " << e.capture_file << " ("
+                  << format_utc_timestamp(e.capture_start_utc) << " + " << std::fixed << std::setprecision(1)
+                  << length << " s)" << std::endl;
+        return 1;
+    }
+    const bool sgc = e.flags & ARCHIVE_SGC;
+    const double into = static_cast<double>(where.sample) / e.sample_rate;
+    if (json) {
+        std::cout << "{\"capture_file\": " << json_string(e.capture_file)
+                  << ", \"satellite\": " << json_string(e.satellite)
+                  << ", \"utc\": " << json_time(utc)
+                  << ", \"offset_sec\": " << json_number(into, 6)
+                  << ", \"sample\": " << where.sample
+                  << ", \"file_offset\": " << where.offset
+                  << ", \"skip_samples\": " << where.skip
+                  << ", \"format\": " << (sgc ? "\"sgc\"" : "\"raw\"") << "}\n";
+        return 0;
+    }
+    std::cout << "Capture: " << e.capture_file << " (" << e.satellite << ", AOS " << short_time(e.aos_unix) << ")\n"
+              << "  Instant: " << format_utc_timestamp(utc) << ", " << std::fixed << std::setprecision(3) << into
+              << " s in\n"
+              << "  Sample:  " << where.sample << "\n";
+    if (sgc) {
+        std::cout << "  Offset:  frame at byte " << where.offset << ", then " << where.skip << " samples\n";
+    } else {
+        std::cout << "  Offset:  byte " << where.offset << "\n";
+    }
+    return 0;
+}
+
+static int run_rebuild(const std::string& index_path, const std::string& mission_log, const std::string& decoded_dir,
+                       const std::string& doppler_dir, uint32_t sample_rate) {
+    std::vector<ArchiveEntry> entries;
+    std::set<std::string> used;
+    if (!read_mission_log(mission_log, decoded_dir, doppler_dir, sample_rate, entries, used)) return 1;
+    const size_t logged = entries.size();
+    read_decoded_dir(decoded_dir, doppler_dir, sample_rate, used, entries);
+    std::stable_sort(entries.begin(), entries.end(),
+                     [](const ArchiveEntry& a, const ArchiveEntry& b) { return a.aos_unix < b.aos_unix; });
+
+    // Built aside, so readers see the old index until the new one is whole
+    const std::string tmp = index_path + ".tmp";
+    std::remove(tmp.c_str());
+    std::remove((tmp + ARCHIVE_BLOB_SUFFIX).c_str());
+    if (!archive_append(tmp, entries) ||
+        std::rename((tmp + ARCHIVE_BLOB_SUFFIX).c_str(), (index_path + ARCHIVE_BLOB_SUFFIX).c_str()) != 0 ||
+        std::rename(tmp.c_str(), index_path.c_str()) != 0) {
+        std::cerr << "Error: Failed writing " << index_path << std::endl;
+        return 1;
+    }
+    size_t seekable = 0;
+    for (const ArchiveEntry& e : entries) seekable += e.capture_samples > 0;
+    std::cout << "Indexed " << entries.size() << " passes (" << logged << " from the mission log, "
+              << entries.size() - logged << " from decoder metadata only, " << seekable << " with capture timing) into "
+              << index_path << "\n";
+    return 0;
+}
+
+void print_usage(const char* progname) {
+    std::cout << "Usage: " << progname << " query [options]\n"
+              << "       " << progname << " seek [--json] <capture> <time>\n"
+              << "       " << progname << " add --satellite <name> --aos <utc> --los <utc> [options]\n"
+              << "       " << progname << " rebuild [options]\n"
+              << "       " << progname << " info\n"
+              << "\nTime-indexed archive of passes and captures, answered from the index alone.\n"
+              << "\nOptions:\n"
+              << "  -I <file>           Archive index (default: " << DEFAULT_INDEX << ")\n"
+              << "  --json              Output JSON (query, seek)\n"
+              << "\nQuery:\n"
+              << "  -S <name>           Satellite name substring (case-insensitive)\n"
+              << "  --from <utc>        AOS at or after (ISO 8601 or Unix seconds)\n"
+              << "  --to <utc>          AOS before\n"
+              << "  --last <N>d|h       AOS within the last N days / hours\n"
+              << "  --min-el <deg>      Minimum max elevation\n"
+              << "  --decoded           Decoded passes only\n"
+              << "  -n <count>          Newest <count> passes (default: all, oldest first)\n"
+              << "\nSeek time: UTC (2026-02-14T18:05:10Z), HH:MM:SS on the capture's day, or +<sec>\n"
+              << "\nAdd:\n"
+              << "  --tca <utc>, --max-el <deg>, --freq <hz>, --norad <id>\n"
+              << "  --capture <file>    Recorded I/Q (.sgc or raw u8); timing and seek table are indexed\n"
+              << "  --capture-start <utc>  Raw capture's first sample (default: mtime minus its length)\n"
+              << "  -s <rate>           Raw capture sample rate (default: " << DEFAULT_SAMPLE_RATE << ")\n"
+              << "  --image <png>, --doppler <file>, --source <tool>\n"
+              << "  --metadata <json>   Decoder *_metadata.json (SNR, sync rate, lines, image)\n"
+              << "  --captured, --decoded  Outcome flags\n"
+              << "\nRebuild:\n"
+              << "  --mission-log <json>  Mission history (default: " << DEFAULT_MISSION_LOG << ")\n"
+              << "  --decoded-dir <dir>   Decoder metadata (default: " << DEFAULT_DECODED_DIR << ")\n"
+              << "  --doppler-dir <dir>   Doppler profiles, for pass times (default: " << DEFAULT_DOPPLER_DIR << ")\n"
+              << "  -h, --help          Show this help\n";
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    std::string command = argv[1];
+    if (command == "-h" || command == "--help") {
+        print_usage(argv[0]);
+        return 0;
+    }
+
+    enum {
+        OPT_FROM = 256, OPT_TO, OPT_LAST, OPT_MIN_EL, OPT_DECODED, OPT_JSON, OPT_SATELLITE, OPT_AOS, OPT_LOS,
+        OPT_TCA, OPT_FREQ, OPT_NORAD, OPT_CAPTURE, OPT_CAPTURE_START, OPT_IMAGE, OPT_DOPPLER, OPT_SOURCE,
+        OPT_METADATA, OPT_CAPTURED, OPT_MISSION_LOG, OPT_DECODED_DIR, OPT_DOPPLER_DIR
+    };
+    static const struct option long_options[] = {
+        {"from", required_argument, nullptr, OPT_FROM},
+        {"to", required_argument, nullptr, OPT_TO},
+        {"last", required_argument, nullptr, OPT_LAST},
+        {"min-el", required_argument, nullptr, OPT_MIN_EL},
+        {"decoded", no_argument, nullptr, OPT_DECODED},
+        {"json", no_argument, nullptr, OPT_JSON},
+        {"satellite", required_argument, nullptr, OPT_SATELLITE},
+        {"aos", required_argument, nullptr, OPT_AOS},
+        {"los", required_argument, nullptr, OPT_LOS},
+        {"tca", required_argument, nullptr, OPT_TCA},
+        {"max-el", required_argument, nullptr, OPT_MIN_EL},
+        {"freq", required_argument, nullptr, OPT_FREQ},
+        {"norad", required_argument, nullptr, OPT_NORAD},
+        {"capture", required_argument, nullptr, OPT_CAPTURE},
+        {"capture-start", required_argument, nullptr, OPT_CAPTURE_START},
+        {"image", required_argument, nullptr, OPT_IMAGE},
+        {"doppler", required_argument, nullptr, OPT_DOPPLER},
+        {"source", required_argument, nullptr, OPT_SOURCE},
+        {"metadata", required_argument, nullptr, OPT_METADATA},
+        {"captured", no_argument, nullptr, OPT_CAPTURED},
+        {"mission-log", required_argument, nullptr, OPT_MISSION_LOG},
+        {"decoded-dir", required_argument, nullptr, OPT_DECODED_DIR},
+        {"doppler-dir", required_argument, nullptr, OPT_DOPPLER_DIR},
+        {"help", no_argument, nullptr, 'h'},
+        {nullptr, 0, nullptr, 0}
+    };
+
+    std::string index_path = DEFAULT_INDEX;
+    std::string mission_log = DEFAULT_MISSION_LOG;
+    std::string decoded_dir = DEFAULT_DECODED_DIR;
+    std::string doppler_dir = DEFAULT_DOPPLER_DIR;
+    std::string metadata;
+    ArchiveQuery q;
+    ArchiveEntry e;
+    double el = NAN, capture_start = 0.0;
+    uint32_t sample_rate = DEFAULT_SAMPLE_RATE;
+    bool json = false, decoded = false, captured = false, times_ok = true;
+
+    int opt;
+    optind = 2;
+    while ((opt = getopt_long(argc, argv, "I:S:n:s:h", long_options, nullptr)) != -1) {
+        switch (opt) {
+            case 'I':
+                index_path = optarg;
+                break;
+            case 'S':
+            case OPT_SATELLITE:
+                q.satellite = e.satellite = optarg;
+                break;
+            case 'n':
+                q.limit = static_cast<size_t>(std::atol(optarg));
+                break;
+            case 's':
+                sample_rate = static_cast<uint32_t>(std::stod(optarg));
+                break;
+            case OPT_FROM:
+                times_ok = parse_time(optarg, q.from_unix) && times_ok;
+                break;
+            case OPT_TO:
+                times_ok = parse_time(optarg, q.to_unix) && times_ok;
+                break;
+            case OPT_LAST: {
+                std::string span = optarg;
+                double n = std::atof(span.c_str());
+                q.from_unix = utc_now() - n * (span.back() == 'h' ? 3600.0 : 86400.0);
+                break;
+            }
+            case OPT_MIN_EL:
+                el = std::stod(optarg);
+                break;
+            case OPT_DECODED:
+                decoded = true;
+                break;
+            case OPT_JSON:
+                json = true;
+                break;
+            case OPT_AOS:
+                times_ok = parse_time(optarg, e.aos_unix) && times_ok;
+                break;
+            case OPT_LOS:
+                times_ok = parse_time(optarg, e.los_unix) && times_ok;
+                break;
+            case OPT_TCA:
+                times_ok = parse_time(optarg, e.tca_unix) && times_ok;
+                break;
+            case OPT_FREQ:
+                e.freq_hz = std::stod(optarg);
+                break;
+            case OPT_NORAD:
+                e.norad_id = std::atoi(optarg);
+                break;
+            case OPT_CAPTURE:
+                e.capture_file = optarg;
+                break;
+            case OPT_CAPTURE_START:
+                times_ok = parse_time(optarg, capture_start) && times_ok;
+                break;
+            case OPT_IMAGE:
+                e.image_file = optarg;
+                break;
+            case OPT_DOPPLER:
+                e.doppler_file = optarg;
+                break;
+            case OPT_SOURCE:
+                e.source = optarg;
+                break;
+            case OPT_METADATA:
+                metadata = optarg;
+                break;
+            case OPT_CAPTURED:
+                captured = true;
+                break;
+            case OPT_MISSION_LOG:
+                mission_log = optarg;
+                break;
+            case OPT_DECODED_DIR:
+                decoded_dir = optarg;
+                break;
+            case OPT_DOPPLER_DIR:
+                doppler_dir = optarg;
+                break;
+            case 'h':
+            default:
+                print_usage(argv[0]);
+                return (opt == 'h') ? 0 : 1;
+        }
+    }
+    if (!times_ok) {
+        std::cerr << "Error: Bad time (expected ISO 8601 UTC or Unix seconds)" << std::endl;
+        return 1;
+    }
+
+    const int args = argc - optind;
+    if (command == "info" && args == 0) {
+        return run_info(index_path);
+    }
+    if (command == "query" && args == 0) {
+        if (std::isfinite(el)) q.min_elevation_deg = el;
+        q.decoded_only = decoded;
+        return run_query(index_path, q, json);
+    }
+    if (command == "seek" && args == 2) {
+        return run_seek(index_path, argv[optind], argv[optind + 1], json);
+    }
+    if (command == "rebuild" && args == 0) {
+        return run_rebuild(index_path, mission_log, decoded_dir, doppler_dir, sample_rate);
+    }
+    if (command == "add" && args == 0) {
+        if (e.satellite.empty() || e.aos_unix == 0.0 || e.los_unix == 0.0) {
+            std::cerr << "Error: add needs --satellite, --aos and --los" << std::endl;
+            return 1;
+        }
+        if (std::isfinite(el)) e.max_elevation_deg = el;
+        if (e.source.empty()) e.source = "satgs_archive";
+        double duration = 0.0;
+        if (!metadata.empty() && !read_metadata(metadata, e, sample_rate, duration)) {
+            std::cerr << "Warning: Cannot read metadata: " << metadata << std::endl;
+        }
+        e.flags = (captured || !e.capture_file.empty() ? ARCHIVE_CAPTURED : 0) | (decoded ? ARCHIVE_DECODED : 0);
+        describe_capture(e, sample_rate, capture_start);
+        return archive_append(index_path, {e}) ? 0 : 1;
+    }
+    print_usage(argv[0]);
+    return 1;
+}
@@ -0,0 +1,1118 @@
+/*
+ * satgs_bench.cpp
+ * Satellite Ground Station - Hot Path Benchmarks
+ *
+ * Replays recorded data through the code the capture and tracking
+ * tools spend their time in, without a dongle:
+ *
+ *   queue/     BufferPool + BufferQueue handoff (callback -> writer)
+ *   writer/    IQWriter backends and capture formats, into --tmp
+ *   sgc/       .sgc frame coding
+ *   dsp/       every kernel table in dsp_kernels.h, DemodPipeline, the
+ *              channelizer and the waterfall spectrum
+ *   apt/       AptDecoder on the WAV audio
+ *   doppler/   DopplerProfile lookups
+ *   json/      Doppler profile loading
+ *
+ * I/Q is a raw u8 capture (--iq, or the first .bin in --data), else one
+ * synthesized by FM-modulating the longest WAV in --data at 2.4 MS/s.
+ * Each benchmark runs for at least -t seconds and reports items/s,
+ * ns/item, the multiple of real time for stream benchmarks, heap
+ * allocations per iteration and p50/p99/max iteration latency (log
+ * histogram, within 25%). --csv saves the results; --baseline compares
+ * against a saved run and exits 1 if anything got slower by more than
+ * --threshold percent.
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <thread>
+#include <filesystem>
+#include <unistd.h>
+#include <getopt.h>
+
+#include "apt_decoder.h"
+#include "buffer_pool.h"
+#include "capture_format.h"
+#include "channelizer.h"
+#include "doppler_profile.h"
+#include "dsp_pipeline.h"
+#include "fft.h"
+#include "iq_file.h"
+#include "json_reader.h"
+#include "latency_histogram.h"
+#include "mapped_file.h"
+#include "sgc_format.h"
+#include "spectrum.h"
+#include "thread_util.h"
+#include "wav_reader.h"
+
+#define BENCH_SAMPLE_RATE     2400000
+#define BENCH_TRANSFER_BYTES  (16 * 16384)  // BUFFER_SIZE of capture_session.h
+#define BENCH_POOL_SLABS      16            // NUM_BUFFERS of capture_session.h
+#define BENCH_IQ_SEC          4.0           // I/Q kept in memory and replayed
+#define BENCH_KERNEL_BLOCK    16384         // Samples per kernel call
+#define BENCH_LOOKUPS         4096          // Doppler lookups per iteration
+#define BENCH_WRITER_MAX_MB   1024          // Cap on data written per writer benchmark
+#define DEFAULT_MIN_TIME      1.0
+#define DEFAULT_THRESHOLD     10.0          // Percent
+
+// ----------------------------------------------------------------------------
+// Allocation counting
+// ----------------------------------------------------------------------------
+
+static std::atomic<uint64_t> g_allocations{0};
+
+// Every replaced operator new and delete goes through this pair, so each
+// allocation is released by the function matching the one that made it
+static void* counted_alloc(size_t size, size_t alignment) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (alignment < sizeof(void*)) alignment = sizeof(void*);
+    void* p = nullptr;
+    return posix_memalign(&p, alignment, size ? size : 1) == 0 ? p : nullptr;
+}
+
+static void counted_free(void* p) {
+    std::free(p);
+}
+
+static void* counted_new(size_t size, size_t alignment) {
+    if (void* p = counted_alloc(size, alignment)) return p;
+    throw std::bad_alloc();
+}
+
+#define DEFAULT_ALIGNMENT  __STDCPP_DEFAULT_NEW_ALIGNMENT__
+
+void* operator new(size_t size) { return counted_new(size, DEFAULT_ALIGNMENT); }
+void* operator new[](size_t size) { return counted_new(size, DEFAULT_ALIGNMENT); }
+void* operator new(size_t size, std::align_val_t align) { return counted_new(size, static_cast<size_t>(align)); }
+void* operator new[](size_t size, std::align_val_t align) { return counted_new(size, static_cast<size_t>(align)); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return counted_alloc(size, DEFAULT_ALIGNMENT); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return counted_alloc(size, DEFAULT_ALIGNMENT); }
+void* operator new(size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return counted_alloc(size, static_cast<size_t>(align));
+}
+void* operator new[](size_t size, std::align_val_t align, const std::nothrow_t&) noexcept {
+    return counted_alloc(size, static_cast<size_t>(align));
+}
+void operator delete(void* p) noexcept { counted_free(p); }
+void operator delete[](void* p) noexcept { counted_free(p); }
+void operator delete(void* p, size_t) noexcept { counted_free(p); }
+void operator delete[](void* p, size_t) noexcept { counted_free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { counted_free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { counted_free(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { counted_free(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { counted_free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { counted_free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { counted_free(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { counted_free(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { counted_free(p); }
+
+// ----------------------------------------------------------------------------
+// Harness
+// ----------------------------------------------------------------------------
+
+static int64_t steady_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Iteration loop of one benchmark:
+//
+//   while (state.next()) { ...one iteration...; state.add_items(n); }
+//
+// Each next() after the first closes an iteration and records its time,
+// unless the benchmark records latencies itself (manual_latency()).
+class BenchState {
+public:
+    BenchState(double min_time_sec, uint64_t max_iterations)
+        : min_ns_(static_cast<int64_t>(min_time_sec * 1e9)), max_iterations_(max_iterations) {}
+
+    bool next() {
+        int64_t now = steady_ns();
+        if (start_ns_ == 0) {
+            start_ns_ = now;
+            last_ns_ = now;
+            alloc_start_ = g_allocations.load(std::memory_order_relaxed);
+            return true;
+        }
+        iterations_++;
+        if (!manual_) latency_.record(static_cast<uint64_t>(now - last_ns_));
+        last_ns_ = now;
+        if (now - start_ns_ >= min_ns_ || iterations_ >= max_iterations_) {
+            stop(now);
+            return false;
+        }
+        return true;
+    }
+
+    // Count work done after the loop (draining queued writes) as part of it
+    void extend_to_now() { stop(steady_ns()); }
+
+    void add_items(uint64_t n) { items_ += n; }
+    void manual_latency() { manual_ = true; }
+    LatencyHistogram& latency() { return latency_; }
+
+    uint64_t iterations() const { return iterations_; }
+    uint64_t items() const { return items_; }
+    uint64_t allocations() const { return allocations_; }
+    double seconds() const { return (end_ns_ - start_ns_) / 1e9; }
+    const LatencyHistogram& latency() const { return latency_; }
+
+private:
+    void stop(int64_t now) {
+        end_ns_ = now;
+        allocations_ = g_allocations.load(std::memory_order_relaxed) - alloc_start_;
+    }
+
+    int64_t min_ns_;
+    uint64_t max_iterations_;
+    int64_t start_ns_ = 0;
+    int64_t last_ns_ = 0;
+    int64_t end_ns_ = 0;
+    uint64_t iterations_ = 0;
+    uint64_t items_ = 0;
+    uint64_t alloc_start_ = 0;
+    uint64_t allocations_ = 0;
+    bool manual_ = false;
+    LatencyHistogram latency_;
+};
+
+struct Benchmark {
+    std::string name;
+    const char* unit;               // What an item is
+    double realtime_rate;           // Items/s of a live capture, 0 if not a stream
+    uint64_t max_iterations;
+    std::function<bool(BenchState&)> run;   // false if it could not run
+};
+
+struct BenchResult {
+    std::string name;
+    std::string unit;
+    uint64_t iterations = 0;
+    double items_per_sec = 0.0;
+    double ns_per_item = 0.0;
+    double realtime = 0.0;
+    double allocs_per_iter = 0.0;
+    uint64_t p50_ns = 0;
+    uint64_t p99_ns = 0;
+    uint64_t max_ns = 0;
+};
+
+// Data shared by the benchmarks, loaded once
+struct BenchData {
+    std::vector<uint8_t> iq;        // u8 I/Q
+    uint32_t iq_rate = BENCH_SAMPLE_RATE;
+    std::string iq_source;
+    std::vector<float> audio;
+    uint32_t audio_rate = 0;
+    std::string audio_source;
+    std::string profile_path;
+    DopplerProfile profile;
+    std::string tmp_dir = "/tmp";
+};
+
+// ----------------------------------------------------------------------------
+// Input data
+// ----------------------------------------------------------------------------
+
+static bool is_riff(const std::string& path) {
+    std::ifstream f(path, std::ios::binary);
+    char magic[4];
+    return f.read(magic, 4) && std::memcmp(magic, "RIFF", 4) == 0;
+}
+
+// Longest readable WAV in dir (the directory also holds fetch failures)
+static bool load_audio(const std::string& dir, BenchData& data) {
+    std::error_code ec;
+    std::vector<std::string> wavs;
+    for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+        if (entry.path().extension() == ".wav" && is_riff(entry.path().string())) {
+            wavs.push_back(entry.path().string());
+        }
+    }
+    std::sort(wavs.begin(), wavs.end());
+    double best = 0.0;
+    for (const std::string& path : wavs) {
+        WavReader reader;
+        if (!reader.open(path) || reader.sample_rate() < APT_MIN_AUDIO_RATE) continue;
+        double duration = static_cast<double>(reader.frames()) / reader.sample_rate();
+        if (duration <= best) continue;
+        std::vector<float> samples;
+        if (!reader.read_all(samples)) continue;
+        best = duration;
+        data.audio.swap(samples);
+        data.audio_rate = reader.sample_rate();
+        data.audio_source = std::filesystem::path(path).filename().string();
+    }
+    return !data.audio.empty();
+}
+
+// FM-modulate the audio (as an APT subcarrier would be) onto u8 I/Q with
+// a little receiver noise, so the DSP chain sees a realistic signal
+static void synthesize_iq(const BenchData& in, double seconds, std::vector<uint8_t>& iq) {
+    const size_t n = static_cast<size_t>(seconds * in.iq_rate);
+    const double step = static_cast<double>(in.audio_rate) / in.iq_rate;
+    const double k = 2.0 * M_PI * 0.8 * DEMOD_MAX_DEVIATION_HZ / in.iq_rate;
+    iq.resize(n * 2);
+    double phase = 0.0;
+    uint32_t lcg = 12345;
+    for (size_t i = 0; i < n; i++) {
+        double pos = i * step;
+        size_t j = static_cast<size_t>(pos) % (in.audio.size() - 1);
+        double frac = pos - std::floor(pos);
+        double a = in.audio[j] + (in.audio[j + 1] - in.audio[j]) * frac;
+        phase = std::remainder(phase + k * a, 2.0 * M_PI);
+        double v[2] = {std::cos(phase), std::sin(phase)};
+        for (int c = 0; c < 2; c++) {
+            lcg = lcg * 1664525u + 1013904223u;
+            double noise = ((lcg >> 8) / 16777216.0 - 0.5) * 8.0;
+            double q = 127.5 + 90.0 * v[c] + noise;
+            iq[i * 2 + c] = static_cast<uint8_t>(std::min(255.0, std::max(0.0, std::round(q))));
+        }
+    }
+}
+
+static bool load_iq(const std::string& path, BenchData& data) {
+    IqFile file;
+    if (!file.open(path, data.iq_rate)) return false;
+    size_t bytes = std::min(static_cast<uint64_t>(BENCH_IQ_SEC * data.iq_rate) * 2,
+                            file.num_samples() * 2);
+    bytes -= bytes % BENCH_TRANSFER_BYTES;
+    if (bytes == 0) {
+        std::cerr << "Error: Capture shorter than one transfer: " << path << std::endl;
+        return false;
+    }
+    data.iq.assign(file.data(), file.data() + bytes);
+    data.iq_source = std::filesystem::path(path).filename().string();
+    return true;
+}
+
+// Stand-in pass when there is no profile on disk: a symmetric S-curve
+static void synthesize_profile(DopplerProfile& profile) {
+    profile.center_freq_hz = 137100000.0;
+    profile.time_step_sec = 1.0;
+    for (int i = 0; i <= 900; i++) {
+        profile.times_sec.push_back(i);
+        profile.doppler_hz.push_back(-3200.0 * std::tanh((i - 450) / 120.0));
+    }
+    profile.prepare();
+}
+
+static std::string first_with_extension(const std::string& dir, const char* ext) {
+    std::error_code ec;
+    std::vector<std::string> found;
+    for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+        if (entry.path().extension() == ext) found.push_back(entry.path().string());
+    }
+    std::sort(found.begin(), found.end());
+    return found.empty() ? std::string() : found.front();
+}
+
+// ----------------------------------------------------------------------------
+// Benchmarks
+// ----------------------------------------------------------------------------
+
+// Callback side fills slabs at full speed; the consumer records the
+// push-to-pop latency of each one
+static bool bench_queue(BenchState& state, const BenchData& data) {
+    BufferPool pool(BENCH_POOL_SLABS, BENCH_TRANSFER_BYTES);
+    BufferQueue queue(BENCH_POOL_SLABS);
+    if (!pool.valid()) return false;
+    std::atomic<bool> stop{false};
+
+    std::thread producer([&]() {
+        const size_t blocks = data.iq.size() / BENCH_TRANSFER_BYTES;
+        uint64_t position = 0;
+        size_t block = 0;
+        uint32_t index;
+        while (!stop.load(std::memory_order_relaxed)) {
+            if (!pool.acquire(index)) {
+                std::this_thread::yield();
+                continue;
+            }
+            std::memcpy(pool.data(index), data.iq.data() + block * BENCH_TRANSFER_BYTES, BENCH_TRANSFER_BYTES);
+            block = (block + 1) % blocks;
+            queue.push({index, BENCH_TRANSFER_BYTES, position, steady_ns(), 0.0});
+            position += BENCH_TRANSFER_BYTES / 2;
+        }
+    });
+
+    state.manual_latency();
+    SlabRef ref;
+    while (state.next()) {
+        while (!queue.pop(ref, 100)) {
+        }
+        state.latency().record(static_cast<uint64_t>(steady_ns() - ref.steady_ns));
+        pool.release(ref.index);
+        state.add_items(ref.length / 2);
+    }
+    stop = true;
+    producer.join();
+    while (queue.pop(ref, 0)) pool.release(ref.index);
+    return true;
+}
+
+// One transfer per iteration through a writer, recycling slabs as the
+// backend completes them; queued writes are drained inside the timing
+static bool bench_writer(BenchState& state, const BenchData& data, CaptureFormat format,
+                         IoBackend backend, int compress_bits) {
+    CaptureMetadata metadata;
+    metadata.sample_rate = data.iq_rate;
+    metadata.center_freq_hz = 137100000;
+    metadata.carrier_freq_hz = 137100000;
+    metadata.hardware = "satgs_bench";
+    metadata.frame_samples = BENCH_TRANSFER_BYTES / 2;
+    std::unique_ptr<IQWriter> writer =
+        create_capture_writer(format, backend, DEFAULT_IO_INFLIGHT, nullptr, metadata, compress_bits);
+    if (!writer) return false;
+
+    std::string path = data.tmp_dir + "/satgs_bench_" + std::to_string(getpid()) +
+                       (format == CaptureFormat::Sgc ? ".sgc" : format == CaptureFormat::Sigmf ? ".sigmf-data" : ".bin");
+    if (!writer->open(path, 0)) return false;
+
+    BufferPool pool(BENCH_POOL_SLABS, BENCH_TRANSFER_BYTES);
+    if (!pool.valid()) return false;
+    const size_t blocks = data.iq.size() / BENCH_TRANSFER_BYTES;
+    std::vector<uint32_t> free_slabs;
+    for (uint32_t i = 0; i < BENCH_POOL_SLABS; i++) {
+        std::memcpy(pool.data(i), data.iq.data() + (i % blocks) * BENCH_TRANSFER_BYTES, BENCH_TRANSFER_BYTES);
+        free_slabs.push_back(i);
+    }
+    std::vector<uint32_t> done;
+    done.reserve(BENCH_POOL_SLABS);
+
+    bool ok = true;
+    IqFrameInfo frame;
+    while (state.next()) {
+        if (free_slabs.empty() && writer->reap(free_slabs, true) == 0) {
+            ok = false;
+            break;
+        }
+        uint32_t slab = free_slabs.back();
+        free_slabs.pop_back();
+        frame.steady_ns = steady_ns();
+        if (!writer->submit(pool.data(slab), BENCH_TRANSFER_BYTES, slab, frame)) {
+            ok = false;
+            break;
+        }
+        frame.first_sample += BENCH_TRANSFER_BYTES / 2;
+        writer->reap(free_slabs, false);
+        state.add_items(BENCH_TRANSFER_BYTES / 2);
+    }
+    ok = writer->close(done) && ok;
+    state.extend_to_now();
+
+    std::remove(path.c_str());
+    if (format == CaptureFormat::Sigmf) std::remove(sigmf_meta_path(path).c_str());
+    return ok;
+}
+
+static bool bench_sgc_encode(BenchState& state, const BenchData& data, int bits) {
+    const size_t blocks = data.iq.size() / BENCH_TRANSFER_BYTES;
+    std::vector<uint8_t> out;
+    uint8_t codec, rice_k;
+    size_t block = 0;
+    while (state.next()) {
+        sgc_encode(data.iq.data() + block * BENCH_TRANSFER_BYTES, BENCH_TRANSFER_BYTES, bits, out, codec, rice_k);
+        block = (block + 1) % blocks;
+        state.add_items(BENCH_TRANSFER_BYTES / 2);
+    }
+    return true;
+}
+
+static bool bench_sgc_decode(BenchState& state, const BenchData& data, int bits) {
+    std::vector<uint8_t> payload;
+    uint8_t codec, rice_k;
+    sgc_encode(data.iq.data(), BENCH_TRANSFER_BYTES, bits, payload, codec, rice_k);
+    std::vector<uint8_t> iq(BENCH_TRANSFER_BYTES);
+    while (state.next()) {
+        if (!sgc_decode(payload.data(), payload.size(), codec, bits, rice_k, iq.data(), iq.size())) return false;
+        state.add_items(BENCH_TRANSFER_BYTES / 2);
+    }
+    return true;
+}
+
+// Kernel inputs: the I/Q converted once, plus taps of the real filters
+struct KernelInputs {
+    std::vector<cf32> samples;
+    std::vector<float> real;
+    std::vector<float> taps2;       // Stage-1 FIR taps, each duplicated
+    std::vector<float> taps;
+    int decimation = 1;
+};
+
+static void make_kernel_inputs(const BenchData& data, KernelInputs& in) {
+    const size_t n = std::min<size_t>(data.iq.size() / 2, 64 * BENCH_KERNEL_BLOCK);
+    in.samples.resize(n);
+    dsp_kernels_scalar().u8_to_cf32(data.iq.data(), in.samples.data(), n);
+    in.real.resize(n);
+    for (size_t i = 0; i < n; i++) in.real[i] = in.samples[i].real();
+
+    DemodPipeline pipeline;
+    DemodConfig config;
+    config.input_rate = data.iq_rate;
+    pipeline.configure(config);
+    in.decimation = pipeline.stage1().decimation();
+    in.taps = design_lowpass(data.iq_rate, data.iq_rate / (2.0 * in.decimation),
+                             static_cast<int>(pipeline.stage1().num_taps()));
+    for (float t : in.taps) {
+        in.taps2.push_back(t);
+        in.taps2.push_back(t);
+    }
+}
+
+enum class KernelOp {
+    U8ToCf32,
+    IqStats,
+    IqApply,
+    ComplexMultiply,
+    FmDiscriminate,
+    DotCf32Real,
+    DotF32
+};
+
+static bool bench_kernel(BenchState& state, const BenchData& data, const KernelInputs& in,
+                         const DspKernels& k, KernelOp op) {
+    const size_t n = BENCH_KERNEL_BLOCK;
+    const size_t blocks = in.samples.size() / n;
+    std::vector<cf32> work(n + in.taps.size());
+    std::vector<float> fout(n);
+    IqStats stats = {};
+    IqCorrection corr = {0.01f, -0.01f, 0.02f, 1.01f};
+    cf32 last(1.0f, 0.0f);
+    volatile float sink = 0.0f;
+    size_t block = 0;
+    while (state.next()) {
+        const cf32* x = in.samples.data() + block * n;
+        switch (op) {
+            case KernelOp::U8ToCf32:
+                k.u8_to_cf32(data.iq.data() + block * n * 2, work.data(), n);
+                break;
+            case KernelOp::IqStats:
+                k.iq_stats(x, n, &stats);
+                break;
+            case KernelOp::IqApply:
+                std::memcpy(work.data(), x, n * sizeof(cf32));
+                k.iq_apply(work.data(), n, &corr);
+                break;
+            case KernelOp::ComplexMultiply:
+                k.complex_multiply(x, in.samples.data() + ((block + 1) % blocks) * n, work.data(), n);
+                break;
+            case KernelOp::FmDiscriminate:
+                k.fm_discriminate(x, fout.data(), n, &last, 1.0f);
+                break;
+            case KernelOp::DotCf32Real: {
+                // Decimating FIR sweep as run by pipeline stage 1
+                cf32 acc(0.0f, 0.0f);
+                const size_t taps = in.taps.size();
+                for (size_t i = 0; i + taps <= n; i += in.decimation) {
+                    acc += k.dot_cf32_real(x + i, in.taps2.data(), taps);
+                }
+                sink = acc.real();
+                break;
+            }
+            case KernelOp::DotF32: {
+                float acc = 0.0f;
+                const float* r = in.real.data() + block * n;
+                const size_t taps = in.taps.size();
+                for (size_t i = 0; i + taps <= n; i += in.decimation) {
+                    acc += k.dot_f32(r + i, in.taps.data(), taps);
+                }
+                sink = acc;
+                break;
+            }
+        }
+        block = (block + 1) % blocks;
+        state.add_items(n);
+    }
+    (void)sink;
+    return true;
+}
+
+static bool bench_pipeline(BenchState& state, const BenchData& data, bool iq_correction, bool shift) {
+    DemodConfig config;
+    config.input_rate = data.iq_rate;
+    config.iq_correction = iq_correction;
+    DemodPipeline pipeline;
+    if (!pipeline.configure(config)) return false;
+
+    const size_t blocks = data.iq.size() / BENCH_TRANSFER_BYTES;
+    const double block_sec = BENCH_TRANSFER_BYTES / 2.0 / data.iq_rate;
+    std::vector<float> audio;
+    // Warm-up block sizes the scratch buffers
+    pipeline.process(data.iq.data(), BENCH_TRANSFER_BYTES, audio);
+    size_t block = 1 % blocks;
+    double t = 0.0;
+    DopplerProfile profile = data.profile;
+    while (state.next()) {
+        if (shift) {
+            pipeline.set_frequency_shift(profile.getDoppler(t), profile.getDoppler(t + block_sec));
+            t = std::fmod(t + block_sec, profile.getDuration());
+        }
+        audio.clear();
+        pipeline.process(data.iq.data() + block * BENCH_TRANSFER_BYTES, BENCH_TRANSFER_BYTES, audio);
+        block = (block + 1) % blocks;
+        state.add_items(BENCH_TRANSFER_BYTES / 2);
+    }
+    return true;
+}
+
+// Whole-band reception: the filter bank, then every channel's chain at
+// the channel rate, one after another (NOAA 19/15/18 and Meteor around
+// a 137.4 MHz tuner)
+static bool bench_channelizer(BenchState& state, const BenchData& data, size_t channels) {
+    const double carriers[] = {-300000.0, 220000.0, 512500.0, 500000.0};
+    std::vector<double> offsets(carriers, carriers + std::min<size_t>(channels, 4));
+    Channelizer channelizer;
+    if (!channelizer.configure(data.iq_rate, offsets, DEMOD_CHANNEL_BW_HZ, false)) return false;
+    DemodConfig config;
+    config.input_rate = channelizer.output_rate();
+    std::vector<DemodPipeline> pipelines(offsets.size());
+    for (DemodPipeline& pipeline : pipelines) {
+        if (!pipeline.configure(config)) return false;
+    }
+
+    const size_t blocks = data.iq.size() / BENCH_TRANSFER_BYTES;
+    std::vector<std::vector<cf32>> baseband;
+    std::vector<float> audio;
+    // Warm-up blocks size the scratch buffers (block counts per transfer
+    // vary by one, so take a few)
+    size_t block = 0;
+    for (int warm = 0; warm < 4; warm++) {
+        for (std::vector<cf32>& samples : baseband) samples.clear();
+        channelizer.process(data.iq.data() + block * BENCH_TRANSFER_BYTES, BENCH_TRANSFER_BYTES, baseband);
+        for (size_t c = 0; c < pipelines.size(); c++) {
+            audio.clear();
+            pipelines[c].process_baseband(baseband[c].data(), baseband[c].size(), audio);
+        }
+        block = (block + 1) % blocks;
+    }
+    while (state.next()) {
+        for (std::vector<cf32>& samples : baseband) samples.clear();
+        channelizer.process(data.iq.data() + block * BENCH_TRANSFER_BYTES, BENCH_TRANSFER_BYTES, baseband);
+        for (size_t c = 0; c < pipelines.size(); c++) {
+            audio.clear();
+            pipelines[c].process_baseband(baseband[c].data(), baseband[c].size(), audio);
+        }
+        block = (block + 1) % blocks;
+        state.add_items(BENCH_TRANSFER_BYTES / 2);
+    }
+    return true;
+}
+
+// One waterfall row at the default geometry; real time is the row rate,
+// so the inverse of the speed-up is the spectrum thread's share of a core
+static bool bench_spectrum(BenchState& state, const BenchData& data) {
+    SpectrumAnalyzer analyzer;
+    if (!analyzer.configure(SpectrumConfig())) return false;
+    const size_t row_bytes = analyzer.samples_per_row() * 2;
+    const size_t rows = data.iq.size() / row_bytes;
+    if (rows == 0) return false;
+    std::vector<uint8_t> row(analyzer.bins());
+    size_t index = 0;
+    while (state.next()) {
+        analyzer.compute(data.iq.data() + index * row_bytes, row.data());
+        index = (index + 1) % rows;
+        state.add_items(1);
+    }
+    return true;
+}
+
+// Half a second of audio per iteration, as apt_decode feeds it
+static bool bench_apt(BenchState& state, const BenchData& data) {
+    AptDecoder decoder;
+    if (!decoder.configure(data.audio_rate)) return false;
+    const size_t block = data.audio_rate / 2;
+    std::vector<AptLine> lines;
+    size_t pos = 0;
+    while (state.next()) {
+        if (pos + block > data.audio.size()) {
+            decoder.reset();
+            pos = 0;
+        }
+        lines.clear();
+        decoder.process(data.audio.data() + pos, block, lines);
+        pos += block;
+        state.add_items(block);
+    }
+    return true;
+}
+
+enum class LookupPattern {
+    Sequential,     // Following the pass, as the tracker and NCO do
+    Random,         // Jumps, defeating the cursor
+    Block           // getDopplerBlock at the IF rate
+};
+
+static bool bench_doppler(BenchState& state, const BenchData& data, DopplerInterp interp, LookupPattern pattern) {
+    DopplerProfile profile = data.profile;
+    profile.interp = interp;
+    if (!profile.prepare()) return false;
+    const double duration = profile.getDuration();
+
+    std::vector<double> times(BENCH_LOOKUPS);
+    uint32_t lcg = 1;
+    for (double& t : times) {
+        lcg = lcg * 1664525u + 1013904223u;
+        t = (lcg >> 8) / 16777216.0 * duration;
+    }
+    std::vector<float> block(BENCH_LOOKUPS);
+    const double step = pattern == LookupPattern::Block ? 1.0 / 48000.0 : 1e-3;
+    volatile double sink = 0.0;
+    double t = 0.0;
+    while (state.next()) {
+        double acc = 0.0;
+        switch (pattern) {
+            case LookupPattern::Sequential:
+                for (size_t i = 0; i < BENCH_LOOKUPS; i++) acc += profile.getDoppler(t + i * step);
+                break;
+            case LookupPattern::Random:
+                for (size_t i = 0; i < BENCH_LOOKUPS; i++) acc += profile.getDoppler(times[i]);
+                break;
+            case LookupPattern::Block:
+                profile.getDopplerBlock(t, step, block.data(), BENCH_LOOKUPS);
+                acc = block[BENCH_LOOKUPS - 1];
+                break;
+        }
+        sink = acc;
+        t += BENCH_LOOKUPS * step;
+        if (t + BENCH_LOOKUPS * step > duration) t = 0.0;
+        state.add_items(BENCH_LOOKUPS);
+    }
+    (void)sink;
+    return true;
+}
+
+static bool bench_profile_load(BenchState& state, const BenchData& data) {
+    while (state.next()) {
+        DopplerProfile profile;
+        if (!profile.load(data.profile_path)) return false;
+        state.add_items(profile.times_sec.size());
+    }
+    return true;
+}
+
+// Tokenizer alone: every value visited, nothing kept
+static bool bench_json_skim(BenchState& state, const BenchData& data) {
+    MappedFile file;
+    if (!file.open(data.profile_path)) return false;
+    while (state.next()) {
+        JsonReader reader(file.data(), file.size());
+        if (!reader.skip_value()) return false;
+        state.add_items(file.size());
+    }
+    return true;
+}
+
+static std::vector<Benchmark> make_benchmarks(const BenchData& data, const KernelInputs& inputs) {
+    const double iq_rate = data.iq_rate;
+    const uint64_t unlimited = ~0ULL;
+    const uint64_t writer_iterations = BENCH_WRITER_MAX_MB * 1024ULL * 1024 / BENCH_TRANSFER_BYTES;
+    std::vector<Benchmark> list;
+
+    list.push_back({"queue/handoff", "samples", iq_rate, unlimited,
+                    [&](BenchState& s) { return bench_queue(s, data); }});
+
+    struct WriterCase {
+        const char* name;
+        CaptureFormat format;
+        IoBackend backend;
+        int bits;
+    };
+    const WriterCase writers[] = {
+        {"writer/raw-stream", CaptureFormat::Raw, IoBackend::Stream, 0},
+        {"writer/raw-direct", CaptureFormat::Raw, IoBackend::Direct, 0},
+        {"writer/raw-uring", CaptureFormat::Raw, IoBackend::Uring, 0},
+        {"writer/sigmf-stream", CaptureFormat::Sigmf, IoBackend::Stream, 0},
+        {"writer/sgc", CaptureFormat::Sgc, IoBackend::Stream, 0},
+        {"writer/sgc-rice8", CaptureFormat::Sgc, IoBackend::Stream, 8},
+        {"writer/sgc-rice4", CaptureFormat::Sgc, IoBackend::Stream, 4},
+    };
+    for (const WriterCase& w : writers) {
+        if (!io_backend_available(w.backend)) continue;
+        list.push_back({w.name, "samples", iq_rate, writer_iterations,
+                        [&data, w](BenchState& s) { return bench_writer(s, data, w.format, w.backend, w.bits); }});
+    }
+
+    for (int bits : {8, 4}) {
+        std::string suffix = "-rice" + std::to_string(bits);
+        list.push_back({"sgc/encode" + suffix, "samples", iq_rate, unlimited,
+                        [&data, bits](BenchState& s) { return bench_sgc_encode(s, data, bits); }});
+        list.push_back({"sgc/decode" + suffix, "samples", iq_rate, unlimited,
+                        [&data, bits](BenchState& s) { return bench_sgc_decode(s, data, bits); }});
+    }
+
+    const std::pair<const char*, KernelOp> ops[] = {
+        {"u8_to_cf32", KernelOp::U8ToCf32},
+        {"iq_stats", KernelOp::IqStats},
+        {"iq_apply", KernelOp::IqApply},
+        {"complex_multiply", KernelOp::ComplexMultiply},
+        {"fm_discriminate", KernelOp::FmDiscriminate},
+        {"dot_cf32_real", KernelOp::DotCf32Real},
+        {"dot_f32", KernelOp::DotF32},
+    };
+    for (const DspKernels* const* k = dsp_kernels_available(); *k; k++) {
+        const DspKernels* table = *k;
+        for (const auto& op : ops) {
+            KernelOp code = op.second;
+            list.push_back({std::string("dsp/") + op.first + "/" + table->name, "samples", iq_rate, unlimited,
+                            [&data, &inputs, table, code](BenchState& s) {
+                                return bench_kernel(s, data, inputs, *table, code);
+                            }});
+        }
+    }
+    list.push_back({"dsp/pipeline", "samples", iq_rate, unlimited,
+                    [&](BenchState& s) { return bench_pipeline(s, data, false, false); }});
+    list.push_back({"dsp/pipeline-iqcorr-doppler", "samples", iq_rate, unlimited,
+                    [&](BenchState& s) { return bench_pipeline(s, data, true, true); }});
+    for (size_t channels : {1, 4}) {
+        list.push_back({"dsp/channelized-" + std::to_string(channels), "samples", iq_rate, unlimited,
+                        [&data, channels](BenchState& s) { return bench_channelizer(s, data, channels); }});
+    }
+
+    list.push_back({"dsp/spectrum-row", "rows", SPECTRUM_DEFAULT_ROW_RATE, unlimited,
+                    [&](BenchState& s) { return bench_spectrum(s, data); }});
+
+    list.push_back({"apt/decoder", "samples", static_cast<double>(data.audio_rate), unlimited,
+                    [&](BenchState& s) { return bench_apt(s, data); }});
+
+    const std::pair<const char*, DopplerInterp> interps[] = {
+        {"linear", DopplerInterp::Linear},
+        {"hermite", DopplerInterp::Hermite},
+    };
+    for (const auto& in : interps) {
+        DopplerInterp interp = in.second;
+        std::string base = std::string("doppler/") + in.first;
+        list.push_back({base + "-sequential", "lookups", 0.0, unlimited,
+                        [&data, interp](BenchState& s) { return bench_doppler(s, data, interp, LookupPattern::Sequential); }});
+        list.push_back({base + "-random", "lookups", 0.0, unlimited,
+                        [&data, interp](BenchState& s) { return bench_doppler(s, data, interp, LookupPattern::Random); }});
+        list.push_back({base + "-block", "samples", 0.0, unlimited,
+                        [&data, interp](BenchState& s) { return bench_doppler(s, data, interp, LookupPattern::Block); }});
+    }
+
+    list.push_back({"json/profile-load", "points", 0.0, unlimited,
+                    [&](BenchState& s) { return bench_profile_load(s, data); }});
+    list.push_back({"json/skim", "bytes", 0.0, unlimited,
+                    [&](BenchState& s) { return bench_json_skim(s, data); }});
+    return list;
+}
+
+// ----------------------------------------------------------------------------
+// Reporting
+// ----------------------------------------------------------------------------
+
+static std::string format_rate(double v) {
+    std::ostringstream s;
+    s << std::fixed << std::setprecision(1);
+    if (v >= 1e9) s << v / 1e9 << " G";
+    else if (v >= 1e6) s << v / 1e6 << " M";
+    else if (v >= 1e3) s << v / 1e3 << " k";
+    else s << v << " ";
+    return s.str();
+}
+
+static std::string format_ns(uint64_t ns) {
+    std::ostringstream s;
+    s << std::fixed << std::setprecision(1);
+    if (ns >= 1000000) s << ns / 1e6 << " ms";
+    else if (ns >= 1000) s << ns / 1e3 << " us";
+    else s << ns << " ns";
+    return s.str();
+}
+
+static void print_header() {
+    std::cout << std::left << std::setw(34) << "Benchmark" << std::right
+              << std::setw(9) << "Iters" << std::setw(18) << "Rate"
+              << std::setw(10) << "ns/item" << std::setw(9) << "x RT"
+              << std::setw(10) << "Allocs/it" << std::setw(10) << "p50"
+              << std::setw(10) << "p99" << std::setw(10) << "max" << "\n";
+}
+
+static void print_result(const BenchResult& r, const BenchResult* base) {
+    std::cout << std::left << std::setw(34) << r.name << std::right << std::setw(9) << r.iterations
+              << std::setw(18) << (format_rate(r.items_per_sec) + r.unit + "/s")
+              << std::fixed << std::setprecision(r.ns_per_item < 10 ? 3 : 1) << std::setw(10) << r.ns_per_item
+              << std::setprecision(1) << std::setw(9);
+    if (r.realtime > 0) std::cout << r.realtime;
+    else std::cout << "-";
+    std::cout << std::setprecision(2) << std::setw(10) << r.allocs_per_iter
+              << std::setw(10) << format_ns(r.p50_ns) << std::setw(10) << format_ns(r.p99_ns)
+              << std::setw(10) << format_ns(r.max_ns);
+    if (base && base->items_per_sec > 0) {
+        std::cout << "  " << std::showpos << std::setprecision(1)
+                  << (r.items_per_sec / base->items_per_sec - 1.0) * 100.0 << "%" << std::noshowpos;
+    }
+    std::cout << "\n";
+}
+
+static bool write_csv(const std::string& path, const std::vector<BenchResult>& results) {
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) {
+        std::cerr << "Error: Cannot create " << path << std::endl;
+        return false;
+    }
+    out << "name,unit,iterations,items_per_sec,ns_per_item,realtime,allocs_per_iter,p50_ns,p99_ns,max_ns\n";
+    out << std::setprecision(9);
+    for (const BenchResult& r : results) {
+        out << r.name << "," << r.unit << "," << r.iterations << "," << r.items_per_sec << ","
+            << r.ns_per_item << "," << r.realtime << "," << r.allocs_per_iter << ","
+            << r.p50_ns << "," << r.p99_ns << "," << r.max_ns << "\n";
+    }
+    return static_cast<bool>(out);
+}
+
+static bool read_csv(const std::string& path, std::map<std::string, BenchResult>& results) {
+    std::ifstream in(path);
+    if (!in) {
+        std::cerr << "Error: Cannot open baseline " << path << std::endl;
+        return false;
+    }
+    std::string line;
+    std::getline(in, line);
+    while (std::getline(in, line)) {
+        std::vector<std::string> fields;
+        std::stringstream ss(line);
+        std::string field;
+        while (std::getline(ss, field, ',')) fields.push_back(field);
+        if (fields.size() < 10) continue;
+        BenchResult r;
+        r.name = fields[0];
+        r.unit = fields[1];
+        r.iterations = std::stoull(fields[2]);
+        r.items_per_sec = std::stod(fields[3]);
+        r.ns_per_item = std::stod(fields[4]);
+        r.realtime = std::stod(fields[5]);
+        r.allocs_per_iter = std::stod(fields[6]);
+        r.p50_ns = std::stoull(fields[7]);
+        r.p99_ns = std::stoull(fields[8]);
+        r.max_ns = std::stoull(fields[9]);
+        results[r.name] = r;
+    }
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// Main
+// ----------------------------------------------------------------------------
+
+void print_usage(const char* progname) {
+    std::cout << "Usage: " << progname << " [options] [filter...]\n"
+              << "\nRuns every benchmark whose name contains one of the filters (all by default).\n"
+              << "\nOptions:\n"
+              << "  --data <dir>      Test recordings (default: data/test_samples)\n"
+              << "  --iq <file>       Raw u8 I/Q capture to replay (default: first .bin in --data,\n"
+              << "                    else synthesized from the longest WAV)\n"
+              << "  -s <rate>         Sample rate of --iq (default: 2400000)\n"
+              << "  -p <profile>      Doppler profile (default: first .json in <data>/../doppler)\n"
+              << "  --tmp <dir>       Directory for writer output (default: /tmp)\n"
+              << "  -t <sec>          Minimum time per benchmark (default: 1.0)\n"
+              << "  --csv <file>      Save results as CSV\n"
+              << "  --baseline <csv>  Compare with an earlier --csv run; exit 1 on regression\n"
+              << "  --threshold <pct> Slowdown counted as a regression (default: 10)\n"
+              << "  -l, --list        List benchmarks and exit\n"
+              << "  -h, --help        Show this help\n"
+              << "\nExamples:\n"
+              << "  " << progname << " --csv base.csv\n"
+              << "  " << progname << " --baseline base.csv dsp/ writer/\n";
+}
+
+int main(int argc, char* argv[]) {
+    enum { OPT_DATA = 256, OPT_IQ, OPT_TMP, OPT_CSV, OPT_BASELINE, OPT_THRESHOLD };
+    static struct option long_options[] = {
+        {"data",      required_argument, nullptr, OPT_DATA},
+        {"iq",        required_argument, nullptr, OPT_IQ},
+        {"tmp",       required_argument, nullptr, OPT_TMP},
+        {"csv",       required_argument, nullptr, OPT_CSV},
+        {"baseline",  required_argument, nullptr, OPT_BASELINE},
+        {"threshold", required_argument, nullptr, OPT_THRESHOLD},
+        {"list",      no_argument,       nullptr, 'l'},
+        {"help",      no_argument,       nullptr, 'h'},
+        {nullptr, 0, nullptr, 0}
+    };
+
+    BenchData data;
+    std::string data_dir = "data/test_samples";
+    std::string iq_file;
+    std::string csv_file;
+    std::string baseline_file;
+    double min_time = DEFAULT_MIN_TIME;
+    double threshold = DEFAULT_THRESHOLD;
+    bool list_only = false;
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "s:p:t:lh", long_options, nullptr)) != -1) {
+        switch (opt) {
+            case OPT_DATA:
+                data_dir = optarg;
+                break;
+            case OPT_IQ:
+                iq_file = optarg;
+                break;
+            case 's':
+                data.iq_rate = static_cast<uint32_t>(std::stoul(optarg));
+                break;
+            case 'p':
+                data.profile_path = optarg;
+                break;
+            case OPT_TMP:
+                data.tmp_dir = optarg;
+                break;
+            case 't':
+                min_time = std::stod(optarg);
+                break;
+            case OPT_CSV:
+                csv_file = optarg;
+                break;
+            case OPT_BASELINE:
+                baseline_file = optarg;
+                break;
+            case OPT_THRESHOLD:
+                threshold = std::stod(optarg);
+                break;
+            case 'l':
+                list_only = true;
+                break;
+            case 'h':
+            default:
+                print_usage(argv[0]);
+                return (opt == 'h') ? 0 : 1;
+        }
+    }
+    std::vector<std::string> filters(argv + optind, argv + argc);
+
+    if (min_time <= 0) {
+        std::cerr << "Error: -t must be positive\n";
+        return 1;
+    }
+
+    auto selected = [&](const std::string& name) {
+        if (filters.empty()) return true;
+        for (const std::string& f : filters) {
+            if (name.find(f) != std::string::npos) return true;
+        }
+        return false;
+    };
+
+    KernelInputs inputs;
+    if (list_only) {
+        for (const Benchmark& b : make_benchmarks(data, inputs)) {
+            if (selected(b.name)) std::cout << b.name << "\n";
+        }
+        return 0;
+    }
+
+    // Inputs
+    if (!load_audio(data_dir, data)) {
+        std::cerr << "Error: No usable WAV recording in " << data_dir << std::endl;
+        return 1;
+    }
+    if (iq_file.empty()) iq_file = first_with_extension(data_dir, ".bin");
+    if (!iq_file.empty()) {
+        if (!load_iq(iq_file, data)) return 1;
+    } else {
+        data.iq_rate = BENCH_SAMPLE_RATE;
+        synthesize_iq(data, BENCH_IQ_SEC, data.iq);
+        data.iq_source = "FM-modulated " + data.audio_source;
+    }
+    bool own_profile = false;
+    if (data.profile_path.empty()) {
+        // Found profiles may be placeholders written without a pass
+        data.profile_path = first_with_extension(data_dir + "/../doppler", ".json");
+        if (!data.profile_path.empty() && !data.profile.load(data.profile_path)) {
+            std::cerr << "  (" << data.profile_path << " unusable, synthesizing a pass)\n";
+            data.profile_path.clear();
+        }
+        own_profile = data.profile_path.empty();
+    }
+    if (own_profile) {
+        // Keep the JSON benchmarks meaningful with a profile of our own
+        synthesize_profile(data.profile);
+        data.profile_path = data.tmp_dir + "/satgs_bench_" + std::to_string(getpid()) + "_doppler.json";
+        if (!data.profile.save(data.profile_path)) return 1;
+    } else if (data.profile.times_sec.empty() && !data.profile.load(data.profile_path)) {
+        return 1;
+    }
+
+    make_kernel_inputs(data, inputs);
+    std::vector<Benchmark> benchmarks = make_benchmarks(data, inputs);
+
+    std::map<std::string, BenchResult> baseline;
+    if (!baseline_file.empty() && !read_csv(baseline_file, baseline)) {
+        return 1;
+    }
+
+    std::cout << "satgs_bench\n";
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "  I/Q:      " << data.iq_source << ", " << data.iq_rate / 1e6 << " MS/s, "
+              << std::setprecision(1) << data.iq.size() / 2.0 / data.iq_rate << " s\n";
+    std::cout << "  Audio:    " << data.audio_source << ", " << data.audio_rate << " Hz, "
+              << static_cast<double>(data.audio.size()) / data.audio_rate << " s\n";
+    std::cout << "  Profile:  " << data.profile_path << " (" << data.profile.times_sec.size() << " points)\n";
+    std::cout << "  Platform: " << cpu_count() << " CPU(s), kernels " << dsp_kernels().name
+              << ", FFT " << fft_backend_name() << "\n\n";
+    print_header();
+
+    std::vector<BenchResult> results;
+    size_t regressions = 0;
+    bool failed = false;
+    for (const Benchmark& b : benchmarks) {
+        if (!selected(b.name)) continue;
+        BenchState state(min_time, b.max_iterations);
+        if (!b.run(state) || state.iterations() == 0) {
+            std::cout << std::left << std::setw(34) << b.name << std::right << " failed\n";
+            failed = true;
+            continue;
+        }
+
+        BenchResult r;
+        r.name = b.name;
+        r.unit = b.unit;
+        r.iterations = state.iterations();
+        r.items_per_sec = state.items() / state.seconds();
+        r.ns_per_item = state.items() ? state.seconds() * 1e9 / state.items() : 0.0;
+        r.realtime = b.realtime_rate > 0 ? r.items_per_sec / b.realtime_rate : 0.0;
+        r.allocs_per_iter = static_cast<double>(state.allocations()) / state.iterations();
+        r.p50_ns = state.latency().percentile_ns(50.0);
+        r.p99_ns = state.latency().percentile_ns(99.0);
+        r.max_ns = state.latency().max_ns();
+
+        auto base = baseline.find(r.name);
+        const BenchResult* base_result = base != baseline.end() ? &base->second : nullptr;
+        print_result(r, base_result);
+        if (base_result && base_result->items_per_sec > 0 &&
+            r.items_per_sec < base_result->items_per_sec * (1.0 - threshold / 100.0)) {
+            regressions++;
+        }
+        results.push_back(r);
+    }
+
+    if (own_profile) {
+        std::remove(data.profile_path.c_str());
+    }
+    if (!csv_file.empty() && !write_csv(csv_file, results)) {
+        return 1;
+    }
+    if (!baseline.empty()) {
+        std::cout << "\n" << regressions << " regression(s) beyond " << std::setprecision(0)
+                  << threshold << "% against " << baseline_file << "\n";
+    }
+    return (failed || regressions > 0) ? 1 : 0;
+}
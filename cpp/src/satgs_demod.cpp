@@ -0,0 +1,375 @@
+/*
+ * satgs_demod.cpp
+ * Satellite Ground Station - Parallel Offline Demodulation of I/Q Captures
+ *
+ * Batch counterpart of rtlsdr_capture -a / --image for raw captures
+ * already on disk (rtlsdr_capture -o). Each capture is memory-mapped and
+ * split into chunks that are demodulated concurrently on a thread pool:
+ *
+ *   - I/Q chunks start on a multiple of the pipeline period (the input
+ *     samples per whole number of audio samples, 1500 at 2.4 MS/s), so a
+ *     fresh DemodPipeline per chunk produces samples on the same grid as
+ *     one continuous run. Each chunk is preceded by a warm-up margin
+ *     whose audio is dropped; the owned outputs are concatenated.
+ *   - The audio is then cut into APT chunks decoded in parallel. Every
+ *     decoder locks and settles its PLL in a warm-up and keeps the lines
+ *     starting within half a line of its own range; at each seam the
+ *     two candidates for the same line are merged, keeping the synced
+ *     one, so the image stitches on sync boundaries without gaps.
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <numeric>
+#include <algorithm>
+#include <cmath>
+#include <getopt.h>
+
+#include "apt_decoder.h"
+#include "doppler_profile.h"
+#include "dsp_pipeline.h"
+#include "iq_file.h"
+#include "thread_pool.h"
+#include "wav_writer.h"
+
+#define DEFAULT_SAMPLE_RATE   2400000
+#define DEFAULT_CHUNK_SEC     30.0
+#define DEFAULT_MARGIN_SEC    0.5       // Filter and I/Q corrector settling
+#define DEMOD_BLOCK_BYTES     (16 * 16384) // Same block size as the capture path
+#define APT_CHUNK_SEC         120.0
+#define APT_WARMUP_SEC        20.0      // Sync lock plus PLL period settling before the owned range
+
+struct DemodOptions {
+    uint32_t sample_rate = DEFAULT_SAMPLE_RATE;
+    double chunk_sec = DEFAULT_CHUNK_SEC;
+    double margin_sec = DEFAULT_MARGIN_SEC;
+    bool iq_correction = false;
+    double tune_offset_hz = 0.0;
+    const DopplerProfile* doppler = nullptr;
+    double profile_start_sec = 0.0;
+    AudioFormat audio_format = AudioFormat::Int16;
+    bool image = true;
+    std::string output_dir;
+};
+
+// A decoded line placed on the whole-recording time axis
+struct PlacedLine {
+    double start_sec;
+    AptLine line;
+};
+
+static std::string output_base(const std::string& input, const std::string& dir) {
+    size_t slash = input.find_last_of('/');
+    std::string name = (slash == std::string::npos) ? input : input.substr(slash + 1);
+    size_t dot = name.find_last_of('.');
+    if (dot != std::string::npos && dot > 0) name = name.substr(0, dot);
+    if (dir.empty()) {
+        return (slash == std::string::npos) ? name : input.substr(0, slash + 1) + name;
+    }
+    return (dir.back() == '/') ? dir + name : dir + "/" + name;
+}
+
+// Demodulate one chunk into audio, dropping the outputs of its margin
+static void demod_chunk(const IqFile& file, const IqChunk& chunk, const DemodOptions& opts,
+                        uint64_t period, int outputs_per_period, std::vector<float>& audio) {
+    file.prefetch(chunk);
+
+    DemodConfig config;
+    config.input_rate = opts.sample_rate;
+    config.iq_correction = opts.iq_correction;
+    DemodPipeline pipeline;
+    pipeline.configure(config);
+
+    // getDoppler walks a cursor, so each chunk needs its own copy
+    DopplerProfile doppler;
+    if (opts.doppler) doppler = *opts.doppler;
+    const bool nco_enabled = opts.doppler || opts.tune_offset_hz != 0.0;
+    auto shift_at = [&](uint64_t sample) {
+        double d = opts.doppler
+            ? doppler.getDoppler(opts.profile_start_sec + static_cast<double>(sample) / opts.sample_rate)
+            : 0.0;
+        return opts.tune_offset_hz - d;
+    };
+
+    const size_t skip = static_cast<size_t>(chunk.margin / period) * outputs_per_period;
+    const size_t total = chunk.data_bytes();
+    uint64_t sample = chunk.first_sample - chunk.margin;
+    audio.clear();
+    audio.reserve(static_cast<size_t>((chunk.margin + chunk.num_samples) / period + 1) * outputs_per_period);
+    for (size_t pos = 0; pos < total; pos += DEMOD_BLOCK_BYTES) {
+        size_t n = std::min(static_cast<size_t>(DEMOD_BLOCK_BYTES), total - pos);
+        if (nco_enabled) {
+            pipeline.set_frequency_shift(shift_at(sample), shift_at(sample + n / 2));
+        }
+        pipeline.process(chunk.data + pos, n, audio);
+        sample += n / 2;
+    }
+    audio.erase(audio.begin(), audio.begin() + std::min(skip, audio.size()));
+
+    file.release(chunk);
+}
+
+// Decode audio[first - warmup, first + count) and keep the lines that
+// start within half a line of [first, first + count)
+static void decode_apt_chunk(const std::vector<float>& audio, uint32_t rate, size_t first,
+                             size_t count, size_t warmup, std::vector<PlacedLine>& out) {
+    AptDecoder decoder;
+    decoder.configure(rate);
+    size_t begin = first - std::min(warmup, first);
+    size_t end = std::min(audio.size(), first + count);
+
+    std::vector<AptLine> lines;
+    decoder.process(audio.data() + begin, end - begin, lines);
+
+    const double half_line = 0.25;      // Seconds (lines are 0.5 s)
+    const double lo = static_cast<double>(first) / rate - half_line;
+    const double hi = static_cast<double>(first + count) / rate + half_line;
+    for (const AptLine& line : lines) {
+        double t = static_cast<double>(begin) / rate + line.start_pixel / APT_PIXEL_RATE;
+        if (t >= lo && t < hi) out.push_back({t, line});
+    }
+}
+
+static bool process_capture(ThreadPool& pool, const std::string& input, const DemodOptions& opts) {
+    IqFile file;
+    if (!file.open(input, opts.sample_rate)) {
+        return false;
+    }
+    if (file.num_samples() == 0) {
+        std::cerr << "Error: Empty capture: " << input << std::endl;
+        return false;
+    }
+
+    DemodConfig config;
+    config.input_rate = opts.sample_rate;
+    DemodPipeline probe;
+    if (!probe.configure(config)) {
+        std::cerr << "Error: No demodulation rate plan for " << opts.sample_rate << " S/s" << std::endl;
+        return false;
+    }
+    const uint64_t period = static_cast<uint64_t>(probe.stage1().decimation()) *
+        probe.stage2().decimation() * probe.resampler().decimation();
+    const int outputs_per_period = probe.resampler().interpolation();
+    const uint32_t audio_rate = probe.audio_rate();
+
+    std::vector<IqChunk> chunks = file.chunks(
+        static_cast<uint64_t>(opts.chunk_sec * opts.sample_rate),
+        static_cast<uint64_t>(opts.margin_sec * opts.sample_rate), period);
+
+    std::cout << "Capture: " << input << "\n";
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "  Duration:    " << file.duration_sec() << " s at " << opts.sample_rate / 1e6 << " MS/s\n";
+    std::cout << "  Chunks:      " << chunks.size() << " x " << opts.chunk_sec << " s on "
+              << pool.size() << " threads\n";
+
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<std::vector<float>> parts(chunks.size());
+    TaskGroup demod_group;
+    for (size_t i = 0; i < chunks.size(); i++) {
+        pool.submit(demod_group, [&, i]() {
+            demod_chunk(file, chunks[i], opts, period, outputs_per_period, parts[i]);
+        });
+    }
+    demod_group.wait();
+
+    std::vector<float> audio;
+    audio.reserve(std::accumulate(parts.begin(), parts.end(), size_t(0),
+        [](size_t n, const std::vector<float>& p) { return n + p.size(); }));
+    for (auto& part : parts) {
+        audio.insert(audio.end(), part.begin(), part.end());
+        std::vector<float>().swap(part);
+    }
+    double demod_sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    const std::string base = output_base(input, opts.output_dir);
+    const std::string wav_file = base + ".wav";
+    WavWriter wav;
+    if (!wav.open(wav_file, audio_rate, opts.audio_format) ||
+        !wav.write(audio.data(), audio.size()) || !wav.close()) {
+        std::cerr << "Error: Cannot write audio: " << wav_file << std::endl;
+        return false;
+    }
+    std::cout << "  Demodulated: " << std::setprecision(2) << demod_sec << " s ("
+              << std::setprecision(0) << file.duration_sec() / std::max(demod_sec, 1e-9)
+              << "x real time)\n";
+    std::cout << "  Audio:       " << wav_file << "\n";
+
+    if (!opts.image) {
+        return true;
+    }
+
+    AptDecoder check;
+    if (!check.configure(audio_rate)) {
+        std::cerr << "Error: Audio rate too low for APT decoding" << std::endl;
+        return false;
+    }
+    t0 = std::chrono::steady_clock::now();
+    const size_t apt_chunk = static_cast<size_t>(APT_CHUNK_SEC * audio_rate);
+    const size_t warmup = static_cast<size_t>(APT_WARMUP_SEC * audio_rate);
+    const size_t num_apt = (audio.size() + apt_chunk - 1) / apt_chunk;
+    std::vector<std::vector<PlacedLine>> placed(num_apt);
+    TaskGroup apt_group;
+    for (size_t i = 0; i < num_apt; i++) {
+        pool.submit(apt_group, [&, i]() {
+            decode_apt_chunk(audio, audio_rate, i * apt_chunk, apt_chunk, warmup, placed[i]);
+        });
+    }
+    apt_group.wait();
+
+    // Seams: chunks overlap by half a line either side, so a line near a
+    // boundary can come from both; of two starts closer than half a line
+    // keep the synced (then the better) one
+    std::vector<PlacedLine> merged;
+    for (auto& chunk_lines : placed) {
+        for (auto& p : chunk_lines) {
+            if (!merged.empty() && p.start_sec - merged.back().start_sec < 0.25) {
+                const AptLine& prev = merged.back().line;
+                bool better = (p.line.synced && !prev.synced) ||
+                              (p.line.synced == prev.synced && p.line.sync_quality > prev.sync_quality);
+                if (better) merged.back() = p;
+                continue;
+            }
+            merged.push_back(p);
+        }
+    }
+
+    AptImage image;
+    size_t synced = 0;
+    for (const PlacedLine& p : merged) {
+        image.add(p.line);
+        if (p.line.synced) synced++;
+    }
+    double apt_sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    const std::string png_file = base + ".png";
+    if (image.height() == 0) {
+        std::cerr << "Warning: Recording too short for a single APT line" << std::endl;
+        return true;
+    }
+    if (!image.save_png(png_file)) {
+        std::cerr << "Error: Cannot write image: " << png_file << std::endl;
+        return false;
+    }
+    std::cout << "  Image:       " << png_file << " (" << image.height() << " lines, "
+              << synced << " synced, " << std::setprecision(2) << apt_sec << " s)\n";
+    return true;
+}
+
+void print_usage(const char* progname) {
+    std::cout << "Usage: " << progname << " [options] <capture.bin> [...]\n"
+              << "\nDemodulates raw u8 I/Q captures (rtlsdr_capture -o) to <name>.wav and\n"
+              << "decodes the APT image to <name>.png, in parallel chunks.\n"
+              << "\nOptions:\n"
+              << "  -s <rate>      Capture sample rate in Hz (default: " << DEFAULT_SAMPLE_RATE << ")\n"
+              << "  -o <dir>       Output directory (default: next to each capture)\n"
+              << "  -j <threads>   Worker threads (default: all CPUs)\n"
+              << "  --chunk=<sec>  I/Q seconds per parallel task (default: " << DEFAULT_CHUNK_SEC << ")\n"
+              << "  --margin=<sec> Warm-up before each chunk (default: " << DEFAULT_MARGIN_SEC << ")\n"
+              << "  --no-image     Audio only\n"
+              << "  --audio-format=<fmt>  Audio sample format: s16, f32 (default: s16)\n"
+              << "  --iq-correct   Remove DC offset and I/Q imbalance before demodulating\n"
+              << "  -p <file>      Doppler profile the capture was made without correcting for\n"
+              << "  --offset=<hz>  Tuner center minus carrier used for the capture\n"
+              << "  --profile-start=<sec>  Profile time at the first sample (default: 0)\n"
+              << "  -h             Show this help\n"
+              << "\nExample:\n"
+              << "  " << progname << " -j 8 -o decoded/ passes/*.bin\n"
+              << "  " << progname << " -p doppler.json --offset=100000 capture.bin\n";
+}
+
+int main(int argc, char *argv[]) {
+    DemodOptions opts;
+    int threads = 0;
+    std::string profile_file;
+
+    enum { OPT_CHUNK = 256, OPT_MARGIN, OPT_NO_IMAGE, OPT_AUDIO_FORMAT, OPT_IQ_CORRECT,
+           OPT_OFFSET, OPT_PROFILE_START };
+    static struct option long_options[] = {
+        {"chunk",        required_argument, nullptr, OPT_CHUNK},
+        {"margin",       required_argument, nullptr, OPT_MARGIN},
+        {"no-image",     no_argument,       nullptr, OPT_NO_IMAGE},
+        {"audio-format", required_argument, nullptr, OPT_AUDIO_FORMAT},
+        {"iq-correct",   no_argument,       nullptr, OPT_IQ_CORRECT},
+        {"offset",       required_argument, nullptr, OPT_OFFSET},
+        {"profile-start", required_argument, nullptr, OPT_PROFILE_START},
+        {"help",         no_argument,       nullptr, 'h'},
+        {nullptr, 0, nullptr, 0}
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "s:o:j:p:h", long_options, nullptr)) != -1) {
+        switch (opt) {
+            case 's':
+                opts.sample_rate = static_cast<uint32_t>(std::stoul(optarg));
+                break;
+            case 'o':
+                opts.output_dir = optarg;
+                break;
+            case 'j':
+                threads = std::stoi(optarg);
+                break;
+            case 'p':
+                profile_file = optarg;
+                break;
+            case OPT_CHUNK:
+                opts.chunk_sec = std::stod(optarg);
+                break;
+            case OPT_MARGIN:
+                opts.margin_sec = std::stod(optarg);
+                break;
+            case OPT_NO_IMAGE:
+                opts.image = false;
+                break;
+            case OPT_AUDIO_FORMAT:
+                if (!parse_audio_format(optarg, opts.audio_format)) {
+                    std::cerr << "Error: Unknown audio format: " << optarg << "\n";
+                    return 1;
+                }
+                break;
+            case OPT_IQ_CORRECT:
+                opts.iq_correction = true;
+                break;
+            case OPT_OFFSET:
+                opts.tune_offset_hz = std::stod(optarg);
+                break;
+            case OPT_PROFILE_START:
+                opts.profile_start_sec = std::stod(optarg);
+                break;
+            case 'h':
+            default:
+                print_usage(argv[0]);
+                return (opt == 'h') ? 0 : 1;
+        }
+    }
+
+    if (optind >= argc) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    if (opts.chunk_sec <= 0.0 || opts.margin_sec < 0.0) {
+        std::cerr << "Error: --chunk must be positive and --margin non-negative\n";
+        return 1;
+    }
+
+    DopplerProfile profile;
+    if (!profile_file.empty()) {
+        if (!profile.load(profile_file)) {
+            return 1;
+        }
+        opts.doppler = &profile;
+    }
+
+    ThreadPool pool(threads);
+    int failed = 0;
+    for (int i = optind; i < argc; i++) {
+        if (!process_capture(pool, argv[i], opts)) failed++;
+        if (i + 1 < argc) std::cout << "\n";
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,118 @@
+/*
+ * satgs_features_py.cpp
+ * Satellite Ground Station - Python Module for Batch Pass Features
+ *
+ * pybind11 wrapper of PassFeatureCache, imported by
+ * python/ml/feature_engineering.py from cpp/build:
+ *
+ *   cache = satgs_features.PassFeatureCache('config.json')
+ *   cache.load_tles('weather.txt', ['NOAA 15', 'NOAA 18', 'NOAA 19'])
+ *   cache.update(time.time(), 48 * 3600)  # satellites propagated
+ *   cols = cache.features()              # {name: numpy array}, AOS order
+ *   scores = cache.score(cloud_cover_pct=70, recent_aos_unix=[...])
+ *
+ * Elements that did not change keep their passes between calls, and
+ * score() only reruns the pass_scorer rules over the cached columns, so
+ * a weather update costs no propagation. update() runs without the GIL.
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+#include <pybind11/stl.h>
+
+#include <cmath>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "pass_features.h"
+
+namespace py = pybind11;
+
+static PassFeatureCache* make_cache(const std::string& config) {
+    GroundStation station;
+    if (!config.empty() && !station.load(config)) {
+        throw std::runtime_error("cannot load station config: " + config);
+    }
+    return new PassFeatureCache(station);
+}
+
+// Names of the satellites whose elements changed
+static std::vector<std::string> load_tles(PassFeatureCache& cache, const std::string& filename,
+                                          const std::vector<std::string>& satellites) {
+    std::vector<Tle> tles;
+    if (!load_tle_file(filename, tles)) throw std::runtime_error("cannot read TLE file: " + filename);
+
+    std::vector<std::string> changed;
+    auto add = [&](const Tle& tle) {
+        if (cache.set_tle(tle)) changed.push_back(tle.name);
+    };
+    if (satellites.empty()) {
+        for (const Tle& tle : tles) add(tle);
+    }
+    for (const std::string& name : satellites) {
+        const Tle* tle = find_tle(tles, name);
+        if (!tle) throw std::runtime_error("satellite not in " + filename + ": " + name);
+        add(*tle);
+    }
+    return changed;
+}
+
+static bool set_tle(PassFeatureCache& cache, const std::string& name, const std::string& line1,
+                    const std::string& line2) {
+    Tle tle;
+    if (!parse_tle(line1, line2, name, tle)) throw std::runtime_error("malformed element set: " + name);
+    return cache.set_tle(tle);
+}
+
+static py::dict features(const PassFeatureCache& cache) {
+    const PassFeatureTable& table = cache.table();
+    py::dict out;
+    py::list names;
+    for (int index : table.satellite) names.append(cache.satellites()[index]);
+    out["satellite"] = names;
+    out["satellite_index"] = py::array_t<int>(table.size(), table.satellite.data());
+    for (size_t i = 0; i < kPassFeatureColumnCount; i++) {
+        const std::vector<double>& column = table.*kPassFeatureColumns[i].column;
+        out[kPassFeatureColumns[i].name] = py::array_t<double>(column.size(), column.data());
+    }
+    return out;
+}
+
+static py::array_t<double> score(const PassFeatureCache& cache, std::optional<double> cloud_cover_pct,
+                                 std::optional<double> precipitation_prob,
+                                 const std::vector<double>& recent_aos_unix) {
+    std::vector<double> scores;
+    cache.score(cloud_cover_pct.value_or(NAN), precipitation_prob.value_or(NAN), recent_aos_unix, scores);
+    return py::array_t<double>(scores.size(), scores.data());
+}
+
+PYBIND11_MODULE(satgs_features, m) {
+    m.doc() = "Batch pass features and scores from SGP4, cached per element set";
+
+    py::class_<PassFeatureCache>(m, "PassFeatureCache")
+        .def(py::init(&make_cache), py::arg("config") = "config.json",
+             "Station from config.json ('' for the built-in defaults)")
+        .def("load_tles", &load_tles, py::arg("filename"), py::arg("satellites") = std::vector<std::string>(),
+             "Add or refresh element sets from a TLE file (all, or the named satellites); "
+             "returns the names whose elements changed")
+        .def("set_tle", &set_tle, py::arg("name"), py::arg("line1"), py::arg("line2"),
+             "True when the elements differ from the cached ones")
+        .def("remove", &PassFeatureCache::remove, py::arg("name"))
+        .def("update", &PassFeatureCache::update, py::arg("start_unix"), py::arg("span_sec"),
+             py::call_guard<py::gil_scoped_release>(),
+             "Passes with AOS in [start, start + span); returns the satellites propagated")
+        .def("features", &features, "Feature columns of the last update, AOS order")
+        .def("score", &score, py::arg("cloud_cover_pct") = py::none(), py::arg("precipitation_prob") = py::none(),
+             py::arg("recent_aos_unix") = std::vector<double>(), "pass_scorer.score_pass of every row")
+        .def_property_readonly("satellites", &PassFeatureCache::satellites)
+        .def("__len__", [](const PassFeatureCache& cache) { return cache.table().size(); });
+
+    py::list columns;
+    for (size_t i = 0; i < kPassFeatureColumnCount; i++) columns.append(kPassFeatureColumns[i].name);
+    m.attr("FEATURE_COLUMNS") = columns;
+}
@@ -0,0 +1,519 @@
+/*
+ * satgs_orbits.cpp
+ * Satellite Ground Station - Orbital Data Export for the HMI
+ *
+ * Writes orbital_data.bin (orbit_data.h) for satellite-viz.html: earth-
+ * fixed positions every step for the next hours, and each pass with its
+ * azimuths and, for satellites with a downlink, the elevation and Doppler
+ * curves generate_orbital_data.py computes. Propagation is the embedded
+ * SGP4, a batch per segment.
+ *
+ * Run again on the same output, it keeps every segment that is still
+ * ahead of now and propagates only the hours added at the end, as long
+ * as the element sets, catalog, station and steps are the ones the file
+ * was made from; otherwise (or with --full) it starts over.
+ *
+ * The catalog (--catalog) is a JSON array of {"name", "norad_id",
+ * "freq_hz", "color", "role", "search_names"}, as TRACKED_SATS in
+ * generate_orbital_data.py; freq_hz null means display only. A TLE is
+ * matched by NORAD number, then by the search names.
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <getopt.h>
+#include <sys/stat.h>
+
+#include "cli_util.h"
+#include "doppler_profile.h"
+#include "json_reader.h"
+#include "mapped_file.h"
+#include "orbit.h"
+#include "orbit_data.h"
+
+#define DEFAULT_HOURS           24.0
+#define DEFAULT_STEP_SEC        30.0    // As generate_orbital_data.py --step
+#define DEFAULT_DOPPLER_STEP    5.0     // As compute_doppler_for_pass
+#define DEFAULT_SEGMENT_MIN     60.0
+#define ORBIT_PASS_MAX_SEC      1800.0  // Longer than any LEO pass over the mask
+
+static const char* kPalette[] = {"#34d399", "#2dd4bf", "#38bdf8", "#a78bfa", "#f472b6", "#fbbf24"};
+
+// ----------------------------------------------------------------------------
+// Catalog
+// ----------------------------------------------------------------------------
+
+struct CatalogEntry {
+    std::string name;
+    int norad_id = 0;
+    double freq_hz = 0.0;               // 0 = no downlink, no Doppler
+    std::string color;
+    std::string role = "display";
+    std::vector<std::string> search_names;
+};
+
+static bool load_catalog(const std::string& filename, std::vector<CatalogEntry>& catalog) {
+    MappedFile file;
+    if (!file.open(filename)) {
+        std::cerr << "Error: Cannot load catalog: " << filename << std::endl;
+        return false;
+    }
+
+    JsonReader json(file.data(), file.size());
+    std::string_view key, text;
+    double value;
+    json.begin_array();
+    while (json.next_element()) {
+        CatalogEntry entry;
+        json.begin_object();
+        while (json.next_key(key)) {
+            if (key == "name" && json.peek() == '"' && json.read_string(text)) {
+                entry.name.assign(text);
+            } else if (key == "norad_id" && json.peek() != 'z' && json.read_number(value)) {
+                entry.norad_id = static_cast<int>(value);
+            } else if (key == "freq_hz" && json.peek() != 'z' && json.read_number(value)) {
+                entry.freq_hz = value;
+            } else if (key == "color" && json.peek() == '"' && json.read_string(text)) {
+                entry.color.assign(text);
+            } else if (key == "role" && json.peek() == '"' && json.read_string(text)) {
+                entry.role.assign(text);
+            } else if (key == "search_names" && json.peek() == '[') {
+                json.begin_array();
+                while (json.next_element()) {
+                    if (json.peek() == '"' && json.read_string(text)) {
+                        entry.search_names.emplace_back(text);
+                    } else {
+                        json.skip_value();
+                    }
+                }
+            } else {
+                json.skip_value();
+            }
+        }
+        if (!entry.name.empty()) catalog.push_back(entry);
+    }
+
+    if (!json.ok()) {
+        std::cerr << "Error: Malformed catalog " << filename << " near byte " << json.error_offset() << std::endl;
+        return false;
+    }
+    if (catalog.empty()) {
+        std::cerr << "Error: No satellites in catalog: " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+static const Tle* match_tle(const std::vector<Tle>& tles, const CatalogEntry& entry) {
+    if (entry.norad_id > 0) {
+        for (const Tle& tle : tles) {
+            if (tle.satnum == entry.norad_id) return &tle;
+        }
+    }
+    for (const std::string& name : entry.search_names) {
+        if (const Tle* tle = find_tle(tles, name)) return tle;
+    }
+    return find_tle(tles, entry.name);
+}
+
+// ----------------------------------------------------------------------------
+// Export
+// ----------------------------------------------------------------------------
+
+struct TrackedSatellite {
+    CatalogEntry entry;
+    Tle tle;
+    PassPredictor predictor;
+};
+
+// Everything the segments depend on besides the step sizes; a file whose
+// meta differs is regenerated
+static std::string build_meta(const GroundStation& station, const std::vector<TrackedSatellite>& sats) {
+    std::ostringstream meta;
+    meta << std::setprecision(10)
+         << "{\"ground_station\": {\"name\": " << json_string(station.name)
+         << ", \"lat\": " << station.lat_deg << ", \"lon\": " << station.lon_deg
+         << ", \"elevation_m\": " << station.elevation_m
+         << ", \"min_elevation_deg\": " << station.min_elevation_deg << "}, \"satellites\": [";
+    for (size_t i = 0; i < sats.size(); i++) {
+        const TrackedSatellite& s = sats[i];
+        meta << (i ? ", " : "") << "{\"name\": " << json_string(s.entry.name)
+             << ", \"tle_name\": " << json_string(s.tle.name) << ", \"norad_id\": " << s.tle.satnum
+             << ", \"freq_hz\": ";
+        if (s.entry.freq_hz > 0.0) meta << s.entry.freq_hz;
+        else meta << "null";
+        meta << ", \"color\": " << json_string(s.entry.color) << ", \"role\": " << json_string(s.entry.role)
+             << ", \"epoch\": " << json_string(format_utc_timestamp(jd_to_unix(s.tle.epoch_jd)))
+             << ", \"epoch_jd\": " << std::setprecision(15) << s.tle.epoch_jd << std::setprecision(10)
+             << ", \"inclination_deg\": " << std::round(s.tle.inclo * 180.0 / M_PI * 100.0) / 100.0
+             << ", \"period_min\": " << std::round(s.predictor.sgp4().period_min() * 100.0) / 100.0 << "}";
+    }
+    meta << "]}";
+    return meta.str();
+}
+
+// Positions and passes (AOS in [start, start + segment)) of one segment
+static bool propagate_segment(const std::vector<TrackedSatellite>& sats, double start, double segment_sec,
+                              double step_sec, double doppler_step_sec, std::vector<uint8_t>& out,
+                              size_t& num_passes) {
+    size_t samples = static_cast<size_t>(std::llround(segment_sec / step_sec));
+    std::vector<std::vector<double>> tracks(sats.size());
+    std::vector<OrbitPass> passes;
+
+    for (size_t s = 0; s < sats.size(); s++) {
+        const PassPredictor& predictor = sats[s].predictor;
+        tracks[s].resize(3 * samples);
+        if (predictor.position_batch(start, step_sec, samples, tracks[s].data()) != 0) {
+            std::cerr << "Warning: SGP4 failed for " << sats[s].entry.name << " after "
+                      << format_utc_timestamp(start) << std::endl;
+        }
+
+        // Searched from earlier so a pass is never cut at the segment start
+        std::vector<SatellitePass> found;
+        double search_start = start - ORBIT_PASS_MAX_SEC;
+        predictor.find_passes(search_start, segment_sec + 2.0 * ORBIT_PASS_MAX_SEC, found);
+        for (const SatellitePass& pass : found) {
+            if (pass.aos_unix < start || pass.aos_unix >= start + segment_sec || pass.aos_unix <= search_start) {
+                continue;
+            }
+            OrbitPass p;
+            p.satellite = static_cast<uint32_t>(s);
+            p.pass = pass;
+            LookAngles look;
+            if (predictor.look(pass.aos_unix, look)) p.aos_az_deg = look.azimuth_deg;
+            if (predictor.look(pass.tca_unix, look)) {
+                p.tca_az_deg = look.azimuth_deg;
+                p.tca_range_km = look.range_km;
+            }
+            if (predictor.look(pass.los_unix, look)) p.los_az_deg = look.azimuth_deg;
+
+            double freq_hz = sats[s].entry.freq_hz;
+            if (freq_hz > 0.0) {
+                size_t n = static_cast<size_t>((pass.los_unix - pass.aos_unix) / doppler_step_sec) + 1;
+                std::vector<LookAngles> looks(n);
+                predictor.look_batch(pass.aos_unix, doppler_step_sec, n, looks.data());
+                for (const LookAngles& l : looks) {
+                    p.elevation_deg.push_back(l.elevation_deg);
+                    p.doppler_hz.push_back(PassPredictor::doppler_hz(l, freq_hz));
+                }
+            }
+            passes.push_back(p);
+        }
+    }
+    std::sort(passes.begin(), passes.end(),
+              [](const OrbitPass& a, const OrbitPass& b) { return a.pass.aos_unix < b.pass.aos_unix; });
+
+    orbit_encode_segment(start, samples, tracks, passes, out);
+    num_passes = passes.size();
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// --info
+// ----------------------------------------------------------------------------
+
+static int print_info(const std::string& filename) {
+    OrbitDataReader reader;
+    if (!reader.open(filename)) return 1;
+    const OrbitDataHeader& h = reader.header();
+
+    std::ostringstream text;
+    text << std::fixed << std::setprecision(1)
+         << "File:       " << filename << "\n"
+         << "Generated:  " << format_utc_timestamp(h.generated_unix) << "\n"
+         << "Positions:  from " << format_utc_timestamp(h.start_unix) << ", every " << h.step_sec << " s\n"
+         << "Doppler:    every " << h.doppler_step_sec << " s\n"
+         << "Segments:   " << h.num_segments << " of " << h.segment_sec / 60.0 << " min\n"
+         << "Satellites: " << h.num_satellites << " (" << h.meta_bytes << " bytes of meta)\n";
+
+    // Everything decodes, and to radii an orbit can have
+    size_t total_passes = 0, bad = 0;
+    double min_r = 1e9, max_r = 0.0;
+    std::vector<double> xyz;
+    std::vector<OrbitPass> passes;
+    for (size_t i = 0; i < reader.segments().size(); i++) {
+        const OrbitDataReader::Segment& s = reader.segments()[i];
+        for (uint32_t sat = 0; sat < h.num_satellites; sat++) {
+            if (!reader.decode_track(i, sat, xyz)) {
+                bad++;
+                continue;
+            }
+            for (size_t k = 0; k < s.samples; k++) {
+                double r = std::hypot(xyz[3 * k], xyz[3 * k + 1], xyz[3 * k + 2]);
+                min_r = std::min(min_r, r);
+                max_r = std::max(max_r, r);
+            }
+        }
+        passes.clear();
+        if (!reader.decode_passes(i, passes)) bad++;
+        total_passes += passes.size();
+        text << "  " << format_utc_timestamp(s.start_unix) << "  " << s.samples << " samples, "
+             << s.passes << " passes, " << s.bytes << " bytes\n";
+        for (const OrbitPass& p : passes) {
+            text << "      sat " << p.satellite << "  AOS " << format_utc_timestamp(p.pass.aos_unix)
+                 << "  max el " << p.pass.max_elevation_deg << " deg, "
+                 << (p.pass.los_unix - p.pass.aos_unix) / 60.0 << " min";
+            if (!p.doppler_hz.empty()) {
+                auto range = std::minmax_element(p.doppler_hz.begin(), p.doppler_hz.end());
+                text << ", Doppler " << std::showpos << *range.first << " to " << *range.second
+                     << std::noshowpos << " Hz";
+            }
+            text << "\n";
+        }
+    }
+    text << "Passes:     " << total_passes << "\n";
+    if (max_r > 0.0) text << "Radius:     " << min_r << " - " << max_r << " km\n";
+    std::cout << text.str() << "Meta:       " << reader.meta() << std::endl;
+
+    if (bad > 0) {
+        std::cerr << "Error: " << bad << " blocks failed to decode" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// ----------------------------------------------------------------------------
+// Main
+// ----------------------------------------------------------------------------
+
+void print_usage(const char* progname) {
+    std::cout << "Usage: " << progname << " -T <tle file>[,...] [options]\n"
+              << "       " << progname << " --info=<file.bin>\n"
+              << "\nOptions:\n"
+              << "  -T <files>     TLE files, comma-separated or repeated\n"
+              << "  -S <names>     Satellites, comma-separated (default: NOAA 15,NOAA 18,NOAA 19)\n"
+              << "  --catalog=<file>  Satellite catalog (JSON, as TRACKED_SATS); replaces -S\n"
+              << "  -c <file>      Station config (default: config.json)\n"
+              << "  -o <file>      Output (default: orbital_data.bin)\n"
+              << "  --hours=<h>    Window ahead of now (default: " << DEFAULT_HOURS << ")\n"
+              << "  --step=<sec>   Position interval (default: " << DEFAULT_STEP_SEC << ")\n"
+              << "  --doppler-step=<sec>  Doppler and elevation interval (default: "
+              << DEFAULT_DOPPLER_STEP << ")\n"
+              << "  --segment=<min>  Segment length; a refresh keeps whole segments (default: "
+              << DEFAULT_SEGMENT_MIN << ")\n"
+              << "  --full         Propagate everything, even if the output could be extended\n"
+              << "  --info=<file>  Decode a file, print its segments and passes, and exit\n"
+              << "  -h             Show this help\n"
+              << "\nExample:\n"
+              << "  " << progname << " -T weather.txt -o hmi/orbital_data.bin\n"
+              << "  " << progname << " -T tle_weather.txt,tle_stations.txt --catalog=catalog.json --hours=48\n";
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> tle_files;
+    std::string config_file = "config.json";
+    std::string satellites;
+    std::string catalog_file;
+    std::string output_file = "orbital_data.bin";
+    std::string info_file;
+    double hours = DEFAULT_HOURS;
+    double step_sec = DEFAULT_STEP_SEC;
+    double doppler_step_sec = DEFAULT_DOPPLER_STEP;
+    double segment_min = DEFAULT_SEGMENT_MIN;
+    bool full = false;
+
+    enum { OPT_CATALOG = 256, OPT_HOURS, OPT_STEP, OPT_DOPPLER_STEP, OPT_SEGMENT, OPT_FULL, OPT_INFO };
+    static const struct option long_options[] = {
+        {"catalog",  required_argument, nullptr, OPT_CATALOG},
+        {"hours",    required_argument, nullptr, OPT_HOURS},
+        {"step",     required_argument, nullptr, OPT_STEP},
+        {"doppler-step", required_argument, nullptr, OPT_DOPPLER_STEP},
+        {"segment",  required_argument, nullptr, OPT_SEGMENT},
+        {"full",     no_argument,       nullptr, OPT_FULL},
+        {"info",     required_argument, nullptr, OPT_INFO},
+        {"help",     no_argument,       nullptr, 'h'},
+        {nullptr, 0, nullptr, 0}
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "T:S:c:o:h", long_options, nullptr)) != -1) {
+        switch (opt) {
+            case 'T': {
+                std::stringstream names(optarg);
+                std::string name;
+                while (std::getline(names, name, ',')) {
+                    if (!name.empty()) tle_files.push_back(name);
+                }
+                break;
+            }
+            case 'S':
+                satellites = optarg;
+                break;
+            case 'c':
+                config_file = optarg;
+                break;
+            case 'o':
+                output_file = optarg;
+                break;
+            case OPT_CATALOG:
+                catalog_file = optarg;
+                break;
+            case OPT_HOURS:
+                hours = std::stod(optarg);
+                break;
+            case OPT_STEP:
+                step_sec = std::stod(optarg);
+                break;
+            case OPT_DOPPLER_STEP:
+                doppler_step_sec = std::stod(optarg);
+                break;
+            case OPT_SEGMENT:
+                segment_min = std::stod(optarg);
+                break;
+            case OPT_FULL:
+                full = true;
+                break;
+            case OPT_INFO:
+                info_file = optarg;
+                break;
+            case 'h':
+            default:
+                print_usage(argv[0]);
+                return (opt == 'h') ? 0 : 1;
+        }
+    }
+
+    if (!info_file.empty()) return print_info(info_file);
+
+    if (tle_files.empty()) {
+        std::cerr << "Error: TLE file (-T) required\n";
+        print_usage(argv[0]);
+        return 1;
+    }
+    double segment_sec = segment_min * 60.0;
+    double per_segment = segment_sec / step_sec;
+    if (hours <= 0.0 || step_sec <= 0.0 || doppler_step_sec <= 0.0) {
+        std::cerr << "Error: --hours, --step and --doppler-step must be positive\n";
+        return 1;
+    }
+    if (per_segment < 2.0 || std::abs(per_segment - std::round(per_segment)) > 1e-9) {
+        std::cerr << "Error: --segment must be a whole number of steps, at least two\n";
+        return 1;
+    }
+
+    GroundStation station;
+    if (!station.load(config_file)) return 1;
+
+    std::vector<CatalogEntry> catalog;
+    if (!catalog_file.empty()) {
+        if (!load_catalog(catalog_file, catalog)) return 1;
+    } else {
+        std::stringstream names(satellites.empty() ? "NOAA 15,NOAA 18,NOAA 19" : satellites);
+        std::string name;
+        while (std::getline(names, name, ',')) {
+            if (name.empty()) continue;
+            CatalogEntry entry;
+            entry.name = name;
+            entry.freq_hz = downlink_freq_hz(name, 0.0);
+            entry.role = entry.freq_hz > 0.0 ? "weather" : "display";
+            entry.color = kPalette[catalog.size() % (sizeof(kPalette) / sizeof(kPalette[0]))];
+            catalog.push_back(entry);
+        }
+    }
+
+    std::vector<Tle> tles;
+    for (const std::string& file : tle_files) {
+        std::vector<Tle> more;
+        if (!load_tle_file(file, more)) return 1;
+        tles.insert(tles.end(), more.begin(), more.end());
+    }
+
+    std::vector<TrackedSatellite> sats;
+    for (const CatalogEntry& entry : catalog) {
+        const Tle* tle = match_tle(tles, entry);
+        TrackedSatellite s;
+        if (!tle) {
+            std::cerr << "Warning: No TLE for " << entry.name << ", skipped" << std::endl;
+            continue;
+        }
+        if (!s.predictor.init(*tle, station)) {
+            std::cerr << "Warning: Cannot propagate " << entry.name << ", skipped" << std::endl;
+            continue;
+        }
+        s.entry = entry;
+        s.tle = *tle;
+        sats.push_back(s);
+        std::cout << "Matched: " << entry.name << " -> " << tle->name << " (NORAD " << tle->satnum
+                  << ", epoch " << format_utc_timestamp(jd_to_unix(tle->epoch_jd)) << ")" << std::endl;
+    }
+    if (sats.empty()) {
+        std::cerr << "Error: No satellite matched a TLE" << std::endl;
+        return 1;
+    }
+
+    // Segments on a fixed grid, from the one holding now to past now + hours
+    double now = utc_now();
+    double first = std::floor(now / segment_sec) * segment_sec;
+    size_t num_segments = static_cast<size_t>(std::ceil((now + hours * 3600.0 - first) / segment_sec));
+    std::string meta = build_meta(station, sats);
+
+    // The parts of the previous export that are still ahead, if it was
+    // made from the same inputs
+    OrbitDataReader previous;
+    std::map<double, size_t> reusable;
+    struct stat st;
+    if (!full && stat(output_file.c_str(), &st) == 0 && previous.open(output_file)) {
+        const OrbitDataHeader& h = previous.header();
+        std::string_view old_meta = previous.meta();
+        while (!old_meta.empty() && old_meta.back() == ' ') old_meta.remove_suffix(1);
+        if (old_meta == meta && h.step_sec == step_sec && h.doppler_step_sec == doppler_step_sec &&
+            h.segment_sec == segment_sec && h.num_satellites == sats.size()) {
+            for (size_t i = 0; i < previous.segments().size(); i++) {
+                reusable[previous.segments()[i].start_unix] = i;
+            }
+        } else {
+            std::cout << "Inputs changed since the last export, propagating everything" << std::endl;
+        }
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<std::vector<uint8_t>> segments(num_segments);
+    size_t kept = 0, total_passes = 0;
+    for (size_t i = 0; i < num_segments; i++) {
+        double start = first + i * segment_sec;
+        auto it = reusable.find(start);
+        size_t passes = 0;
+        if (it != reusable.end()) {
+            const OrbitDataReader::Segment& s = previous.segments()[it->second];
+            const uint8_t* data = previous.segment_data(it->second);
+            segments[i].assign(data, data + s.bytes);
+            passes = s.passes;
+            kept++;
+        } else if (!propagate_segment(sats, start, segment_sec, step_sec, doppler_step_sec, segments[i], passes)) {
+            return 1;
+        }
+        total_passes += passes;
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    OrbitDataHeader header;
+    header.generated_unix = now;
+    header.start_unix = first;
+    header.step_sec = step_sec;
+    header.doppler_step_sec = doppler_step_sec;
+    header.segment_sec = segment_sec;
+    header.num_satellites = static_cast<uint32_t>(sats.size());
+    if (!orbit_write_file(output_file, header, meta, segments)) return 1;
+
+    size_t bytes = ORBIT_DATA_HEADER_SIZE + meta.size();
+    for (const auto& segment : segments) bytes += segment.size();
+    std::ostringstream summary;
+    summary << std::fixed << std::setprecision(1)
+            << "Segments: " << num_segments << " (" << kept << " kept, " << num_segments - kept
+            << " propagated in " << elapsed * 1e3 << " ms)\n"
+            << "Window:   " << format_utc_timestamp(first) << " + " << num_segments * segment_sec / 3600.0
+            << " h, " << sats.size() << " satellites, " << total_passes << " passes\n"
+            << "Output:   " << output_file << " (" << bytes / 1024.0 << " KB)\n";
+    std::cout << summary.str();
+    return 0;
+}
@@ -0,0 +1,450 @@
+/*
+ * satgs_pass.cpp
+ * Satellite Ground Station - Single-process Pass Executor
+ *
+ * Runs one NOAA APT pass end to end in one process, in place of
+ * rtlsdr_capture + doppler_tracker + the Python decoder talking through
+ * files:
+ *
+ *   AOS - warmup   open and tune the source, calibrate the slab pool on
+ *                  a trial stream (capture_session.h)
+ *   AOS            start streaming: USB reader -> NCO Doppler correction
+ *                  and FM demod -> APT decoder -> live PNG, each stage
+ *                  behind a bounded SPSC ring with backpressure. The
+ *                  stream is up STREAM_PREROLL_SEC early and kept from
+ *                  AOS on (CaptureSession::start_at)
+ *   LOS            stop; the decoder finishes the image from what is
+ *                  already in memory, so it is on disk seconds later
+ *
+ * No intermediate I/Q or audio touches the disk unless asked for (-o,
+ * -a). The pass window comes from the Doppler profile: its aos_utc and
+ * duration, or --aos. A profile written by doppler_calc.py or
+ * doppler_tracker -b carries both.
+ *
+ * Replayed and generated sources (--source, speed != 1) don't wait for
+ * the clock: the pass runs from its first sample, with profile time 0
+ * at the start of the data.
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <cmath>
+#include <csignal>
+#include <getopt.h>
+
+#include "capture_session.h"
+#include "cli_util.h"
+#include "doppler_profile.h"
+#include "dsp_pipeline.h"
+#include "io_scheduler.h"
+#include "metrics.h"
+#include "ppm_store.h"
+#include "thread_util.h"
+#include "waterfall_ring.h"
+
+#define DEFAULT_WARMUP_SEC  30      // Device opened this long before AOS
+#define WAIT_REPORT_SEC     60      // Countdown line interval while waiting
+
+// Global state
+static std::atomic<bool> g_running(true);
+
+void signal_handler(int signum) {
+    std::cerr << "\nSignal " << signum << " received, stopping pass..." << std::endl;
+    g_running = false;
+}
+
+// Sleep until Unix time `epoch_sec`, reporting now and then; false if
+// interrupted
+static bool wait_until_utc(double epoch_sec, const char* what) {
+    double last_report = 0.0;
+    while (g_running) {
+        double remaining = epoch_sec - utc_now();
+        if (remaining <= 0.0) return true;
+        if (last_report == 0.0 || last_report - remaining >= WAIT_REPORT_SEC) {
+            std::cout << what << " in " << static_cast<long>(std::ceil(remaining))
+                      << " s (" << format_utc_timestamp(epoch_sec) << ")" << std::endl;
+            last_report = remaining;
+        }
+        std::this_thread::sleep_for(std::chrono::duration<double>(std::min(remaining, 1.0)));
+    }
+    return false;
+}
+
+// One status line per second until LOS (or the data runs out)
+static void progress_loop(const CaptureSession& session, int duration_sec) {
+    auto start_time = std::chrono::steady_clock::now();
+    bool real_time = session.speed() == 1.0;
+
+    while (g_running && session.running()) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::steady_clock::now() - start_time).count();
+        if (real_time && elapsed >= duration_sec + WALL_STOP_GRACE_SEC) {
+            g_running = false;
+        }
+
+        CaptureStats stats = session.stats();
+        std::cout << "\r[" << stats.samples / session.config().sample_rate << "/" << duration_sec << "s] "
+                  << "Lines: " << stats.image_lines << ", "
+                  << "Queue: " << stats.queued << "/" << session.config().num_buffers << ", "
+                  << "Overflows: " << stats.overflows << ", "
+                  << "Gaps: " << stats.gaps << ", "
+                  << "Doppler: " << std::showpos << std::fixed << std::setprecision(1)
+                  << stats.doppler_hz << std::noshowpos << " Hz"
+                  << "     " << std::flush;
+    }
+    std::cout << std::endl;
+}
+
+void print_usage(const char* progname) {
+    std::cout << "Usage: " << progname << " -p <profile> -i <image.png> [options]\n"
+              << "\nOptions:\n"
+              << "  -p <file>      Doppler profile (.json or .dpb); sets the pass window\n"
+              << "                 and drives the NCO\n"
+              << "  -i <file.png>  APT image, filled in live and completed at LOS\n"
+              << "  -a <file.wav>  Also keep the demodulated audio\n"
+              << "  -o <file>      Also keep the raw I/Q (see --format)\n"
+              << "  -f <freq>      Carrier in Hz (default: the profile's center frequency)\n"
+              << "  -s <rate>      Sample rate in Hz (default: " << DEFAULT_SAMPLE_RATE << ")\n"
+              << "  -g <gain>      Gain in dB (default: " << DEFAULT_GAIN/10.0 << ")\n"
+              << "  -D <index>     RTL-SDR device index (default: 0)\n"
+              << "  --source=<spec>  Sample source: rtlsdr[:<index>], file:<path>[,...],\n"
+              << "                 synth[:...] (see rtlsdr_capture -h; default: rtlsdr)\n"
+              << "  --aos=<utc>    AOS as ISO 8601 UTC (default: the profile's aos_utc)\n"
+              << "  --warmup=<sec> Open the source and calibrate this long before AOS\n"
+              << "                 (default: " << DEFAULT_WARMUP_SEC << "; 0 = open at AOS, no calibration)\n"
+              << "  --offset=<hz>  Tune this far from the carrier (keeps it off the DC spike)\n"
+              << "  --format=<fmt> Raw I/Q format for -o: raw, sigmf, sgc (default: raw)\n"
+              << "  --track-carrier[=<hz>]  Frequency-locked loop on top of the profile\n"
+              << "                 (loop bandwidth, default " << FLL_BANDWIDTH_HZ << " Hz)\n"
+              << "  --ppm=<ppm>    Tuner crystal error to correct (rtl_sdr -p convention)\n"
+              << "  --ppm-store=<file>  Per-dongle ppm: start from the stored value, update it\n"
+              << "                 from this pass\n"
+              << "  --pin[=<io>,<reader>,<dsp>]  Pin the capture threads (default: 0,1,2)\n"
+              << "  --realtime     SCHED_FIFO reader and writer, locked buffers\n"
+              << "  --metrics=<port>  Serve Prometheus metrics on http://" << METRICS_BIND_ADDRESS
+              << ":<port>/metrics\n"
+              << "  --waterfall=<name>[,fft=<n>,avg=<n>,overlap=<f>,rate=<hz>,range=<dB>:<dB>]\n"
+              << "                 Publish live spectrum rows to /dev/shm/satgs-wf-<name> for the\n"
+              << "                 HMI (default " << SPECTRUM_DEFAULT_SIZE << " bins, " << SPECTRUM_DEFAULT_AVERAGES
+              << " averages, " << SPECTRUM_DEFAULT_ROW_RATE << " rows/s)\n"
+              << "  -h             Show this help\n"
+              << "\nExample:\n"
+              << "  " << progname << " -p noaa19.dpb -i noaa19.png --offset=100000\n"
+              << "  " << progname << " -p noaa19.dpb -i noaa19.png --track-carrier --ppm-store=ppm.json\n"
+              << "  " << progname << " -p pass.json -i test.png --source=synth:speed=max,doppler=pass.json\n";
+}
+
+int main(int argc, char* argv[]) {
+    std::string profile_file;
+    std::string image_file;
+    std::string audio_file;
+    std::string output_file;
+    std::string source;
+    CaptureFormat output_format = CaptureFormat::Raw;
+    uint32_t frequency = 0;
+    uint32_t sample_rate = DEFAULT_SAMPLE_RATE;
+    int gain = DEFAULT_GAIN;
+    int device_index = 0;
+    double aos_override = 0.0;
+    double warmup_sec = DEFAULT_WARMUP_SEC;
+    double tune_offset_hz = 0.0;
+    bool pin_threads = false;
+    std::vector<int> pin_cores = {0, 1, 2};
+    bool realtime = false;
+    int metrics_port = -1;
+    std::string waterfall_name;
+    SpectrumConfig spectrum;
+    bool track_carrier = false;
+    double fll_bandwidth_hz = FLL_BANDWIDTH_HZ;
+    bool ppm_set = false;
+    double ppm = 0.0;
+    std::string ppm_store_file;
+
+    enum { OPT_SOURCE = 256, OPT_AOS, OPT_WARMUP, OPT_OFFSET, OPT_FORMAT, OPT_PIN, OPT_REALTIME,
+           OPT_METRICS, OPT_WATERFALL, OPT_TRACK_CARRIER, OPT_PPM, OPT_PPM_STORE };
+    static const struct option long_options[] = {
+        {"source",   required_argument, nullptr, OPT_SOURCE},
+        {"aos",      required_argument, nullptr, OPT_AOS},
+        {"warmup",   required_argument, nullptr, OPT_WARMUP},
+        {"offset",   required_argument, nullptr, OPT_OFFSET},
+        {"format",   required_argument, nullptr, OPT_FORMAT},
+        {"pin",      optional_argument, nullptr, OPT_PIN},
+        {"realtime", no_argument,       nullptr, OPT_REALTIME},
+        {"metrics",  required_argument, nullptr, OPT_METRICS},
+        {"waterfall", required_argument, nullptr, OPT_WATERFALL},
+        {"track-carrier", optional_argument, nullptr, OPT_TRACK_CARRIER},
+        {"ppm",      required_argument, nullptr, OPT_PPM},
+        {"ppm-store", required_argument, nullptr, OPT_PPM_STORE},
+        {"help",     no_argument,       nullptr, 'h'},
+        {nullptr, 0, nullptr, 0}
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "p:i:a:o:f:s:g:D:h", long_options, nullptr)) != -1) {
+        switch (opt) {
+            case 'p':
+                profile_file = optarg;
+                break;
+            case 'i':
+                image_file = optarg;
+                break;
+            case 'a':
+                audio_file = optarg;
+                break;
+            case 'o':
+                output_file = optarg;
+                break;
+            case 'f':
+                frequency = std::stoul(optarg);
+                break;
+            case 's':
+                sample_rate = std::stoul(optarg);
+                break;
+            case 'g':
+                gain = static_cast<int>(std::stod(optarg) * 10);
+                break;
+            case 'D':
+                device_index = std::stoi(optarg);
+                break;
+            case OPT_SOURCE:
+                source = optarg;
+                break;
+            case OPT_AOS:
+                if (!parse_utc_timestamp(optarg, aos_override)) {
+                    std::cerr << "Error: Bad --aos timestamp: " << optarg << "\n";
+                    return 1;
+                }
+                break;
+            case OPT_WARMUP:
+                warmup_sec = std::stod(optarg);
+                break;
+            case OPT_OFFSET:
+                tune_offset_hz = std::stod(optarg);
+                break;
+            case OPT_FORMAT:
+                if (!parse_capture_format(optarg, output_format)) {
+                    std::cerr << "Error: Unknown output format: " << optarg << "\n";
+                    return 1;
+                }
+                break;
+            case OPT_PIN:
+                pin_threads = true;
+                if (optarg && (!parse_core_list(optarg, pin_cores) || pin_cores.size() != 3)) {
+                    std::cerr << "Error: --pin takes three cores: <io>,<reader>,<dsp>\n";
+                    return 1;
+                }
+                break;
+            case OPT_REALTIME:
+                realtime = true;
+                break;
+            case OPT_METRICS:
+                metrics_port = std::stoi(optarg);
+                break;
+            case OPT_WATERFALL:
+                if (!parse_waterfall_spec(optarg, waterfall_name, spectrum)) {
+                    std::cerr << "Error: Bad --waterfall spec: " << optarg << "\n";
+                    return 1;
+                }
+                break;
+            case OPT_TRACK_CARRIER:
+                track_carrier = true;
+                if (optarg) fll_bandwidth_hz = std::stod(optarg);
+                break;
+            case OPT_PPM:
+                ppm = std::stod(optarg);
+                ppm_set = true;
+                break;
+            case OPT_PPM_STORE:
+                ppm_store_file = optarg;
+                break;
+            case 'h':
+            default:
+                print_usage(argv[0]);
+                return (opt == 'h') ? 0 : 1;
+        }
+    }
+
+    if (profile_file.empty() || image_file.empty()) {
+        std::cerr << "Error: Doppler profile (-p) and image (-i) required\n";
+        print_usage(argv[0]);
+        return 1;
+    }
+    if (warmup_sec < 0.0) {
+        std::cerr << "Error: --warmup must not be negative\n";
+        return 1;
+    }
+    if (std::abs(tune_offset_hz) > sample_rate / 2.0 - DEMOD_CHANNEL_BW_HZ) {
+        std::cerr << "Error: --offset must keep the channel inside +/-"
+                  << (sample_rate / 2.0 - DEMOD_CHANNEL_BW_HZ) / 1e3 << " kHz\n";
+        return 1;
+    }
+    if (track_carrier && (fll_bandwidth_hz <= 0.0 || fll_bandwidth_hz > 10.0)) {
+        std::cerr << "Error: --track-carrier bandwidth must be in (0, 10] Hz\n";
+        return 1;
+    }
+    if (std::abs(ppm) > PPM_STORE_MAX) {
+        std::cerr << "Error: --ppm must be within +/-" << PPM_STORE_MAX << "\n";
+        return 1;
+    }
+    PpmStore ppm_store;
+    if (!ppm_store_file.empty() && !ppm_store.load(ppm_store_file)) {
+        return 1;
+    }
+
+    DopplerProfile profile;
+    if (!profile.load(profile_file)) {
+        return 1;
+    }
+    if (aos_override > 0.0) {
+        profile.aos_epoch_sec = aos_override;
+    }
+    double pass_sec = profile.getDuration();
+    if (pass_sec <= 0.0) {
+        std::cerr << "Error: Profile covers no time: " << profile_file << "\n";
+        return 1;
+    }
+    if (frequency == 0) {
+        frequency = profile.center_freq_hz > 0 ? static_cast<uint32_t>(profile.center_freq_hz) : DEFAULT_FREQ;
+    }
+
+    CaptureConfig config;
+    config.source = source;
+    config.waterfall_name = waterfall_name;
+    config.spectrum = spectrum;
+    config.device_index = device_index;
+    config.frequency = frequency;
+    config.sample_rate = sample_rate;
+    config.gain = gain;
+    config.filename = output_file;
+    config.format = output_format;
+    config.audio_filename = audio_file;
+    config.image_filename = image_file;
+    config.doppler = &profile;
+    config.tune_offset_hz = tune_offset_hz;
+    config.carrier_tracking = track_carrier;
+    config.fll_bandwidth_hz = fll_bandwidth_hz;
+    config.ppm_set = ppm_set;
+    config.ppm = ppm;
+    if (!ppm_store_file.empty()) {
+        config.ppm_store = &ppm_store;
+    }
+    config.calibrate_sec = warmup_sec > 0.0 ? std::min(warmup_sec, DEFAULT_CALIBRATE_SEC) : 0.0;
+
+    int io_core = -1;
+    if (pin_threads) {
+        io_core = pin_cores[0] % cpu_count();
+        config.reader_core = pin_cores[1] % cpu_count();
+        config.worker_core = pin_cores[2] % cpu_count();
+    }
+    if (realtime) {
+        config.reader_rt_priority = READER_RT_PRIORITY;
+        config.lock_memory = true;
+    }
+
+    signal(SIGINT, signal_handler);
+    signal(SIGTERM, signal_handler);
+
+    IoScheduler io(io_core);
+    if (realtime) {
+        io.set_realtime(IO_RT_PRIORITY);
+    }
+
+    // Only a dongle runs on the pass clock; replays start at AOS at once
+    bool live = source.empty() || source == "rtlsdr" || source.compare(0, 7, "rtlsdr:") == 0;
+    double aos = profile.aos_epoch_sec;
+    double los = aos + pass_sec;
+    std::cout << "Pass: " << std::lround(pass_sec) << " s, Doppler "
+              << profile.doppler_hz.front() << " to " << profile.doppler_hz.back() << " Hz\n";
+    if (live) {
+        if (aos <= 0.0) {
+            std::cerr << "Error: Profile has no aos_utc; give --aos\n";
+            return 1;
+        }
+        if (utc_now() >= los) {
+            std::cerr << "Error: Pass ended at " << format_utc_timestamp(los) << "\n";
+            return 1;
+        }
+        std::cout << "  AOS: " << format_utc_timestamp(aos) << "\n"
+                  << "  LOS: " << format_utc_timestamp(los) << "\n";
+        config.duration_sec = static_cast<int>(std::ceil(los - std::max(aos, utc_now())));
+        if (!wait_until_utc(aos - warmup_sec, "Warm-up")) {
+            return 1;
+        }
+    } else {
+        config.profile_start_set = true;
+        config.profile_start_sec = 0.0;
+        config.duration_sec = static_cast<int>(std::ceil(pass_sec));
+    }
+
+    // Warm-up: device open and tuned, pool sized on a trial stream
+    CaptureSession session(config);
+    if (!session.open(io)) {
+        return 1;
+    }
+    if (live) {
+        if (!wait_until_utc(aos - STREAM_PREROLL_SEC, "Stream start")) {
+            return 1;
+        }
+        // Joining mid-pass keeps the LOS; the NCO aligns the profile to
+        // the first sample's timestamp
+        session.set_duration(static_cast<int>(std::ceil(los - std::max(aos, utc_now()))));
+    }
+
+    std::cout << "\nStarting pass...\n";
+    io.start();
+    if (live) session.start_at(aos);
+    else session.start();
+    if (pin_threads || realtime) {
+        std::cout << "Real-time:\n";
+        session.print_placement(std::cout);
+        std::cout << "  I/O writer: " << describe_placement(io.placement()) << "\n";
+        if (pin_threads && !pin_current_thread_excluding({io_core, config.reader_core, config.worker_core})) {
+            std::cout << "  Progress:   shares the capture cores (" << cpu_count() << " online)\n";
+        }
+    }
+
+    MetricsServer metrics;
+    if (metrics_port >= 0) {
+        metrics.add_collector([&session](MetricsWriter& out) { session.collect_metrics(out); });
+        if (!metrics.start(metrics_port)) {
+            session.stop();
+            session.join();
+            return 1;
+        }
+        std::cout << "Metrics on http://" << METRICS_BIND_ADDRESS << ":" << metrics.port() << "/metrics\n";
+    }
+
+    progress_loop(session, session.config().duration_sec);
+
+    session.stop();
+    bool ok = session.join();
+    metrics.stop();
+
+    CaptureStats stats = session.stats();
+    std::cout << "\n========================================\n";
+    std::cout << "Pass complete!\n";
+    session.print_summary(std::cout);
+    double latency = session.image_latency_sec();
+    if (latency >= 0.0) {
+        std::cout << "  Ready:     " << std::setprecision(2) << latency << " s after the last sample\n";
+    }
+    std::cout << "========================================\n";
+
+    double learned;
+    if (!ppm_store_file.empty() && session.learned_ppm(learned) && !ppm_store.save()) {
+        ok = false;
+    }
+    if (stats.image_lines == 0) {
+        std::cerr << "Error: No APT lines decoded\n";
+        return 1;
+    }
+    return ok ? 0 : 1;
+}
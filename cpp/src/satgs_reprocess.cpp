@@ -0,0 +1,711 @@
+/*
+ * satgs_reprocess.cpp
+ * Satellite Ground Station - Parallel Re-decoding of the Capture Archive
+ *
+ * Walks directories of archived captures (raw u8 I/Q from rtlsdr_capture
+ * -o, or .sgc) and re-decodes every one into the data/ store, the way
+ * decode_apt.py leaves a pass:
+ *
+ *   <out>/<name>_decoded.png      APT image
+ *   <out>/<name>_metadata.json    decode_apt.py's fields, plus snr_db,
+ *                                 sync_rate and clock_error_ppm
+ *   data/metrics.json             one data_store.log_metrics entry per pass
+ *
+ * Each capture is memory-mapped and cut into I/Q chunks (iq_file.h),
+ * demodulated on a work-stealing ThreadPool. A capture keeps a fixed
+ * window of chunks in flight: whichever worker finishes the chunk that
+ * is next in order feeds it to the capture's streaming AptDecoder, then
+ * queues the chunk after the window on its own deque, where idle
+ * workers steal it. Several captures run at once so the pool stays
+ * saturated across short and long passes alike.
+ *
+ * Memory is bounded by the chunk budget (CHUNKS_PER_THREAD per worker,
+ * each a chunk of audio) plus one image per capture in flight; mapped
+ * pages are dropped as chunks are consumed, so a capture's length only
+ * changes how long it takes.
+ *
+ * Quality, per pass:
+ *   sync_rate   lines framed on a detected sync / lines decoded
+ *   snr_db      sync A white-black swing over the pixel noise in space A,
+ *               medians over the synced lines (envelope units, so
+ *               noise_floor_db / peak_signal_db are relative levels)
+ *
+ * A Doppler profile named <name>_doppler.json (or .dpb) in --doppler-dir
+ * is applied like satgs_demod -p; .sgc captures carry their own tuning
+ * offset and start time, so their profile lines up by UTC.
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <algorithm>
+#include <filesystem>
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <getopt.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+
+#include "apt_decoder.h"
+#include "cli_util.h"
+#include "doppler_profile.h"
+#include "dsp_pipeline.h"
+#include "iq_file.h"
+#include "mapped_file.h"
+#include "sgc_format.h"
+#include "thread_pool.h"
+
+#define DEFAULT_SAMPLE_RATE   2400000
+#define DEFAULT_CHUNK_SEC     20.0
+#define DEFAULT_MARGIN_SEC    0.5       // Filter and I/Q corrector settling
+#define DEMOD_BLOCK_BYTES     (16 * 16384) // Same block size as the capture path
+#define CHUNKS_PER_THREAD     2         // Chunk budget: in flight or waiting for their turn
+#define APT_SPACE_PIXELS      47        // Space A, after sync A
+#define SPACE_EDGE_PIXELS     4         // Left out next to each transition
+
+static bool write_text_file(const std::string& path, const std::string& text) {
+    std::string tmp = path + ".tmp";
+    FILE* f = std::fopen(tmp.c_str(), "w");
+    bool ok = f && std::fwrite(text.data(), 1, text.size(), f) == text.size();
+    ok = f && (std::fclose(f) == 0) && ok;
+    if (!ok || std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::cerr << "Error: Failed writing " << path << std::endl;
+        std::remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+// Appends objects to the JSON array data_store.py keeps
+static bool append_json_array(const std::string& path, const std::vector<std::string>& entries) {
+    std::string body = "[]";
+    struct stat st;
+    if (stat(path.c_str(), &st) == 0 && st.st_size > 0) {
+        MappedFile file;
+        if (!file.open(path)) {
+            std::cerr << "Error: Cannot read " << path << std::endl;
+            return false;
+        }
+        body.assign(file.data(), file.size());
+    }
+    size_t close = body.find_last_of(']');
+    size_t open = body.find('[');
+    if (open == std::string::npos || close == std::string::npos || close < open) {
+        std::cerr << "Error: Not a JSON array: " << path << std::endl;
+        return false;
+    }
+    bool empty = body.find_first_not_of(" \t\r\n", open + 1) == close;
+    size_t end = body.find_last_not_of(" \t\r\n", close - 1) + 1;
+
+    std::string added;
+    for (const std::string& entry : entries) {
+        added += (empty && added.empty()) ? "\n  " : ",\n  ";
+        added += entry;
+    }
+    return write_text_file(path, body.substr(0, empty ? open + 1 : end) + added + "\n]\n");
+}
+
+static double median(std::vector<float>& values) {
+    if (values.empty()) return 0.0;
+    auto mid = values.begin() + values.size() / 2;
+    std::nth_element(values.begin(), mid, values.end());
+    return *mid;
+}
+
+// ----------------------------------------------------------------------------
+// Captures
+// ----------------------------------------------------------------------------
+
+struct ReprocessOptions {
+    uint32_t sample_rate = DEFAULT_SAMPLE_RATE;     // Raw captures (.sgc has its own)
+    double chunk_sec = DEFAULT_CHUNK_SEC;
+    double margin_sec = DEFAULT_MARGIN_SEC;
+    bool iq_correction = false;
+    bool doppler = true;
+    bool skip_decoded = false;
+    int max_captures = 0;                           // 0 = from the thread count
+    std::string output_dir = "data/decoded";
+    std::string doppler_dir = "data/doppler";
+    std::string metrics_log = "data/metrics.json";
+};
+
+// Raw I/Q or .sgc, read in sample ranges
+class CaptureInput {
+public:
+    bool open(const std::string& path, uint32_t raw_rate) {
+        sgc_ = path.size() > 4 && path.compare(path.size() - 4, 4, ".sgc") == 0;
+        if (sgc_) {
+            if (!reader_.open(path)) return false;
+            const SgcHeader& h = reader_.header();
+            rate_ = h.sample_rate;
+            num_samples_ = reader_.stream_samples();
+            start_utc_ = reader_.entries().empty() ? h.created_utc : reader_.entries()[0].utc;
+            if (h.carrier_freq_hz != 0) {
+                tune_offset_hz_ = static_cast<double>(h.center_freq_hz) - static_cast<double>(h.carrier_freq_hz);
+            }
+            return rate_ > 0;
+        }
+        if (!raw_.open(path, raw_rate)) return false;
+        rate_ = raw_rate;
+        num_samples_ = raw_.num_samples();
+        return true;
+    }
+
+    // Chunks as IqFile::chunks cuts them; data is only set for raw files
+    std::vector<IqChunk> chunks(uint64_t chunk_samples, uint64_t margin, uint64_t align) const {
+        if (!sgc_) return raw_.chunks(chunk_samples, margin, align);
+        std::vector<IqChunk> out;
+        chunk_samples = std::max(align, (chunk_samples + align - 1) / align * align);
+        margin = (margin + align - 1) / align * align;
+        for (uint64_t start = 0; start < num_samples_; start += chunk_samples) {
+            IqChunk c;
+            c.index = out.size();
+            c.first_sample = start;
+            c.num_samples = std::min(chunk_samples, num_samples_ - start);
+            c.margin = std::min(margin, start);
+            out.push_back(c);
+        }
+        return out;
+    }
+
+    // fn(bytes, n) over the chunk's samples, margin included, in blocks
+    template <typename Fn>
+    bool for_each_block(const IqChunk& chunk, Fn fn) const {
+        if (!sgc_) {
+            raw_.prefetch(chunk);
+            const size_t total = chunk.data_bytes();
+            for (size_t pos = 0; pos < total; pos += DEMOD_BLOCK_BYTES) {
+                fn(chunk.data + pos, std::min(static_cast<size_t>(DEMOD_BLOCK_BYTES), total - pos));
+            }
+            raw_.release(chunk);
+            return true;
+        }
+        const uint64_t from = chunk.first_sample - chunk.margin;
+        const uint64_t to = chunk.first_sample + chunk.num_samples;
+        const size_t first = reader_.find_sample(from);
+        std::vector<uint8_t> iq;
+        size_t i = first;
+        for (; i < reader_.entries().size() && reader_.entries()[i].first_sample < to; i++) {
+            const SgcEntry& e = reader_.entries()[i];
+            if (!reader_.read(i, iq)) return false;
+            uint64_t a = std::max(from, e.first_sample), b = std::min(to, e.first_sample + e.num_samples);
+            if (b > a) fn(iq.data() + (a - e.first_sample) * 2, static_cast<size_t>((b - a) * 2));
+        }
+        // The last frame can still hold the next chunk's margin
+        if (i > first + 1) reader_.release(first, i - 1);
+        return true;
+    }
+
+    uint32_t sample_rate() const { return rate_; }
+    uint64_t num_samples() const { return num_samples_; }
+    double start_utc() const { return start_utc_; }
+    double tune_offset_hz() const { return tune_offset_hz_; }
+
+private:
+    bool sgc_ = false;
+    IqFile raw_;
+    SgcReader reader_;
+    uint32_t rate_ = 0;
+    uint64_t num_samples_ = 0;
+    double start_utc_ = 0.0;            // 0 for raw captures
+    double tune_offset_hz_ = 0.0;
+};
+
+struct CaptureJob {
+    std::string path;
+    std::string base;                   // File name without extension
+    CaptureInput input;
+    DopplerProfile doppler;
+    std::string doppler_file;
+    double profile_start_sec = 0.0;
+    std::vector<IqChunk> chunks;
+    uint64_t period = 0;                // Input samples per whole number of audio samples
+    int outputs_per_period = 0;
+    uint32_t audio_rate = 0;
+    std::chrono::steady_clock::time_point started;
+
+    // Chunks are demodulated in any order and decoded in order
+    std::mutex mutex;
+    std::map<size_t, std::vector<float>> ready;
+    size_t next_submit = 0;
+    size_t next_decode = 0;
+    bool draining = false;
+    bool failed = false;
+
+    // Touched only by the drainer
+    AptDecoder decoder;
+    AptImage image;
+    std::vector<AptLine> lines;
+    uint64_t lines_total = 0;
+    uint64_t lines_synced = 0;
+    std::vector<float> signal;          // Per synced line: sync A swing ...
+    std::vector<float> noise;           // ... and the pixel noise in space A
+};
+
+// ----------------------------------------------------------------------------
+// Reprocessor
+// ----------------------------------------------------------------------------
+
+class Reprocessor {
+public:
+    Reprocessor(const ReprocessOptions& opts, ThreadPool& pool) : opts_(opts), pool_(pool) {}
+
+    // Every capture, at most max_captures at a time; false if any failed
+    bool run(const std::vector<std::string>& files);
+
+private:
+    void start(CaptureJob* job);
+    void submit_chunk(CaptureJob* job);
+    void demod(CaptureJob* job, size_t index);
+    void deposit(CaptureJob* job, size_t index, std::vector<float>& audio);
+    void decode(CaptureJob* job, const std::vector<float>& audio);
+    void finish(CaptureJob* job);
+    bool write_outputs(CaptureJob* job, std::ostringstream& report);
+
+    const ReprocessOptions& opts_;
+    ThreadPool& pool_;
+    TaskGroup tasks_;
+    size_t window_ = 1;                 // Chunks in flight per capture
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    int in_flight_ = 0;
+    int failed_ = 0;
+    double iq_seconds_ = 0.0;
+    std::vector<std::string> metrics_;  // data_store log_metrics entries
+};
+
+bool Reprocessor::run(const std::vector<std::string>& files) {
+    const int threads = pool_.size();
+    int max_captures = opts_.max_captures > 0 ? opts_.max_captures : std::max(1, (threads + 1) / 2);
+    max_captures = std::min<int>(max_captures, static_cast<int>(files.size()));
+    const size_t budget = static_cast<size_t>(CHUNKS_PER_THREAD) * threads;
+    window_ = std::max<size_t>(2, (budget + max_captures - 1) / max_captures);
+
+    std::cout << "Reprocessing " << files.size() << " captures on " << threads << " threads ("
+              << max_captures << " at a time, " << window_ << " chunks of " << opts_.chunk_sec
+              << " s in flight each)" << std::endl;
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (const std::string& path : files) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [&]() { return in_flight_ < max_captures; });
+            in_flight_++;
+        }
+        CaptureJob* job = new CaptureJob();
+        job->path = path;
+        pool_.submit(tasks_, [this, job]() { start(job); });
+    }
+    tasks_.wait();
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    if (!opts_.metrics_log.empty() && !metrics_.empty() && !append_json_array(opts_.metrics_log, metrics_)) {
+        failed_++;
+    }
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    std::ostringstream summary;
+    summary << std::fixed << std::setprecision(1) << "\nDone: " << files.size() - failed_ << " decoded, "
+            << failed_ << " failed; " << iq_seconds_ << " s of I/Q in " << elapsed << " s ("
+            << iq_seconds_ / std::max(elapsed, 1e-9) << "x real time)\n"
+            << "Pool: " << pool_.steals() << " chunks stolen; peak RSS " << usage.ru_maxrss / 1024.0 << " MB\n";
+    if (!opts_.metrics_log.empty() && !metrics_.empty()) {
+        summary << "Metrics: " << metrics_.size() << " entries appended to " << opts_.metrics_log << "\n";
+    }
+    std::cout << summary.str();
+    return failed_ == 0;
+}
+
+// On a worker: open, plan the chunks, queue the first window
+void Reprocessor::start(CaptureJob* job) {
+    std::string name = std::filesystem::path(job->path).filename().string();
+    size_t dot = name.find_last_of('.');
+    job->base = (dot != std::string::npos && dot > 0) ? name.substr(0, dot) : name;
+    job->started = std::chrono::steady_clock::now();
+
+    bool opened = job->input.open(job->path, opts_.sample_rate);
+    if (!opened || job->input.num_samples() == 0) {
+        if (opened) std::cerr << "Error: Empty capture: " << job->path << std::endl;
+        job->failed = true;
+        finish(job);
+        return;
+    }
+
+    DemodConfig config;
+    config.input_rate = job->input.sample_rate();
+    DemodPipeline probe;
+    AptDecoder check;
+    if (!probe.configure(config) || !check.configure(probe.audio_rate())) {
+        std::cerr << "Error: No demodulation rate plan for " << config.input_rate << " S/s: " << job->path
+                  << std::endl;
+        job->failed = true;
+        finish(job);
+        return;
+    }
+    job->period = static_cast<uint64_t>(probe.stage1().decimation()) * probe.stage2().decimation() *
+                  probe.resampler().decimation();
+    job->outputs_per_period = probe.resampler().interpolation();
+    job->audio_rate = probe.audio_rate();
+    job->decoder.configure(job->audio_rate);
+
+    if (opts_.doppler) {
+        for (const char* suffix : {"_doppler.json", "_doppler.dpb"}) {
+            std::string file = opts_.doppler_dir + "/" + job->base + suffix;
+            struct stat st;
+            if (stat(file.c_str(), &st) != 0 || !job->doppler.load(file)) continue;
+            job->doppler_file = file;
+            // .sgc knows when it started; a raw capture starts at the profile's start
+            if (job->input.start_utc() > 0.0 && job->doppler.aos_epoch_sec > 0.0) {
+                job->profile_start_sec = job->input.start_utc() - job->doppler.aos_epoch_sec;
+            }
+            break;
+        }
+    }
+
+    const uint32_t rate = job->input.sample_rate();
+    job->chunks = job->input.chunks(static_cast<uint64_t>(opts_.chunk_sec * rate),
+                                    static_cast<uint64_t>(opts_.margin_sec * rate), job->period);
+
+    std::lock_guard<std::mutex> lock(job->mutex);
+    while (job->next_submit < std::min(window_, job->chunks.size())) submit_chunk(job);
+}
+
+// Caller holds job->mutex
+void Reprocessor::submit_chunk(CaptureJob* job) {
+    size_t index = job->next_submit++;
+    pool_.submit(tasks_, [this, job, index]() { demod(job, index); });
+}
+
+void Reprocessor::demod(CaptureJob* job, size_t index) {
+    const IqChunk& chunk = job->chunks[index];
+    const uint32_t rate = job->input.sample_rate();
+
+    DemodConfig config;
+    config.input_rate = rate;
+    config.iq_correction = opts_.iq_correction;
+    DemodPipeline pipeline;
+    pipeline.configure(config);
+
+    // getDoppler walks a cursor, so each chunk needs its own copy
+    const bool have_doppler = !job->doppler_file.empty();
+    DopplerProfile doppler;
+    if (have_doppler) doppler = job->doppler;
+    const double offset_hz = job->input.tune_offset_hz();
+    const bool nco_enabled = have_doppler || offset_hz != 0.0;
+    auto shift_at = [&](uint64_t sample) {
+        double d = have_doppler ? doppler.getDoppler(job->profile_start_sec + static_cast<double>(sample) / rate)
+                                : 0.0;
+        return offset_hz - d;
+    };
+
+    std::vector<float> audio;
+    audio.reserve(static_cast<size_t>((chunk.margin + chunk.num_samples) / job->period + 1) *
+                  job->outputs_per_period);
+    uint64_t sample = chunk.first_sample - chunk.margin;
+    bool ok = job->input.for_each_block(chunk, [&](const uint8_t* iq, size_t n) {
+        if (nco_enabled) pipeline.set_frequency_shift(shift_at(sample), shift_at(sample + n / 2));
+        pipeline.process(iq, n, audio);
+        sample += n / 2;
+    });
+    const size_t skip = static_cast<size_t>(chunk.margin / job->period) * job->outputs_per_period;
+    audio.erase(audio.begin(), audio.begin() + std::min(skip, audio.size()));
+    if (!ok) {
+        std::lock_guard<std::mutex> lock(job->mutex);
+        job->failed = true;
+    }
+    deposit(job, index, audio);
+}
+
+// Hand over a chunk's audio; whoever holds the next one in order drains
+// everything that is now contiguous and keeps the window full
+void Reprocessor::deposit(CaptureJob* job, size_t index, std::vector<float>& audio) {
+    std::unique_lock<std::mutex> lock(job->mutex);
+    job->ready[index] = std::move(audio);
+    if (job->draining) return;
+    job->draining = true;
+    while (true) {
+        auto it = job->ready.find(job->next_decode);
+        if (it == job->ready.end()) break;
+        std::vector<float> part = std::move(it->second);
+        job->ready.erase(it);
+        if (job->next_submit < job->chunks.size()) submit_chunk(job);
+        lock.unlock();
+        decode(job, part);
+        lock.lock();
+        job->next_decode++;
+    }
+    job->draining = false;
+    bool done = job->next_decode == job->chunks.size();
+    lock.unlock();
+    if (done) finish(job);
+}
+
+void Reprocessor::decode(CaptureJob* job, const std::vector<float>& audio) {
+    job->lines.clear();
+    job->decoder.process(audio.data(), audio.size(), job->lines);
+    for (const AptLine& line : job->lines) {
+        job->image.add(line);
+        job->lines_total++;
+        if (!line.synced) continue;
+        job->lines_synced++;
+
+        const size_t first = APT_SYNC_PIXELS + SPACE_EDGE_PIXELS;
+        const size_t last = APT_SYNC_PIXELS + APT_SPACE_PIXELS - SPACE_EDGE_PIXELS;
+        double sum = 0.0, sum_sq = 0.0;
+        for (size_t p = first; p < last; p++) {
+            sum += line.pixels[p];
+            sum_sq += static_cast<double>(line.pixels[p]) * line.pixels[p];
+        }
+        double mean = sum / (last - first);
+        job->signal.push_back(line.white_level - line.black_level);
+        job->noise.push_back(static_cast<float>(std::sqrt(std::max(0.0, sum_sq / (last - first) - mean * mean))));
+    }
+}
+
+void Reprocessor::finish(CaptureJob* job) {
+    std::ostringstream report;
+    bool ok = !job->failed && write_outputs(job, report);
+    if (!ok) report << "  " << job->path << ": failed\n";
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!ok) failed_++;
+        std::cout << report.str() << std::flush;
+        in_flight_--;
+    }
+    cv_.notify_one();
+    delete job;
+}
+
+bool Reprocessor::write_outputs(CaptureJob* job, std::ostringstream& report) {
+    const std::string base = opts_.output_dir + "/" + job->base;
+    const std::string png_file = base + "_decoded.png";
+    const double duration = static_cast<double>(job->input.num_samples()) / job->input.sample_rate();
+    const double sync_rate = job->lines_total ? static_cast<double>(job->lines_synced) / job->lines_total : 0.0;
+    const double signal = median(job->signal);
+    const double noise = median(job->noise);
+    const bool have_snr = signal > 0.0 && noise > 0.0;
+
+    if (job->image.height() > 0 && !job->image.save_png(png_file)) {
+        std::cerr << "Error: Cannot write image: " << png_file << std::endl;
+        return false;
+    }
+
+    std::time_t now = std::time(nullptr);
+    char stamp[32];
+    std::strftime(stamp, sizeof(stamp), "%Y%m%d_%H%M%S", std::gmtime(&now));
+
+    // decode_apt.py's metadata, plus the quality measures
+    std::ostringstream meta;
+    meta << std::fixed << std::setprecision(3)
+         << "{\n  \"input_file\": " << json_string(job->path)
+         << ",\n  \"output_file\": " << (job->image.height() ? json_string(png_file) : "null")
+         << ",\n  \"timestamp\": " << json_string(stamp)
+         << ",\n  \"sample_rate_hz\": " << job->input.sample_rate()
+         << ",\n  \"duration_sec\": " << duration
+         << ",\n  \"image_width\": " << job->image.width()
+         << ",\n  \"image_height\": " << job->image.height()
+         << ",\n  \"sync_pulses_found\": " << job->lines_synced
+         << ",\n  \"station_offset_hz\": " << job->input.tune_offset_hz()
+         << ",\n  \"doppler_profile\": " << (job->doppler_file.empty() ? "null" : json_string(job->doppler_file))
+         << ",\n  \"sync_rate\": " << sync_rate
+         << ",\n  \"snr_db\": ";
+    if (have_snr) meta << 20.0 * std::log10(signal / noise);
+    else meta << "null";
+    meta << ",\n  \"clock_error_ppm\": " << job->decoder.clock_error_ppm()
+         << ",\n  \"decoder\": \"satgs_reprocess\"\n}\n";
+    if (!write_text_file(base + "_metadata.json", meta.str())) return false;
+
+    std::ostringstream metrics;
+    metrics << std::fixed << std::setprecision(3)
+            << "{\"mission_id\": " << json_string(job->base)
+            << ", \"timestamp\": " << json_string(format_utc_timestamp(utc_now()));
+    if (have_snr) {
+        metrics << ", \"snr_db\": " << 20.0 * std::log10(signal / noise)
+                << ", \"noise_floor_db\": " << 20.0 * std::log10(noise)
+                << ", \"peak_signal_db\": " << 20.0 * std::log10(signal);
+    } else {
+        metrics << ", \"snr_db\": null, \"noise_floor_db\": null, \"peak_signal_db\": null";
+    }
+    metrics << ", \"sync_rate\": " << sync_rate << ", \"image_quality_score\": null, \"doppler_error_hz\": null}";
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - job->started).count();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        metrics_.push_back(metrics.str());
+        iq_seconds_ += duration;
+    }
+
+    report << std::fixed << std::setprecision(1) << "  " << job->base << ": " << job->lines_total << " lines, "
+           << sync_rate * 100.0 << "% synced";
+    if (have_snr) report << ", SNR " << 20.0 * std::log10(signal / noise) << " dB";
+    report << ", " << duration << " s in " << std::setprecision(2) << elapsed << " s"
+           << (job->doppler_file.empty() ? "" : ", Doppler corrected") << "\n";
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// Main
+// ----------------------------------------------------------------------------
+
+// Captures named on the command line, and every .bin / .sgc under the
+// directories named there
+static bool collect_captures(const std::vector<std::string>& args, const ReprocessOptions& opts,
+                             std::vector<std::string>& files) {
+    for (const std::string& arg : args) {
+        std::error_code ec;
+        if (!std::filesystem::is_directory(arg, ec)) {
+            files.push_back(arg);
+            continue;
+        }
+        std::vector<std::string> found;
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(arg, ec)) {
+            if (!entry.is_regular_file()) continue;
+            std::string ext = entry.path().extension().string();
+            if (ext == ".bin" || ext == ".sgc") found.push_back(entry.path().string());
+        }
+        if (ec) {
+            std::cerr << "Error: Cannot read directory " << arg << ": " << ec.message() << std::endl;
+            return false;
+        }
+        std::sort(found.begin(), found.end());
+        files.insert(files.end(), found.begin(), found.end());
+    }
+
+    if (opts.skip_decoded) {
+        // Decoded after the capture was last written
+        files.erase(std::remove_if(files.begin(), files.end(), [&](const std::string& path) {
+            std::string stem = std::filesystem::path(path).stem().string();
+            struct stat capture, meta;
+            return stat(path.c_str(), &capture) == 0 &&
+                   stat((opts.output_dir + "/" + stem + "_metadata.json").c_str(), &meta) == 0 &&
+                   meta.st_mtime >= capture.st_mtime;
+        }), files.end());
+    }
+    return true;
+}
+
+void print_usage(const char* progname) {
+    std::cout << "Usage: " << progname << " [options] [<dir or capture> ...]\n"
+              << "\nRe-decodes archived captures (raw u8 I/Q .bin, .sgc) into <name>_decoded.png and\n"
+              << "<name>_metadata.json with per-pass SNR and sync rate, and appends the quality\n"
+              << "metrics to data/metrics.json. Directories are searched recursively\n"
+              << "(default: data/captures).\n"
+              << "\nOptions:\n"
+              << "  -s <rate>      Sample rate of raw captures in Hz (default: " << DEFAULT_SAMPLE_RATE << ")\n"
+              << "  -o <dir>       Output directory (default: data/decoded)\n"
+              << "  -j <threads>   Worker threads (default: all CPUs)\n"
+              << "  --captures=<n> Captures decoded at once (default: half the threads)\n"
+              << "  --chunk=<sec>  I/Q seconds per task (default: " << DEFAULT_CHUNK_SEC << ")\n"
+              << "  --margin=<sec> Warm-up before each chunk (default: " << DEFAULT_MARGIN_SEC << ")\n"
+              << "  --iq-correct   Remove DC offset and I/Q imbalance before demodulating\n"
+              << "  --doppler-dir=<dir>  Where <name>_doppler.json profiles are (default: data/doppler)\n"
+              << "  --no-doppler   Ignore Doppler profiles\n"
+              << "  --metrics-log=<file>  data_store metrics file (default: data/metrics.json;\n"
+              << "                 empty = don't append)\n"
+              << "  --skip-decoded Leave captures whose metadata is newer than the capture\n"
+              << "  -h             Show this help\n"
+              << "\nExample:\n"
+              << "  " << progname << " data/captures\n"
+              << "  " << progname << " -j 32 --skip-decoded -o data/decoded /archive/2026\n";
+}
+
+int main(int argc, char* argv[]) {
+    ReprocessOptions opts;
+    int threads = 0;
+
+    enum { OPT_CAPTURES = 256, OPT_CHUNK, OPT_MARGIN, OPT_IQ_CORRECT, OPT_DOPPLER_DIR, OPT_NO_DOPPLER,
+           OPT_METRICS_LOG, OPT_SKIP_DECODED };
+    static const struct option long_options[] = {
+        {"captures",     required_argument, nullptr, OPT_CAPTURES},
+        {"chunk",        required_argument, nullptr, OPT_CHUNK},
+        {"margin",       required_argument, nullptr, OPT_MARGIN},
+        {"iq-correct",   no_argument,       nullptr, OPT_IQ_CORRECT},
+        {"doppler-dir",  required_argument, nullptr, OPT_DOPPLER_DIR},
+        {"no-doppler",   no_argument,       nullptr, OPT_NO_DOPPLER},
+        {"metrics-log",  required_argument, nullptr, OPT_METRICS_LOG},
+        {"skip-decoded", no_argument,       nullptr, OPT_SKIP_DECODED},
+        {"help",         no_argument,       nullptr, 'h'},
+        {nullptr, 0, nullptr, 0}
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "s:o:j:h", long_options, nullptr)) != -1) {
+        switch (opt) {
+            case 's':
+                opts.sample_rate = static_cast<uint32_t>(std::stoul(optarg));
+                break;
+            case 'o':
+                opts.output_dir = optarg;
+                break;
+            case 'j':
+                threads = std::stoi(optarg);
+                break;
+            case OPT_CAPTURES:
+                opts.max_captures = std::stoi(optarg);
+                break;
+            case OPT_CHUNK:
+                opts.chunk_sec = std::stod(optarg);
+                break;
+            case OPT_MARGIN:
+                opts.margin_sec = std::stod(optarg);
+                break;
+            case OPT_IQ_CORRECT:
+                opts.iq_correction = true;
+                break;
+            case OPT_DOPPLER_DIR:
+                opts.doppler_dir = optarg;
+                break;
+            case OPT_NO_DOPPLER:
+                opts.doppler = false;
+                break;
+            case OPT_METRICS_LOG:
+                opts.metrics_log = optarg;
+                break;
+            case OPT_SKIP_DECODED:
+                opts.skip_decoded = true;
+                break;
+            case 'h':
+            default:
+                print_usage(argv[0]);
+                return (opt == 'h') ? 0 : 1;
+        }
+    }
+
+    if (opts.chunk_sec <= 0.0 || opts.margin_sec < 0.0) {
+        std::cerr << "Error: --chunk must be positive and --margin non-negative\n";
+        return 1;
+    }
+
+    std::vector<std::string> args(argv + optind, argv + argc);
+    if (args.empty()) args.push_back("data/captures");
+    std::vector<std::string> files;
+    if (!collect_captures(args, opts, files)) return 1;
+    if (files.empty()) {
+        std::cout << "No captures to reprocess" << std::endl;
+        return 0;
+    }
+    std::error_code ec;
+    std::filesystem::create_directories(opts.output_dir, ec);
+    if (ec) {
+        std::cerr << "Error: Cannot create " << opts.output_dir << ": " << ec.message() << std::endl;
+        return 1;
+    }
+
+    ThreadPool pool(threads);
+    Reprocessor reprocessor(opts, pool);
+    return reprocessor.run(files) ? 0 : 1;
+}
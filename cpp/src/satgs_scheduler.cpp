@@ -0,0 +1,1072 @@
+/*
+ * satgs_scheduler.cpp
+ * Satellite Ground Station - Resident Multi-pass Scheduler
+ *
+ * Keeps the station capturing without a script in the loop: predicts
+ * the passes of the next horizon_hours from a TLE file with the embedded
+ * SGP4 (or reads a pass list), assigns them to devices and channelizer
+ * slots (pass_scheduler.h), and runs each booking as a capture session
+ * inside this process:
+ *
+ *   warm-up   warmup_sec before the capture window (AOS minus
+ *             pre_aos_margin_sec): borrow and tune the source, calibrate
+ *             the slab pool, Doppler profiles already built
+ *   window    stream (up STREAM_PREROLL_SEC ahead, kept from the window
+ *             start on), NCO-correct and decode every pass of the
+ *             booking into its own live PNG, one channel per carrier
+ *   LOS       post_los_margin_sec later: stop, append the passes to the
+ *             mission log, free the device
+ *
+ * Upcoming actions wait in a priority queue ordered by time. The plan is
+ * redone every replan_min and whenever the TLE file changes; bookings
+ * already warming up or streaming keep their device.
+ *
+ * Dongles are opened once, at service start, and stay open between
+ * passes (device_pool.h): a warm-up typically only retunes the center
+ * frequency.
+ *
+ * Settings come from the "capture" and "scheduler" sections of
+ * config.json; command-line options override them:
+ *
+ *   "scheduler": {
+ *     "devices": [{"source": "rtlsdr:0", "channels": 3}, {"source": "rtlsdr:1"}],
+ *     "satellites": ["NOAA 15", "NOAA 18", "NOAA 19"],
+ *     "horizon_hours": 24, "replan_min": 60, "warmup_sec": 30, "min_score": 0.0,
+ *     "track_carrier": true, "ppm_store": "data/ppm.json", "keep_audio": false,
+ *     "output_dir": "data/decoded", "mission_log": "data/mission_log.json",
+ *     "archive_index": "data/archive.sgi", "shed_load": true
+ *   }
+ *
+ * "shed_load" lets a dongle working several passes at once give up the
+ * further channels while the host can't keep up (load_manager.h), so
+ * the pass it was booked for first keeps every line.
+ *
+ * A pass list (--passes) is a JSON array of {"satellite", "aos_utc",
+ * "los_utc", "max_elevation_deg"[, "frequency_hz"][, "profile"]}, with
+ * ISO 8601 or Unix times; the service exits once it is worked off.
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <map>
+#include <queue>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <ctime>
+#include <cerrno>
+#include <getopt.h>
+#include <sys/stat.h>
+
+#include "archive_index.h"
+#include "capture_session.h"
+#include "cli_util.h"
+#include "doppler_profile.h"
+#include "device_pool.h"
+#include "dsp_pipeline.h"
+#include "io_scheduler.h"
+#include "json_reader.h"
+#include "mapped_file.h"
+#include "metrics.h"
+#include "orbit.h"
+#include "pass_scheduler.h"
+#include "ppm_store.h"
+#include "thread_util.h"
+
+#define DEFAULT_HORIZON_HOURS   24.0
+#define DEFAULT_REPLAN_MIN      60.0
+#define DEFAULT_WARMUP_SEC      30.0    // As satgs_pass --warmup
+#define PROFILE_STEP_SEC        1.0
+#define STATUS_REPORT_SEC       600     // "Next pass" line while idle
+#define SAME_PASS_SEC           120.0   // AOS tolerance matching a pass across replans
+#define SCHED_DECODED_LINES     20      // Synced APT lines (10 s) for decode_success
+
+// Global state
+static std::atomic<bool> g_running(true);
+
+void signal_handler(int signum) {
+    std::cerr << "\nSignal " << signum << " received, stopping scheduler..." << std::endl;
+    g_running = false;
+}
+
+// ----------------------------------------------------------------------------
+// Settings
+// ----------------------------------------------------------------------------
+
+struct SchedulerSettings {
+    std::vector<SchedulerDevice> devices;
+    std::vector<std::string> satellites;
+    uint32_t sample_rate = DEFAULT_SAMPLE_RATE;
+    int gain = DEFAULT_GAIN;
+    double horizon_hours = DEFAULT_HORIZON_HOURS;
+    double replan_min = DEFAULT_REPLAN_MIN;
+    double warmup_sec = DEFAULT_WARMUP_SEC;
+    double min_score = 0.0;
+    bool track_carrier = false;
+    bool keep_audio = false;
+    bool shed_load = false;
+    std::string ppm_store;
+    std::string output_dir = "data/decoded";
+    std::string mission_log = "data/mission_log.json";
+    std::string archive_index = "data/archive.sgi";     // archive_index.h ("": not indexed)
+
+    // "capture" and "scheduler" sections; missing fields keep their defaults
+    bool load(const std::string& filename);
+};
+
+bool SchedulerSettings::load(const std::string& filename) {
+    MappedFile file;
+    if (!file.open(filename)) {
+        std::cerr << "Error: Cannot load station config: " << filename << std::endl;
+        return false;
+    }
+
+    JsonReader json(file.data(), file.size());
+    std::string_view section, key, text;
+    double value;
+    json.begin_object();
+    while (json.next_key(section)) {
+        if ((section != "capture" && section != "scheduler") || json.peek() != '{') {
+            json.skip_value();
+            continue;
+        }
+        json.begin_object();
+        while (json.next_key(key)) {
+            if (section == "capture" && key == "sample_rate" && json.read_number(value)) {
+                sample_rate = static_cast<uint32_t>(value);
+            } else if (section == "capture" && key == "gain_db" && json.read_number(value)) {
+                gain = static_cast<int>(std::lround(value * 10));
+            } else if (section != "scheduler") {
+                json.skip_value();
+            } else if (key == "devices" && json.peek() == '[') {
+                devices.clear();
+                json.begin_array();
+                while (json.next_element()) {
+                    SchedulerDevice device;
+                    json.begin_object();
+                    while (json.next_key(key)) {
+                        if (key == "source" && json.peek() == '"' && json.read_string(text)) {
+                            device.source.assign(text);
+                        } else if (key == "channels" && json.read_number(value)) {
+                            device.channel_slots = static_cast<int>(value);
+                        } else {
+                            json.skip_value();
+                        }
+                    }
+                    devices.push_back(device);
+                }
+            } else if (key == "satellites" && json.peek() == '[') {
+                satellites.clear();
+                json.begin_array();
+                while (json.next_element()) {
+                    if (json.peek() == '"' && json.read_string(text)) {
+                        satellites.emplace_back(text);
+                    } else {
+                        json.skip_value();
+                    }
+                }
+            } else if (key == "horizon_hours" && json.read_number(value)) {
+                horizon_hours = value;
+            } else if (key == "replan_min" && json.read_number(value)) {
+                replan_min = value;
+            } else if (key == "warmup_sec" && json.read_number(value)) {
+                warmup_sec = value;
+            } else if (key == "min_score" && json.read_number(value)) {
+                min_score = value;
+            } else if (key == "track_carrier" || key == "keep_audio" || key == "shed_load") {
+                bool flag = json.peek() == 't';
+                json.skip_value();
+                if (key == "track_carrier") track_carrier = flag;
+                else if (key == "shed_load") shed_load = flag;
+                else keep_audio = flag;
+            } else if (key == "ppm_store" && json.peek() == '"' && json.read_string(text)) {
+                ppm_store.assign(text);
+            } else if (key == "output_dir" && json.peek() == '"' && json.read_string(text)) {
+                output_dir.assign(text);
+            } else if (key == "mission_log" && json.peek() == '"' && json.read_string(text)) {
+                mission_log.assign(text);
+            } else if (key == "archive_index" && json.peek() == '"' && json.read_string(text)) {
+                archive_index.assign(text);
+            } else {
+                json.skip_value();
+            }
+        }
+    }
+
+    if (!json.ok()) {
+        std::cerr << "Error: Malformed station config at byte " << json.error_offset()
+                  << ": " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// Pass sources
+// ----------------------------------------------------------------------------
+
+// One entry of a --passes file
+struct ListedPass {
+    std::string satellite;
+    SatellitePass pass{};
+    double freq_hz = 0.0;
+    std::string profile;
+};
+
+static bool read_time(JsonReader& json, double& unix_sec) {
+    std::string_view text;
+    if (json.peek() == '"') {
+        return json.read_string(text) && parse_utc_timestamp(std::string(text), unix_sec);
+    }
+    return json.read_number(unix_sec);
+}
+
+static bool load_pass_list(const std::string& filename, double fallback_hz, std::vector<ListedPass>& passes) {
+    MappedFile file;
+    if (!file.open(filename)) {
+        std::cerr << "Error: Cannot load pass list: " << filename << std::endl;
+        return false;
+    }
+
+    JsonReader json(file.data(), file.size());
+    std::string_view key, text;
+    json.begin_array();
+    while (json.next_element()) {
+        ListedPass p;
+        bool times = true;
+        json.begin_object();
+        while (json.next_key(key)) {
+            if (key == "satellite" && json.peek() == '"' && json.read_string(text)) {
+                p.satellite.assign(text);
+            } else if (key == "aos_utc") {
+                times = read_time(json, p.pass.aos_unix) && times;
+            } else if (key == "los_utc") {
+                times = read_time(json, p.pass.los_unix) && times;
+            } else if (key == "max_elevation_deg") {
+                json.read_number(p.pass.max_elevation_deg);
+            } else if (key == "frequency_hz") {
+                json.read_number(p.freq_hz);
+            } else if (key == "profile" && json.peek() == '"' && json.read_string(text)) {
+                p.profile.assign(text);
+            } else {
+                json.skip_value();
+            }
+        }
+        if (!times || p.satellite.empty() || p.pass.los_unix <= p.pass.aos_unix) {
+            std::cerr << "Error: Pass " << passes.size() + 1 << " in " << filename
+                      << " needs \"satellite\", \"aos_utc\" and a later \"los_utc\"\n";
+            return false;
+        }
+        p.pass.tca_unix = 0.5 * (p.pass.aos_unix + p.pass.los_unix);
+        if (p.freq_hz <= 0.0) p.freq_hz = downlink_freq_hz(p.satellite, fallback_hz);
+        passes.push_back(p);
+    }
+    if (!json.ok()) {
+        std::cerr << "Error: Malformed pass list at byte " << json.error_offset() << ": " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// Output
+// ----------------------------------------------------------------------------
+
+// "NOAA_19_20260227_025446", as schedule_captures.py names its files
+static std::string pass_stem(const std::string& satellite, double aos_unix) {
+    std::string name;
+    for (char c : satellite) {
+        if (c == ' ') name += '_';
+        else if (c != '(' && c != ')' && c != '/') name += c;
+    }
+    time_t t = static_cast<time_t>(aos_unix);
+    struct tm tm;
+    gmtime_r(&t, &tm);
+    char stamp[32];
+    std::strftime(stamp, sizeof(stamp), "%Y%m%d_%H%M%S", &tm);
+    return name + "_" + stamp;
+}
+
+static bool make_directories(const std::string& path) {
+    for (size_t slash = path.find('/', 1); ; slash = path.find('/', slash + 1)) {
+        std::string prefix = path.substr(0, slash);
+        if (!prefix.empty() && mkdir(prefix.c_str(), 0755) != 0 && errno != EEXIST) {
+            std::cerr << "Error: Cannot create directory: " << prefix << std::endl;
+            return false;
+        }
+        if (slash == std::string::npos) return true;
+    }
+}
+
+// Appends objects to the JSON array satcom_server.py and
+// schedule_captures.py keep, rewriting it through a temporary file
+static bool append_mission_log(const std::string& path, const std::vector<std::string>& entries) {
+    std::string body = "[]";
+    struct stat st;
+    if (stat(path.c_str(), &st) == 0 && st.st_size > 0) {
+        MappedFile file;
+        if (!file.open(path)) {
+            std::cerr << "Error: Cannot read mission log: " << path << std::endl;
+            return false;
+        }
+        body.assign(file.data(), file.size());
+    }
+    size_t close = body.find_last_of(']');
+    size_t open = body.find('[');
+    if (open == std::string::npos || close == std::string::npos || close < open) {
+        std::cerr << "Error: Mission log is not a JSON array: " << path << std::endl;
+        return false;
+    }
+    bool empty = body.find_first_not_of(" \t\r\n", open + 1) == close;
+    size_t end = body.find_last_not_of(" \t\r\n", close - 1) + 1;
+
+    std::string added;
+    for (const std::string& entry : entries) {
+        added += (empty && added.empty()) ? "\n  " : ",\n  ";
+        added += entry;
+    }
+    body = body.substr(0, empty ? open + 1 : end) + added + "\n]\n";
+
+    std::string tmp = path + ".tmp";
+    FILE* f = std::fopen(tmp.c_str(), "w");
+    bool ok = f && std::fwrite(body.data(), 1, body.size(), f) == body.size();
+    ok = f && (std::fclose(f) == 0) && ok;
+    if (!ok || std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::cerr << "Error: Failed writing mission log: " << path << std::endl;
+        std::remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+// ----------------------------------------------------------------------------
+// Service
+// ----------------------------------------------------------------------------
+
+class Scheduler {
+public:
+    Scheduler(const SchedulerSettings& settings, const GroundStation& station, IoScheduler& io)
+        : settings_(settings), station_(station), io_(io) {}
+
+    bool use_tle(const std::string& tle_file);
+    void use_pass_list(const std::vector<ListedPass>& passes) { listed_ = passes; }
+    bool use_ppm_store(const std::string& path) { return ppm_store_.load(path); }
+
+    void replan(double now);
+    void print_plan(std::ostream& out) const;
+
+    // Runs until interrupted, or with a pass list until it is worked off
+    void run();
+
+    void collect_metrics(MetricsWriter& out) const;
+    void print_devices(std::ostream& out) const;
+
+private:
+    enum class State { Planned, Warm, Streaming, Done };
+
+    struct Job {
+        Booking booking;
+        State state = State::Planned;
+        std::vector<std::unique_ptr<DopplerProfile>> profiles;   // Per pass, may be null
+        std::vector<std::string> images;
+        std::unique_ptr<CaptureSession> session;
+    };
+
+    struct Event {
+        double time;
+        uint64_t job;
+        State expect;
+        bool operator>(const Event& other) const { return time > other.time; }
+    };
+
+    std::vector<PassCandidate> predict(double now) const;
+    bool committed(const PassCandidate& c) const;
+    bool prepare(Job& job);
+    void warm_up(uint64_t id, Job& job);
+    void start(Job& job);
+    void finish(Job& job, bool ok);
+    void schedule(uint64_t id, const Job& job);
+    std::string describe(const Booking& booking) const;
+    bool tle_changed() const;
+
+    SchedulerSettings settings_;
+    GroundStation station_;
+    IoScheduler& io_;
+    PpmStore ppm_store_;
+    DevicePool device_pool_;                    // Outlives the jobs' sessions
+
+    std::string tle_file_;
+    time_t tle_mtime_ = 0;
+    std::vector<PassPredictor> predictors_;
+    std::vector<std::string> predictor_names_;
+    std::vector<ListedPass> listed_;
+
+    std::map<uint64_t, std::unique_ptr<Job>> jobs_;
+    uint64_t next_id_ = 1;
+    std::priority_queue<Event, std::vector<Event>, std::greater<Event>> queue_;
+    std::vector<PassCandidate> skipped_;
+    std::vector<PassCandidate> finished_;       // Passes already worked, any result
+    std::vector<double> recent_aos_;            // Captured AOS times for the diversity score
+    uint64_t captured_ = 0;
+    uint64_t failed_ = 0;
+    mutable std::mutex mutex_;                  // jobs_ sessions vs the metrics thread
+};
+
+bool Scheduler::use_tle(const std::string& tle_file) {
+    std::vector<Tle> tles;
+    if (!load_tle_file(tle_file, tles)) {
+        return false;
+    }
+    std::vector<PassPredictor> predictors;
+    std::vector<std::string> names;
+    for (const std::string& name : settings_.satellites) {
+        const Tle* tle = find_tle(tles, name);
+        PassPredictor predictor;
+        if (!tle) {
+            std::cerr << "Warning: " << name << " not in " << tle_file << "\n";
+        } else if (!predictor.init(*tle, station_)) {
+            std::cerr << "Warning: Cannot propagate " << tle->name << "\n";
+        } else {
+            predictors.push_back(predictor);
+            names.push_back(tle->name);
+        }
+    }
+    if (predictors.empty()) {
+        std::cerr << "Error: None of the satellites is in " << tle_file << "\n";
+        return false;
+    }
+    predictors_ = predictors;
+    predictor_names_ = names;
+    tle_file_ = tle_file;
+    struct stat st;
+    tle_mtime_ = stat(tle_file.c_str(), &st) == 0 ? st.st_mtime : 0;
+    return true;
+}
+
+bool Scheduler::tle_changed() const {
+    struct stat st;
+    return !tle_file_.empty() && stat(tle_file_.c_str(), &st) == 0 && st.st_mtime != tle_mtime_;
+}
+
+std::vector<PassCandidate> Scheduler::predict(double now) const {
+    std::vector<PassCandidate> candidates;
+    double span = settings_.horizon_hours * 3600.0;
+    for (size_t i = 0; i < predictors_.size(); i++) {
+        std::vector<SatellitePass> passes;
+        predictors_[i].find_passes(now, span, passes);
+        for (const SatellitePass& pass : passes) {
+            PassCandidate c;
+            c.satellite = predictor_names_[i];
+            c.freq_hz = downlink_freq_hz(c.satellite, station_.primary_freq_hz);
+            c.pass = pass;
+            c.source = static_cast<int>(i);
+            candidates.push_back(c);
+        }
+    }
+    for (size_t i = 0; i < listed_.size(); i++) {
+        if (listed_[i].pass.los_unix + station_.post_los_margin_sec <= now) continue;
+        PassCandidate c;
+        c.satellite = listed_[i].satellite;
+        c.freq_hz = listed_[i].freq_hz;
+        c.pass = listed_[i].pass;
+        c.source = static_cast<int>(i);
+        candidates.push_back(c);
+    }
+    for (PassCandidate& c : candidates) {
+        c.score = score_pass(c.pass, recent_aos_);
+    }
+    return candidates;
+}
+
+// Already open, streaming or worked off
+bool Scheduler::committed(const PassCandidate& c) const {
+    auto same = [&c](const PassCandidate& p) {
+        return p.satellite == c.satellite && std::abs(p.pass.aos_unix - c.pass.aos_unix) < SAME_PASS_SEC;
+    };
+    for (const PassCandidate& p : finished_) {
+        if (same(p)) return true;
+    }
+    for (const auto& item : jobs_) {
+        if (item.second->state == State::Planned) continue;
+        for (const PassCandidate& p : item.second->booking.passes) {
+            if (same(p)) return true;
+        }
+    }
+    return false;
+}
+
+void Scheduler::replan(double now) {
+    if (tle_changed()) {
+        std::cout << "TLE file changed, reloading " << tle_file_ << "\n";
+        use_tle(tle_file_);
+    }
+
+    std::vector<PassCandidate> candidates;
+    for (const PassCandidate& c : predict(now)) {
+        if (c.score >= settings_.min_score && !committed(c)) candidates.push_back(c);
+    }
+
+    double half_band = settings_.sample_rate / 2.0 - DEMOD_CHANNEL_BW_HZ;
+    PassPlanner planner(settings_.devices, station_, settings_.warmup_sec, half_band);
+    for (const auto& item : jobs_) {
+        if (item.second->state == State::Warm || item.second->state == State::Streaming) {
+            planner.reserve(item.second->booking);
+        }
+    }
+    skipped_.clear();
+    std::vector<Booking> bookings = planner.plan(candidates, &skipped_);
+
+    // Planned jobs are replaced; their queued events go stale
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = jobs_.begin(); it != jobs_.end();) {
+        if (it->second->state == State::Planned || it->second->state == State::Done) {
+            it = jobs_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    for (const Booking& booking : bookings) {
+        std::unique_ptr<Job> job(new Job());
+        job->booking = booking;
+        uint64_t id = next_id_++;
+        schedule(id, *job);
+        jobs_[id] = std::move(job);
+    }
+}
+
+std::string Scheduler::describe(const Booking& booking) const {
+    std::ostringstream out;
+    out << booking.passes[0].satellite;
+    for (size_t i = 1; i < booking.passes.size(); i++) out << " + " << booking.passes[i].satellite;
+    return out.str();
+}
+
+void Scheduler::print_plan(std::ostream& out) const {
+    std::ostringstream text;
+    text << std::fixed;
+    size_t passes = 0;
+    for (const auto& item : jobs_) passes += item.second->booking.passes.size();
+    text << "Plan: " << passes << " pass(es) in " << jobs_.size() << " session(s) on "
+         << settings_.devices.size() << " device(s), " << skipped_.size() << " skipped\n";
+
+    std::vector<const Job*> ordered;
+    for (const auto& item : jobs_) ordered.push_back(item.second.get());
+    std::sort(ordered.begin(), ordered.end(), [](const Job* a, const Job* b) {
+        return a->booking.warm_unix < b->booking.warm_unix;
+    });
+    for (const Job* job : ordered) {
+        const Booking& b = job->booking;
+        text << "  " << format_utc_timestamp(b.warm_unix) << "  " << settings_.devices[b.device].source
+             << std::setprecision(4) << " at " << b.center_hz / 1e6 << " MHz, "
+             << std::setprecision(0) << (b.stop_unix - b.start_unix) / 60.0 << " min"
+             << (job->state == State::Planned ? "" : " (active)") << "\n";
+        for (const PassCandidate& p : b.passes) {
+            text << "      " << std::left << std::setw(10) << p.satellite << std::right
+                 << " AOS " << format_utc_timestamp(p.pass.aos_unix)
+                 << std::setprecision(1) << std::setw(6) << p.pass.max_elevation_deg << " deg "
+                 << std::setw(5) << (p.pass.los_unix - p.pass.aos_unix) / 60.0 << " min  score "
+                 << std::setprecision(2) << p.score << "\n";
+        }
+    }
+    for (const PassCandidate& p : skipped_) {
+        text << "  skipped   " << std::left << std::setw(10) << p.satellite << std::right
+             << " AOS " << format_utc_timestamp(p.pass.aos_unix)
+             << std::setprecision(1) << std::setw(6) << p.pass.max_elevation_deg << " deg  score "
+             << std::setprecision(2) << p.score << " (no free device or slot)\n";
+    }
+    out << text.str();
+}
+
+void Scheduler::schedule(uint64_t id, const Job& job) {
+    if (job.state == State::Planned) queue_.push({job.booking.warm_unix, id, State::Planned});
+    else if (job.state == State::Warm) queue_.push({job.booking.start_unix - STREAM_PREROLL_SEC, id, State::Warm});
+}
+
+// Profiles and file names at warm-up, so nothing is left to compute at AOS
+bool Scheduler::prepare(Job& job) {
+    if (!make_directories(settings_.output_dir)) return false;
+    for (const PassCandidate& p : job.booking.passes) {
+        std::unique_ptr<DopplerProfile> profile;
+        if (!predictors_.empty()) {
+            profile.reset(new DopplerProfile());
+            if (!predictors_[p.source].build_profile(p.pass, p.freq_hz, PROFILE_STEP_SEC, *profile)) return false;
+        } else if (!listed_[p.source].profile.empty()) {
+            profile.reset(new DopplerProfile());
+            if (!profile->load(listed_[p.source].profile)) return false;
+        }
+        job.profiles.push_back(std::move(profile));
+        job.images.push_back(settings_.output_dir + "/" + pass_stem(p.satellite, p.pass.aos_unix) + ".png");
+    }
+    return true;
+}
+
+void Scheduler::warm_up(uint64_t id, Job& job) {
+    const Booking& b = job.booking;
+    const SchedulerDevice& device = settings_.devices[b.device];
+    std::cout << "\n== " << describe(b) << ": warm-up on " << device.source << " ==\n";
+    if (!prepare(job)) {
+        finish(job, false);
+        return;
+    }
+
+    CaptureConfig config;
+    config.label = describe(b);
+    config.source = device.source;
+    config.sample_rate = settings_.sample_rate;
+    config.gain = settings_.gain;
+    config.frequency = static_cast<uint32_t>(b.passes[0].freq_hz);
+    config.tune_offset_hz = b.center_hz - b.passes[0].freq_hz;
+    config.duration_sec = static_cast<int>(std::ceil(b.stop_unix - std::max(b.start_unix, utc_now())));
+    config.calibrate_sec = settings_.warmup_sec > 0.0 ? std::min(settings_.warmup_sec, DEFAULT_CALIBRATE_SEC) : 0.0;
+    config.image_filename = job.images[0];
+    config.doppler = job.profiles[0].get();
+    config.carrier_tracking = settings_.track_carrier;
+    config.load.enabled = settings_.shed_load;
+    config.device_pool = &device_pool_;
+    if (!ppm_store_.path().empty()) config.ppm_store = &ppm_store_;
+    if (settings_.keep_audio) {
+        config.audio_filename = job.images[0].substr(0, job.images[0].size() - 4) + ".wav";
+    }
+    for (size_t i = 1; i < b.passes.size(); i++) {
+        ChannelConfig channel;
+        channel.label = b.passes[i].satellite;
+        channel.frequency = static_cast<uint32_t>(b.passes[i].freq_hz);
+        channel.image_filename = job.images[i];
+        if (settings_.keep_audio) {
+            channel.audio_filename = job.images[i].substr(0, job.images[i].size() - 4) + ".wav";
+        }
+        channel.doppler = job.profiles[i].get();
+        config.channels.push_back(channel);
+    }
+
+    std::unique_ptr<CaptureSession> session(new CaptureSession(config));
+    bool opened = session->open(io_);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        job.session = std::move(session);
+        job.state = State::Warm;
+    }
+    if (!opened) {
+        finish(job, false);
+        return;
+    }
+    schedule(id, job);
+}
+
+void Scheduler::start(Job& job) {
+    const Booking& b = job.booking;
+    double now = utc_now();
+    std::cout << "\n== " << describe(b) << ": streaming until " << format_utc_timestamp(b.stop_unix) << " ==\n";
+    job.session->set_duration(static_cast<int>(std::ceil(b.stop_unix - std::max(b.start_unix, now))));
+    if (!job.session->start_at(b.start_unix)) {
+        finish(job, false);
+        return;
+    }
+    job.state = State::Streaming;
+}
+
+void Scheduler::finish(Job& job, bool ok) {
+    const Booking& b = job.booking;
+    CaptureStats stats;
+    std::vector<uint64_t> synced(b.passes.size(), 0);
+    if (job.state == State::Streaming) {
+        ok = job.session->join() && ok;
+        stats = job.session->stats();
+        std::cout << "\n== " << describe(b) << ": " << (ok ? "complete" : "failed") << " ==\n";
+        job.session->print_summary(std::cout);
+        for (size_t i = 0; i < synced.size(); i++) synced[i] = job.session->lines_synced(i);
+        double learned;
+        if (!ppm_store_.path().empty() && job.session->learned_ppm(learned)) ppm_store_.save();
+    } else {
+        std::cout << "\n== " << describe(b) << ": failed ==\n";
+    }
+
+    std::vector<std::string> entries;
+    std::vector<ArchiveEntry> archived;
+    for (size_t i = 0; i < b.passes.size(); i++) {
+        const PassCandidate& p = b.passes[i];
+        // An image of noise still gets written; count it once the
+        // decoder has found the sync train
+        bool image = ok && synced[i] >= SCHED_DECODED_LINES;
+        std::ostringstream entry;
+        entry << std::fixed << std::setprecision(1)
+              << "{\"timestamp\": " << json_string(format_utc_timestamp(utc_now()))
+              << ", \"satellite\": " << json_string(p.satellite)
+              << ", \"aos_utc\": " << json_string(format_utc_timestamp(p.pass.aos_unix))
+              << ", \"los_utc\": " << json_string(format_utc_timestamp(p.pass.los_unix))
+              << ", \"max_elevation_deg\": " << p.pass.max_elevation_deg
+              << ", \"duration_sec\": " << p.pass.los_unix - p.pass.aos_unix
+              << ", \"score\": " << std::setprecision(3) << p.score
+              << ", \"device\": " << json_string(settings_.devices[b.device].source)
+              << ", \"status\": \"complete\", \"capture_file\": null"
+              << ", \"capture_success\": " << (ok && stats.samples > 0 ? "true" : "false")
+              << ", \"decode_success\": " << (image ? "true" : "false")
+              << ", \"image_file\": " << (image ? json_string(job.images[i]) : "null")
+              << ", \"scheduler\": \"satgs_scheduler\"}";
+        entries.push_back(entry.str());
+
+        ArchiveEntry a;
+        a.satellite = p.satellite;
+        a.aos_unix = p.pass.aos_unix;
+        a.los_unix = p.pass.los_unix;
+        a.tca_unix = p.pass.tca_unix;
+        a.max_elevation_deg = p.pass.max_elevation_deg;
+        a.freq_hz = p.freq_hz;
+        a.image_lines = static_cast<uint32_t>(synced[i]);
+        a.flags = (ok && stats.samples > 0 ? ARCHIVE_CAPTURED : 0) | (image ? ARCHIVE_DECODED : 0);
+        if (image) a.image_file = job.images[i];
+        a.source = "satgs_scheduler";
+        archived.push_back(a);
+        finished_.push_back(p);
+        if (ok) recent_aos_.push_back(p.pass.aos_unix);
+    }
+    if (!settings_.mission_log.empty()) {
+        append_mission_log(settings_.mission_log, entries);
+    }
+    if (!settings_.archive_index.empty()) {
+        archive_append(settings_.archive_index, archived);
+    }
+    if (ok) captured_ += b.passes.size();
+    else failed_ += b.passes.size();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    job.session.reset();
+    job.state = State::Done;
+}
+
+void Scheduler::run() {
+    for (const SchedulerDevice& device : settings_.devices) {
+        if (!device_pool_.preopen(device.source, 0, settings_.sample_rate, settings_.gain)) {
+            std::cerr << "Warning: " << device.source << " not ready; trying again at its first warm-up\n";
+        }
+    }
+
+    double now = utc_now();
+    double next_replan = now + settings_.replan_min * 60.0;
+    double last_status = now;
+
+    while (g_running) {
+        now = utc_now();
+        if (!predictors_.empty() && (now >= next_replan || tle_changed())) {
+            replan(now);
+            print_plan(std::cout);
+            next_replan = now + settings_.replan_min * 60.0;
+        }
+
+        while (!queue_.empty() && queue_.top().time <= now && g_running) {
+            Event event = queue_.top();
+            queue_.pop();
+            auto it = jobs_.find(event.job);
+            if (it == jobs_.end() || it->second->state != event.expect) continue;
+            if (event.expect == State::Planned) warm_up(event.job, *it->second);
+            else start(*it->second);
+            now = utc_now();
+        }
+
+        // Sessions end themselves after their duration; the wall clock
+        // backs that up for live sources
+        bool pending = false;
+        for (auto& item : jobs_) {
+            Job& job = *item.second;
+            if (job.state == State::Streaming) {
+                if (job.session->speed() == 1.0 && now >= job.booking.stop_unix + WALL_STOP_GRACE_SEC) {
+                    job.session->stop();
+                }
+                if (!job.session->running()) finish(job, true);
+            }
+            pending = pending || job.state != State::Done;
+        }
+        if (!pending && predictors_.empty()) {
+            std::cout << "\nPass list worked off: " << captured_ << " captured, " << failed_ << " failed\n";
+            return;
+        }
+
+        if (now - last_status >= STATUS_REPORT_SEC && !queue_.empty()) {
+            auto it = jobs_.find(queue_.top().job);
+            if (it != jobs_.end()) {
+                std::cout << "Next: " << describe(it->second->booking) << " warm-up in "
+                          << static_cast<long>((queue_.top().time - now) / 60.0) << " min ("
+                          << captured_ << " captured so far)" << std::endl;
+            }
+            last_status = now;
+        }
+
+        double wait = queue_.empty() ? 1.0 : std::min(1.0, queue_.top().time - now);
+        std::this_thread::sleep_for(std::chrono::duration<double>(std::max(wait, 0.01)));
+    }
+
+    // Interrupted: close out whatever is open
+    for (auto& item : jobs_) {
+        Job& job = *item.second;
+        if (job.state == State::Streaming) job.session->stop();
+        if (job.state == State::Streaming || job.state == State::Warm) finish(job, job.state == State::Streaming);
+    }
+}
+
+void Scheduler::collect_metrics(MetricsWriter& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t planned = 0, active = 0;
+    for (const auto& item : jobs_) {
+        const Job& job = *item.second;
+        if (job.state == State::Planned) planned += job.booking.passes.size();
+        if (job.state == State::Warm || job.state == State::Streaming) active += job.booking.passes.size();
+        if (job.session) job.session->collect_metrics(out);
+    }
+    out.gauge("satgs_scheduler_passes_planned", "Passes booked and not yet opened", "", planned);
+    out.gauge("satgs_scheduler_passes_active", "Passes warming up or streaming", "", active);
+    out.gauge("satgs_scheduler_passes_skipped", "Passes in the horizon with no device or slot", "", skipped_.size());
+    out.counter("satgs_scheduler_passes_total", "Passes worked off", metrics_label("result", "captured"), captured_);
+    out.counter("satgs_scheduler_passes_total", "Passes worked off", metrics_label("result", "failed"), failed_);
+    device_pool_.collect_metrics(out);
+}
+
+void Scheduler::print_devices(std::ostream& out) const {
+    out << "Devices:\n";
+    device_pool_.print_status(out);
+}
+
+// ----------------------------------------------------------------------------
+// Main
+// ----------------------------------------------------------------------------
+
+static bool parse_devices(const std::string& list, std::vector<SchedulerDevice>& devices) {
+    std::vector<int> indices;
+    if (!parse_core_list(list, indices) || indices.empty()) return false;
+    devices.clear();
+    for (int index : indices) {
+        SchedulerDevice device;
+        device.source = "rtlsdr:" + std::to_string(index);
+        devices.push_back(device);
+    }
+    return true;
+}
+
+void print_usage(const char* progname) {
+    std::cout << "Usage: " << progname << " -T <tle file> [options]\n"
+              << "       " << progname << " --passes=<file.json> [options]\n"
+              << "\nOptions:\n"
+              << "  -T <file>      TLE file; passes predicted with the embedded SGP4\n"
+              << "  -S <names>     Satellites, comma-separated (default: scheduler.satellites,\n"
+              << "                 else NOAA 15,NOAA 18,NOAA 19)\n"
+              << "  -c <file>      Station config (default: config.json)\n"
+              << "  -D <list>      RTL-SDR devices, e.g. 0,1 (default: scheduler.devices, else 0)\n"
+              << "  -o <dir>       Image directory (default: scheduler.output_dir, data/decoded)\n"
+              << "  --source=<spec>  A single device from a sample source spec (see rtlsdr_capture -h)\n"
+              << "  --channels=<n> Carriers one device demodulates at once (default: "
+              << SCHED_DEFAULT_SLOTS << "; 1 = no sharing)\n"
+              << "  --horizon=<h>  Hours ahead to plan (default: " << DEFAULT_HORIZON_HOURS << ")\n"
+              << "  --replan=<min> Re-predict and re-plan interval (default: " << DEFAULT_REPLAN_MIN << ")\n"
+              << "  --warmup=<sec> Open and calibrate this long before the capture window\n"
+              << "                 (default: " << DEFAULT_WARMUP_SEC << ")\n"
+              << "  --min-score=<s>  Leave passes scoring below this (pass_scorer scale, 0-1)\n"
+              << "  --passes=<file>  Work off a pass list instead of predicting\n"
+              << "  --track-carrier  Carrier FLL on every channel\n"
+              << "  --ppm-store=<file>  Per-dongle tuner ppm, learned across passes\n"
+              << "  --metrics=<port>  Serve Prometheus metrics on http://" << METRICS_BIND_ADDRESS
+              << ":<port>/metrics\n"
+              << "  -n, --dry-run  Print the plan and exit\n"
+              << "  -h             Show this help\n"
+              << "\nExample:\n"
+              << "  " << progname << " -T weather.txt -D 0,1 --track-carrier --ppm-store=data/ppm.json\n"
+              << "  " << progname << " -T weather.txt --horizon=48 -n\n";
+}
+
+int main(int argc, char* argv[]) {
+    std::string tle_file;
+    std::string config_file = "config.json";
+    std::string satellites;
+    std::string device_list;
+    std::string source;
+    std::string output_dir;
+    std::string pass_file;
+    std::string ppm_store_file;
+    int channel_slots = 0;
+    double horizon_hours = 0.0;
+    double replan_min = 0.0;
+    double warmup_sec = -1.0;
+    double min_score = -1.0;
+    bool track_carrier = false;
+    bool dry_run = false;
+    int metrics_port = -1;
+
+    enum { OPT_SOURCE = 256, OPT_CHANNELS, OPT_HORIZON, OPT_REPLAN, OPT_WARMUP, OPT_MIN_SCORE, OPT_PASSES,
+           OPT_TRACK_CARRIER, OPT_PPM_STORE, OPT_METRICS };
+    static const struct option long_options[] = {
+        {"source",    required_argument, nullptr, OPT_SOURCE},
+        {"channels",  required_argument, nullptr, OPT_CHANNELS},
+        {"horizon",   required_argument, nullptr, OPT_HORIZON},
+        {"replan",    required_argument, nullptr, OPT_REPLAN},
+        {"warmup",    required_argument, nullptr, OPT_WARMUP},
+        {"min-score", required_argument, nullptr, OPT_MIN_SCORE},
+        {"passes",    required_argument, nullptr, OPT_PASSES},
+        {"track-carrier", no_argument,   nullptr, OPT_TRACK_CARRIER},
+        {"ppm-store", required_argument, nullptr, OPT_PPM_STORE},
+        {"metrics",   required_argument, nullptr, OPT_METRICS},
+        {"dry-run",   no_argument,       nullptr, 'n'},
+        {"help",      no_argument,       nullptr, 'h'},
+        {nullptr, 0, nullptr, 0}
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "T:S:c:D:o:nh", long_options, nullptr)) != -1) {
+        switch (opt) {
+            case 'T':
+                tle_file = optarg;
+                break;
+            case 'S':
+                satellites = optarg;
+                break;
+            case 'c':
+                config_file = optarg;
+                break;
+            case 'D':
+                device_list = optarg;
+                break;
+            case 'o':
+                output_dir = optarg;
+                break;
+            case OPT_SOURCE:
+                source = optarg;
+                break;
+            case OPT_CHANNELS:
+                channel_slots = std::stoi(optarg);
+                break;
+            case OPT_HORIZON:
+                horizon_hours = std::stod(optarg);
+                break;
+            case OPT_REPLAN:
+                replan_min = std::stod(optarg);
+                break;
+            case OPT_WARMUP:
+                warmup_sec = std::stod(optarg);
+                break;
+            case OPT_MIN_SCORE:
+                min_score = std::stod(optarg);
+                break;
+            case OPT_PASSES:
+                pass_file = optarg;
+                break;
+            case OPT_TRACK_CARRIER:
+                track_carrier = true;
+                break;
+            case OPT_PPM_STORE:
+                ppm_store_file = optarg;
+                break;
+            case OPT_METRICS:
+                metrics_port = std::stoi(optarg);
+                break;
+            case 'n':
+                dry_run = true;
+                break;
+            case 'h':
+            default:
+                print_usage(argv[0]);
+                return (opt == 'h') ? 0 : 1;
+        }
+    }
+
+    if (tle_file.empty() == pass_file.empty()) {
+        std::cerr << "Error: Need either a TLE file (-T) or a pass list (--passes)\n";
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    GroundStation station;
+    SchedulerSettings settings;
+    if (!station.load(config_file) || !settings.load(config_file)) {
+        return 1;
+    }
+    if (!satellites.empty()) {
+        settings.satellites.clear();
+        std::stringstream names(satellites);
+        std::string name;
+        while (std::getline(names, name, ',')) {
+            if (!name.empty()) settings.satellites.push_back(name);
+        }
+    }
+    if (settings.satellites.empty()) settings.satellites = {"NOAA 15", "NOAA 18", "NOAA 19"};
+    if (!device_list.empty() && !parse_devices(device_list, settings.devices)) {
+        std::cerr << "Error: -D takes device indices, e.g. 0,1\n";
+        return 1;
+    }
+    if (!source.empty()) {
+        settings.devices.assign(1, SchedulerDevice());
+        settings.devices[0].source = source;
+    }
+    if (settings.devices.empty()) parse_devices("0", settings.devices);
+    for (SchedulerDevice& device : settings.devices) {
+        if (channel_slots > 0) device.channel_slots = channel_slots;
+        if (device.channel_slots < 1) {
+            std::cerr << "Error: A device needs at least one channel slot\n";
+            return 1;
+        }
+    }
+    if (!output_dir.empty()) settings.output_dir = output_dir;
+    if (horizon_hours > 0.0) settings.horizon_hours = horizon_hours;
+    if (replan_min > 0.0) settings.replan_min = replan_min;
+    if (warmup_sec >= 0.0) settings.warmup_sec = warmup_sec;
+    if (min_score >= 0.0) settings.min_score = min_score;
+    if (track_carrier) settings.track_carrier = true;
+    if (!ppm_store_file.empty()) settings.ppm_store = ppm_store_file;
+    if (settings.warmup_sec < 0.0 || settings.horizon_hours <= 0.0 || settings.replan_min <= 0.0) {
+        std::cerr << "Error: warmup must not be negative; horizon and replan must be positive\n";
+        return 1;
+    }
+
+    IoScheduler io;
+    Scheduler scheduler(settings, station, io);
+    if (!tle_file.empty() && !scheduler.use_tle(tle_file)) {
+        return 1;
+    }
+    if (!pass_file.empty()) {
+        std::vector<ListedPass> passes;
+        if (!load_pass_list(pass_file, station.primary_freq_hz, passes)) {
+            return 1;
+        }
+        scheduler.use_pass_list(passes);
+    }
+    if (!settings.ppm_store.empty() && !scheduler.use_ppm_store(settings.ppm_store)) {
+        return 1;
+    }
+
+    std::cout << "Station: " << (station.name.empty() ? "unnamed" : station.name) << ", mask "
+              << station.min_elevation_deg << " deg, margins -" << station.pre_aos_margin_sec << "/+"
+              << station.post_los_margin_sec << " s, warm-up " << settings.warmup_sec << " s\n";
+    scheduler.replan(utc_now());
+    scheduler.print_plan(std::cout);
+    if (dry_run) {
+        return 0;
+    }
+
+    signal(SIGINT, signal_handler);
+    signal(SIGTERM, signal_handler);
+
+    // No raw I/Q is written, so the shared writer never gets a channel
+    io.start();
+
+    MetricsServer metrics;
+    if (metrics_port >= 0) {
+        metrics.add_collector([&scheduler](MetricsWriter& out) { scheduler.collect_metrics(out); });
+        if (!metrics.start(metrics_port)) {
+            return 1;
+        }
+        std::cout << "Metrics on http://" << METRICS_BIND_ADDRESS << ":" << metrics.port() << "/metrics\n";
+    }
+
+    scheduler.run();
+    metrics.stop();
+    scheduler.print_devices(std::cout);
+    return 0;
+}
@@ -0,0 +1,180 @@
+/*
+ * satgs_sgc.cpp
+ * Satellite Ground Station - .sgc Capture Inspection and Extraction
+ *
+ *   satgs_sgc info <capture.sgc>
+ *       Header, frame / gap counts, compression and time span.
+ *
+ *   satgs_sgc extract [-s <start>] [-d <sec>] <capture.sgc> <out.bin>
+ *       Decodes a time range back to raw u8 I/Q for the existing tools
+ *       (satgs_demod, decode_apt.py). The start is found through the
+ *       index, not by scanning. Gaps are written as mid-scale samples
+ *       so sample times in the output stay true.
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <getopt.h>
+
+#include "doppler_profile.h"
+#include "sgc_format.h"
+
+static void print_info(const SgcReader& reader, const std::string& filename) {
+    const SgcHeader& h = reader.header();
+    const std::vector<SgcEntry>& entries = reader.entries();
+    size_t frames = 0, gaps = 0;
+    for (const SgcEntry& e : entries) {
+        if (e.gap) gaps++;
+        else frames++;
+    }
+    uint64_t stream = reader.stream_samples();
+    uint64_t dropped = reader.gap_samples();
+
+    std::cout << "Capture: " << filename << "\n";
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "  Created:     " << format_utc_timestamp(h.created_utc) << "\n";
+    std::cout << "  Device:      " << h.device_index << ", gain " << std::setprecision(1)
+              << h.gain_tenth_db / 10.0 << " dB\n";
+    std::cout << std::setprecision(6);
+    std::cout << "  Tuned:       " << h.center_freq_hz / 1e6 << " MHz (carrier "
+              << h.carrier_freq_hz / 1e6 << " MHz)\n";
+    std::cout << "  Sample rate: " << h.sample_rate / 1e6 << " MS/s\n";
+    std::cout << "  Codec:       ";
+    if (h.codec == SGC_CODEC_RICE) {
+        std::cout << "Rice, " << h.bits << " bits" << (h.bits == 8 ? " (lossless)" : "") << "\n";
+    } else {
+        std::cout << "raw\n";
+    }
+    std::cout << "  Records:     " << frames << " frames, " << gaps << " gaps"
+              << (reader.indexed() ? " (indexed)" : " (scanned, no index)") << "\n";
+    std::cout << std::setprecision(1);
+    std::cout << "  Duration:    " << static_cast<double>(stream) / h.sample_rate << " s";
+    if (dropped) std::cout << ", " << static_cast<double>(dropped) / h.sample_rate << " s dropped";
+    std::cout << "\n";
+    if (!entries.empty()) {
+        std::cout << "  Span:        " << format_utc_timestamp(entries.front().utc) << " to "
+                  << format_utc_timestamp(entries.back().utc) << "\n";
+    }
+    uint64_t raw = (stream - dropped) * 2;
+    if (raw > 0) {
+        std::cout << "  Size:        " << reader.file_size() / 1e6 << " MB ("
+                  << 100.0 * reader.file_size() / raw << "% of raw)\n";
+    }
+}
+
+static bool extract(const SgcReader& reader, const std::string& start, double duration,
+                    const std::string& output) {
+    const std::vector<SgcEntry>& entries = reader.entries();
+    if (entries.empty()) {
+        std::cerr << "Error: Capture has no frames" << std::endl;
+        return false;
+    }
+    const uint32_t rate = reader.header().sample_rate;
+    const uint64_t base = entries.front().first_sample;
+
+    // Start as seconds into the capture or as a UTC timestamp
+    uint64_t first = base;
+    if (!start.empty()) {
+        double utc;
+        if (start.find('T') != std::string::npos && parse_utc_timestamp(start, utc)) {
+            first = reader.time_to_sample(utc);
+        } else {
+            first = base + static_cast<uint64_t>(std::stod(start) * rate);
+        }
+    }
+    uint64_t last = entries.back().first_sample + entries.back().num_samples;
+    if (duration > 0) last = std::min(last, first + static_cast<uint64_t>(duration * rate));
+    if (first >= last) {
+        std::cerr << "Error: Empty range" << std::endl;
+        return false;
+    }
+
+    std::ofstream out(output, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::cerr << "Error: Cannot create " << output << std::endl;
+        return false;
+    }
+    std::vector<uint8_t> iq;
+    uint64_t written = 0;
+    for (size_t i = reader.find_sample(first); i < entries.size(); i++) {
+        const SgcEntry& e = entries[i];
+        if (e.first_sample >= last) break;
+        if (!reader.read(i, iq)) return false;
+        uint64_t lo = std::max(first, e.first_sample) - e.first_sample;
+        uint64_t hi = std::min(last, e.first_sample + e.num_samples) - e.first_sample;
+        out.write(reinterpret_cast<const char*>(iq.data() + lo * 2), static_cast<std::streamsize>((hi - lo) * 2));
+        written += hi - lo;
+    }
+    out.close();
+    if (!out) {
+        std::cerr << "Error: Failed writing " << output << std::endl;
+        return false;
+    }
+    std::cout << "Extracted " << std::fixed << std::setprecision(1)
+              << static_cast<double>(written) / rate << " s (" << written * 2 / 1e6 << " MB) from "
+              << static_cast<double>(first - base) / rate << " s to " << output << "\n";
+    return true;
+}
+
+void print_usage(const char* progname) {
+    std::cout << "Usage: " << progname << " info <capture.sgc>\n"
+              << "       " << progname << " extract [options] <capture.sgc> <out.bin>\n"
+              << "\nExtract options:\n"
+              << "  -s <start>     Seconds into the capture, or UTC (2026-02-14T18:05:00Z)\n"
+              << "  -d <sec>       Length to extract (default: to the end)\n"
+              << "  -h             Show this help\n";
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    std::string command = argv[1];
+    if (command == "-h" || command == "--help") {
+        print_usage(argv[0]);
+        return 0;
+    }
+
+    std::string start;
+    double duration = 0.0;
+    int opt;
+    optind = 2;
+    while ((opt = getopt(argc, argv, "s:d:h")) != -1) {
+        switch (opt) {
+            case 's':
+                start = optarg;
+                break;
+            case 'd':
+                duration = std::stod(optarg);
+                break;
+            case 'h':
+            default:
+                print_usage(argv[0]);
+                return (opt == 'h') ? 0 : 1;
+        }
+    }
+
+    const int args = argc - optind;
+    if (!((command == "info" && args == 1) || (command == "extract" && args == 2))) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    SgcReader reader;
+    if (!reader.open(argv[optind])) {
+        return 1;
+    }
+    if (command == "info") {
+        print_info(reader, argv[optind]);
+        return 0;
+    }
+    return extract(reader, start, duration, argv[optind + 1]) ? 0 : 1;
+}
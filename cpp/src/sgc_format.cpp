@@ -0,0 +1,399 @@
+/*
+ * sgc_format.cpp
+ * Satellite Ground Station - Self-describing Chunked I/Q Container
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#include "sgc_format.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+template <typename T>
+static void put(uint8_t* buf, size_t offset, T value) {
+    std::memcpy(buf + offset, &value, sizeof(T));
+}
+
+template <typename T>
+static T get(const uint8_t* buf, size_t offset) {
+    T value;
+    std::memcpy(&value, buf + offset, sizeof(T));
+    return value;
+}
+
+void sgc_pack_header(const SgcHeader& h, uint8_t* buf) {
+    std::memset(buf, 0, SGC_HEADER_SIZE);
+    std::memcpy(buf, SGC_MAGIC, 4);
+    put<uint32_t>(buf, 4, h.version);
+    put<uint32_t>(buf, 8, SGC_HEADER_SIZE);
+    put<uint32_t>(buf, 12, h.sample_rate);
+    put<uint64_t>(buf, 16, h.center_freq_hz);
+    put<uint64_t>(buf, 24, h.carrier_freq_hz);
+    put<int32_t>(buf, 32, h.gain_tenth_db);
+    put<uint32_t>(buf, 36, h.frame_samples);
+    put<double>(buf, 40, h.created_utc);
+    put<uint32_t>(buf, 48, h.codec);
+    put<uint32_t>(buf, 52, h.bits);
+    put<uint32_t>(buf, 56, h.device_index);
+}
+
+void sgc_pack_record(const char* type, uint32_t payload_bytes, uint64_t first_sample,
+                     uint32_t num_samples, uint8_t codec, uint8_t bits, uint8_t rice_k,
+                     double utc, int64_t steady_ns, uint8_t* buf) {
+    std::memcpy(buf, type, 4);
+    put<uint32_t>(buf, 4, payload_bytes);
+    put<uint64_t>(buf, 8, first_sample);
+    put<uint32_t>(buf, 16, num_samples);
+    buf[20] = codec;
+    buf[21] = bits;
+    buf[22] = rice_k;
+    buf[23] = 0;
+    put<double>(buf, 24, utc);
+    put<int64_t>(buf, 32, steady_ns);
+}
+
+// ----------------------------------------------------------------------------
+// Codec
+// ----------------------------------------------------------------------------
+
+// MSB-first bit packer into a fixed buffer with 8 bytes of slack; the
+// caller checks size() against the limit it cares about
+class BitWriter {
+public:
+    explicit BitWriter(uint8_t* out) : out_(out), p_(out) {}
+
+    // n <= 32
+    void put(uint32_t value, int n) {
+        acc_ = (acc_ << n) | value;
+        nbits_ += n;
+        while (nbits_ >= 8) {
+            nbits_ -= 8;
+            *p_++ = static_cast<uint8_t>(acc_ >> nbits_);
+        }
+    }
+
+    void flush() {
+        if (nbits_ > 0) put(0, 8 - nbits_);
+    }
+
+    size_t size() const { return static_cast<size_t>(p_ - out_); }
+
+private:
+    uint8_t* out_;
+    uint8_t* p_;
+    uint64_t acc_ = 0;
+    int nbits_ = 0;
+};
+
+// Reads past the end as zeros; overrun() reports whether it had to
+class BitReader {
+public:
+    BitReader(const uint8_t* data, size_t size) : p_(data), end_(data + size), avail_(size * 8) {}
+
+    void refill() {
+        while (nbits_ <= 56) {
+            uint64_t byte = (p_ < end_) ? *p_++ : 0;
+            acc_ |= byte << (56 - nbits_);
+            nbits_ += 8;
+        }
+    }
+
+    // Leading ones, at most limit (refill() first)
+    int ones(int limit) const {
+        uint64_t inv = ~acc_;
+        int n = inv ? __builtin_clzll(inv) : 64;
+        return std::min(n, limit);
+    }
+
+    void skip(int n) {
+        acc_ <<= n;
+        nbits_ -= n;
+        used_ += n;
+    }
+
+    uint32_t get(int n) {
+        if (n == 0) return 0;
+        uint32_t v = static_cast<uint32_t>(acc_ >> (64 - n));
+        skip(n);
+        return v;
+    }
+
+    bool overrun() const { return used_ > avail_; }
+
+private:
+    const uint8_t* p_;
+    const uint8_t* end_;
+    uint64_t acc_ = 0;
+    int nbits_ = 0;
+    uint64_t used_ = 0;
+    uint64_t avail_;
+};
+
+static inline uint32_t quantize(uint8_t x, int bits) {
+    return static_cast<uint32_t>(x) >> (8 - bits);
+}
+
+// Bucket center, so requantization error stays zero-mean
+static inline uint8_t dequantize(uint32_t q, int bits) {
+    if (bits >= 8) return static_cast<uint8_t>(q);
+    return static_cast<uint8_t>((q << (8 - bits)) | (1u << (7 - bits)));
+}
+
+void sgc_encode(const uint8_t* iq, size_t n, int bits, std::vector<uint8_t>& out,
+                uint8_t& codec, uint8_t& rice_k) {
+    bits = std::max(1, std::min(8, bits));
+    const int32_t mid = 1 << (bits - 1);
+
+    // Rice parameter from the mean magnitude: 2^k ~ ln(2) * mean is the
+    // optimum for a geometric distribution
+    uint64_t sum = 0;
+    for (size_t i = 0; i < n; i++) {
+        int32_t d = static_cast<int32_t>(quantize(iq[i], bits)) - mid;
+        sum += static_cast<uint32_t>((d << 1) ^ (d >> 31));
+    }
+    double target = n ? 0.69 * static_cast<double>(sum) / n : 0.0;
+    int k = 0;
+    while (k < bits && static_cast<double>(1u << (k + 1)) <= target) k++;
+
+    // Stop as soon as the output reaches the input size; one value is at
+    // most SGC_RICE_ESCAPE + 8 bits, within the slack
+    out.resize(n + 8);
+    BitWriter writer(out.data());
+    bool fits = true;
+    for (size_t i = 0; i < n; i++) {
+        if (writer.size() >= n) {
+            fits = false;
+            break;
+        }
+        int32_t d = static_cast<int32_t>(quantize(iq[i], bits)) - mid;
+        uint32_t zz = static_cast<uint32_t>((d << 1) ^ (d >> 31));
+        uint32_t q = zz >> k;
+        if (q < SGC_RICE_ESCAPE) {
+            // q ones and a terminating zero, then the k low bits
+            writer.put(((1u << q) - 1) << 1, static_cast<int>(q) + 1);
+            writer.put(zz & ((1u << k) - 1), k);
+        } else {
+            writer.put((1u << SGC_RICE_ESCAPE) - 1, SGC_RICE_ESCAPE);
+            writer.put(zz, bits);
+        }
+    }
+    writer.flush();
+
+    // Incompressible (strong signal near full scale): keep the
+    // requantized bytes as they are
+    if (!fits || writer.size() >= n) {
+        out.resize(n);
+        for (size_t i = 0; i < n; i++) out[i] = static_cast<uint8_t>(quantize(iq[i], bits));
+        codec = SGC_CODEC_RAW;
+        rice_k = 0;
+        return;
+    }
+    out.resize(writer.size());
+    codec = SGC_CODEC_RICE;
+    rice_k = static_cast<uint8_t>(k);
+}
+
+bool sgc_decode(const uint8_t* payload, size_t payload_bytes, uint8_t codec, int bits,
+                uint8_t rice_k, uint8_t* iq, size_t n) {
+    if (bits < 1 || bits > 8) return false;
+    if (codec == SGC_CODEC_RAW) {
+        if (payload_bytes < n) return false;
+        for (size_t i = 0; i < n; i++) iq[i] = dequantize(payload[i], bits);
+        return true;
+    }
+    if (codec != SGC_CODEC_RICE) return false;
+
+    const int32_t mid = 1 << (bits - 1);
+    const int k = rice_k;
+    BitReader reader(payload, payload_bytes);
+    for (size_t i = 0; i < n; i++) {
+        reader.refill();
+        int q = reader.ones(SGC_RICE_ESCAPE);
+        uint32_t zz;
+        if (q < SGC_RICE_ESCAPE) {
+            reader.skip(q + 1);
+            zz = (static_cast<uint32_t>(q) << k) | reader.get(k);
+        } else {
+            reader.skip(SGC_RICE_ESCAPE);
+            zz = reader.get(bits);
+        }
+        int32_t d = static_cast<int32_t>(zz >> 1) ^ -static_cast<int32_t>(zz & 1);
+        iq[i] = dequantize(static_cast<uint32_t>(d + mid) & ((1u << bits) - 1), bits);
+    }
+    return !reader.overrun();
+}
+
+// ----------------------------------------------------------------------------
+// Reader
+// ----------------------------------------------------------------------------
+
+bool SgcReader::open(const std::string& filename) {
+    close();
+    filename_ = filename;
+    if (!file_.open(filename)) {
+        std::cerr << "Error: Cannot open capture: " << filename << std::endl;
+        return false;
+    }
+    if (!parse_header()) {
+        return false;
+    }
+    indexed_ = load_index();
+    if (!indexed_ && !scan()) {
+        return false;
+    }
+    return true;
+}
+
+bool SgcReader::parse_header() {
+    const uint8_t* b = reinterpret_cast<const uint8_t*>(file_.data());
+    if (file_.size() < SGC_HEADER_SIZE || std::memcmp(b, SGC_MAGIC, 4) != 0) {
+        std::cerr << "Error: Not an .sgc capture: " << filename_ << std::endl;
+        return false;
+    }
+    header_.version = get<uint32_t>(b, 4);
+    if (header_.version != SGC_VERSION || get<uint32_t>(b, 8) != SGC_HEADER_SIZE) {
+        std::cerr << "Error: Unsupported .sgc version " << header_.version << ": " << filename_ << std::endl;
+        return false;
+    }
+    header_.sample_rate = get<uint32_t>(b, 12);
+    header_.center_freq_hz = get<uint64_t>(b, 16);
+    header_.carrier_freq_hz = get<uint64_t>(b, 24);
+    header_.gain_tenth_db = get<int32_t>(b, 32);
+    header_.frame_samples = get<uint32_t>(b, 36);
+    header_.created_utc = get<double>(b, 40);
+    header_.codec = get<uint32_t>(b, 48);
+    header_.bits = get<uint32_t>(b, 52);
+    header_.device_index = get<uint32_t>(b, 56);
+    if (header_.sample_rate == 0) {
+        std::cerr << "Error: .sgc header has no sample rate: " << filename_ << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Entries straight from the trailer; false if there is no valid index
+bool SgcReader::load_index() {
+    const uint8_t* b = reinterpret_cast<const uint8_t*>(file_.data());
+    const uint64_t size = file_.size();
+    if (size < SGC_HEADER_SIZE + SGC_RECORD_SIZE + SGC_TRAILER_SIZE) return false;
+    const uint8_t* trailer = b + size - SGC_TRAILER_SIZE;
+    if (std::memcmp(trailer, SGC_TRAILER_MAGIC, 4) != 0) return false;
+
+    uint32_t count = get<uint32_t>(trailer, 4);
+    uint64_t offset = get<uint64_t>(trailer, 8);
+    uint64_t payload = static_cast<uint64_t>(count) * SGC_INDEX_ENTRY;
+    if (offset < SGC_HEADER_SIZE || offset + SGC_RECORD_SIZE + payload > size - SGC_TRAILER_SIZE ||
+        std::memcmp(b + offset, SGC_RECORD_INDEX, 4) != 0 || get<uint32_t>(b, offset + 4) != payload) {
+        return false;
+    }
+
+    const uint8_t* e = b + offset + SGC_RECORD_SIZE;
+    entries_.resize(count);
+    for (uint32_t i = 0; i < count; i++, e += SGC_INDEX_ENTRY) {
+        SgcEntry& entry = entries_[i];
+        entry.offset = get<uint64_t>(e, 0);
+        entry.first_sample = get<uint64_t>(e, 8);
+        entry.utc = get<double>(e, 16);
+        entry.num_samples = get<uint32_t>(e, 24);
+        entry.gap = get<uint32_t>(e, 28) != 0;
+        if (entry.offset + SGC_RECORD_SIZE > offset) {
+            entries_.clear();
+            return false;
+        }
+    }
+    return true;
+}
+
+// No index (capture cut short): walk the records
+bool SgcReader::scan() {
+    const uint8_t* b = reinterpret_cast<const uint8_t*>(file_.data());
+    const uint64_t size = file_.size();
+    uint64_t offset = SGC_HEADER_SIZE;
+    while (offset + SGC_RECORD_SIZE <= size) {
+        const uint8_t* r = b + offset;
+        bool frame = std::memcmp(r, SGC_RECORD_FRAME, 4) == 0;
+        bool gap = std::memcmp(r, SGC_RECORD_GAP, 4) == 0;
+        uint64_t payload = get<uint32_t>(r, 4);
+        if ((!frame && !gap) || offset + SGC_RECORD_SIZE + payload > size) break;
+
+        SgcEntry entry;
+        entry.offset = offset;
+        entry.first_sample = get<uint64_t>(r, 8);
+        entry.num_samples = get<uint32_t>(r, 16);
+        entry.gap = gap;
+        entry.utc = get<double>(r, 24);
+        entries_.push_back(entry);
+        offset += SGC_RECORD_SIZE + payload;
+    }
+    if (offset < size) {
+        std::cerr << "Warning: " << filename_ << " has no index and ends in a partial record; "
+                  << "using the " << entries_.size() << " complete ones" << std::endl;
+    }
+    return true;
+}
+
+uint64_t SgcReader::stream_samples() const {
+    if (entries_.empty()) return 0;
+    return entries_.back().first_sample + entries_.back().num_samples - entries_.front().first_sample;
+}
+
+uint64_t SgcReader::gap_samples() const {
+    uint64_t n = 0;
+    for (const SgcEntry& e : entries_) {
+        if (e.gap) n += e.num_samples;
+    }
+    return n;
+}
+
+size_t SgcReader::find_sample(uint64_t sample) const {
+    auto it = std::upper_bound(entries_.begin(), entries_.end(), sample,
+        [](uint64_t s, const SgcEntry& e) { return s < e.first_sample; });
+    if (it != entries_.begin()) {
+        auto prev = it - 1;
+        if (sample < prev->first_sample + prev->num_samples) return static_cast<size_t>(prev - entries_.begin());
+    }
+    return static_cast<size_t>(it - entries_.begin());
+}
+
+uint64_t SgcReader::time_to_sample(double utc) const {
+    if (entries_.empty()) return 0;
+    // Frame times are arrivals, i.e. the end of each transfer: count back
+    // from the first frame that arrives at or after utc
+    auto it = std::lower_bound(entries_.begin(), entries_.end(), utc,
+        [](const SgcEntry& e, double t) { return e.utc < t; });
+    if (it == entries_.end()) return entries_.back().first_sample + entries_.back().num_samples;
+    uint64_t back = static_cast<uint64_t>(std::max(0.0, it->utc - utc) * header_.sample_rate);
+    uint64_t end = it->first_sample + it->num_samples;
+    uint64_t start = entries_.front().first_sample;
+    return (end - start > back) ? end - back : start;
+}
+
+bool SgcReader::read(size_t index, std::vector<uint8_t>& iq) const {
+    if (index >= entries_.size()) return false;
+    const SgcEntry& entry = entries_[index];
+    const size_t n = static_cast<size_t>(entry.num_samples) * 2;
+    iq.resize(n);
+    if (entry.gap) {
+        std::fill(iq.begin(), iq.end(), static_cast<uint8_t>(128));
+        return true;
+    }
+
+    const uint8_t* r = reinterpret_cast<const uint8_t*>(file_.data()) + entry.offset;
+    uint32_t payload = get<uint32_t>(r, 4);
+    if (entry.offset + SGC_RECORD_SIZE + payload > file_.size() ||
+        !sgc_decode(r + SGC_RECORD_SIZE, payload, r[20], r[21], r[22], iq.data(), n)) {
+        std::cerr << "Error: Corrupt frame at offset " << entry.offset << " in " << filename_ << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void SgcReader::release(size_t first, size_t end) const {
+    end = std::min(end, entries_.size());
+    if (first >= end) return;
+    uint64_t to = end < entries_.size() ? entries_[end].offset : file_.size();
+    file_.release(entries_[first].offset, to - entries_[first].offset);
+}
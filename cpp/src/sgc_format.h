@@ -0,0 +1,145 @@
+/*
+ * sgc_format.h
+ * Satellite Ground Station - Self-describing Chunked I/Q Container
+ *
+ * .sgc keeps the u8 I/Q stream of rtlsdr_capture together with what a
+ * raw .bin loses: tuning, gain and sample rate in the header, and per
+ * frame (one USB transfer) its stream position and arrival time. Ring
+ * overflows appear as explicit gap records instead of silently shifting
+ * everything after them. Little-endian throughout:
+ *
+ *   header  "SGIQ" uint32 version, header_size (64), sample_rate
+ *           uint64 center_freq_hz (tuner), carrier_freq_hz
+ *           int32  gain (tenths of a dB), uint32 frame_samples
+ *           float64 created_utc
+ *           uint32 codec, bits, device_index, reserved
+ *
+ *   record  char[4] type ("FRAM", "GAP ", "INDX"), uint32 payload_bytes
+ *           uint64 first_sample, uint32 num_samples
+ *           uint8  codec, bits, rice_k, reserved
+ *           float64 utc, int64 steady_ns
+ *           payload
+ *
+ *   trailer "SGIX" uint32 entries, uint64 offset of the INDX record
+ *
+ * The INDX record written on close lists every frame and gap (offset,
+ * first sample, UTC), so a reader seeks by sample or time from the
+ * trailer alone; a file cut short by a crash is still readable by
+ * scanning the records.
+ *
+ * Frames are stored raw or Rice-coded. Before coding, each component
+ * can be requantized to fewer bits (lossy bit-depth reduction; 8 keeps
+ * it lossless). Values are coded as zigzag(q - mid) with one Rice
+ * parameter per frame, and a frame that would not shrink is stored
+ * raw.
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#ifndef SATGS_SGC_FORMAT_H
+#define SATGS_SGC_FORMAT_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "mapped_file.h"
+
+#define SGC_MAGIC           "SGIQ"
+#define SGC_VERSION         1
+#define SGC_HEADER_SIZE     64
+#define SGC_RECORD_SIZE     40
+#define SGC_INDEX_ENTRY     32
+#define SGC_TRAILER_MAGIC   "SGIX"
+#define SGC_TRAILER_SIZE    16
+
+#define SGC_RECORD_FRAME    "FRAM"
+#define SGC_RECORD_GAP      "GAP "
+#define SGC_RECORD_INDEX    "INDX"
+
+#define SGC_CODEC_RAW       0
+#define SGC_CODEC_RICE      1
+#define SGC_RICE_ESCAPE     16      // Unary quotient at which a value is sent verbatim
+
+struct SgcHeader {
+    uint32_t version = SGC_VERSION;
+    uint32_t sample_rate = 0;
+    uint64_t center_freq_hz = 0;    // Tuner center
+    uint64_t carrier_freq_hz = 0;   // Signal of interest (differs with an offset tune)
+    int32_t gain_tenth_db = 0;
+    uint32_t frame_samples = 0;     // Nominal samples per frame
+    double created_utc = 0.0;
+    uint32_t codec = SGC_CODEC_RAW;
+    uint32_t bits = 8;
+    uint32_t device_index = 0;
+};
+
+// One frame or gap, as listed by the index
+struct SgcEntry {
+    uint64_t offset = 0;            // Start of the record in the file
+    uint64_t first_sample = 0;
+    uint32_t num_samples = 0;
+    bool gap = false;
+    double utc = 0.0;
+};
+
+// Header serialization (buf holds SGC_HEADER_SIZE / SGC_RECORD_SIZE bytes)
+void sgc_pack_header(const SgcHeader& header, uint8_t* buf);
+void sgc_pack_record(const char* type, uint32_t payload_bytes, uint64_t first_sample,
+                     uint32_t num_samples, uint8_t codec, uint8_t bits, uint8_t rice_k,
+                     double utc, int64_t steady_ns, uint8_t* buf);
+
+// Encode n u8 I/Q bytes at `bits` per component into out (replaced).
+// Sets codec / rice_k to what was used.
+void sgc_encode(const uint8_t* iq, size_t n, int bits, std::vector<uint8_t>& out,
+                uint8_t& codec, uint8_t& rice_k);
+
+// Inverse: n output bytes from payload; false if the payload is short
+bool sgc_decode(const uint8_t* payload, size_t payload_bytes, uint8_t codec, int bits,
+                uint8_t rice_k, uint8_t* iq, size_t n);
+
+class SgcReader {
+public:
+    bool open(const std::string& filename);
+    void close() { file_.close(); entries_.clear(); }
+
+    const SgcHeader& header() const { return header_; }
+    const std::vector<SgcEntry>& entries() const { return entries_; }
+    bool indexed() const { return indexed_; }   // Entries came from the trailer index
+
+    // Stream samples covered, gaps included, and the dropped share of them
+    uint64_t stream_samples() const;
+    uint64_t gap_samples() const;
+
+    // Entry covering the sample, else the first one after it
+    // (entries().size() past the end)
+    size_t find_sample(uint64_t sample) const;
+
+    // Stream sample recorded at a UTC time (binary search of the index;
+    // past the end returns the end of the stream)
+    uint64_t time_to_sample(double utc) const;
+
+    // Decode frame entries()[i] into iq (2 bytes per sample). Gaps
+    // decode to mid-scale.
+    bool read(size_t index, std::vector<uint8_t>& iq) const;
+
+    // Drop the mapped pages of entries [first, end) once they are read,
+    // so streaming through a large file keeps a bounded footprint
+    void release(size_t first, size_t end) const;
+
+    uint64_t file_size() const { return file_.size(); }
+
+private:
+    bool parse_header();
+    bool load_index();
+    bool scan();
+
+    MappedFile file_;
+    std::string filename_;
+    SgcHeader header_;
+    std::vector<SgcEntry> entries_;
+    bool indexed_ = false;
+};
+
+#endif // SATGS_SGC_FORMAT_H
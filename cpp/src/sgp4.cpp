@@ -0,0 +1,441 @@
+/*
+ * sgp4.cpp
+ * Satellite Ground Station - TLE parsing and SGP4 propagation
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#include "sgp4.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+// WGS-72, as used to generate the element sets
+#define WGS72_MU        398600.8        // km^3/s^2
+#define WGS72_RADIUS_KM 6378.135
+#define WGS72_J2        0.001082616
+#define WGS72_J3       -0.00000253881
+#define WGS72_J4       -0.00000165597
+
+static const double kPi = 3.14159265358979323846;
+static const double kTwoPi = 2.0 * kPi;
+static const double kDeg2Rad = kPi / 180.0;
+static const double kX2o3 = 2.0 / 3.0;
+static const double kXke = 60.0 / std::sqrt(WGS72_RADIUS_KM * WGS72_RADIUS_KM * WGS72_RADIUS_KM / WGS72_MU);
+static const double kJ3oJ2 = WGS72_J3 / WGS72_J2;
+static const double kVkmPerSec = WGS72_RADIUS_KM * kXke / 60.0;
+static const double kXpdotp = 1440.0 / kTwoPi;     // rev/day -> rad/min
+
+// ----------------------------------------------------------------------------
+// TLE parsing
+// ----------------------------------------------------------------------------
+
+static bool tle_checksum_ok(const std::string& line) {
+    if (line.size() < 69 || !std::isdigit(static_cast<unsigned char>(line[68]))) {
+        return line.size() < 69;  // Sets without a checksum column are accepted
+    }
+    int sum = 0;
+    for (size_t i = 0; i < 68; i++) {
+        char c = line[i];
+        if (std::isdigit(static_cast<unsigned char>(c))) sum += c - '0';
+        else if (c == '-') sum += 1;
+    }
+    return sum % 10 == line[68] - '0';
+}
+
+static bool parse_field(const std::string& line, size_t pos, size_t len, double& value) {
+    if (line.size() < pos + len) return false;
+    std::string field = line.substr(pos, len);
+    char* end = nullptr;
+    value = std::strtod(field.c_str(), &end);
+    while (end && *end == ' ') end++;
+    return end && *end == '\0' && end != field.c_str();
+}
+
+// Implied-decimal exponential field, e.g. " 28098-4" = 0.28098e-4
+static bool parse_exp_field(const std::string& line, size_t pos, double& value) {
+    if (line.size() < pos + 8) return false;
+    std::string field = line.substr(pos, 8);
+    double sign = field[0] == '-' ? -1.0 : 1.0;
+    size_t exp_at = field.find_first_of("+-", 1);
+    if (exp_at == std::string::npos) exp_at = 6;
+    double m = std::atof(("0." + field.substr(1, exp_at - 1)).c_str());
+    int e = std::atoi(field.substr(exp_at).c_str());
+    value = sign * m * std::pow(10.0, e);
+    return true;
+}
+
+bool parse_tle(const std::string& line1, const std::string& line2, const std::string& name, Tle& tle) {
+    if (line1.size() < 64 || line2.size() < 63 || line1[0] != '1' || line2[0] != '2') {
+        return false;
+    }
+    if (!tle_checksum_ok(line1) || !tle_checksum_ok(line2)) {
+        return false;
+    }
+
+    double satnum, year, day, ndot, incl, node, ecc, argp, ma, mm;
+    double nddot, bstar;
+    if (!parse_field(line1, 2, 5, satnum) || !parse_field(line1, 18, 2, year) ||
+        !parse_field(line1, 20, 12, day) || !parse_field(line1, 33, 10, ndot) ||
+        !parse_exp_field(line1, 44, nddot) || !parse_exp_field(line1, 53, bstar)) {
+        return false;
+    }
+
+    std::string ecc_field = "0." + line2.substr(26, 7);
+    if (!parse_field(line2, 8, 8, incl) || !parse_field(line2, 17, 8, node) ||
+        !parse_field(ecc_field, 0, ecc_field.size(), ecc) || !parse_field(line2, 34, 8, argp) ||
+        !parse_field(line2, 43, 8, ma) || !parse_field(line2, 52, 11, mm)) {
+        return false;
+    }
+
+    tle.name = name;
+    tle.satnum = static_cast<int>(satnum);
+
+    // Two-digit years: 57-99 are 1900s (Sputnik era onward)
+    int y = static_cast<int>(year);
+    y += (y < 57) ? 2000 : 1900;
+    double jan1 = 367.0 * y - std::floor(7.0 * y / 4.0) + 31.0 + 1721013.5;
+    tle.epoch_jd = jan1 + day - 1.0;
+
+    tle.ndot = ndot / (kXpdotp * 1440.0);
+    tle.nddot = nddot / (kXpdotp * 1440.0 * 1440.0);
+    tle.bstar = bstar;
+    tle.inclo = incl * kDeg2Rad;
+    tle.nodeo = node * kDeg2Rad;
+    tle.ecco = ecc;
+    tle.argpo = argp * kDeg2Rad;
+    tle.mo = ma * kDeg2Rad;
+    tle.no_kozai = mm / kXpdotp;
+    return true;
+}
+
+static std::string trim(const std::string& s) {
+    size_t start = s.find_first_not_of(" \t\r\n");
+    if (start == std::string::npos) return "";
+    size_t stop = s.find_last_not_of(" \t\r\n");
+    return s.substr(start, stop - start + 1);
+}
+
+bool load_tle_file(const std::string& filename, std::vector<Tle>& tles) {
+    std::ifstream file(filename);
+    if (!file) {
+        std::cerr << "Error: Cannot open TLE file: " << filename << std::endl;
+        return false;
+    }
+
+    std::string line, name, line1;
+    while (std::getline(file, line)) {
+        // Keep leading spaces out of the column layout but drop CR / trailing blanks
+        while (!line.empty() && (line.back() == '\r' || line.back() == ' ')) line.pop_back();
+        if (line.empty()) continue;
+
+        if (line.size() > 2 && line[0] == '1' && line[1] == ' ') {
+            line1 = line;
+        } else if (line.size() > 2 && line[0] == '2' && line[1] == ' ' && !line1.empty()) {
+            Tle tle;
+            if (parse_tle(line1, line, name, tle)) {
+                tles.push_back(tle);
+            } else {
+                std::cerr << "Warning: Skipping malformed TLE" << (name.empty() ? "" : " for ")
+                          << name << std::endl;
+            }
+            line1.clear();
+            name.clear();
+        } else {
+            // Name line; 3LE files prefix it with "0 "
+            name = trim(line.compare(0, 2, "0 ") == 0 ? line.substr(2) : line);
+            line1.clear();
+        }
+    }
+    return true;
+}
+
+const Tle* find_tle(const std::vector<Tle>& tles, const std::string& name) {
+    auto upper = [](std::string s) {
+        for (auto& c : s) c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+        return s;
+    };
+    std::string wanted = upper(name);
+    for (const Tle& tle : tles) {
+        if (upper(tle.name).find(wanted) != std::string::npos) return &tle;
+    }
+    // Also accept a NORAD catalog number
+    char* end = nullptr;
+    long satnum = std::strtol(name.c_str(), &end, 10);
+    if (end && *end == '\0' && !name.empty()) {
+        for (const Tle& tle : tles) {
+            if (tle.satnum == satnum) return &tle;
+        }
+    }
+    return nullptr;
+}
+
+double gmst_rad(double jd_ut1) {
+    double tut1 = (jd_ut1 - 2451545.0) / 36525.0;
+    double temp = -6.2e-6 * tut1 * tut1 * tut1 + 0.093104 * tut1 * tut1 +
+                  (876600.0 * 3600.0 + 8640184.812866) * tut1 + 67310.54841;  // Seconds
+    temp = std::fmod(temp * kDeg2Rad / 240.0, kTwoPi);
+    return temp < 0.0 ? temp + kTwoPi : temp;
+}
+
+// ----------------------------------------------------------------------------
+// Sgp4
+// ----------------------------------------------------------------------------
+
+bool Sgp4::init(const Tle& tle) {
+    error_.clear();
+    epoch_jd_ = tle.epoch_jd;
+    bstar_ = tle.bstar;
+    inclo_ = tle.inclo;
+    nodeo_ = tle.nodeo;
+    ecco_ = tle.ecco;
+    argpo_ = tle.argpo;
+    mo_ = tle.mo;
+
+    if (ecco_ < 0.0 || ecco_ >= 1.0 || tle.no_kozai <= 0.0) {
+        error_ = "invalid elements";
+        return false;
+    }
+
+    // Recover the original mean motion and semi-major axis (initl)
+    double eccsq = ecco_ * ecco_;
+    double omeosq = 1.0 - eccsq;
+    double rteosq = std::sqrt(omeosq);
+    double cosio = std::cos(inclo_);
+    double cosio2 = cosio * cosio;
+    double ak = std::pow(kXke / tle.no_kozai, kX2o3);
+    double d1 = 0.75 * WGS72_J2 * (3.0 * cosio2 - 1.0) / (rteosq * omeosq);
+    double del = d1 / (ak * ak);
+    double adel = ak * (1.0 - del * del - del * (1.0 / 3.0 + 134.0 * del * del / 81.0));
+    del = d1 / (adel * adel);
+    no_unkozai_ = tle.no_kozai / (1.0 + del);
+
+    if (period_min() >= SGP4_DEEP_SPACE_PERIOD_MIN) {
+        error_ = "deep-space orbit (period >= 225 min) needs SDP4, not supported";
+        return false;
+    }
+
+    double ao = std::pow(kXke / no_unkozai_, kX2o3);
+    double sinio = std::sin(inclo_);
+    double po = ao * omeosq;
+    double con42 = 1.0 - 5.0 * cosio2;
+    con41_ = -con42 - cosio2 - cosio2;
+    double posq = po * po;
+    double rp = ao * (1.0 - ecco_);
+
+    // Atmospheric drag terms, with the perigee-dependent s and q0
+    double ss = 78.0 / WGS72_RADIUS_KM + 1.0;
+    double qzms2t = std::pow((120.0 - 78.0) / WGS72_RADIUS_KM, 4);
+    isimp_ = rp < (220.0 / WGS72_RADIUS_KM + 1.0);
+
+    double sfour = ss;
+    double qzms24 = qzms2t;
+    double perige = (rp - 1.0) * WGS72_RADIUS_KM;
+    if (perige < 156.0) {
+        sfour = perige - 78.0;
+        if (perige < 98.0) sfour = 20.0;
+        qzms24 = std::pow((120.0 - sfour) / WGS72_RADIUS_KM, 4);
+        sfour = sfour / WGS72_RADIUS_KM + 1.0;
+    }
+
+    double pinvsq = 1.0 / posq;
+    double tsi = 1.0 / (ao - sfour);
+    eta_ = ao * ecco_ * tsi;
+    double etasq = eta_ * eta_;
+    double eeta = ecco_ * eta_;
+    double psisq = std::fabs(1.0 - etasq);
+    double coef = qzms24 * std::pow(tsi, 4);
+    double coef1 = coef / std::pow(psisq, 3.5);
+    double cc2 = coef1 * no_unkozai_ * (ao * (1.0 + 1.5 * etasq + eeta * (4.0 + etasq)) +
+                 0.375 * WGS72_J2 * tsi / psisq * con41_ * (8.0 + 3.0 * etasq * (8.0 + etasq)));
+    cc1_ = bstar_ * cc2;
+    double cc3 = 0.0;
+    if (ecco_ > 1.0e-4) cc3 = -2.0 * coef * tsi * kJ3oJ2 * no_unkozai_ * sinio / ecco_;
+    x1mth2_ = 1.0 - cosio2;
+    cc4_ = 2.0 * no_unkozai_ * coef1 * ao * omeosq *
+           (eta_ * (2.0 + 0.5 * etasq) + ecco_ * (0.5 + 2.0 * etasq) -
+            WGS72_J2 * tsi / (ao * psisq) *
+            (-3.0 * con41_ * (1.0 - 2.0 * eeta + etasq * (1.5 - 0.5 * eeta)) +
+             0.75 * x1mth2_ * (2.0 * etasq - eeta * (1.0 + etasq)) * std::cos(2.0 * argpo_)));
+    cc5_ = 2.0 * coef1 * ao * omeosq * (1.0 + 2.75 * (etasq + eeta) + eeta * etasq);
+
+    // Secular rates from J2 / J4
+    double cosio4 = cosio2 * cosio2;
+    double temp1 = 1.5 * WGS72_J2 * pinvsq * no_unkozai_;
+    double temp2 = 0.5 * temp1 * WGS72_J2 * pinvsq;
+    double temp3 = -0.46875 * WGS72_J4 * pinvsq * pinvsq * no_unkozai_;
+    mdot_ = no_unkozai_ + 0.5 * temp1 * rteosq * con41_ +
+            0.0625 * temp2 * rteosq * (13.0 - 78.0 * cosio2 + 137.0 * cosio4);
+    argpdot_ = -0.5 * temp1 * con42 + 0.0625 * temp2 * (7.0 - 114.0 * cosio2 + 395.0 * cosio4) +
+               temp3 * (3.0 - 36.0 * cosio2 + 49.0 * cosio4);
+    double xhdot1 = -temp1 * cosio;
+    nodedot_ = xhdot1 + (0.5 * temp2 * (4.0 - 19.0 * cosio2) + 2.0 * temp3 * (3.0 - 7.0 * cosio2)) * cosio;
+
+    omgcof_ = bstar_ * cc3 * std::cos(argpo_);
+    xmcof_ = 0.0;
+    if (ecco_ > 1.0e-4) xmcof_ = -kX2o3 * coef * bstar_ / eeta;
+    nodecf_ = 3.5 * omeosq * xhdot1 * cc1_;
+    t2cof_ = 1.5 * cc1_;
+
+    // Avoid the divide by zero at i = 180 deg
+    double denom = std::fabs(cosio + 1.0) > 1.5e-12 ? (1.0 + cosio) : 1.5e-12;
+    xlcof_ = -0.25 * kJ3oJ2 * sinio * (3.0 + 5.0 * cosio) / denom;
+    aycof_ = -0.5 * kJ3oJ2 * sinio;
+    delmo_ = std::pow(1.0 + eta_ * std::cos(mo_), 3);
+    sinmao_ = std::sin(mo_);
+    x7thm1_ = 7.0 * cosio2 - 1.0;
+
+    if (!isimp_) {
+        double cc1sq = cc1_ * cc1_;
+        d2_ = 4.0 * ao * tsi * cc1sq;
+        double temp = d2_ * tsi * cc1_ / 3.0;
+        d3_ = (17.0 * ao + sfour) * temp;
+        d4_ = 0.5 * temp * ao * tsi * (221.0 * ao + 31.0 * sfour) * cc1_;
+        t3cof_ = d2_ + 2.0 * cc1sq;
+        t4cof_ = 0.25 * (3.0 * d3_ + cc1_ * (12.0 * d2_ + 10.0 * cc1sq));
+        t5cof_ = 0.2 * (3.0 * d4_ + 12.0 * cc1_ * d3_ + 6.0 * d2_ * d2_ + 15.0 * cc1sq * (2.0 * d2_ + cc1sq));
+    }
+
+    // Catch elements that fail immediately (e.g. already decayed)
+    StateVector sv;
+    int err = propagate(0.0, sv);
+    if (err != 0) {
+        error_ = "propagation failed at epoch (error " + std::to_string(err) + ")";
+        return false;
+    }
+    return true;
+}
+
+int Sgp4::propagate(double t, StateVector& out) const {
+    // Secular gravity and drag
+    double xmdf = mo_ + mdot_ * t;
+    double argpdf = argpo_ + argpdot_ * t;
+    double nodedf = nodeo_ + nodedot_ * t;
+    double argpm = argpdf;
+    double mm = xmdf;
+    double t2 = t * t;
+    double nodem = nodedf + nodecf_ * t2;
+    double tempa = 1.0 - cc1_ * t;
+    double tempe = bstar_ * cc4_ * t;
+    double templ = t2cof_ * t2;
+
+    if (!isimp_) {
+        double delomg = omgcof_ * t;
+        double delmtemp = 1.0 + eta_ * std::cos(xmdf);
+        double delm = xmcof_ * (delmtemp * delmtemp * delmtemp - delmo_);
+        double temp = delomg + delm;
+        mm = xmdf + temp;
+        argpm = argpdf - temp;
+        double t3 = t2 * t;
+        double t4 = t3 * t;
+        tempa = tempa - d2_ * t2 - d3_ * t3 - d4_ * t4;
+        tempe = tempe + bstar_ * cc5_ * (std::sin(mm) - sinmao_);
+        templ = templ + t3cof_ * t3 + t4 * (t4cof_ + t * t5cof_);
+    }
+
+    double nm = no_unkozai_;
+    double em = ecco_;
+    double inclm = inclo_;
+    if (nm <= 0.0) return 2;
+
+    double am = std::pow(kXke / nm, kX2o3) * tempa * tempa;
+    nm = kXke / std::pow(am, 1.5);
+    em = em - tempe;
+    if (em >= 1.0 || em < -0.001) return 1;
+    if (em < 1.0e-6) em = 1.0e-6;
+
+    mm = mm + no_unkozai_ * templ;
+    double xlm = mm + argpm + nodem;
+    nodem = std::fmod(nodem, kTwoPi);
+    argpm = std::fmod(argpm, kTwoPi);
+    xlm = std::fmod(xlm, kTwoPi);
+    mm = std::fmod(xlm - argpm - nodem, kTwoPi);
+
+    double sinim = std::sin(inclm);
+    double cosim = std::cos(inclm);
+
+    // Long-period periodics
+    double axnl = em * std::cos(argpm);
+    double temp = 1.0 / (am * (1.0 - em * em));
+    double aynl = em * std::sin(argpm) + temp * aycof_;
+    double xl = mm + argpm + nodem + temp * xlcof_ * axnl;
+
+    // Kepler's equation
+    double u = std::fmod(xl - nodem, kTwoPi);
+    double eo1 = u;
+    double tem5 = 9999.9;
+    double sineo1 = 0.0, coseo1 = 1.0;
+    for (int ktr = 1; std::fabs(tem5) >= 1.0e-12 && ktr <= 10; ktr++) {
+        sineo1 = std::sin(eo1);
+        coseo1 = std::cos(eo1);
+        tem5 = 1.0 - coseo1 * axnl - sineo1 * aynl;
+        tem5 = (u - aynl * coseo1 + axnl * sineo1 - eo1) / tem5;
+        if (std::fabs(tem5) >= 0.95) tem5 = tem5 > 0.0 ? 0.95 : -0.95;
+        eo1 = eo1 + tem5;
+    }
+
+    // Short-period periodics
+    double ecose = axnl * coseo1 + aynl * sineo1;
+    double esine = axnl * sineo1 - aynl * coseo1;
+    double el2 = axnl * axnl + aynl * aynl;
+    double pl = am * (1.0 - el2);
+    if (pl < 0.0) return 4;
+
+    double rl = am * (1.0 - ecose);
+    double rdotl = std::sqrt(am) * esine / rl;
+    double rvdotl = std::sqrt(pl) / rl;
+    double betal = std::sqrt(1.0 - el2);
+    temp = esine / (1.0 + betal);
+    double sinu = am / rl * (sineo1 - aynl - axnl * temp);
+    double cosu = am / rl * (coseo1 - axnl + aynl * temp);
+    double su = std::atan2(sinu, cosu);
+    double sin2u = (cosu + cosu) * sinu;
+    double cos2u = 1.0 - 2.0 * sinu * sinu;
+    temp = 1.0 / pl;
+    double temp1 = 0.5 * WGS72_J2 * temp;
+    double temp2 = temp1 * temp;
+
+    double mrt = rl * (1.0 - 1.5 * temp2 * betal * con41_) + 0.5 * temp1 * x1mth2_ * cos2u;
+    su = su - 0.25 * temp2 * x7thm1_ * sin2u;
+    double xnode = nodem + 1.5 * temp2 * cosim * sin2u;
+    double xinc = inclm + 1.5 * temp2 * cosim * sinim * cos2u;
+    double mvt = rdotl - nm * temp1 * x1mth2_ * sin2u / kXke;
+    double rvdot = rvdotl + nm * temp1 * (x1mth2_ * cos2u + 1.5 * con41_) / kXke;
+
+    // Orientation vectors
+    double sinsu = std::sin(su), cossu = std::cos(su);
+    double snod = std::sin(xnode), cnod = std::cos(xnode);
+    double sini = std::sin(xinc), cosi = std::cos(xinc);
+    double xmx = -snod * cosi;
+    double xmy = cnod * cosi;
+    double ux = xmx * sinsu + cnod * cossu;
+    double uy = xmy * sinsu + snod * cossu;
+    double uz = sini * sinsu;
+    double vx = xmx * cossu - cnod * sinsu;
+    double vy = xmy * cossu - snod * sinsu;
+    double vz = sini * cossu;
+
+    out.r[0] = mrt * ux * WGS72_RADIUS_KM;
+    out.r[1] = mrt * uy * WGS72_RADIUS_KM;
+    out.r[2] = mrt * uz * WGS72_RADIUS_KM;
+    out.v[0] = (mvt * ux + rvdot * vx) * kVkmPerSec;
+    out.v[1] = (mvt * uy + rvdot * vy) * kVkmPerSec;
+    out.v[2] = (mvt * uz + rvdot * vz) * kVkmPerSec;
+
+    return mrt < 1.0 ? 6 : 0;
+}
+
+size_t Sgp4::propagate_batch(const double* tsince_min, size_t n, StateVector* out, int* errors) const {
+    size_t failed = 0;
+    for (size_t i = 0; i < n; i++) {
+        int err = propagate(tsince_min[i], out[i]);
+        if (errors) errors[i] = err;
+        failed += err != 0;
+    }
+    return failed;
+}
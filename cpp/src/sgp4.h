@@ -0,0 +1,100 @@
+/*
+ * sgp4.h
+ * Satellite Ground Station - TLE parsing and SGP4 propagation
+ *
+ * Native port of the near-earth SGP4 model (Vallado et al., "Revisiting
+ * Spacetrack Report #3", AIAA 2006-6753) with WGS-72 constants, the same
+ * model skyfield uses. Positions and velocities are in the TEME frame.
+ *
+ * Deep-space elements (period >= 225 min, SDP4) are rejected at init:
+ * every satellite this station tracks (NOAA, METEOR, ISS, the LEO
+ * display targets) is near-earth.
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#ifndef SATGS_SGP4_H
+#define SATGS_SGP4_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#define SGP4_DEEP_SPACE_PERIOD_MIN 225.0
+
+// Mean elements from a two-line element set (angles in radians,
+// mean motion in rad/min)
+struct Tle {
+    std::string name;
+    int satnum = 0;
+    double epoch_jd = 0.0;      // UTC Julian date of the element epoch
+    double ndot = 0.0;          // rad/min^2 (unused by SGP4, kept for reference)
+    double nddot = 0.0;         // rad/min^3
+    double bstar = 0.0;         // 1/earth radii
+    double inclo = 0.0;
+    double nodeo = 0.0;
+    double ecco = 0.0;
+    double argpo = 0.0;
+    double mo = 0.0;
+    double no_kozai = 0.0;
+};
+
+// Parse one element set. Checksums are verified; name may be empty.
+bool parse_tle(const std::string& line1, const std::string& line2, const std::string& name, Tle& tle);
+
+// Read a Celestrak-style file of 2- or 3-line sets. Malformed sets are
+// skipped with a warning; returns false only if the file can't be read.
+bool load_tle_file(const std::string& filename, std::vector<Tle>& tles);
+
+// First set whose name contains `name` (case-insensitive), as
+// doppler_calc.load_satellite matches, or nullptr
+const Tle* find_tle(const std::vector<Tle>& tles, const std::string& name);
+
+// Unix seconds <-> Julian date (UTC)
+inline double unix_to_jd(double unix_sec) { return unix_sec / 86400.0 + 2440587.5; }
+inline double jd_to_unix(double jd) { return (jd - 2440587.5) * 86400.0; }
+
+// Greenwich mean sidereal time (IAU-82) in radians
+double gmst_rad(double jd_ut1);
+
+struct StateVector {
+    double r[3];    // km
+    double v[3];    // km/s
+};
+
+class Sgp4 {
+public:
+    // Precompute the secular terms; false for deep-space or invalid elements
+    bool init(const Tle& tle);
+
+    // State at tsince minutes from the element epoch. Returns 0 on
+    // success or the Vallado error code (1 eccentricity, 2 mean motion,
+    // 4 semi-latus rectum, 6 decayed).
+    int propagate(double tsince_min, StateVector& out) const;
+
+    // States at n times (minutes from epoch). All per-satellite terms are
+    // loop-invariant, so the only per-step branching is the Kepler solve
+    // and the error checks. Returns the number of steps that failed.
+    size_t propagate_batch(const double* tsince_min, size_t n, StateVector* out, int* errors = nullptr) const;
+
+    double epoch_jd() const { return epoch_jd_; }
+    double period_min() const { return 2.0 * 3.14159265358979323846 / no_unkozai_; }
+    const std::string& error() const { return error_; }
+
+private:
+    std::string error_;
+    double epoch_jd_ = 0.0;
+    bool isimp_ = false;
+
+    // Elements
+    double bstar_ = 0, inclo_ = 0, nodeo_ = 0, ecco_ = 0, argpo_ = 0, mo_ = 0, no_unkozai_ = 0;
+
+    // Secular and periodic coefficients (names follow the reference code)
+    double aycof_ = 0, con41_ = 0, cc1_ = 0, cc4_ = 0, cc5_ = 0, d2_ = 0, d3_ = 0, d4_ = 0;
+    double delmo_ = 0, eta_ = 0, argpdot_ = 0, omgcof_ = 0, sinmao_ = 0, t2cof_ = 0, t3cof_ = 0;
+    double t4cof_ = 0, t5cof_ = 0, x1mth2_ = 0, x7thm1_ = 0, mdot_ = 0, nodedot_ = 0, xlcof_ = 0;
+    double xmcof_ = 0, nodecf_ = 0;
+};
+
+#endif // SATGS_SGP4_H
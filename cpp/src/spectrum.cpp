@@ -0,0 +1,78 @@
+/*
+ * spectrum.cpp
+ * Satellite Ground Station - Averaged Power Spectrum for the Waterfall
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#include "spectrum.h"
+#include "fft.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+static const double kPi = 3.14159265358979323846;
+
+bool SpectrumAnalyzer::configure(const SpectrumConfig& config) {
+    if (!fft_size_valid(config.fft_size) || config.fft_size < 64) {
+        std::cerr << "Error: Spectrum size must be a power of two of at least 64\n";
+        return false;
+    }
+    if (config.averages < 1 || config.overlap < 0.0 || config.overlap >= 1.0 ||
+        config.row_rate <= 0.0 || config.db_max <= config.db_min) {
+        std::cerr << "Error: Bad spectrum averaging, overlap, rate or dB range\n";
+        return false;
+    }
+    config_ = config;
+    plan_ = &fft_plan(config.fft_size);
+
+    const size_t n = config.fft_size;
+    hop_ = std::max<size_t>(1, static_cast<size_t>(std::lround(n * (1.0 - config.overlap))));
+    samples_per_row_ = n + (config.averages - 1) * hop_;
+
+    // 4-term Blackman-Harris: -92 dB sidelobes keep a strong carrier
+    // from masking its neighbours
+    window_.resize(n);
+    double sum = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        double x = 2.0 * kPi * i / n;
+        window_[i] = static_cast<float>(0.35875 - 0.48829 * std::cos(x) + 0.14128 * std::cos(2 * x) -
+                                        0.01168 * std::cos(3 * x));
+        sum += window_[i];
+    }
+    // u8_to_cf32 spans +/-1, so a full-scale tone has |X| = sum
+    scale_ = static_cast<float>(1.0 / (sum * sum * config.averages));
+
+    samples_.resize(samples_per_row_);
+    block_.resize(n);
+    power_.resize(n);
+    power_db_.resize(n);
+    return true;
+}
+
+void SpectrumAnalyzer::compute(const uint8_t* iq, uint8_t* row) {
+    const size_t n = config_.fft_size;
+    const DspKernels& k = dsp_kernels();
+    k.u8_to_cf32(iq, samples_.data(), samples_per_row_);
+
+    std::fill(power_.begin(), power_.end(), 0.0f);
+    for (int a = 0; a < config_.averages; a++) {
+        const cf32* in = samples_.data() + a * hop_;
+        for (size_t i = 0; i < n; i++) block_[i] = in[i] * window_[i];
+        plan_->forward(block_.data());
+        for (size_t i = 0; i < n; i++) power_[i] += std::norm(block_[i]);
+    }
+
+    // Swap halves so negative frequencies come first
+    const float span = static_cast<float>(config_.db_max - config_.db_min);
+    const float floor_db = static_cast<float>(config_.db_min);
+    for (size_t i = 0; i < n; i++) {
+        size_t src = (i + n / 2) % n;
+        float db = 10.0f * std::log10(power_[src] * scale_ + 1e-20f);
+        power_db_[i] = db;
+        float level = (db - floor_db) / span * 255.0f;
+        row[i] = static_cast<uint8_t>(std::lround(std::min(255.0f, std::max(0.0f, level))));
+    }
+}
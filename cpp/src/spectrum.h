@@ -0,0 +1,71 @@
+/*
+ * spectrum.h
+ * Satellite Ground Station - Averaged Power Spectrum for the Waterfall
+ *
+ * Turns a short run of u8 I/Q into one waterfall row: Welch average of
+ * `averages` Blackman-Harris windowed FFTs overlapping by `overlap`,
+ * in dBFS (a full-scale tone reads 0 dB), DC in the middle, quantized
+ * to one byte per bin over [db_min, db_max]. The FFT plan comes from
+ * the shared cache in fft.h; everything else is sized in configure().
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#ifndef SATGS_SPECTRUM_H
+#define SATGS_SPECTRUM_H
+
+#include "dsp_kernels.h"
+
+#include <cstdint>
+#include <vector>
+
+#define SPECTRUM_DEFAULT_SIZE      2048    // ~1.2 kHz bins at 2.4 MS/s
+#define SPECTRUM_DEFAULT_AVERAGES  8
+#define SPECTRUM_DEFAULT_OVERLAP   0.5
+#define SPECTRUM_DEFAULT_ROW_RATE  10.0    // Rows per second
+#define SPECTRUM_DEFAULT_DB_MIN    -100.0  // dBFS at byte 0 ...
+#define SPECTRUM_DEFAULT_DB_MAX    0.0     // ... and at byte 255
+
+struct SpectrumConfig {
+    size_t fft_size = SPECTRUM_DEFAULT_SIZE;      // Power of two
+    int averages = SPECTRUM_DEFAULT_AVERAGES;
+    double overlap = SPECTRUM_DEFAULT_OVERLAP;    // Fraction of fft_size, [0, 1)
+    double row_rate = SPECTRUM_DEFAULT_ROW_RATE;
+    double db_min = SPECTRUM_DEFAULT_DB_MIN;
+    double db_max = SPECTRUM_DEFAULT_DB_MAX;
+};
+
+class FftPlan;
+
+class SpectrumAnalyzer {
+public:
+    bool configure(const SpectrumConfig& config);
+
+    // I/Q samples one row consumes
+    size_t samples_per_row() const { return samples_per_row_; }
+    size_t bins() const { return config_.fft_size; }
+    const SpectrumConfig& config() const { return config_; }
+
+    // iq holds samples_per_row() samples (interleaved offset-binary u8);
+    // row receives bins() bytes, lowest frequency first
+    void compute(const uint8_t* iq, uint8_t* row);
+
+    // Unquantized dBFS of the last row, same order
+    const std::vector<float>& power_db() const { return power_db_; }
+
+private:
+    SpectrumConfig config_;
+    const FftPlan* plan_ = nullptr;
+    size_t hop_ = 0;
+    size_t samples_per_row_ = 0;
+    std::vector<float> window_;
+    float scale_ = 1.0f;            // Power normalization (window gain, averages)
+
+    std::vector<cf32> samples_;
+    std::vector<cf32> block_;
+    std::vector<float> power_;
+    std::vector<float> power_db_;
+};
+
+#endif // SATGS_SPECTRUM_H
@@ -0,0 +1,133 @@
+/*
+ * thread_pool.cpp
+ * Satellite Ground Station - Worker Pool for Offline Processing
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#include "thread_pool.h"
+#include "thread_util.h"
+
+#include <string>
+
+void TaskGroup::add() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_++;
+}
+
+void TaskGroup::done() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (--pending_ == 0) cv_.notify_all();
+}
+
+void TaskGroup::wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this]() { return pending_ == 0; });
+}
+
+// Set on pool workers, so submit() can tell a nested task from an
+// outside one
+static thread_local const ThreadPool* tls_pool = nullptr;
+static thread_local int tls_worker = -1;
+
+ThreadPool::ThreadPool(int threads) {
+    if (threads <= 0) threads = cpu_count();
+    // Every deque exists before any worker starts looking for work
+    for (int i = 0; i < threads; i++) {
+        workers_.emplace_back(new Worker());
+    }
+    for (int i = 0; i < threads; i++) {
+        workers_[i]->thread = std::thread(&ThreadPool::worker_loop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    for (auto& w : workers_) w->thread.join();
+}
+
+// queued_ is counted before the task can be seen, so a worker that
+// steals it straight away never takes the count below zero
+void ThreadPool::submit(TaskGroup& group, std::function<void()> task) {
+    group.add();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queued_++;
+        if (tls_pool != this) queue_.push_back({std::move(task), &group});
+    }
+    if (tls_pool == this) {
+        Worker& own = *workers_[tls_worker];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        own.tasks.push_back({std::move(task), &group});
+    }
+    cv_.notify_one();
+}
+
+// Own deque newest first, then the shared queue, then the oldest task
+// of another worker
+bool ThreadPool::take(int id, Task& task) {
+    bool found = false;
+    {
+        Worker& own = *workers_[id];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            found = true;
+        }
+    }
+    if (!found) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!queue_.empty()) {
+            task = std::move(queue_.front());
+            queue_.pop_front();
+            queued_--;
+            return true;
+        }
+    }
+    const int n = size();
+    for (int k = 1; k < n && !found; k++) {
+        Worker& victim = *workers_[(id + k) % n];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            steals_.fetch_add(1, std::memory_order_relaxed);
+            found = true;
+        }
+    }
+    if (found) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queued_--;
+    }
+    return found;
+}
+
+// Queued tasks still run after the destructor is entered; workers exit
+// once every queue is empty
+void ThreadPool::worker_loop(int id) {
+    std::string name = "satgs-pool" + std::to_string(id);
+    set_current_thread_name(name.c_str());
+    tls_pool = this;
+    tls_worker = id;
+
+    while (true) {
+        Task task;
+        if (take(id, task)) {
+            task.fn();
+            task.group->done();
+            continue;
+        }
+        // queued_ can be ahead of what take() saw while a task is being
+        // pushed, or another worker is between popping one and counting
+        // it; that is a retry, not a lost wakeup
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this]() { return stopping_ || queued_ > 0; });
+        if (stopping_ && queued_ == 0) return;
+    }
+}
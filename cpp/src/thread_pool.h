@@ -0,0 +1,98 @@
+/*
+ * thread_pool.h
+ * Satellite Ground Station - Worker Pool for Offline Processing
+ *
+ * Fixed set of worker threads. Tasks submitted from outside the pool
+ * go on one shared FIFO; a task that submits more (a capture queuing
+ * its next chunks) puts them on its worker's own deque, which that
+ * worker runs newest first while idle workers steal from the oldest
+ * end. A job that grows its own work therefore stays on the worker
+ * that has its data warm, and is spread out only when cores would
+ * otherwise sit idle. Tasks are submitted under a TaskGroup so a caller
+ * can wait for its own batch (one capture's chunks) while other
+ * batches keep the workers busy.
+ *
+ * Meant for reprocessing recordings as fast as the cores allow; on the
+ * capture path the session threads stay dedicated and only a
+ * channelized stream's per-carrier demodulators run on a pool.
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#ifndef SATGS_THREAD_POOL_H
+#define SATGS_THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Outstanding task count for one batch
+class TaskGroup {
+public:
+    TaskGroup() = default;
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    // Block until every task submitted under this group has run
+    void wait();
+
+private:
+    friend class ThreadPool;
+    void add();
+    void done();
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    size_t pending_ = 0;
+};
+
+class ThreadPool {
+public:
+    // threads <= 0 uses every online CPU
+    explicit ThreadPool(int threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Onto the calling worker's deque when called from a task of this
+    // pool, else onto the shared queue. A task must not wait on a group
+    // of the same pool.
+    void submit(TaskGroup& group, std::function<void()> task);
+    int size() const { return static_cast<int>(workers_.size()); }
+
+    // Tasks taken from another worker's deque
+    uint64_t steals() const { return steals_.load(std::memory_order_relaxed); }
+
+private:
+    struct Task {
+        std::function<void()> fn;
+        TaskGroup* group;
+    };
+
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+        std::thread thread;
+    };
+
+    bool take(int id, Task& task);
+    void worker_loop(int id);
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::deque<Task> queue_;            // Submitted from outside the pool
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    size_t queued_ = 0;                 // Tasks on any queue (guarded by mutex_)
+    bool stopping_ = false;
+    std::atomic<uint64_t> steals_{0};
+};
+
+#endif // SATGS_THREAD_POOL_H
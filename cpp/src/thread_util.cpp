@@ -0,0 +1,159 @@
+/*
+ * thread_util.cpp
+ * Satellite Ground Station - Thread Placement Helpers
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE     // pthread_setaffinity_np, pthread_setname_np
+#endif
+
+#include "thread_util.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+int cpu_count() {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? static_cast<int>(n) : 1;
+}
+
+bool pin_current_thread(int core) {
+    if (core < 0) return true;
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core % cpu_count(), &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    return false;
+#endif
+}
+
+bool pin_current_thread_excluding(const std::vector<int>& cores) {
+#if defined(__linux__)
+    int n = cpu_count();
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int c = 0; c < n; c++) CPU_SET(c, &set);
+    for (int core : cores) {
+        if (core >= 0) CPU_CLR(core % n, &set);
+    }
+    if (CPU_COUNT(&set) == 0) return false;
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cores;
+    return false;
+#endif
+}
+
+void set_current_thread_name(const char* name) {
+#if defined(__linux__)
+    char buf[16];
+    std::strncpy(buf, name, sizeof(buf) - 1);
+    buf[sizeof(buf) - 1] = '\0';
+    pthread_setname_np(pthread_self(), buf);
+#elif defined(__APPLE__)
+    pthread_setname_np(name);
+#else
+    (void)name;
+#endif
+}
+
+bool lower_current_thread_priority(int nice) {
+#if defined(__linux__)
+    pid_t tid = static_cast<pid_t>(syscall(SYS_gettid));
+    return setpriority(PRIO_PROCESS, static_cast<id_t>(tid), nice) == 0;
+#else
+    (void)nice;
+    return false;
+#endif
+}
+
+bool parse_core_list(const std::string& text, std::vector<int>& cores) {
+    cores.clear();
+    const char* p = text.c_str();
+    while (*p) {
+        char* end = nullptr;
+        errno = 0;
+        long core = std::strtol(p, &end, 10);
+        if (end == p || errno != 0 || core < 0 || core > 4095) return false;
+        cores.push_back(static_cast<int>(core));
+        if (*end == ',') end++;
+        else if (*end != '\0') return false;
+        p = end;
+    }
+    return !cores.empty();
+}
+
+void apply_thread_placement(ThreadPlacement& placement, const char* name) {
+    placement.pinned = placement.core >= 0 && pin_current_thread(placement.core);
+    if (placement.core >= 0 && !placement.pinned) {
+        std::cerr << "Warning: Could not pin " << name << " to core " << placement.core << std::endl;
+    }
+
+    placement.granted_priority = 0;
+    placement.rt_error = 0;
+    if (placement.rt_priority > 0) {
+        sched_param param = {};
+        param.sched_priority = std::max(sched_get_priority_min(SCHED_FIFO),
+                                        std::min(placement.rt_priority, sched_get_priority_max(SCHED_FIFO)));
+        int err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if (err == 0) {
+            placement.granted_priority = param.sched_priority;
+        } else {
+            placement.rt_error = err;
+            std::cerr << "Warning: SCHED_FIFO refused for " << name << ": " << std::strerror(err)
+                      << " (needs CAP_SYS_NICE or an rtprio limit)" << std::endl;
+        }
+    }
+    placement.applied = true;
+}
+
+std::string describe_placement(const ThreadPlacement& placement) {
+    std::string out;
+    if (placement.pinned) out = "core " + std::to_string(placement.core % cpu_count());
+    else if (placement.core >= 0) out = "any core (pinning to " + std::to_string(placement.core) + " failed)";
+    else out = "any core";
+
+    if (placement.granted_priority > 0) {
+        out += ", SCHED_FIFO " + std::to_string(placement.granted_priority);
+    } else {
+        out += ", normal priority";
+        if (placement.rt_error != 0) {
+            out += std::string(" (SCHED_FIFO refused: ") + std::strerror(placement.rt_error) + ")";
+        }
+    }
+    return out;
+}
+
+// mlockall(MCL_FUTURE) under a finite RLIMIT_MEMLOCK would make later
+// allocations fail once the limit is reached, so without privilege or
+// an unlimited allowance only the region itself is locked
+MemoryLock lock_memory(const void* addr, size_t len, int& error) {
+    error = 0;
+    rlimit limit = {};
+    bool unlimited = getrlimit(RLIMIT_MEMLOCK, &limit) == 0 && limit.rlim_cur == RLIM_INFINITY;
+    if ((unlimited || geteuid() == 0) && mlockall(MCL_CURRENT | MCL_FUTURE) == 0) {
+        return MemoryLock::All;
+    }
+    if (addr && len > 0 && mlock(addr, len) == 0) {
+        return MemoryLock::Region;
+    }
+    error = errno;
+    return MemoryLock::None;
+}
@@ -0,0 +1,78 @@
+/*
+ * thread_util.h
+ * Satellite Ground Station - Thread Placement Helpers
+ *
+ * Core pinning and naming for the capture threads. Pinning is a hint:
+ * Linux honours it with pthread_setaffinity_np, macOS has no hard
+ * affinity API, so these report false there and the scheduler decides.
+ *
+ * The real-time pieces (SCHED_FIFO, locked memory) need CAP_SYS_NICE /
+ * CAP_IPC_LOCK or matching RLIMIT_RTPRIO / RLIMIT_MEMLOCK allowances,
+ * e.g. in /etc/security/limits.conf:
+ *
+ *   @plugdev  -  rtprio   60
+ *   @plugdev  -  memlock  65536
+ *
+ * Without them the calls fail, the thread keeps running as before, and
+ * the result says what was refused.
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#ifndef SATGS_THREAD_UTIL_H
+#define SATGS_THREAD_UTIL_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Online CPUs (at least 1)
+int cpu_count();
+
+// Pin the calling thread to one core (taken modulo cpu_count()).
+// Negative core is a no-op that returns true.
+bool pin_current_thread(int core);
+
+// Restrict the calling thread to every online core not in `cores`;
+// false (mask unchanged) if that would leave none
+bool pin_current_thread_excluding(const std::vector<int>& cores);
+
+// Name shown by top -H / gdb; truncated to 15 characters on Linux
+void set_current_thread_name(const char* name);
+
+// Raise the calling thread's nice value (Linux schedules threads
+// individually), for side work that must yield to the capture threads;
+// false if refused or unsupported
+bool lower_current_thread_priority(int nice);
+
+// "0,2,5" -> {0, 2, 5}; false on anything but a comma-separated list
+// of non-negative integers
+bool parse_core_list(const std::string& text, std::vector<int>& cores);
+
+// Placement a thread asks for and, once applied, what it got
+struct ThreadPlacement {
+    int core = -1;              // Requested core (-1 = any)
+    int rt_priority = 0;        // Requested SCHED_FIFO priority (0 = normal)
+
+    bool applied = false;
+    bool pinned = false;
+    int granted_priority = 0;   // 0 = still SCHED_OTHER
+    int rt_error = 0;           // errno from the SCHED_FIFO request
+};
+
+// Apply to the calling thread (name is for the warnings); refusals are
+// reported on stderr and leave the thread as it was
+void apply_thread_placement(ThreadPlacement& placement, const char* name);
+
+// "core 1, SCHED_FIFO 50" / "any core, normal priority (SCHED_FIFO: ...)"
+std::string describe_placement(const ThreadPlacement& placement);
+
+// Page locking: everything (mlockall, current and future mappings) if
+// the limits allow it, else just the given region
+enum class MemoryLock { None, Region, All };
+
+// Lock [addr, addr + len) at least; error gets errno when it is None
+MemoryLock lock_memory(const void* addr, size_t len, int& error);
+
+#endif // SATGS_THREAD_UTIL_H
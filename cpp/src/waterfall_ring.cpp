@@ -0,0 +1,146 @@
+/*
+ * waterfall_ring.cpp
+ * Satellite Ground Station - Shared-memory Waterfall Ring
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#include "waterfall_ring.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#define OFFSET_ROWS_WRITTEN 48
+#define OFFSET_ACTIVE       56
+
+bool parse_waterfall_spec(const std::string& spec, std::string& name, SpectrumConfig& config) {
+    size_t comma = spec.find(',');
+    name = spec.substr(0, comma);
+    if (name.empty()) return false;
+    for (char c : name) {
+        bool ok = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+                  c == '-' || c == '_';
+        if (!ok) return false;
+    }
+    while (comma != std::string::npos) {
+        size_t start = comma + 1;
+        comma = spec.find(',', start);
+        std::string option = spec.substr(start, comma == std::string::npos ? std::string::npos : comma - start);
+        size_t eq = option.find('=');
+        if (eq == std::string::npos) return false;
+        std::string key = option.substr(0, eq);
+        const char* value = option.c_str() + eq + 1;
+        char* end = nullptr;
+        if (key == "fft") {
+            config.fft_size = std::strtoul(value, &end, 10);
+        } else if (key == "avg") {
+            config.averages = static_cast<int>(std::strtol(value, &end, 10));
+        } else if (key == "overlap") {
+            config.overlap = std::strtod(value, &end);
+        } else if (key == "rate") {
+            config.row_rate = std::strtod(value, &end);
+        } else if (key == "range") {
+            config.db_min = std::strtod(value, &end);
+            if (*end != ':') return false;
+            config.db_max = std::strtod(end + 1, &end);
+        } else {
+            return false;
+        }
+        if (end == value || *end != '\0') return false;
+    }
+    return true;
+}
+
+// Written before the rows so a reader never sees a header for a
+// different geometry than the data
+static void write_header(uint8_t* base, const SpectrumConfig& config, uint32_t bins, uint32_t capacity,
+                         uint32_t row_bytes, uint64_t center_freq_hz, uint32_t carrier_freq_hz,
+                         uint32_t sample_rate) {
+    uint32_t header_bytes = WATERFALL_HEADER_BYTES;
+    float db_min = static_cast<float>(config.db_min);
+    float db_max = static_cast<float>(config.db_max);
+    float row_rate = static_cast<float>(config.row_rate);
+    std::memcpy(base, WATERFALL_MAGIC, 8);
+    std::memcpy(base + 8, &header_bytes, 4);
+    std::memcpy(base + 12, &bins, 4);
+    std::memcpy(base + 16, &capacity, 4);
+    std::memcpy(base + 20, &row_bytes, 4);
+    std::memcpy(base + 24, &center_freq_hz, 8);
+    std::memcpy(base + 32, &sample_rate, 4);
+    std::memcpy(base + 36, &db_min, 4);
+    std::memcpy(base + 40, &db_max, 4);
+    std::memcpy(base + 44, &row_rate, 4);
+    std::memcpy(base + 60, &carrier_freq_hz, 4);
+}
+
+bool WaterfallPublisher::open(const std::string& name, const SpectrumConfig& config, uint64_t center_freq_hz,
+                              uint32_t carrier_freq_hz, uint32_t sample_rate, uint32_t capacity) {
+    close();
+    bins_ = static_cast<uint32_t>(config.fft_size);
+    capacity_ = capacity > 0 ? capacity : WATERFALL_DEFAULT_ROWS;
+    row_bytes_ = (WATERFALL_ROW_HEADER + bins_ + 7) & ~7u;
+    size_ = WATERFALL_HEADER_BYTES + static_cast<size_t>(row_bytes_) * capacity_;
+    path_ = WATERFALL_SHM_PREFIX + name;
+
+    // A fresh object each run: a reader still mapping the old one keeps
+    // its pages and sees it go inactive
+    shm_unlink(path_.c_str());
+    int fd = shm_open(path_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        std::cerr << "Error: Cannot create waterfall ring " << path_ << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    if (ftruncate(fd, static_cast<off_t>(size_)) != 0) {
+        std::cerr << "Error: Cannot size waterfall ring " << path_ << ": " << std::strerror(errno) << std::endl;
+        ::close(fd);
+        shm_unlink(path_.c_str());
+        return false;
+    }
+    void* map = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        std::cerr << "Error: Cannot map waterfall ring " << path_ << ": " << std::strerror(errno) << std::endl;
+        shm_unlink(path_.c_str());
+        return false;
+    }
+    base_ = static_cast<uint8_t*>(map);
+    rows_ = 0;
+
+    write_header(base_, config, bins_, capacity_, row_bytes_, center_freq_hz, carrier_freq_hz, sample_rate);
+    for (uint32_t slot = 0; slot < capacity_; slot++) {
+        new (base_ + WATERFALL_HEADER_BYTES + static_cast<size_t>(slot) * row_bytes_) std::atomic<uint64_t>(0);
+    }
+    new (base_ + OFFSET_ROWS_WRITTEN) std::atomic<uint64_t>(0);
+    std::atomic<uint32_t>* active = new (base_ + OFFSET_ACTIVE) std::atomic<uint32_t>(0);
+    active->store(1, std::memory_order_release);
+    return true;
+}
+
+void WaterfallPublisher::publish(const uint8_t* row, double utc) {
+    if (!base_) return;
+    uint8_t* slot = base_ + WATERFALL_HEADER_BYTES + static_cast<size_t>(rows_ % capacity_) * row_bytes_;
+    std::atomic<uint64_t>* sequence = reinterpret_cast<std::atomic<uint64_t>*>(slot);
+    sequence->store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(slot + 8, &utc, 8);
+    std::memcpy(slot + WATERFALL_ROW_HEADER, row, bins_);
+    rows_++;
+    sequence->store(rows_, std::memory_order_release);
+    reinterpret_cast<std::atomic<uint64_t>*>(base_ + OFFSET_ROWS_WRITTEN)->store(rows_, std::memory_order_release);
+}
+
+void WaterfallPublisher::close() {
+    if (!base_) return;
+    reinterpret_cast<std::atomic<uint32_t>*>(base_ + OFFSET_ACTIVE)->store(0, std::memory_order_release);
+    munmap(base_, size_);
+    base_ = nullptr;
+}
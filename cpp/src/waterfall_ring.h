@@ -0,0 +1,82 @@
+/*
+ * waterfall_ring.h
+ * Satellite Ground Station - Shared-memory Waterfall Ring
+ *
+ * Live spectrum rows for the HMI without a socket on the capture side:
+ * the session writes quantized rows (spectrum.h) into a ring in
+ * /dev/shm/satgs-wf-<name>, and satcom_server.py maps the same file to
+ * serve them (python/waterfall_shm.py). Readers never block the writer.
+ *
+ * Layout (little endian, rows start at header_bytes):
+ *
+ *   0   char[8]  magic "SATGSWF1"
+ *   8   u32      header_bytes
+ *   12  u32      bins per row
+ *   16  u32      capacity (rows in the ring)
+ *   20  u32      row_bytes (16-byte row header + bins, padded to 8)
+ *   24  u64      center frequency, Hz
+ *   32  u32      sample rate, Hz
+ *   36  f32      dB at byte 0
+ *   40  f32      dB at byte 255
+ *   44  f32      nominal rows per second
+ *   48  u64      rows written (row k lives in slot k % capacity)
+ *   56  u32      1 while a capture is publishing
+ *   60  u32      carrier of interest, Hz (where the HMI looks for lock)
+ *
+ *   row: u64 sequence (k + 1 once complete, 0 while being written),
+ *        f64 stream time of the first sample (Unix seconds), u8[bins]
+ *
+ * A reader copies a row between two reads of its sequence and keeps it
+ * only if both equal k + 1.
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#ifndef SATGS_WATERFALL_RING_H
+#define SATGS_WATERFALL_RING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "spectrum.h"
+
+#define WATERFALL_SHM_PREFIX  "/satgs-wf-"
+#define WATERFALL_MAGIC       "SATGSWF1"
+#define WATERFALL_HEADER_BYTES 64
+#define WATERFALL_ROW_HEADER  16
+#define WATERFALL_DEFAULT_ROWS 600      // A minute at the default rate
+
+// --waterfall=<name>[,fft=<n>][,avg=<n>][,overlap=<f>][,rate=<hz>][,range=<min>:<max>]
+bool parse_waterfall_spec(const std::string& spec, std::string& name, SpectrumConfig& config);
+
+class WaterfallPublisher {
+public:
+    ~WaterfallPublisher() { close(); }
+
+    // Creates (or replaces) /dev/shm/satgs-wf-<name>
+    bool open(const std::string& name, const SpectrumConfig& config, uint64_t center_freq_hz,
+              uint32_t carrier_freq_hz, uint32_t sample_rate, uint32_t capacity = WATERFALL_DEFAULT_ROWS);
+
+    // bins() bytes; single writer
+    void publish(const uint8_t* row, double utc);
+
+    // Marks the ring inactive and unmaps it; the rows stay readable
+    void close();
+
+    bool is_open() const { return base_ != nullptr; }
+    const std::string& path() const { return path_; }
+    uint64_t rows() const { return rows_; }
+
+private:
+    uint8_t* base_ = nullptr;
+    size_t size_ = 0;
+    uint32_t bins_ = 0;
+    uint32_t capacity_ = 0;
+    uint32_t row_bytes_ = 0;
+    uint64_t rows_ = 0;
+    std::string path_;
+};
+
+#endif // SATGS_WATERFALL_RING_H
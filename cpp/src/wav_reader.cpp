@@ -0,0 +1,97 @@
+/*
+ * wav_reader.cpp
+ * Satellite Ground Station - Streaming WAV Audio Reader
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#include "wav_reader.h"
+
+#include <cstring>
+#include <iostream>
+
+#define WAVE_FORMAT_PCM        1
+#define WAVE_FORMAT_IEEE_FLOAT 3
+#define WAV_READ_BLOCK         16384   // Frames per read() pass of read_all()
+
+static uint32_t get_u32(const char* b) {
+    return static_cast<uint8_t>(b[0]) | static_cast<uint8_t>(b[1]) << 8 |
+           static_cast<uint8_t>(b[2]) << 16 | static_cast<uint32_t>(static_cast<uint8_t>(b[3])) << 24;
+}
+
+static uint16_t get_u16(const char* b) {
+    return static_cast<uint16_t>(static_cast<uint8_t>(b[0]) | static_cast<uint8_t>(b[1]) << 8);
+}
+
+bool WavReader::open(const std::string& path) {
+    file_.close();
+    file_.clear();
+    file_.open(path, std::ios::binary);
+    char header[12];
+    if (!file_ || !file_.read(header, 12) || std::memcmp(header, "RIFF", 4) != 0 ||
+        std::memcmp(header + 8, "WAVE", 4) != 0) {
+        std::cerr << "Error: Not a WAV file: " << path << std::endl;
+        return false;
+    }
+
+    uint16_t format = 0;
+    char chunk[8];
+    while (file_.read(chunk, 8)) {
+        uint32_t size = get_u32(chunk + 4);
+        if (std::memcmp(chunk, "fmt ", 4) == 0) {
+            std::vector<char> fmt(size);
+            if (size < 16 || !file_.read(fmt.data(), size)) break;
+            format = get_u16(&fmt[0]);
+            channels_ = get_u16(&fmt[2]);
+            sample_rate_ = get_u32(&fmt[4]);
+            bits_ = get_u16(&fmt[14]);
+            if (size & 1) file_.ignore(1);
+        } else if (std::memcmp(chunk, "data", 4) == 0) {
+            bool pcm16 = format == WAVE_FORMAT_PCM && bits_ == 16;
+            bool f32 = format == WAVE_FORMAT_IEEE_FLOAT && bits_ == 32;
+            if (channels_ == 0 || (!pcm16 && !f32)) {
+                std::cerr << "Error: Unsupported WAV encoding (need 16-bit PCM or 32-bit float): "
+                          << path << std::endl;
+                return false;
+            }
+            is_float_ = f32;
+            frames_ = size / (static_cast<uint64_t>(channels_) * bits_ / 8);
+            return true;
+        } else {
+            file_.ignore(size + (size & 1));
+        }
+    }
+    std::cerr << "Error: WAV file has no fmt/data chunk: " << path << std::endl;
+    return false;
+}
+
+size_t WavReader::read(float* out, size_t max_frames) {
+    const size_t frame_bytes = static_cast<size_t>(channels_) * bits_ / 8;
+    if (frame_bytes == 0 || !file_) return 0;
+    raw_.resize(max_frames * frame_bytes);
+    file_.read(raw_.data(), static_cast<std::streamsize>(raw_.size()));
+    size_t n = static_cast<size_t>(file_.gcount()) / frame_bytes;
+    for (size_t i = 0; i < n; i++) {
+        const char* s = &raw_[i * frame_bytes];
+        if (is_float_) {
+            std::memcpy(&out[i], s, sizeof(float));
+        } else {
+            out[i] = static_cast<int16_t>(get_u16(s)) / 32768.0f;
+        }
+    }
+    return n;
+}
+
+bool WavReader::read_all(std::vector<float>& samples) {
+    samples.clear();
+    samples.reserve(static_cast<size_t>(frames_));
+    size_t n;
+    do {
+        size_t at = samples.size();
+        samples.resize(at + WAV_READ_BLOCK);
+        n = read(samples.data() + at, WAV_READ_BLOCK);
+        samples.resize(at + n);
+    } while (n > 0);
+    return !samples.empty();
+}
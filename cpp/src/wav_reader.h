@@ -0,0 +1,51 @@
+/*
+ * wav_reader.h
+ * Satellite Ground Station - Streaming WAV Audio Reader
+ *
+ * Reads 16-bit PCM or 32-bit float RIFF/WAVE files (what WavWriter,
+ * rtlsdr_capture -a and most recorders produce) block by block as
+ * float samples in [-1, 1]. Multi-channel files return the first
+ * channel.
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#ifndef SATGS_WAV_READER_H
+#define SATGS_WAV_READER_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+class WavReader {
+public:
+    // Leaves the stream at the first sample
+    bool open(const std::string& path);
+    void close() { file_.close(); }
+
+    // Up to max_frames samples into out; 0 at end of file. Reads to the
+    // end of the file rather than the declared data size, so a WAV still
+    // being written (placeholder header) can be followed.
+    size_t read(float* out, size_t max_frames);
+
+    // Whole remaining file into samples (replaced)
+    bool read_all(std::vector<float>& samples);
+
+    uint32_t sample_rate() const { return sample_rate_; }
+    uint16_t channels() const { return channels_; }
+    uint64_t frames() const { return frames_; }    // As declared by the data chunk
+    bool is_float() const { return is_float_; }
+
+private:
+    std::ifstream file_;
+    uint32_t sample_rate_ = 0;
+    uint16_t channels_ = 0;
+    uint16_t bits_ = 0;
+    bool is_float_ = false;
+    uint64_t frames_ = 0;
+    std::vector<char> raw_;
+};
+
+#endif // SATGS_WAV_READER_H
@@ -0,0 +1,102 @@
+/*
+ * wav_writer.cpp
+ * Satellite Ground Station - Streaming WAV Audio Writer
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#include "wav_writer.h"
+
+#include <algorithm>
+#include <cmath>
+
+#define WAVE_FORMAT_PCM        1
+#define WAVE_FORMAT_IEEE_FLOAT 3
+
+bool parse_audio_format(const std::string& name, AudioFormat& format) {
+    if (name == "s16" || name == "int16") format = AudioFormat::Int16;
+    else if (name == "f32" || name == "float") format = AudioFormat::Float32;
+    else return false;
+    return true;
+}
+
+const char* audio_format_name(AudioFormat format) {
+    return format == AudioFormat::Float32 ? "f32" : "s16";
+}
+
+static void put_u16(std::ofstream& f, uint16_t v) {
+    char b[2] = {static_cast<char>(v & 0xff), static_cast<char>(v >> 8)};
+    f.write(b, 2);
+}
+
+static void put_u32(std::ofstream& f, uint32_t v) {
+    char b[4] = {static_cast<char>(v & 0xff), static_cast<char>((v >> 8) & 0xff),
+                 static_cast<char>((v >> 16) & 0xff), static_cast<char>(v >> 24)};
+    f.write(b, 4);
+}
+
+bool WavWriter::open(const std::string& path, uint32_t sample_rate, AudioFormat format) {
+    close();
+    sample_rate_ = sample_rate;
+    format_ = format;
+    samples_ = 0;
+    file_.open(path, std::ios::binary | std::ios::out | std::ios::trunc);
+    if (!file_) return false;
+    write_header();
+    return static_cast<bool>(file_);
+}
+
+void WavWriter::write_header() {
+    uint16_t bits = (format_ == AudioFormat::Float32) ? 32 : 16;
+    uint16_t block_align = bits / 8;
+    uint64_t data_bytes64 = samples_ * block_align;
+    uint32_t data_bytes = data_bytes64 > 0xFFFFFFFFull - 36 ? 0xFFFFFFFFu - 36 : static_cast<uint32_t>(data_bytes64);
+
+    file_.write("RIFF", 4);
+    put_u32(file_, 36 + data_bytes);
+    file_.write("WAVE", 4);
+    file_.write("fmt ", 4);
+    put_u32(file_, 16);
+    put_u16(file_, format_ == AudioFormat::Float32 ? WAVE_FORMAT_IEEE_FLOAT : WAVE_FORMAT_PCM);
+    put_u16(file_, 1);  // Mono
+    put_u32(file_, sample_rate_);
+    put_u32(file_, sample_rate_ * block_align);
+    put_u16(file_, block_align);
+    put_u16(file_, bits);
+    file_.write("data", 4);
+    put_u32(file_, data_bytes);
+}
+
+bool WavWriter::write(const float* samples, size_t n) {
+    if (!file_.is_open()) return false;
+    if (format_ == AudioFormat::Float32) {
+        file_.write(reinterpret_cast<const char*>(samples), n * sizeof(float));
+    } else {
+        scratch_.resize(n);
+        for (size_t i = 0; i < n; i++) {
+            float v = std::max(-1.0f, std::min(1.0f, samples[i]));
+            scratch_[i] = static_cast<int16_t>(std::lrint(v * 32767.0f));
+        }
+        file_.write(reinterpret_cast<const char*>(scratch_.data()), n * sizeof(int16_t));
+    }
+    samples_ += n;
+    return static_cast<bool>(file_);
+}
+
+void WavWriter::flush_header() {
+    if (!file_.is_open()) return;
+    std::streampos end = file_.tellp();
+    file_.seekp(0);
+    write_header();
+    file_.seekp(end);
+    file_.flush();
+}
+
+bool WavWriter::close() {
+    if (!file_.is_open()) return true;
+    file_.seekp(0);
+    write_header();
+    file_.close();
+    return !file_.fail();
+}
@@ -0,0 +1,58 @@
+/*
+ * wav_writer.h
+ * Satellite Ground Station - Streaming WAV Audio Writer
+ *
+ * Mono RIFF/WAVE output as int16 PCM or 32-bit IEEE float. The header
+ * is written up front with placeholder sizes and patched on close, so
+ * the file can be appended to for the whole pass. Readable by
+ * scipy.io.wavfile (decode_apt_wav.py) and any APT decoder.
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#ifndef SATGS_WAV_WRITER_H
+#define SATGS_WAV_WRITER_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+enum class AudioFormat {
+    Int16,
+    Float32
+};
+
+bool parse_audio_format(const std::string& name, AudioFormat& format);
+const char* audio_format_name(AudioFormat format);
+
+class WavWriter {
+public:
+    ~WavWriter() { close(); }
+
+    bool open(const std::string& path, uint32_t sample_rate, AudioFormat format);
+
+    // Samples are nominally in [-1, 1]; int16 output is clipped
+    bool write(const float* samples, size_t n);
+
+    // Rewinds to patch the RIFF/data sizes; safe to call more than once
+    bool close();
+
+    // Patch the header in place so readers see everything written so far
+    void flush_header();
+
+    uint64_t samples_written() const { return samples_; }
+    bool is_open() const { return file_.is_open(); }
+
+private:
+    void write_header();
+
+    std::ofstream file_;
+    uint32_t sample_rate_ = 0;
+    AudioFormat format_ = AudioFormat::Int16;
+    uint64_t samples_ = 0;
+    std::vector<int16_t> scratch_;
+};
+
+#endif // SATGS_WAV_WRITER_H
@@ -0,0 +1,24 @@
+/*
+ * test_dsp_kernels.cpp
+ * Satellite Ground Station - SIMD Kernel Checks
+ *
+ * Every kernel table this CPU supports against the scalar reference, as
+ * rtlsdr_capture --dsp-check does, without needing a dongle build.
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#include "dsp_kernels.h"
+
+#include <iostream>
+
+int main() {
+    bool ok = true;
+    for (const DspKernels* const* k = dsp_kernels_available(); *k; k++) {
+        ok = dsp_kernels_verify(**k, std::cout) && ok;
+    }
+    if (ok) std::cout << "dsp_kernels: all checks passed\n";
+    else std::cerr << "FAIL: a kernel table disagrees with the scalar reference\n";
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,49 @@
+/*
+ * test_latency_histogram.cpp
+ * Satellite Ground Station - LatencyHistogram Percentile Checks
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#include "latency_histogram.h"
+
+#include <iostream>
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+    if (!ok) {
+        std::cerr << "FAIL: " << what << "\n";
+        failures++;
+    }
+}
+
+int main() {
+    LatencyHistogram empty;
+    check(empty.percentile_ns(99) == 0 && empty.min_ns() == 0, "empty histogram reports 0");
+
+    // 7.40-7.65 ms all land in the 7.34-8.39 ms bucket, whose upper edge
+    // is above everything recorded (the p99 > max a capture reported)
+    LatencyHistogram h;
+    const uint64_t values[] = {7400000, 7500000, 7600000, 7650000};
+    for (uint64_t v : values) h.record(v);
+    check(LatencyHistogram::bucket_upper(22 * LATENCY_SUB_BUCKETS + 3) > 7650000, "values share a bucket");
+    check(h.max_ns() == 7650000 && h.min_ns() == 7400000, "min and max tracked");
+    check(h.percentile_ns(99) <= h.max_ns(), "p99 <= max");
+    check(h.percentile_ns(50) <= h.max_ns(), "p50 <= max");
+    check(h.percentile_ns(0) >= h.min_ns(), "p0 >= min");
+    check(h.percentile_ns(100) == h.max_ns(), "p100 == max");
+
+    // A single value is every percentile
+    LatencyHistogram one;
+    one.record(123456);
+    check(one.percentile_ns(1) == 123456 && one.percentile_ns(99) == 123456, "single value");
+
+    h.reset();
+    h.record(5000);
+    check(h.min_ns() == 5000 && h.max_ns() == 5000, "reset clears min and max");
+
+    if (failures == 0) std::cout << "latency_histogram: all checks passed\n";
+    return failures == 0 ? 0 : 1;
+}
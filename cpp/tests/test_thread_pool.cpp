@@ -0,0 +1,50 @@
+/*
+ * test_thread_pool.cpp
+ * Satellite Ground Station - Work-stealing Pool Checks
+ *
+ * Nested submits land on the submitting worker's deque, where the other
+ * workers steal them at once; every task has to run exactly once and
+ * the pool has to shut down with nothing left counted.
+ *
+ * Author: Luke Waszyn
+ * Date: February 2026
+ */
+
+#include "thread_pool.h"
+
+#include <atomic>
+#include <iostream>
+
+#define ROUNDS      200
+#define FAN_OUT     16     // Outside tasks per round ...
+#define NESTED      8      // ... each submitting this many more
+
+int main() {
+    int failures = 0;
+    for (int threads : {2, 4}) {
+        std::atomic<int> ran{0};
+        {
+            ThreadPool pool(threads);
+            for (int round = 0; round < ROUNDS; round++) {
+                TaskGroup outer, inner;
+                for (int i = 0; i < FAN_OUT; i++) {
+                    pool.submit(outer, [&pool, &inner, &ran]() {
+                        for (int k = 0; k < NESTED; k++) {
+                            pool.submit(inner, [&ran]() { ran.fetch_add(1, std::memory_order_relaxed); });
+                        }
+                        ran.fetch_add(1, std::memory_order_relaxed);
+                    });
+                }
+                outer.wait();
+                inner.wait();
+            }
+        }   // Hangs here if the pool lost count of its queued tasks
+        int expected = ROUNDS * FAN_OUT * (NESTED + 1);
+        if (ran != expected) {
+            std::cerr << "FAIL: " << threads << " threads ran " << ran << " of " << expected << " tasks\n";
+            failures++;
+        }
+    }
+    if (failures == 0) std::cout << "thread_pool: all checks passed\n";
+    return failures == 0 ? 0 : 1;
+}
@@ -7,6 +7,11 @@ Fetches real TLEs from Celestrak, propagates with SGP4 via Skyfield,
 and exports satellite positions, pass predictions, and Doppler profiles
 as JSON for the SATCOM 3D visualizer.
 
+With --format bin the propagation is handed to the C++ exporter
+(cpp/build/satgs_orbits): the same catalog and cached TLEs, written as
+orbital_data.bin, which the visualizer maps onto typed arrays. A rerun
+extends that file instead of recomputing the whole window.
+
 Tracks a mix of satellites for a full mission ops display:
   - NOAA 20 (primary imaging target)
   - NOAA 21, METEOR-M (weather constellation)
@@ -20,6 +25,7 @@ Reuses patterns from:
 Usage:
     python generate_orbital_data.py
     python generate_orbital_data.py --hours 24 --step 30 -o orbital_data.json
+    python generate_orbital_data.py --format bin -o orbital_data.bin
 
 Author: Luke Waszyn
 Date: February 2026
@@ -30,6 +36,9 @@ import math
 import argparse
 import sys
 import os
+import glob
+import subprocess
+import tempfile
 import time as time_module
 from datetime import datetime, timedelta, timezone
 
@@ -55,6 +64,10 @@ MIN_ELEVATION = 10.0
 # Speed of light (m/s) — matches doppler_calc.py
 C = 299792458.0
 
+# Native exporter for --format bin
+SATGS_ORBITS = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                            '..', 'cpp', 'build', 'satgs_orbits')
+
 # =============================================================
 # Satellite Catalog
 #
@@ -552,6 +565,55 @@ def generate_data(duration_hours=24, position_step_sec=30, output_path='orbital_
     return output
 
 
+def generate_binary(duration_hours=24, position_step_sec=30, output_path='orbital_data.bin',
+                    doppler_step_sec=5.0, full=False, tle_dir='.', exporter=SATGS_ORBITS):
+    """
+    TLE fetch here, propagation in satgs_orbits -> orbital_data.bin.
+    Segments still ahead of now are kept from the previous file.
+    Returns True on success.
+    """
+    if not os.path.exists(exporter):
+        print(f"[BIN] ERROR: {exporter} not found (build cpp/ first)")
+        return False
+
+    # Refreshes the tle_*.txt caches the exporter reads
+    fetch_tles(tle_dir)
+    tle_files = sorted(glob.glob(os.path.join(tle_dir, 'tle_*.txt')))
+
+    catalog = [{
+        'name': name,
+        'norad_id': info['norad_id'],
+        'freq_hz': info['freq_hz'],
+        'color': info['color'],
+        'role': info['role'],
+        'search_names': info.get('search_names', []),
+    } for name, info in TRACKED_SATS.items()]
+    station = {'station': {
+        'name': 'State College, PA',
+        'lat': GS_LAT,
+        'lon': GS_LON,
+        'elevation_m': GS_ELEV,
+        'min_elevation_deg': MIN_ELEVATION,
+    }}
+
+    with tempfile.TemporaryDirectory() as tmp:
+        catalog_path = os.path.join(tmp, 'catalog.json')
+        config_path = os.path.join(tmp, 'config.json')
+        with open(catalog_path, 'w') as f:
+            json.dump(catalog, f)
+        with open(config_path, 'w') as f:
+            json.dump(station, f)
+
+        cmd = [exporter, '-T', ','.join(tle_files), f'--catalog={catalog_path}',
+               '-c', config_path, '-o', output_path, f'--hours={duration_hours}',
+               f'--step={position_step_sec}', f'--doppler-step={doppler_step_sec}']
+        if full:
+            cmd.append('--full')
+        result = subprocess.run(cmd)
+
+    return result.returncode == 0
+
+
 def main():
     parser = argparse.ArgumentParser(
         description='Generate orbital data for SATCOM 3D visualizer',
@@ -561,20 +623,34 @@ Examples:
   python generate_orbital_data.py                        # 24h, 30s steps
   python generate_orbital_data.py --hours 48 --step 60   # 48h, 1-min steps
   python generate_orbital_data.py -o viz_data.json       # Custom output
+  python generate_orbital_data.py --format bin -o orbital_data.bin
 """
     )
     parser.add_argument('--hours', type=float, default=24,
                         help='Prediction window in hours (default: 24)')
     parser.add_argument('--step', type=float, default=30,
                         help='Position sample interval in seconds (default: 30)')
-    parser.add_argument('--output', '-o', type=str, default='orbital_data.json',
-                        help='Output JSON path (default: orbital_data.json)')
+    parser.add_argument('--output', '-o', type=str, default=None,
+                        help='Output path (default: orbital_data.json, or .bin)')
+    parser.add_argument('--format', choices=['json', 'bin'], default='json',
+                        help='json (Skyfield) or bin (satgs_orbits, incremental)')
+    parser.add_argument('--full', action='store_true',
+                        help='bin: propagate the whole window even if the file could be extended')
 
     args = parser.parse_args()
+    if args.format == 'bin':
+        ok = generate_binary(
+            duration_hours=args.hours,
+            position_step_sec=args.step,
+            output_path=args.output or 'orbital_data.bin',
+            full=args.full,
+        )
+        sys.exit(0 if ok else 1)
+
     generate_data(
         duration_hours=args.hours,
         position_step_sec=args.step,
-        output_path=args.output,
+        output_path=args.output or 'orbital_data.json',
     )
 
 
@@ -16,6 +16,7 @@ Date: February 2026
 
 import os
 import json
+import subprocess
 from datetime import datetime
 from pathlib import Path
 from typing import Dict, List, Optional, Any
@@ -27,6 +28,10 @@ DATA_DIR = Path('data')
 MISSIONS_FILE = DATA_DIR / 'missions.json'
 METRICS_FILE = DATA_DIR / 'metrics.json'
 ML_FEATURES_FILE = DATA_DIR / 'ml' / 'training_data.json'
+ARCHIVE_INDEX = DATA_DIR / 'archive.sgi'
+
+# Capture archive index (cpp/src/archive_index.h)
+ARCHIVE_TOOL = Path('cpp/build/satgs_archive')
 
 
 def ensure_data_dirs():
@@ -150,6 +155,122 @@ def get_mission_count() -> Dict[str, int]:
     }
 
 
+# ============================================================
+# CAPTURE ARCHIVE INDEX
+# ============================================================
+
+def _iso(t) -> str:
+    """ISO 8601 for a datetime (naive = UTC), or the string as given."""
+    return t.isoformat() if isinstance(t, datetime) else str(t)
+
+
+def index_pass(
+    satellite: str,
+    aos_time,
+    los_time,
+    max_elevation: float,
+    capture_success: bool,
+    decode_success: bool,
+    capture_file: Optional[str] = None,
+    image_file: Optional[str] = None,
+    capture_start=None,
+    sample_rate: Optional[float] = None,
+    freq_hz: Optional[float] = None,
+    source: str = 'python',
+    index_file: Path = ARCHIVE_INDEX
+) -> bool:
+    """
+    Add a finished pass to the archive index with satgs_archive.
+
+    The capture's timing (and seek table for .sgc) is read once here, so
+    later history queries and seeks need only the index. The decoder's
+    <name>_metadata.json next to the image supplies SNR and sync rate.
+    Returns False when the tool is not built or indexing failed; the
+    mission log stays the record of truth either way.
+    """
+    if not ARCHIVE_TOOL.exists():
+        return False
+
+    cmd = [
+        str(ARCHIVE_TOOL), 'add', '-I', str(index_file),
+        f'--satellite={satellite}',
+        f'--aos={_iso(aos_time)}',
+        f'--los={_iso(los_time)}',
+        f'--max-el={max_elevation}',
+        f'--source={source}',
+    ]
+    if capture_success:
+        cmd.append('--captured')
+    if decode_success:
+        cmd.append('--decoded')
+    if capture_file and os.path.exists(capture_file):
+        cmd.append(f'--capture={capture_file}')
+        if capture_start is not None:
+            cmd.append(f'--capture-start={_iso(capture_start)}')
+        if sample_rate:
+            cmd += ['-s', str(int(sample_rate))]
+    if image_file:
+        cmd.append(f'--image={image_file}')
+        metadata = image_file.replace('_decoded.png', '_metadata.json')
+        if metadata != image_file and os.path.exists(metadata):
+            cmd.append(f'--metadata={metadata}')
+    if freq_hz:
+        cmd.append(f'--freq={freq_hz}')
+
+    Path(index_file).parent.mkdir(parents=True, exist_ok=True)
+    try:
+        result = subprocess.run(cmd, capture_output=True, text=True, timeout=30)
+    except (OSError, subprocess.TimeoutExpired) as e:
+        print(f"Warning: archive index not updated: {e}")
+        return False
+    if result.returncode != 0:
+        print(f"Warning: archive index not updated: {result.stderr.strip()}")
+        return False
+    return True
+
+
+def query_archive(
+    satellite: Optional[str] = None,
+    since=None,
+    until=None,
+    min_elevation: Optional[float] = None,
+    decoded_only: bool = False,
+    limit: Optional[int] = None,
+    index_file: Path = ARCHIVE_INDEX
+) -> Optional[List[Dict]]:
+    """
+    Passes from the archive index, newest first when limited.
+
+    Entries carry the mission log's field names. Returns None when the
+    tool or the index is missing, so callers can fall back to reading
+    the mission log.
+    """
+    if not ARCHIVE_TOOL.exists() or not Path(index_file).exists():
+        return None
+
+    cmd = [str(ARCHIVE_TOOL), 'query', '-I', str(index_file), '--json']
+    if satellite:
+        cmd.append(f'-S{satellite}')
+    if since is not None:
+        cmd.append(f'--from={_iso(since)}')
+    if until is not None:
+        cmd.append(f'--to={_iso(until)}')
+    if min_elevation is not None:
+        cmd.append(f'--min-el={min_elevation}')
+    if decoded_only:
+        cmd.append('--decoded')
+    if limit:
+        cmd += ['-n', str(int(limit))]
+
+    try:
+        result = subprocess.run(cmd, capture_output=True, text=True, timeout=30)
+    except (OSError, subprocess.TimeoutExpired):
+        return None
+    if result.returncode != 0:
+        return None
+    return json.loads(result.stdout)
+
+
 # ============================================================
 # PERFORMANCE METRICS
 # ============================================================
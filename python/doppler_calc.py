@@ -20,9 +20,10 @@ Date: February 2026
 
 import numpy as np
 from skyfield.api import load, wgs84, EarthSatellite
-from datetime import datetime, timedelta
+from datetime import datetime, timedelta, timezone
 import json
 import os
+import struct
 
 # Speed of light
 C = 299792458.0  # m/s
@@ -35,6 +36,10 @@ NOAA_FREQUENCIES = {
     'NOAA 20': 137.100e6,  # NOAA 20 uses same as NOAA 19
 }
 
+# Binary profile (.dpb) read by cpp/src/doppler_profile.cpp
+DOPPLER_BINARY_MAGIC = b'SGDP'
+DOPPLER_BINARY_VERSION = 1
+
 # Observer location (State College, PA)
 OBSERVER_LAT = 40.7934
 OBSERVER_LON = -77.8600
@@ -174,6 +179,54 @@ def save_doppler_profile(profile, output_path):
     print(f"Saved Doppler profile: {output_path}")
 
 
+def _profile_series(profile):
+    """Return (times_sec, doppler_hz) from either profile schema."""
+    if 'points' in profile and 'times_sec' not in profile:
+        points = profile['points']
+        times = [p.get('time_sec', p.get('t', i * profile.get('time_step_sec', 1.0)))
+                 for i, p in enumerate(points)]
+        doppler = [p.get('doppler_hz', p.get('doppler')) for p in points]
+        return times, doppler
+    return list(profile['times_sec']), list(profile['doppler_hz'])
+
+
+def _utc_epoch(iso_text):
+    """ISO timestamp (naive = UTC) to Unix seconds, 0.0 if missing."""
+    if not iso_text:
+        return 0.0
+    dt = datetime.fromisoformat(str(iso_text).replace('Z', '+00:00'))
+    if dt.tzinfo is None:
+        dt = dt.replace(tzinfo=timezone.utc)
+    return dt.timestamp()
+
+
+def save_doppler_profile_binary(profile, output_path):
+    """
+    Save Doppler profile in the compact binary format (.dpb).
+    
+    Layout (little-endian): magic 'SGDP', uint32 version, uint32 count,
+    uint32 reserved, float64 center_freq_hz, time_step_sec, aos_epoch_sec,
+    then float64 times_sec[count] and float64 doppler_hz[count].
+    The C++ tools load it with a single read, no parsing.
+    """
+    times, doppler = _profile_series(profile)
+    if len(times) != len(doppler):
+        raise ValueError("Doppler profile times and values differ in length")
+    
+    header = struct.pack('<4sIII3d',
+                         DOPPLER_BINARY_MAGIC, DOPPLER_BINARY_VERSION, len(times), 0,
+                         float(profile.get('center_freq_hz', 0.0)),
+                         float(profile.get('time_step_sec', 0.0)),
+                         _utc_epoch(profile.get('aos_utc')))
+    
+    with open(output_path, 'wb') as f:
+        f.write(header)
+        f.write(np.asarray(times, dtype='<f8').tobytes())
+        f.write(np.asarray(doppler, dtype='<f8').tobytes())
+    
+    print(f"Saved binary Doppler profile: {output_path}")
+
+
 def print_profile_summary(profile):
     """Print summary of Doppler profile."""
     print("\n" + "="*60)
@@ -202,7 +255,7 @@ if __name__ == "__main__":
         print("  satellite  - Satellite name (e.g., 'NOAA 18')")
         print("  aos_utc    - AOS time in ISO format (e.g., '2026-02-03T14:30:00')")
         print("  los_utc    - LOS time in ISO format (e.g., '2026-02-03T14:45:00')")
-        print("  output     - Output JSON file (optional)")
+        print("  output     - Output file (optional; .dpb writes the binary format)")
         print("")
         print("Example:")
         print("  python doppler_calc.py 'NOAA 18' '2026-02-03T14:30:00' '2026-02-03T14:45:00'")
@@ -216,7 +269,9 @@ if __name__ == "__main__":
     profile = calculate_doppler_profile(sat, aos, los)
     print_profile_summary(profile)
     
-    if output:
+    if output and output.endswith('.dpb'):
+        save_doppler_profile_binary(profile, output)
+    elif output:
         save_doppler_profile(profile, output)
     else:
         # Default output location
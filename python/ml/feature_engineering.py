@@ -8,17 +8,28 @@ for use in ML prediction models.
 
 Features:
     - Orbital: max elevation, duration, time of day, azimuth range
+      (plus range, Doppler span/rate and sun angles from the native path)
     - Weather: cloud cover, precipitation, temperature
     - Historical: recent success rate, satellite-specific performance
     - Hardware: gain setting, LNA status, antenna config
 
+Native path:
+    When cpp/build holds the satgs_features module (cpp/src/pass_features.cpp),
+    native_upcoming_passes() predicts passes and computes their orbital
+    features in one batch from the C++ SGP4 propagator. Results are cached per
+    element set for the life of the process, so a later call only propagates
+    satellites whose TLE changed and hours not covered yet. The pass dicts
+    carry their features, so rescoring them after a weather update does no
+    orbital work at all.
+
 Author: Luke Waszyn
 Date: February 2026
 """
 
 import numpy as np
 import pandas as pd
-from datetime import datetime
+import time
+from datetime import datetime, timezone
 from typing import Dict, List, Optional, Tuple
 import sys
 import os
@@ -26,6 +37,24 @@ import os
 sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
 from python.data_store import get_missions, get_recent_success_rate, get_satellite_stats
 
+# Repository root, so the defaults below don't depend on the caller's cwd
+_REPO_ROOT = os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+# Optional native module, built by cmake when pybind11 is available
+_BUILD_DIR = os.path.join(_REPO_ROOT, 'cpp', 'build')
+try:
+    sys.path.insert(0, _BUILD_DIR)
+    import satgs_features
+except ImportError:
+    satgs_features = None
+finally:
+    sys.path.remove(_BUILD_DIR)
+
+NATIVE_SATELLITES = ['NOAA 15', 'NOAA 18', 'NOAA 19', 'NOAA 20']
+NATIVE_TLE_FILE = os.path.join(_REPO_ROOT, 'weather.txt')
+NATIVE_CONFIG_FILE = os.path.join(_REPO_ROOT, 'config.json')
+_native_cache = None
+
 
 # Feature definitions
 FEATURE_SCHEMA = {
@@ -38,6 +67,13 @@ FEATURE_SCHEMA = {
     'is_morning_pass': 'int',          # 0 or 1
     'is_evening_pass': 'int',          # 0 or 1
     
+    # Propagator features (native path only, not model inputs yet)
+    'tca_range_km': 'float',           # slant range at max elevation
+    'doppler_span_hz': 'float',        # AOS minus LOS shift
+    'doppler_rate_hz_s': 'float',      # peak rate, at TCA
+    'sun_elevation_deg': 'float',      # at the station, at TCA
+    'subsat_sun_elevation_deg': 'float',  # under the satellite (>0: visible channel lit)
+    
     # Weather features
     'cloud_cover_pct': 'float',        # 0-100 (nullable)
     'precipitation_prob': 'float',     # 0-1 (nullable)
@@ -67,6 +103,10 @@ def extract_orbital_features(pass_info: Dict) -> Dict:
     Returns:
         Dictionary of orbital features
     """
+    # Passes from native_upcoming_passes() arrive with theirs
+    if 'orbital_features' in pass_info:
+        return dict(pass_info['orbital_features'])
+    
     aos = pass_info.get('aos_time')
     los = pass_info.get('los_time')
     
@@ -107,6 +147,59 @@ def extract_orbital_features(pass_info: Dict) -> Dict:
     }
 
 
+def native_upcoming_passes(hours_ahead: float = 24,
+                           min_elevation: float = 0,
+                           tle_file: str = NATIVE_TLE_FILE,
+                           config_file: str = NATIVE_CONFIG_FILE,
+                           satellites: Optional[List[str]] = None) -> Optional[List[Dict]]:
+    """
+    Upcoming passes with their orbital features, from the native module.
+    
+    Same dict layout as schedule_captures.get_upcoming_passes (elevation
+    mask from config.json), plus 'orbital_features'. Element sets are
+    re-read from tle_file on every call, but only the satellites whose
+    elements changed are propagated again. The default files are the
+    repository's weather.txt and config.json, wherever it is called from.
+    
+    Returns:
+        List of pass dictionaries in AOS order, or None without the module
+    """
+    global _native_cache
+    if satgs_features is None or not os.path.exists(tle_file):
+        return None
+    
+    if _native_cache is None:
+        _native_cache = satgs_features.PassFeatureCache(config_file if os.path.exists(config_file) else '')
+    _native_cache.load_tles(tle_file, satellites or NATIVE_SATELLITES)
+    _native_cache.update(time.time(), hours_ahead * 3600.0)
+    cols = _native_cache.features()
+    
+    def utc(t):
+        return datetime.fromtimestamp(float(t), tz=timezone.utc)
+    
+    native_names = [name for name in FEATURE_SCHEMA if name in cols]
+    passes = []
+    for i, satellite in enumerate(cols['satellite']):
+        if cols['max_elevation_deg'][i] < min_elevation:
+            continue
+        features = {name: float(cols[name][i]) for name in native_names}
+        features['aos_day_of_week'] = int(features['aos_day_of_week'])
+        features['is_morning_pass'] = int(features['is_morning_pass'])
+        features['is_evening_pass'] = int(features['is_evening_pass'])
+        passes.append({
+            'satellite': satellite,
+            'aos_time': utc(cols['aos_unix'][i]),
+            'max_time': utc(cols['tca_unix'][i]),
+            'los_time': utc(cols['los_unix'][i]),
+            'max_elevation': features['max_elevation_deg'],
+            'aos_az': float(cols['aos_az_deg'][i]),
+            'los_az': float(cols['los_az_deg'][i]),
+            'duration_sec': float(cols['los_unix'][i] - cols['aos_unix'][i]),
+            'orbital_features': features,
+        })
+    return passes
+
+
 def extract_weather_features(weather: Optional[Dict] = None) -> Dict:
     """
     Extract weather features.
@@ -228,6 +321,41 @@ def extract_all_features(
     return features
 
 
+def extract_features_batch(
+    passes: List[Dict],
+    weather: Optional[Dict] = None,
+    config: Optional[Dict] = None
+) -> List[Dict]:
+    """
+    extract_all_features for many passes at once.
+    
+    Weather and hardware features are shared by every pass and the
+    historical ones only depend on the satellite, so the mission store is
+    read once per satellite rather than once per pass.
+    
+    Returns:
+        Feature dictionaries in the order of passes
+    """
+    weather_features = extract_weather_features(weather)
+    hardware_features = extract_hardware_features(config)
+    
+    historical = {}
+    features_list = []
+    for pass_info in passes:
+        satellite = pass_info.get('satellite', '')
+        if satellite not in historical:
+            historical[satellite] = extract_historical_features(satellite)
+        
+        features = extract_orbital_features(pass_info)
+        features.update(weather_features)
+        features.update(historical[satellite])
+        features.update(hardware_features)
+        features['satellite'] = satellite
+        features_list.append(features)
+    
+    return features_list
+
+
 def features_to_dataframe(features_list: List[Dict]) -> pd.DataFrame:
     """
     Convert list of feature dictionaries to DataFrame.
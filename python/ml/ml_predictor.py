@@ -26,6 +26,7 @@ sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
 
 from python.ml.feature_engineering import (
     extract_all_features,
+    extract_features_batch,
     features_to_dataframe,
     get_feature_names,
     impute_missing
@@ -84,7 +85,8 @@ class MissionPredictor:
     def predict(self,
                 pass_info: Dict,
                 weather: Optional[Dict] = None,
-                config: Optional[Dict] = None) -> Dict:
+                config: Optional[Dict] = None,
+                features: Optional[Dict] = None) -> Dict:
         """
         Predict mission outcome.
         
@@ -92,6 +94,7 @@ class MissionPredictor:
             pass_info: Pass data from scheduler
             weather: Weather data (optional)
             config: Hardware config (optional)
+            features: Precomputed extract_all_features result (optional)
         
         Returns:
             Dictionary with predictions:
@@ -101,10 +104,9 @@ class MissionPredictor:
                 - method: 'ml' or 'rule_based'
                 - recommendation: 'capture', 'skip', or 'marginal'
         """
-        # Extract features
-        features = extract_all_features(pass_info, weather, config)
-        
         if self.using_ml and self.classifier is not None:
+            if features is None:
+                features = extract_all_features(pass_info, weather, config)
             return self._predict_ml(features)
         else:
             return self._predict_rules(pass_info, weather)
@@ -199,9 +201,13 @@ class MissionPredictor:
         
         Returns list of predictions in same order as input.
         """
+        features_list = [None] * len(passes)
+        if self.using_ml and self.classifier is not None:
+            features_list = extract_features_batch(passes, weather, config)
+        
         predictions = []
-        for p in passes:
-            pred = self.predict(p, weather, config)
+        for p, features in zip(passes, features_list):
+            pred = self.predict(p, weather, config, features)
             pred['pass_info'] = p
             predictions.append(pred)
         return predictions
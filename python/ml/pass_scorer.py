@@ -24,7 +24,7 @@ from datetime import datetime
 from typing import Dict, List, Optional, Tuple
 
 sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
-from python.ml.feature_engineering import extract_all_features
+from python.ml.feature_engineering import extract_orbital_features, extract_weather_features
 
 
 # Scoring weights
@@ -168,8 +168,10 @@ def score_pass(pass_info: Dict,
         - score: 0.0 to 1.0
         - breakdown: Dict with component scores
     """
-    # Extract features
-    features = extract_all_features(pass_info, weather)
+    # Only orbital and weather features are scored (the historical ones
+    # would read the mission store for every pass)
+    features = extract_orbital_features(pass_info)
+    features.update(extract_weather_features(weather))
     
     # Component scores
     el_score = score_elevation(features['max_elevation_deg'])
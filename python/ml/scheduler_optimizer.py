@@ -25,6 +25,7 @@ sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
 
 from python.ml.ml_predictor import get_predictor, predict_success
 from python.ml.pass_scorer import score_pass
+from python.ml.feature_engineering import native_upcoming_passes
 from python.schedule_captures import get_upcoming_passes
 
 
@@ -62,16 +63,18 @@ class ScheduleOptimizer:
         Returns:
             List of scheduled captures with predictions
         """
-        # Get upcoming passes
-        passes = get_upcoming_passes(hours_ahead=hours_ahead, min_elevation=15)
+        # Get upcoming passes (native batch features when built)
+        passes = native_upcoming_passes(hours_ahead=hours_ahead, min_elevation=15)
+        if passes is None:
+            passes = get_upcoming_passes(hours_ahead=hours_ahead, min_elevation=15)
         
         if not passes:
             return []
         
         # Score all passes
         scored_passes = []
-        for p in passes:
-            pred = self.predictor.predict(p, weather, config)
+        for pred in self.predictor.predict_batch(passes, weather, config):
+            p = pred.pop('pass_info')
             scored_passes.append({
                 'pass': p,
                 'prediction': pred,
@@ -9,6 +9,8 @@ Single script to execute a complete mission:
     3. Wait for AOS
     4. Capture I/Q data
     5. Decode APT image
+       (4 and 5 run as one process when cpp/build/satgs_pass is built:
+        no I/Q file, image ready seconds after LOS)
     6. Log results
     7. Store ML training data
 
@@ -30,8 +32,10 @@ from python.schedule_captures import (
     select_best_pass,
     wait_for_pass,
     execute_capture,
+    execute_pass,
     ensure_directories,
-    CONFIG
+    CONFIG,
+    PASS_EXECUTOR
 )
 from python.doppler_calc import calculate_doppler_profile, save_doppler_profile
 from python.data_store import log_mission, log_training_sample, log_metrics, print_summary
@@ -67,6 +71,74 @@ def get_weather_data():
     }
 
 
+def finish_mission(selected_pass, capture_success, capture_file, decode_result):
+    """Log the mission and its ML training sample, print the summary."""
+    decode_success = decode_result is not None
+    
+    # Step 7: Log mission
+    print("\nStep 7: Logging mission...")
+    
+    snr_db = None
+    sync_pulses = None
+    if decode_result and 'metadata' in decode_result:
+        sync_pulses = decode_result['metadata'].get('sync_pulses_found')
+    
+    mission_record = log_mission(
+        satellite=selected_pass['satellite'],
+        aos_time=selected_pass['aos_time'],
+        los_time=selected_pass['los_time'],
+        max_elevation=selected_pass['max_elevation'],
+        capture_success=capture_success,
+        decode_success=decode_success,
+        capture_file=capture_file,
+        image_file=decode_result['png_path'] if decode_result else None,
+        snr_db=snr_db,
+        sync_pulses_found=sync_pulses
+    )
+    
+    # Step 8: Log ML training data
+    print("Step 8: Logging ML training sample...")
+    
+    weather = get_weather_data()
+    aos_hour = selected_pass['aos_time'].hour + selected_pass['aos_time'].minute / 60.0
+    
+    log_training_sample(
+        satellite=selected_pass['satellite'],
+        max_elevation_deg=selected_pass['max_elevation'],
+        duration_min=selected_pass['duration_sec'] / 60.0,
+        time_of_day_hour=aos_hour,
+        day_of_week=selected_pass['aos_time'].weekday(),
+        cloud_cover_pct=weather.get('cloud_cover_pct'),
+        precipitation_prob=weather.get('precipitation_prob'),
+        temperature_c=weather.get('temperature_c'),
+        gain_db=CONFIG['capture_gain_db'],
+        antenna_type='dipole',
+        using_lna=False,  # Update when LNA is integrated
+        decode_success=decode_success,
+        snr_db=snr_db,
+        sync_rate=sync_pulses / (selected_pass['duration_sec'] * 2) if sync_pulses else None
+    )
+    
+    # Summary
+    print("\n" + "="*60)
+    print("MISSION COMPLETE")
+    print("="*60)
+    print(f"Satellite: {selected_pass['satellite']}")
+    print(f"Capture: {'SUCCESS' if capture_success else 'FAILED'}")
+    print(f"Decode: {'SUCCESS' if decode_success else 'FAILED'}")
+    if decode_result:
+        print(f"Image: {decode_result['png_path']}")
+    print("="*60 + "\n")
+    
+    return {
+        'success': decode_success,
+        'pass': selected_pass,
+        'capture_file': capture_file,
+        'decode_result': decode_result,
+        'mission_record': mission_record
+    }
+
+
 def run_mission(
     satellite: str = None,
     min_elevation: float = 20.0,
@@ -159,6 +231,18 @@ def run_mission(
         print(f"\nPass is {time_until/60:.1f} minutes away. Use --wait to wait for it.")
         return None
     
+    # Steps 5-6 in one process when the pass executor is built; the pass
+    # is over once it returns, so there is nothing to fall back to
+    if not skip_decode and os.path.exists(PASS_EXECUTOR):
+        print("\nStep 5: Executing pass (capture + decode)...")
+        decode_result = execute_pass(selected_pass, doppler_profile)
+        if decode_result:
+            print(f"Image saved: {decode_result['png_path']}")
+            print(f"Image size: {decode_result['metadata']['image_width']} x {decode_result['metadata']['image_height']}")
+        else:
+            print("Pass failed!")
+        return finish_mission(selected_pass, decode_result is not None, None, decode_result)
+
     # Step 5: Execute capture
     print("\nStep 5: Executing capture...")
     capture_file = execute_capture(selected_pass, doppler_profile)
@@ -200,68 +284,7 @@ def run_mission(
     else:
         print("\nStep 6: Skipping decode (--skip-decode)")
     
-    # Step 7: Log mission
-    print("\nStep 7: Logging mission...")
-    
-    snr_db = None
-    sync_pulses = None
-    if decode_result and 'metadata' in decode_result:
-        sync_pulses = decode_result['metadata'].get('sync_pulses_found')
-    
-    mission_record = log_mission(
-        satellite=selected_pass['satellite'],
-        aos_time=selected_pass['aos_time'],
-        los_time=selected_pass['los_time'],
-        max_elevation=selected_pass['max_elevation'],
-        capture_success=capture_success,
-        decode_success=decode_success,
-        capture_file=capture_file,
-        image_file=decode_result['png_path'] if decode_result else None,
-        snr_db=snr_db,
-        sync_pulses_found=sync_pulses
-    )
-    
-    # Step 8: Log ML training data
-    print("Step 8: Logging ML training sample...")
-    
-    weather = get_weather_data()
-    aos_hour = selected_pass['aos_time'].hour + selected_pass['aos_time'].minute / 60.0
-    
-    log_training_sample(
-        satellite=selected_pass['satellite'],
-        max_elevation_deg=selected_pass['max_elevation'],
-        duration_min=selected_pass['duration_sec'] / 60.0,
-        time_of_day_hour=aos_hour,
-        day_of_week=selected_pass['aos_time'].weekday(),
-        cloud_cover_pct=weather.get('cloud_cover_pct'),
-        precipitation_prob=weather.get('precipitation_prob'),
-        temperature_c=weather.get('temperature_c'),
-        gain_db=CONFIG['capture_gain_db'],
-        antenna_type='dipole',
-        using_lna=False,  # Update when LNA is integrated
-        decode_success=decode_success,
-        snr_db=snr_db,
-        sync_rate=sync_pulses / (selected_pass['duration_sec'] * 2) if sync_pulses else None
-    )
-    
-    # Summary
-    print("\n" + "="*60)
-    print("MISSION COMPLETE")
-    print("="*60)
-    print(f"Satellite: {selected_pass['satellite']}")
-    print(f"Capture: {'SUCCESS' if capture_success else 'FAILED'}")
-    print(f"Decode: {'SUCCESS' if decode_success else 'FAILED'}")
-    if decode_result:
-        print(f"Image: {decode_result['png_path']}")
-    print("="*60 + "\n")
-    
-    return {
-        'success': decode_success,
-        'pass': selected_pass,
-        'capture_file': capture_file,
-        'decode_result': decode_result,
-        'mission_record': mission_record
-    }
+    return finish_mission(selected_pass, capture_success, capture_file, decode_result)
 
 
 def main():
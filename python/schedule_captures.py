@@ -23,6 +23,7 @@ import os
 import sys
 import json
 import time
+import signal
 import subprocess
 from datetime import datetime, timedelta
 from pathlib import Path
@@ -31,7 +32,8 @@ from pathlib import Path
 sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
 
 from python.predict_passes import main as predict_passes
-from python.doppler_calc import calculate_doppler_profile, save_doppler_profile
+from python.doppler_calc import calculate_doppler_profile, save_doppler_profile, save_doppler_profile_binary
+from python.data_store import index_pass
 
 # Configuration
 CONFIG = {
@@ -48,6 +50,13 @@ CONFIG = {
 }
 
 
+# Single-process capture + decode (cpp/src/satgs_pass.cpp)
+PASS_EXECUTOR = './cpp/build/satgs_pass'
+
+# Resident multi-pass scheduler (cpp/src/satgs_scheduler.cpp)
+SCHEDULER_SERVICE = './cpp/build/satgs_scheduler'
+
+
 def ensure_directories():
     """Create necessary data directories."""
     for key in ['data_dir', 'captures_dir', 'decoded_dir', 'schedules_dir', 'doppler_dir']:
@@ -210,8 +219,12 @@ def execute_capture(pass_info, doppler_profile):
     output_file = os.path.join(CONFIG['captures_dir'], f"{sat_name}_{timestamp}.bin")
     doppler_file = os.path.join(CONFIG['doppler_dir'], f"{sat_name}_{timestamp}_doppler.json")
     
-    # Save Doppler profile for the tracker
+    # Save Doppler profile for the tracker; the binary copy loads instantly at AOS
     save_doppler_profile(doppler_profile, doppler_file)
+    try:
+        save_doppler_profile_binary(doppler_profile, doppler_file.replace('.json', '.dpb'))
+    except (KeyError, ValueError, TypeError) as e:
+        print(f"Warning: binary Doppler profile not written: {e}")
     
     # Calculate capture duration
     duration_sec = pass_info['duration_sec'] + CONFIG['pre_aos_margin_sec'] + CONFIG['post_los_margin_sec']
@@ -273,6 +286,66 @@ def execute_capture(pass_info, doppler_profile):
         return None
 
 
+def execute_pass(pass_info, doppler_profile):
+    """
+    Run the whole pass in one process with the C++ pass executor.
+
+    satgs_pass opens the dongle pre_aos_margin_sec before AOS, streams
+    through Doppler correction and demodulation straight into the APT
+    decoder, and has the image on disk moments after LOS. No I/Q file is
+    written. Returns a decode result like decode_apt(), or None if the
+    executor is missing or the pass failed.
+    """
+    if not os.path.exists(PASS_EXECUTOR):
+        return None
+
+    sat_name = pass_info['satellite'].replace(' ', '_').replace('(', '').replace(')', '')
+    timestamp = pass_info['aos_time'].strftime('%Y%m%d_%H%M%S')
+    doppler_file = os.path.join(CONFIG['doppler_dir'], f"{sat_name}_{timestamp}_doppler.dpb")
+    png_path = os.path.join(CONFIG['decoded_dir'], f"{sat_name}_{timestamp}.png")
+
+    save_doppler_profile_binary(doppler_profile, doppler_file)
+
+    cmd = [
+        PASS_EXECUTOR,
+        '-p', doppler_file,
+        '-i', png_path,
+        '-s', str(int(CONFIG['capture_sample_rate'])),
+        '-g', str(int(CONFIG['capture_gain_db'])),
+        f"--warmup={int(CONFIG['pre_aos_margin_sec'])}",
+    ]
+    print(f"Executing: {' '.join(cmd)}")
+
+    timeout = pass_info['duration_sec'] + CONFIG['pre_aos_margin_sec'] + 120
+    try:
+        result = subprocess.run(cmd, capture_output=True, text=True, timeout=timeout)
+    except subprocess.TimeoutExpired:
+        print("\nPass executor timed out!")
+        return None
+
+    if result.returncode != 0 or not os.path.exists(png_path):
+        print(f"\nPass failed with return code {result.returncode}")
+        print(f"stderr: {result.stderr}")
+        return None
+
+    # "  Image:     <png> (<lines> lines, <synced> synced)"
+    lines = synced = None
+    for line in result.stdout.splitlines():
+        if line.strip().startswith('Image:') and 'synced)' in line:
+            counts = line[line.rindex('(') + 1:line.rindex(')')].split(',')
+            lines = int(counts[0].split()[0])
+            synced = int(counts[1].split()[0])
+
+    return {
+        'png_path': png_path,
+        'metadata': {
+            'image_width': 2080,
+            'image_height': lines,
+            'sync_pulses_found': synced,
+        }
+    }
+
+
 def decode_capture(capture_file, pass_info):
     """Run APT decoder on captured file."""
     if not capture_file or not os.path.exists(capture_file):
@@ -335,6 +408,18 @@ def log_mission(pass_info, capture_file, decode_result):
     
     print(f"\nMission logged: {log_file}")
     
+    # Archive index: the raw capture's start is taken from when it was
+    # last written, less its length at the capture rate
+    if index_pass(
+        pass_info['satellite'], pass_info['aos_time'], pass_info['los_time'],
+        pass_info['max_elevation'],
+        mission_log['capture_success'], mission_log['decode_success'],
+        capture_file=capture_file, image_file=mission_log['image_file'],
+        sample_rate=CONFIG['capture_sample_rate'], source='schedule_captures',
+        index_file=os.path.join(CONFIG['data_dir'], 'archive.sgi'),
+    ):
+        print("Archive index updated")
+    
     return mission_log
 
 
@@ -393,6 +478,21 @@ def run_daemon(hours=24):
     print(f"{'='*60}\n")
     
     ensure_directories()
+
+    # The C++ service books overlapping passes onto devices and channel
+    # slots and runs them in one process; it reads the same config.json
+    if os.path.exists(SCHEDULER_SERVICE) and os.path.exists('weather.txt'):
+        cmd = [SCHEDULER_SERVICE, '-T', 'weather.txt', f"--horizon={min(hours, 24)}"]
+        print(f"Executing: {' '.join(cmd)}")
+        proc = subprocess.Popen(cmd)
+        try:
+            proc.wait(timeout=hours * 3600)
+        except subprocess.TimeoutExpired:
+            proc.send_signal(signal.SIGINT)     # Finishes and logs the open pass
+            proc.wait()
+        print("\nDaemon finished.")
+        return
+
     end_time = datetime.utcnow() + timedelta(hours=hours)
     
     while datetime.utcnow() < end_time:
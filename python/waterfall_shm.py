@@ -0,0 +1,179 @@
+#!/usr/bin/env python3
+"""
+waterfall_shm.py
+Satellite Ground Station - Waterfall Ring Reader
+
+Reads the live spectrum rows a capture publishes with --waterfall=<name>
+(cpp/src/waterfall_ring.h) from /dev/shm/satgs-wf-<name>. The capture
+never waits on a reader: a row that is overwritten while it is being
+copied fails its sequence check and is skipped.
+
+Also estimates carrier lock from the newest row: the strongest bin near
+the expected carrier, its offset, and its height over the noise floor.
+
+Author: Luke Waszyn
+Date: February 2026
+"""
+
+import mmap
+import os
+import statistics
+import struct
+from pathlib import Path
+from typing import Dict, List, Optional, Any
+
+
+SHM_DIR = Path('/dev/shm')
+SHM_PREFIX = 'satgs-wf-'
+MAGIC = b'SATGSWF1'
+
+# Header fields up to the rows-written counter (waterfall_ring.h)
+HEADER_FORMAT = '<8sIIIIQIfff'
+OFFSET_ROWS_WRITTEN = 48
+OFFSET_ACTIVE = 56
+OFFSET_CARRIER = 60
+ROW_HEADER = 16
+
+# How far from the expected carrier to search, Hz (APT Doppler is +/-4 kHz)
+LOCK_SEARCH_HZ = 8000
+# Peak height over the median bin for the HMI to call it locked, dB
+LOCK_SNR_DB = 10.0
+
+
+def list_waterfalls() -> List[str]:
+    """Names of the waterfall rings present in shared memory."""
+    if not SHM_DIR.is_dir():
+        return []
+    return sorted(p.name[len(SHM_PREFIX):] for p in SHM_DIR.glob(SHM_PREFIX + '*'))
+
+
+def _u64(buf, offset: int) -> int:
+    return struct.unpack_from('<Q', buf, offset)[0]
+
+
+def read_waterfall(name: str, since: int = 0, max_rows: int = 50) -> Optional[Dict[str, Any]]:
+    """
+    Read the header and the rows newer than `since`.
+
+    Args:
+        name: Ring name as given to --waterfall
+        since: Rows already seen (the rows_written of the previous call)
+        max_rows: Newest rows to return at most
+
+    Returns:
+        Dict with the ring metadata and 'rows', a list of
+        {'seq', 'utc', 'data'} with data the quantized bins (bytes), or
+        None if the ring does not exist or is not a waterfall
+    """
+    if not name or '/' in name:
+        return None
+    path = SHM_DIR / (SHM_PREFIX + name)
+    try:
+        fd = os.open(path, os.O_RDONLY)
+    except OSError:
+        return None
+    try:
+        size = os.fstat(fd).st_size
+        if size < 64:
+            return None
+        buf = mmap.mmap(fd, size, prot=mmap.PROT_READ)
+    finally:
+        os.close(fd)
+
+    try:
+        (magic, header_bytes, bins, capacity, row_bytes, center, rate,
+         db_min, db_max, row_rate) = struct.unpack_from(HEADER_FORMAT, buf, 0)
+        if magic != MAGIC or header_bytes + row_bytes * capacity > size:
+            return None
+        written = _u64(buf, OFFSET_ROWS_WRITTEN)
+        active = struct.unpack_from('<I', buf, OFFSET_ACTIVE)[0] != 0
+        carrier = struct.unpack_from('<I', buf, OFFSET_CARRIER)[0]
+
+        # Only rows still in the ring, newest max_rows of them
+        first = max(0, since, written - capacity, written - max_rows)
+        rows = []
+        for k in range(int(first), int(written)):
+            offset = header_bytes + (k % capacity) * row_bytes
+            seq = _u64(buf, offset)
+            utc = struct.unpack_from('<d', buf, offset + 8)[0]
+            data = buf[offset + ROW_HEADER:offset + ROW_HEADER + bins]
+            if seq != k + 1 or _u64(buf, offset) != seq:
+                continue  # Being rewritten
+            rows.append({'seq': seq, 'utc': utc, 'data': data})
+    finally:
+        buf.close()
+
+    return {
+        'name': name,
+        'bins': bins,
+        'capacity': capacity,
+        'center_freq_hz': center,
+        'carrier_freq_hz': carrier,
+        'sample_rate': rate,
+        'db_min': db_min,
+        'db_max': db_max,
+        'row_rate': row_rate,
+        'active': active,
+        'rows_written': written,
+        'rows': rows,
+    }
+
+
+def carrier_lock(ring: Dict[str, Any]) -> Optional[Dict[str, Any]]:
+    """
+    Carrier estimate from the newest row of a read_waterfall() result.
+
+    Returns:
+        Dict with 'offset_hz' (peak relative to the expected carrier),
+        'peak_db', 'floor_db', 'snr_db' and 'locked', or None without rows
+    """
+    if not ring or not ring['rows']:
+        return None
+    row = ring['rows'][-1]['data']
+    bins = ring['bins']
+    bin_hz = ring['sample_rate'] / bins
+    db_per_step = (ring['db_max'] - ring['db_min']) / 255.0
+
+    carrier = ring['carrier_freq_hz'] or ring['center_freq_hz']
+    centre_bin = bins // 2 + int(round((carrier - ring['center_freq_hz']) / bin_hz))
+    span = max(1, int(LOCK_SEARCH_HZ / bin_hz))
+    lo = max(0, centre_bin - span)
+    hi = min(bins, centre_bin + span + 1)
+    if lo >= hi:
+        return None
+
+    peak = max(range(lo, hi), key=lambda i: row[i])
+    floor = statistics.median(row)
+    peak_db = ring['db_min'] + row[peak] * db_per_step
+    floor_db = ring['db_min'] + floor * db_per_step
+    snr = peak_db - floor_db
+    return {
+        'offset_hz': (peak - centre_bin) * bin_hz,
+        'peak_db': round(peak_db, 1),
+        'floor_db': round(floor_db, 1),
+        'snr_db': round(snr, 1),
+        'locked': snr >= LOCK_SNR_DB,
+    }
+
+
+if __name__ == '__main__':
+    import sys
+    import time
+
+    names = sys.argv[1:] or list_waterfalls()
+    if not names:
+        print("No waterfall rings in /dev/shm")
+        sys.exit(1)
+    for ring_name in names:
+        ring = read_waterfall(ring_name, max_rows=1)
+        if ring is None:
+            print(f"{ring_name}: not a waterfall ring")
+            continue
+        lock = carrier_lock(ring)
+        state = 'active' if ring['active'] else 'stopped'
+        print(f"{ring_name}: {ring['bins']} bins, {ring['sample_rate'] / 1e6:.3f} MS/s at "
+              f"{ring['center_freq_hz'] / 1e6:.4f} MHz, {ring['rows_written']} rows, {state}")
+        if lock:
+            age = time.time() - ring['rows'][-1]['utc']
+            print(f"  carrier {lock['offset_hz']:+.0f} Hz, {lock['snr_db']:.1f} dB over floor"
+                  f"{' (locked)' if lock['locked'] else ''}, newest row {age:.1f} s old")
@@ -19,18 +19,21 @@ With a single command:
 API Endpoints:
   GET  /                     → HMI frontend
   GET  /api/orbital-data     → Live orbital data (replaces orbital_data.json)
+  GET  /api/orbital-data.bin → The same as orbital_data.bin (satgs_orbits, extended incrementally)
   GET  /api/passes           → Upcoming passes with capture recommendations
   GET  /api/status           → System status (SDR, capture state, etc.)
-  GET  /api/missions         → Mission history log
+  GET  /api/missions         → Mission history (?satellite=&since=&min_elevation=&decoded=&limit=)
   GET  /api/config           → Current station configuration
   PUT  /api/config           → Update station configuration
   POST /api/capture          → Schedule/trigger a satellite capture
   GET  /api/decoded/<file>   → Serve decoded APT images
+  GET  /api/waterfall        → Live spectrum rings (?name=<ring>&since=<row> for rows)
 
 Author: Luke Waszyn
 Date: February 2026
 """
 
+import base64
 import json
 import os
 import sys
@@ -54,6 +57,7 @@ DECODED_DIR = DATA_DIR / 'decoded'
 CAPTURES_DIR = DATA_DIR / 'captures'
 CONFIG_PATH = BASE_DIR / 'config.json'
 MISSION_LOG_PATH = DATA_DIR / 'mission_log.json'
+ARCHIVE_INDEX_PATH = DATA_DIR / 'archive.sgi'
 
 # Add project root to path for imports
 sys.path.insert(0, str(BASE_DIR))
@@ -155,27 +159,31 @@ state = SystemState()
 # =============================================================
 # Orbital Data Generation (wraps generate_orbital_data.py)
 # =============================================================
+def load_generator(config):
+    """Import generate_orbital_data (hmi/) with the station from config."""
+    sys.path.insert(0, str(HMI_DIR))
+
+    import importlib
+    if 'generate_orbital_data' in sys.modules:
+        mod = importlib.reload(sys.modules['generate_orbital_data'])
+    else:
+        mod = importlib.import_module('generate_orbital_data')
+
+    # Patch ground station from config
+    mod.GS_LAT = config['station']['lat']
+    mod.GS_LON = config['station']['lon']
+    mod.GS_ELEV = config['station']['elevation_m']
+    mod.MIN_ELEVATION = config['station']['min_elevation_deg']
+    return mod
+
+
 def generate_orbital_data(config):
     """
     Generate orbital data using the existing generate_orbital_data module.
     Returns the data dict directly instead of writing to file.
     """
     try:
-        # Import the generator - it lives in hmi/
-        sys.path.insert(0, str(HMI_DIR))
-        
-        # We need to patch the ground station location from config
-        import importlib
-        if 'generate_orbital_data' in sys.modules:
-            mod = importlib.reload(sys.modules['generate_orbital_data'])
-        else:
-            mod = importlib.import_module('generate_orbital_data')
-        
-        # Patch ground station from config
-        mod.GS_LAT = config['station']['lat']
-        mod.GS_LON = config['station']['lon']
-        mod.GS_ELEV = config['station']['elevation_m']
-        mod.MIN_ELEVATION = config['station']['min_elevation_deg']
+        mod = load_generator(config)
         
         # Generate data
         data = mod.generate_data(
@@ -195,6 +203,25 @@ def generate_orbital_data(config):
         return None
 
 
+def generate_orbital_binary(config):
+    """
+    Bring data/orbital_data.bin up to date with satgs_orbits. Only the
+    segments added since the last call are propagated. Returns True on success.
+    """
+    try:
+        mod = load_generator(config)
+        return mod.generate_binary(
+            duration_hours=config['hmi']['propagation_hours'],
+            position_step_sec=config['hmi']['position_step_sec'],
+            doppler_step_sec=config['hmi']['doppler_step_sec'],
+            output_path=str(DATA_DIR / 'orbital_data.bin'),
+        )
+    except Exception as e:
+        print(f"[ERROR] Binary orbital data generation failed: {e}")
+        traceback.print_exc()
+        return False
+
+
 # =============================================================
 # Mission Log
 # =============================================================
@@ -251,6 +278,8 @@ def run_capture_async(pass_info, config):
         mission_entry = {
             'timestamp': datetime.now(timezone.utc).isoformat(),
             'satellite': pass_info.get('satellite', 'Unknown'),
+            'aos_utc': pass_info.get('aos_utc'),
+            'los_utc': pass_info.get('los_utc'),
             'max_elevation_deg': pass_info.get('max_el', 0),
             'status': 'capturing',
             'capture_file': None,
@@ -335,6 +364,23 @@ def run_capture_async(pass_info, config):
         append_mission_log(mission_entry)
         state.capture_history.append(mission_entry)
         
+        try:
+            from python.data_store import index_pass
+            if pipeline_pass.get('aos_time') and pipeline_pass.get('los_time'):
+                image = mission_entry.get('decoded_image')
+                index_pass(
+                    mission_entry['satellite'], pipeline_pass['aos_time'], pipeline_pass['los_time'],
+                    mission_entry['max_elevation_deg'],
+                    bool(mission_entry.get('capture_success')), bool(mission_entry.get('decode_success')),
+                    capture_file=mission_entry.get('capture_file'),
+                    image_file=str(DECODED_DIR / image) if image else None,
+                    sample_rate=config['capture'].get('sample_rate'),
+                    freq_hz=pass_info.get('freq_hz'), source='satcom_server',
+                    index_file=ARCHIVE_INDEX_PATH,
+                )
+        except Exception as e:
+            print(f"[CAPTURE] Archive index not updated: {e}")
+        
         print(f"[CAPTURE] Mission complete for {pass_info.get('satellite', 'Unknown')}")
         
     except Exception as e:
@@ -380,16 +426,20 @@ class SATCOMHandler(SimpleHTTPRequestHandler):
         # ---- API Routes ----
         if path == '/api/orbital-data':
             self.handle_orbital_data()
+        elif path == '/api/orbital-data.bin':
+            self.handle_orbital_data_bin()
         elif path == '/api/passes':
             self.handle_passes(parse_qs(parsed.query))
         elif path == '/api/status':
             self.handle_status()
         elif path == '/api/missions':
-            self.handle_missions()
+            self.handle_missions(parse_qs(parsed.query))
         elif path == '/api/config':
             self.handle_get_config()
         elif path.startswith('/api/decoded/'):
             self.handle_decoded_image(path)
+        elif path == '/api/waterfall':
+            self.handle_waterfall(parse_qs(parsed.query))
         
         # ---- Static Files (HMI) ----
         elif path == '/' or path == '/index.html':
@@ -459,6 +509,19 @@ class SATCOMHandler(SimpleHTTPRequestHandler):
         else:
             self.send_error_json(500, 'Failed to generate orbital data')
     
+    def handle_orbital_data_bin(self):
+        """Return orbital_data.bin, extended first if over 10 min old."""
+        bin_path = DATA_DIR / 'orbital_data.bin'
+        if not bin_path.exists() or time.time() - bin_path.stat().st_mtime >= 600:
+            print("[API] Extending binary orbital data...")
+            generate_orbital_binary(load_config())
+
+        # Without the exporter the HMI falls back to /api/orbital-data
+        if bin_path.exists():
+            self.serve_file(bin_path, 'application/octet-stream')
+        else:
+            self.send_error_json(404, 'No binary orbital data (build cpp/ for satgs_orbits)')
+    
     def handle_passes(self, query):
         """Return upcoming passes, optionally filtered."""
         config = load_config()
@@ -501,12 +564,49 @@ class SATCOMHandler(SimpleHTTPRequestHandler):
         
         self.send_json(status)
     
-    def handle_missions(self):
-        """Return mission history."""
-        log = load_mission_log()
+    def handle_missions(self, query):
+        """
+        Return mission history, optionally filtered by satellite, AOS
+        since (ISO 8601), minimum elevation, decoded only and newest N.
+        Answered from the archive index when it exists.
+        """
+        satellite = query.get('satellite', [None])[0]
+        since = query.get('since', [None])[0]
+        min_el = query.get('min_elevation', [None])[0]
+        decoded = query.get('decoded', ['false'])[0].lower() in ('1', 'true', 'yes')
+        limit = query.get('limit', [None])[0]
+        
+        missions = None
+        try:
+            from python.data_store import query_archive
+            missions = query_archive(
+                satellite=satellite, since=since,
+                min_elevation=float(min_el) if min_el else None,
+                decoded_only=decoded, limit=int(limit) if limit else None,
+                index_file=ARCHIVE_INDEX_PATH,
+            )
+        except Exception as e:
+            print(f"[MISSIONS] Archive query failed, reading mission log: {e}")
+        
+        source = 'archive'
+        if missions is None:
+            source = 'mission_log'
+            missions = load_mission_log()
+            if satellite:
+                missions = [m for m in missions if satellite.upper() in str(m.get('satellite', '')).upper()]
+            if since:
+                missions = [m for m in missions if str(m.get('aos_utc') or m.get('timestamp', '')) >= since]
+            if min_el:
+                missions = [m for m in missions if (m.get('max_elevation_deg') or 0) >= float(min_el)]
+            if decoded:
+                missions = [m for m in missions if m.get('decode_success')]
+            if limit:
+                missions = missions[-int(limit):][::-1]
+        
         self.send_json({
-            'count': len(log),
-            'missions': log,
+            'count': len(missions),
+            'source': source,
+            'missions': missions,
         })
     
     def handle_get_config(self):
@@ -601,6 +701,39 @@ class SATCOMHandler(SimpleHTTPRequestHandler):
         else:
             self.send_error_json(404, f'Image not found: {filename}')
     
+    def handle_waterfall(self, query):
+        """List the live spectrum rings, or return one ring's new rows."""
+        from python.waterfall_shm import list_waterfalls, read_waterfall, carrier_lock
+
+        name = query.get('name', [None])[0]
+        if not name:
+            rings = []
+            for ring_name in list_waterfalls():
+                ring = read_waterfall(ring_name, max_rows=1)
+                if ring:
+                    ring['lock'] = carrier_lock(ring)
+                    del ring['rows']
+                    rings.append(ring)
+            self.send_json({'waterfalls': rings})
+            return
+
+        try:
+            since = int(query.get('since', ['0'])[0])
+            max_rows = min(int(query.get('max', ['50'])[0]), 600)
+        except ValueError:
+            self.send_error_json(400, 'since and max must be integers')
+            return
+        ring = read_waterfall(name, since=since, max_rows=max_rows)
+        if ring is None:
+            self.send_error_json(404, f'No waterfall: {name}')
+            return
+        ring['lock'] = carrier_lock(ring)
+        # Rows stay one byte per bin on the wire
+        ring['rows'] = [{'seq': r['seq'], 'utc': r['utc'],
+                         'data': base64.b64encode(r['data']).decode('ascii')}
+                        for r in ring['rows']]
+        self.send_json(ring)
+
     def serve_file(self, file_path, content_type=None):
         """Serve a static file."""
         file_path = Path(file_path)